@@ -3,9 +3,27 @@
 #ifndef UNC_IDENTY_H
 #define UNC_IDENTY_H
 
+#include "Identy_archive.hxx"
+#include "Identy_blob_store.hxx"
+#include "Identy_blocklist.hxx"
+#include "Identy_cache.hxx"
+#include "Identy_capture.hxx"
+#include "Identy_cardinality.hxx"
+#include "Identy_collector.hxx"
+#include "Identy_columnar.hxx"
+#include "Identy_daemon.hxx"
+#include "Identy_diff.hxx"
+#include "Identy_executor.hxx"
+#include "Identy_fixture.hxx"
+#include "Identy_fleet.hxx"
 #include "Identy_hash.hxx"
+#include "Identy_heavy_hitters.hxx"
+#include "Identy_history.hxx"
 #include "Identy_hwid.hxx"
 #include "Identy_io.hxx"
+#include "Identy_similarity.hxx"
+#include "Identy_tier.hxx"
+#include "Identy_trace.hxx"
 #include "Identy_vm.hxx"
 
 #endif
@@ -0,0 +1,70 @@
+# Prints the static footprint of each Identy component.
+# Invoked by the identy_size_report target with
+#   -DIDENTY_COMPONENTS=name=path|name=path|...  library file per component
+#   -DIDENTY_SIZE_TOOL=<size or llvm-size>       optional, adds section sizes
+
+string(REPLACE "|" ";" components "${IDENTY_COMPONENTS}")
+
+# Appends value to line, right-aligned in a column of eleven characters
+function(append_column var value)
+  string(LENGTH "${value}" width)
+  set(result "${${var}}")
+  foreach(pad RANGE ${width} 10)
+    string(APPEND result " ")
+  endforeach()
+  string(APPEND result "${value}")
+  set(${var} "${result}" PARENT_SCOPE)
+endfunction()
+
+set(header "component")
+if(IDENTY_SIZE_TOOL)
+  foreach(column IN ITEMS text data bss)
+    append_column(header "${column}")
+  endforeach()
+endif()
+append_column(header "file")
+message("${header}")
+
+set(total_file 0)
+
+foreach(component IN LISTS components)
+  string(REGEX REPLACE "=.*$" "" name "${component}")
+  string(REGEX REPLACE "^[^=]*=" "" path "${component}")
+
+  file(SIZE "${path}" file_size)
+  math(EXPR total_file "${total_file} + ${file_size}")
+
+  set(line "${name}")
+  string(LENGTH "${name}" width)
+  foreach(pad RANGE ${width} 8)
+    string(APPEND line " ")
+  endforeach()
+
+  if(IDENTY_SIZE_TOOL)
+    # Berkeley format; for archives the last line sums every member
+    execute_process(
+      COMMAND "${IDENTY_SIZE_TOOL}" -t "${path}"
+      OUTPUT_VARIABLE output
+      ERROR_QUIET
+      RESULT_VARIABLE result
+    )
+
+    set(text "?")
+    set(data "?")
+    set(bss "?")
+    if(result EQUAL 0 AND output MATCHES "([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)[ \t]+[0-9]+[ \t]+[0-9a-fA-F]+[ \t]+[^\n]*\n?$")
+      set(text "${CMAKE_MATCH_1}")
+      set(data "${CMAKE_MATCH_2}")
+      set(bss "${CMAKE_MATCH_3}")
+    endif()
+
+    foreach(value IN ITEMS "${text}" "${data}" "${bss}")
+      append_column(line "${value}")
+    endforeach()
+  endif()
+  append_column(line "${file_size}")
+
+  message("${line}")
+endforeach()
+
+message("total file size: ${total_file} bytes")
@@ -0,0 +1,307 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_archive.hxx"
+
+#include "Platform/Identy_platform_io.hxx"
+
+namespace
+{
+constexpr std::size_t footer_count_offset = 0;
+constexpr std::size_t footer_magic_offset = 8;
+constexpr std::size_t footer_version_offset = 12;
+
+void store_u64_le(identy::byte* dst, std::uint64_t value) noexcept
+{
+    for(std::size_t i = 0; i < sizeof(value); ++i) {
+        dst[i] = static_cast<identy::byte>(value >> (i * 8));
+    }
+}
+
+std::uint64_t load_u64_le(const identy::byte* src) noexcept
+{
+    std::uint64_t value = 0;
+    for(std::size_t i = 0; i < sizeof(value); ++i) {
+        value |= static_cast<std::uint64_t>(src[i]) << (i * 8);
+    }
+    return value;
+}
+
+std::uint32_t load_u32_le(const identy::byte* src) noexcept
+{
+    return static_cast<std::uint32_t>(src[0]) | (static_cast<std::uint32_t>(src[1]) << 8) | (static_cast<std::uint32_t>(src[2]) << 16)
+        | (static_cast<std::uint32_t>(src[3]) << 24);
+}
+
+/**
+ * @brief Reads the snapshot size from a header without validating the whole snapshot
+ *
+ * Used to hop across records when computing partitions, so only the first
+ * bytes of every record are touched.
+ */
+std::size_t peek_snapshot_size(std::span<const identy::byte> bytes, std::size_t offset) noexcept
+{
+    if(offset + identy::io::snapshot_header_size > bytes.size()) {
+        return 0;
+    }
+
+    if(std::memcmp(bytes.data() + offset, identy::io::snapshot_magic, sizeof(identy::io::snapshot_magic)) != 0) {
+        return 0;
+    }
+
+    return load_u32_le(bytes.data() + offset + 8);
+}
+} // namespace
+
+identy::io::ArchiveWriter::ArchiveWriter(std::ostream& stream)
+    : m_stream(stream)
+{
+}
+
+bool identy::io::ArchiveWriter::append(const Motherboard& mb)
+{
+    m_buffer.clear();
+    if(encode_binary(m_buffer, mb) == 0) {
+        return false;
+    }
+
+    return append_encoded(m_buffer);
+}
+
+bool identy::io::ArchiveWriter::append(const MotherboardEx& mb)
+{
+    m_buffer.clear();
+    if(encode_binary(m_buffer, mb) == 0) {
+        return false;
+    }
+
+    return append_encoded(m_buffer);
+}
+
+bool identy::io::ArchiveWriter::append_encoded(std::span<const byte> snapshot)
+{
+    if(snapshot.empty() || !m_stream.good()) {
+        return false;
+    }
+
+    m_stream.write(reinterpret_cast<const char*>(snapshot.data()), static_cast<std::streamsize>(snapshot.size()));
+    if(!m_stream.good()) {
+        return false;
+    }
+
+    m_offsets.push_back(m_position);
+    m_position += snapshot.size();
+    return true;
+}
+
+std::size_t identy::io::ArchiveWriter::record_count() const noexcept
+{
+    return m_offsets.size();
+}
+
+void identy::io::ArchiveWriter::finish()
+{
+    if(!m_stream.good()) {
+        return;
+    }
+
+    std::vector<byte> footer(m_offsets.size() * sizeof(std::uint64_t) + archive_footer_size);
+
+    for(std::size_t i = 0; i < m_offsets.size(); ++i) {
+        store_u64_le(footer.data() + i * sizeof(std::uint64_t), m_offsets[i]);
+    }
+
+    byte* trailer = footer.data() + m_offsets.size() * sizeof(std::uint64_t);
+
+    store_u64_le(trailer + footer_count_offset, m_offsets.size());
+    std::memcpy(trailer + footer_magic_offset, archive_footer_magic, sizeof(archive_footer_magic));
+
+    for(std::size_t i = 0; i < sizeof(archive_footer_version); ++i) {
+        trailer[footer_version_offset + i] = static_cast<byte>(archive_footer_version >> (i * 8));
+    }
+
+    m_stream.write(reinterpret_cast<const char*>(footer.data()), static_cast<std::streamsize>(footer.size()));
+}
+
+std::optional<identy::io::ArchiveReader> identy::io::ArchiveReader::open(const std::filesystem::path& path)
+{
+    auto file = platform::MappedFile::open(path, true);
+    if(file == nullptr) {
+        return std::nullopt;
+    }
+
+    ArchiveReader reader;
+    reader.m_file = std::move(file);
+
+    auto bytes = reader.bytes();
+    reader.m_data_size = bytes.size();
+
+    if(bytes.size() < archive_footer_size) {
+        return reader;
+    }
+
+    const byte* trailer = bytes.data() + bytes.size() - archive_footer_size;
+
+    if(std::memcmp(trailer + footer_magic_offset, archive_footer_magic, sizeof(archive_footer_magic)) != 0) {
+        return reader;
+    }
+
+    auto version = load_u32_le(trailer + footer_version_offset);
+    auto count = load_u64_le(trailer + footer_count_offset);
+
+    std::uint64_t available = (bytes.size() - archive_footer_size) / sizeof(std::uint64_t);
+
+    if(version == 0 || version > archive_footer_version || count > available) {
+        return std::nullopt;
+    }
+
+    reader.m_has_index = true;
+    reader.m_index_count = static_cast<std::size_t>(count);
+    reader.m_data_size = bytes.size() - archive_footer_size - reader.m_index_count * sizeof(std::uint64_t);
+
+    return reader;
+}
+
+identy::io::ArchiveReader::ArchiveReader(ArchiveReader&& other) noexcept = default;
+
+identy::io::ArchiveReader& identy::io::ArchiveReader::operator=(ArchiveReader&& other) noexcept = default;
+
+identy::io::ArchiveReader::~ArchiveReader() = default;
+
+std::span<const identy::byte> identy::io::ArchiveReader::bytes() const noexcept
+{
+    return m_file->bytes();
+}
+
+std::uint64_t identy::io::ArchiveReader::index_entry(std::size_t index) const noexcept
+{
+    return load_u64_le(bytes().data() + m_data_size + index * sizeof(std::uint64_t));
+}
+
+bool identy::io::ArchiveReader::has_index() const noexcept
+{
+    return m_has_index;
+}
+
+std::size_t identy::io::ArchiveReader::data_size() const noexcept
+{
+    return m_data_size;
+}
+
+std::size_t identy::io::ArchiveReader::record_count() const noexcept
+{
+    if(m_has_index) {
+        return m_index_count;
+    }
+
+    auto data = bytes().first(m_data_size);
+
+    std::size_t count = 0;
+    std::size_t offset = 0;
+
+    while(auto size = peek_snapshot_size(data, offset)) {
+        if(offset + size > data.size()) {
+            break;
+        }
+
+        offset += size;
+        ++count;
+    }
+
+    return count;
+}
+
+std::optional<identy::io::SnapshotReader> identy::io::ArchiveReader::record(std::size_t index) const noexcept
+{
+    if(!m_has_index || index >= m_index_count) {
+        return std::nullopt;
+    }
+
+    auto offset = index_entry(index);
+    if(offset >= m_data_size) {
+        return std::nullopt;
+    }
+
+    return record_at_offset(static_cast<std::size_t>(offset), m_data_size);
+}
+
+std::optional<identy::io::SnapshotReader> identy::io::ArchiveReader::record_at_offset(std::size_t offset, std::size_t end) const noexcept
+{
+    end = std::min(end, m_data_size);
+
+    if(offset >= end) {
+        return std::nullopt;
+    }
+
+    return SnapshotReader::open(bytes().subspan(offset, end - offset));
+}
+
+identy::io::ArchiveReader::Iterator identy::io::ArchiveReader::begin() const noexcept
+{
+    return Iterator(this, 0, m_data_size);
+}
+
+identy::io::ArchiveReader::Iterator identy::io::ArchiveReader::end() const noexcept
+{
+    return Iterator();
+}
+
+std::vector<identy::io::ArchivePartition> identy::io::ArchiveReader::partition(std::size_t parts) const
+{
+    parts = std::max<std::size_t>(parts, 1);
+
+    std::vector<ArchivePartition> result;
+
+    if(m_data_size == 0) {
+        return result;
+    }
+
+    if(m_has_index) {
+        if(m_index_count == 0) {
+            return result;
+        }
+
+        parts = std::min(parts, m_index_count);
+        result.reserve(parts);
+
+        for(std::size_t i = 0; i < parts; ++i) {
+            auto first = m_index_count * i / parts;
+            auto last = m_index_count * (i + 1) / parts;
+
+            auto begin_offset = static_cast<std::size_t>(index_entry(first));
+            auto end_offset = last == m_index_count ? m_data_size : static_cast<std::size_t>(index_entry(last));
+
+            if(begin_offset < end_offset && end_offset <= m_data_size) {
+                result.push_back({ begin_offset, end_offset });
+            }
+        }
+
+        return result;
+    }
+
+    // No index: one pass over the record headers, cutting at the first record
+    // boundary past every target byte position
+    auto data = bytes().first(m_data_size);
+    auto target = m_data_size / parts;
+
+    std::size_t offset = 0;
+    std::size_t part_begin = 0;
+
+    while(auto size = peek_snapshot_size(data, offset)) {
+        if(offset + size > data.size()) {
+            break;
+        }
+
+        offset += size;
+
+        if(offset >= target * (result.size() + 1) && result.size() + 1 < parts) {
+            result.push_back({ part_begin, offset });
+            part_begin = offset;
+        }
+    }
+
+    if(offset > part_begin) {
+        result.push_back({ part_begin, offset });
+    }
+
+    return result;
+}
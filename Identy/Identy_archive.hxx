@@ -0,0 +1,356 @@
+/**
+ * @file Identy_archive.hxx
+ * @brief Memory-mapped reader and writer for concatenated snapshot archives
+ *
+ * An archive is a plain concatenation of binary snapshots produced by
+ * io::encode_binary(), optionally followed by a footer offset index.
+ *
+ * ## Footer Layout (version 1)
+ *
+ * | Size    | Content                                   |
+ * |---------|-------------------------------------------|
+ * | 8*N     | Little-endian offsets of every snapshot   |
+ * | 8       | Record count N                            |
+ * | 4       | Magic "IDAX"                              |
+ * | 4       | Footer version                            |
+ *
+ * Archives without a footer are still readable: records are discovered by
+ * hopping from one snapshot header to the next.
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_ARCHIVE_H
+#define UNC_IDENTY_ARCHIVE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include "Identy_executor.hxx"
+#include "Identy_io.hxx"
+
+namespace identy::platform
+{
+class MappedFile;
+} // namespace identy::platform
+
+namespace identy::io
+{
+/** @brief Magic bytes of the archive footer ("IDAX") */
+constexpr byte archive_footer_magic[4] = { 'I', 'D', 'A', 'X' };
+
+/** @brief Current archive footer version */
+constexpr std::uint32_t archive_footer_version = 1;
+
+/** @brief Size of the fixed archive footer trailer (count, magic, version) */
+constexpr std::size_t archive_footer_size = 16;
+
+/**
+ * @brief Contiguous byte range of an archive holding whole records
+ *
+ * Offsets are relative to the beginning of the archive.
+ */
+struct ArchivePartition
+{
+    /** @brief Offset of the first record in the partition */
+    std::size_t begin { 0 };
+
+    /** @brief Offset one past the last record in the partition */
+    std::size_t end { 0 };
+};
+
+/**
+ * @brief Sequential writer of snapshot archives
+ *
+ * Appends encoded snapshots to a stream and optionally terminates the archive
+ * with an offset index so readers can jump to records and partition the file
+ * without walking it.
+ */
+class ArchiveWriter final
+{
+public:
+    /**
+     * @brief Creates a writer appending to @p stream
+     *
+     * @param stream Output stream (must be in binary mode)
+     */
+    explicit ArchiveWriter(std::ostream& stream);
+
+    /**
+     * @brief Encodes and appends a Motherboard snapshot
+     *
+     * @return false if the snapshot cannot be encoded or written; no record
+     *         is added then
+     */
+    bool append(const Motherboard& mb);
+
+    /**
+     * @brief Encodes and appends a MotherboardEx snapshot
+     *
+     * @return false if the snapshot cannot be encoded or written; no record
+     *         is added then
+     */
+    bool append(const MotherboardEx& mb);
+
+    /**
+     * @brief Appends an already encoded snapshot
+     *
+     * @param snapshot Snapshot bytes as produced by encode_binary()
+     * @return false if @p snapshot is empty or the stream failed; no record
+     *         is added then
+     */
+    bool append_encoded(std::span<const byte> snapshot);
+
+    /** @brief Number of records appended so far */
+    std::size_t record_count() const noexcept;
+
+    /**
+     * @brief Writes the footer offset index
+     *
+     * @note No records may be appended after calling finish()
+     */
+    void finish();
+
+private:
+    std::ostream& m_stream;
+    std::vector<byte> m_buffer;
+    std::vector<std::uint64_t> m_offsets;
+    std::uint64_t m_position { 0 };
+};
+
+/**
+ * @brief Zero-copy reader over a memory-mapped snapshot archive
+ *
+ * Maps the whole archive read-only with a sequential access hint and yields
+ * io::SnapshotReader views directly into the mapping. Records are never
+ * copied; the views stay valid as long as the ArchiveReader is alive.
+ *
+ * Iteration stops at the first malformed record, so a partially written tail
+ * does not prevent reading the intact prefix.
+ *
+ * ## Parallel Scans
+ *
+ * partition() splits the archive into byte ranges holding whole records. When
+ * the archive has a footer index the split is computed from the index only,
+ * otherwise one pass over the record headers is made. scan_parallel() runs
+ * the partitions on an executor (see Identy_executor.hxx).
+ */
+class ArchiveReader final
+{
+public:
+    /**
+     * @brief Forward iterator over the records of an archive
+     */
+    class Iterator
+    {
+    public:
+        using value_type = SnapshotReader;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        const SnapshotReader& operator*() const noexcept
+        {
+            return *m_current;
+        }
+
+        const SnapshotReader* operator->() const noexcept
+        {
+            return &*m_current;
+        }
+
+        Iterator& operator++() noexcept
+        {
+            m_offset += m_current->size();
+            m_current = m_archive->record_at_offset(m_offset, m_end);
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const noexcept
+        {
+            return m_current.has_value() == other.m_current.has_value() && (!m_current.has_value() || m_offset == other.m_offset);
+        }
+
+    private:
+        friend class ArchiveReader;
+
+        Iterator(const ArchiveReader* archive, std::size_t offset, std::size_t end) noexcept
+            : m_archive(archive)
+            , m_offset(offset)
+            , m_end(end)
+            , m_current(archive->record_at_offset(offset, end))
+        {
+        }
+
+        const ArchiveReader* m_archive { nullptr };
+        std::size_t m_offset { 0 };
+        std::size_t m_end { 0 };
+        std::optional<SnapshotReader> m_current;
+    };
+
+    /**
+     * @brief Maps an archive file
+     *
+     * @param path Archive file path
+     * @return Reader, std::nullopt if the file cannot be mapped or has a corrupt footer
+     */
+    static std::optional<ArchiveReader> open(const std::filesystem::path& path);
+
+    ArchiveReader(ArchiveReader&& other) noexcept;
+    ArchiveReader& operator=(ArchiveReader&& other) noexcept;
+    ~ArchiveReader();
+
+    /** @brief Whether the archive ends with a footer offset index */
+    bool has_index() const noexcept;
+
+    /** @brief Size of the record area in bytes (file size without the footer) */
+    std::size_t data_size() const noexcept;
+
+    /**
+     * @brief Number of records
+     *
+     * O(1) with a footer index, otherwise walks every record header.
+     */
+    std::size_t record_count() const noexcept;
+
+    /**
+     * @brief Random access to a record via the footer index
+     *
+     * @param index Record index
+     * @return Record view, std::nullopt without an index, for an out of range
+     *         index or a malformed record
+     */
+    std::optional<SnapshotReader> record(std::size_t index) const noexcept;
+
+    /**
+     * @brief Reads the record starting at @p offset
+     *
+     * @param offset Offset of the snapshot header from the beginning of the archive
+     * @param end Records must end at or before this offset
+     */
+    std::optional<SnapshotReader> record_at_offset(std::size_t offset, std::size_t end) const noexcept;
+
+    /** @brief Iterator to the first record */
+    Iterator begin() const noexcept;
+
+    /** @brief Past-the-end iterator */
+    Iterator end() const noexcept;
+
+    /**
+     * @brief Splits the archive into at most @p parts ranges of roughly equal size
+     *
+     * @param parts Desired number of partitions (0 is treated as 1)
+     * @return Non-empty partitions covering every record exactly once
+     */
+    std::vector<ArchivePartition> partition(std::size_t parts) const;
+
+    /**
+     * @brief Visits every record of a partition in order
+     *
+     * @param part Partition obtained from partition()
+     * @param fn Callable invoked as fn(const SnapshotReader&)
+     * @return Number of records visited
+     */
+    template<typename Fn>
+    std::size_t for_each(const ArchivePartition& part, Fn&& fn) const;
+
+    /**
+     * @brief Visits every record of the archive in order
+     *
+     * @param fn Callable invoked as fn(const SnapshotReader&)
+     * @return Number of records visited
+     */
+    template<typename Fn>
+    std::size_t for_each(Fn&& fn) const;
+
+    /**
+     * @brief Visits every record, partitions running concurrently on an executor
+     *
+     * @param fn Callable invoked as fn(const SnapshotReader&); must be safe to
+     *           call concurrently from several threads
+     * @param partitions Number of partitions (0 selects the executor concurrency)
+     * @param executor Executor running the partitions
+     * @return Number of records visited
+     */
+    template<typename Fn>
+    std::size_t scan_parallel(Fn&& fn, std::size_t partitions = 0, exec::ExecutorRef executor = exec::default_executor()) const;
+
+private:
+    ArchiveReader() = default;
+
+    std::span<const byte> bytes() const noexcept;
+    std::uint64_t index_entry(std::size_t index) const noexcept;
+
+    std::unique_ptr<platform::MappedFile> m_file;
+    std::size_t m_data_size { 0 };
+    std::size_t m_index_count { 0 };
+    bool m_has_index { false };
+};
+} // namespace identy::io
+
+template<typename Fn>
+std::size_t identy::io::ArchiveReader::for_each(const ArchivePartition& part, Fn&& fn) const
+{
+    std::size_t visited = 0;
+    std::size_t offset = part.begin;
+
+    while(offset < part.end) {
+        auto record = record_at_offset(offset, part.end);
+        if(!record.has_value()) {
+            break;
+        }
+
+        fn(*record);
+
+        offset += record->size();
+        ++visited;
+    }
+
+    return visited;
+}
+
+template<typename Fn>
+std::size_t identy::io::ArchiveReader::for_each(Fn&& fn) const
+{
+    return for_each(ArchivePartition { 0, m_data_size }, fn);
+}
+
+template<typename Fn>
+std::size_t identy::io::ArchiveReader::scan_parallel(Fn&& fn, std::size_t partitions, exec::ExecutorRef executor) const
+{
+    if(partitions == 0) {
+        partitions = std::max<std::size_t>(1, executor.concurrency());
+    }
+
+    auto parts = partition(partitions);
+    if(parts.empty()) {
+        return 0;
+    }
+
+    std::vector<std::size_t> visited(parts.size(), 0);
+
+    exec::parallel_for(
+        parts.size(),
+        [this, &fn, &parts, &visited](std::size_t begin, std::size_t end) {
+            for(auto i = begin; i < end; ++i) {
+                visited[i] = for_each(parts[i], fn);
+            }
+        },
+        executor, 1);
+
+    std::size_t total = 0;
+    for(auto count : visited) {
+        total += count;
+    }
+
+    return total;
+}
+
+#endif
@@ -0,0 +1,330 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_blob_store.hxx"
+#include "Identy_sha256.hxx"
+#include "detail/Identy_bytes.hxx"
+
+namespace
+{
+constexpr std::size_t pack_header_size = 8;
+constexpr std::size_t record_header_size = 48;
+constexpr std::size_t record_alignment = 8;
+
+constexpr identy::byte blob_tag[4] = { 'B', 'L', 'O', 'B' };
+constexpr identy::byte refs_tag[4] = { 'R', 'E', 'F', 'S' };
+
+constexpr std::size_t record_tag_offset = 0;
+constexpr std::size_t record_delta_offset = 4;
+constexpr std::size_t record_size_offset = 8;
+constexpr std::size_t record_digest_offset = 16;
+
+constexpr std::uint64_t align_record(std::uint64_t value) noexcept
+{
+    return (value + record_alignment - 1) & ~std::uint64_t { record_alignment - 1 };
+}
+
+using identy::detail::store_le;
+using identy::detail::load_le;
+
+/**
+ * Whether a record tag appears at an aligned offset in [from, end). A bad
+ * record followed by intact ones is corruption inside the pack, not a record
+ * torn by an interrupted append.
+ */
+bool record_follows(std::istream& pack, std::uint64_t from, std::uint64_t end)
+{
+    std::vector<identy::byte> chunk(64 * 1024);
+
+    pack.clear();
+    pack.seekg(static_cast<std::streamoff>(from));
+
+    for(auto offset = from; offset + record_header_size <= end;) {
+        auto size = static_cast<std::size_t>(std::min<std::uint64_t>(chunk.size(), end - offset));
+        if(!pack.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(size))) {
+            return false;
+        }
+
+        for(std::size_t i = 0; i < size && offset + i + record_header_size <= end; i += record_alignment) {
+            if(std::memcmp(chunk.data() + i, blob_tag, sizeof(blob_tag)) == 0
+                || std::memcmp(chunk.data() + i, refs_tag, sizeof(refs_tag)) == 0) {
+                return true;
+            }
+        }
+
+        offset += size;
+    }
+
+    return false;
+}
+} // namespace
+
+std::optional<identy::io::BlobStore> identy::io::BlobStore::open(const std::filesystem::path& pack_path)
+{
+    std::error_code ec;
+    bool exists = std::filesystem::exists(pack_path, ec);
+
+    if(!exists) {
+        std::ofstream create(pack_path, std::ios::binary);
+        if(!create) {
+            return std::nullopt;
+        }
+
+        byte header[pack_header_size] {};
+        std::memcpy(header, blob_pack_magic, sizeof(blob_pack_magic));
+        store_le(header + 4, blob_pack_version);
+
+        create.write(reinterpret_cast<const char*>(header), sizeof(header));
+        if(!create) {
+            return std::nullopt;
+        }
+    }
+
+    BlobStore store;
+    store.m_path = pack_path;
+    store.m_pack = std::make_unique<std::fstream>(pack_path, std::ios::binary | std::ios::in | std::ios::out);
+
+    if(!store.m_pack->is_open() || !store.replay()) {
+        return std::nullopt;
+    }
+
+    // cut off a torn record left by an interrupted append; replay() fails on
+    // a bad record with intact ones after it, so nothing valid is cut here
+    if(std::filesystem::file_size(pack_path, ec) != store.m_pack_size && !ec) {
+        store.m_pack.reset();
+        std::filesystem::resize_file(pack_path, store.m_pack_size, ec);
+        if(ec) {
+            return std::nullopt;
+        }
+
+        store.m_pack = std::make_unique<std::fstream>(pack_path, std::ios::binary | std::ios::in | std::ios::out);
+        if(!store.m_pack->is_open()) {
+            return std::nullopt;
+        }
+    }
+
+    return store;
+}
+
+bool identy::io::BlobStore::replay()
+{
+    auto& pack = *m_pack;
+
+    byte header[pack_header_size];
+    pack.seekg(0);
+
+    if(!pack.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        return false;
+    }
+
+    if(std::memcmp(header, blob_pack_magic, sizeof(blob_pack_magic)) != 0) {
+        return false;
+    }
+
+    auto version = load_le<std::uint32_t>(header + 4);
+    if(version == 0 || version > blob_pack_version) {
+        return false;
+    }
+
+    pack.seekg(0, std::ios::end);
+    auto file_size = static_cast<std::uint64_t>(pack.tellg());
+    pack.seekg(pack_header_size);
+
+    m_pack_size = pack_header_size;
+
+    byte record[record_header_size];
+    std::vector<byte> payload;
+
+    while(pack.read(reinterpret_cast<char*>(record), sizeof(record))) {
+        BlobRef ref;
+        std::memcpy(ref.buffer, record + record_digest_offset, sizeof(ref.buffer));
+
+        if(std::memcmp(record + record_tag_offset, blob_tag, sizeof(blob_tag)) == 0) {
+            auto size = load_le<std::uint64_t>(record + record_size_offset);
+            auto data_offset = m_pack_size + record_header_size;
+            auto next = align_record(data_offset + size);
+
+            if(next > file_size) {
+                if(record_follows(pack, m_pack_size + record_alignment, file_size)) {
+                    return false; // corrupt size field
+                }
+                break; // torn payload
+            }
+
+            // the index is only as good as the payloads: a blob whose bytes
+            // do not match its digest is skipped, get() reports it as unknown
+            payload.resize(static_cast<std::size_t>(size));
+            if(!pack.read(reinterpret_cast<char*>(payload.data()), static_cast<std::streamsize>(payload.size()))) {
+                break;
+            }
+
+            pack.seekg(static_cast<std::streamoff>(next));
+            m_pack_size = next;
+
+            if(std::memcmp(hs::detail::Sha256::hash(payload).buffer, ref.buffer, sizeof(ref.buffer)) != 0) {
+                continue;
+            }
+
+            auto& entry = m_index[ref];
+            entry.offset = data_offset;
+            entry.size = size;
+            entry.refs += 1;
+        }
+        else if(std::memcmp(record + record_tag_offset, refs_tag, sizeof(refs_tag)) == 0) {
+            auto delta = load_le<std::int32_t>(record + record_delta_offset);
+
+            auto it = m_index.find(ref);
+            if(it != m_index.end()) {
+                auto refs = static_cast<std::int64_t>(it->second.refs) + delta;
+                it->second.refs = static_cast<std::uint32_t>(std::max<std::int64_t>(refs, 0));
+            }
+
+            m_pack_size += record_header_size;
+        }
+        else if(record_follows(pack, m_pack_size + record_alignment, file_size)) {
+            return false; // corrupt tag
+        }
+        else {
+            break; // torn header
+        }
+    }
+
+    pack.clear();
+
+    return true;
+}
+
+void identy::io::BlobStore::reset_stream()
+{
+    // a failed flush leaves the unwritten bytes in the stream buffer and every
+    // later seek fails on them; a fresh stream drops them, and the next record
+    // overwrites whatever part of the failed one reached the file
+    m_pack = std::make_unique<std::fstream>(m_path, std::ios::binary | std::ios::in | std::ios::out);
+}
+
+bool identy::io::BlobStore::append_refs(const BlobRef& ref, std::int32_t delta)
+{
+    byte record[record_header_size] {};
+    std::memcpy(record + record_tag_offset, refs_tag, sizeof(refs_tag));
+    store_le(record + record_delta_offset, delta);
+    std::memcpy(record + record_digest_offset, ref.buffer, sizeof(ref.buffer));
+
+    m_pack->seekp(static_cast<std::streamoff>(m_pack_size));
+    m_pack->write(reinterpret_cast<const char*>(record), sizeof(record));
+    m_pack->flush();
+
+    if(!m_pack->good()) {
+        reset_stream();
+        return false;
+    }
+
+    m_pack_size += record_header_size;
+    return true;
+}
+
+std::optional<identy::io::BlobRef> identy::io::BlobStore::put(std::span<const byte> data)
+{
+    auto ref = hs::detail::Sha256::hash(data);
+
+    auto it = m_index.find(ref);
+    if(it != m_index.end()) {
+        if(!append_refs(ref, 1)) {
+            return std::nullopt;
+        }
+
+        it->second.refs += 1;
+        return ref;
+    }
+
+    byte record[record_header_size] {};
+    std::memcpy(record + record_tag_offset, blob_tag, sizeof(blob_tag));
+    store_le(record + record_size_offset, static_cast<std::uint64_t>(data.size()));
+    std::memcpy(record + record_digest_offset, ref.buffer, sizeof(ref.buffer));
+
+    auto data_offset = m_pack_size + record_header_size;
+    auto next = align_record(data_offset + data.size());
+
+    static constexpr char padding[record_alignment] {};
+
+    m_pack->seekp(static_cast<std::streamoff>(m_pack_size));
+    m_pack->write(reinterpret_cast<const char*>(record), sizeof(record));
+    m_pack->write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    m_pack->write(padding, static_cast<std::streamsize>(next - data_offset - data.size()));
+    m_pack->flush();
+
+    if(!m_pack->good()) {
+        reset_stream();
+        return std::nullopt;
+    }
+
+    Entry entry;
+    entry.offset = data_offset;
+    entry.size = data.size();
+    entry.refs = 1;
+    entry.cache = std::make_shared<const std::vector<byte>>(data.begin(), data.end());
+
+    m_index.emplace(ref, std::move(entry));
+    m_pack_size = next;
+
+    return ref;
+}
+
+bool identy::io::BlobStore::release(const BlobRef& ref)
+{
+    auto it = m_index.find(ref);
+    if(it == m_index.end() || it->second.refs == 0) {
+        return false;
+    }
+
+    if(!append_refs(ref, -1)) {
+        return false;
+    }
+
+    it->second.refs -= 1;
+
+    return true;
+}
+
+std::optional<std::span<const identy::byte>> identy::io::BlobStore::get(const BlobRef& ref) const
+{
+    auto it = m_index.find(ref);
+    if(it == m_index.end()) {
+        return std::nullopt;
+    }
+
+    const auto& entry = it->second;
+
+    if(entry.cache == nullptr) {
+        auto payload = std::make_shared<std::vector<byte>>(static_cast<std::size_t>(entry.size));
+
+        m_pack->seekg(static_cast<std::streamoff>(entry.offset));
+        if(!m_pack->read(reinterpret_cast<char*>(payload->data()), static_cast<std::streamsize>(payload->size()))) {
+            m_pack->clear();
+            return std::nullopt;
+        }
+
+        entry.cache = std::move(payload);
+    }
+
+    return std::span<const byte>(*entry.cache);
+}
+
+bool identy::io::BlobStore::contains(const BlobRef& ref) const noexcept
+{
+    return m_index.contains(ref);
+}
+
+std::uint32_t identy::io::BlobStore::ref_count(const BlobRef& ref) const noexcept
+{
+    auto it = m_index.find(ref);
+    return it == m_index.end() ? 0 : it->second.refs;
+}
+
+std::size_t identy::io::BlobStore::blob_count() const noexcept
+{
+    return m_index.size();
+}
+
+std::uint64_t identy::io::BlobStore::pack_size() const noexcept
+{
+    return m_pack_size;
+}
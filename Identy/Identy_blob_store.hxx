@@ -0,0 +1,174 @@
+/**
+ * @file Identy_blob_store.hxx
+ * @brief Content-addressed deduplicating store for large snapshot payloads
+ *
+ * SMBIOS tables are nearly identical across hosts of the same model, so
+ * storing them inside every snapshot wastes space. A BlobStore keeps each
+ * distinct payload exactly once in an append-only pack file, keyed by its
+ * SHA-256 digest, and snapshots carry only the 32-byte BlobRef.
+ *
+ * ## Pack File Layout (version 1)
+ *
+ * The pack starts with an 8-byte header ("IDPK" + version) followed by
+ * 8-byte aligned records. All integers are little-endian.
+ *
+ * | Record | Content                                                  |
+ * |--------|----------------------------------------------------------|
+ * | BLOB   | tag, reserved, u64 size, 32-byte digest, payload, padding |
+ * | REFS   | tag, i32 reference delta, u64 reserved, 32-byte digest    |
+ *
+ * Storing a new payload appends a BLOB record (reference count 1), storing a
+ * known payload or releasing a reference appends a REFS record. Opening a pack
+ * replays all records to rebuild the in-memory index and reference counts,
+ * checking every payload against its digest. A torn record at the end of the
+ * file is cut off and a blob whose payload does not match its digest is left
+ * out of the index. A record with a bad tag or size that is followed by intact
+ * records makes open() fail and leaves the file untouched.
+ *
+ * @note BlobStore is not thread-safe. Use external synchronization when
+ *       sharing one store between threads.
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_BLOB_STORE_H
+#define UNC_IDENTY_BLOB_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "Identy_io.hxx"
+
+namespace identy::io
+{
+/** @brief Magic bytes at the beginning of a blob pack file ("IDPK") */
+constexpr byte blob_pack_magic[4] = { 'I', 'D', 'P', 'K' };
+
+/** @brief Current blob pack format version */
+constexpr std::uint32_t blob_pack_version = 1;
+
+/**
+ * @brief Content-addressed, reference-counted blob store backed by a pack file
+ *
+ * Example usage:
+ * @code
+ * auto store = identy::io::BlobStore::open("smbios.pack");
+ *
+ * std::vector<identy::byte> snapshot;
+ * identy::io::encode_binary(snapshot, identy::snap_motherboard_ex(), *store);
+ *
+ * auto reader = identy::io::read_binary(snapshot);
+ * auto mb = reader->to_motherboard_ex(&*store);
+ * @endcode
+ */
+class BlobStore final
+{
+public:
+    /**
+     * @brief Opens an existing pack or creates a new one
+     *
+     * @param pack_path Path of the pack file
+     * @return Store, std::nullopt if the file cannot be opened, is not a pack
+     *         or has a corrupt record before its end
+     */
+    static std::optional<BlobStore> open(const std::filesystem::path& pack_path);
+
+    BlobStore(BlobStore&&) noexcept = default;
+    BlobStore& operator=(BlobStore&&) noexcept = default;
+
+    /**
+     * @brief Stores a payload and takes a reference to it
+     *
+     * Appends the payload only if no blob with the same digest exists yet,
+     * otherwise only the reference count is incremented.
+     *
+     * @param data Payload bytes
+     * @return Reference to the stored payload, std::nullopt if the pack could
+     *         not be written (the store is left unchanged)
+     */
+    std::optional<BlobRef> put(std::span<const byte> data);
+
+    /**
+     * @brief Drops one reference to a blob
+     *
+     * @param ref Blob reference
+     * @return false if the blob is unknown, has no references left or the
+     *         pack could not be written
+     *
+     * @note The payload stays in the pack; reclaiming space of unreferenced
+     *       blobs requires rewriting the pack
+     */
+    bool release(const BlobRef& ref);
+
+    /**
+     * @brief Returns the payload of a blob
+     *
+     * The payload is read from the pack once and cached, later calls return
+     * the cached bytes.
+     *
+     * @param ref Blob reference
+     * @return View of the payload valid for the store lifetime, std::nullopt if unknown
+     */
+    std::optional<std::span<const byte>> get(const BlobRef& ref) const;
+
+    /** @brief Whether a blob with this digest is stored */
+    bool contains(const BlobRef& ref) const noexcept;
+
+    /** @brief Current reference count of a blob, 0 if unknown */
+    std::uint32_t ref_count(const BlobRef& ref) const noexcept;
+
+    /** @brief Number of distinct blobs in the pack */
+    std::size_t blob_count() const noexcept;
+
+    /** @brief Size of the pack file in bytes */
+    std::uint64_t pack_size() const noexcept;
+
+private:
+    struct Entry
+    {
+        std::uint64_t offset { 0 };
+        std::uint64_t size { 0 };
+        std::uint32_t refs { 0 };
+        mutable std::shared_ptr<const std::vector<byte>> cache;
+    };
+
+    struct RefHasher
+    {
+        std::size_t operator()(const BlobRef& ref) const noexcept
+        {
+            std::size_t value;
+            std::memcpy(&value, ref.buffer, sizeof(value));
+            return value;
+        }
+    };
+
+    struct RefEqual
+    {
+        bool operator()(const BlobRef& lhs, const BlobRef& rhs) const noexcept
+        {
+            return std::memcmp(lhs.buffer, rhs.buffer, sizeof(lhs.buffer)) == 0;
+        }
+    };
+
+    BlobStore() = default;
+
+    bool replay();
+    void reset_stream();
+    bool append_refs(const BlobRef& ref, std::int32_t delta);
+
+    std::filesystem::path m_path;
+    std::unique_ptr<std::fstream> m_pack;
+    std::uint64_t m_pack_size { 0 };
+    std::unordered_map<BlobRef, Entry, RefHasher, RefEqual> m_index;
+};
+} // namespace identy::io
+
+#endif
@@ -0,0 +1,452 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_blocklist.hxx"
+#include "detail/Identy_bytes.hxx"
+#include "Platform/Identy_platform_io.hxx"
+
+#include <cmath>
+
+namespace
+{
+constexpr std::size_t header_size = 64;
+constexpr std::size_t section_alignment = 64;
+constexpr std::size_t bloom_block_bytes = 64;
+constexpr std::size_t bloom_bits_per_key = 10;
+constexpr std::size_t bloom_probes = 7;
+
+// fuse construction retries with a new seed; each attempt fails with a
+// probability well below 1% once duplicates are removed
+constexpr std::size_t max_attempts = 100;
+
+constexpr std::uint32_t max_segment_length = 1u << 18;
+
+using identy::detail::store_le;
+using identy::detail::load_le;
+
+constexpr std::uint64_t murmur64(std::uint64_t h) noexcept
+{
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+std::uint64_t next_seed(std::uint64_t& state) noexcept
+{
+    // splitmix64
+    state += 0x9E3779B97F4A7C15ull;
+    auto z = state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+std::uint64_t mulhi(std::uint64_t a, std::uint64_t b) noexcept
+{
+#ifdef _MSC_VER
+    return __umulh(a, b);
+#else
+    return static_cast<std::uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#endif
+}
+
+std::size_t align_up(std::size_t value) noexcept
+{
+    return (value + section_alignment - 1) / section_alignment * section_alignment;
+}
+
+/** Shape of a binary fuse filter with three hash functions */
+struct FuseLayout
+{
+    std::uint32_t segment_length { 0 };
+    std::uint32_t segment_length_mask { 0 };
+    std::uint32_t segment_count_length { 0 };
+    std::uint32_t array_length { 0 };
+};
+
+FuseLayout fuse_layout(std::size_t size) noexcept
+{
+    constexpr std::uint32_t arity = 3;
+
+    FuseLayout layout;
+
+    // segments of 2^floor(log_3.33(n) + 2.25) slots and 12.5% slack for
+    // large sets, following Graf and Lemire, "Binary Fuse Filters" (2022)
+    auto n = static_cast<double>(std::max<std::size_t>(size, 1));
+    layout.segment_length = size == 0 ? 4 : 1u << static_cast<int>(std::floor(std::log(n) / std::log(3.33) + 2.25));
+    layout.segment_length = std::min(layout.segment_length, max_segment_length);
+    layout.segment_length_mask = layout.segment_length - 1;
+
+    auto size_factor = size <= 1 ? 0.0 : std::max(1.125, 0.875 + 0.25 * std::log(1000000.0) / std::log(n));
+    auto capacity = static_cast<std::uint32_t>(std::round(n * size_factor));
+
+    auto segment_count = (capacity + layout.segment_length - 1) / layout.segment_length;
+    segment_count = segment_count <= arity - 1 ? 1 : segment_count - (arity - 1);
+
+    layout.array_length = (segment_count + arity - 1) * layout.segment_length;
+    layout.segment_count_length = segment_count * layout.segment_length;
+
+    return layout;
+}
+
+std::uint8_t fingerprint_of(std::uint64_t hash) noexcept
+{
+    return static_cast<std::uint8_t>(hash ^ (hash >> 32));
+}
+
+/** Slot of the key with @p hash for hash function @p index (0..2) */
+std::uint32_t fuse_slot(const FuseLayout& layout, std::uint32_t index, std::uint64_t hash) noexcept
+{
+    auto slot = mulhi(hash, layout.segment_count_length) + std::uint64_t { index } * layout.segment_length;
+    auto bits = hash & ((std::uint64_t { 1 } << 36) - 1);
+    slot ^= (bits >> (36 - 18 * index)) & layout.segment_length_mask;
+
+    return static_cast<std::uint32_t>(slot);
+}
+
+std::uint32_t mod3(std::uint32_t x) noexcept
+{
+    return x > 2 ? x - 3 : x;
+}
+
+/**
+ * Peels the 3-hypergraph of @p keys (distinct) and assigns the fingerprints.
+ * @return false if no seed produced an acyclic graph
+ */
+bool populate_fuse(std::span<const std::uint64_t> keys, const FuseLayout& layout, std::uint64_t& seed,
+    std::vector<std::uint8_t>& fingerprints)
+{
+    auto size = keys.size();
+    auto capacity = layout.array_length;
+    auto segment_count = layout.segment_count_length / layout.segment_length;
+
+    std::vector<std::uint64_t> order(size + 1);
+    std::vector<std::uint32_t> alone(capacity);
+    std::vector<std::uint8_t> t2count(capacity);
+    std::vector<std::uint64_t> t2hash(capacity);
+    std::vector<std::uint8_t> reverse_h(size);
+
+    std::uint32_t block_bits = 1;
+    while((std::uint32_t { 1 } << block_bits) < segment_count) {
+        ++block_bits;
+    }
+    auto blocks = std::size_t { 1 } << block_bits;
+    std::vector<std::size_t> start(blocks);
+
+    std::uint64_t rng = 0x726B2B9D438B9D4Dull;
+    std::size_t stack_size = 0;
+
+    for(std::size_t attempt = 0;; ++attempt) {
+        if(attempt == max_attempts) {
+            return false;
+        }
+
+        seed = next_seed(rng);
+
+        std::fill(order.begin(), order.end(), 0);
+        order[size] = 1;
+        std::fill(t2count.begin(), t2count.end(), 0);
+        std::fill(t2hash.begin(), t2hash.end(), 0);
+
+        // bucket the hashes by their top bits so that the graph is built
+        // segment by segment, which keeps the counters in cache
+        for(std::size_t i = 0; i < blocks; ++i) {
+            start[i] = (i * size) >> block_bits;
+        }
+
+        for(auto key : keys) {
+            auto hash = murmur64(key + seed);
+            auto block = static_cast<std::size_t>(hash >> (64 - block_bits));
+            while(order[start[block]] != 0) {
+                block = (block + 1) & (blocks - 1);
+            }
+            order[start[block]] = hash;
+            ++start[block];
+        }
+
+        bool error = false;
+        for(std::size_t i = 0; i < size; ++i) {
+            auto hash = order[i];
+            for(std::uint32_t index = 0; index < 3; ++index) {
+                auto slot = fuse_slot(layout, index, hash);
+                t2count[slot] = static_cast<std::uint8_t>((t2count[slot] + 4) ^ index);
+                t2hash[slot] ^= hash;
+                error = error || t2count[slot] < 4;
+            }
+        }
+
+        if(error) {
+            continue;
+        }
+
+        // peel slots holding a single key until none is left
+        std::size_t queue = 0;
+        for(std::uint32_t i = 0; i < capacity; ++i) {
+            alone[queue] = i;
+            queue += (t2count[i] >> 2) == 1 ? 1 : 0;
+        }
+
+        stack_size = 0;
+        while(queue > 0) {
+            auto slot = alone[--queue];
+            if((t2count[slot] >> 2) != 1) {
+                continue;
+            }
+
+            auto hash = t2hash[slot];
+            auto found = static_cast<std::uint32_t>(t2count[slot] & 3);
+
+            reverse_h[stack_size] = static_cast<std::uint8_t>(found);
+            order[stack_size] = hash;
+            ++stack_size;
+
+            for(std::uint32_t step = 1; step <= 2; ++step) {
+                auto index = mod3(found + step);
+                auto other = fuse_slot(layout, index, hash);
+
+                alone[queue] = other;
+                queue += (t2count[other] >> 2) == 2 ? 1 : 0;
+
+                t2count[other] = static_cast<std::uint8_t>((t2count[other] - 4) ^ index);
+                t2hash[other] ^= hash;
+            }
+        }
+
+        if(stack_size == size) {
+            break;
+        }
+    }
+
+    fingerprints.assign(capacity, 0);
+
+    for(auto i = stack_size; i-- > 0;) {
+        auto hash = order[i];
+        auto found = reverse_h[i];
+
+        std::uint32_t slots[3];
+        for(std::uint32_t index = 0; index < 3; ++index) {
+            slots[index] = fuse_slot(layout, index, hash);
+        }
+
+        fingerprints[slots[found]] = static_cast<std::uint8_t>(
+            fingerprint_of(hash) ^ fingerprints[slots[mod3(found + 1)]] ^ fingerprints[slots[mod3(found + 2)]]);
+    }
+
+    return true;
+}
+
+std::size_t bloom_block_count(std::uint64_t capacity) noexcept
+{
+    return capacity == 0 ? 0 : static_cast<std::size_t>((capacity * bloom_bits_per_key + bloom_block_bytes * 8 - 1) / (bloom_block_bytes * 8));
+}
+
+/** Block of @p key and its probe bits: 9-bit positions within the 512-bit block */
+std::size_t bloom_block(std::uint64_t key, std::size_t blocks, std::uint64_t& bits) noexcept
+{
+    auto hash = murmur64(key ^ 0x424C4F4F4D424C4Bull);
+    bits = murmur64(hash);
+
+    return static_cast<std::size_t>(mulhi(hash, blocks));
+}
+} // namespace
+
+std::optional<identy::filter::Blocklist> identy::filter::Blocklist::build(std::span<const std::uint64_t> keys, std::size_t update_capacity)
+{
+    std::vector<std::uint64_t> distinct(keys.begin(), keys.end());
+    std::ranges::sort(distinct);
+    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+
+    Blocklist blocklist;
+    blocklist.m_entries = distinct.size();
+
+    if(!distinct.empty()) {
+        auto layout = fuse_layout(distinct.size());
+        if(!populate_fuse(distinct, layout, blocklist.m_seed, blocklist.m_owned_fingerprints)) {
+            return std::nullopt;
+        }
+
+        blocklist.m_segment_length = layout.segment_length;
+        blocklist.m_segment_length_mask = layout.segment_length_mask;
+        blocklist.m_segment_count_length = layout.segment_count_length;
+        blocklist.m_fingerprints = blocklist.m_owned_fingerprints;
+    }
+
+    blocklist.m_update_capacity = update_capacity;
+    blocklist.m_owned_bloom.assign(bloom_block_count(update_capacity) * bloom_block_bytes, 0);
+    blocklist.m_bloom = blocklist.m_owned_bloom;
+
+    return blocklist;
+}
+
+std::optional<identy::filter::Blocklist> identy::filter::Blocklist::open(std::span<const byte> buffer)
+{
+    if(buffer.size() < header_size || std::memcmp(buffer.data(), blocklist_magic, sizeof(blocklist_magic)) != 0) {
+        return std::nullopt;
+    }
+
+    const auto* header = buffer.data();
+    if(load_le<std::uint32_t>(header + 4) != blocklist_version) {
+        return std::nullopt;
+    }
+
+    Blocklist blocklist;
+    blocklist.m_seed = load_le<std::uint64_t>(header + 8);
+    blocklist.m_entries = load_le<std::uint64_t>(header + 16);
+    blocklist.m_segment_length = load_le<std::uint32_t>(header + 24);
+    blocklist.m_segment_count_length = load_le<std::uint32_t>(header + 28);
+
+    auto array_length = load_le<std::uint32_t>(header + 32);
+    auto bloom_blocks = load_le<std::uint32_t>(header + 36);
+    blocklist.m_updates = load_le<std::uint64_t>(header + 40);
+    blocklist.m_update_capacity = load_le<std::uint64_t>(header + 48);
+
+    if(blocklist.m_entries != 0) {
+        auto segment_length = blocklist.m_segment_length;
+        if(!std::has_single_bit(segment_length) || segment_length > max_segment_length || blocklist.m_segment_count_length == 0
+            || blocklist.m_segment_count_length % segment_length != 0
+            || std::uint64_t { blocklist.m_segment_count_length } + 2ull * segment_length > array_length) {
+            return std::nullopt;
+        }
+        blocklist.m_segment_length_mask = segment_length - 1;
+    }
+
+    // the Bloom blocks end the buffer, and contains() probes them once keys were added
+    auto bloom_offset = header_size + align_up(array_length);
+    auto bloom_size = std::size_t { bloom_blocks } * bloom_block_bytes;
+    if(bloom_offset > buffer.size() || bloom_size != buffer.size() - bloom_offset || (blocklist.m_updates != 0 && bloom_blocks == 0)) {
+        return std::nullopt;
+    }
+
+    blocklist.m_fingerprints = buffer.subspan(header_size, array_length);
+    blocklist.m_bloom = buffer.subspan(bloom_offset, bloom_size);
+
+    return blocklist;
+}
+
+std::optional<identy::filter::Blocklist> identy::filter::Blocklist::open(const std::filesystem::path& path)
+{
+    auto file = platform::MappedFile::open(path, false);
+    if(file == nullptr) {
+        return std::nullopt;
+    }
+
+    auto blocklist = open(file->bytes());
+    if(blocklist.has_value()) {
+        blocklist->m_file = std::move(file);
+    }
+
+    return blocklist;
+}
+
+identy::filter::Blocklist::Blocklist(Blocklist&& other) noexcept = default;
+identy::filter::Blocklist& identy::filter::Blocklist::operator=(Blocklist&& other) noexcept = default;
+identy::filter::Blocklist::~Blocklist() = default;
+
+bool identy::filter::Blocklist::contains(std::uint64_t key) const noexcept
+{
+    if(m_entries != 0) {
+        FuseLayout layout;
+        layout.segment_length = m_segment_length;
+        layout.segment_length_mask = m_segment_length_mask;
+        layout.segment_count_length = m_segment_count_length;
+
+        auto hash = murmur64(key + m_seed);
+        auto f = fingerprint_of(hash);
+        f ^= m_fingerprints[fuse_slot(layout, 0, hash)];
+        f ^= m_fingerprints[fuse_slot(layout, 1, hash)];
+        f ^= m_fingerprints[fuse_slot(layout, 2, hash)];
+
+        if(f == 0) {
+            return true;
+        }
+    }
+
+    if(m_updates == 0) {
+        return false;
+    }
+
+    std::uint64_t bits = 0;
+    auto blocks = m_bloom.size() / bloom_block_bytes;
+    const auto* block = m_bloom.data() + bloom_block(key, blocks, bits) * bloom_block_bytes;
+
+    for(std::size_t probe = 0; probe < bloom_probes; ++probe) {
+        auto bit = (bits >> (probe * 9)) & 511;
+        if((block[bit >> 3] & (1u << (bit & 7))) == 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool identy::filter::Blocklist::add(std::uint64_t key)
+{
+    if(m_bloom.empty()) {
+        return false;
+    }
+
+    // opened in place: copy the Bloom filter before the first write
+    if(m_owned_bloom.empty()) {
+        m_owned_bloom.assign(m_bloom.begin(), m_bloom.end());
+        m_bloom = m_owned_bloom;
+    }
+
+    std::uint64_t bits = 0;
+    auto blocks = m_owned_bloom.size() / bloom_block_bytes;
+    auto* block = m_owned_bloom.data() + bloom_block(key, blocks, bits) * bloom_block_bytes;
+
+    for(std::size_t probe = 0; probe < bloom_probes; ++probe) {
+        auto bit = (bits >> (probe * 9)) & 511;
+        block[bit >> 3] = static_cast<byte>(block[bit >> 3] | (1u << (bit & 7)));
+    }
+
+    ++m_updates;
+    return true;
+}
+
+double identy::filter::Blocklist::bits_per_entry() const noexcept
+{
+    if(m_entries == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(m_fingerprints.size()) * 8.0 / static_cast<double>(m_entries);
+}
+
+std::size_t identy::filter::Blocklist::encode(std::vector<byte>& out) const
+{
+    auto begin = out.size();
+    auto bloom_offset = header_size + align_up(m_fingerprints.size());
+    auto total = bloom_offset + m_bloom.size();
+
+    out.resize(begin + total, 0);
+    auto* header = out.data() + begin;
+
+    std::memcpy(header, blocklist_magic, sizeof(blocklist_magic));
+    store_le(header + 4, blocklist_version);
+    store_le(header + 8, m_seed);
+    store_le(header + 16, m_entries);
+    store_le(header + 24, m_segment_length);
+    store_le(header + 28, m_segment_count_length);
+    store_le(header + 32, static_cast<std::uint32_t>(m_fingerprints.size()));
+    store_le(header + 36, static_cast<std::uint32_t>(m_bloom.size() / bloom_block_bytes));
+    store_le(header + 40, m_updates);
+    store_le(header + 48, m_update_capacity);
+
+    if(!m_fingerprints.empty()) {
+        std::memcpy(header + header_size, m_fingerprints.data(), m_fingerprints.size());
+    }
+    if(!m_bloom.empty()) {
+        std::memcpy(header + bloom_offset, m_bloom.data(), m_bloom.size());
+    }
+
+    return total;
+}
+
+void identy::filter::Blocklist::write(std::ostream& stream) const
+{
+    std::vector<byte> bytes;
+    encode(bytes);
+    stream.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
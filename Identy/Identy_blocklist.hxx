@@ -0,0 +1,217 @@
+/**
+ * @file Identy_blocklist.hxx
+ * @brief Compact filter of banned fingerprints for client-side checks
+ *
+ * A Blocklist answers "is this fingerprint banned?" from a few bytes per
+ * entry instead of a full list of hashes. It is a static binary fuse filter
+ * (8-bit fingerprints, about 9 bits per entry) built once from the banned
+ * set, plus a blocked Bloom filter taking keys added later until the next
+ * rebuild.
+ *
+ * Like every filter it has false positives and no false negatives: a banned
+ * fingerprint is always reported, an unbanned one with probability 1/256
+ * (fuse part) plus roughly 1% (Bloom part, at its capacity). A positive
+ * answer should be confirmed against the authoritative list, e.g. by the
+ * license server.
+ *
+ * Lookups read three bytes of the fuse array and, when keys were added, one
+ * 64-byte Bloom block.
+ *
+ * ## File Layout (version 1)
+ *
+ * The serialized form is meant to be mapped and queried in place
+ * (open(path)). All header fields are little-endian.
+ *
+ * | Offset | Size | Content                                           |
+ * |--------|------|---------------------------------------------------|
+ * | 0      | 4    | Magic "IDBL"                                      |
+ * | 4      | 4    | Version                                           |
+ * | 8      | 8    | Fuse seed                                         |
+ * | 16     | 8    | Keys in the fuse filter                           |
+ * | 24     | 4    | Segment length                                    |
+ * | 28     | 4    | Segment count * segment length                    |
+ * | 32     | 4    | Fuse array length                                 |
+ * | 36     | 4    | Bloom blocks of 64 bytes                          |
+ * | 40     | 8    | Keys added to the Bloom filter                    |
+ * | 48     | 8    | Bloom capacity in keys                            |
+ * | 56     | 8    | Reserved                                          |
+ * | 64     | ...  | Fuse array, zero-padded to a multiple of 64 bytes |
+ * | ...    | ...  | Bloom blocks, up to the end of the buffer         |
+ *
+ * open() rejects a buffer whose size does not match the Bloom block count,
+ * or that counts added keys without any Bloom block.
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_BLOCKLIST_H
+#define UNC_IDENTY_BLOCKLIST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include "Identy_hash_base.hxx"
+
+namespace identy::platform
+{
+class MappedFile;
+} // namespace identy::platform
+
+namespace identy::filter
+{
+/** @brief Magic bytes at the beginning of a blocklist file ("IDBL") */
+constexpr byte blocklist_magic[4] = { 'I', 'D', 'B', 'L' };
+
+/** @brief Current blocklist file version */
+constexpr std::uint32_t blocklist_version = 1;
+
+/**
+ * @brief Filter key of a fingerprint: its first eight bytes, little-endian
+ *
+ * Fingerprints are uniformly distributed hash values, so any eight bytes
+ * make a good key; shorter hashes are zero-extended.
+ */
+template<std::size_t N>
+constexpr std::uint64_t key_of(const hs::Hash<N>& hash) noexcept
+{
+    std::uint64_t key = 0;
+    for(std::size_t i = 0; i < N && i < sizeof(key); ++i) {
+        key |= static_cast<std::uint64_t>(hash.buffer[i]) << (i * 8);
+    }
+    return key;
+}
+
+/**
+ * @brief Binary fuse filter of banned fingerprints with a Bloom filter for updates
+ *
+ * Move-only. A blocklist built in memory owns its arrays; one opened from a
+ * buffer or file reads them in place and copies the Bloom filter on the
+ * first add(). contains() may run concurrently with other contains() calls,
+ * not with add().
+ */
+class Blocklist final
+{
+public:
+    /**
+     * @brief Builds the filter of a key set
+     *
+     * @param keys Keys, duplicates allowed
+     * @param update_capacity Keys add() may take before the Bloom filter
+     *        exceeds its 1% false positive target (about 10 bits each)
+     * @return Blocklist, std::nullopt if no fuse construction succeeded
+     *         (practically impossible for distinct 64-bit keys)
+     */
+    static std::optional<Blocklist> build(std::span<const std::uint64_t> keys, std::size_t update_capacity = 0);
+
+    /** @brief Builds the filter of a set of fingerprints, see build(std::span<const std::uint64_t>, std::size_t) */
+    template<std::size_t N>
+    static std::optional<Blocklist> build(std::span<const hs::Hash<N>> hashes, std::size_t update_capacity = 0);
+
+    /**
+     * @brief Reads a serialized blocklist in place
+     *
+     * @param buffer Complete blocklist file; must outlive the blocklist
+     * @return Blocklist, std::nullopt on a bad magic, unknown version or
+     *         inconsistent sizes
+     */
+    static std::optional<Blocklist> open(std::span<const byte> buffer);
+
+    /** @brief Maps a blocklist file, see open(std::span<const byte>) */
+    static std::optional<Blocklist> open(const std::filesystem::path& path);
+
+    Blocklist(Blocklist&& other) noexcept;
+    Blocklist& operator=(Blocklist&& other) noexcept;
+    ~Blocklist();
+
+    /** @brief Whether @p key may be in the set; never false for a key that is */
+    bool contains(std::uint64_t key) const noexcept;
+
+    /** @copydoc contains(std::uint64_t) const */
+    template<std::size_t N>
+    bool contains(const hs::Hash<N>& hash) const noexcept
+    {
+        return contains(key_of(hash));
+    }
+
+    /**
+     * @brief Adds a key to the Bloom filter
+     * @return false if the blocklist was built without update capacity
+     */
+    bool add(std::uint64_t key);
+
+    /** @copydoc add(std::uint64_t) */
+    template<std::size_t N>
+    bool add(const hs::Hash<N>& hash)
+    {
+        return add(key_of(hash));
+    }
+
+    /** @brief Distinct keys in the fuse filter */
+    std::uint64_t size() const noexcept
+    {
+        return m_entries;
+    }
+
+    /** @brief Keys added since the build */
+    std::uint64_t updates() const noexcept
+    {
+        return m_updates;
+    }
+
+    /** @brief Keys add() was sized for; beyond it the false positive rate grows */
+    std::uint64_t update_capacity() const noexcept
+    {
+        return m_update_capacity;
+    }
+
+    /** @brief Size of the fuse array in bits per key */
+    double bits_per_entry() const noexcept;
+
+    /**
+     * @brief Appends the serialized blocklist to @p out
+     * @return Number of bytes appended
+     */
+    std::size_t encode(std::vector<byte>& out) const;
+
+    /** @brief Writes the serialized blocklist to @p stream */
+    void write(std::ostream& stream) const;
+
+private:
+    Blocklist() = default;
+
+    std::uint64_t m_seed { 0 };
+    std::uint64_t m_entries { 0 };
+    std::uint32_t m_segment_length { 0 };
+    std::uint32_t m_segment_length_mask { 0 };
+    std::uint32_t m_segment_count_length { 0 };
+    std::span<const std::uint8_t> m_fingerprints;
+
+    std::span<const byte> m_bloom;
+    std::uint64_t m_updates { 0 };
+    std::uint64_t m_update_capacity { 0 };
+
+    std::vector<std::uint8_t> m_owned_fingerprints;
+    std::vector<byte> m_owned_bloom;
+    std::unique_ptr<platform::MappedFile> m_file;
+};
+} // namespace identy::filter
+
+template<std::size_t N>
+std::optional<identy::filter::Blocklist> identy::filter::Blocklist::build(std::span<const hs::Hash<N>> hashes, std::size_t update_capacity)
+{
+    std::vector<std::uint64_t> keys;
+    keys.reserve(hashes.size());
+    for(const auto& hash : hashes) {
+        keys.push_back(key_of(hash));
+    }
+
+    return build(keys, update_capacity);
+}
+
+#endif
@@ -0,0 +1,283 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_cache.hxx"
+
+#include <random>
+
+#include "Identy_io.hxx"
+#include "Identy_strings.hxx"
+#include "Identy_tier.hxx"
+#include "detail/Identy_bytes.hxx"
+#include "Platform/Identy_platform_source.hxx"
+
+namespace
+{
+constexpr std::size_t header_version_offset = 4;
+constexpr std::size_t header_snapshot_size_offset = 8;
+constexpr std::size_t header_block_names_offset = 12;
+constexpr std::size_t header_dmi_size_offset = 16;
+constexpr std::size_t header_dmi_mtime_offset = 24;
+constexpr std::size_t header_block_mtime_offset = 32;
+constexpr std::size_t header_boot_id_offset = 40;
+constexpr std::size_t header_boot_id_size = 40;
+constexpr std::size_t header_fingerprint_offset = 80;
+constexpr std::size_t header_snapshot_crc_offset = 112;
+constexpr std::size_t header_tier_offset = 116;
+constexpr std::size_t header_crc_offset = 120;
+constexpr std::size_t header_size = 128;
+
+const std::filesystem::path boot_id_path = "/proc/sys/kernel/random/boot_id";
+const std::filesystem::path dmi_table_path = "/sys/firmware/dmi/tables/DMI";
+const std::filesystem::path block_path = "/sys/block";
+
+using identy::detail::store_le;
+using identy::detail::load_le;
+using identy::detail::crc32_update;
+using identy::detail::crc32;
+
+std::filesystem::path cache_path(const std::filesystem::path& directory)
+{
+    return directory / identy::cache::cache_file_name;
+}
+
+struct Entry
+{
+    identy::cache::CacheKey key;
+    identy::hs::Hash256 fingerprint {};
+    std::uint32_t snapshot_size { 0 };
+    std::uint32_t snapshot_crc { 0 };
+};
+
+std::optional<Entry> parse_header(std::span<const identy::byte> header)
+{
+    if(header.size() < header_size || std::memcmp(header.data(), identy::cache::cache_magic, sizeof(identy::cache::cache_magic)) != 0
+        || load_le<std::uint32_t>(header.data() + header_version_offset) != identy::cache::cache_version
+        || load_le<std::uint32_t>(header.data() + header_crc_offset) != crc32(header.first(header_crc_offset))) {
+        return std::nullopt;
+    }
+
+    Entry entry;
+    entry.snapshot_size = load_le<std::uint32_t>(header.data() + header_snapshot_size_offset);
+    entry.snapshot_crc = load_le<std::uint32_t>(header.data() + header_snapshot_crc_offset);
+
+    entry.key.block_names_crc = load_le<std::uint32_t>(header.data() + header_block_names_offset);
+    entry.key.dmi_size = load_le<std::uint64_t>(header.data() + header_dmi_size_offset);
+    entry.key.dmi_mtime_ns = load_le<std::int64_t>(header.data() + header_dmi_mtime_offset);
+    entry.key.block_mtime_ns = load_le<std::int64_t>(header.data() + header_block_mtime_offset);
+    entry.key.tier = static_cast<identy::SmbiosTier>(header[header_tier_offset]);
+
+    const auto* boot_id = reinterpret_cast<const char*>(header.data() + header_boot_id_offset);
+    entry.key.boot_id.assign(boot_id, std::find(boot_id, boot_id + header_boot_id_size, '\0'));
+
+    std::memcpy(entry.fingerprint.buffer, header.data() + header_fingerprint_offset, sizeof(entry.fingerprint.buffer));
+
+    return entry;
+}
+
+/**
+ * Reads the header, and the snapshot if requested, of a cache file whose key
+ * matches the running system.
+ */
+std::optional<Entry> read_valid(const std::filesystem::path& directory, std::vector<identy::byte>* snapshot)
+{
+    auto key = identy::cache::current_key();
+    if(!key.has_value()) {
+        return std::nullopt;
+    }
+
+    std::ifstream file(cache_path(directory), std::ios::binary);
+    if(!file.is_open()) {
+        return std::nullopt;
+    }
+
+    std::array<identy::byte, header_size> header {};
+    if(!file.read(reinterpret_cast<char*>(header.data()), header.size())) {
+        return std::nullopt;
+    }
+
+    auto entry = parse_header(header);
+    if(!entry.has_value() || entry->key != *key) {
+        return std::nullopt;
+    }
+
+    if(snapshot != nullptr) {
+        snapshot->resize(entry->snapshot_size);
+        if(!file.read(reinterpret_cast<char*>(snapshot->data()), static_cast<std::streamsize>(snapshot->size()))
+            || crc32(*snapshot) != entry->snapshot_crc) {
+            return std::nullopt;
+        }
+    }
+
+    return entry;
+}
+
+bool write_entry(const std::filesystem::path& directory, const identy::cache::CacheKey& key, const identy::MotherboardEx& mb,
+    const identy::hs::Hash256& fingerprint)
+{
+    if(key.boot_id.size() > header_boot_id_size) {
+        return false;
+    }
+
+    std::vector<identy::byte> buffer(header_size);
+    if(identy::io::encode_binary(buffer, mb) == 0) {
+        return false;
+    }
+
+    auto snapshot = std::span<const identy::byte>(buffer).subspan(header_size);
+    auto* header = buffer.data();
+
+    std::memcpy(header, identy::cache::cache_magic, sizeof(identy::cache::cache_magic));
+    store_le(header + header_version_offset, identy::cache::cache_version);
+    store_le(header + header_snapshot_size_offset, static_cast<std::uint32_t>(snapshot.size()));
+    store_le(header + header_block_names_offset, key.block_names_crc);
+    store_le(header + header_dmi_size_offset, key.dmi_size);
+    store_le(header + header_dmi_mtime_offset, key.dmi_mtime_ns);
+    store_le(header + header_block_mtime_offset, key.block_mtime_ns);
+    std::memcpy(header + header_boot_id_offset, key.boot_id.data(), key.boot_id.size());
+    std::memcpy(header + header_fingerprint_offset, fingerprint.buffer, sizeof(fingerprint.buffer));
+    store_le(header + header_snapshot_crc_offset, crc32(snapshot));
+    header[header_tier_offset] = static_cast<identy::byte>(key.tier);
+    store_le(header + header_crc_offset, crc32({ header, header_crc_offset }));
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+
+    // write aside and rename, so concurrent readers see either file whole
+    auto target = cache_path(directory);
+    auto temporary = target;
+    temporary += std::format(".tmp{:08x}", std::random_device {}());
+
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if(!file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()))) {
+            file.close();
+            std::filesystem::remove(temporary, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temporary, target, ec);
+    if(ec) {
+        std::filesystem::remove(temporary, ec);
+        return false;
+    }
+
+    return true;
+}
+} // namespace
+
+std::optional<identy::cache::CacheKey> identy::cache::current_key()
+{
+    auto& source = platform::source();
+
+    auto boot_id_raw = source.read_file(boot_id_path);
+    if(!boot_id_raw.has_value()) {
+        return std::nullopt;
+    }
+
+    auto boot_id = strings::trim_whitespace({ reinterpret_cast<const char*>(boot_id_raw->data()), boot_id_raw->size() });
+
+    auto dmi = source.stat(dmi_table_path);
+    if(boot_id.empty() || !dmi.has_value()) {
+        return std::nullopt;
+    }
+
+    CacheKey key;
+    key.boot_id = boot_id;
+    key.dmi_size = dmi->size;
+    key.dmi_mtime_ns = dmi->mtime_ns;
+
+    // the same tables read with other privileges give another snapshot
+    key.tier = tier::access().best();
+
+    if(auto block = source.stat(block_path)) {
+        key.block_mtime_ns = block->mtime_ns;
+    }
+
+    // sysfs directory times rarely move on hot-plug, the entry names do
+    if(auto names = source.list_dir(block_path)) {
+        std::uint32_t crc = 0xFFFFFFFFu;
+        for(const auto& name : *names) {
+            crc = crc32_update(crc, { reinterpret_cast<const byte*>(name.c_str()), name.size() + 1 });
+        }
+        key.block_names_crc = crc ^ 0xFFFFFFFFu;
+    }
+
+    return key;
+}
+
+std::optional<identy::hs::Hash256> identy::cache::load_fingerprint(const std::filesystem::path& directory)
+{
+    auto entry = read_valid(directory, nullptr);
+    if(!entry.has_value()) {
+        return std::nullopt;
+    }
+
+    return entry->fingerprint;
+}
+
+std::optional<identy::MotherboardEx> identy::cache::load_snapshot(const std::filesystem::path& directory)
+{
+    std::vector<byte> snapshot;
+    if(!read_valid(directory, &snapshot).has_value()) {
+        return std::nullopt;
+    }
+
+    auto reader = io::read_binary(snapshot);
+    if(!reader.has_value() || reader->kind() != io::SnapshotKind::MotherboardEx) {
+        return std::nullopt;
+    }
+
+    return reader->to_motherboard_ex();
+}
+
+bool identy::cache::store(const std::filesystem::path& directory, const MotherboardEx& mb)
+{
+    auto key = current_key();
+    if(!key.has_value()) {
+        return false;
+    }
+
+    return write_entry(directory, *key, mb, hs::hash(mb));
+}
+
+identy::hs::Hash256 identy::cache::cached_fingerprint(const std::filesystem::path& directory)
+{
+    if(auto fingerprint = load_fingerprint(directory)) {
+        return *fingerprint;
+    }
+
+    // the key is taken before collecting: a change during collection makes
+    // the next process miss instead of trusting a stale entry
+    auto key = current_key();
+    auto mb = snap_motherboard_ex();
+    auto fingerprint = hs::hash(mb);
+
+    if(key.has_value()) {
+        write_entry(directory, *key, mb, fingerprint);
+    }
+
+    return fingerprint;
+}
+
+identy::MotherboardEx identy::cache::cached_snapshot(const std::filesystem::path& directory)
+{
+    if(auto snapshot = load_snapshot(directory)) {
+        return std::move(*snapshot);
+    }
+
+    auto key = current_key();
+    auto mb = snap_motherboard_ex();
+
+    if(key.has_value()) {
+        write_entry(directory, *key, mb, hs::hash(mb));
+    }
+
+    return mb;
+}
+
+void identy::cache::invalidate(const std::filesystem::path& directory)
+{
+    std::error_code ec;
+    std::filesystem::remove(cache_path(directory), ec);
+}
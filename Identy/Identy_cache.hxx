@@ -0,0 +1,146 @@
+/**
+ * @file Identy_cache.hxx
+ * @brief Persistent fingerprint cache for short-lived processes
+ *
+ * Collecting and hashing the extended snapshot dominates the startup of
+ * short-lived tools. The cache stores the fingerprint and the binary snapshot
+ * in a file under a caller-chosen directory, keyed by invariants that are far
+ * cheaper to read than the hardware itself:
+ *
+ * - /proc/sys/kernel/random/boot_id, which changes on every boot;
+ * - size and modification time of /sys/firmware/dmi/tables/DMI;
+ * - modification time and entry names of /sys/block;
+ * - the SMBIOS tier the process reaches (see tier::access()), so an entry
+ *   collected unprivileged is not served once the tables or identyd become
+ *   readable.
+ *
+ * A process whose key matches the stored one gets the fingerprint from one
+ * small read of the file header; any mismatch, missing or corrupted file
+ * falls back to full collection and rewrites the cache:
+ *
+ * @code
+ * auto fingerprint = identy::cache::cached_fingerprint(cache_dir);
+ * @endcode
+ *
+ * The cache is opt-in and never used implicitly by snap_motherboard_ex().
+ * Where the invariants are unavailable (Windows, replayed captures) the
+ * functions always collect and never write.
+ *
+ * ## File Layout (version 2)
+ *
+ * | Offset | Size | Content                                   |
+ * |--------|------|-------------------------------------------|
+ * | 0      | 4    | Magic "IDFC"                              |
+ * | 4      | 4    | Version                                   |
+ * | 8      | 4    | Snapshot size                             |
+ * | 12     | 4    | CRC-32 of the /sys/block entry names      |
+ * | 16     | 8    | DMI table size                            |
+ * | 24     | 8    | DMI table mtime (ns)                      |
+ * | 32     | 8    | /sys/block mtime (ns)                     |
+ * | 40     | 40   | boot_id, zero padded                      |
+ * | 80     | 32   | Fingerprint (hs::hash() of the snapshot)  |
+ * | 112    | 4    | CRC-32 of the snapshot                    |
+ * | 116    | 1    | SMBIOS tier                               |
+ * | 117    | 3    | Reserved                                  |
+ * | 120    | 4    | CRC-32 of bytes 0..119                    |
+ * | 124    | 4    | Reserved                                  |
+ * | 128    | n    | Binary snapshot (io::encode_binary())     |
+ *
+ * All integers are little-endian. The file is replaced atomically.
+ *
+ * @warning The file contains drive serials and the SMBIOS tables; place it in
+ *          a directory only trusted users can write to.
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_CACHE_H
+#define UNC_IDENTY_CACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "Identy_hash.hxx"
+#include "Identy_hwid.hxx"
+
+namespace identy::cache
+{
+/** @brief Magic bytes at the beginning of a cache file ("IDFC") */
+constexpr byte cache_magic[4] = { 'I', 'D', 'F', 'C' };
+
+/** @brief Current cache file version */
+constexpr std::uint32_t cache_version = 2;
+
+/** @brief Name of the cache file inside the cache directory */
+inline constexpr std::string_view cache_file_name = "fingerprint.idfc";
+
+/**
+ * @brief Invariants validating a cache entry
+ */
+struct CacheKey
+{
+    std::string boot_id;
+    std::uint64_t dmi_size { 0 };
+    std::int64_t dmi_mtime_ns { 0 };
+    std::int64_t block_mtime_ns { 0 };
+    std::uint32_t block_names_crc { 0 };
+    SmbiosTier tier { SmbiosTier::None };
+
+    bool operator==(const CacheKey&) const = default;
+};
+
+/**
+ * @brief Reads the invariants of the running system
+ *
+ * Reads go through the current hardware source, so ScopedSysfsRoot redirects
+ * them as well.
+ *
+ * @return Key, std::nullopt if the boot ID or the DMI table is unavailable
+ */
+std::optional<CacheKey> current_key();
+
+/**
+ * @brief Reads the cached fingerprint if it is still valid
+ * @param directory Cache directory
+ * @return Fingerprint, std::nullopt on a miss
+ */
+std::optional<hs::Hash256> load_fingerprint(const std::filesystem::path& directory);
+
+/**
+ * @brief Reads the cached snapshot if it is still valid
+ * @param directory Cache directory
+ * @return Snapshot, std::nullopt on a miss
+ */
+std::optional<MotherboardEx> load_snapshot(const std::filesystem::path& directory);
+
+/**
+ * @brief Writes a snapshot and its fingerprint to the cache
+ *
+ * @param directory Cache directory, created if missing
+ * @param mb Snapshot taken on this system
+ * @return false if the invariants are unavailable or the file cannot be written
+ */
+bool store(const std::filesystem::path& directory, const MotherboardEx& mb);
+
+/**
+ * @brief Fingerprint from the cache, collected and cached on a miss
+ *
+ * Equals hs::hash(snap_motherboard_ex()) as long as the hardware is unchanged.
+ */
+hs::Hash256 cached_fingerprint(const std::filesystem::path& directory);
+
+/**
+ * @brief Snapshot from the cache, collected and cached on a miss
+ */
+MotherboardEx cached_snapshot(const std::filesystem::path& directory);
+
+/**
+ * @brief Removes the cache file
+ */
+void invalidate(const std::filesystem::path& directory);
+} // namespace identy::cache
+
+#endif
@@ -0,0 +1,541 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_capture.hxx"
+
+#include "Identy_vm.hxx"
+#include "detail/Identy_bytes.hxx"
+#include "Platform/Identy_platform_source.hxx"
+
+namespace
+{
+constexpr std::size_t header_version_offset = 4;
+constexpr std::size_t header_cpuid_count_offset = 8;
+constexpr std::size_t header_record_count_offset = 12;
+constexpr std::size_t header_size = 16;
+
+constexpr std::size_t cpuid_record_size = 24;
+constexpr std::size_t input_record_header_size = 8;
+
+using identy::detail::store_le;
+using identy::detail::load_le;
+
+std::span<const identy::byte> as_bytes(std::string_view string) noexcept
+{
+    return { reinterpret_cast<const identy::byte*>(string.data()), string.size() };
+}
+
+std::string path_key(const std::filesystem::path& path)
+{
+    return path.generic_string();
+}
+
+std::string firmware_key(identy::dword provider, identy::dword id)
+{
+    constexpr char digits[] = "0123456789abcdef";
+
+    std::string key(17, '/');
+
+    for(std::size_t i = 0; i < 8; ++i) {
+        key[7 - i] = digits[(provider >> (i * 4)) & 0xF];
+        key[16 - i] = digits[(id >> (i * 4)) & 0xF];
+    }
+
+    return key;
+}
+
+bool valid_kind(std::uint8_t kind) noexcept
+{
+    return kind >= static_cast<std::uint8_t>(identy::CaptureRecordKind::File)
+        && kind <= static_cast<std::uint8_t>(identy::CaptureRecordKind::FirmwareTable);
+}
+} // namespace
+
+namespace
+{
+/**
+ * @brief Forwards to another source and records every result
+ *
+ * Only successful reads are recorded; anything absent from the bundle reads
+ * as missing on replay.
+ */
+class RecordingSource final : public identy::platform::HardwareSource
+{
+public:
+    RecordingSource(identy::platform::HardwareSource& next, identy::CaptureBundle& bundle)
+        : m_next(next)
+        , m_bundle(bundle)
+    {
+    }
+
+    void cpuid(identy::register_32 registers[4], identy::register_32 leaf, identy::register_32 subleaf) override
+    {
+        m_next.cpuid(registers, leaf, subleaf);
+        m_bundle.add_cpuid(leaf, subleaf, registers);
+    }
+
+    std::optional<std::vector<identy::byte>> read_file(const std::filesystem::path& path) override
+    {
+        auto data = m_next.read_file(path);
+        if(data.has_value()) {
+            m_bundle.add_file(path, std::span<const identy::byte>(*data));
+        }
+        return data;
+    }
+
+    std::optional<std::vector<std::string>> list_dir(const std::filesystem::path& path) override
+    {
+        auto names = m_next.list_dir(path);
+        if(names.has_value()) {
+            m_bundle.add_directory(path, *names);
+        }
+        return names;
+    }
+
+    std::optional<std::filesystem::path> read_link(const std::filesystem::path& path) override
+    {
+        auto target = m_next.read_link(path);
+        if(target.has_value()) {
+            m_bundle.add_link(path, *target);
+        }
+        return target;
+    }
+
+    bool exists(const std::filesystem::path& path) override
+    {
+        bool result = m_next.exists(path);
+        if(result) {
+            m_bundle.add_existing(path);
+        }
+        return result;
+    }
+
+    std::optional<identy::platform::FileStamp> stat(const std::filesystem::path& path) override
+    {
+        // timestamps are not part of a capture, only the cache asks for them
+        return m_next.stat(path);
+    }
+
+    std::optional<std::vector<identy::byte>> firmware_table(identy::dword provider, identy::dword id) override
+    {
+        auto table = m_next.firmware_table(provider, id);
+        if(table.has_value()) {
+            m_bundle.add_firmware_table(provider, id, *table);
+        }
+        return table;
+    }
+
+private:
+    identy::platform::HardwareSource& m_next;
+    identy::CaptureBundle& m_bundle;
+};
+
+/**
+ * @brief Answers every read from a bundle
+ */
+class ReplaySource final : public identy::platform::HardwareSource
+{
+public:
+    explicit ReplaySource(const identy::CaptureBundle& bundle)
+        : m_bundle(bundle)
+    {
+    }
+
+    void cpuid(identy::register_32 registers[4], identy::register_32 leaf, identy::register_32 subleaf) override
+    {
+        if(!m_bundle.find_cpuid(leaf, subleaf, registers)) {
+            std::fill_n(registers, 4, 0);
+        }
+    }
+
+    std::optional<std::vector<identy::byte>> read_file(const std::filesystem::path& path) override
+    {
+        auto data = m_bundle.find(identy::CaptureRecordKind::File, path_key(path));
+        if(!data.has_value()) {
+            return std::nullopt;
+        }
+        return std::vector<identy::byte>(data->begin(), data->end());
+    }
+
+    std::optional<std::vector<std::string>> list_dir(const std::filesystem::path& path) override
+    {
+        auto data = m_bundle.find(identy::CaptureRecordKind::Directory, path_key(path));
+        if(!data.has_value()) {
+            return std::nullopt;
+        }
+
+        std::vector<std::string> names;
+        std::string_view rest { reinterpret_cast<const char*>(data->data()), data->size() };
+
+        while(!rest.empty()) {
+            auto end = std::min(rest.find('\0'), rest.size());
+            names.emplace_back(rest.substr(0, end));
+            rest.remove_prefix(std::min(end + 1, rest.size()));
+        }
+
+        return names;
+    }
+
+    std::optional<std::filesystem::path> read_link(const std::filesystem::path& path) override
+    {
+        auto data = m_bundle.find(identy::CaptureRecordKind::Link, path_key(path));
+        if(!data.has_value()) {
+            return std::nullopt;
+        }
+        return std::filesystem::path(std::string_view { reinterpret_cast<const char*>(data->data()), data->size() });
+    }
+
+    bool exists(const std::filesystem::path& path) override
+    {
+        auto key = path_key(path);
+
+        return m_bundle.find(identy::CaptureRecordKind::Exists, key).has_value()
+            || m_bundle.find(identy::CaptureRecordKind::File, key).has_value()
+            || m_bundle.find(identy::CaptureRecordKind::Directory, key).has_value()
+            || m_bundle.find(identy::CaptureRecordKind::Link, key).has_value();
+    }
+
+    std::optional<identy::platform::FileStamp> stat(const std::filesystem::path&) override
+    {
+        // bundles carry no timestamps; without them the fingerprint cache is bypassed
+        return std::nullopt;
+    }
+
+    std::optional<std::vector<identy::byte>> firmware_table(identy::dword provider, identy::dword id) override
+    {
+        auto data = m_bundle.find(identy::CaptureRecordKind::FirmwareTable, firmware_key(provider, id));
+        if(!data.has_value()) {
+            return std::nullopt;
+        }
+        return std::vector<identy::byte>(data->begin(), data->end());
+    }
+
+private:
+    const identy::CaptureBundle& m_bundle;
+};
+
+/**
+ * @brief Reads files below a root directory, everything else from @p next
+ */
+class RootedSource final : public identy::platform::HardwareSource
+{
+public:
+    RootedSource(std::filesystem::path root, identy::platform::HardwareSource& next)
+        : m_root(std::move(root))
+        , m_next(next)
+    {
+    }
+
+    void cpuid(identy::register_32 registers[4], identy::register_32 leaf, identy::register_32 subleaf) override
+    {
+        m_next.cpuid(registers, leaf, subleaf);
+    }
+
+    std::optional<std::vector<identy::byte>> read_file(const std::filesystem::path& path) override
+    {
+        return m_next.read_file(rooted(path));
+    }
+
+    std::optional<std::vector<std::string>> list_dir(const std::filesystem::path& path) override
+    {
+        return m_next.list_dir(rooted(path));
+    }
+
+    std::optional<std::filesystem::path> read_link(const std::filesystem::path& path) override
+    {
+        return m_next.read_link(rooted(path));
+    }
+
+    bool exists(const std::filesystem::path& path) override
+    {
+        return m_next.exists(rooted(path));
+    }
+
+    std::optional<identy::platform::FileStamp> stat(const std::filesystem::path& path) override
+    {
+        return m_next.stat(rooted(path));
+    }
+
+    std::optional<std::vector<identy::byte>> firmware_table(identy::dword provider, identy::dword id) override
+    {
+        return m_next.firmware_table(provider, id);
+    }
+
+private:
+    std::filesystem::path rooted(const std::filesystem::path& path) const
+    {
+        return m_root / path.relative_path();
+    }
+
+    std::filesystem::path m_root;
+    identy::platform::HardwareSource& m_next;
+};
+} // namespace
+
+std::optional<identy::CaptureBundle> identy::CaptureBundle::decode(std::span<const byte> buffer)
+{
+    if(buffer.size() < header_size || std::memcmp(buffer.data(), capture_magic, sizeof(capture_magic)) != 0) {
+        return std::nullopt;
+    }
+
+    const byte* data = buffer.data();
+
+    if(load_le<std::uint32_t>(data + header_version_offset) != capture_version) {
+        return std::nullopt;
+    }
+
+    auto cpuid_count = load_le<std::uint32_t>(data + header_cpuid_count_offset);
+    auto record_count = load_le<std::uint32_t>(data + header_record_count_offset);
+
+    std::size_t offset = header_size;
+
+    if((buffer.size() - offset) / cpuid_record_size < cpuid_count) {
+        return std::nullopt;
+    }
+
+    CaptureBundle bundle;
+    bundle.m_cpuid.reserve(cpuid_count);
+
+    for(std::uint32_t i = 0; i < cpuid_count; ++i, offset += cpuid_record_size) {
+        CpuidRecord record;
+        record.leaf = load_le<register_32>(data + offset);
+        record.subleaf = load_le<register_32>(data + offset + 4);
+
+        for(std::size_t r = 0; r < 4; ++r) {
+            record.registers[r] = load_le<register_32>(data + offset + 8 + r * 4);
+        }
+
+        bundle.m_cpuid.push_back(record);
+    }
+
+    if((buffer.size() - offset) / input_record_header_size < record_count) {
+        return std::nullopt;
+    }
+
+    bundle.m_records.reserve(record_count);
+
+    for(std::uint32_t i = 0; i < record_count; ++i) {
+        if(buffer.size() - offset < input_record_header_size) {
+            return std::nullopt;
+        }
+
+        auto kind = data[offset];
+        auto key_size = load_le<std::uint16_t>(data + offset + 2);
+        auto data_size = load_le<std::uint32_t>(data + offset + 4);
+        offset += input_record_header_size;
+
+        if(!valid_kind(kind) || buffer.size() - offset < static_cast<std::size_t>(key_size) + data_size) {
+            return std::nullopt;
+        }
+
+        InputRecord record;
+        record.kind = static_cast<CaptureRecordKind>(kind);
+        record.key.assign(reinterpret_cast<const char*>(data + offset), key_size);
+        offset += key_size;
+        record.data.assign(data + offset, data + offset + data_size);
+        offset += data_size;
+
+        bundle.m_records.push_back(std::move(record));
+    }
+
+    // Lookups binary search; hand-made bundles are not required to be sorted
+    std::ranges::stable_sort(bundle.m_cpuid, {}, [](const CpuidRecord& r) { return std::pair(r.leaf, r.subleaf); });
+    std::ranges::stable_sort(bundle.m_records, {}, [](const InputRecord& r) { return std::tie(r.kind, r.key); });
+
+    return bundle;
+}
+
+std::size_t identy::CaptureBundle::encode(std::vector<byte>& out) const
+{
+    std::size_t size = header_size + m_cpuid.size() * cpuid_record_size;
+
+    for(const auto& record : m_records) {
+        size += input_record_header_size + record.key.size() + record.data.size();
+    }
+
+    auto start = out.size();
+    out.resize(start + size);
+
+    byte* dst = out.data() + start;
+
+    std::memcpy(dst, capture_magic, sizeof(capture_magic));
+    store_le<std::uint32_t>(dst + header_version_offset, capture_version);
+    store_le<std::uint32_t>(dst + header_cpuid_count_offset, static_cast<std::uint32_t>(m_cpuid.size()));
+    store_le<std::uint32_t>(dst + header_record_count_offset, static_cast<std::uint32_t>(m_records.size()));
+    dst += header_size;
+
+    for(const auto& record : m_cpuid) {
+        store_le<register_32>(dst, record.leaf);
+        store_le<register_32>(dst + 4, record.subleaf);
+
+        for(std::size_t r = 0; r < 4; ++r) {
+            store_le<register_32>(dst + 8 + r * 4, record.registers[r]);
+        }
+
+        dst += cpuid_record_size;
+    }
+
+    for(const auto& record : m_records) {
+        dst[0] = static_cast<byte>(record.kind);
+        dst[1] = 0;
+        store_le<std::uint16_t>(dst + 2, static_cast<std::uint16_t>(record.key.size()));
+        store_le<std::uint32_t>(dst + 4, static_cast<std::uint32_t>(record.data.size()));
+        dst += input_record_header_size;
+
+        std::memcpy(dst, record.key.data(), record.key.size());
+        dst += record.key.size();
+
+        if(!record.data.empty()) {
+            std::memcpy(dst, record.data.data(), record.data.size());
+            dst += record.data.size();
+        }
+    }
+
+    return size;
+}
+
+void identy::CaptureBundle::write(std::ostream& stream) const
+{
+    std::vector<byte> buffer;
+    encode(buffer);
+    stream.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+}
+
+void identy::CaptureBundle::add_cpuid(register_32 leaf, register_32 subleaf, const register_32 registers[4])
+{
+    auto key = std::pair(leaf, subleaf);
+    auto projection = [](const CpuidRecord& r) { return std::pair(r.leaf, r.subleaf); };
+
+    auto it = std::ranges::lower_bound(m_cpuid, key, {}, projection);
+
+    if(it == m_cpuid.end() || projection(*it) != key) {
+        it = m_cpuid.insert(it, CpuidRecord { leaf, subleaf });
+    }
+
+    std::copy_n(registers, 4, it->registers);
+}
+
+void identy::CaptureBundle::add_file(const std::filesystem::path& path, std::span<const byte> contents)
+{
+    add_record(CaptureRecordKind::File, path_key(path), contents);
+}
+
+void identy::CaptureBundle::add_file(const std::filesystem::path& path, std::string_view contents)
+{
+    add_record(CaptureRecordKind::File, path_key(path), as_bytes(contents));
+}
+
+void identy::CaptureBundle::add_directory(const std::filesystem::path& path, std::vector<std::string> names)
+{
+    std::ranges::sort(names);
+
+    std::string joined;
+
+    for(const auto& name : names) {
+        if(!joined.empty()) {
+            joined.push_back('\0');
+        }
+        joined += name;
+    }
+
+    add_record(CaptureRecordKind::Directory, path_key(path), as_bytes(joined));
+}
+
+void identy::CaptureBundle::add_link(const std::filesystem::path& path, const std::filesystem::path& target)
+{
+    add_record(CaptureRecordKind::Link, path_key(path), as_bytes(path_key(target)));
+}
+
+void identy::CaptureBundle::add_existing(const std::filesystem::path& path)
+{
+    add_record(CaptureRecordKind::Exists, path_key(path), {});
+}
+
+void identy::CaptureBundle::add_firmware_table(dword provider, dword id, std::span<const byte> contents)
+{
+    add_record(CaptureRecordKind::FirmwareTable, firmware_key(provider, id), contents);
+}
+
+void identy::CaptureBundle::add_record(CaptureRecordKind kind, std::string key, std::span<const byte> data)
+{
+    auto it = std::ranges::lower_bound(m_records, std::tie(kind, key), {}, [](const InputRecord& r) {
+        return std::tie(r.kind, r.key);
+    });
+
+    if(it == m_records.end() || it->kind != kind || it->key != key) {
+        it = m_records.insert(it, InputRecord { kind, std::move(key), {} });
+    }
+
+    it->data.assign(data.begin(), data.end());
+}
+
+bool identy::CaptureBundle::find_cpuid(register_32 leaf, register_32 subleaf, register_32 registers[4]) const noexcept
+{
+    auto key = std::pair(leaf, subleaf);
+    auto it = std::ranges::lower_bound(m_cpuid, key, {}, [](const CpuidRecord& r) { return std::pair(r.leaf, r.subleaf); });
+
+    if(it == m_cpuid.end() || it->leaf != leaf || it->subleaf != subleaf) {
+        return false;
+    }
+
+    std::copy_n(it->registers, 4, registers);
+    return true;
+}
+
+std::optional<std::span<const identy::byte>> identy::CaptureBundle::find(CaptureRecordKind kind, std::string_view key) const noexcept
+{
+    auto it = std::ranges::lower_bound(m_records, std::pair(kind, key), {}, [](const InputRecord& r) {
+        return std::pair<CaptureRecordKind, std::string_view>(r.kind, r.key);
+    });
+
+    if(it == m_records.end() || it->kind != kind || it->key != key) {
+        return std::nullopt;
+    }
+
+    return std::span<const byte>(it->data);
+}
+
+std::size_t identy::CaptureBundle::cpuid_count() const noexcept
+{
+    return m_cpuid.size();
+}
+
+std::size_t identy::CaptureBundle::record_count() const noexcept
+{
+    return m_records.size();
+}
+
+bool identy::CaptureBundle::empty() const noexcept
+{
+    return m_cpuid.empty() && m_records.empty();
+}
+
+identy::CaptureBundle identy::capture_hardware()
+{
+    CaptureBundle bundle;
+    RecordingSource recorder(platform::source(), bundle);
+
+    {
+        platform::ScopedSource scope(recorder);
+
+        auto mb = snap_motherboard_ex();
+        vm::analyze_full(mb);
+    }
+
+    return bundle;
+}
+
+identy::ScopedReplay::ScopedReplay(const CaptureBundle& bundle)
+    : m_source(std::make_unique<ReplaySource>(bundle))
+    , m_scope(std::make_unique<platform::ScopedSource>(*m_source))
+{
+}
+
+identy::ScopedReplay::~ScopedReplay() = default;
+
+identy::ScopedSysfsRoot::ScopedSysfsRoot(std::filesystem::path root)
+    : m_source(std::make_unique<RootedSource>(std::move(root), platform::source()))
+    , m_scope(std::make_unique<platform::ScopedSource>(*m_source))
+{
+}
+
+identy::ScopedSysfsRoot::~ScopedSysfsRoot() = default;
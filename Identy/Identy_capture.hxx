@@ -0,0 +1,236 @@
+/**
+ * @file Identy_capture.hxx
+ * @brief Recording of raw hardware inputs and offline replay
+ *
+ * A capture bundle holds every raw input the collectors read while taking a
+ * snapshot: CPUID leaves, the SMBIOS/DMI table and entry point, and the
+ * /sys/block and /sys/class/net attributes used for drive and network
+ * adapter enumeration. A bundle taken on a customer machine can be replayed
+ * anywhere: while a ScopedReplay is active, snap_motherboard_ex() and
+ * vm::analyze_full() on that thread read from the bundle instead of the
+ * hardware.
+ *
+ * Replay is deterministic. Inputs missing from the bundle behave like absent
+ * files and CPUID leaves returning zeros; directory listings are recorded in
+ * sorted order.
+ *
+ * ScopedSysfsRoot redirects the same reads to a directory tree instead, e.g. a
+ * synthetic tree built by fixture::write_sysfs_tree() or a mounted image of
+ * another machine.
+ *
+ * ## Bundle Layout (version 1)
+ *
+ * | Offset | Size | Content                              |
+ * |--------|------|--------------------------------------|
+ * | 0      | 4    | Magic "IDCP"                         |
+ * | 4      | 4    | Version                              |
+ * | 8      | 4    | CPUID record count                   |
+ * | 12     | 4    | Input record count                   |
+ * | 16     | 24*n | CPUID records {leaf, subleaf, EAX..EDX} |
+ * | ...    | ...  | Input records                        |
+ *
+ * An input record is {u8 kind, u8 reserved, u16 key size, u32 data size,
+ * key, data}. All integers are little-endian.
+ *
+ * @note On Windows only CPUID and the SMBIOS firmware table are captured;
+ *       drive and adapter enumeration go through IOCTLs and IP Helper and are
+ *       always read live.
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_CAPTURE_H
+#define UNC_IDENTY_CAPTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Identy_hwid.hxx"
+
+namespace identy::platform
+{
+class HardwareSource;
+class ScopedSource;
+} // namespace identy::platform
+
+namespace identy
+{
+/** @brief Magic bytes at the beginning of a capture bundle ("IDCP") */
+constexpr byte capture_magic[4] = { 'I', 'D', 'C', 'P' };
+
+/** @brief Current capture bundle version */
+constexpr std::uint32_t capture_version = 1;
+
+/**
+ * @brief Kind of a recorded input
+ */
+enum class CaptureRecordKind : std::uint8_t {
+    File = 1,         /**< File contents, key is the path */
+    Directory = 2,    /**< Sorted entry names separated by NUL, key is the path */
+    Link = 3,         /**< Symbolic link target, key is the path */
+    Exists = 4,       /**< Path exists, no data */
+    FirmwareTable = 5 /**< Firmware table, key is "<provider>/<id>" in hex */
+};
+
+/**
+ * @brief Raw hardware inputs of one machine
+ *
+ * Bundles are produced by capture_hardware() or assembled by hand with the
+ * add_*() functions, e.g. to build test fixtures.
+ */
+class CaptureBundle final
+{
+public:
+    /**
+     * @brief Decodes a bundle
+     *
+     * @param buffer Bundle bytes as produced by encode()
+     * @return Bundle, std::nullopt if @p buffer is not a valid bundle
+     */
+    static std::optional<CaptureBundle> decode(std::span<const byte> buffer);
+
+    /**
+     * @brief Appends the bundle representation to @p out
+     *
+     * @return Number of bytes appended
+     */
+    std::size_t encode(std::vector<byte>& out) const;
+
+    /** @brief Writes the bundle representation to @p stream */
+    void write(std::ostream& stream) const;
+
+    /** @brief Records the result of CPUID @p leaf / @p subleaf */
+    void add_cpuid(register_32 leaf, register_32 subleaf, const register_32 registers[4]);
+
+    /** @brief Records the contents of a file */
+    void add_file(const std::filesystem::path& path, std::span<const byte> contents);
+
+    /** @brief Records the contents of a text file */
+    void add_file(const std::filesystem::path& path, std::string_view contents);
+
+    /** @brief Records a directory listing; names are sorted on insertion */
+    void add_directory(const std::filesystem::path& path, std::vector<std::string> names);
+
+    /** @brief Records a symbolic link */
+    void add_link(const std::filesystem::path& path, const std::filesystem::path& target);
+
+    /** @brief Records that a path exists */
+    void add_existing(const std::filesystem::path& path);
+
+    /** @brief Records a firmware table */
+    void add_firmware_table(dword provider, dword id, std::span<const byte> contents);
+
+    /**
+     * @brief Looks up a CPUID result
+     * @return true and fills @p registers if the leaf was recorded
+     */
+    bool find_cpuid(register_32 leaf, register_32 subleaf, register_32 registers[4]) const noexcept;
+
+    /**
+     * @brief Looks up an input record
+     * @return Record data, std::nullopt if not recorded
+     */
+    std::optional<std::span<const byte>> find(CaptureRecordKind kind, std::string_view key) const noexcept;
+
+    /** @brief Number of recorded CPUID leaves */
+    std::size_t cpuid_count() const noexcept;
+
+    /** @brief Number of recorded file, directory, link and firmware inputs */
+    std::size_t record_count() const noexcept;
+
+    /** @brief Whether nothing was recorded */
+    bool empty() const noexcept;
+
+private:
+    struct CpuidRecord
+    {
+        register_32 leaf { 0 };
+        register_32 subleaf { 0 };
+        register_32 registers[4] { 0, 0, 0, 0 };
+    };
+
+    struct InputRecord
+    {
+        CaptureRecordKind kind { CaptureRecordKind::File };
+        std::string key;
+        std::vector<byte> data;
+    };
+
+    void add_record(CaptureRecordKind kind, std::string key, std::span<const byte> data);
+
+    std::vector<CpuidRecord> m_cpuid;
+    std::vector<InputRecord> m_records;
+};
+
+/**
+ * @brief Captures the raw inputs of the running machine
+ *
+ * Runs snap_motherboard_ex() and vm::analyze_full() against the hardware
+ * source of the calling thread (the live system unless a ScopedSysfsRoot or
+ * ScopedReplay is active) and records everything they read.
+ *
+ * @return Bundle reproducing both results on replay
+ */
+CaptureBundle capture_hardware();
+
+/**
+ * @brief Redirects hardware reads of the calling thread to a bundle
+ *
+ * Example usage:
+ * @code
+ * auto bundle = identy::CaptureBundle::decode(bytes);
+ * identy::ScopedReplay replay(*bundle);
+ * auto mb = identy::snap_motherboard_ex();
+ * auto verdict = identy::vm::analyze_full(mb);
+ * @endcode
+ *
+ * Replays nest. The bundle must outlive the replay scope.
+ */
+class ScopedReplay final
+{
+public:
+    explicit ScopedReplay(const CaptureBundle& bundle);
+    ~ScopedReplay();
+
+    ScopedReplay(const ScopedReplay&) = delete;
+    ScopedReplay& operator=(const ScopedReplay&) = delete;
+
+private:
+    std::unique_ptr<platform::HardwareSource> m_source;
+    std::unique_ptr<platform::ScopedSource> m_scope;
+};
+
+/**
+ * @brief Resolves sysfs and DMI paths of the calling thread below a directory
+ *
+ * While alive, a collector reading "/sys/block" reads "<root>/sys/block"
+ * instead. CPUID and firmware tables still come from the previously active
+ * source. Scopes nest like ScopedReplay.
+ *
+ * @note Symbolic links are resolved by the kernel, so absolute link targets
+ *       inside the tree point outside of it; use relative targets.
+ */
+class ScopedSysfsRoot final
+{
+public:
+    explicit ScopedSysfsRoot(std::filesystem::path root);
+    ~ScopedSysfsRoot();
+
+    ScopedSysfsRoot(const ScopedSysfsRoot&) = delete;
+    ScopedSysfsRoot& operator=(const ScopedSysfsRoot&) = delete;
+
+private:
+    std::unique_ptr<platform::HardwareSource> m_source;
+    std::unique_ptr<platform::ScopedSource> m_scope;
+};
+} // namespace identy
+
+#endif
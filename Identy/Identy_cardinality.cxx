@@ -0,0 +1,437 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_cardinality.hxx"
+
+#include <cmath>
+#include <mutex>
+
+#include "detail/Identy_bytes.hxx"
+#include "detail/Identy_walk.hxx"
+
+namespace
+{
+using identy::sketch::Field;
+using identy::sketch::field_count;
+
+constexpr std::size_t header_size = 8;
+constexpr std::size_t fields_header_size = 16;
+
+// digests hashed per block by HyperLogLog::add(span)
+constexpr std::size_t add_block = 64;
+
+// snapshots whose digests are gathered before the sketches are fed
+constexpr std::size_t board_block = 256;
+
+constexpr std::array<std::string_view, field_count> field_names = {
+    "cpu.vendor",
+    "cpu.version",
+    "cpu.brand_index",
+    "cpu.clflush_line_size",
+    "cpu.logical_processors",
+    "cpu.brand_string",
+    "cpu.instruction_set",
+    "smbios.version",
+    "smbios.uuid",
+    "drive.bus_type",
+    "drive.device_name",
+    "drive.serial",
+    "fingerprint",
+    "cpu.hypervisor_signature",
+    "smbios.structure",
+    "drive.model",
+};
+
+using identy::detail::Digest;
+using identy::detail::HashedField;
+using identy::detail::load_le;
+using identy::detail::store_le;
+
+// the fields default_hash_ex() covers come first, in the walker's order
+static_assert(static_cast<std::size_t>(Field::DriveSerial) == static_cast<std::size_t>(HashedField::DriveSerial));
+static_assert(static_cast<std::size_t>(Field::CpuInstructionSet) == static_cast<std::size_t>(HashedField::CpuInstructionSet));
+
+constexpr std::uint64_t murmur64(std::uint64_t h) noexcept
+{
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+/** Digest of one field value, keyed by the field */
+Digest field_digest(Field field) noexcept
+{
+    return Digest(0x4644'0000ull + static_cast<std::uint64_t>(field));
+}
+
+/** Adds one member of a hashed field: strings and byte arrays by content, integers zero-extended */
+template<typename T>
+void update_member(Digest& digest, const T& value) noexcept
+{
+    if constexpr(std::is_same_v<T, std::string>) {
+        digest.update(std::string_view(value));
+    } else if constexpr(std::is_array_v<T> && sizeof(std::remove_extent_t<T>) == 1) {
+        digest.update(std::span<const identy::byte>(value));
+    } else if constexpr(std::is_array_v<T>) {
+        for(const auto& element : value) {
+            update_member(digest, element);
+        }
+    } else if constexpr(std::is_enum_v<T>) {
+        digest.update(static_cast<std::uint64_t>(value));
+    } else {
+        digest.update(static_cast<std::uint64_t>(static_cast<std::make_unsigned_t<T>>(value)));
+    }
+}
+
+/** sigma(x) of Ertl's estimator: x + sum x^(2^k) * 2^(k-1) */
+double ertl_sigma(double x) noexcept
+{
+    if(x == 1.0) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    double y = 1.0;
+    double z = x;
+    double previous;
+
+    do {
+        x *= x;
+        previous = z;
+        z += x * y;
+        y += y;
+    } while(z != previous);
+
+    return z;
+}
+
+/** tau(x) of Ertl's estimator: (1 - x - sum (1 - x^(2^-k))^2 * 2^-k) / 3 */
+double ertl_tau(double x) noexcept
+{
+    if(x == 0.0 || x == 1.0) {
+        return 0.0;
+    }
+
+    double y = 1.0;
+    double z = 1.0 - x;
+    double previous;
+
+    do {
+        x = std::sqrt(x);
+        previous = z;
+        y *= 0.5;
+        z -= (1.0 - x) * (1.0 - x) * y;
+    } while(z != previous);
+
+    return z / 3.0;
+}
+
+/** Registers of precision @p precision never exceed 64 - precision + 1 */
+bool valid_registers(std::span<const identy::byte> registers, unsigned precision) noexcept
+{
+    auto max_rank = static_cast<identy::byte>(64 - precision + 1);
+    return std::all_of(registers.begin(), registers.end(), [max_rank](auto reg) { return reg <= max_rank; });
+}
+
+} // namespace
+
+identy::sketch::HyperLogLog::HyperLogLog(unsigned precision)
+    : m_precision(std::clamp(precision, min_precision, max_precision))
+    , m_registers(std::size_t { 1 } << m_precision, 0)
+{
+}
+
+void identy::sketch::HyperLogLog::add(std::uint64_t digest) noexcept
+{
+    add(std::span<const std::uint64_t>(&digest, 1));
+}
+
+void identy::sketch::HyperLogLog::add(std::span<const std::uint64_t> digests) noexcept
+{
+    std::uint32_t indices[add_block];
+    std::uint8_t ranks[add_block];
+
+    const auto index_shift = 64 - m_precision;
+
+    // with the bit below the index set, the rank never exceeds 64 - p + 1
+    const auto sentinel = std::uint64_t { 1 } << (m_precision - 1);
+
+    for(std::size_t offset = 0; offset < digests.size(); offset += add_block) {
+        auto count = std::min(add_block, digests.size() - offset);
+        const auto* block = digests.data() + offset;
+
+        for(std::size_t i = 0; i < count; ++i) {
+            auto h = murmur64(block[i]);
+            indices[i] = static_cast<std::uint32_t>(h >> index_shift);
+            ranks[i] = static_cast<std::uint8_t>(std::countl_zero((h << m_precision) | sentinel) + 1);
+        }
+
+        for(std::size_t i = 0; i < count; ++i) {
+            auto& reg = m_registers[indices[i]];
+            reg = std::max(reg, ranks[i]);
+        }
+    }
+}
+
+bool identy::sketch::HyperLogLog::merge(const HyperLogLog& other) noexcept
+{
+    if(other.m_precision != m_precision) {
+        return false;
+    }
+
+    auto* dst = m_registers.data();
+    const auto* src = other.m_registers.data();
+    for(std::size_t i = 0; i < m_registers.size(); ++i) {
+        dst[i] = std::max(dst[i], src[i]);
+    }
+
+    return true;
+}
+
+double identy::sketch::HyperLogLog::estimate() const noexcept
+{
+    const auto q = 64 - m_precision;
+    const auto m = static_cast<double>(m_registers.size());
+
+    std::array<std::uint32_t, 64 + 2> histogram {};
+    for(auto reg : m_registers) {
+        ++histogram[reg];
+    }
+
+    auto z = m * ertl_tau(1.0 - static_cast<double>(histogram[q + 1]) / m);
+    for(auto k = q; k >= 1; --k) {
+        z = 0.5 * (z + static_cast<double>(histogram[k]));
+    }
+    z += m * ertl_sigma(static_cast<double>(histogram[0]) / m);
+
+    // alpha_inf = 1 / (2 ln 2)
+    return 0.5 / std::log(2.0) * m * m / z;
+}
+
+void identy::sketch::HyperLogLog::clear() noexcept
+{
+    std::fill(m_registers.begin(), m_registers.end(), std::uint8_t { 0 });
+}
+
+double identy::sketch::HyperLogLog::standard_error() const noexcept
+{
+    return 1.04 / std::sqrt(static_cast<double>(m_registers.size()));
+}
+
+std::size_t identy::sketch::HyperLogLog::encode(std::vector<byte>& out) const
+{
+    auto offset = out.size();
+    out.resize(offset + header_size + m_registers.size());
+
+    auto* dst = out.data() + offset;
+    std::memcpy(dst, hyperloglog_magic, sizeof(hyperloglog_magic));
+    dst[4] = cardinality_version;
+    dst[5] = static_cast<byte>(m_precision);
+    store_le(dst + 6, std::uint16_t { 0 });
+    std::memcpy(dst + header_size, m_registers.data(), m_registers.size());
+
+    return out.size() - offset;
+}
+
+std::optional<identy::sketch::HyperLogLog> identy::sketch::HyperLogLog::decode(std::span<const byte> buffer)
+{
+    if(buffer.size() < header_size || std::memcmp(buffer.data(), hyperloglog_magic, sizeof(hyperloglog_magic)) != 0) {
+        return std::nullopt;
+    }
+
+    unsigned precision = buffer[5];
+    if(buffer[4] != cardinality_version || precision < min_precision || precision > max_precision) {
+        return std::nullopt;
+    }
+
+    HyperLogLog sketch(precision);
+    if(buffer.size() != header_size + sketch.m_registers.size() || !valid_registers(buffer.subspan(header_size), precision)) {
+        return std::nullopt;
+    }
+
+    std::memcpy(sketch.m_registers.data(), buffer.data() + header_size, sketch.m_registers.size());
+    return sketch;
+}
+
+std::string_view identy::sketch::field_name(Field field) noexcept
+{
+    auto index = static_cast<std::size_t>(field);
+    return index < field_names.size() ? field_names[index] : std::string_view {};
+}
+
+std::size_t identy::sketch::field_digests(const MotherboardEx& mb, std::vector<FieldDigest>& out)
+{
+    auto before = out.size();
+
+    auto emit = [&out](Field field, const Digest& digest) {
+        out.push_back({ field, digest.finish() });
+    };
+
+    detail::for_each_hashed_field(mb, [&emit](HashedField hashed, const auto&... members) {
+        auto field = static_cast<Field>(hashed);
+        auto digest = field_digest(field);
+        (update_member(digest, members), ...);
+        emit(field, digest);
+    });
+
+    // the fingerprint covers the hashed fields, in order
+    auto fingerprint = field_digest(Field::Fingerprint);
+    for(auto i = before; i < out.size(); ++i) {
+        fingerprint.update(out[i].digest);
+    }
+    emit(Field::Fingerprint, fingerprint);
+
+    emit(Field::CpuHypervisorSignature, field_digest(Field::CpuHypervisorSignature).update(std::string_view(mb.cpu.hypervisor_signature)));
+    detail::for_each_structure(mb.smbios.raw_tables_data, [&emit](std::span<const byte> structure) {
+        emit(Field::SmbiosStructure, field_digest(Field::SmbiosStructure).update(structure));
+    });
+
+    for(const auto& drive : mb.drives) {
+        if(detail::is_hashed_drive(drive)) {
+            emit(Field::DriveModel, field_digest(Field::DriveModel).update(std::string_view(drive.model_id)));
+        }
+    }
+
+    return out.size() - before;
+}
+
+identy::sketch::FieldCardinality::FieldCardinality(unsigned precision)
+{
+    if(precision != HyperLogLog::default_precision) {
+        m_sketches.fill(HyperLogLog(precision));
+    }
+}
+
+void identy::sketch::FieldCardinality::add(const MotherboardEx& mb)
+{
+    add(std::span<const MotherboardEx>(&mb, 1));
+}
+
+void identy::sketch::FieldCardinality::add(std::span<const MotherboardEx> boards)
+{
+    std::vector<FieldDigest> digests;
+
+    for(std::size_t offset = 0; offset < boards.size(); offset += board_block) {
+        auto count = std::min(board_block, boards.size() - offset);
+
+        digests.clear();
+        for(const auto& mb : boards.subspan(offset, count)) {
+            field_digests(mb, digests);
+        }
+
+        add_digests(digests);
+        m_snapshots += count;
+    }
+}
+
+void identy::sketch::FieldCardinality::add_batch(std::span<const MotherboardEx> boards, exec::ExecutorRef executor)
+{
+    // one chunk per worker: every chunk costs a full set of sketches
+    auto workers = std::max<std::size_t>(1, executor.concurrency());
+    auto grain = std::max(board_block, (boards.size() + workers - 1) / workers);
+
+    std::mutex mutex;
+    auto precision = this->precision();
+
+    exec::parallel_for(
+        boards.size(),
+        [this, &boards, &mutex, precision](std::size_t begin, std::size_t end) {
+            FieldCardinality local(precision);
+            local.add(boards.subspan(begin, end - begin));
+
+            std::lock_guard lock(mutex);
+            merge(local);
+        },
+        executor, grain);
+}
+
+bool identy::sketch::FieldCardinality::merge(const FieldCardinality& other) noexcept
+{
+    if(other.precision() != precision()) {
+        return false;
+    }
+
+    for(std::size_t i = 0; i < field_count; ++i) {
+        m_sketches[i].merge(other.m_sketches[i]);
+    }
+    m_snapshots += other.m_snapshots;
+
+    return true;
+}
+
+void identy::sketch::FieldCardinality::add_digests(std::span<const FieldDigest> digests)
+{
+    // counting sort by field, so every sketch gets one contiguous batch
+    std::array<std::size_t, field_count + 1> offsets {};
+    for(const auto& digest : digests) {
+        ++offsets[static_cast<std::size_t>(digest.field) + 1];
+    }
+    for(std::size_t i = 1; i <= field_count; ++i) {
+        offsets[i] += offsets[i - 1];
+    }
+
+    std::vector<std::uint64_t> sorted(digests.size());
+    auto next = offsets;
+    for(const auto& digest : digests) {
+        sorted[next[static_cast<std::size_t>(digest.field)]++] = digest.digest;
+    }
+
+    for(std::size_t i = 0; i < field_count; ++i) {
+        m_sketches[i].add(std::span<const std::uint64_t>(sorted).subspan(offsets[i], offsets[i + 1] - offsets[i]));
+    }
+}
+
+std::size_t identy::sketch::FieldCardinality::encode(std::vector<byte>& out) const
+{
+    auto registers = m_sketches[0].m_registers.size();
+
+    auto offset = out.size();
+    out.resize(offset + fields_header_size + field_count * registers);
+
+    auto* dst = out.data() + offset;
+    std::memcpy(dst, field_cardinality_magic, sizeof(field_cardinality_magic));
+    dst[4] = cardinality_version;
+    dst[5] = static_cast<byte>(precision());
+    store_le(dst + 6, static_cast<std::uint16_t>(field_count));
+    store_le(dst + 8, m_snapshots);
+
+    dst += fields_header_size;
+    for(const auto& sketch : m_sketches) {
+        std::memcpy(dst, sketch.m_registers.data(), registers);
+        dst += registers;
+    }
+
+    return out.size() - offset;
+}
+
+std::optional<identy::sketch::FieldCardinality> identy::sketch::FieldCardinality::decode(std::span<const byte> buffer)
+{
+    if(buffer.size() < fields_header_size
+        || std::memcmp(buffer.data(), field_cardinality_magic, sizeof(field_cardinality_magic)) != 0) {
+        return std::nullopt;
+    }
+
+    unsigned precision = buffer[5];
+    auto fields = load_le<std::uint16_t>(buffer.data() + 6);
+    if(buffer[4] != cardinality_version || precision < HyperLogLog::min_precision || precision > HyperLogLog::max_precision
+        || fields > field_count) {
+        return std::nullopt;
+    }
+
+    auto registers = std::size_t { 1 } << precision;
+    if(buffer.size() != fields_header_size + fields * registers || !valid_registers(buffer.subspan(fields_header_size), precision)) {
+        return std::nullopt;
+    }
+
+    FieldCardinality counts(precision);
+    counts.m_snapshots = load_le<std::uint64_t>(buffer.data() + 8);
+
+    const auto* src = buffer.data() + fields_header_size;
+    for(std::size_t i = 0; i < fields; ++i) {
+        std::memcpy(counts.m_sketches[i].m_registers.data(), src, registers);
+        src += registers;
+    }
+
+    return counts;
+}
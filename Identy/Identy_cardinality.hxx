@@ -0,0 +1,282 @@
+/**
+ * @file Identy_cardinality.hxx
+ * @brief Distinct-value counts per fingerprint field (HyperLogLog)
+ *
+ * A field that has the same value on every machine of a fleet adds nothing
+ * to the fingerprint; one with as many values as machines identifies them
+ * on its own. Counting the distinct values of each field exactly needs a
+ * set per field, which does not fit in memory for billions of snapshots.
+ *
+ * HyperLogLog estimates the number of distinct values of a stream from 2^p
+ * one-byte registers, with a standard error of 1.04 / sqrt(2^p) (0.8% at the
+ * default p = 14, 16 KiB). Sketches of the same precision merge by taking
+ * the register-wise maximum, so every node can count its own snapshots and
+ * a coordinator merges the serialized sketches:
+ *
+ * @code
+ * identy::sketch::FieldCardinality counts;
+ * counts.add(snapshots);
+ *
+ * std::vector<identy::byte> bytes;
+ * counts.encode(bytes);
+ * // ... on the coordinator
+ * total.merge(*identy::sketch::FieldCardinality::decode(bytes));
+ * for(std::size_t i = 0; i < identy::sketch::field_count; ++i) {
+ *     auto field = static_cast<identy::sketch::Field>(i);
+ *     report(identy::sketch::field_name(field), total.estimate(field));
+ * }
+ * @endcode
+ *
+ * ## Serialized Layout (version 1)
+ *
+ * All fields are little-endian.
+ *
+ * | Offset | Size | HyperLogLog          | FieldCardinality            |
+ * |--------|------|----------------------|-----------------------------|
+ * | 0      | 4    | Magic "IDHY"         | Magic "IDFS"                |
+ * | 4      | 1    | Version              | Version                     |
+ * | 5      | 1    | Precision p          | Precision p                 |
+ * | 6      | 2    | Reserved             | Number of fields            |
+ * | 8      | ...  | 2^p registers        | Snapshots (8 bytes)         |
+ * | 16     | ...  |                      | 2^p registers per field     |
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_CARDINALITY_H
+#define UNC_IDENTY_CARDINALITY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "Identy_executor.hxx"
+#include "Identy_hwid.hxx"
+
+namespace identy::sketch
+{
+/** @brief Magic bytes of a serialized HyperLogLog ("IDHY") */
+constexpr byte hyperloglog_magic[4] = { 'I', 'D', 'H', 'Y' };
+
+/** @brief Magic bytes of a serialized FieldCardinality ("IDFS") */
+constexpr byte field_cardinality_magic[4] = { 'I', 'D', 'F', 'S' };
+
+/**
+ * @brief Current version of both formats
+ *
+ * Version 2 digests the fields value by value, as default_hash_ex() hashes
+ * them; sketches of version 1 do not merge with it.
+ */
+constexpr std::uint8_t cardinality_version = 2;
+
+/**
+ * @brief HyperLogLog distinct-value sketch
+ *
+ * Register i holds the maximum rank (leading zeros + 1) of the hashes whose
+ * top p bits equal i. estimate() uses Ertl's improved raw estimator, which
+ * stays unbiased from empty sketches to 2^64 values without empirical
+ * correction tables.
+ *
+ * Inputs are 64-bit digests; add() mixes them again, so sequential or
+ * otherwise structured values are fine.
+ */
+class HyperLogLog final
+{
+public:
+    static constexpr unsigned min_precision = 4;
+    static constexpr unsigned max_precision = 18;
+    static constexpr unsigned default_precision = 14;
+
+    /** @param precision Register count is 2^precision; clamped to [min_precision, max_precision] */
+    explicit HyperLogLog(unsigned precision = default_precision);
+
+    void add(std::uint64_t digest) noexcept;
+
+    /**
+     * @brief Adds many digests
+     *
+     * Hashes, register indices and ranks are computed for blocks of digests
+     * in branch-free loops the compiler vectorizes; only the register update
+     * is a scalar scatter. Prefer it over add(std::uint64_t) in loops.
+     */
+    void add(std::span<const std::uint64_t> digests) noexcept;
+
+    /**
+     * @brief Adds the values of @p other: the result estimates the union
+     * @return false, leaving this sketch unchanged, if the precisions differ
+     */
+    bool merge(const HyperLogLog& other) noexcept;
+
+    /** @brief Estimated number of distinct digests added */
+    double estimate() const noexcept;
+
+    /** @brief Resets every register */
+    void clear() noexcept;
+
+    unsigned precision() const noexcept
+    {
+        return m_precision;
+    }
+
+    std::span<const std::uint8_t> registers() const noexcept
+    {
+        return m_registers;
+    }
+
+    /** @brief Relative standard error of estimate(): 1.04 / sqrt(2^precision) */
+    double standard_error() const noexcept;
+
+    /**
+     * @brief Appends the serialized sketch to @p out
+     * @return Number of bytes appended: 8 + 2^precision
+     */
+    std::size_t encode(std::vector<byte>& out) const;
+
+    /** @brief Reads a sketch written by encode(); std::nullopt on a bad magic, version, precision or size */
+    static std::optional<HyperLogLog> decode(std::span<const byte> buffer);
+
+    bool operator==(const HyperLogLog&) const = default;
+
+private:
+    friend class FieldCardinality;
+
+    unsigned m_precision;
+    std::vector<std::uint8_t> m_registers;
+};
+
+/**
+ * @brief Fingerprint field counted by FieldCardinality
+ *
+ * The fields default_hash_ex() hashes, in its order, followed by fields it
+ * does not hash but that are candidates for it. Drive fields count the
+ * values of every drive; SmbiosStructure counts every raw SMBIOS structure.
+ */
+enum class Field : std::uint8_t {
+    CpuVendor,
+    CpuVersion,
+    CpuBrandIndex,
+    CpuClflushLineSize,
+    CpuLogicalProcessors,
+    CpuBrandString,
+    CpuInstructionSet,
+    SmbiosVersion,
+    SmbiosUuid,
+    DriveBusType,
+    DriveDeviceName,
+    DriveSerial,
+
+    /** @brief All fields above combined: the number of distinct fingerprints */
+    Fingerprint,
+
+    CpuHypervisorSignature,
+    SmbiosStructure,
+    DriveModel
+};
+
+/** @brief Number of Field values */
+inline constexpr std::size_t field_count = static_cast<std::size_t>(Field::DriveModel) + 1;
+
+/** @brief Name of @p field, e.g. "cpu.vendor" */
+std::string_view field_name(Field field) noexcept;
+
+/**
+ * @brief Digest of one field value of a snapshot
+ */
+struct FieldDigest
+{
+    Field field { Field::CpuVendor };
+    std::uint64_t digest { 0 };
+};
+
+/**
+ * @brief Appends the digests of the field values of @p mb to @p out
+ *
+ * One digest per field, plus one per drive for the drive fields and one per
+ * structure for SmbiosStructure. Like default_hash_ex(), USB and Other
+ * drives are skipped.
+ *
+ * @return Number of digests appended
+ */
+std::size_t field_digests(const MotherboardEx& mb, std::vector<FieldDigest>& out);
+
+/**
+ * @brief One HyperLogLog per Field
+ *
+ * add() requires exclusive access; const members may run concurrently.
+ */
+class FieldCardinality final
+{
+public:
+    /** @param precision Precision of every sketch, see HyperLogLog(unsigned) */
+    explicit FieldCardinality(unsigned precision = HyperLogLog::default_precision);
+
+    void add(const MotherboardEx& mb);
+
+    /** @brief Adds many snapshots, feeding each sketch in batches */
+    void add(std::span<const MotherboardEx> boards);
+
+    /**
+     * @brief Adds many snapshots in parallel
+     *
+     * Every chunk fills sketches of its own that are merged at the end,
+     * 16 * 2^precision bytes per chunk.
+     */
+    void add_batch(std::span<const MotherboardEx> boards, exec::ExecutorRef executor = exec::default_executor());
+
+    /**
+     * @brief Adds the snapshots counted by @p other
+     * @return false, leaving this object unchanged, if the precisions differ
+     */
+    bool merge(const FieldCardinality& other) noexcept;
+
+    /** @brief Estimated number of distinct values of @p field */
+    double estimate(Field field) const noexcept
+    {
+        return sketch(field).estimate();
+    }
+
+    const HyperLogLog& sketch(Field field) const noexcept
+    {
+        return m_sketches[static_cast<std::size_t>(field)];
+    }
+
+    /** @brief Snapshots added, exactly */
+    std::uint64_t snapshots() const noexcept
+    {
+        return m_snapshots;
+    }
+
+    unsigned precision() const noexcept
+    {
+        return m_sketches[0].precision();
+    }
+
+    /**
+     * @brief Appends the serialized sketches to @p out
+     * @return Number of bytes appended: 16 + field_count * 2^precision
+     */
+    std::size_t encode(std::vector<byte>& out) const;
+
+    /**
+     * @brief Reads sketches written by encode()
+     *
+     * Files of older versions may hold fewer fields; the missing ones are
+     * empty.
+     *
+     * @return std::nullopt on a bad magic, version, precision or size
+     */
+    static std::optional<FieldCardinality> decode(std::span<const byte> buffer);
+
+private:
+    void add_digests(std::span<const FieldDigest> digests);
+
+    std::array<HyperLogLog, field_count> m_sketches;
+    std::uint64_t m_snapshots { 0 };
+};
+} // namespace identy::sketch
+
+#endif
@@ -0,0 +1,376 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_collector.hxx"
+
+#include <condition_variable>
+#include <memory>
+
+#include "Identy_sha256.hxx"
+#include "Identy_trace.hxx"
+#include "detail/Identy_bytes.hxx"
+#include "Platform/Identy_platform_source.hxx"
+
+namespace
+{
+using identy::collect::Collector;
+using identy::collect::CostClass;
+using identy::collect::Encoding;
+using identy::collect::Result;
+using identy::collect::Status;
+using Clock = std::chrono::steady_clock;
+
+using identy::detail::store_le;
+
+bool is_space(identy::byte b) noexcept
+{
+    return b == ' ' || b == '\t' || b == '\n' || b == '\r' || b == '\v' || b == '\f';
+}
+
+std::vector<identy::byte> canonical(Encoding encoding, std::vector<identy::byte> value)
+{
+    switch(encoding) {
+        case Encoding::Text:
+            while(!value.empty() && is_space(value.back())) {
+                value.pop_back();
+            }
+            return value;
+
+        case Encoding::Set: {
+            std::vector<std::string_view> items;
+            std::string_view text(reinterpret_cast<const char*>(value.data()), value.size());
+
+            while(!text.empty()) {
+                auto end = text.find('\n');
+                auto item = text.substr(0, end);
+                if(!item.empty() && item.back() == '\r') {
+                    item.remove_suffix(1);
+                }
+                if(!item.empty()) {
+                    items.push_back(item);
+                }
+                text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+            }
+
+            std::ranges::sort(items);
+            auto [first, last] = std::ranges::unique(items);
+            items.erase(first, last);
+
+            std::vector<identy::byte> result;
+            for(auto item : items) {
+                result.insert(result.end(), item.begin(), item.end());
+                result.push_back('\n');
+            }
+            return result;
+        }
+
+        default:
+            return value;
+    }
+}
+
+/**
+ * State shared with the executor tasks. Tasks own a reference, so a
+ * collector finishing after the caller gave up writes into a live object.
+ */
+struct Batch
+{
+    std::vector<Collector> collectors;
+    std::vector<Result> results;
+    std::vector<bool> finished;
+
+    // set by whoever runs a collector first: an executor task or the caller
+    std::unique_ptr<std::atomic<bool>[]> claimed;
+
+    std::mutex mutex;
+    std::condition_variable done;
+
+    bool claim(std::size_t index) noexcept
+    {
+        return !claimed[index].exchange(true, std::memory_order_acq_rel);
+    }
+};
+
+void execute(Batch& batch, std::size_t index)
+{
+    const auto& collector = batch.collectors[index];
+    identy::trace::Span span(identy::trace::Phase::Collector, collector.name);
+
+    auto start = Clock::now();
+
+    std::optional<std::vector<identy::byte>> output;
+    try {
+        output = collector.collect();
+    }
+    catch(...) {
+        // a throwing user collector is a failed component, not a crash
+        output.reset();
+    }
+
+    auto elapsed = Clock::now() - start;
+    auto value = output.has_value() ? canonical(collector.encoding, std::move(*output)) : std::vector<identy::byte> {};
+
+    std::lock_guard lock(batch.mutex);
+    auto& result = batch.results[index];
+    result.status = output.has_value() ? Status::Ok : Status::Failed;
+    result.value = std::move(value);
+    result.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+    batch.finished[index] = true;
+    batch.done.notify_all();
+}
+
+/**
+ * One run: threaded collectors are submitted on construction, inline ones
+ * run in run_inline(), finish() collects the results within the budget.
+ */
+class Run
+{
+public:
+    Run(const identy::collect::Registry& registry, const identy::collect::RunOptions& options, identy::exec::ExecutorRef executor)
+        : m_batch(std::make_shared<Batch>())
+        , m_options(options)
+        , m_deadline(Clock::now() + options.budget)
+    {
+        auto& batch = *m_batch;
+        batch.collectors = registry.collectors();
+        batch.results.resize(batch.collectors.size());
+        batch.finished.assign(batch.collectors.size(), false);
+        batch.claimed = std::make_unique<std::atomic<bool>[]>(batch.collectors.size());
+
+        for(std::size_t i = 0; i < batch.collectors.size(); ++i) {
+            batch.results[i].name = batch.collectors[i].name;
+            batch.results[i].stability = batch.collectors[i].stability;
+
+            if(!runs(batch.collectors[i])) {
+                batch.claimed[i].store(true, std::memory_order_relaxed);
+            }
+        }
+
+        auto& source = identy::platform::source();
+        m_source = &source == &identy::platform::live_source() ? nullptr : &source;
+
+        // longest first, so the slowest collectors get the whole budget
+        for(auto cost : { CostClass::Expensive, CostClass::Moderate }) {
+            for(std::size_t i = 0; i < batch.collectors.size(); ++i) {
+                if(batch.collectors[i].cost == cost && runs(batch.collectors[i])) {
+                    submit(executor, i);
+                }
+            }
+        }
+    }
+
+    void run_inline()
+    {
+        auto& batch = *m_batch;
+
+        for(std::size_t i = 0; i < batch.collectors.size(); ++i) {
+            if(batch.collectors[i].cost == CostClass::Cheap && batch.claim(i)) {
+                execute(batch, i);
+            }
+        }
+    }
+
+    std::vector<Result> finish()
+    {
+        auto& batch = *m_batch;
+
+        // workers must not outlive a scoped source they read through: run
+        // what the executor has not started yet here, then wait for the rest
+        if(m_source != nullptr) {
+            for(std::size_t i = 0; i < batch.collectors.size(); ++i) {
+                if(batch.claim(i)) {
+                    execute(batch, i);
+                }
+            }
+        }
+
+        std::unique_lock lock(batch.mutex);
+
+        auto all_finished = [this, &batch] {
+            for(std::size_t i = 0; i < batch.collectors.size(); ++i) {
+                if(runs(batch.collectors[i]) && !batch.finished[i]) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        if(m_source != nullptr) {
+            batch.done.wait(lock, all_finished);
+        }
+        else {
+            batch.done.wait_until(lock, m_deadline, all_finished);
+        }
+
+        auto results = batch.results;
+
+        for(std::size_t i = 0; i < results.size(); ++i) {
+            if(!runs(batch.collectors[i])) {
+                results[i].status = Status::Skipped;
+            }
+            else if(!batch.finished[i]) {
+                // a collector the executor has not started never will
+                batch.claim(i);
+                results[i].status = Status::TimedOut;
+                results[i].elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(m_options.budget);
+            }
+        }
+
+        return results;
+    }
+
+private:
+    bool runs(const Collector& collector) const noexcept
+    {
+        return collector.cost != CostClass::Expensive || m_options.include_expensive;
+    }
+
+    void submit(identy::exec::ExecutorRef executor, std::size_t index)
+    {
+        executor.submit([batch = m_batch, index, source = m_source] {
+            if(!batch->claim(index)) {
+                return;
+            }
+
+            std::optional<identy::platform::ScopedSource> scoped;
+            if(source != nullptr) {
+                scoped.emplace(*source);
+            }
+
+            execute(*batch, index);
+        });
+    }
+
+    std::shared_ptr<Batch> m_batch;
+    identy::collect::RunOptions m_options;
+    Clock::time_point m_deadline;
+    identy::platform::HardwareSource* m_source { nullptr };
+};
+} // namespace
+
+bool identy::collect::Registry::add(Collector collector)
+{
+    if(collector.name.empty() || !collector.collect) {
+        return false;
+    }
+
+    std::lock_guard lock(m_mutex);
+
+    auto it = std::ranges::lower_bound(m_collectors, collector.name, {}, &Collector::name);
+    if(it != m_collectors.end() && it->name == collector.name) {
+        return false;
+    }
+
+    m_collectors.insert(it, std::move(collector));
+    return true;
+}
+
+bool identy::collect::Registry::remove(std::string_view name)
+{
+    std::lock_guard lock(m_mutex);
+
+    auto it = std::ranges::find(m_collectors, name, &Collector::name);
+    if(it == m_collectors.end()) {
+        return false;
+    }
+
+    m_collectors.erase(it);
+    return true;
+}
+
+void identy::collect::Registry::clear()
+{
+    std::lock_guard lock(m_mutex);
+    m_collectors.clear();
+}
+
+std::vector<identy::collect::Collector> identy::collect::Registry::collectors() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_collectors;
+}
+
+std::size_t identy::collect::Registry::size() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_collectors.size();
+}
+
+identy::collect::Registry& identy::collect::registry() noexcept
+{
+    static Registry registry;
+    return registry;
+}
+
+std::vector<identy::collect::Result> identy::collect::run(const Registry& collectors, const RunOptions& options,
+    exec::ExecutorRef executor)
+{
+    Run run(collectors, options, executor);
+    run.run_inline();
+    return run.finish();
+}
+
+identy::hs::Hash256 identy::collect::fold(const hs::Hash256& base, std::span<const Result> results)
+{
+    // only collected values count: a budget overrun under load must not
+    // make the same hardware fold to a different hash
+    std::vector<const Result*> stable;
+    for(const auto& result : results) {
+        if(result.stability == Stability::Stable && result.status == Status::Ok) {
+            stable.push_back(&result);
+        }
+    }
+
+    if(stable.empty()) {
+        return base;
+    }
+
+    std::ranges::sort(stable, {}, [](const Result* result) -> const std::string& { return result->name; });
+
+    hs::detail::Sha256 ctx;
+    ctx.update(base.buffer, sizeof(base.buffer));
+
+    for(const auto* result : stable) {
+        byte header[8] {};
+        store_le(header, static_cast<std::uint32_t>(result->name.size()));
+        store_le(header + 4, static_cast<std::uint32_t>(result->value.size()));
+
+        ctx.update(header, sizeof(header));
+        ctx.update(reinterpret_cast<const byte*>(result->name.data()), result->name.size());
+        ctx.update(result->value);
+    }
+
+    return ctx.finalize();
+}
+
+identy::collect::Fingerprint identy::collect::fingerprint(const Registry& collectors, const RunOptions& options,
+    exec::ExecutorRef executor)
+{
+    Run run(collectors, options, executor);
+
+    Fingerprint result;
+    result.snapshot = snap_motherboard_ex();
+
+    run.run_inline();
+    result.components = run.finish();
+    result.hash = fold(hs::hash(result.snapshot), result.components);
+    result.complete = std::ranges::none_of(result.components, [](const Result& component) {
+        return component.stability == Stability::Stable && component.status == Status::TimedOut;
+    });
+
+    return result;
+}
+
+identy::collect::Collector identy::collect::file_collector(std::string name, std::filesystem::path path, Stability stability,
+    Encoding encoding)
+{
+    Collector collector;
+    collector.name = std::move(name);
+    collector.cost = CostClass::Cheap;
+    collector.stability = stability;
+    collector.encoding = encoding;
+    collector.collect = [path = std::move(path)] {
+        return platform::source().read_file(path);
+    };
+
+    return collector;
+}
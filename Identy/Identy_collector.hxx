@@ -0,0 +1,244 @@
+/**
+ * @file Identy_collector.hxx
+ * @brief Pluggable identity components folded into the fingerprint
+ *
+ * Applications often bind the fingerprint to more than the CPU, SMBIOS and
+ * drives: a TPM endorsement key hash, the set of MAC addresses, GPU PCI IDs
+ * or cloud instance metadata. Instead of forking the hash, register a
+ * collector for each such component:
+ *
+ * @code
+ * identy::collect::registry().add({
+ *     .name = "cloud.instance_id",
+ *     .cost = identy::collect::CostClass::Cheap,
+ *     .stability = identy::collect::Stability::Stable,
+ *     .encoding = identy::collect::Encoding::Text,
+ *     .collect = [] { return read_instance_id(); },
+ * });
+ *
+ * auto result = identy::collect::fingerprint();
+ * // result.hash folds hs::hash(result.snapshot) and every stable component
+ * @endcode
+ *
+ * fingerprint() submits the Moderate and Expensive collectors to an executor
+ * (the built-in pool unless one is passed, see Identy_executor.hxx),
+ * Expensive first, takes the snapshot on the calling thread, then runs the
+ * Cheap collectors inline and waits for the others until the time budget
+ * runs out. A collector still running at that point is reported as TimedOut
+ * and does not hold up the caller, though it keeps its executor thread until
+ * it returns.
+ *
+ * Outputs are folded in name order, so registration order and completion
+ * order never change the result. Each encoding is canonicalized first:
+ * Text drops trailing whitespace and Set sorts and deduplicates its
+ * newline-separated items. Volatile components are reported but never
+ * folded. Without stable collectors the fingerprint equals hs::hash() of
+ * the snapshot.
+ *
+ * Only components with status Ok are folded; a failed, skipped or timed-out
+ * one counts as absent. A stable component that ran out of budget would
+ * still change the hash against a run where it finished in time, so
+ * fingerprint() reports such a run as incomplete (Fingerprint::complete)
+ * instead of passing the hash off as the machine's.
+ *
+ * Tasks read through the caller's hardware source, so ScopedSysfsRoot and
+ * ScopedReplay apply to file_collector(). With such a source active, the
+ * run waits for every collector, so none outlives the source; collectors
+ * the executor has not started by then run on the calling thread.
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_COLLECTOR_H
+#define UNC_IDENTY_COLLECTOR_H
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Identy_executor.hxx"
+#include "Identy_hash.hxx"
+#include "Identy_hwid.hxx"
+
+namespace identy::collect
+{
+/**
+ * @brief Expected cost of one collection, decides where it runs
+ */
+enum class CostClass : std::uint8_t {
+    Cheap,     /**< Microseconds, e.g. one small file; runs inline on the calling thread */
+    Moderate,  /**< Milliseconds, e.g. a directory scan; runs on the executor */
+    Expensive, /**< Up to the budget, e.g. a device query; started first, can be excluded */
+};
+
+/**
+ * @brief Whether a component belongs in the fingerprint
+ */
+enum class Stability : std::uint8_t {
+    Stable,   /**< Bound to the machine; folded into the fingerprint */
+    Volatile, /**< Changes without a hardware change; reported only */
+};
+
+/**
+ * @brief How the output bytes are canonicalized before folding
+ */
+enum class Encoding : std::uint8_t {
+    Binary, /**< Folded as-is */
+    Text,   /**< Trailing whitespace removed */
+    Set,    /**< Newline-separated items, sorted and deduplicated */
+};
+
+/** @brief Collection function; std::nullopt reports a failure */
+using CollectFn = std::function<std::optional<std::vector<byte>>()>;
+
+/**
+ * @brief Declaration of one identity component
+ */
+struct Collector
+{
+    /** @brief Unique name, also the folding order */
+    std::string name;
+
+    CostClass cost { CostClass::Moderate };
+    Stability stability { Stability::Stable };
+    Encoding encoding { Encoding::Binary };
+
+    CollectFn collect;
+};
+
+/**
+ * @brief Thread-safe set of collectors
+ */
+class Registry final
+{
+public:
+    /**
+     * @brief Registers a collector
+     * @return false if the name is empty or taken, or the function is empty
+     */
+    bool add(Collector collector);
+
+    /**
+     * @brief Unregisters a collector
+     * @return false if no collector has this name
+     */
+    bool remove(std::string_view name);
+
+    /** @brief Unregisters every collector */
+    void clear();
+
+    /** @brief Copy of the registered collectors, sorted by name */
+    std::vector<Collector> collectors() const;
+
+    /** @brief Number of registered collectors */
+    std::size_t size() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<Collector> m_collectors;
+};
+
+/**
+ * @brief Process-wide registry used by default
+ */
+Registry& registry() noexcept;
+
+/**
+ * @brief Outcome of one collector
+ */
+enum class Status : std::uint8_t {
+    Ok,       /**< Output collected */
+    Failed,   /**< The function returned std::nullopt or threw */
+    TimedOut, /**< Still running when the budget ran out */
+    Skipped,  /**< Expensive collector excluded by RunOptions */
+};
+
+/**
+ * @brief Output of one collector
+ */
+struct Result
+{
+    std::string name;
+    Stability stability { Stability::Stable };
+    Status status { Status::Skipped };
+
+    /** @brief Canonicalized output, empty unless status is Ok */
+    std::vector<byte> value;
+
+    /** @brief Time spent in the function, the budget for TimedOut */
+    std::chrono::nanoseconds elapsed { 0 };
+};
+
+/**
+ * @brief Scheduling limits of a run
+ */
+struct RunOptions
+{
+    /** @brief Wall time granted to the threaded collectors */
+    std::chrono::milliseconds budget { 250 };
+
+    /** @brief Whether Expensive collectors run at all */
+    bool include_expensive { true };
+};
+
+/**
+ * @brief Runs every registered collector
+ * @param executor Executor running the Moderate and Expensive collectors
+ * @return One result per collector, sorted by name
+ */
+std::vector<Result> run(const Registry& collectors = registry(), const RunOptions& options = {},
+    exec::ExecutorRef executor = exec::default_executor());
+
+/**
+ * @brief Folds stable components into a base fingerprint
+ *
+ * SHA-256 over the base and, in name order, the name and value of every
+ * Stable result with status Ok. Returns @p base unchanged if there is none.
+ */
+hs::Hash256 fold(const hs::Hash256& base, std::span<const Result> results);
+
+/**
+ * @brief Snapshot, components and their combined fingerprint
+ */
+struct Fingerprint
+{
+    hs::Hash256 hash {};
+    MotherboardEx snapshot;
+    std::vector<Result> components;
+
+    /**
+     * @brief false if a Stable component timed out
+     *
+     * The hash then lacks that component and differs from the machine's
+     * fingerprint; do not compare or store it, retry with a larger budget.
+     */
+    bool complete { true };
+};
+
+/**
+ * @brief Collects the snapshot and the components concurrently and folds them
+ *
+ * Equivalent to fold(hs::hash(snap_motherboard_ex()), run()), with the
+ * snapshot taken while the threaded collectors run.
+ */
+Fingerprint fingerprint(const Registry& collectors = registry(), const RunOptions& options = {},
+    exec::ExecutorRef executor = exec::default_executor());
+
+/**
+ * @brief Collector returning the contents of a file
+ *
+ * Reads through the current hardware source. Fails if the file cannot be
+ * read.
+ */
+Collector file_collector(std::string name, std::filesystem::path path, Stability stability = Stability::Stable,
+    Encoding encoding = Encoding::Text);
+} // namespace identy::collect
+
+#endif
@@ -0,0 +1,835 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_columnar.hxx"
+
+#include <unordered_map>
+#include <utility>
+
+#include "detail/Identy_bytes.hxx"
+
+namespace
+{
+using Column = identy::io::ColumnarBatch::Column;
+using identy::io::ColumnType;
+
+// Batch file layout constants (see Identy_columnar.hxx for the overall layout)
+constexpr std::size_t header_size = 32;
+constexpr std::size_t header_version_offset = 4;
+constexpr std::size_t header_rows_offset = 8;
+constexpr std::size_t header_column_count_offset = 16;
+constexpr std::size_t header_node_count_offset = 20;
+constexpr std::size_t header_total_size_offset = 24;
+
+constexpr std::size_t node_size = 80;
+constexpr std::size_t node_type_offset = 0;
+constexpr std::size_t node_child_count_offset = 2;
+constexpr std::size_t node_byte_width_offset = 4;
+constexpr std::size_t node_length_offset = 8;
+constexpr std::size_t node_null_count_offset = 16;
+constexpr std::size_t node_name_offset = 24;
+constexpr std::size_t node_name_size_offset = 28;
+constexpr std::size_t node_buffers_offset = 32;
+constexpr std::size_t node_buffer_count = 3;
+
+// Nesting is at most list<struct<dictionary<utf8>>>; deeper files are malformed
+constexpr std::size_t max_node_depth = 8;
+
+constexpr std::size_t align_up(std::size_t value, std::size_t alignment) noexcept
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+constexpr std::size_t bitmap_size(std::uint64_t bits) noexcept
+{
+    return static_cast<std::size_t>((bits + 7) / 8);
+}
+
+using identy::detail::store_le;
+using identy::detail::load_le;
+
+void set_bit(identy::io::AlignedBuffer& bitmap, std::uint64_t index, bool value)
+{
+    auto byte_index = static_cast<std::size_t>(index / 8);
+    if(bitmap.size() <= byte_index) {
+        bitmap.resize(byte_index + 1);
+    }
+
+    if(value) {
+        bitmap.data()[byte_index] |= static_cast<identy::byte>(1u << (index % 8));
+    }
+}
+
+bool get_bit(std::span<const identy::byte> bitmap, std::uint64_t index) noexcept
+{
+    auto byte_index = static_cast<std::size_t>(index / 8);
+    return byte_index < bitmap.size() && (bitmap[byte_index] >> (index % 8)) & 1;
+}
+
+Column make_column(std::string name, ColumnType type, std::uint32_t byte_width = 0)
+{
+    Column column;
+    column.name = std::move(name);
+    column.type = type;
+    column.byte_width = byte_width;
+
+    if(type == ColumnType::Utf8 || type == ColumnType::List) {
+        column.offsets.append_value<std::int32_t>(0);
+    }
+
+    if(type == ColumnType::Dictionary) {
+        column.children.push_back(make_column("dictionary", ColumnType::Utf8));
+    }
+
+    return column;
+}
+
+// Records validity of the next row; the bitmap is materialized on the first null
+void append_validity(Column& column, bool valid)
+{
+    if(!valid && column.null_count == 0) {
+        for(std::uint64_t row = 0; row < column.length; ++row) {
+            set_bit(column.validity, row, true);
+        }
+    }
+
+    if(!valid) {
+        ++column.null_count;
+    }
+
+    if(column.null_count != 0) {
+        set_bit(column.validity, column.length, valid);
+    }
+}
+
+template<typename T>
+void append_fixed(Column& column, T value)
+{
+    append_validity(column, true);
+    column.values.append_value(value);
+    ++column.length;
+}
+
+void append_bool(Column& column, bool value)
+{
+    append_validity(column, true);
+    set_bit(column.values, column.length, value);
+    ++column.length;
+}
+
+void append_binary(Column& column, std::span<const identy::byte> value, bool valid)
+{
+    append_validity(column, valid);
+    column.values.append(value.data(), value.size());
+    ++column.length;
+}
+
+void append_utf8(Column& column, std::string_view value, bool valid = true)
+{
+    append_validity(column, valid);
+    column.values.append(value.data(), value.size());
+    column.offsets.append_value(static_cast<std::int32_t>(column.values.size()));
+    ++column.length;
+}
+
+struct StringHash
+{
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view value) const noexcept
+    {
+        return std::hash<std::string_view> {}(value);
+    }
+};
+
+using Dictionary = std::unordered_map<std::string, std::int32_t, StringHash, std::equal_to<>>;
+
+void append_dictionary(Column& column, Dictionary& dictionary, std::string_view value)
+{
+    auto it = dictionary.find(value);
+    if(it == dictionary.end()) {
+        auto index = static_cast<std::int32_t>(dictionary.size());
+        it = dictionary.emplace(std::string(value), index).first;
+        append_utf8(column.children.front(), value);
+    }
+
+    append_fixed(column, it->second);
+}
+
+identy::io::ColumnView make_view(const Column& column)
+{
+    identy::io::ColumnView view;
+    view.name = column.name;
+    view.type = column.type;
+    view.byte_width = column.byte_width;
+    view.length = column.length;
+    view.null_count = column.null_count;
+    view.validity = column.validity.bytes();
+    view.offsets = column.offsets.bytes();
+    view.values = column.values.bytes();
+
+    view.children.reserve(column.children.size());
+    for(const auto& child : column.children) {
+        view.children.push_back(make_view(child));
+    }
+
+    return view;
+}
+
+void count_nodes(const Column& column, std::size_t& nodes, std::size_t& names, std::size_t& buffers)
+{
+    ++nodes;
+    names += column.name.size();
+    buffers += align_up(column.validity.size(), identy::io::columnar_alignment);
+    buffers += align_up(column.offsets.size(), identy::io::columnar_alignment);
+    buffers += align_up(column.values.size(), identy::io::columnar_alignment);
+
+    for(const auto& child : column.children) {
+        count_nodes(child, nodes, names, buffers);
+    }
+}
+
+struct EncodeCursor
+{
+    identy::byte* base;
+    std::size_t node;
+    std::size_t name;
+    std::size_t buffer;
+};
+
+void encode_node(const Column& column, EncodeCursor& cursor)
+{
+    auto* node = cursor.base + cursor.node;
+    cursor.node += node_size;
+
+    store_le(node + node_type_offset, static_cast<std::uint16_t>(column.type));
+    store_le(node + node_child_count_offset, static_cast<std::uint16_t>(column.children.size()));
+    store_le(node + node_byte_width_offset, column.byte_width);
+    store_le(node + node_length_offset, column.length);
+    store_le(node + node_null_count_offset, column.null_count);
+    store_le(node + node_name_offset, static_cast<std::uint32_t>(cursor.name));
+    store_le(node + node_name_size_offset, static_cast<std::uint32_t>(column.name.size()));
+
+    std::memcpy(cursor.base + cursor.name, column.name.data(), column.name.size());
+    cursor.name += column.name.size();
+
+    const identy::io::AlignedBuffer* buffers[node_buffer_count] = { &column.validity, &column.offsets, &column.values };
+
+    for(std::size_t i = 0; i < node_buffer_count; ++i) {
+        auto* entry = node + node_buffers_offset + i * 16;
+        auto size = buffers[i]->size();
+
+        store_le<std::uint64_t>(entry, size == 0 ? 0 : cursor.buffer);
+        store_le<std::uint64_t>(entry + 8, size);
+
+        if(size != 0) {
+            std::memcpy(cursor.base + cursor.buffer, buffers[i]->data(), size);
+            cursor.buffer += align_up(size, identy::io::columnar_alignment);
+        }
+    }
+
+    for(const auto& child : column.children) {
+        encode_node(child, cursor);
+    }
+}
+
+bool column_shape_valid(const identy::io::ColumnView& view) noexcept
+{
+    if(view.null_count > view.length) {
+        return false;
+    }
+
+    if(view.null_count != 0 && view.validity.size() < bitmap_size(view.length)) {
+        return false;
+    }
+
+    auto offsets_valid = [&](std::size_t data_size) {
+        if(view.offsets.size() != (view.length + 1) * sizeof(std::int32_t)) {
+            return false;
+        }
+
+        auto offsets = view.offsets_as();
+        return offsets.front() >= 0 && static_cast<std::size_t>(offsets.back()) <= data_size;
+    };
+
+    switch(view.type) {
+        case ColumnType::Bool:
+            return view.children.empty() && view.values.size() >= bitmap_size(view.length);
+        case ColumnType::UInt8:
+            return view.children.empty() && view.values.size() >= view.length;
+        case ColumnType::Int32:
+        case ColumnType::UInt32:
+            return view.children.empty() && view.values.size() >= view.length * 4;
+        case ColumnType::FixedSizeBinary:
+            return view.children.empty() && view.values.size() >= view.length * view.byte_width;
+        case ColumnType::Utf8:
+            return view.children.empty() && offsets_valid(view.values.size());
+        case ColumnType::Dictionary:
+            return view.children.size() == 1 && view.children.front().type == ColumnType::Utf8
+                && view.values.size() >= view.length * 4;
+        case ColumnType::List:
+            return view.children.size() == 1 && offsets_valid(static_cast<std::size_t>(view.children.front().length));
+        case ColumnType::Struct:
+            return std::ranges::all_of(view.children, [&](const auto& child) { return child.length == view.length; });
+        default:
+            return false;
+    }
+}
+
+struct DecodeCursor
+{
+    std::span<const identy::byte> file;
+    std::size_t node;
+    std::size_t nodes_left;
+};
+
+std::optional<identy::io::ColumnView> decode_node(DecodeCursor& cursor, std::size_t depth)
+{
+    if(cursor.nodes_left == 0 || depth > max_node_depth) {
+        return std::nullopt;
+    }
+
+    --cursor.nodes_left;
+
+    const auto* node = cursor.file.data() + cursor.node;
+    cursor.node += node_size;
+
+    identy::io::ColumnView view;
+    view.type = static_cast<ColumnType>(load_le<std::uint16_t>(node + node_type_offset));
+    view.byte_width = load_le<std::uint32_t>(node + node_byte_width_offset);
+    view.length = load_le<std::uint64_t>(node + node_length_offset);
+    view.null_count = load_le<std::uint64_t>(node + node_null_count_offset);
+
+    // every row takes at least one bit of some buffer; also keeps size math below from overflowing
+    if(view.length > static_cast<std::uint64_t>(cursor.file.size()) * 8) {
+        return std::nullopt;
+    }
+
+    auto name_offset = load_le<std::uint32_t>(node + node_name_offset);
+    auto name_size = load_le<std::uint32_t>(node + node_name_size_offset);
+    if(static_cast<std::uint64_t>(name_offset) + name_size > cursor.file.size()) {
+        return std::nullopt;
+    }
+    view.name = { reinterpret_cast<const char*>(cursor.file.data() + name_offset), name_size };
+
+    std::span<const identy::byte>* buffers[node_buffer_count] = { &view.validity, &view.offsets, &view.values };
+
+    for(std::size_t i = 0; i < node_buffer_count; ++i) {
+        const auto* entry = node + node_buffers_offset + i * 16;
+        auto offset = load_le<std::uint64_t>(entry);
+        auto size = load_le<std::uint64_t>(entry + 8);
+
+        if(offset % identy::io::columnar_alignment != 0 || offset > cursor.file.size()
+           || size > cursor.file.size() - offset) {
+            return std::nullopt;
+        }
+
+        *buffers[i] = cursor.file.subspan(static_cast<std::size_t>(offset), static_cast<std::size_t>(size));
+    }
+
+    auto child_count = load_le<std::uint16_t>(node + node_child_count_offset);
+    for(std::size_t i = 0; i < child_count; ++i) {
+        auto child = decode_node(cursor, depth + 1);
+        if(!child) {
+            return std::nullopt;
+        }
+        view.children.push_back(std::move(*child));
+    }
+
+    if(!column_shape_valid(view)) {
+        return std::nullopt;
+    }
+
+    return view;
+}
+} // namespace
+
+// ============================================================================
+// AlignedBuffer
+// ============================================================================
+
+identy::io::AlignedBuffer::AlignedBuffer(AlignedBuffer&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr))
+    , m_size(std::exchange(other.m_size, 0))
+    , m_capacity(std::exchange(other.m_capacity, 0))
+{
+}
+
+identy::io::AlignedBuffer& identy::io::AlignedBuffer::operator=(AlignedBuffer&& other) noexcept
+{
+    if(this != &other) {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_capacity, other.m_capacity);
+    }
+    return *this;
+}
+
+identy::io::AlignedBuffer::~AlignedBuffer()
+{
+    if(m_data != nullptr) {
+        ::operator delete(m_data, std::align_val_t { columnar_alignment });
+    }
+}
+
+void identy::io::AlignedBuffer::reserve(std::size_t capacity)
+{
+    if(capacity <= m_capacity) {
+        return;
+    }
+
+    capacity = align_up(std::max(capacity, m_capacity * 2), columnar_alignment);
+
+    auto* data = static_cast<byte*>(::operator new(capacity, std::align_val_t { columnar_alignment }));
+    if(m_size != 0) {
+        std::memcpy(data, m_data, m_size);
+    }
+    // padding past the logical size stays zeroed
+    std::memset(data + m_size, 0, capacity - m_size);
+
+    if(m_data != nullptr) {
+        ::operator delete(m_data, std::align_val_t { columnar_alignment });
+    }
+
+    m_data = data;
+    m_capacity = capacity;
+}
+
+void identy::io::AlignedBuffer::append(const void* data, std::size_t size)
+{
+    if(size == 0) {
+        return;
+    }
+
+    reserve(m_size + size);
+    std::memcpy(m_data + m_size, data, size);
+    m_size += size;
+}
+
+void identy::io::AlignedBuffer::resize(std::size_t size)
+{
+    if(size <= m_size) {
+        return;
+    }
+
+    reserve(size);
+    m_size = size;
+}
+
+void identy::io::AlignedBuffer::clear() noexcept
+{
+    if(m_data != nullptr) {
+        std::memset(m_data, 0, m_size);
+    }
+    m_size = 0;
+}
+
+// ============================================================================
+// ColumnView
+// ============================================================================
+
+bool identy::io::ColumnView::is_valid(std::size_t row) const noexcept
+{
+    if(row >= length) {
+        return false;
+    }
+
+    return null_count == 0 || get_bit(validity, row);
+}
+
+bool identy::io::ColumnView::bool_at(std::size_t row) const noexcept
+{
+    return row < length && get_bit(values, row);
+}
+
+std::string_view identy::io::ColumnView::string_at(std::size_t row) const noexcept
+{
+    if(!is_valid(row)) {
+        return {};
+    }
+
+    if(type == ColumnType::Dictionary) {
+        auto index = values_as<std::int32_t>()[row];
+        return index < 0 ? std::string_view {} : children.front().string_at(static_cast<std::size_t>(index));
+    }
+
+    if(type != ColumnType::Utf8) {
+        return {};
+    }
+
+    auto bounds = offsets_as();
+    auto begin = bounds[row];
+    auto end = bounds[row + 1];
+
+    if(begin < 0 || end < begin || static_cast<std::size_t>(end) > values.size()) {
+        return {};
+    }
+
+    return { reinterpret_cast<const char*>(values.data()) + begin, static_cast<std::size_t>(end - begin) };
+}
+
+std::span<const identy::byte> identy::io::ColumnView::binary_at(std::size_t row) const noexcept
+{
+    if(type != ColumnType::FixedSizeBinary || row >= length) {
+        return {};
+    }
+
+    return values.subspan(row * byte_width, byte_width);
+}
+
+const identy::io::ColumnView* identy::io::ColumnView::child(std::string_view child_name) const noexcept
+{
+    auto it = std::ranges::find(children, child_name, &ColumnView::name);
+    return it == children.end() ? nullptr : &*it;
+}
+
+// ============================================================================
+// ColumnarBatch
+// ============================================================================
+
+std::uint64_t identy::io::ColumnarBatch::row_count() const noexcept
+{
+    return m_rows;
+}
+
+std::vector<identy::io::ColumnView> identy::io::ColumnarBatch::columns() const
+{
+    std::vector<ColumnView> views;
+    views.reserve(m_columns.size());
+
+    for(const auto& column : m_columns) {
+        views.push_back(make_view(column));
+    }
+
+    return views;
+}
+
+std::optional<identy::io::ColumnView> identy::io::ColumnarBatch::column(std::string_view name) const
+{
+    auto it = std::ranges::find(m_columns, name, &Column::name);
+    if(it == m_columns.end()) {
+        return std::nullopt;
+    }
+
+    return make_view(*it);
+}
+
+std::size_t identy::io::ColumnarBatch::encode(std::vector<byte>& out) const
+{
+    std::size_t nodes = 0;
+    std::size_t names = 0;
+    std::size_t buffers = 0;
+
+    for(const auto& column : m_columns) {
+        count_nodes(column, nodes, names, buffers);
+    }
+
+    auto names_offset = header_size + nodes * node_size;
+    auto buffers_offset = align_up(names_offset + names, columnar_alignment);
+    auto total = buffers_offset + buffers;
+
+    auto start = out.size();
+    out.resize(start + total);
+
+    auto* base = out.data() + start;
+
+    std::memcpy(base, columnar_magic, sizeof(columnar_magic));
+    store_le(base + header_version_offset, columnar_version);
+    store_le(base + header_rows_offset, m_rows);
+    store_le(base + header_column_count_offset, static_cast<std::uint32_t>(m_columns.size()));
+    store_le(base + header_node_count_offset, static_cast<std::uint32_t>(nodes));
+    store_le(base + header_total_size_offset, static_cast<std::uint64_t>(total));
+
+    EncodeCursor cursor { base, header_size, names_offset, buffers_offset };
+    for(const auto& column : m_columns) {
+        encode_node(column, cursor);
+    }
+
+    return total;
+}
+
+void identy::io::ColumnarBatch::write(std::ostream& stream) const
+{
+    if(!stream.good()) {
+        return;
+    }
+
+    std::vector<byte> buffer;
+    encode(buffer);
+
+    stream.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+}
+
+// ============================================================================
+// ColumnarBatchBuilder
+// ============================================================================
+
+struct identy::io::ColumnarBatchBuilder::State
+{
+    enum Index : std::size_t {
+        CpuVendor,
+        CpuBrand,
+        CpuVersion,
+        CpuLogicalProcessors,
+        CpuIsaBasic,
+        CpuIsaModern,
+        CpuIsaExtended0,
+        CpuIsaExtended1,
+        CpuIsaExtended2,
+        CpuApicId,
+        CpuBrandIndex,
+        CpuClflushLineSize,
+        CpuHypervisor,
+        CpuTooOld,
+        CpuHypervisorSignature,
+        SmbiosUuid,
+        SmbiosMajorVersion,
+        SmbiosMinorVersion,
+        SmbiosDmiVersion,
+        Smbios20Calling,
+        SmbiosTablesSize,
+        SmbiosTier,
+        Drives,
+        ColumnCount
+    };
+
+    enum DriveField : std::size_t {
+        DriveBus,
+        DriveDevice,
+        DriveSerial,
+        DriveModel,
+        DriveVendor,
+        DriveProduct,
+        DrivePaths
+    };
+
+    State()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        batch = ColumnarBatch {};
+        auto& columns = batch.m_columns;
+        columns.reserve(ColumnCount);
+
+        columns.push_back(make_column("cpu_vendor", ColumnType::Dictionary));
+        columns.push_back(make_column("cpu_brand", ColumnType::Dictionary));
+        columns.push_back(make_column("cpu_version", ColumnType::Int32));
+        columns.push_back(make_column("cpu_logical_processors", ColumnType::Int32));
+        columns.push_back(make_column("cpu_isa_basic", ColumnType::Int32));
+        columns.push_back(make_column("cpu_isa_modern", ColumnType::Int32));
+        columns.push_back(make_column("cpu_isa_extended_0", ColumnType::Int32));
+        columns.push_back(make_column("cpu_isa_extended_1", ColumnType::Int32));
+        columns.push_back(make_column("cpu_isa_extended_2", ColumnType::Int32));
+        columns.push_back(make_column("cpu_apic_id", ColumnType::UInt8));
+        columns.push_back(make_column("cpu_brand_index", ColumnType::UInt8));
+        columns.push_back(make_column("cpu_clflush_line_size", ColumnType::UInt8));
+        columns.push_back(make_column("cpu_hypervisor", ColumnType::Bool));
+        columns.push_back(make_column("cpu_too_old", ColumnType::Bool));
+        columns.push_back(make_column("cpu_hypervisor_signature", ColumnType::Utf8));
+        columns.push_back(make_column("smbios_uuid", ColumnType::FixedSizeBinary, SMBIOS_uuid_length));
+        columns.push_back(make_column("smbios_major_version", ColumnType::UInt8));
+        columns.push_back(make_column("smbios_minor_version", ColumnType::UInt8));
+        columns.push_back(make_column("smbios_dmi_version", ColumnType::UInt8));
+        columns.push_back(make_column("smbios_20_calling", ColumnType::Bool));
+        columns.push_back(make_column("smbios_tables_size", ColumnType::UInt32));
+        columns.push_back(make_column("smbios_tier", ColumnType::UInt8));
+
+        auto drive = make_column("item", ColumnType::Struct);
+        drive.children.push_back(make_column("bus", ColumnType::UInt8));
+        drive.children.push_back(make_column("device", ColumnType::Utf8));
+        drive.children.push_back(make_column("serial", ColumnType::Utf8));
+        drive.children.push_back(make_column("model", ColumnType::Dictionary));
+        drive.children.push_back(make_column("vendor", ColumnType::Dictionary));
+        drive.children.push_back(make_column("product", ColumnType::Dictionary));
+        drive.children.push_back(make_column("paths", ColumnType::UInt32));
+
+        auto drives = make_column("drives", ColumnType::List);
+        drives.children.push_back(std::move(drive));
+        columns.push_back(std::move(drives));
+
+        for(auto& dictionary : dictionaries) {
+            dictionary.clear();
+        }
+    }
+
+    Column& at(Index index) noexcept
+    {
+        return batch.m_columns[index];
+    }
+
+    ColumnarBatch batch;
+
+    // cpu_vendor, cpu_brand, drive model, drive vendor, drive product
+    Dictionary dictionaries[5];
+};
+
+identy::io::ColumnarBatchBuilder::ColumnarBatchBuilder()
+    : m_state(std::make_unique<State>())
+{
+}
+
+identy::io::ColumnarBatchBuilder::ColumnarBatchBuilder(ColumnarBatchBuilder&&) noexcept = default;
+identy::io::ColumnarBatchBuilder& identy::io::ColumnarBatchBuilder::operator=(ColumnarBatchBuilder&&) noexcept = default;
+identy::io::ColumnarBatchBuilder::~ColumnarBatchBuilder() = default;
+
+void identy::io::ColumnarBatchBuilder::reserve(std::size_t rows)
+{
+    for(auto& column : m_state->batch.m_columns) {
+        switch(column.type) {
+            case ColumnType::Int32:
+            case ColumnType::UInt32:
+            case ColumnType::Dictionary:
+                column.values.reserve(rows * 4);
+                break;
+            case ColumnType::UInt8:
+                column.values.reserve(rows);
+                break;
+            case ColumnType::FixedSizeBinary:
+                column.values.reserve(rows * column.byte_width);
+                break;
+            case ColumnType::Utf8:
+            case ColumnType::List:
+                column.offsets.reserve((rows + 1) * 4);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void identy::io::ColumnarBatchBuilder::append(const MotherboardEx& mb)
+{
+    auto& state = *m_state;
+    const auto& cpu = mb.cpu;
+    const auto& smbios = mb.smbios;
+
+    append_dictionary(state.at(State::CpuVendor), state.dictionaries[0], cpu.vendor);
+    append_dictionary(state.at(State::CpuBrand), state.dictionaries[1], cpu.extended_brand_string);
+    append_fixed<std::int32_t>(state.at(State::CpuVersion), cpu.version);
+    append_fixed<std::int32_t>(state.at(State::CpuLogicalProcessors), cpu.logical_processors_count);
+    append_fixed<std::int32_t>(state.at(State::CpuIsaBasic), cpu.instruction_set.basic);
+    append_fixed<std::int32_t>(state.at(State::CpuIsaModern), cpu.instruction_set.modern);
+    append_fixed<std::int32_t>(state.at(State::CpuIsaExtended0), cpu.instruction_set.extended_modern[0]);
+    append_fixed<std::int32_t>(state.at(State::CpuIsaExtended1), cpu.instruction_set.extended_modern[1]);
+    append_fixed<std::int32_t>(state.at(State::CpuIsaExtended2), cpu.instruction_set.extended_modern[2]);
+    append_fixed<std::uint8_t>(state.at(State::CpuApicId), cpu.apic_id);
+    append_fixed<std::uint8_t>(state.at(State::CpuBrandIndex), cpu.brand_index);
+    append_fixed<std::uint8_t>(state.at(State::CpuClflushLineSize), cpu.clflush_line_size);
+    append_bool(state.at(State::CpuHypervisor), cpu.hypervisor_bit);
+    append_bool(state.at(State::CpuTooOld), cpu.too_old);
+    append_utf8(state.at(State::CpuHypervisorSignature), cpu.hypervisor_signature, !cpu.hypervisor_signature.empty());
+
+    bool has_uuid = std::ranges::any_of(smbios.uuid, [](byte b) { return b != 0; });
+    append_binary(state.at(State::SmbiosUuid), smbios.uuid, has_uuid);
+    append_fixed<std::uint8_t>(state.at(State::SmbiosMajorVersion), smbios.major_version);
+    append_fixed<std::uint8_t>(state.at(State::SmbiosMinorVersion), smbios.minor_version);
+    append_fixed<std::uint8_t>(state.at(State::SmbiosDmiVersion), smbios.dmi_version);
+    append_bool(state.at(State::Smbios20Calling), smbios.is_20_calling_used);
+    append_fixed(state.at(State::SmbiosTablesSize), static_cast<std::uint32_t>(smbios.raw_tables_data.size()));
+    append_fixed(state.at(State::SmbiosTier), static_cast<std::uint8_t>(smbios.tier));
+
+    auto& drives = state.at(State::Drives);
+    auto& item = drives.children.front();
+    auto& fields = item.children;
+
+    for(const auto& drive : mb.drives) {
+        append_fixed(fields[State::DriveBus], static_cast<std::uint8_t>(drive.bus_type));
+        append_utf8(fields[State::DriveDevice], drive.device_name);
+        append_utf8(fields[State::DriveSerial], drive.serial);
+        append_dictionary(fields[State::DriveModel], state.dictionaries[2], drive.model_id);
+        append_dictionary(fields[State::DriveVendor], state.dictionaries[3], drive.vendor_id);
+        append_dictionary(fields[State::DriveProduct], state.dictionaries[4], drive.product_id);
+        append_fixed(fields[State::DrivePaths], drive.path_count);
+
+        append_validity(item, true);
+        ++item.length;
+    }
+
+    append_validity(drives, true);
+    drives.offsets.append_value(static_cast<std::int32_t>(item.length));
+    ++drives.length;
+
+    ++state.batch.m_rows;
+}
+
+void identy::io::ColumnarBatchBuilder::append(std::span<const MotherboardEx> boards)
+{
+    reserve(size() + boards.size());
+
+    for(const auto& mb : boards) {
+        append(mb);
+    }
+}
+
+std::size_t identy::io::ColumnarBatchBuilder::size() const noexcept
+{
+    return static_cast<std::size_t>(m_state->batch.m_rows);
+}
+
+identy::io::ColumnarBatch identy::io::ColumnarBatchBuilder::finish()
+{
+    auto batch = std::move(m_state->batch);
+    m_state->reset();
+    return batch;
+}
+
+// ============================================================================
+// ColumnarReader
+// ============================================================================
+
+std::optional<identy::io::ColumnarReader> identy::io::ColumnarReader::open(std::span<const byte> buffer)
+{
+    if(buffer.size() < header_size || std::memcmp(buffer.data(), columnar_magic, sizeof(columnar_magic)) != 0) {
+        return std::nullopt;
+    }
+
+    auto version = load_le<std::uint32_t>(buffer.data() + header_version_offset);
+    if(version == 0 || version > columnar_version) {
+        return std::nullopt;
+    }
+
+    auto total = load_le<std::uint64_t>(buffer.data() + header_total_size_offset);
+    auto columns = load_le<std::uint32_t>(buffer.data() + header_column_count_offset);
+    auto nodes = load_le<std::uint32_t>(buffer.data() + header_node_count_offset);
+
+    if(total > buffer.size() || header_size + static_cast<std::uint64_t>(nodes) * node_size > total) {
+        return std::nullopt;
+    }
+
+    ColumnarReader reader;
+    reader.m_rows = load_le<std::uint64_t>(buffer.data() + header_rows_offset);
+
+    DecodeCursor cursor { buffer.first(static_cast<std::size_t>(total)), header_size, nodes };
+
+    for(std::uint32_t i = 0; i < columns; ++i) {
+        auto column = decode_node(cursor, 0);
+        if(!column || column->length != reader.m_rows) {
+            return std::nullopt;
+        }
+        reader.m_columns.push_back(std::move(*column));
+    }
+
+    if(cursor.nodes_left != 0) {
+        return std::nullopt;
+    }
+
+    return reader;
+}
+
+std::uint64_t identy::io::ColumnarReader::row_count() const noexcept
+{
+    return m_rows;
+}
+
+const std::vector<identy::io::ColumnView>& identy::io::ColumnarReader::columns() const noexcept
+{
+    return m_columns;
+}
+
+const identy::io::ColumnView* identy::io::ColumnarReader::column(std::string_view name) const noexcept
+{
+    auto it = std::ranges::find(m_columns, name, &ColumnView::name);
+    return it == m_columns.end() ? nullptr : &*it;
+}
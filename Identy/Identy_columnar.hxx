@@ -0,0 +1,334 @@
+/**
+ * @file Identy_columnar.hxx
+ * @brief Columnar batch export of snapshots for analytics loaders
+ *
+ * ColumnarBatchBuilder turns a sequence of MotherboardEx values into typed
+ * column buffers instead of serializing one row after another. The buffers
+ * follow the Apache Arrow columnar memory layout, so a loader can hand them to
+ * Arrow (or any engine speaking the layout) without conversion:
+ *
+ * - every buffer is 64-byte aligned and zero-padded to a multiple of 64 bytes
+ * - validity bitmaps are LSB-ordered, present only when a column has nulls
+ * - variable-size data uses int32 offsets with length + 1 entries
+ * - booleans are bit-packed
+ * - repeated strings (CPU vendor and brand, drive model/vendor/product) are
+ *   dictionary encoded with int32 indices into a Utf8 dictionary
+ * - the SMBIOS UUID is a fixed_size_binary(16) column
+ * - drives are a list<struct<...>> column with per-row offsets
+ *
+ * ## Batch File Layout (version 1)
+ *
+ * ColumnarBatch::encode() writes a self-describing container that can be
+ * mmapped and read back with ColumnarReader without copying:
+ *
+ * | Size       | Content                                                     |
+ * |------------|-------------------------------------------------------------|
+ * | 32         | Header: magic "IDCB", version, row count, column/node count |
+ * | 80*N       | Node table, columns in pre-order (children follow parent)   |
+ * | ...        | Column names                                                |
+ * | ...        | Buffers, each 64-byte aligned                               |
+ *
+ * Header fields and the node table are little-endian. Buffer contents use the
+ * host byte order as Arrow does; batches are only exchanged between
+ * little-endian hosts.
+ *
+ * @note Arrow IPC schema/record batch flatbuffer messages are not produced;
+ *       a loader maps the buffers into Arrow arrays using the node table.
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_COLUMNAR_H
+#define UNC_IDENTY_COLUMNAR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Identy_hwid.hxx"
+
+namespace identy::io
+{
+/** @brief Magic bytes at the beginning of a columnar batch file ("IDCB") */
+constexpr byte columnar_magic[4] = { 'I', 'D', 'C', 'B' };
+
+/** @brief Current columnar batch file version */
+constexpr std::uint32_t columnar_version = 1;
+
+/** @brief Alignment and padding of every column buffer */
+constexpr std::size_t columnar_alignment = 64;
+
+/**
+ * @brief Physical column types, mirroring the Arrow types they map to
+ */
+enum class ColumnType : std::uint16_t {
+    Bool = 1,            /**< Bit-packed boolean */
+    UInt8 = 2,           /**< uint8 values */
+    Int32 = 3,           /**< int32 values */
+    UInt32 = 4,          /**< uint32 values */
+    FixedSizeBinary = 5, /**< byte_width bytes per row */
+    Utf8 = 6,            /**< int32 offsets + character data */
+    Dictionary = 7,      /**< int32 indices, child 0 is the Utf8 dictionary */
+    List = 8,            /**< int32 offsets, child 0 holds the list items */
+    Struct = 9           /**< no own buffers besides validity, children are the fields */
+};
+
+/**
+ * @brief Growable byte buffer with 64-byte aligned, zero-padded storage
+ */
+class AlignedBuffer final
+{
+public:
+    AlignedBuffer() = default;
+    AlignedBuffer(AlignedBuffer&& other) noexcept;
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept;
+    ~AlignedBuffer();
+
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+    /** @brief Appends raw bytes */
+    void append(const void* data, std::size_t size);
+
+    /** @brief Appends one trivially copyable value in host byte order */
+    template<typename T>
+    void append_value(T value)
+    {
+        append(&value, sizeof(T));
+    }
+
+    /** @brief Grows the buffer with zero bytes up to @p size */
+    void resize(std::size_t size);
+
+    /** @brief Ensures capacity for at least @p capacity bytes */
+    void reserve(std::size_t capacity);
+
+    /** @brief Drops the contents, keeping the allocation */
+    void clear() noexcept;
+
+    byte* data() noexcept
+    {
+        return m_data;
+    }
+
+    const byte* data() const noexcept
+    {
+        return m_data;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    std::span<const byte> bytes() const noexcept
+    {
+        return { m_data, m_size };
+    }
+
+private:
+    byte* m_data { nullptr };
+    std::size_t m_size { 0 };
+    std::size_t m_capacity { 0 };
+};
+
+/**
+ * @brief Non-owning view of one column and its buffers
+ *
+ * Produced both by ColumnarBatch (pointing into the batch) and by
+ * ColumnarReader (pointing into the mapped file).
+ */
+struct ColumnView
+{
+    std::string_view name;
+    ColumnType type { ColumnType::UInt8 };
+
+    /** @brief Row width of FixedSizeBinary columns, 0 otherwise */
+    std::uint32_t byte_width { 0 };
+
+    std::uint64_t length { 0 };
+    std::uint64_t null_count { 0 };
+
+    /** @brief Validity bitmap, empty when the column has no nulls */
+    std::span<const byte> validity;
+
+    /** @brief int32 offsets of Utf8 and List columns */
+    std::span<const byte> offsets;
+
+    /** @brief Values, character data or dictionary indices */
+    std::span<const byte> values;
+
+    std::vector<ColumnView> children;
+
+    /** @brief Whether row @p row holds a value */
+    bool is_valid(std::size_t row) const noexcept;
+
+    /** @brief Value buffer reinterpreted as @p T (Int32, UInt32, UInt8, Dictionary indices) */
+    template<typename T>
+    std::span<const T> values_as() const noexcept
+    {
+        return { reinterpret_cast<const T*>(values.data()), values.size() / sizeof(T) };
+    }
+
+    /** @brief Offset buffer of Utf8 and List columns */
+    std::span<const std::int32_t> offsets_as() const noexcept
+    {
+        return { reinterpret_cast<const std::int32_t*>(offsets.data()), offsets.size() / sizeof(std::int32_t) };
+    }
+
+    /** @brief Bit of a Bool column */
+    bool bool_at(std::size_t row) const noexcept;
+
+    /**
+     * @brief String of a Utf8 or Dictionary column
+     *
+     * @return The string, empty for nulls and out-of-range rows
+     */
+    std::string_view string_at(std::size_t row) const noexcept;
+
+    /** @brief Row of a FixedSizeBinary column, empty for out-of-range rows */
+    std::span<const byte> binary_at(std::size_t row) const noexcept;
+
+    /** @brief Child column by name (Struct fields) */
+    const ColumnView* child(std::string_view child_name) const noexcept;
+};
+
+/**
+ * @brief Immutable set of column buffers produced by ColumnarBatchBuilder
+ */
+class ColumnarBatch final
+{
+public:
+    /** @brief Owning storage of one column */
+    struct Column
+    {
+        std::string name;
+        ColumnType type { ColumnType::UInt8 };
+        std::uint32_t byte_width { 0 };
+        std::uint64_t length { 0 };
+        std::uint64_t null_count { 0 };
+        AlignedBuffer validity;
+        AlignedBuffer offsets;
+        AlignedBuffer values;
+        std::vector<Column> children;
+    };
+
+    /** @brief Number of rows (snapshots) in the batch */
+    std::uint64_t row_count() const noexcept;
+
+    /** @brief Views of all top-level columns */
+    std::vector<ColumnView> columns() const;
+
+    /** @brief View of a top-level column by name */
+    std::optional<ColumnView> column(std::string_view name) const;
+
+    /**
+     * @brief Appends the batch file representation to @p out
+     *
+     * @return Number of bytes appended
+     */
+    std::size_t encode(std::vector<byte>& out) const;
+
+    /** @brief Writes the batch file representation to a binary stream */
+    void write(std::ostream& stream) const;
+
+private:
+    friend class ColumnarBatchBuilder;
+
+    std::uint64_t m_rows { 0 };
+    std::vector<Column> m_columns;
+};
+
+/**
+ * @brief Accumulates snapshots column by column
+ *
+ * Example usage:
+ * @code
+ * identy::io::ColumnarBatchBuilder builder;
+ * builder.append(snapshots);
+ *
+ * std::ofstream file("fleet.idcb", std::ios::binary);
+ * builder.finish().write(file);
+ * @endcode
+ *
+ * Top-level columns: cpu_vendor, cpu_brand (dictionary), cpu_version,
+ * cpu_logical_processors, cpu_isa_basic, cpu_isa_modern,
+ * cpu_isa_extended_0..2 (int32), cpu_apic_id, cpu_brand_index,
+ * cpu_clflush_line_size (uint8), cpu_hypervisor, cpu_too_old (bool),
+ * cpu_hypervisor_signature (utf8, null when empty), smbios_uuid
+ * (fixed_size_binary(16), null when all zero), smbios_major_version,
+ * smbios_minor_version, smbios_dmi_version (uint8), smbios_20_calling (bool),
+ * smbios_tables_size (uint32), smbios_tier (uint8, SmbiosTier) and drives
+ * (list of struct with bus (uint8), device, serial (utf8), model, vendor,
+ * product (dictionary), paths (uint32)).
+ */
+class ColumnarBatchBuilder final
+{
+public:
+    ColumnarBatchBuilder();
+    ColumnarBatchBuilder(ColumnarBatchBuilder&&) noexcept;
+    ColumnarBatchBuilder& operator=(ColumnarBatchBuilder&&) noexcept;
+    ~ColumnarBatchBuilder();
+
+    /** @brief Reserves column storage for @p rows snapshots */
+    void reserve(std::size_t rows);
+
+    /** @brief Appends one snapshot as a row */
+    void append(const MotherboardEx& mb);
+
+    /** @brief Appends a range of snapshots */
+    void append(std::span<const MotherboardEx> boards);
+
+    /** @brief Number of rows appended since the last finish() */
+    std::size_t size() const noexcept;
+
+    /** @brief Hands out the accumulated columns and resets the builder */
+    ColumnarBatch finish();
+
+private:
+    struct State;
+    std::unique_ptr<State> m_state;
+};
+
+/**
+ * @brief Zero-copy reader of columnar batch files
+ *
+ * Column views point into the buffer passed to open(), which must outlive the
+ * reader. Buffers are 64-byte aligned relative to the file start, so mapping
+ * the file keeps typed access aligned.
+ */
+class ColumnarReader final
+{
+public:
+    /**
+     * @brief Validates a batch file and builds the column views
+     *
+     * @param buffer Complete batch file
+     * @return Reader, std::nullopt if the file is malformed or of unknown version
+     */
+    static std::optional<ColumnarReader> open(std::span<const byte> buffer);
+
+    /** @brief Number of rows in the batch */
+    std::uint64_t row_count() const noexcept;
+
+    /** @brief All top-level columns */
+    const std::vector<ColumnView>& columns() const noexcept;
+
+    /** @brief Top-level column by name, nullptr if absent */
+    const ColumnView* column(std::string_view name) const noexcept;
+
+private:
+    ColumnarReader() = default;
+
+    std::uint64_t m_rows { 0 };
+    std::vector<ColumnView> m_columns;
+};
+} // namespace identy::io
+
+#endif
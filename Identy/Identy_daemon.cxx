@@ -0,0 +1,388 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_daemon.hxx"
+
+#include <atomic>
+#include <chrono>
+
+#include "Identy_io.hxx"
+#include "detail/Identy_bytes.hxx"
+#include "Platform/Identy_platform_ipc.hxx"
+
+namespace
+{
+constexpr std::size_t request_query_offset = 4;
+
+constexpr std::size_t reply_query_offset = 4;
+constexpr std::size_t reply_status_offset = 5;
+constexpr std::size_t reply_size_offset = 8;
+
+constexpr std::size_t verdict_header_size = 8;
+
+constexpr std::uint32_t shared_magic = 0x48534449; // "IDSH" little-endian
+constexpr std::uint32_t shared_version = 1;
+
+// Spins before a reader gives up on a publisher that died mid-update
+constexpr std::uint32_t max_read_attempts = 1 << 20;
+
+constexpr std::size_t hash_words = sizeof(identy::hs::Hash256::buffer) / sizeof(std::uint64_t);
+
+/**
+ * Layout of the shared memory segment. Every field is an atomic word so
+ * readers racing with the publisher stay well-defined; the sequence is odd
+ * while an update is in progress.
+ */
+struct SharedBlock
+{
+    std::atomic<std::uint32_t> magic;
+    std::atomic<std::uint32_t> version;
+    std::atomic<std::uint64_t> sequence;
+    std::array<std::atomic<std::uint64_t>, hash_words> hash;
+    std::atomic<std::uint64_t> generation;
+    std::atomic<std::uint64_t> updated_unix_ns;
+    std::atomic<std::uint64_t> confidence;
+    std::atomic<std::uint64_t> detections;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "seqlock needs address-free atomics");
+
+using identy::detail::store_le;
+using identy::detail::load_le;
+
+std::uint64_t detection_mask(const std::vector<identy::vm::VMFlags>& detections) noexcept
+{
+    std::uint64_t mask = 0;
+
+    for(auto flag : detections) {
+        auto bit = static_cast<unsigned>(flag);
+        if(bit < 64) {
+            mask |= std::uint64_t { 1 } << bit;
+        }
+    }
+
+    return mask;
+}
+
+std::uint64_t unix_now_ns() noexcept
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+}
+} // namespace
+
+void identy::daemon::encode_request(std::vector<byte>& out, Query query)
+{
+    auto offset = out.size();
+    out.resize(offset + request_size);
+
+    std::memcpy(out.data() + offset, request_magic, sizeof(request_magic));
+    out[offset + request_query_offset] = static_cast<byte>(query);
+}
+
+std::optional<identy::daemon::Query> identy::daemon::decode_request(std::span<const byte> buffer) noexcept
+{
+    if(buffer.size() != request_size || std::memcmp(buffer.data(), request_magic, sizeof(request_magic)) != 0) {
+        return std::nullopt;
+    }
+
+    auto query = static_cast<Query>(buffer[request_query_offset]);
+
+    switch(query) {
+        case Query::Fingerprint:
+        case Query::Snapshot:
+        case Query::Verdict:
+            return query;
+    }
+
+    return std::nullopt;
+}
+
+void identy::daemon::encode_reply(std::vector<byte>& out, Query query, Status status, std::span<const byte> payload)
+{
+    auto offset = out.size();
+    out.resize(offset + reply_header_size);
+
+    auto* header = out.data() + offset;
+    std::memcpy(header, reply_magic, sizeof(reply_magic));
+    header[reply_query_offset] = static_cast<byte>(query);
+    header[reply_status_offset] = static_cast<byte>(status);
+    store_le(header + reply_size_offset, static_cast<std::uint32_t>(payload.size()));
+
+    out.insert(out.end(), payload.begin(), payload.end());
+}
+
+std::optional<identy::daemon::Reply> identy::daemon::decode_reply(std::span<const byte> buffer) noexcept
+{
+    if(buffer.size() < reply_header_size || std::memcmp(buffer.data(), reply_magic, sizeof(reply_magic)) != 0) {
+        return std::nullopt;
+    }
+
+    auto size = load_le<std::uint32_t>(buffer.data() + reply_size_offset);
+    if(buffer.size() - reply_header_size != size) {
+        return std::nullopt;
+    }
+
+    Reply reply;
+    reply.query = static_cast<Query>(buffer[reply_query_offset]);
+    reply.status = static_cast<Status>(buffer[reply_status_offset]);
+    reply.payload = buffer.subspan(reply_header_size);
+
+    return reply;
+}
+
+void identy::daemon::encode_verdict(std::vector<byte>& out, const vm::HeuristicVerdict& verdict)
+{
+    auto offset = out.size();
+    out.resize(offset + verdict_header_size + verdict.detections.size() * sizeof(std::uint32_t));
+
+    auto* data = out.data() + offset;
+    data[0] = static_cast<byte>(verdict.confidence);
+    store_le(data + 4, static_cast<std::uint32_t>(verdict.detections.size()));
+
+    for(std::size_t i = 0; i < verdict.detections.size(); ++i) {
+        store_le(data + verdict_header_size + i * sizeof(std::uint32_t), static_cast<std::uint32_t>(verdict.detections[i]));
+    }
+}
+
+std::optional<identy::vm::HeuristicVerdict> identy::daemon::decode_verdict(std::span<const byte> buffer)
+{
+    if(buffer.size() < verdict_header_size) {
+        return std::nullopt;
+    }
+
+    auto count = load_le<std::uint32_t>(buffer.data() + 4);
+    if((buffer.size() - verdict_header_size) / sizeof(std::uint32_t) != count
+        || (buffer.size() - verdict_header_size) % sizeof(std::uint32_t) != 0) {
+        return std::nullopt;
+    }
+
+    if(buffer[0] > static_cast<byte>(vm::VMConfidence::DefinitelyVM)) {
+        return std::nullopt;
+    }
+
+    vm::HeuristicVerdict verdict;
+    verdict.confidence = static_cast<vm::VMConfidence>(buffer[0]);
+    verdict.detections.reserve(count);
+
+    for(std::uint32_t i = 0; i < count; ++i) {
+        auto flag = load_le<std::uint32_t>(buffer.data() + verdict_header_size + i * sizeof(std::uint32_t));
+        verdict.detections.push_back(static_cast<vm::VMFlags>(flag));
+    }
+
+    return verdict;
+}
+
+std::optional<identy::daemon::FingerprintPublisher> identy::daemon::FingerprintPublisher::create(std::string_view name)
+{
+    auto memory = platform::SharedMemory::create(name, sizeof(SharedBlock));
+    if(!memory) {
+        return std::nullopt;
+    }
+
+    // the segment is zero-filled by ftruncate; magic goes last so readers
+    // never accept a half initialized block
+    auto* block = new(memory->data()) SharedBlock {};
+    block->version.store(shared_version, std::memory_order_relaxed);
+    block->magic.store(shared_magic, std::memory_order_release);
+
+    FingerprintPublisher publisher;
+    publisher.m_memory = std::move(memory);
+
+    return publisher;
+}
+
+identy::daemon::FingerprintPublisher::FingerprintPublisher(FingerprintPublisher&&) noexcept = default;
+identy::daemon::FingerprintPublisher& identy::daemon::FingerprintPublisher::operator=(FingerprintPublisher&&) noexcept = default;
+identy::daemon::FingerprintPublisher::~FingerprintPublisher() = default;
+
+void identy::daemon::FingerprintPublisher::publish(const PublishedFingerprint& fingerprint) noexcept
+{
+    auto* block = static_cast<SharedBlock*>(m_memory->data());
+
+    auto sequence = block->sequence.load(std::memory_order_relaxed);
+    block->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for(std::size_t i = 0; i < hash_words; ++i) {
+        std::uint64_t word;
+        std::memcpy(&word, fingerprint.hash.buffer + i * sizeof(word), sizeof(word));
+        block->hash[i].store(word, std::memory_order_relaxed);
+    }
+
+    block->generation.store(fingerprint.generation, std::memory_order_relaxed);
+    block->updated_unix_ns.store(fingerprint.updated_unix_ns, std::memory_order_relaxed);
+    block->confidence.store(static_cast<std::uint64_t>(fingerprint.confidence), std::memory_order_relaxed);
+    block->detections.store(fingerprint.detections, std::memory_order_relaxed);
+
+    block->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+std::optional<identy::daemon::FingerprintReader> identy::daemon::FingerprintReader::open(std::string_view name)
+{
+    auto memory = platform::SharedMemory::open(name, sizeof(SharedBlock));
+    if(!memory) {
+        return std::nullopt;
+    }
+
+    const auto* block = static_cast<const SharedBlock*>(memory->data());
+    if(block->magic.load(std::memory_order_acquire) != shared_magic
+        || block->version.load(std::memory_order_relaxed) != shared_version) {
+        return std::nullopt;
+    }
+
+    FingerprintReader reader;
+    reader.m_memory = std::move(memory);
+
+    return reader;
+}
+
+identy::daemon::FingerprintReader::FingerprintReader(FingerprintReader&&) noexcept = default;
+identy::daemon::FingerprintReader& identy::daemon::FingerprintReader::operator=(FingerprintReader&&) noexcept = default;
+identy::daemon::FingerprintReader::~FingerprintReader() = default;
+
+std::optional<identy::daemon::PublishedFingerprint> identy::daemon::FingerprintReader::read() const noexcept
+{
+    const auto* block = static_cast<const SharedBlock*>(m_memory->data());
+
+    PublishedFingerprint fingerprint;
+
+    for(std::uint32_t attempt = 0; attempt < max_read_attempts; ++attempt) {
+        auto before = block->sequence.load(std::memory_order_acquire);
+        if(before & 1) {
+            continue;
+        }
+
+        for(std::size_t i = 0; i < hash_words; ++i) {
+            auto word = block->hash[i].load(std::memory_order_relaxed);
+            std::memcpy(fingerprint.hash.buffer + i * sizeof(word), &word, sizeof(word));
+        }
+
+        fingerprint.generation = block->generation.load(std::memory_order_relaxed);
+        fingerprint.updated_unix_ns = block->updated_unix_ns.load(std::memory_order_relaxed);
+        auto confidence = block->confidence.load(std::memory_order_relaxed);
+        fingerprint.detections = block->detections.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if(block->sequence.load(std::memory_order_relaxed) != before) {
+            continue;
+        }
+
+        if(fingerprint.generation == 0) {
+            return std::nullopt;
+        }
+
+        fingerprint.confidence = static_cast<vm::VMConfidence>(confidence);
+        return fingerprint;
+    }
+
+    return std::nullopt;
+}
+
+std::optional<std::vector<identy::byte>> identy::daemon::query(Query query, const std::filesystem::path& socket)
+{
+    std::vector<byte> request;
+    encode_request(request, query);
+
+    auto raw = platform::local_socket_request(socket, request, max_reply_size);
+    if(!raw.has_value()) {
+        return std::nullopt;
+    }
+
+    auto reply = decode_reply(*raw);
+    if(!reply.has_value() || reply->query != query || reply->status != Status::Ok) {
+        return std::nullopt;
+    }
+
+    return std::vector<byte>(reply->payload.begin(), reply->payload.end());
+}
+
+std::optional<identy::hs::Hash256> identy::daemon::query_fingerprint(const std::filesystem::path& socket)
+{
+    auto payload = query(Query::Fingerprint, socket);
+    if(!payload.has_value() || payload->size() != sizeof(hs::Hash256::buffer)) {
+        return std::nullopt;
+    }
+
+    hs::Hash256 hash;
+    std::memcpy(hash.buffer, payload->data(), sizeof(hash.buffer));
+
+    return hash;
+}
+
+std::optional<identy::MotherboardEx> identy::daemon::query_snapshot(const std::filesystem::path& socket)
+{
+    auto payload = query(Query::Snapshot, socket);
+    if(!payload.has_value()) {
+        return std::nullopt;
+    }
+
+    auto reader = io::read_binary(*payload);
+    if(!reader.has_value() || reader->kind() != io::SnapshotKind::MotherboardEx) {
+        return std::nullopt;
+    }
+
+    return reader->to_motherboard_ex();
+}
+
+std::optional<identy::vm::HeuristicVerdict> identy::daemon::query_verdict(const std::filesystem::path& socket)
+{
+    auto payload = query(Query::Verdict, socket);
+    if(!payload.has_value()) {
+        return std::nullopt;
+    }
+
+    return decode_verdict(*payload);
+}
+
+bool identy::daemon::Service::refresh()
+{
+    auto mb = snap_motherboard_ex();
+    auto hash = hs::hash(mb);
+    auto verdict = vm::analyze_full(mb);
+
+    bool changed = m_published.generation == 0
+        || std::memcmp(m_published.hash.buffer, hash.buffer, sizeof(hash.buffer)) != 0;
+
+    m_snapshot.clear();
+    io::encode_binary(m_snapshot, mb);
+
+    m_verdict.clear();
+    encode_verdict(m_verdict, verdict);
+
+    m_published.hash = hash;
+    m_published.generation += 1;
+    m_published.updated_unix_ns = unix_now_ns();
+    m_published.confidence = verdict.confidence;
+    m_published.detections = detection_mask(verdict.detections);
+
+    return changed;
+}
+
+void identy::daemon::Service::handle(std::span<const byte> request, std::vector<byte>& reply) const
+{
+    reply.clear();
+
+    auto query = decode_request(request);
+    if(!query.has_value()) {
+        encode_reply(reply, Query {}, Status::BadRequest, {});
+        return;
+    }
+
+    if(m_published.generation == 0) {
+        encode_reply(reply, *query, Status::Unavailable, {});
+        return;
+    }
+
+    switch(*query) {
+        case Query::Fingerprint:
+            encode_reply(reply, *query, Status::Ok, m_published.hash.buffer);
+            break;
+        case Query::Snapshot:
+            encode_reply(reply, *query, Status::Ok, m_snapshot);
+            break;
+        case Query::Verdict:
+            encode_reply(reply, *query, Status::Ok, m_verdict);
+            break;
+    }
+}
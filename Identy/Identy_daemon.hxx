@@ -0,0 +1,262 @@
+/**
+ * @file Identy_daemon.hxx
+ * @brief Client and service side of the identyd fingerprint daemon
+ *
+ * identyd collects the hardware once per host and refreshes it on drive or
+ * network hot-plug events and after a TTL, so that processes sharing a host
+ * do not each probe and hash the same hardware. It publishes:
+ *
+ * - the latest fingerprint in a read-only shared memory segment guarded by a
+ *   seqlock. FingerprintReader maps it once; every read() afterwards is a few
+ *   plain loads without syscalls;
+ * - the fingerprint, the binary snapshot and the VM verdict over a Unix
+ *   domain socket, see query_fingerprint(), query_snapshot() and
+ *   query_verdict().
+ *
+ * @code
+ * static auto reader = identy::daemon::FingerprintReader::open();
+ * if(auto published = reader ? reader->read() : std::nullopt) {
+ *     use(published->hash);
+ * }
+ * else {
+ *     use(identy::hs::hash(identy::snap_motherboard_ex()));
+ * }
+ * @endcode
+ *
+ * ## Socket Protocol (version 1)
+ *
+ * A client connects, sends an 8 byte request {"IDRQ", u8 query, 3 reserved}
+ * and half-closes the connection. The daemon answers with a 12 byte header
+ * {"IDRP", u8 query, u8 status, u16 reserved, u32 payload size} followed by
+ * the payload and closes the connection. Payloads are the 32 byte
+ * fingerprint, a binary snapshot (see io::encode_binary()) or a verdict
+ * {u8 confidence, 3 reserved, u32 count, count x u32 flag}. Integers are
+ * little-endian.
+ *
+ * @note The daemon and its clients are Linux only; on Windows the client
+ *       functions return std::nullopt.
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_DAEMON_H
+#define UNC_IDENTY_DAEMON_H
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "Identy_hash.hxx"
+#include "Identy_hwid.hxx"
+#include "Identy_vm.hxx"
+
+namespace identy::platform
+{
+class SharedMemory;
+} // namespace identy::platform
+
+namespace identy::daemon
+{
+/** @brief Default socket path of identyd */
+inline constexpr std::string_view default_socket_path = "/run/identyd.sock";
+
+/** @brief Default shared memory segment name of identyd */
+inline constexpr std::string_view default_shm_name = "/identyd";
+
+/** @brief Magic bytes of a request ("IDRQ") */
+constexpr byte request_magic[4] = { 'I', 'D', 'R', 'Q' };
+
+/** @brief Magic bytes of a reply ("IDRP") */
+constexpr byte reply_magic[4] = { 'I', 'D', 'R', 'P' };
+
+/** @brief Size of a request */
+constexpr std::size_t request_size = 8;
+
+/** @brief Size of a reply header */
+constexpr std::size_t reply_header_size = 12;
+
+/** @brief Largest reply accepted by the client */
+constexpr std::size_t max_reply_size = 64 * 1024 * 1024;
+
+/**
+ * @brief Data requested from the daemon
+ */
+enum class Query : std::uint8_t {
+    Fingerprint = 1, /**< 32 byte hs::hash() of the extended snapshot */
+    Snapshot = 2,    /**< Binary snapshot of the extended snapshot */
+    Verdict = 3      /**< vm::analyze_full() of the extended snapshot */
+};
+
+/**
+ * @brief Result of a request
+ */
+enum class Status : std::uint8_t {
+    Ok = 0,
+    Unavailable = 1, /**< No snapshot collected yet */
+    BadRequest = 2   /**< Malformed request or unknown query */
+};
+
+/**
+ * @brief Reply header and payload
+ */
+struct Reply
+{
+    Query query { Query::Fingerprint };
+    Status status { Status::Ok };
+
+    /** @brief Payload, points into the decoded buffer */
+    std::span<const byte> payload;
+};
+
+/** @brief Appends a request for @p query to @p out */
+void encode_request(std::vector<byte>& out, Query query);
+
+/** @brief Parses a request, std::nullopt if malformed */
+std::optional<Query> decode_request(std::span<const byte> buffer) noexcept;
+
+/** @brief Appends a reply to @p out */
+void encode_reply(std::vector<byte>& out, Query query, Status status, std::span<const byte> payload);
+
+/** @brief Parses a reply, std::nullopt if malformed or truncated */
+std::optional<Reply> decode_reply(std::span<const byte> buffer) noexcept;
+
+/** @brief Appends the wire form of a verdict to @p out */
+void encode_verdict(std::vector<byte>& out, const vm::HeuristicVerdict& verdict);
+
+/** @brief Parses the wire form of a verdict */
+std::optional<vm::HeuristicVerdict> decode_verdict(std::span<const byte> buffer);
+
+/**
+ * @brief Fingerprint as published in shared memory
+ */
+struct PublishedFingerprint
+{
+    hs::Hash256 hash {};
+
+    /** @brief Incremented by every refresh of the daemon, starting at 1 */
+    std::uint64_t generation { 0 };
+
+    /** @brief Time of the refresh, nanoseconds since the Unix epoch */
+    std::uint64_t updated_unix_ns { 0 };
+
+    vm::VMConfidence confidence { vm::VMConfidence::Unlikely };
+
+    /** @brief Detected VM indicators, bit i set for vm::VMFlags value i */
+    std::uint64_t detections { 0 };
+};
+
+/**
+ * @brief Owner of the shared memory segment
+ *
+ * @note A segment must have a single publisher.
+ */
+class FingerprintPublisher final
+{
+public:
+    /**
+     * @brief Creates the segment; it is removed when the publisher is destroyed
+     * @return Publisher, std::nullopt if the segment cannot be created
+     */
+    static std::optional<FingerprintPublisher> create(std::string_view name = default_shm_name);
+
+    FingerprintPublisher(FingerprintPublisher&&) noexcept;
+    FingerprintPublisher& operator=(FingerprintPublisher&&) noexcept;
+    ~FingerprintPublisher();
+
+    /** @brief Atomically replaces the published fingerprint */
+    void publish(const PublishedFingerprint& fingerprint) noexcept;
+
+private:
+    FingerprintPublisher() = default;
+
+    std::unique_ptr<platform::SharedMemory> m_memory;
+};
+
+/**
+ * @brief Read-only view of the shared memory segment
+ */
+class FingerprintReader final
+{
+public:
+    /**
+     * @brief Maps the segment
+     * @return Reader, std::nullopt if the daemon is not running or the segment
+     *         has an unknown layout
+     */
+    static std::optional<FingerprintReader> open(std::string_view name = default_shm_name);
+
+    FingerprintReader(FingerprintReader&&) noexcept;
+    FingerprintReader& operator=(FingerprintReader&&) noexcept;
+    ~FingerprintReader();
+
+    /**
+     * @brief Reads a consistent copy of the fingerprint without syscalls
+     *
+     * Retries while the publisher is writing.
+     *
+     * @return Fingerprint, std::nullopt if nothing was published yet
+     */
+    std::optional<PublishedFingerprint> read() const noexcept;
+
+private:
+    FingerprintReader() = default;
+
+    std::unique_ptr<platform::SharedMemory> m_memory;
+};
+
+/**
+ * @brief Sends a request to the daemon
+ * @return Decoded reply payload, std::nullopt if the daemon is unreachable or
+ *         the status is not Status::Ok
+ */
+std::optional<std::vector<byte>> query(Query query, const std::filesystem::path& socket = default_socket_path);
+
+/** @brief Fingerprint served by the daemon */
+std::optional<hs::Hash256> query_fingerprint(const std::filesystem::path& socket = default_socket_path);
+
+/** @brief Extended snapshot served by the daemon */
+std::optional<MotherboardEx> query_snapshot(const std::filesystem::path& socket = default_socket_path);
+
+/** @brief VM verdict served by the daemon */
+std::optional<vm::HeuristicVerdict> query_verdict(const std::filesystem::path& socket = default_socket_path);
+
+/**
+ * @brief Collected state and request handling of the daemon
+ *
+ * identyd owns one service, calls refresh() on start, hot-plug events and TTL
+ * expiry, and answers each request with handle().
+ */
+class Service final
+{
+public:
+    /**
+     * @brief Collects the hardware and rebuilds the published values
+     * @return true if the fingerprint changed
+     */
+    bool refresh();
+
+    /**
+     * @brief Builds the reply to one request
+     * @param request Raw request bytes
+     * @param reply Cleared and filled with the reply
+     */
+    void handle(std::span<const byte> request, std::vector<byte>& reply) const;
+
+    /** @brief Current state in shared memory form; generation 0 before the first refresh */
+    const PublishedFingerprint& published() const noexcept
+    {
+        return m_published;
+    }
+
+private:
+    PublishedFingerprint m_published;
+    std::vector<byte> m_snapshot;
+    std::vector<byte> m_verdict;
+};
+} // namespace identy::daemon
+
+#endif
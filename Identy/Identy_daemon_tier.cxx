@@ -0,0 +1,25 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_daemon.hxx"
+#include "Platform/Identy_platform_hwid.hxx"
+
+// Linked as loose objects into every consumer of Identy::io (see
+// CMakeLists.txt), so the registration runs even though nothing refers to it.
+
+namespace
+{
+std::optional<identy::SMBIOS> query_smbios(const std::filesystem::path& socket)
+{
+    auto mb = identy::daemon::query_snapshot(socket);
+    if(!mb.has_value()) {
+        return std::nullopt;
+    }
+
+    return std::move(mb->smbios);
+}
+
+[[maybe_unused]] const bool registered = [] {
+    identy::platform::set_daemon_smbios_query(&query_smbios);
+    return true;
+}();
+} // namespace
@@ -0,0 +1,363 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_diff.hxx"
+
+namespace
+{
+using identy::ChangeKind;
+using identy::SnapshotChange;
+
+struct StructureRef
+{
+    std::uint32_t key { 0 }; // type << 16 | handle
+    std::uint32_t offset { 0 };
+    std::uint32_t size { 0 };
+};
+
+/**
+ * Splits a raw SMBIOS table into structures (formatted area plus string set).
+ * Stops at the first structure that does not fit into the table.
+ */
+void split_structures(std::span<const identy::byte> table, std::vector<StructureRef>& out)
+{
+    out.clear();
+
+    std::size_t offset = 0;
+
+    while(offset + sizeof(identy::SMBIOS_Header) <= table.size()) {
+        identy::SMBIOS_Header header;
+        std::memcpy(&header, table.data() + offset, sizeof(header));
+
+        if(header.length < sizeof(identy::SMBIOS_Header)) {
+            break;
+        }
+
+        // skip strings block, terminated by a double null; memchr does the scanning
+        std::size_t next = offset + header.length;
+        while(next + 1 < table.size()) {
+            auto* nul = static_cast<const identy::byte*>(std::memchr(table.data() + next, 0, table.size() - next - 1));
+            if(nul == nullptr) {
+                next = table.size();
+                break;
+            }
+
+            next = static_cast<std::size_t>(nul - table.data());
+            if(table[next + 1] == 0) {
+                break;
+            }
+            ++next;
+        }
+
+        if(next + 2 > table.size()) {
+            break;
+        }
+
+        next += 2;
+
+        out.push_back({ static_cast<std::uint32_t>(header.type) << 16 | header.handle, static_cast<std::uint32_t>(offset),
+            static_cast<std::uint32_t>(next - offset) });
+
+        offset = next;
+    }
+}
+
+bool same_bytes(std::span<const identy::byte> a, const StructureRef& x, std::span<const identy::byte> b, const StructureRef& y) noexcept
+{
+    return x.size == y.size && std::memcmp(a.data() + x.offset, b.data() + y.offset, x.size) == 0;
+}
+
+void push_structure(std::vector<SnapshotChange>& changes, ChangeKind kind, std::uint32_t key)
+{
+    SnapshotChange change;
+    change.kind = kind;
+    change.smbios_type = static_cast<identy::byte>(key >> 16);
+    change.smbios_handle = static_cast<identy::word>(key & 0xFFFF);
+    changes.push_back(change);
+}
+
+void diff_structures(std::span<const identy::byte> a, std::span<const identy::byte> b, std::vector<SnapshotChange>& changes)
+{
+    if(a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size()) == 0)) {
+        return;
+    }
+
+    // scratch lists are reused across calls to keep bulk diffing allocation free
+    thread_local std::vector<StructureRef> xs;
+    thread_local std::vector<StructureRef> ys;
+    split_structures(a, xs);
+    split_structures(b, ys);
+
+    // tables usually keep their structure order, so walk both in lockstep first
+    std::size_t common = 0;
+    for(; common < xs.size() && common < ys.size() && xs[common].key == ys[common].key; ++common) {
+        if(!same_bytes(a, xs[common], b, ys[common])) {
+            push_structure(changes, ChangeKind::SmbiosStructureModified, xs[common].key);
+        }
+    }
+
+    if(common == xs.size() && common == ys.size()) {
+        return;
+    }
+
+    // reordered or inserted structures: merge-join the rest by (type, handle)
+    auto by_key = [](const StructureRef& lhs, const StructureRef& rhs) { return lhs.key < rhs.key; };
+    std::stable_sort(xs.begin() + static_cast<std::ptrdiff_t>(common), xs.end(), by_key);
+    std::stable_sort(ys.begin() + static_cast<std::ptrdiff_t>(common), ys.end(), by_key);
+
+    auto x = xs.begin() + static_cast<std::ptrdiff_t>(common);
+    auto y = ys.begin() + static_cast<std::ptrdiff_t>(common);
+
+    while(x != xs.end() || y != ys.end()) {
+        if(y == ys.end() || (x != xs.end() && x->key < y->key)) {
+            push_structure(changes, ChangeKind::SmbiosStructureRemoved, (x++)->key);
+        }
+        else if(x == xs.end() || y->key < x->key) {
+            push_structure(changes, ChangeKind::SmbiosStructureAdded, (y++)->key);
+        }
+        else {
+            if(!same_bytes(a, *x, b, *y)) {
+                push_structure(changes, ChangeKind::SmbiosStructureModified, x->key);
+            }
+            ++x;
+            ++y;
+        }
+    }
+}
+
+void push_string(std::vector<SnapshotChange>& changes, ChangeKind kind, std::string_view field, std::string_view before,
+    std::string_view after)
+{
+    if(before != after) {
+        SnapshotChange change;
+        change.kind = kind;
+        change.field = field;
+        change.before = before;
+        change.after = after;
+        changes.push_back(change);
+    }
+}
+
+void push_value(std::vector<SnapshotChange>& changes, ChangeKind kind, std::string_view field, std::int64_t before,
+    std::int64_t after)
+{
+    if(before != after) {
+        SnapshotChange change;
+        change.kind = kind;
+        change.field = field;
+        change.before_value = before;
+        change.after_value = after;
+        changes.push_back(change);
+    }
+}
+
+void diff_cpu(const identy::Cpu& a, const identy::Cpu& b, std::vector<SnapshotChange>& changes)
+{
+    constexpr auto kind = ChangeKind::CpuField;
+
+    push_string(changes, kind, "vendor", a.vendor, b.vendor);
+    push_string(changes, kind, "brand", a.extended_brand_string, b.extended_brand_string);
+    push_string(changes, kind, "hypervisor_signature", a.hypervisor_signature, b.hypervisor_signature);
+    push_value(changes, kind, "version", a.version, b.version);
+    push_value(changes, kind, "logical_processors", a.logical_processors_count, b.logical_processors_count);
+    push_value(changes, kind, "apic_id", a.apic_id, b.apic_id);
+    push_value(changes, kind, "brand_index", a.brand_index, b.brand_index);
+    push_value(changes, kind, "clflush_line_size", a.clflush_line_size, b.clflush_line_size);
+    push_value(changes, kind, "hypervisor", a.hypervisor_bit, b.hypervisor_bit);
+    push_value(changes, kind, "too_old", a.too_old, b.too_old);
+    push_value(changes, kind, "isa_basic", a.instruction_set.basic, b.instruction_set.basic);
+    push_value(changes, kind, "isa_modern", a.instruction_set.modern, b.instruction_set.modern);
+    push_value(changes, kind, "isa_extended_0", a.instruction_set.extended_modern[0], b.instruction_set.extended_modern[0]);
+    push_value(changes, kind, "isa_extended_1", a.instruction_set.extended_modern[1], b.instruction_set.extended_modern[1]);
+    push_value(changes, kind, "isa_extended_2", a.instruction_set.extended_modern[2], b.instruction_set.extended_modern[2]);
+}
+
+void diff_smbios(const identy::SMBIOS& a, const identy::SMBIOS& b, std::vector<SnapshotChange>& changes)
+{
+    constexpr auto kind = ChangeKind::SmbiosField;
+
+    push_value(changes, kind, "major_version", a.major_version, b.major_version);
+    push_value(changes, kind, "minor_version", a.minor_version, b.minor_version);
+    push_value(changes, kind, "dmi_version", a.dmi_version, b.dmi_version);
+    push_value(changes, kind, "calling_convention_20", a.is_20_calling_used, b.is_20_calling_used);
+    push_value(changes, kind, "tier", static_cast<std::int64_t>(a.tier), static_cast<std::int64_t>(b.tier));
+
+    auto uuid_view = [](const identy::byte (&uuid)[identy::SMBIOS_uuid_length]) {
+        return std::string_view(reinterpret_cast<const char*>(uuid), identy::SMBIOS_uuid_length);
+    };
+    push_string(changes, kind, "uuid", uuid_view(a.uuid), uuid_view(b.uuid));
+
+    diff_structures(a.raw_tables_data, b.raw_tables_data, changes);
+}
+
+// Drives are matched by serial; drives without one fall back to the device name
+std::string_view drive_key(const identy::PhysicalDriveInfo& drive) noexcept
+{
+    return drive.serial.empty() ? std::string_view(drive.device_name) : std::string_view(drive.serial);
+}
+
+void diff_drive(const identy::PhysicalDriveInfo& a, const identy::PhysicalDriveInfo& b, std::size_t ia, std::size_t ib,
+    std::vector<SnapshotChange>& changes)
+{
+    auto first = changes.size();
+
+    push_value(changes, ChangeKind::DriveModified, "bus", a.bus_type, b.bus_type);
+    push_string(changes, ChangeKind::DriveModified, "serial", a.serial, b.serial);
+    push_string(changes, ChangeKind::DriveModified, "device", a.device_name, b.device_name);
+    push_string(changes, ChangeKind::DriveModified, "model", a.model_id, b.model_id);
+    push_string(changes, ChangeKind::DriveModified, "vendor", a.vendor_id, b.vendor_id);
+    push_string(changes, ChangeKind::DriveModified, "product", a.product_id, b.product_id);
+
+    for(auto i = first; i < changes.size(); ++i) {
+        changes[i].before_index = ia;
+        changes[i].after_index = ib;
+    }
+}
+
+void diff_drives(const std::vector<identy::PhysicalDriveInfo>& a, const std::vector<identy::PhysicalDriveInfo>& b,
+    std::vector<SnapshotChange>& changes)
+{
+    // common case: same drives in the same order
+    bool same_order = a.size() == b.size();
+    for(std::size_t i = 0; same_order && i < a.size(); ++i) {
+        same_order = drive_key(a[i]) == drive_key(b[i]);
+    }
+
+    if(same_order) {
+        for(std::size_t i = 0; i < a.size(); ++i) {
+            diff_drive(a[i], b[i], i, i, changes);
+        }
+        return;
+    }
+
+    std::vector<bool> matched(b.size(), false);
+
+    for(std::size_t i = 0; i < a.size(); ++i) {
+        auto key = drive_key(a[i]);
+        auto j = std::size_t { 0 };
+
+        while(j < b.size() && (matched[j] || drive_key(b[j]) != key)) {
+            ++j;
+        }
+
+        if(j == b.size()) {
+            SnapshotChange change;
+            change.kind = ChangeKind::DriveRemoved;
+            change.before = key;
+            change.before_index = i;
+            changes.push_back(change);
+            continue;
+        }
+
+        matched[j] = true;
+        diff_drive(a[i], b[j], i, j, changes);
+    }
+
+    for(std::size_t j = 0; j < b.size(); ++j) {
+        if(!matched[j]) {
+            SnapshotChange change;
+            change.kind = ChangeKind::DriveAdded;
+            change.after = drive_key(b[j]);
+            change.after_index = j;
+            changes.push_back(change);
+        }
+    }
+}
+
+std::string_view kind_name(ChangeKind kind) noexcept
+{
+    switch(kind) {
+        case ChangeKind::CpuField:
+            return "CPU";
+        case ChangeKind::SmbiosField:
+            return "SMBIOS";
+        case ChangeKind::SmbiosStructureAdded:
+            return "SMBIOS structure added";
+        case ChangeKind::SmbiosStructureRemoved:
+            return "SMBIOS structure removed";
+        case ChangeKind::SmbiosStructureModified:
+            return "SMBIOS structure modified";
+        case ChangeKind::DriveAdded:
+            return "Drive added";
+        case ChangeKind::DriveRemoved:
+            return "Drive removed";
+        case ChangeKind::DriveModified:
+            return "Drive";
+        default:
+            return "Unknown";
+    }
+}
+
+void write_uuid(std::ostream& stream, std::string_view raw)
+{
+    for(std::size_t i = 0; i < raw.size(); ++i) {
+        if(i == 4 || i == 6 || i == 8 || i == 10) {
+            stream << '-';
+        }
+        stream << std::format("{:02x}", static_cast<std::uint8_t>(raw[i]));
+    }
+}
+} // namespace
+
+std::vector<identy::SnapshotChange> identy::diff(const MotherboardEx& before, const MotherboardEx& after)
+{
+    std::vector<SnapshotChange> changes;
+    diff(before, after, changes);
+    return changes;
+}
+
+std::size_t identy::diff(const MotherboardEx& before, const MotherboardEx& after, std::vector<SnapshotChange>& changes)
+{
+    changes.clear();
+
+    diff_cpu(before.cpu, after.cpu, changes);
+    diff_smbios(before.smbios, after.smbios, changes);
+    diff_drives(before.drives, after.drives, changes);
+
+    return changes.size();
+}
+
+void identy::io::write_diff(std::ostream& stream, std::span<const SnapshotChange> changes)
+{
+    if(!stream.good()) {
+        return;
+    }
+
+    for(const auto& change : changes) {
+        stream << kind_name(change.kind);
+
+        switch(change.kind) {
+            case ChangeKind::SmbiosStructureAdded:
+            case ChangeKind::SmbiosStructureRemoved:
+            case ChangeKind::SmbiosStructureModified:
+                stream << std::format(": type {} handle 0x{:04x}\n", change.smbios_type, change.smbios_handle);
+                continue;
+            case ChangeKind::DriveAdded:
+                stream << std::format(" #{}: {}\n", change.after_index + 1, change.after);
+                continue;
+            case ChangeKind::DriveRemoved:
+                stream << std::format(" #{}: {}\n", change.before_index + 1, change.before);
+                continue;
+            case ChangeKind::DriveModified:
+                stream << std::format(" #{}", change.after_index + 1);
+                break;
+            default:
+                break;
+        }
+
+        stream << " " << change.field << ": ";
+
+        if(change.field == "uuid") {
+            write_uuid(stream, change.before);
+            stream << " -> ";
+            write_uuid(stream, change.after);
+        }
+        else if(!change.before.empty() || !change.after.empty()) {
+            stream << '"' << change.before << "\" -> \"" << change.after << '"';
+        }
+        else {
+            stream << change.before_value << " -> " << change.after_value;
+        }
+
+        stream << "\n";
+    }
+}
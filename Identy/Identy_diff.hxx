@@ -0,0 +1,128 @@
+/**
+ * @file Identy_diff.hxx
+ * @brief Structured comparison of two hardware snapshots
+ *
+ * diff() reports what changed between two MotherboardEx snapshots instead of
+ * leaving it to a visual comparison of text dumps:
+ *
+ * - CPU field changes (vendor, brand, version, feature registers, ...)
+ * - SMBIOS version, calling convention and UUID changes
+ * - SMBIOS structures added, removed or modified, keyed by type and handle
+ * - drives added, removed or modified, matched by serial number
+ *
+ * Identical inputs are detected with a handful of comparisons and a single
+ * memcmp over the raw SMBIOS tables, so diffing mostly unchanged snapshots
+ * in bulk is cheap.
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_DIFF_H
+#define UNC_IDENTY_DIFF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "Identy_hwid.hxx"
+
+namespace identy
+{
+/**
+ * @brief Category of a snapshot change
+ */
+enum class ChangeKind : std::uint8_t {
+    CpuField,                /**< A CPU field changed, see SnapshotChange::field */
+    SmbiosField,             /**< SMBIOS version, DMI version, calling convention, UUID or tier changed */
+    SmbiosStructureAdded,    /**< Structure only present in the second snapshot */
+    SmbiosStructureRemoved,  /**< Structure only present in the first snapshot */
+    SmbiosStructureModified, /**< Structure with the same type and handle has different contents */
+    DriveAdded,              /**< Drive only present in the second snapshot */
+    DriveRemoved,            /**< Drive only present in the first snapshot */
+    DriveModified            /**< Drive with the same serial has a different attribute */
+};
+
+/**
+ * @brief One difference between two snapshots
+ *
+ * String members are views into the compared snapshots and the library's
+ * static field names; they stay valid as long as both snapshots do. diff()
+ * therefore does not accept temporary snapshots.
+ */
+struct SnapshotChange
+{
+    /** @brief Index value meaning "not applicable" */
+    static constexpr std::size_t no_index = std::numeric_limits<std::size_t>::max();
+
+    ChangeKind kind { ChangeKind::CpuField };
+
+    /** @brief Changed field ("vendor", "serial", "uuid", ...), empty for additions/removals */
+    std::string_view field;
+
+    /** @brief Previous and new value of string fields */
+    std::string_view before;
+    std::string_view after;
+
+    /** @brief Previous and new value of numeric and boolean fields */
+    std::int64_t before_value { 0 };
+    std::int64_t after_value { 0 };
+
+    /** @brief Type and handle of SMBIOS structure changes */
+    byte smbios_type { 0 };
+    word smbios_handle { 0 };
+
+    /** @brief Drive index in the first and second snapshot, no_index if absent */
+    std::size_t before_index { no_index };
+    std::size_t after_index { no_index };
+};
+
+/**
+ * @brief Computes the changes between two snapshots
+ *
+ * @param before Earlier snapshot
+ * @param after Later snapshot
+ * @return Changes in order: CPU, SMBIOS fields, SMBIOS structures, drives;
+ *         empty if the snapshots are identical
+ */
+std::vector<SnapshotChange> diff(const MotherboardEx& before, const MotherboardEx& after);
+
+/** @brief Deleted: the changes would point into a destroyed snapshot */
+std::vector<SnapshotChange> diff(const MotherboardEx&& before, const MotherboardEx& after) = delete;
+std::vector<SnapshotChange> diff(const MotherboardEx& before, const MotherboardEx&& after) = delete;
+std::vector<SnapshotChange> diff(const MotherboardEx&& before, const MotherboardEx&& after) = delete;
+
+/**
+ * @brief Computes the changes between two snapshots into an existing vector
+ *
+ * Clears @p changes first and reuses its capacity, avoiding an allocation per
+ * call when diffing many snapshot pairs.
+ *
+ * @param before Earlier snapshot
+ * @param after Later snapshot
+ * @param changes Destination
+ * @return Number of changes
+ */
+std::size_t diff(const MotherboardEx& before, const MotherboardEx& after, std::vector<SnapshotChange>& changes);
+
+/** @brief Deleted: the changes would point into a destroyed snapshot */
+std::size_t diff(const MotherboardEx&& before, const MotherboardEx& after, std::vector<SnapshotChange>& changes) = delete;
+std::size_t diff(const MotherboardEx& before, const MotherboardEx&& after, std::vector<SnapshotChange>& changes) = delete;
+std::size_t diff(const MotherboardEx&& before, const MotherboardEx&& after, std::vector<SnapshotChange>& changes) = delete;
+} // namespace identy
+
+namespace identy::io
+{
+/**
+ * @brief Writes changes in human-readable form, one line per change
+ *
+ * @param stream Output stream to write to (must be in good state)
+ * @param changes Result of identy::diff()
+ */
+void write_diff(std::ostream& stream, std::span<const SnapshotChange> changes);
+} // namespace identy::io
+
+#endif
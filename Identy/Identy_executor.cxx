@@ -0,0 +1,205 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_executor.hxx"
+
+#include "Platform/Identy_platform_source.hxx"
+
+namespace
+{
+struct WorkerContext
+{
+    const identy::exec::WorkStealingPool* pool { nullptr };
+    std::size_t index { 0 };
+};
+
+thread_local WorkerContext current_worker;
+
+/**
+ * Shared with the helper tasks of one parallel_for(). A helper may start
+ * after the loop finished; it then finds no chunk left and only touches
+ * this state, never the caller's stack.
+ */
+struct Loop
+{
+    const std::function<void(std::size_t, std::size_t)>* body { nullptr };
+    identy::platform::HardwareSource* source { nullptr };
+
+    std::size_t count { 0 };
+    std::size_t grain { 1 };
+    std::size_t chunks { 0 };
+
+    std::atomic<std::size_t> next { 0 };
+    std::atomic<std::size_t> completed { 0 };
+
+    std::mutex mutex;
+    std::condition_variable done;
+};
+
+void drain(Loop& loop)
+{
+    std::size_t finished = 0;
+
+    for(auto chunk = loop.next.fetch_add(1, std::memory_order_relaxed); chunk < loop.chunks;
+        chunk = loop.next.fetch_add(1, std::memory_order_relaxed)) {
+        auto begin = chunk * loop.grain;
+        (*loop.body)(begin, std::min(begin + loop.grain, loop.count));
+        ++finished;
+    }
+
+    if(finished != 0 && loop.completed.fetch_add(finished, std::memory_order_acq_rel) + finished == loop.chunks) {
+        std::lock_guard lock(loop.mutex);
+        loop.done.notify_all();
+    }
+}
+} // namespace
+
+identy::exec::WorkStealingPool::WorkStealingPool(std::size_t threads)
+{
+    if(threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_queues.reserve(threads);
+    for(std::size_t i = 0; i < threads; ++i) {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+
+    m_threads.reserve(threads);
+    for(std::size_t i = 0; i < threads; ++i) {
+        m_threads.emplace_back([this, i] { work(i); });
+    }
+}
+
+identy::exec::WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+
+    for(auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void identy::exec::WorkStealingPool::submit(Task task)
+{
+    auto index = current_worker.pool == this ? current_worker.index : m_next.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+    {
+        std::lock_guard lock(m_queues[index]->mutex);
+        m_queues[index]->tasks.push_back(std::move(task));
+    }
+
+    // published after the push, so a worker seeing pending > 0 finds the task
+    m_pending.fetch_add(1, std::memory_order_release);
+
+    {
+        std::lock_guard lock(m_mutex);
+    }
+    m_wake.notify_one();
+}
+
+bool identy::exec::WorkStealingPool::take(std::size_t index, Task& task)
+{
+    {
+        auto& own = *m_queues[index];
+        std::lock_guard lock(own.mutex);
+        if(!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    for(std::size_t offset = 1; offset < m_queues.size(); ++offset) {
+        auto& victim = *m_queues[(index + offset) % m_queues.size()];
+        std::lock_guard lock(victim.mutex);
+        if(!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void identy::exec::WorkStealingPool::work(std::size_t index)
+{
+    current_worker = { this, index };
+
+    while(true) {
+        Task task;
+        if(take(index, task)) {
+            m_pending.fetch_sub(1, std::memory_order_relaxed);
+            task();
+            continue;
+        }
+
+        std::unique_lock lock(m_mutex);
+        m_wake.wait(lock, [this] { return m_stop || m_pending.load(std::memory_order_acquire) != 0; });
+
+        if(m_stop && m_pending.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+identy::exec::WorkStealingPool& identy::exec::default_pool()
+{
+    static WorkStealingPool pool;
+    return pool;
+}
+
+identy::exec::ExecutorRef identy::exec::default_executor()
+{
+    return default_pool();
+}
+
+void identy::exec::parallel_for(std::size_t count, const std::function<void(std::size_t, std::size_t)>& body,
+    ExecutorRef executor, std::size_t grain)
+{
+    if(count == 0) {
+        return;
+    }
+
+    auto workers = std::max<std::size_t>(1, executor.concurrency());
+    if(grain == 0) {
+        grain = std::max<std::size_t>(1, count / (workers * 4));
+    }
+
+    auto chunks = (count + grain - 1) / grain;
+    if(chunks == 1) {
+        body(0, count);
+        return;
+    }
+
+    auto loop = std::make_shared<Loop>();
+    loop->body = &body;
+    loop->count = count;
+    loop->grain = grain;
+    loop->chunks = chunks;
+
+    auto& source = platform::source();
+    loop->source = &source == &platform::live_source() ? nullptr : &source;
+
+    // the caller takes a share itself, so one helper fewer than chunks
+    auto helpers = std::min(workers, chunks - 1);
+    for(std::size_t i = 0; i < helpers; ++i) {
+        executor.submit([loop] {
+            std::optional<platform::ScopedSource> scoped;
+            if(loop->source != nullptr) {
+                scoped.emplace(*loop->source);
+            }
+
+            drain(*loop);
+        });
+    }
+
+    drain(*loop);
+
+    std::unique_lock lock(loop->mutex);
+    loop->done.wait(lock, [&loop] { return loop->completed.load(std::memory_order_acquire) == loop->chunks; });
+}
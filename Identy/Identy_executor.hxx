@@ -0,0 +1,191 @@
+/**
+ * @file Identy_executor.hxx
+ * @brief Executor abstraction for every internally parallel operation
+ *
+ * Identy never starts threads of its own for parallel work. Entry points
+ * that can fan out take an executor, an object that accepts tasks:
+ *
+ * @code
+ * struct MyPool
+ * {
+ *     void submit(identy::exec::Task task);  // run task eventually, on any thread
+ *     std::size_t concurrency();             // number of workers
+ * };
+ *
+ * MyPool pool;
+ * auto hashes = identy::hs::hash_batch(boards, pool);
+ * @endcode
+ *
+ * Anything modelling the Executor concept converts to the non-owning
+ * ExecutorRef taken by the entry points. Without one they use
+ * default_executor(), a process-wide WorkStealingPool with one worker per
+ * hardware thread, started on first use.
+ *
+ * parallel_for() is the bulk primitive built on submit(): the calling thread
+ * processes chunks too, so a loop issued from inside a worker, or on an
+ * executor whose workers are all busy, still completes. Helper tasks install
+ * the caller's hardware source (see Identy_capture.hxx), so replay and
+ * ScopedSysfsRoot apply to the whole loop.
+ *
+ * Tasks must not throw.
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_EXECUTOR_H
+#define UNC_IDENTY_EXECUTOR_H
+
+#include <atomic>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace identy::exec
+{
+/** @brief Unit of work accepted by an executor */
+using Task = std::function<void()>;
+
+/**
+ * @brief Requirements on an executor
+ *
+ * submit() schedules a task to run exactly once on any thread; concurrency()
+ * reports how many tasks can run at the same time and sizes the chunking of
+ * parallel_for().
+ */
+template<typename E>
+concept Executor = requires(E& executor, Task task) {
+    { executor.submit(std::move(task)) };
+    { executor.concurrency() } -> std::convertible_to<std::size_t>;
+};
+
+/**
+ * @brief Non-owning reference to any Executor
+ *
+ * The referenced executor must outlive every call the reference is passed to.
+ */
+class ExecutorRef final
+{
+public:
+    template<Executor E>
+        requires(!std::same_as<std::remove_cvref_t<E>, ExecutorRef>)
+    ExecutorRef(E& executor) noexcept
+        : m_executor(&executor)
+        , m_submit([](void* self, Task&& task) { static_cast<E*>(self)->submit(std::move(task)); })
+        , m_concurrency([](void* self) { return static_cast<std::size_t>(static_cast<E*>(self)->concurrency()); })
+    {
+    }
+
+    void submit(Task task) const
+    {
+        m_submit(m_executor, std::move(task));
+    }
+
+    std::size_t concurrency() const
+    {
+        return m_concurrency(m_executor);
+    }
+
+private:
+    void* m_executor;
+    void (*m_submit)(void*, Task&&);
+    std::size_t (*m_concurrency)(void*);
+};
+
+/**
+ * @brief Executor running every task immediately on the submitting thread
+ */
+class InlineExecutor final
+{
+public:
+    void submit(Task task)
+    {
+        task();
+    }
+
+    std::size_t concurrency() const noexcept
+    {
+        return 1;
+    }
+};
+
+/**
+ * @brief Lightweight work-stealing thread pool
+ *
+ * Each worker owns a deque. Tasks submitted from a worker go to the back of
+ * its own deque and are taken back LIFO while hot in cache; other tasks are
+ * dealt round-robin. An idle worker steals from the front of the others'
+ * deques before going to sleep. The destructor runs the queued tasks and
+ * joins the workers.
+ */
+class WorkStealingPool final
+{
+public:
+    /**
+     * @param threads Number of workers, 0 selects the hardware concurrency
+     */
+    explicit WorkStealingPool(std::size_t threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(Task task);
+
+    std::size_t concurrency() const noexcept
+    {
+        return m_threads.size();
+    }
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void work(std::size_t index);
+    bool take(std::size_t index, Task& task);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::atomic<std::size_t> m_pending { 0 };
+    std::atomic<std::size_t> m_next { 0 };
+    bool m_stop { false };
+};
+
+/**
+ * @brief Process-wide pool used when no executor is given
+ */
+WorkStealingPool& default_pool();
+
+/**
+ * @brief default_pool() as an ExecutorRef
+ */
+ExecutorRef default_executor();
+
+/**
+ * @brief Calls body(begin, end) over consecutive chunks covering [0, count)
+ *
+ * Returns after every chunk completed. Chunks run concurrently on the
+ * executor and on the calling thread.
+ *
+ * @param count Number of items
+ * @param body Called once per chunk; must be safe to call concurrently
+ * @param executor Executor providing the helper threads
+ * @param grain Items per chunk, 0 picks about four chunks per worker
+ */
+void parallel_for(std::size_t count, const std::function<void(std::size_t, std::size_t)>& body,
+    ExecutorRef executor = default_executor(), std::size_t grain = 0);
+} // namespace identy::exec
+
+#endif
@@ -0,0 +1,349 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_fixture.hxx"
+
+namespace
+{
+constexpr identy::byte smbios_type_bios = 0;
+constexpr identy::byte smbios_type_system = 1;
+constexpr identy::byte smbios_type_baseboard = 2;
+constexpr identy::byte smbios_type_memory_device = 17;
+constexpr identy::byte smbios_type_end_of_table = 127;
+
+constexpr std::size_t bios_length = 18;
+constexpr std::size_t system_length = 27;
+constexpr std::size_t baseboard_length = 15;
+constexpr std::size_t memory_device_length = 40;
+constexpr std::size_t end_of_table_size = 6;
+
+constexpr std::size_t system_uuid_offset = 8;
+
+constexpr std::size_t entry_point_size = 24;
+
+// ARPHRD_ETHER and ARPHRD_LOOPBACK as found in /sys/class/net/<if>/type
+constexpr std::string_view net_type_ether = "1\n";
+constexpr std::string_view net_type_loopback = "772\n";
+
+std::uint64_t splitmix64(std::uint64_t& state) noexcept
+{
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+class TableBuilder
+{
+public:
+    explicit TableBuilder(std::vector<identy::byte>& table)
+        : m_table(table)
+    {
+    }
+
+    /**
+     * @brief Appends a structure with a zeroed formatted area and @p strings
+     * @return Offset of the structure in the table
+     */
+    std::size_t add(identy::byte type, std::size_t length, std::initializer_list<std::string_view> strings)
+    {
+        auto offset = m_table.size();
+
+        m_table.resize(offset + length, 0);
+        m_table[offset] = type;
+        m_table[offset + 1] = static_cast<identy::byte>(length);
+        m_table[offset + 2] = static_cast<identy::byte>(m_handle & 0xFF);
+        m_table[offset + 3] = static_cast<identy::byte>(m_handle >> 8);
+        ++m_handle;
+
+        for(auto string : strings) {
+            m_table.insert(m_table.end(), string.begin(), string.end());
+            m_table.push_back(0);
+        }
+
+        if(strings.size() == 0) {
+            m_table.push_back(0);
+        }
+        m_table.push_back(0);
+
+        return offset;
+    }
+
+    identy::byte* at(std::size_t offset) noexcept
+    {
+        return m_table.data() + offset;
+    }
+
+private:
+    std::vector<identy::byte>& m_table;
+    identy::word m_handle { 0 };
+};
+
+std::string hex_string(std::uint64_t value, std::size_t digits)
+{
+    constexpr char alphabet[] = "0123456789ABCDEF";
+
+    std::string result(digits, '0');
+
+    for(std::size_t i = 0; i < digits; ++i) {
+        result[digits - 1 - i] = alphabet[(value >> (i * 4)) & 0xF];
+    }
+
+    return result;
+}
+
+std::array<identy::byte, identy::SMBIOS_uuid_length> make_uuid(std::uint32_t seed) noexcept
+{
+    std::array<identy::byte, identy::SMBIOS_uuid_length> uuid {};
+    std::uint64_t state = seed;
+
+    for(std::size_t i = 0; i < uuid.size(); i += 8) {
+        auto bits = splitmix64(state);
+        std::memcpy(uuid.data() + i, &bits, 8);
+    }
+
+    return uuid;
+}
+
+// Formatted like /sys/class/dmi/id/product_uuid
+std::string uuid_string(std::span<const identy::byte> uuid)
+{
+    constexpr char alphabet[] = "0123456789abcdef";
+
+    std::string result;
+
+    for(std::size_t i = 0; i < uuid.size(); ++i) {
+        if(i == 4 || i == 6 || i == 8 || i == 10) {
+            result.push_back('-');
+        }
+        result.push_back(alphabet[uuid[i] >> 4]);
+        result.push_back(alphabet[uuid[i] & 0xF]);
+    }
+
+    return result;
+}
+
+// The kernel prints the first three fields little-endian from SMBIOS 2.6 on
+std::string product_uuid_string(std::array<identy::byte, identy::SMBIOS_uuid_length> uuid, identy::byte major, identy::byte minor)
+{
+    if(major > 2 || (major == 2 && minor >= 6)) {
+        std::reverse(uuid.begin(), uuid.begin() + 4);
+        std::reverse(uuid.begin() + 4, uuid.begin() + 6);
+        std::reverse(uuid.begin() + 6, uuid.begin() + 8);
+    }
+
+    return uuid_string(uuid);
+}
+
+// sda..sdz, sdaa..sdzz, ... like the kernel names SCSI disks
+std::string scsi_disk_name(std::size_t index)
+{
+    std::string suffix;
+
+    for(++index; index > 0; index /= 26) {
+        --index;
+        suffix.insert(suffix.begin(), static_cast<char>('a' + index % 26));
+    }
+
+    return "sd" + suffix;
+}
+
+bool write_file(const std::filesystem::path& path, std::span<const identy::byte> contents)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(contents.data()), static_cast<std::streamsize>(contents.size()));
+    return file.good();
+}
+
+bool write_file(const std::filesystem::path& path, std::string_view contents)
+{
+    return write_file(path, { reinterpret_cast<const identy::byte*>(contents.data()), contents.size() });
+}
+
+bool make_directories(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(path, ec);
+    return !ec;
+}
+
+bool make_link(const std::filesystem::path& link, const std::filesystem::path& target)
+{
+    std::error_code ec;
+    std::filesystem::remove(link, ec);
+    std::filesystem::create_directory_symlink(target, link, ec);
+    return !ec;
+}
+} // namespace
+
+std::vector<identy::byte> identy::fixture::make_smbios_table(std::size_t size, std::uint32_t seed)
+{
+    std::vector<byte> table;
+    table.reserve(size);
+
+    TableBuilder builder(table);
+
+    auto bios = builder.add(smbios_type_bios, bios_length, { "Identy Fixture BIOS", "1.0", "01/01/2026" });
+    builder.at(bios)[4] = 1;
+    builder.at(bios)[5] = 2;
+    builder.at(bios)[8] = 3;
+
+    auto serial = "SN" + hex_string(seed, 8);
+
+    auto system = builder.add(smbios_type_system, system_length, { "Identy", "Synthetic Board", "1.0", serial });
+    for(byte i = 0; i < 4; ++i) {
+        builder.at(system)[4 + i] = static_cast<byte>(i + 1);
+    }
+
+    auto uuid = make_uuid(seed);
+    std::memcpy(builder.at(system) + system_uuid_offset, uuid.data(), uuid.size());
+
+    auto board = builder.add(smbios_type_baseboard, baseboard_length, { "Identy", "Synthetic Baseboard", "1.0", serial });
+    for(byte i = 0; i < 4; ++i) {
+        builder.at(board)[4 + i] = static_cast<byte>(i + 1);
+    }
+
+    // A memory device with one string "DIMM_xxxx"; the last one takes a
+    // longer string so the table ends exactly at the requested size
+    constexpr std::size_t unit_size = memory_device_length + 9 + 2;
+    constexpr std::size_t min_size = memory_device_length + 2;
+
+    std::size_t dimm = 0;
+
+    auto remaining = [&] {
+        auto used = table.size() + end_of_table_size;
+        return size > used ? size - used : 0;
+    };
+
+    while(remaining() >= unit_size + min_size) {
+        builder.add(smbios_type_memory_device, memory_device_length, { "DIMM_" + hex_string(dimm++, 4) });
+    }
+
+    if(auto rest = remaining(); rest > min_size) {
+        builder.add(smbios_type_memory_device, memory_device_length, { std::string(rest - min_size, 'P') });
+    }
+    else if(rest == min_size) {
+        builder.add(smbios_type_memory_device, memory_device_length, {});
+    }
+
+    builder.add(smbios_type_end_of_table, 4, {});
+
+    return table;
+}
+
+bool identy::fixture::write_sysfs_tree(const std::filesystem::path& root, const SysfsSpec& spec)
+{
+    const auto sys = root / "sys";
+    const auto block = sys / "block";
+    const auto net = sys / "class" / "net";
+    const auto dmi_tables = sys / "firmware" / "dmi" / "tables";
+    const auto dmi_id = sys / "class" / "dmi" / "id";
+
+    bool ok = true;
+
+    for(const auto& dir : { block, net, dmi_tables, dmi_id, sys / "bus" / "scsi", sys / "bus" / "usb",
+            sys / "bus" / "pci" / "drivers" / "e1000e", sys / "bus" / "virtio" / "drivers" / "virtio_net" }) {
+        ok = ok && make_directories(dir);
+    }
+
+    if(!ok) {
+        return false;
+    }
+
+    std::uint64_t state = static_cast<std::uint64_t>(spec.seed) << 32;
+
+    std::size_t nvme_index = 0;
+    std::size_t scsi_index = 0;
+
+    for(std::size_t i = 0; i < spec.block_devices && ok; ++i) {
+        auto serial = "FX" + hex_string(splitmix64(state), 16) + "\n";
+
+        switch(i % 3) {
+            case 0: {
+                auto device = block / ("nvme" + std::to_string(nvme_index++) + "n1");
+                ok = make_directories(device) && write_file(device / "serial", serial);
+                break;
+            }
+
+            default: {
+                // Relative from sys/block/sdX/device to sys/bus/<subsystem>
+                auto device = block / scsi_disk_name(scsi_index++) / "device";
+                auto subsystem = (i % 3 == 1) ? "../../../bus/scsi" : "../../../bus/usb";
+
+                ok = make_directories(device)
+                    && make_link(device / "subsystem", subsystem)
+                    && write_file(device / "serial", serial);
+                break;
+            }
+        }
+    }
+
+    for(std::size_t lun = 0; lun < spec.multipath_luns && ok; ++lun) {
+        auto id = hex_string(splitmix64(state), 16);
+        auto map = "dm-" + std::to_string(lun);
+
+        ok = make_directories(block / map / "dm") && make_directories(block / map / "slaves")
+            && write_file(block / map / "dm" / "uuid", "mpath-36" + id + "\n");
+
+        for(std::size_t path = 0; path < spec.paths_per_lun && ok; ++path) {
+            auto name = scsi_disk_name(scsi_index++);
+            auto device = block / name / "device";
+
+            // Relative from sys/block/sdX/holders/dm-N to sys/block/dm-N and back
+            ok = make_directories(device) && make_directories(block / name / "holders")
+                && make_link(device / "subsystem", "../../../bus/scsi")
+                && write_file(device / "serial", "LUN" + id + "\n")
+                && write_file(device / "wwid", "naa.6" + id + "\n")
+                && make_link(block / name / "holders" / map, "../../" + map)
+                && make_link(block / map / "slaves" / name, "../../" + name);
+        }
+    }
+
+    for(std::size_t i = 0; i < spec.loop_devices && ok; ++i) {
+        ok = make_directories(block / ("loop" + std::to_string(i)));
+    }
+
+    ok = ok && make_directories(net / "lo") && write_file(net / "lo" / "type", net_type_loopback);
+
+    for(std::size_t i = 0; i < spec.network_interfaces && ok; ++i) {
+        auto iface = net / ("eth" + std::to_string(i));
+
+        // Relative from sys/class/net/ethN/device to sys/bus/...
+        auto driver = i < spec.virtual_network_interfaces
+            ? "../../../../bus/virtio/drivers/virtio_net"
+            : "../../../../bus/pci/drivers/e1000e";
+
+        ok = make_directories(iface / "device")
+            && write_file(iface / "type", net_type_ether)
+            && make_link(iface / "device" / "driver", driver);
+    }
+
+    if(!ok) {
+        return false;
+    }
+
+    auto table = make_smbios_table(spec.dmi_table_size, spec.seed);
+
+    std::vector<byte> entry_point(entry_point_size, 0);
+    std::memcpy(entry_point.data(), "_SM3_", 5);
+    entry_point[6] = static_cast<byte>(entry_point_size);
+    entry_point[7] = spec.smbios_major_version;
+    entry_point[8] = spec.smbios_minor_version;
+    entry_point[10] = 1;
+
+    auto table_size = static_cast<std::uint32_t>(table.size());
+    std::memcpy(entry_point.data() + 12, &table_size, sizeof(table_size));
+
+    auto version = std::to_string(spec.smbios_major_version) + "." + std::to_string(spec.smbios_minor_version) + "\n";
+    auto uuid = product_uuid_string(make_uuid(spec.seed), spec.smbios_major_version, spec.smbios_minor_version);
+    auto boot_id = uuid_string(make_uuid(~spec.seed));
+
+    std::error_code ec;
+    auto random = root / "proc" / "sys" / "kernel" / "random";
+    std::filesystem::create_directories(random, ec);
+
+    return write_file(dmi_tables / "DMI", table)
+        && write_file(dmi_tables / "smbios_entry_point", entry_point)
+        && write_file(dmi_id / "smbios_version", version)
+        && write_file(dmi_id / "product_uuid", uuid + "\n")
+        && write_file(random / "boot_id", boot_id + "\n");
+}
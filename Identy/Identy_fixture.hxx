@@ -0,0 +1,104 @@
+/**
+ * @file Identy_fixture.hxx
+ * @brief Synthetic sysfs and DMI trees for tests and benchmarks
+ *
+ * Collector performance depends on how many block devices and network
+ * interfaces a machine has, which makes measurements on a developer box hard
+ * to reproduce. write_sysfs_tree() builds a directory tree with the layout the
+ * Linux collectors read, sized by a SysfsSpec, so enumeration can be measured
+ * from 10 to 10,000 devices on any machine:
+ *
+ * @code
+ * identy::fixture::SysfsSpec spec;
+ * spec.block_devices = 10000;
+ * identy::fixture::write_sysfs_tree("/tmp/sysfs", spec);
+ *
+ * identy::ScopedSysfsRoot root("/tmp/sysfs");
+ * auto mb = identy::snap_motherboard_ex();
+ * @endcode
+ *
+ * Trees are deterministic for a given spec; serials and the SMBIOS UUID are
+ * derived from SysfsSpec::seed.
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_FIXTURE_H
+#define UNC_IDENTY_FIXTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "Identy_hwid.hxx"
+
+namespace identy::fixture
+{
+/**
+ * @brief Shape of a synthetic sysfs tree
+ */
+struct SysfsSpec
+{
+    /** @brief Block devices; bus types cycle through NVMe, SATA and USB */
+    std::size_t block_devices { 8 };
+
+    /** @brief Loop devices, listed in /sys/block but skipped by the collectors */
+    std::size_t loop_devices { 0 };
+
+    /**
+     * @brief SAN LUNs, each seen through paths_per_lun SCSI paths
+     *
+     * Paths share the LUN's serial and WWID and are held by a dm-N
+     * multipath map. Their sdX names follow the block_devices ones.
+     */
+    std::size_t multipath_luns { 0 };
+
+    /** @brief SCSI paths per multipath LUN */
+    std::size_t paths_per_lun { 4 };
+
+    /** @brief Network interfaces besides "lo" */
+    std::size_t network_interfaces { 2 };
+
+    /** @brief How many of the network interfaces use a virtio driver */
+    std::size_t virtual_network_interfaces { 0 };
+
+    /** @brief Size of the DMI table in bytes, padded with memory device structures */
+    std::size_t dmi_table_size { 4096 };
+
+    /** @brief SMBIOS version reported by the entry point */
+    byte smbios_major_version { 3 };
+    byte smbios_minor_version { 4 };
+
+    /** @brief Seed for serials and the SMBIOS UUID */
+    std::uint32_t seed { 1 };
+};
+
+/**
+ * @brief Builds an SMBIOS structure table
+ *
+ * The table holds BIOS (type 0), System (type 1) and Baseboard (type 2)
+ * structures, memory devices (type 17) filling it up to @p size and an
+ * end-of-table marker. Small sizes are rounded up to the minimal table.
+ *
+ * @param size Requested table size in bytes
+ * @param seed Seed of the system UUID
+ * @return Raw table as exposed by /sys/firmware/dmi/tables/DMI
+ */
+std::vector<byte> make_smbios_table(std::size_t size, std::uint32_t seed);
+
+/**
+ * @brief Writes a synthetic sysfs tree below @p root
+ *
+ * Creates sys/block, sys/class/net, sys/firmware/dmi/tables,
+ * sys/class/dmi/id and proc/sys/kernel/random/boot_id. Existing files are overwritten; entries not described by
+ * @p spec are left alone, so use an empty directory.
+ *
+ * @param root Directory to build the tree in, created if missing
+ * @param spec Tree shape
+ * @return false if a file or directory could not be created
+ */
+bool write_sysfs_tree(const std::filesystem::path& root, const SysfsSpec& spec);
+} // namespace identy::fixture
+
+#endif
@@ -0,0 +1,411 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_fleet.hxx"
+#include "Identy_io.hxx"
+
+#include <chrono>
+#include <mutex>
+
+namespace
+{
+struct Batch
+{
+    std::uint64_t first_sequence { 0 };
+    std::uint64_t sealed_ns { 0 };
+
+    std::vector<std::vector<identy::byte>> blobs;
+    std::vector<identy::MotherboardEx> boards;
+    std::vector<std::uint8_t> decoded;
+    std::vector<identy::hs::Hash256> hashes;
+};
+
+using BatchPtr = std::unique_ptr<Batch>;
+using BatchQueue = identy::fleet::BoundedQueue<BatchPtr>;
+
+struct StageCounters
+{
+    std::size_t threads { 0 };
+    std::atomic<std::size_t> running { 0 };
+
+    std::atomic<std::uint64_t> items { 0 };
+    std::atomic<std::uint64_t> batches { 0 };
+    std::atomic<std::uint64_t> total_ns { 0 };
+    std::atomic<std::uint64_t> max_ns { 0 };
+    std::atomic<std::uint64_t> bytes { 0 };
+    std::atomic<std::uint64_t> idle_ns { 0 };
+    std::atomic<std::uint64_t> stalled_ns { 0 };
+    std::array<std::atomic<std::uint64_t>, identy::trace::histogram_buckets> histogram {};
+};
+
+std::uint64_t now_ns() noexcept
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+std::size_t bucket_of(std::uint64_t duration_ns) noexcept
+{
+    if(duration_ns == 0) {
+        return 0;
+    }
+    return std::min<std::size_t>(std::bit_width(duration_ns) - 1, identy::trace::histogram_buckets - 1);
+}
+
+void record(StageCounters& counters, std::uint64_t duration_ns, std::size_t items, std::uint64_t bytes) noexcept
+{
+    counters.items.fetch_add(items, std::memory_order_relaxed);
+    counters.batches.fetch_add(1, std::memory_order_relaxed);
+    counters.total_ns.fetch_add(duration_ns, std::memory_order_relaxed);
+    counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    counters.histogram[bucket_of(duration_ns)].fetch_add(1, std::memory_order_relaxed);
+
+    auto current = counters.max_ns.load(std::memory_order_relaxed);
+    while(current < duration_ns && !counters.max_ns.compare_exchange_weak(current, duration_ns, std::memory_order_relaxed)) {
+    }
+}
+
+identy::trace::PhaseStats latency_of(const StageCounters& counters) noexcept
+{
+    identy::trace::PhaseStats stats;
+    stats.calls = counters.batches.load(std::memory_order_relaxed);
+    stats.total_ns = counters.total_ns.load(std::memory_order_relaxed);
+    stats.max_ns = counters.max_ns.load(std::memory_order_relaxed);
+    stats.bytes = counters.bytes.load(std::memory_order_relaxed);
+
+    for(std::size_t i = 0; i < stats.histogram.size(); ++i) {
+        stats.histogram[i] = counters.histogram[i].load(std::memory_order_relaxed);
+    }
+
+    return stats;
+}
+
+identy::fleet::StageStats stats_of(const StageCounters& counters) noexcept
+{
+    identy::fleet::StageStats stats;
+    stats.threads = counters.threads;
+    stats.items = counters.items.load(std::memory_order_relaxed);
+    stats.latency = latency_of(counters);
+    stats.idle_ns = counters.idle_ns.load(std::memory_order_relaxed);
+    stats.stalled_ns = counters.stalled_ns.load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+struct PipelineState
+{
+    PipelineState(identy::fleet::Sink sink, const identy::fleet::Options& options)
+        : sink(std::move(sink))
+        , batch_size(std::max<std::size_t>(options.batch_size, 1))
+        , to_decode(std::max<std::size_t>(options.queue_batches, 1))
+        , to_hash(std::max<std::size_t>(options.queue_batches, 1))
+        , to_score(std::max<std::size_t>(options.queue_batches, 1))
+        , started_ns(now_ns())
+    {
+        decode.threads = std::max<std::size_t>(options.decode_threads, 1);
+        hash.threads = std::max<std::size_t>(options.hash_threads, 1);
+        score.threads = std::max<std::size_t>(options.score_threads, 1);
+    }
+
+    std::size_t workers() const noexcept
+    {
+        return decode.threads + hash.threads + score.threads;
+    }
+
+    /**
+     * Every worker blocks for the lifetime of the pipeline, so the stages
+     * share the executor's threads: the largest stage gives one up until
+     * they fit. Returns false if not even one worker per stage fits.
+     */
+    bool fit(std::size_t available) noexcept
+    {
+        while(workers() > available) {
+            auto* largest = &decode;
+            for(auto* stage : { &hash, &score }) {
+                if(stage->threads > largest->threads) {
+                    largest = stage;
+                }
+            }
+
+            if(largest->threads == 1) {
+                return false;
+            }
+            --largest->threads;
+        }
+
+        return true;
+    }
+
+    identy::fleet::Sink sink;
+    std::size_t batch_size;
+
+    BatchQueue to_decode;
+    BatchQueue to_hash;
+    BatchQueue to_score;
+
+    StageCounters decode;
+    StageCounters hash;
+    StageCounters score;
+    StageCounters end_to_end;
+
+    // producer side, guarded by mutex
+    std::mutex mutex;
+    BatchPtr open;
+    std::uint64_t next_sequence { 0 };
+    bool sealed { false };
+
+    std::uint64_t started_ns;
+    std::atomic<std::uint64_t> pushed { 0 };
+    std::atomic<std::uint64_t> completed { 0 };
+    std::atomic<std::uint64_t> rejected { 0 };
+    std::atomic<bool> drained { false };
+};
+
+std::uint64_t decode_batch(PipelineState& state, Batch& batch)
+{
+    std::uint64_t bytes = 0;
+    std::uint64_t rejected = 0;
+
+    batch.boards.resize(batch.blobs.size());
+    batch.decoded.assign(batch.blobs.size(), 0);
+
+    for(std::size_t i = 0; i < batch.blobs.size(); ++i) {
+        bytes += batch.blobs[i].size();
+
+        auto reader = identy::io::read_binary(batch.blobs[i]);
+        if(!reader.has_value()) {
+            ++rejected;
+            continue;
+        }
+
+        batch.boards[i] = reader->to_motherboard_ex();
+        batch.decoded[i] = 1;
+    }
+
+    // the boards own their data from here on
+    batch.blobs = {};
+
+    state.rejected.fetch_add(rejected, std::memory_order_relaxed);
+    return bytes;
+}
+
+std::uint64_t hash_batch(PipelineState&, Batch& batch)
+{
+    identy::exec::InlineExecutor inline_executor;
+    batch.hashes = identy::hs::hash_batch(std::span<const identy::MotherboardEx>(batch.boards), inline_executor);
+
+    return 0;
+}
+
+std::uint64_t score_batch(PipelineState& state, Batch& batch)
+{
+    identy::exec::InlineExecutor inline_executor;
+    auto verdicts = identy::vm::analyze_batch(std::span<const identy::MotherboardEx>(batch.boards), inline_executor);
+
+    std::vector<identy::fleet::Verified> results(batch.boards.size());
+    for(std::size_t i = 0; i < results.size(); ++i) {
+        auto& result = results[i];
+        result.sequence = batch.first_sequence + i;
+
+        if(batch.decoded[i] == 0) {
+            continue;
+        }
+
+        result.decoded = true;
+        result.board = std::move(batch.boards[i]);
+        result.hash = batch.hashes[i];
+        result.verdict = std::move(verdicts[i]);
+    }
+
+    if(state.sink) {
+        state.sink(std::span<const identy::fleet::Verified>(results));
+    }
+
+    state.completed.fetch_add(results.size(), std::memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * Worker loop of one stage: takes batches from @p input until it is closed
+ * and drained, hands them to @p output. The last worker to leave closes
+ * @p output, or reports the pipeline drained after the final stage.
+ */
+void run_stage(PipelineState& state, StageCounters& counters, BatchQueue& input, BatchQueue* output,
+    std::uint64_t (*process)(PipelineState&, Batch&))
+{
+    while(true) {
+        BatchPtr batch;
+
+        auto waiting = now_ns();
+        if(!input.pop(batch)) {
+            counters.idle_ns.fetch_add(now_ns() - waiting, std::memory_order_relaxed);
+            break;
+        }
+
+        auto begin = now_ns();
+        counters.idle_ns.fetch_add(begin - waiting, std::memory_order_relaxed);
+
+        auto items = std::max(batch->blobs.size(), batch->boards.size());
+
+        auto bytes = process(state, *batch);
+        auto end = now_ns();
+        record(counters, end - begin, items, bytes);
+
+        if(output == nullptr) {
+            record(state.end_to_end, end - batch->sealed_ns, items, 0);
+            continue;
+        }
+
+        output->push(batch);
+        counters.stalled_ns.fetch_add(now_ns() - end, std::memory_order_relaxed);
+    }
+
+    if(counters.running.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    if(output != nullptr) {
+        output->close();
+    }
+    else {
+        state.drained.store(true, std::memory_order_release);
+        state.drained.notify_all();
+    }
+}
+
+void start(std::shared_ptr<PipelineState> state, identy::exec::ExecutorRef executor)
+{
+    auto spawn = [&state, &executor](StageCounters& counters, BatchQueue& input, BatchQueue* output,
+                     std::uint64_t (*process)(PipelineState&, Batch&)) {
+        counters.running.store(counters.threads, std::memory_order_relaxed);
+
+        for(std::size_t i = 0; i < counters.threads; ++i) {
+            executor.submit([state, &counters, &input, output, process] { run_stage(*state, counters, input, output, process); });
+        }
+    };
+
+    spawn(state->decode, state->to_decode, &state->to_hash, &decode_batch);
+    spawn(state->hash, state->to_hash, &state->to_score, &hash_batch);
+    spawn(state->score, state->to_score, nullptr, &score_batch);
+}
+
+// seals the open batch; caller holds state.mutex
+void seal(PipelineState& state)
+{
+    if(state.open == nullptr) {
+        return;
+    }
+
+    state.open->sealed_ns = now_ns();
+    state.to_decode.push(state.open);
+    state.open.reset();
+}
+} // namespace
+
+struct identy::fleet::Verifier::State : PipelineState
+{
+    using PipelineState::PipelineState;
+};
+
+double identy::fleet::StageStats::items_per_second() const noexcept
+{
+    if(latency.total_ns == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(items) * 1e9 / static_cast<double>(latency.total_ns);
+}
+
+double identy::fleet::PipelineStats::throughput() const noexcept
+{
+    if(elapsed_ns == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(completed) * 1e9 / static_cast<double>(elapsed_ns);
+}
+
+identy::fleet::Verifier::Verifier(Sink sink, const Options& options, exec::ExecutorRef executor)
+    : m_state(std::make_shared<State>(std::move(sink), options))
+{
+    // a stage without a worker would never drain; refuse the snapshots instead
+    if(!m_state->fit(executor.concurrency())) {
+        m_state->sealed = true;
+        m_state->drained.store(true, std::memory_order_release);
+        return;
+    }
+
+    m_started = true;
+    start(m_state, executor);
+}
+
+bool identy::fleet::Verifier::started() const noexcept
+{
+    return m_started;
+}
+
+identy::fleet::Verifier::~Verifier()
+{
+    finish();
+}
+
+bool identy::fleet::Verifier::push(std::vector<byte> snapshot)
+{
+    auto& state = *m_state;
+    std::lock_guard lock(state.mutex);
+
+    if(state.sealed) {
+        return false;
+    }
+
+    if(state.open == nullptr) {
+        state.open = std::make_unique<Batch>();
+        state.open->first_sequence = state.next_sequence;
+        state.open->blobs.reserve(state.batch_size);
+    }
+
+    state.open->blobs.push_back(std::move(snapshot));
+    ++state.next_sequence;
+    state.pushed.fetch_add(1, std::memory_order_relaxed);
+
+    if(state.open->blobs.size() >= state.batch_size) {
+        seal(state);
+    }
+
+    return true;
+}
+
+bool identy::fleet::Verifier::push(std::span<const byte> snapshot)
+{
+    return push(std::vector<byte>(snapshot.begin(), snapshot.end()));
+}
+
+void identy::fleet::Verifier::finish()
+{
+    auto& state = *m_state;
+
+    {
+        std::lock_guard lock(state.mutex);
+        if(!state.sealed) {
+            seal(state);
+            state.sealed = true;
+            state.to_decode.close();
+        }
+    }
+
+    state.drained.wait(false, std::memory_order_acquire);
+}
+
+identy::fleet::PipelineStats identy::fleet::Verifier::stats() const
+{
+    const auto& state = *m_state;
+
+    PipelineStats stats;
+    stats.decode = stats_of(state.decode);
+    stats.hash = stats_of(state.hash);
+    stats.score = stats_of(state.score);
+    stats.end_to_end = latency_of(state.end_to_end);
+    stats.pushed = state.pushed.load(std::memory_order_relaxed);
+    stats.completed = state.completed.load(std::memory_order_relaxed);
+    stats.rejected = state.rejected.load(std::memory_order_relaxed);
+    stats.elapsed_ns = now_ns() - state.started_ns;
+
+    return stats;
+}
@@ -0,0 +1,408 @@
+/**
+ * @file Identy_fleet.hxx
+ * @brief Pipelined verification of serialized client snapshots
+ *
+ * A backend receiving binary snapshots (see Identy_io.hxx) from many hosts
+ * decodes each one, recomputes its fingerprint and scores it for
+ * virtualization. Verifier runs these steps as three stages connected by
+ * bounded queues, each stage with its own worker count:
+ *
+ * @code
+ * identy::fleet::Options options;
+ * options.decode_threads = 8;
+ * options.hash_threads = 16;
+ * options.score_threads = 8;
+ *
+ * identy::exec::WorkStealingPool pool(32);
+ * identy::fleet::Verifier verifier([&](std::span<const identy::fleet::Verified> batch) {
+ *     for(const auto& item : batch) {
+ *         lookup(item.sequence, item.hash, item.verdict);   // called concurrently
+ *     }
+ * }, options, pool);
+ *
+ * while(auto blob = next_upload()) {
+ *     verifier.push(std::move(*blob));   // blocks while the pipeline is full
+ * }
+ * verifier.finish();
+ * @endcode
+ *
+ * Snapshots travel in batches of Options::batch_size, so queue traffic is
+ * paid once per batch, and each stage applies its batch primitive:
+ * hs::hash_batch() and vm::analyze_batch() on the worker's own thread. When
+ * a later stage falls behind its input queue fills, the stage feeding it
+ * blocks, and eventually so does push(): memory stays bounded by
+ * queue_batches * batch_size snapshots per stage.
+ *
+ * Every stage records its throughput, batch latency, time starved of input
+ * and time stalled by a full output queue (stats()), which shows the stage
+ * to give more threads.
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_FLEET_H
+#define UNC_IDENTY_FLEET_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "Identy_executor.hxx"
+#include "Identy_hash.hxx"
+#include "Identy_trace.hxx"
+#include "Identy_vm.hxx"
+
+namespace identy::fleet
+{
+/**
+ * @brief Bounded multi-producer multi-consumer queue
+ *
+ * Lock-free ring of sequenced cells (Vyukov). try_push() and try_pop() never
+ * block; push() and pop() wait on the queue state with std::atomic::wait
+ * while it is full or empty. After close() pushes fail and pops drain what is
+ * left.
+ */
+template<typename T>
+class BoundedQueue final
+{
+public:
+    /** @param capacity Number of slots, rounded up to a power of two of at least 2 */
+    explicit BoundedQueue(std::size_t capacity);
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /** @brief Moves @p value in unless the queue is full or closed */
+    bool try_push(T& value);
+
+    /** @brief Moves the oldest value out unless the queue is empty */
+    bool try_pop(T& value);
+
+    /**
+     * @brief Moves @p value in, waiting while the queue is full
+     * @return false if the queue is closed; @p value is left untouched
+     */
+    bool push(T& value);
+
+    /**
+     * @brief Moves the oldest value out, waiting while the queue is empty
+     * @return false once the queue is closed and drained
+     */
+    bool pop(T& value);
+
+    /** @brief Rejects further pushes and wakes every waiter */
+    void close();
+
+    std::size_t capacity() const noexcept
+    {
+        return m_mask + 1;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    std::size_t m_mask;
+
+    alignas(64) std::atomic<std::size_t> m_enqueue { 0 };
+    alignas(64) std::atomic<std::size_t> m_dequeue { 0 };
+
+    // bumped after every push and pop, waited on by blocked consumers and producers
+    alignas(64) std::atomic<std::uint32_t> m_pushes { 0 };
+    std::atomic<std::uint32_t> m_pops { 0 };
+    std::atomic<bool> m_closed { false };
+};
+
+/**
+ * @brief Verification result of one snapshot
+ */
+struct Verified
+{
+    /** @brief Position of the snapshot in push() order, from 0 */
+    std::uint64_t sequence { 0 };
+
+    /** @brief false if the buffer is not a valid binary snapshot; the fields below are then empty */
+    bool decoded { false };
+
+    /** @brief The decoded snapshot */
+    MotherboardEx board;
+
+    /** @brief Recomputed fingerprint, hs::hash() of the snapshot */
+    hs::Hash256 hash {};
+
+    /** @brief vm::analyze_full() of the snapshot */
+    vm::HeuristicVerdict verdict;
+};
+
+/**
+ * @brief Receives the results of one batch, in push() order within the batch
+ *
+ * Called from the score workers, concurrently for different batches.
+ */
+using Sink = std::function<void(std::span<const Verified>)>;
+
+/**
+ * @brief Sizing of a Verifier
+ */
+struct Options
+{
+    /** @brief Snapshots per batch */
+    std::size_t batch_size { 64 };
+
+    /** @brief Batches each queue holds before its producer blocks */
+    std::size_t queue_batches { 8 };
+
+    std::size_t decode_threads { 1 };
+    std::size_t hash_threads { 1 };
+    std::size_t score_threads { 1 };
+};
+
+/**
+ * @brief Metrics of one stage
+ */
+struct StageStats
+{
+    /** @brief Workers of the stage */
+    std::size_t threads { 0 };
+
+    /** @brief Snapshots processed */
+    std::uint64_t items { 0 };
+
+    /**
+     * @brief Processing time per batch
+     *
+     * calls counts batches, total_ns is the busy time of all workers and
+     * bytes the input size (decode stage only).
+     */
+    trace::PhaseStats latency;
+
+    /** @brief Time workers waited for input */
+    std::uint64_t idle_ns { 0 };
+
+    /** @brief Time workers waited for room in the next queue (backpressure) */
+    std::uint64_t stalled_ns { 0 };
+
+    /** @brief Snapshots per second of busy time over all workers */
+    double items_per_second() const noexcept;
+};
+
+/**
+ * @brief Metrics of a Verifier
+ */
+struct PipelineStats
+{
+    StageStats decode;
+    StageStats hash;
+    StageStats score;
+
+    /** @brief Batch latency from sealing to the sink returning */
+    trace::PhaseStats end_to_end;
+
+    /** @brief Snapshots pushed and delivered to the sink */
+    std::uint64_t pushed { 0 };
+    std::uint64_t completed { 0 };
+
+    /** @brief Snapshots that failed to decode */
+    std::uint64_t rejected { 0 };
+
+    /** @brief Time since construction */
+    std::uint64_t elapsed_ns { 0 };
+
+    /** @brief Delivered snapshots per second of elapsed time */
+    double throughput() const noexcept;
+};
+
+/**
+ * @brief Decode, hash and score pipeline over binary snapshots
+ *
+ * Stage workers are long-running tasks on the given executor, one executor
+ * thread each for as long as the verifier runs. push() and finish() may be
+ * called from any thread.
+ */
+class Verifier final
+{
+public:
+    /**
+     * @brief Starts the stage workers on @p executor
+     *
+     * When the executor's concurrency is below the sum of the thread counts
+     * the largest stages are given fewer workers until they fit (see
+     * StageStats::threads). An executor that cannot run one worker per stage,
+     * such as exec::InlineExecutor, starts nothing: started() is false and
+     * push() fails.
+     *
+     * @param sink Receiver of the results
+     * @param options Batch, queue and stage sizing
+     * @param executor Executor running the workers; it must outlive the verifier
+     */
+    Verifier(Sink sink, const Options& options, exec::ExecutorRef executor);
+
+    /** @brief Calls finish() */
+    ~Verifier();
+
+    Verifier(const Verifier&) = delete;
+    Verifier& operator=(const Verifier&) = delete;
+
+    /**
+     * @brief Queues one serialized snapshot
+     *
+     * Blocks while the decode queue is full.
+     *
+     * @return false after finish() or if the verifier did not start
+     */
+    bool push(std::vector<byte> snapshot);
+
+    /** @copydoc push(std::vector<byte>) */
+    bool push(std::span<const byte> snapshot);
+
+    /**
+     * @brief Flushes the partial batch and waits until the sink received every result
+     *
+     * Idempotent; later push() calls fail.
+     */
+    void finish();
+
+    /** @brief Current metrics; consistent per counter, not across counters */
+    PipelineStats stats() const;
+
+    /** @brief false if the executor could not run one worker per stage */
+    bool started() const noexcept;
+
+private:
+    struct State;
+
+    std::shared_ptr<State> m_state;
+    bool m_started { false };
+};
+} // namespace identy::fleet
+
+template<typename T>
+identy::fleet::BoundedQueue<T>::BoundedQueue(std::size_t capacity)
+    : m_mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1)
+{
+    m_cells = std::make_unique<Cell[]>(m_mask + 1);
+    for(std::size_t i = 0; i <= m_mask; ++i) {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template<typename T>
+bool identy::fleet::BoundedQueue<T>::try_push(T& value)
+{
+    if(m_closed.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    auto position = m_enqueue.load(std::memory_order_relaxed);
+
+    while(true) {
+        auto& cell = m_cells[position & m_mask];
+        auto sequence = cell.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+        if(diff == 0) {
+            if(m_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                cell.value = std::move(value);
+                cell.sequence.store(position + 1, std::memory_order_release);
+
+                m_pushes.fetch_add(1, std::memory_order_release);
+                m_pushes.notify_all();
+                return true;
+            }
+        }
+        else if(diff < 0) {
+            return false;
+        }
+        else {
+            position = m_enqueue.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template<typename T>
+bool identy::fleet::BoundedQueue<T>::try_pop(T& value)
+{
+    auto position = m_dequeue.load(std::memory_order_relaxed);
+
+    while(true) {
+        auto& cell = m_cells[position & m_mask];
+        auto sequence = cell.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+        if(diff == 0) {
+            if(m_dequeue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                value = std::move(cell.value);
+                cell.sequence.store(position + m_mask + 1, std::memory_order_release);
+
+                m_pops.fetch_add(1, std::memory_order_release);
+                m_pops.notify_all();
+                return true;
+            }
+        }
+        else if(diff < 0) {
+            return false;
+        }
+        else {
+            position = m_dequeue.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template<typename T>
+bool identy::fleet::BoundedQueue<T>::push(T& value)
+{
+    while(true) {
+        // read the epoch first: a pop after this read changes it and the wait returns
+        auto seen = m_pops.load(std::memory_order_acquire);
+
+        if(m_closed.load(std::memory_order_acquire)) {
+            return false;
+        }
+        if(try_push(value)) {
+            return true;
+        }
+
+        m_pops.wait(seen, std::memory_order_acquire);
+    }
+}
+
+template<typename T>
+bool identy::fleet::BoundedQueue<T>::pop(T& value)
+{
+    while(true) {
+        auto seen = m_pushes.load(std::memory_order_acquire);
+        bool closed = m_closed.load(std::memory_order_acquire);
+
+        if(try_pop(value)) {
+            return true;
+        }
+        if(closed) {
+            return false;
+        }
+
+        m_pushes.wait(seen, std::memory_order_acquire);
+    }
+}
+
+template<typename T>
+void identy::fleet::BoundedQueue<T>::close()
+{
+    m_closed.store(true, std::memory_order_release);
+
+    m_pushes.fetch_add(1, std::memory_order_release);
+    m_pushes.notify_all();
+    m_pops.fetch_add(1, std::memory_order_release);
+    m_pops.notify_all();
+}
+
+#endif
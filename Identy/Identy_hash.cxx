@@ -2,6 +2,10 @@
 
 #include "Identy_hash.hxx"
 #include "Identy_sha256.hxx"
+#include "Identy_strings.hxx"
+#include "Identy_trace.hxx"
+
+#include "detail/Identy_walk.hxx"
 
 namespace
 {
@@ -15,6 +19,7 @@ void hash_value(identy::hs::detail::Sha256& ctx, const T& value) noexcept
     static_assert(std::has_unique_object_representations_v<T>, "T MUST have unique object representations");
 
     ctx.update(reinterpret_cast<const identy::byte*>(&value), sizeof(T));
+    identy::trace::count_io(sizeof(T), 0);
 }
 
 /**
@@ -23,6 +28,7 @@ void hash_value(identy::hs::detail::Sha256& ctx, const T& value) noexcept
 void hash_string(identy::hs::detail::Sha256& ctx, const std::string& str) noexcept
 {
     ctx.update(reinterpret_cast<const identy::byte*>(str.data()), str.size());
+    identy::trace::count_io(str.size(), 0);
 }
 
 /**
@@ -31,6 +37,30 @@ void hash_string(identy::hs::detail::Sha256& ctx, const std::string& str) noexce
 void hash_bytes(identy::hs::detail::Sha256& ctx, const identy::byte* data, std::size_t size) noexcept
 {
     ctx.update(data, size);
+    identy::trace::count_io(size, 0);
+}
+
+/**
+ * @brief Helper to update hash with one member of a hashed field
+ */
+template<typename T>
+void hash_member(identy::hs::detail::Sha256& ctx, const T& value) noexcept
+{
+    if constexpr(std::is_same_v<T, std::string>) {
+        hash_string(ctx, value);
+    } else {
+        hash_value(ctx, value);
+    }
+}
+
+/**
+ * @brief Updates hash context with every field the walker visits
+ */
+auto hash_fields(identy::hs::detail::Sha256& ctx) noexcept
+{
+    return [&ctx](identy::detail::HashedField, const auto&... members) {
+        (hash_member(ctx, members), ...);
+    };
 }
 
 /**
@@ -41,34 +71,7 @@ void hash_bytes(identy::hs::detail::Sha256& ctx, const identy::byte* data, std::
  */
 void hash_motherboard(identy::hs::detail::Sha256& ctx, const identy::Motherboard& board) noexcept
 {
-    // Hash CPU vendor string
-    hash_string(ctx, board.cpu.vendor);
-
-    // Hash CPU version (4 bytes)
-    hash_value(ctx, board.cpu.version);
-
-    // Hash CPU characteristics
-    hash_value(ctx, board.cpu.brand_index);
-    hash_value(ctx, board.cpu.clflush_line_size);
-    hash_value(ctx, board.cpu.logical_processors_count);
-
-    // Hash extended brand string
-    hash_string(ctx, board.cpu.extended_brand_string);
-
-    // Hash instruction sets
-    hash_value(ctx, board.cpu.instruction_set.basic);
-    hash_value(ctx, board.cpu.instruction_set.modern);
-    hash_value(ctx, board.cpu.instruction_set.extended_modern);
-
-    // Hash SMBIOS data
-    identy::byte is_20_flag = board.smbios.is_20_calling_used ? 1 : 0;
-    hash_value(ctx, is_20_flag);
-    hash_value(ctx, board.smbios.major_version);
-    hash_value(ctx, board.smbios.minor_version);
-    hash_value(ctx, board.smbios.dmi_version);
-
-    // Hash UUID
-    hash_bytes(ctx, board.smbios.uuid, identy::SMBIOS_uuid_length);
+    identy::detail::for_each_hashed_field(board.cpu, board.smbios, hash_fields(ctx));
 }
 
 /**
@@ -79,32 +82,49 @@ void hash_motherboard(identy::hs::detail::Sha256& ctx, const identy::Motherboard
  */
 void hash_motherboard_ex(identy::hs::detail::Sha256& ctx, const identy::MotherboardEx& board) noexcept
 {
-    // Hash base motherboard data
-    identy::Motherboard base_board;
-    base_board.cpu = board.cpu;
-    base_board.smbios = board.smbios;
-    hash_motherboard(ctx, base_board);
+    identy::detail::for_each_hashed_field(board, hash_fields(ctx));
+}
+
+/**
+ * @brief Updates hash context with MotherboardEx data, each distinct drive once and without paths
+ *
+ * @param ctx The SHA256 context to update
+ * @param board The extended motherboard information to hash
+ */
+void hash_motherboard_ex_paths(identy::hs::detail::Sha256& ctx, const identy::MotherboardEx& board)
+{
+    identy::detail::for_each_hashed_field(board.cpu, board.smbios, hash_fields(ctx));
+
+    std::vector<std::pair<identy::PhysicalDriveInfo::BusType, std::string_view>> drives;
+    drives.reserve(board.drives.size());
 
-    // Hash drive information
     for(const auto& drive : board.drives) {
-        if(drive.bus_type == identy::PhysicalDriveInfo::USB || drive.bus_type == identy::PhysicalDriveInfo::Other) {
-            continue;
+        if(identy::detail::is_hashed_drive(drive)) {
+            drives.emplace_back(drive.bus_type, drive.serial);
         }
+    }
 
-        // Hash bus type
-        hash_value(ctx, drive.bus_type);
+    // only a real serial identifies a drive: placeholder serials of distinct
+    // drives on cheap bridges must not collapse into one
+    std::sort(drives.begin(), drives.end());
+    drives.erase(std::unique(drives.begin(), drives.end(),
+                     [](const auto& lhs, const auto& rhs) { return lhs == rhs && !identy::strings::all_same(lhs.second); }),
+        drives.end());
 
-        // Hash device name
-        hash_string(ctx, drive.device_name);
+    for(const auto& [bus_type, serial] : drives) {
+        hash_value(ctx, bus_type);
 
-        // Hash serial number
-        hash_string(ctx, drive.serial);
+        // Length prefix: without device names, serials would run into each other
+        hash_value(ctx, static_cast<std::uint32_t>(serial.size()));
+        hash_bytes(ctx, reinterpret_cast<const identy::byte*>(serial.data()), serial.size());
     }
 }
 } // anonymous namespace
 
 identy::hs::Hash256 identy::hs::detail::default_hash(const Motherboard& board)
 {
+    trace::Span span(trace::Phase::Hash);
+
     Sha256 ctx;
     hash_motherboard(ctx, board);
     return ctx.finalize();
@@ -112,7 +132,18 @@ identy::hs::Hash256 identy::hs::detail::default_hash(const Motherboard& board)
 
 identy::hs::Hash256 identy::hs::detail::default_hash_ex(const MotherboardEx& board)
 {
+    trace::Span span(trace::Phase::Hash);
+
     Sha256 ctx;
     hash_motherboard_ex(ctx, board);
     return ctx.finalize();
 }
+
+identy::hs::Hash256 identy::hs::detail::path_independent_hash_ex(const MotherboardEx& board)
+{
+    trace::Span span(trace::Phase::Hash);
+
+    Sha256 ctx;
+    hash_motherboard_ex_paths(ctx, board);
+    return ctx.finalize();
+}
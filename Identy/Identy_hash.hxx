@@ -4,8 +4,11 @@
 #define UNC_IDENTY_HASH_H
 
 #include <cstring>
+#include <span>
 #include <type_traits>
+#include <vector>
 
+#include "Identy_executor.hxx"
 #include "Identy_hash_base.hxx"
 #include "Identy_hwid.hxx"
 
@@ -58,6 +61,27 @@ Hash256 default_hash(const Motherboard& board);
  * @see identy::hs::hash()
  */
 Hash256 default_hash_ex(const MotherboardEx& board);
+
+/**
+ * @brief Computes a SHA-256 hash of extended motherboard information that ignores drive paths
+ *
+ * Like default_hash_ex(), but drives are identified by bus type and serial
+ * only: device names and path counts are not hashed, and a drive reported
+ * by several paths counts once. Drives whose serial is empty or a
+ * placeholder (strings::all_same(), e.g. all zeros or spaces) cannot be told
+ * apart and are each hashed. Drives are hashed in sorted order, so the input
+ * order does not matter either.
+ *
+ * Meant for hosts with multipath storage, where paths appear, disappear and
+ * get renamed while the LUNs behind them stay the same. Its hashes differ
+ * from default_hash_ex() hashes of the same machine.
+ *
+ * @param board MotherboardEx structure containing CPU, SMBIOS, and drive information
+ * @return Hash256 containing the computed 256-bit hash value
+ *
+ * @see PathIndependentHashEx
+ */
+Hash256 path_independent_hash_ex(const MotherboardEx& board);
 } // namespace identy::hs::detail
 
 namespace identy::hs::detail
@@ -146,6 +170,25 @@ struct DefaultHashEx final : public IHash<Hash256>
         return default_hash_ex(board);
     }
 };
+
+/**
+ * @brief Extended hash function that ignores drive paths
+ *
+ * Functor for path_independent_hash_ex(), for use with identy::hs::hash():
+ *
+ * @code
+ * auto fingerprint = identy::hs::hash<identy::hs::detail::PathIndependentHashEx>(mb);
+ * @endcode
+ *
+ * @see DefaultHashEx
+ */
+struct PathIndependentHashEx final : public IHash<Hash256>
+{
+    Type operator()(const MotherboardEx& board) const
+    {
+        return path_independent_hash_ex(board);
+    }
+};
 } // namespace identy::hs::detail
 
 namespace identy::hs
@@ -280,6 +323,25 @@ auto hash(const Motherboard& mb) -> Hash::Type;
  */
 template<IdentyHashExFn Hash = detail::DefaultHashEx>
 auto hash(const MotherboardEx& mb) -> Hash::Type;
+
+/**
+ * @brief Hashes many snapshots concurrently
+ *
+ * Equivalent to calling hash() on every element, with the work spread over
+ * an executor (see Identy_executor.hxx) instead of threads of its own.
+ *
+ * @param boards Snapshots to hash
+ * @param executor Executor running the chunks, the built-in pool by default
+ * @return One hash per snapshot, in input order
+ */
+template<IdentyHashFn Hash = detail::DefaultHash>
+auto hash_batch(std::span<const Motherboard> boards, exec::ExecutorRef executor = exec::default_executor())
+    -> std::vector<typename Hash::Type>;
+
+/** @copydoc hash_batch(std::span<const Motherboard>, exec::ExecutorRef) */
+template<IdentyHashExFn Hash = detail::DefaultHashEx>
+auto hash_batch(std::span<const MotherboardEx> boards, exec::ExecutorRef executor = exec::default_executor())
+    -> std::vector<typename Hash::Type>;
 } // namespace identy::hs
 
 namespace identy::hs
@@ -300,6 +362,40 @@ auto identy::hs::hash(const MotherboardEx& mb) -> Hash::Type
     return Hash {}(mb);
 }
 
+template<identy::hs::IdentyHashFn Hash>
+auto identy::hs::hash_batch(std::span<const Motherboard> boards, exec::ExecutorRef executor) -> std::vector<typename Hash::Type>
+{
+    std::vector<typename Hash::Type> hashes(boards.size());
+
+    exec::parallel_for(
+        boards.size(),
+        [&boards, &hashes](std::size_t begin, std::size_t end) {
+            for(auto i = begin; i < end; ++i) {
+                hashes[i] = Hash {}(boards[i]);
+            }
+        },
+        executor);
+
+    return hashes;
+}
+
+template<identy::hs::IdentyHashExFn Hash>
+auto identy::hs::hash_batch(std::span<const MotherboardEx> boards, exec::ExecutorRef executor) -> std::vector<typename Hash::Type>
+{
+    std::vector<typename Hash::Type> hashes(boards.size());
+
+    exec::parallel_for(
+        boards.size(),
+        [&boards, &hashes](std::size_t begin, std::size_t end) {
+            for(auto i = begin; i < end; ++i) {
+                hashes[i] = Hash {}(boards[i]);
+            }
+        },
+        executor);
+
+    return hashes;
+}
+
 template<identy::hs::IdentyHashCompatible Hash>
 int identy::hs::compare(Hash&& lhs, Hash&& rhs)
 {
@@ -0,0 +1,101 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_heavy_hitters.hxx"
+
+namespace
+{
+constexpr std::uint64_t murmur64(std::uint64_t h) noexcept
+{
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+std::uint64_t load_le64(const identy::byte* src, std::size_t size) noexcept
+{
+    std::uint64_t word = 0;
+    for(std::size_t i = 0; i < size; ++i) {
+        word |= static_cast<std::uint64_t>(src[i]) << (i * 8);
+    }
+    return word;
+}
+
+/** Row i of key @p digest, double hashing h1 + i * h2 with odd h2 */
+std::size_t row_slot(std::uint64_t digest, std::size_t row, std::size_t mask) noexcept
+{
+    auto h1 = static_cast<std::uint32_t>(digest);
+    auto h2 = static_cast<std::uint32_t>(digest >> 32) | 1u;
+    return (h1 + row * h2) & mask;
+}
+} // namespace
+
+std::uint64_t identy::sketch::detail::key_digest(std::span<const byte> key) noexcept
+{
+    std::uint64_t h = 0x4B45'5944'0000'0000ull ^ key.size();
+
+    std::size_t offset = 0;
+    for(; offset + 8 <= key.size(); offset += 8) {
+        h = std::rotl(h ^ murmur64(load_le64(key.data() + offset, 8)), 27) * 0x9E3779B97F4A7C15ull;
+    }
+    if(offset < key.size()) {
+        h = std::rotl(h ^ murmur64(load_le64(key.data() + offset, key.size() - offset)), 27) * 0x9E3779B97F4A7C15ull;
+    }
+
+    return murmur64(h);
+}
+
+identy::sketch::CountMin::CountMin(std::size_t width, std::size_t depth)
+    : m_mask(std::bit_ceil(std::max<std::size_t>(width, 64)) - 1)
+    , m_depth(std::clamp<std::size_t>(depth, 1, max_depth))
+    , m_counters((m_mask + 1) * m_depth, 0)
+{
+}
+
+std::uint32_t identy::sketch::CountMin::add(std::uint64_t digest, std::uint32_t weight) noexcept
+{
+    const auto width = m_mask + 1;
+
+    std::size_t slots[max_depth];
+    auto estimate = std::numeric_limits<std::uint32_t>::max();
+
+    for(std::size_t row = 0; row < m_depth; ++row) {
+        slots[row] = row * width + row_slot(digest, row, m_mask);
+        estimate = std::min(estimate, m_counters[slots[row]]);
+    }
+
+    // conservative update: counters already above the new estimate keep their value
+    auto updated = estimate > std::numeric_limits<std::uint32_t>::max() - weight ? std::numeric_limits<std::uint32_t>::max() : estimate + weight;
+    for(std::size_t row = 0; row < m_depth; ++row) {
+        auto& counter = m_counters[slots[row]];
+        counter = std::max(counter, updated);
+    }
+
+    return updated;
+}
+
+std::uint32_t identy::sketch::CountMin::estimate(std::uint64_t digest) const noexcept
+{
+    const auto width = m_mask + 1;
+
+    auto estimate = std::numeric_limits<std::uint32_t>::max();
+    for(std::size_t row = 0; row < m_depth; ++row) {
+        estimate = std::min(estimate, m_counters[row * width + row_slot(digest, row, m_mask)]);
+    }
+
+    return estimate;
+}
+
+void identy::sketch::CountMin::decay() noexcept
+{
+    for(auto& counter : m_counters) {
+        counter >>= 1;
+    }
+}
+
+void identy::sketch::CountMin::clear() noexcept
+{
+    std::fill(m_counters.begin(), m_counters.end(), 0u);
+}
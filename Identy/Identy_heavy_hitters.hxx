@@ -0,0 +1,486 @@
+/**
+ * @file Identy_heavy_hitters.hxx
+ * @brief Streaming detection of fingerprints reported by many activations
+ *
+ * A cloned golden image shows up as thousands of activations reporting the
+ * same Hash256 or the same SMBIOS UUID (often all zeros). HeavyHitters finds
+ * these keys in the verification stream with memory independent of the
+ * stream length:
+ *
+ * - a Count-Min sketch estimates the frequency of every key seen, never
+ *   below the true frequency;
+ * - a Space-Saving table tracks the k most frequent keys. A key that is not
+ *   tracked replaces the least frequent tracked key once its Count-Min
+ *   estimate exceeds that key's count.
+ *
+ * @code
+ * std::mutex mutex;
+ * identy::sketch::HeavyHitters<32> fingerprints;
+ * identy::sketch::HeavyHitters<16> uuids;
+ *
+ * identy::exec::WorkStealingPool pool(3);
+ * identy::fleet::Verifier verifier([&](std::span<const identy::fleet::Verified> batch) {
+ *     // score workers call the sink concurrently for different batches
+ *     std::lock_guard lock(mutex);
+ *     for(const auto& item : batch) {
+ *         fingerprints.add(item.hash);
+ *         uuids.add(identy::sketch::uuid_key(item.board.smbios));
+ *     }
+ * }, {}, pool);
+ *
+ * // ... push the uploads ...
+ * verifier.finish();
+ *
+ * for(const auto& hitter : fingerprints.top(10)) {
+ *     if(hitter.guaranteed() > 1000) {
+ *         alert(hitter.key);
+ *     }
+ * }
+ * @endcode
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_HEAVY_HITTERS_H
+#define UNC_IDENTY_HEAVY_HITTERS_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "Identy_hash_base.hxx"
+#include "Identy_hwid.hxx"
+
+namespace identy::sketch
+{
+namespace detail
+{
+/** @brief 64-bit hash of a key's bytes; zero-filled keys hash like any other */
+std::uint64_t key_digest(std::span<const byte> key) noexcept;
+} // namespace detail
+
+/**
+ * @brief Count-Min sketch over 64-bit key digests
+ *
+ * depth rows of width 32-bit counters; a key increments one counter per
+ * row and its estimate is the smallest of them. With conservative update
+ * (only the counters below the new estimate grow) the estimate exceeds the
+ * true frequency by at most e / width of the total weight with probability
+ * 1 - e^-depth. Counters saturate instead of wrapping.
+ */
+class CountMin final
+{
+public:
+    static constexpr std::size_t max_depth = 8;
+
+    /**
+     * @param width Counters per row, rounded up to a power of two (at least 64)
+     * @param depth Rows, clamped to [1, max_depth]
+     */
+    explicit CountMin(std::size_t width = std::size_t { 1 } << 16, std::size_t depth = 4);
+
+    /**
+     * @brief Adds @p weight occurrences of a key
+     * @return Estimated frequency of the key after the update
+     */
+    std::uint32_t add(std::uint64_t digest, std::uint32_t weight = 1) noexcept;
+
+    /** @brief Estimated frequency of a key, never below the true one */
+    std::uint32_t estimate(std::uint64_t digest) const noexcept;
+
+    /** @brief Halves every counter, so old occurrences fade out */
+    void decay() noexcept;
+
+    void clear() noexcept;
+
+    std::size_t width() const noexcept
+    {
+        return m_mask + 1;
+    }
+
+    std::size_t depth() const noexcept
+    {
+        return m_depth;
+    }
+
+    std::size_t memory_bytes() const noexcept
+    {
+        return m_counters.capacity() * sizeof(std::uint32_t);
+    }
+
+private:
+    std::size_t m_mask;
+    std::size_t m_depth;
+    std::vector<std::uint32_t> m_counters;
+};
+
+/**
+ * @brief Sizing of a HeavyHitters
+ */
+struct HeavyHittersOptions
+{
+    /** @brief Keys tracked by the Space-Saving table (k) */
+    std::size_t capacity { 64 };
+
+    /** @brief Count-Min counters per row */
+    std::size_t width { std::size_t { 1 } << 16 };
+
+    /** @brief Count-Min rows */
+    std::size_t depth { 4 };
+};
+
+/**
+ * @brief Tracked key reported by HeavyHitters::top()
+ *
+ * The true frequency of @p key lies in [count - error, count].
+ */
+template<std::size_t N>
+struct HeavyHitter
+{
+    hs::Hash<N> key {};
+
+    /** @brief Upper bound of the frequency */
+    std::uint64_t count { 0 };
+
+    /** @brief Part of count taken from the Count-Min estimate when the key entered the table */
+    std::uint64_t error { 0 };
+
+    /** @brief Occurrences counted since the key entered the table: a lower bound of the frequency */
+    std::uint64_t guaranteed() const noexcept
+    {
+        return count - error;
+    }
+};
+
+/**
+ * @brief Most frequent keys of a stream (Count-Min plus Space-Saving)
+ *
+ * add() costs one key hash, depth counter updates and one probe of a small
+ * open-addressing index, and allocates nothing. Memory is fixed at
+ * construction: 4 * width * depth bytes plus about N + 50 bytes per tracked
+ * key.
+ *
+ * Not thread-safe. A fleet::Verifier sink is called concurrently by the
+ * score workers, so guard the sketch with a mutex there (one lock per batch)
+ * or run the verifier with Options::score_threads = 1.
+ *
+ * @tparam N Key size: 32 for Hash256 fingerprints, 16 for SMBIOS UUIDs
+ */
+template<std::size_t N>
+class HeavyHitters final
+{
+public:
+    using Key = hs::Hash<N>;
+
+    explicit HeavyHitters(const HeavyHittersOptions& options = {});
+
+    /** @brief Adds @p weight occurrences of @p key */
+    void add(const Key& key, std::uint32_t weight = 1) noexcept;
+
+    /** @brief Adds one occurrence of every key */
+    void add(std::span<const Key> keys) noexcept;
+
+    /** @brief Estimated frequency of any key, tracked or not; an upper bound */
+    std::uint64_t estimate(const Key& key) const noexcept;
+
+    /**
+     * @brief Tracked keys by descending count
+     * @param limit Maximum number of keys returned
+     */
+    std::vector<HeavyHitter<N>> top(std::size_t limit = std::numeric_limits<std::size_t>::max()) const;
+
+    /**
+     * @brief Halves all counts, so that top() follows recent activity
+     *
+     * Calling it periodically (e.g. every minute) turns the counts into an
+     * exponentially weighted window; a cloning wave rises above the
+     * background within a few periods and fades out after it ends.
+     */
+    void decay() noexcept;
+
+    void clear() noexcept;
+
+    /** @brief Total weight added (and decayed) */
+    std::uint64_t total() const noexcept
+    {
+        return m_total;
+    }
+
+    /** @brief Keys currently tracked */
+    std::size_t size() const noexcept
+    {
+        return m_entries.size();
+    }
+
+    std::size_t capacity() const noexcept
+    {
+        return m_capacity;
+    }
+
+    std::size_t memory_bytes() const noexcept
+    {
+        return m_sketch.memory_bytes() + m_entries.capacity() * sizeof(Entry) + m_heap.capacity() * sizeof(std::uint32_t)
+            + m_slots.capacity() * sizeof(std::uint32_t);
+    }
+
+private:
+    static constexpr std::uint32_t empty_slot = std::numeric_limits<std::uint32_t>::max();
+
+    struct Entry
+    {
+        Key key;
+        std::uint64_t digest;
+        std::uint64_t count;
+        std::uint64_t error;
+        std::uint32_t heap_index;
+    };
+
+    std::uint32_t find(const Key& key, std::uint64_t digest) const noexcept;
+    void index_insert(std::uint32_t entry) noexcept;
+    void index_erase(std::uint64_t digest, std::uint32_t entry) noexcept;
+    void sift_down(std::uint32_t position) noexcept;
+    void sift_up(std::uint32_t position) noexcept;
+    void swap_heap(std::uint32_t a, std::uint32_t b) noexcept;
+
+    std::size_t m_capacity;
+    CountMin m_sketch;
+    std::uint64_t m_total { 0 };
+
+    std::vector<Entry> m_entries;
+
+    // min-heap of entry indices by count
+    std::vector<std::uint32_t> m_heap;
+
+    // linear-probing index from key digest to entry, 2 to 4 slots per entry
+    std::vector<std::uint32_t> m_slots;
+};
+
+/** @brief Key of the SMBIOS UUID, for HeavyHitters<SMBIOS_uuid_length> */
+inline hs::Hash<SMBIOS_uuid_length> uuid_key(const SMBIOS& smbios) noexcept
+{
+    hs::Hash<SMBIOS_uuid_length> key;
+    std::memcpy(key.buffer, smbios.uuid, SMBIOS_uuid_length);
+    return key;
+}
+} // namespace identy::sketch
+
+template<std::size_t N>
+identy::sketch::HeavyHitters<N>::HeavyHitters(const HeavyHittersOptions& options)
+    : m_capacity(std::clamp<std::size_t>(options.capacity, 1, empty_slot / 4))
+    , m_sketch(options.width, options.depth)
+    , m_slots(std::bit_ceil(m_capacity * 2), empty_slot)
+{
+    m_entries.reserve(m_capacity);
+    m_heap.reserve(m_capacity);
+}
+
+template<std::size_t N>
+void identy::sketch::HeavyHitters<N>::add(const Key& key, std::uint32_t weight) noexcept
+{
+    auto digest = detail::key_digest(key.buffer);
+    auto estimate = m_sketch.add(digest, weight);
+    m_total += weight;
+
+    auto entry = find(key, digest);
+    if(entry != empty_slot) {
+        m_entries[entry].count += weight;
+        sift_down(m_entries[entry].heap_index);
+        return;
+    }
+
+    if(m_entries.size() < m_capacity) {
+        auto index = static_cast<std::uint32_t>(m_entries.size());
+        m_entries.push_back({ key, digest, estimate, estimate - weight, static_cast<std::uint32_t>(m_heap.size()) });
+        m_heap.push_back(index);
+        index_insert(index);
+        sift_up(m_entries[index].heap_index);
+        return;
+    }
+
+    // Space-Saving: the key takes the place of the least frequent one, but
+    // only once it may be more frequent
+    auto victim = m_heap.front();
+    auto& min = m_entries[victim];
+    if(estimate <= min.count) {
+        return;
+    }
+
+    index_erase(min.digest, victim);
+    min.key = key;
+    min.digest = digest;
+    min.count = estimate;
+    min.error = estimate - weight;
+    index_insert(victim);
+    sift_down(0);
+}
+
+template<std::size_t N>
+void identy::sketch::HeavyHitters<N>::add(std::span<const Key> keys) noexcept
+{
+    for(const auto& key : keys) {
+        add(key);
+    }
+}
+
+template<std::size_t N>
+std::uint64_t identy::sketch::HeavyHitters<N>::estimate(const Key& key) const noexcept
+{
+    auto digest = detail::key_digest(key.buffer);
+    auto entry = find(key, digest);
+
+    // the table count is exact since the key entered, so it may be tighter
+    std::uint64_t sketch = m_sketch.estimate(digest);
+    return entry != empty_slot ? std::min(sketch, m_entries[entry].count) : sketch;
+}
+
+template<std::size_t N>
+std::vector<identy::sketch::HeavyHitter<N>> identy::sketch::HeavyHitters<N>::top(std::size_t limit) const
+{
+    std::vector<HeavyHitter<N>> hitters;
+    hitters.reserve(m_entries.size());
+
+    for(const auto& entry : m_entries) {
+        hitters.push_back({ entry.key, entry.count, entry.error });
+    }
+
+    std::sort(hitters.begin(), hitters.end(), [](const auto& lhs, const auto& rhs) {
+        if(lhs.count != rhs.count) {
+            return lhs.count > rhs.count;
+        }
+        return std::memcmp(lhs.key.buffer, rhs.key.buffer, N) < 0;
+    });
+
+    if(hitters.size() > limit) {
+        hitters.resize(limit);
+    }
+
+    return hitters;
+}
+
+template<std::size_t N>
+void identy::sketch::HeavyHitters<N>::decay() noexcept
+{
+    m_sketch.decay();
+    m_total /= 2;
+
+    // halving keeps the heap order
+    for(auto& entry : m_entries) {
+        entry.count /= 2;
+        entry.error /= 2;
+    }
+}
+
+template<std::size_t N>
+void identy::sketch::HeavyHitters<N>::clear() noexcept
+{
+    m_sketch.clear();
+    m_total = 0;
+    m_entries.clear();
+    m_heap.clear();
+    std::fill(m_slots.begin(), m_slots.end(), empty_slot);
+}
+
+template<std::size_t N>
+std::uint32_t identy::sketch::HeavyHitters<N>::find(const Key& key, std::uint64_t digest) const noexcept
+{
+    auto mask = m_slots.size() - 1;
+
+    for(auto slot = digest & mask;; slot = (slot + 1) & mask) {
+        auto entry = m_slots[slot];
+        if(entry == empty_slot) {
+            return empty_slot;
+        }
+
+        const auto& candidate = m_entries[entry];
+        if(candidate.digest == digest && std::memcmp(candidate.key.buffer, key.buffer, N) == 0) {
+            return entry;
+        }
+    }
+}
+
+template<std::size_t N>
+void identy::sketch::HeavyHitters<N>::index_insert(std::uint32_t entry) noexcept
+{
+    auto mask = m_slots.size() - 1;
+
+    auto slot = m_entries[entry].digest & mask;
+    while(m_slots[slot] != empty_slot) {
+        slot = (slot + 1) & mask;
+    }
+    m_slots[slot] = entry;
+}
+
+template<std::size_t N>
+void identy::sketch::HeavyHitters<N>::index_erase(std::uint64_t digest, std::uint32_t entry) noexcept
+{
+    auto mask = m_slots.size() - 1;
+
+    auto slot = digest & mask;
+    while(m_slots[slot] != entry) {
+        slot = (slot + 1) & mask;
+    }
+
+    // backward-shift deletion keeps every probe sequence unbroken
+    for(auto next = (slot + 1) & mask; m_slots[next] != empty_slot; next = (next + 1) & mask) {
+        auto home = m_entries[m_slots[next]].digest & mask;
+        if(((next - home) & mask) >= ((next - slot) & mask)) {
+            m_slots[slot] = m_slots[next];
+            slot = next;
+        }
+    }
+    m_slots[slot] = empty_slot;
+}
+
+template<std::size_t N>
+void identy::sketch::HeavyHitters<N>::sift_down(std::uint32_t position) noexcept
+{
+    auto size = static_cast<std::uint32_t>(m_heap.size());
+
+    for(;;) {
+        auto smallest = position;
+        auto left = position * 2 + 1;
+        auto right = left + 1;
+
+        if(left < size && m_entries[m_heap[left]].count < m_entries[m_heap[smallest]].count) {
+            smallest = left;
+        }
+        if(right < size && m_entries[m_heap[right]].count < m_entries[m_heap[smallest]].count) {
+            smallest = right;
+        }
+        if(smallest == position) {
+            return;
+        }
+
+        swap_heap(position, smallest);
+        position = smallest;
+    }
+}
+
+template<std::size_t N>
+void identy::sketch::HeavyHitters<N>::sift_up(std::uint32_t position) noexcept
+{
+    while(position > 0) {
+        auto parent = (position - 1) / 2;
+        if(m_entries[m_heap[parent]].count <= m_entries[m_heap[position]].count) {
+            return;
+        }
+
+        swap_heap(position, parent);
+        position = parent;
+    }
+}
+
+template<std::size_t N>
+void identy::sketch::HeavyHitters<N>::swap_heap(std::uint32_t a, std::uint32_t b) noexcept
+{
+    std::swap(m_heap[a], m_heap[b]);
+    m_entries[m_heap[a]].heap_index = a;
+    m_entries[m_heap[b]].heap_index = b;
+}
+
+#endif
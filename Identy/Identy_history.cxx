@@ -0,0 +1,702 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_history.hxx"
+
+#include "Identy_io.hxx"
+#include "detail/Identy_bytes.hxx"
+#include "Platform/Identy_platform_io.hxx"
+
+namespace
+{
+// History log layout constants (see Identy_history.hxx for the overall layout)
+constexpr std::size_t log_header_size = 16;
+constexpr std::size_t log_version_offset = 4;
+constexpr std::size_t log_interval_offset = 8;
+
+constexpr std::size_t entry_header_size = 24;
+constexpr std::size_t entry_payload_size_offset = 0;
+constexpr std::size_t entry_crc_offset = 4;
+constexpr std::size_t entry_checked_offset = 8;
+constexpr std::size_t entry_type_offset = 8;
+constexpr std::size_t entry_op_count_offset = 10;
+constexpr std::size_t entry_timestamp_offset = 16;
+
+constexpr std::size_t op_header_size = 8;
+
+// Deltas above this size are compared against a full keyframe
+constexpr std::size_t keyframe_probe_size = 256;
+
+/**
+ * Fields addressed by delta operations. Drive fields carry the drive index,
+ * all others use index 0.
+ */
+enum class DeltaField : std::uint16_t {
+    CpuVendor = 1,
+    CpuBrand = 2,
+    CpuHypervisorSignature = 3,
+    CpuVersion = 4,
+    CpuLogicalProcessors = 5,
+    CpuApicId = 6,
+    CpuBrandIndex = 7,
+    CpuClflushLineSize = 8,
+    CpuHypervisorBit = 9,
+    CpuTooOld = 10,
+    CpuInstructionSet = 11,
+    SmbiosVersion = 12,
+    SmbiosUuid = 13,
+    SmbiosTablesSize = 14,
+    SmbiosTablesPatch = 15,
+    DriveCount = 16,
+    DriveBus = 17,
+    DriveDeviceName = 18,
+    DriveSerial = 19,
+    DriveModel = 20,
+    DriveVendor = 21,
+    DriveProduct = 22,
+    SmbiosTier = 23,
+    DrivePathCount = 24
+};
+
+using identy::detail::store_le;
+using identy::detail::load_le;
+using identy::detail::crc32;
+
+class DeltaEncoder
+{
+public:
+    explicit DeltaEncoder(std::vector<identy::byte>& out) noexcept
+        : m_out(out)
+    {
+    }
+
+    std::uint16_t count() const noexcept
+    {
+        return m_count;
+    }
+
+    // whether an operation did not fit the u16 count or drive index, or its
+    // value the u32 size; such a delta cannot be written
+    bool overflowed() const noexcept
+    {
+        return m_overflow;
+    }
+
+    void op(DeltaField field, std::size_t index, std::span<const identy::byte> value)
+    {
+        if(m_overflow || m_count == std::numeric_limits<std::uint16_t>::max()
+            || index > std::numeric_limits<std::uint16_t>::max() || value.size() > std::numeric_limits<std::uint32_t>::max()) {
+            m_overflow = true;
+            return;
+        }
+
+        auto offset = m_out.size();
+        m_out.resize(offset + op_header_size + value.size());
+
+        auto* dst = m_out.data() + offset;
+        store_le(dst, static_cast<std::uint16_t>(field));
+        store_le(dst + 2, static_cast<std::uint16_t>(index));
+        store_le(dst + 4, static_cast<std::uint32_t>(value.size()));
+
+        if(!value.empty()) {
+            std::memcpy(dst + op_header_size, value.data(), value.size());
+        }
+
+        ++m_count;
+    }
+
+    void string(DeltaField field, std::size_t index, std::string_view before, std::string_view after)
+    {
+        if(before != after) {
+            op(field, index, { reinterpret_cast<const identy::byte*>(after.data()), after.size() });
+        }
+    }
+
+    template<typename T>
+    void value(DeltaField field, std::size_t index, T before, T after)
+    {
+        if(before != after) {
+            identy::byte encoded[sizeof(T)];
+            store_le(encoded, after);
+            op(field, index, encoded);
+        }
+    }
+
+private:
+    std::vector<identy::byte>& m_out;
+    std::uint16_t m_count { 0 };
+    bool m_overflow { false };
+};
+
+void encode_isa(identy::byte* dst, const identy::Cpu& cpu) noexcept
+{
+    store_le(dst, cpu.instruction_set.basic);
+    store_le(dst + 4, cpu.instruction_set.modern);
+    for(std::size_t i = 0; i < 3; ++i) {
+        store_le(dst + 8 + i * 4, cpu.instruction_set.extended_modern[i]);
+    }
+}
+
+void encode_smbios_version(identy::byte* dst, const identy::SMBIOS& smbios) noexcept
+{
+    dst[0] = smbios.is_20_calling_used ? 1 : 0;
+    dst[1] = smbios.major_version;
+    dst[2] = smbios.minor_version;
+    dst[3] = smbios.dmi_version;
+}
+
+void encode_tables_delta(DeltaEncoder& delta, const std::vector<std::uint8_t>& before, const std::vector<std::uint8_t>& after)
+{
+    if(before.size() != after.size()) {
+        delta.value(DeltaField::SmbiosTablesSize, 0, static_cast<std::uint32_t>(before.size()),
+            static_cast<std::uint32_t>(after.size()));
+    }
+
+    // the patch applies after resizing, so bytes past the old end compare against zero
+    auto before_at = [&](std::size_t i) -> std::uint8_t { return i < before.size() ? before[i] : 0; };
+
+    std::size_t first = 0;
+    while(first < after.size() && before_at(first) == after[first]) {
+        ++first;
+    }
+
+    if(first == after.size()) {
+        return;
+    }
+
+    std::size_t last = after.size();
+    while(last > first && before_at(last - 1) == after[last - 1]) {
+        --last;
+    }
+
+    std::vector<identy::byte> patch(4 + (last - first));
+    store_le(patch.data(), static_cast<std::uint32_t>(first));
+    std::memcpy(patch.data() + 4, after.data() + first, last - first);
+
+    delta.op(DeltaField::SmbiosTablesPatch, 0, patch);
+}
+
+/** Returns the operation count, std::nullopt if the change needs a keyframe */
+std::optional<std::uint16_t> encode_delta(std::vector<identy::byte>& out, const identy::MotherboardEx& before,
+    const identy::MotherboardEx& after)
+{
+    DeltaEncoder delta(out);
+
+    const auto& a = before.cpu;
+    const auto& b = after.cpu;
+
+    delta.string(DeltaField::CpuVendor, 0, a.vendor, b.vendor);
+    delta.string(DeltaField::CpuBrand, 0, a.extended_brand_string, b.extended_brand_string);
+    delta.string(DeltaField::CpuHypervisorSignature, 0, a.hypervisor_signature, b.hypervisor_signature);
+    delta.value(DeltaField::CpuVersion, 0, a.version, b.version);
+    delta.value(DeltaField::CpuLogicalProcessors, 0, a.logical_processors_count, b.logical_processors_count);
+    delta.value(DeltaField::CpuApicId, 0, a.apic_id, b.apic_id);
+    delta.value(DeltaField::CpuBrandIndex, 0, a.brand_index, b.brand_index);
+    delta.value(DeltaField::CpuClflushLineSize, 0, a.clflush_line_size, b.clflush_line_size);
+    delta.value<std::uint8_t>(DeltaField::CpuHypervisorBit, 0, a.hypervisor_bit, b.hypervisor_bit);
+    delta.value<std::uint8_t>(DeltaField::CpuTooOld, 0, a.too_old, b.too_old);
+
+    identy::byte isa_before[20];
+    identy::byte isa_after[20];
+    encode_isa(isa_before, a);
+    encode_isa(isa_after, b);
+    if(std::memcmp(isa_before, isa_after, sizeof(isa_after)) != 0) {
+        delta.op(DeltaField::CpuInstructionSet, 0, isa_after);
+    }
+
+    identy::byte version_before[4];
+    identy::byte version_after[4];
+    encode_smbios_version(version_before, before.smbios);
+    encode_smbios_version(version_after, after.smbios);
+    if(std::memcmp(version_before, version_after, sizeof(version_after)) != 0) {
+        delta.op(DeltaField::SmbiosVersion, 0, version_after);
+    }
+
+    if(std::memcmp(before.smbios.uuid, after.smbios.uuid, identy::SMBIOS_uuid_length) != 0) {
+        delta.op(DeltaField::SmbiosUuid, 0, after.smbios.uuid);
+    }
+
+    delta.value(DeltaField::SmbiosTier, 0, static_cast<std::uint8_t>(before.smbios.tier), static_cast<std::uint8_t>(after.smbios.tier));
+
+    encode_tables_delta(delta, before.smbios.raw_tables_data, after.smbios.raw_tables_data);
+
+    delta.value(DeltaField::DriveCount, 0, static_cast<std::uint32_t>(before.drives.size()),
+        static_cast<std::uint32_t>(after.drives.size()));
+
+    static const identy::PhysicalDriveInfo no_drive {};
+
+    for(std::size_t i = 0; i < after.drives.size(); ++i) {
+        const auto& x = i < before.drives.size() ? before.drives[i] : no_drive;
+        const auto& y = after.drives[i];
+
+        delta.value(DeltaField::DriveBus, i, static_cast<std::uint32_t>(x.bus_type), static_cast<std::uint32_t>(y.bus_type));
+        delta.string(DeltaField::DriveDeviceName, i, x.device_name, y.device_name);
+        delta.string(DeltaField::DriveSerial, i, x.serial, y.serial);
+        delta.string(DeltaField::DriveModel, i, x.model_id, y.model_id);
+        delta.string(DeltaField::DriveVendor, i, x.vendor_id, y.vendor_id);
+        delta.string(DeltaField::DriveProduct, i, x.product_id, y.product_id);
+        delta.value(DeltaField::DrivePathCount, i, x.path_count, y.path_count);
+
+        if(delta.overflowed()) {
+            return std::nullopt;
+        }
+    }
+
+    if(delta.overflowed() || out.size() > std::numeric_limits<std::uint32_t>::max()) {
+        return std::nullopt;
+    }
+
+    return delta.count();
+}
+
+bool apply_delta(identy::MotherboardEx& mb, std::span<const identy::byte> payload, std::uint16_t op_count)
+{
+    for(std::uint16_t n = 0; n < op_count; ++n) {
+        if(payload.size() < op_header_size) {
+            return false;
+        }
+
+        auto field = static_cast<DeltaField>(load_le<std::uint16_t>(payload.data()));
+        auto index = load_le<std::uint16_t>(payload.data() + 2);
+        auto size = load_le<std::uint32_t>(payload.data() + 4);
+
+        if(payload.size() - op_header_size < size) {
+            return false;
+        }
+
+        auto value = payload.subspan(op_header_size, size);
+        auto text = std::string_view(reinterpret_cast<const char*>(value.data()), value.size());
+        payload = payload.subspan(op_header_size + size);
+
+        auto fixed = [&](std::size_t expected) { return value.size() == expected; };
+
+        auto* drive = index < mb.drives.size() ? &mb.drives[index] : nullptr;
+        bool drive_field = (field >= DeltaField::DriveBus && field <= DeltaField::DriveProduct) || field == DeltaField::DrivePathCount;
+        if(drive_field && drive == nullptr) {
+            return false;
+        }
+
+        switch(field) {
+            case DeltaField::CpuVendor:
+                mb.cpu.vendor = text;
+                break;
+            case DeltaField::CpuBrand:
+                mb.cpu.extended_brand_string = text;
+                break;
+            case DeltaField::CpuHypervisorSignature:
+                mb.cpu.hypervisor_signature = text;
+                break;
+            case DeltaField::CpuVersion:
+                if(!fixed(4)) {
+                    return false;
+                }
+                mb.cpu.version = load_le<identy::register_32>(value.data());
+                break;
+            case DeltaField::CpuLogicalProcessors:
+                if(!fixed(4)) {
+                    return false;
+                }
+                mb.cpu.logical_processors_count = load_le<identy::register_32>(value.data());
+                break;
+            case DeltaField::CpuApicId:
+            case DeltaField::CpuBrandIndex:
+            case DeltaField::CpuClflushLineSize:
+            case DeltaField::CpuHypervisorBit:
+            case DeltaField::CpuTooOld:
+                if(!fixed(1)) {
+                    return false;
+                }
+                if(field == DeltaField::CpuApicId) {
+                    mb.cpu.apic_id = value[0];
+                }
+                else if(field == DeltaField::CpuBrandIndex) {
+                    mb.cpu.brand_index = value[0];
+                }
+                else if(field == DeltaField::CpuClflushLineSize) {
+                    mb.cpu.clflush_line_size = value[0];
+                }
+                else if(field == DeltaField::CpuHypervisorBit) {
+                    mb.cpu.hypervisor_bit = value[0] != 0;
+                }
+                else {
+                    mb.cpu.too_old = value[0] != 0;
+                }
+                break;
+            case DeltaField::CpuInstructionSet:
+                if(!fixed(20)) {
+                    return false;
+                }
+                mb.cpu.instruction_set.basic = load_le<identy::register_32>(value.data());
+                mb.cpu.instruction_set.modern = load_le<identy::register_32>(value.data() + 4);
+                for(std::size_t i = 0; i < 3; ++i) {
+                    mb.cpu.instruction_set.extended_modern[i] = load_le<identy::register_32>(value.data() + 8 + i * 4);
+                }
+                break;
+            case DeltaField::SmbiosVersion:
+                if(!fixed(4)) {
+                    return false;
+                }
+                mb.smbios.is_20_calling_used = value[0] != 0;
+                mb.smbios.major_version = value[1];
+                mb.smbios.minor_version = value[2];
+                mb.smbios.dmi_version = value[3];
+                break;
+            case DeltaField::SmbiosUuid:
+                if(!fixed(identy::SMBIOS_uuid_length)) {
+                    return false;
+                }
+                std::memcpy(mb.smbios.uuid, value.data(), identy::SMBIOS_uuid_length);
+                break;
+            case DeltaField::SmbiosTier:
+                if(!fixed(1) || value[0] > static_cast<std::uint8_t>(identy::SmbiosTier::Table)) {
+                    return false;
+                }
+                mb.smbios.tier = static_cast<identy::SmbiosTier>(value[0]);
+                break;
+            case DeltaField::SmbiosTablesSize:
+                if(!fixed(4)) {
+                    return false;
+                }
+                mb.smbios.raw_tables_data.resize(load_le<std::uint32_t>(value.data()));
+                break;
+            case DeltaField::SmbiosTablesPatch: {
+                if(value.size() < 4) {
+                    return false;
+                }
+                auto offset = load_le<std::uint32_t>(value.data());
+                auto bytes = value.subspan(4);
+                auto& tables = mb.smbios.raw_tables_data;
+                if(offset > tables.size() || bytes.size() > tables.size() - offset) {
+                    return false;
+                }
+                std::memcpy(tables.data() + offset, bytes.data(), bytes.size());
+                break;
+            }
+            case DeltaField::DriveCount:
+                if(!fixed(4)) {
+                    return false;
+                }
+                mb.drives.resize(load_le<std::uint32_t>(value.data()));
+                break;
+            case DeltaField::DriveBus:
+                if(!fixed(4)) {
+                    return false;
+                }
+                drive->bus_type = static_cast<identy::PhysicalDriveInfo::BusType>(load_le<std::uint32_t>(value.data()));
+                break;
+            case DeltaField::DriveDeviceName:
+                drive->device_name = text;
+                break;
+            case DeltaField::DriveSerial:
+                drive->serial = text;
+                break;
+            case DeltaField::DriveModel:
+                drive->model_id = text;
+                break;
+            case DeltaField::DriveVendor:
+                drive->vendor_id = text;
+                break;
+            case DeltaField::DriveProduct:
+                drive->product_id = text;
+                break;
+            case DeltaField::DrivePathCount:
+                if(!fixed(4)) {
+                    return false;
+                }
+                drive->path_count = load_le<std::uint32_t>(value.data());
+                break;
+            default:
+                return false;
+        }
+    }
+
+    return payload.empty();
+}
+} // namespace
+
+// ============================================================================
+// HistoryWriter
+// ============================================================================
+
+identy::io::HistoryWriter::HistoryWriter(HistoryWriter&&) noexcept = default;
+identy::io::HistoryWriter& identy::io::HistoryWriter::operator=(HistoryWriter&&) noexcept = default;
+identy::io::HistoryWriter::~HistoryWriter() = default;
+
+std::optional<identy::io::HistoryWriter> identy::io::HistoryWriter::open(const std::filesystem::path& path,
+    std::uint32_t keyframe_interval)
+{
+    HistoryWriter writer;
+    writer.m_keyframe_interval = std::max<std::uint32_t>(keyframe_interval, 1);
+
+    std::error_code ec;
+    if(std::filesystem::exists(path, ec)) {
+        std::uint64_t file_size = 0;
+
+        {
+            auto reader = HistoryReader::open(path);
+            if(!reader) {
+                return std::nullopt;
+            }
+
+            writer.m_keyframe_interval = std::max<std::uint32_t>(reader->keyframe_interval(), 1);
+            writer.m_entries = reader->entry_count();
+            writer.m_size = reader->valid_size();
+            file_size = reader->m_file->bytes().size();
+
+            if(writer.m_entries != 0) {
+                auto last = writer.m_entries - 1;
+                auto state = reader->snapshot(last);
+                if(!state) {
+                    return std::nullopt;
+                }
+
+                writer.m_last = std::move(*state);
+                writer.m_last_timestamp = reader->timestamp(last);
+                writer.m_since_keyframe = static_cast<std::uint32_t>(last - reader->m_entries[last].keyframe);
+            }
+        }
+
+        // cut off a torn or corrupted tail before appending behind it
+        if(file_size != writer.m_size) {
+            std::filesystem::resize_file(path, writer.m_size, ec);
+            if(ec) {
+                return std::nullopt;
+            }
+        }
+
+        writer.m_file = std::make_unique<std::ofstream>(path, std::ios::binary | std::ios::app);
+    }
+    else {
+        writer.m_file = std::make_unique<std::ofstream>(path, std::ios::binary | std::ios::trunc);
+
+        byte header[log_header_size] {};
+        std::memcpy(header, history_magic, sizeof(history_magic));
+        store_le(header + log_version_offset, history_version);
+        store_le(header + log_interval_offset, writer.m_keyframe_interval);
+
+        writer.m_file->write(reinterpret_cast<const char*>(header), sizeof(header));
+        writer.m_file->flush();
+        writer.m_size = log_header_size;
+    }
+
+    if(!writer.m_file->good()) {
+        return std::nullopt;
+    }
+
+    return writer;
+}
+
+std::optional<identy::io::HistoryEntryType> identy::io::HistoryWriter::append(const MotherboardEx& mb, std::uint64_t timestamp)
+{
+    if(m_entries != 0 && timestamp < m_last_timestamp) {
+        return std::nullopt;
+    }
+
+    auto& entry = m_scratch;
+    entry.assign(entry_header_size, 0);
+
+    auto type = HistoryEntryType::Keyframe;
+    std::uint16_t op_count = 0;
+
+    if(m_entries != 0 && m_since_keyframe + 1 < m_keyframe_interval) {
+        type = HistoryEntryType::Delta;
+        auto ops = encode_delta(entry, m_last, mb);
+        op_count = ops.value_or(0);
+
+        if(!ops) {
+            type = HistoryEntryType::Keyframe;
+            entry.resize(entry_header_size);
+        }
+        else if(entry.size() - entry_header_size > keyframe_probe_size) {
+            std::vector<byte> keyframe;
+            auto keyframe_size = encode_binary(keyframe, mb);
+            if(keyframe_size != 0 && keyframe_size <= entry.size() - entry_header_size) {
+                type = HistoryEntryType::Keyframe;
+                entry.resize(entry_header_size);
+            }
+        }
+    }
+
+    if(type == HistoryEntryType::Keyframe) {
+        op_count = 0;
+        if(encode_binary(entry, mb) == 0) {
+            return std::nullopt;
+        }
+    }
+
+    auto payload_size = entry.size() - entry_header_size;
+    store_le(entry.data() + entry_payload_size_offset, static_cast<std::uint32_t>(payload_size));
+    store_le(entry.data() + entry_type_offset, static_cast<std::uint16_t>(type));
+    store_le(entry.data() + entry_op_count_offset, op_count);
+    store_le(entry.data() + entry_timestamp_offset, timestamp);
+    store_le(entry.data() + entry_crc_offset, crc32(std::span<const byte>(entry).subspan(entry_checked_offset)));
+
+    m_file->write(reinterpret_cast<const char*>(entry.data()), static_cast<std::streamsize>(entry.size()));
+    m_file->flush();
+
+    if(!m_file->good()) {
+        return std::nullopt;
+    }
+
+    m_last = mb;
+    m_last_timestamp = timestamp;
+    m_size += entry.size();
+    ++m_entries;
+    m_since_keyframe = type == HistoryEntryType::Keyframe ? 0 : m_since_keyframe + 1;
+
+    return type;
+}
+
+std::size_t identy::io::HistoryWriter::entry_count() const noexcept
+{
+    return m_entries;
+}
+
+std::uint64_t identy::io::HistoryWriter::size() const noexcept
+{
+    return m_size;
+}
+
+// ============================================================================
+// HistoryReader
+// ============================================================================
+
+identy::io::HistoryReader::HistoryReader(HistoryReader&&) noexcept = default;
+identy::io::HistoryReader& identy::io::HistoryReader::operator=(HistoryReader&&) noexcept = default;
+identy::io::HistoryReader::~HistoryReader() = default;
+
+std::optional<identy::io::HistoryReader> identy::io::HistoryReader::open(const std::filesystem::path& path)
+{
+    auto file = platform::MappedFile::open(path, true);
+    if(!file) {
+        return std::nullopt;
+    }
+
+    auto bytes = file->bytes();
+
+    if(bytes.size() < log_header_size || std::memcmp(bytes.data(), history_magic, sizeof(history_magic)) != 0) {
+        return std::nullopt;
+    }
+
+    auto version = load_le<std::uint32_t>(bytes.data() + log_version_offset);
+    if(version == 0 || version > history_version) {
+        return std::nullopt;
+    }
+
+    HistoryReader reader;
+    reader.m_keyframe_interval = load_le<std::uint32_t>(bytes.data() + log_interval_offset);
+
+    std::uint64_t offset = log_header_size;
+    std::optional<std::uint32_t> keyframe;
+
+    while(bytes.size() - offset >= entry_header_size) {
+        const auto* header = bytes.data() + offset;
+        auto payload_size = load_le<std::uint32_t>(header + entry_payload_size_offset);
+
+        if(bytes.size() - offset - entry_header_size < payload_size) {
+            break; // torn entry
+        }
+
+        auto checked = bytes.subspan(static_cast<std::size_t>(offset) + entry_checked_offset,
+            entry_header_size - entry_checked_offset + payload_size);
+        if(crc32(checked) != load_le<std::uint32_t>(header + entry_crc_offset)) {
+            break;
+        }
+
+        EntryInfo info;
+        info.offset = offset;
+        info.size = payload_size;
+        info.type = static_cast<HistoryEntryType>(load_le<std::uint16_t>(header + entry_type_offset));
+        info.op_count = load_le<std::uint16_t>(header + entry_op_count_offset);
+        info.timestamp = load_le<std::uint64_t>(header + entry_timestamp_offset);
+
+        if(info.type == HistoryEntryType::Keyframe) {
+            keyframe = static_cast<std::uint32_t>(reader.m_entries.size());
+        }
+        else if(info.type != HistoryEntryType::Delta || !keyframe) {
+            break;
+        }
+
+        if(!reader.m_entries.empty() && info.timestamp < reader.m_entries.back().timestamp) {
+            break;
+        }
+
+        info.keyframe = *keyframe;
+        reader.m_entries.push_back(info);
+
+        offset += entry_header_size + payload_size;
+    }
+
+    reader.m_valid_size = offset;
+    reader.m_file = std::move(file);
+
+    return reader;
+}
+
+std::size_t identy::io::HistoryReader::entry_count() const noexcept
+{
+    return m_entries.size();
+}
+
+std::uint32_t identy::io::HistoryReader::keyframe_interval() const noexcept
+{
+    return m_keyframe_interval;
+}
+
+std::uint64_t identy::io::HistoryReader::timestamp(std::size_t index) const noexcept
+{
+    return index < m_entries.size() ? m_entries[index].timestamp : 0;
+}
+
+identy::io::HistoryEntryType identy::io::HistoryReader::type(std::size_t index) const noexcept
+{
+    return index < m_entries.size() ? m_entries[index].type : HistoryEntryType::Keyframe;
+}
+
+std::size_t identy::io::HistoryReader::change_count(std::size_t index) const noexcept
+{
+    return index < m_entries.size() ? m_entries[index].op_count : 0;
+}
+
+std::optional<identy::MotherboardEx> identy::io::HistoryReader::snapshot(std::size_t index) const
+{
+    if(index >= m_entries.size()) {
+        return std::nullopt;
+    }
+
+    auto bytes = m_file->bytes();
+    auto payload = [&](const EntryInfo& info) {
+        return bytes.subspan(static_cast<std::size_t>(info.offset) + entry_header_size, info.size);
+    };
+
+    const auto& keyframe = m_entries[m_entries[index].keyframe];
+
+    auto reader = read_binary(payload(keyframe));
+    if(!reader) {
+        return std::nullopt;
+    }
+
+    auto state = reader->to_motherboard_ex();
+
+    for(std::size_t i = m_entries[index].keyframe + 1; i <= index; ++i) {
+        if(!apply_delta(state, payload(m_entries[i]), m_entries[i].op_count)) {
+            return std::nullopt;
+        }
+    }
+
+    return state;
+}
+
+std::optional<identy::MotherboardEx> identy::io::HistoryReader::at(std::uint64_t timestamp) const
+{
+    auto it = std::ranges::upper_bound(m_entries, timestamp, {}, &EntryInfo::timestamp);
+    if(it == m_entries.begin()) {
+        return std::nullopt;
+    }
+
+    return snapshot(static_cast<std::size_t>(std::distance(m_entries.begin(), it)) - 1);
+}
+
+std::uint64_t identy::io::HistoryReader::valid_size() const noexcept
+{
+    return m_valid_size;
+}
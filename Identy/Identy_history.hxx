@@ -0,0 +1,218 @@
+/**
+ * @file Identy_history.hxx
+ * @brief Append-only per-host fingerprint history with delta encoding
+ *
+ * Hosts that are snapshotted periodically almost never change, so storing a
+ * full snapshot per observation is wasteful. A history log stores a full
+ * keyframe every few entries and, in between, only the fields that changed
+ * against the previous entry ("drive #3 serial changed"). An unchanged
+ * observation costs a single entry header.
+ *
+ * ## Log Layout (version 1)
+ *
+ * The log starts with a 16-byte header ("IDHL", version, keyframe interval)
+ * followed by entries. All integers are little-endian.
+ *
+ * | Offset | Size | Entry content                                        |
+ * |--------|------|------------------------------------------------------|
+ * | 0      | 4    | Payload size                                         |
+ * | 4      | 4    | CRC-32 of bytes 8.. of the entry (header and payload) |
+ * | 8      | 2    | Entry type: 1 = keyframe, 2 = delta                  |
+ * | 10     | 2    | Operation count (deltas)                             |
+ * | 12     | 4    | Reserved                                             |
+ * | 16     | 8    | Timestamp supplied by the writer                     |
+ * | 24     | ...  | Payload                                              |
+ *
+ * A keyframe payload is a complete binary snapshot (see io::encode_binary()).
+ * A delta payload is a list of operations {u16 field, u16 drive index,
+ * u32 size, value}; SMBIOS tables are patched by byte range. A change that
+ * needs more than 65535 operations or touches a drive past index 65535 is
+ * written as a keyframe instead.
+ *
+ * Readers stop at the first entry that is truncated or fails its checksum.
+ * Writers cut such a tail off when reopening the log.
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_HISTORY_H
+#define UNC_IDENTY_HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "Identy_hwid.hxx"
+
+namespace identy::platform
+{
+class MappedFile;
+} // namespace identy::platform
+
+namespace identy::io
+{
+/** @brief Magic bytes at the beginning of a history log ("IDHL") */
+constexpr byte history_magic[4] = { 'I', 'D', 'H', 'L' };
+
+/** @brief Current history log version */
+constexpr std::uint32_t history_version = 1;
+
+/** @brief Default number of entries between two keyframes */
+constexpr std::uint32_t history_default_keyframe_interval = 64;
+
+/**
+ * @brief Kind of a history entry
+ */
+enum class HistoryEntryType : std::uint16_t {
+    Keyframe = 1, /**< Complete snapshot */
+    Delta = 2     /**< Changes against the previous entry */
+};
+
+/**
+ * @brief Appends observations of one host to a history log
+ *
+ * Example usage:
+ * @code
+ * auto log = identy::io::HistoryWriter::open("host-42.idhl");
+ * log->append(identy::snap_motherboard_ex(), unix_time_now);
+ * @endcode
+ *
+ * @note Not thread-safe; a log must have a single writer.
+ */
+class HistoryWriter final
+{
+public:
+    /**
+     * @brief Opens a log for appending, creating it if missing
+     *
+     * An existing log is replayed to recover the last state, and a truncated or
+     * corrupted tail is removed.
+     *
+     * @param path Log file
+     * @param keyframe_interval Entries between keyframes for a new log; existing
+     *                          logs keep the interval stored in their header
+     * @return Writer, std::nullopt if the file cannot be opened or is not a history log
+     */
+    static std::optional<HistoryWriter> open(const std::filesystem::path& path,
+        std::uint32_t keyframe_interval = history_default_keyframe_interval);
+
+    HistoryWriter(HistoryWriter&&) noexcept;
+    HistoryWriter& operator=(HistoryWriter&&) noexcept;
+    ~HistoryWriter();
+
+    /**
+     * @brief Records an observation
+     *
+     * Writes a keyframe when the interval is reached or when the delta would not
+     * be smaller than a keyframe, otherwise a delta against the previous entry.
+     *
+     * @param mb Observed hardware state
+     * @param timestamp Observation time; must not be lower than the previous one
+     * @return Type of the written entry, std::nullopt on a timestamp going
+     *         backwards or a write error
+     */
+    std::optional<HistoryEntryType> append(const MotherboardEx& mb, std::uint64_t timestamp);
+
+    /** @brief Number of entries in the log */
+    std::size_t entry_count() const noexcept;
+
+    /** @brief Size of the log in bytes */
+    std::uint64_t size() const noexcept;
+
+private:
+    HistoryWriter() = default;
+
+    std::unique_ptr<std::ofstream> m_file;
+    std::uint32_t m_keyframe_interval { history_default_keyframe_interval };
+    std::uint32_t m_since_keyframe { 0 };
+    std::size_t m_entries { 0 };
+    std::uint64_t m_size { 0 };
+    std::uint64_t m_last_timestamp { 0 };
+    MotherboardEx m_last;
+    std::vector<byte> m_scratch;
+};
+
+/**
+ * @brief Random access reader of history logs
+ *
+ * open() memory-maps the log and indexes all intact entries, verifying their
+ * checksums once. Reconstructing an entry replays deltas from the nearest
+ * preceding keyframe.
+ */
+class HistoryReader final
+{
+public:
+    /**
+     * @brief Maps and indexes a history log
+     *
+     * @param path Log file
+     * @return Reader, std::nullopt if the file cannot be mapped or is not a history log
+     */
+    static std::optional<HistoryReader> open(const std::filesystem::path& path);
+
+    HistoryReader(HistoryReader&&) noexcept;
+    HistoryReader& operator=(HistoryReader&&) noexcept;
+    ~HistoryReader();
+
+    /** @brief Number of intact entries */
+    std::size_t entry_count() const noexcept;
+
+    /** @brief Keyframe interval stored in the log header */
+    std::uint32_t keyframe_interval() const noexcept;
+
+    /** @brief Timestamp of entry @p index */
+    std::uint64_t timestamp(std::size_t index) const noexcept;
+
+    /** @brief Type of entry @p index */
+    HistoryEntryType type(std::size_t index) const noexcept;
+
+    /** @brief Number of changed fields recorded by entry @p index, 0 for keyframes */
+    std::size_t change_count(std::size_t index) const noexcept;
+
+    /**
+     * @brief Reconstructs the hardware state recorded by entry @p index
+     *
+     * @return State, std::nullopt if @p index is out of range or a payload is malformed
+     */
+    std::optional<MotherboardEx> snapshot(std::size_t index) const;
+
+    /**
+     * @brief Reconstructs the hardware state at a point in time
+     *
+     * @param timestamp Point in time
+     * @return State of the last entry not newer than @p timestamp, std::nullopt
+     *         if the log starts later
+     */
+    std::optional<MotherboardEx> at(std::uint64_t timestamp) const;
+
+    /** @brief Byte size of the intact part of the log */
+    std::uint64_t valid_size() const noexcept;
+
+private:
+    friend class HistoryWriter;
+
+    struct EntryInfo
+    {
+        std::uint64_t offset { 0 };
+        std::uint64_t timestamp { 0 };
+        std::uint32_t size { 0 };
+        HistoryEntryType type { HistoryEntryType::Keyframe };
+        std::uint16_t op_count { 0 };
+        std::uint32_t keyframe { 0 };
+    };
+
+    HistoryReader() = default;
+
+    std::unique_ptr<platform::MappedFile> m_file;
+    std::uint32_t m_keyframe_interval { 0 };
+    std::uint64_t m_valid_size { 0 };
+    std::vector<EntryInfo> m_entries;
+};
+} // namespace identy::io
+
+#endif
@@ -1,7 +1,9 @@
 #include "Identy_pch.hxx"
 
 #include "Identy_hwid.hxx"
+#include "Identy_trace.hxx"
 #include "Platform/Identy_platform_hwid.hxx"
+#include "Platform/Identy_platform_source.hxx"
 
 namespace
 {
@@ -32,32 +34,14 @@ constexpr identy::dword EDX = 3;
 
 namespace
 {
-void intrin_cpuid(int registers[4], int leaf)
+void intrin_cpuid(identy::register_32 registers[4], identy::register_32 leaf)
 {
-#ifdef IDENTY_MSVC
-    __cpuid(registers, leaf);
-#elif defined(IDENTY_GNUC) || defined(IDENTY_CLANG)
-    unsigned int eax, ebx, ecx, edx;
-    __cpuid(leaf, eax, ebx, ecx, edx);
-    registers[0] = static_cast<int>(eax);
-    registers[1] = static_cast<int>(ebx);
-    registers[2] = static_cast<int>(ecx);
-    registers[3] = static_cast<int>(edx);
-#endif
+    identy::platform::source().cpuid(registers, leaf, 0);
 }
 
-void intrin_cpuidex(int registers[4], int leaf, int subleaf)
+void intrin_cpuidex(identy::register_32 registers[4], identy::register_32 leaf, identy::register_32 subleaf)
 {
-#ifdef IDENTY_MSVC
-    __cpuidex(registers, leaf, subleaf);
-#elif defined(IDENTY_GNUC) || defined(IDENTY_CLANG)
-    unsigned int eax, ebx, ecx, edx;
-    __cpuid_count(leaf, subleaf, eax, ebx, ecx, edx);
-    registers[0] = static_cast<int>(eax);
-    registers[1] = static_cast<int>(ebx);
-    registers[2] = static_cast<int>(ecx);
-    registers[3] = static_cast<int>(edx);
-#endif
+    identy::platform::source().cpuid(registers, leaf, subleaf);
 }
 } // namespace
 
@@ -114,6 +98,8 @@ std::vector<std::uint8_t> get_smbios_uuid(const std::vector<identy::byte>& table
 
 identy::Cpu get_cpu_info()
 {
+    identy::trace::Span span(identy::trace::Phase::CpuInfo);
+
     identy::Cpu cpu;
 
     identy::register_32 cpu_info[4] = { -1 };
@@ -238,10 +224,27 @@ identy::Cpu get_cpu_info()
 
 identy::Motherboard identy::snap_motherboard()
 {
+    trace::Span span(trace::Phase::SnapMotherboard);
+
     Motherboard motherboard;
     motherboard.cpu = get_cpu_info();
 
-    auto smbios_raw = platform::get_smbios();
+    platform::AccessPlan local_plan;
+    auto& plan = &platform::source() == &platform::live_source() ? platform::live_access_plan() : local_plan;
+
+    auto smbios_raw = [&plan] {
+        trace::Span smbios_span(trace::Phase::GetSmbios);
+        return platform::get_smbios(plan);
+    }();
+
+    // unprivileged: a running daemon has the tables this process cannot read
+    if(smbios_raw.tier != SmbiosTier::Table) {
+        if(auto smbios = platform::query_daemon_smbios(plan)) {
+            motherboard.smbios = std::move(*smbios);
+            return motherboard;
+        }
+    }
+
     if(smbios_raw.empty()) {
         return motherboard;
     }
@@ -250,6 +253,7 @@ identy::Motherboard identy::snap_motherboard()
     motherboard.smbios.minor_version = smbios_raw.minor_version;
     motherboard.smbios.is_20_calling_used = smbios_raw.used_20_calling_method == 1;
     motherboard.smbios.dmi_version = smbios_raw.dmi_revision;
+    motherboard.smbios.tier = smbios_raw.tier;
 
     motherboard.smbios.raw_tables_data = std::move(smbios_raw.table_data);
 
@@ -266,6 +270,8 @@ identy::Motherboard identy::snap_motherboard()
 
 identy::MotherboardEx identy::snap_motherboard_ex()
 {
+    trace::Span span(trace::Phase::SnapMotherboardEx);
+
     MotherboardEx motherboard;
 
     auto short_mb = snap_motherboard();
@@ -284,5 +290,11 @@ identy::MotherboardEx identy::snap_motherboard_ex()
 
 std::vector<identy::PhysicalDriveInfo> identy::list_drives()
 {
+    trace::Span span(trace::Phase::ListDrives);
     return platform::list_drives();
 }
+
+identy::Cpu identy::snap_cpu()
+{
+    return get_cpu_info();
+}
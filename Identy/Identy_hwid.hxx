@@ -44,22 +44,22 @@ struct Cpu
     std::string vendor;
 
     /** @brief Processor version information from CPUID EAX register (leaf 0x01) */
-    register_32 version;
+    register_32 version { 0 };
 
     /** @brief Hypervisor bit */
-    bool hypervisor_bit;
+    bool hypervisor_bit { false };
 
     /** @brief Brand index value indicating the processor brand string table index */
-    std::uint8_t brand_index;
+    std::uint8_t brand_index { 0 };
 
     /** @brief CLFLUSH instruction cache line size in 8-byte increments */
-    std::uint8_t clflush_line_size;
+    std::uint8_t clflush_line_size { 0 };
 
     /** @brief Number of logical processors per physical package */
-    register_32 logical_processors_count;
+    register_32 logical_processors_count { 0 };
 
     /** @brief Advanced Programmable Interrupt Controller (APIC) ID */
-    std::uint8_t apic_id;
+    std::uint8_t apic_id { 0 };
 
     /** @brief Extended processor brand string (human-readable model name) */
     std::string extended_brand_string;
@@ -76,13 +76,13 @@ struct Cpu
     struct _instruction_set
     {
         /** @brief Basic instruction set features from CPUID leaf 0x01 (EDX register) */
-        register_32 basic;
+        register_32 basic { 0 };
 
         /** @brief Modern instruction set features from CPUID leaf 0x01 (ECX register) */
-        register_32 modern;
+        register_32 modern { 0 };
 
         /** @brief Extended modern instruction set features from CPUID leaf 0x07 (EBX, ECX, EDX registers) */
-        register_32 extended_modern[3];
+        register_32 extended_modern[3] {};
     } instruction_set;
 
     /**
@@ -118,6 +118,20 @@ struct SMBIOS_Header
 };
 #pragma pack(pop)
 
+/**
+ * @brief Source the SMBIOS fields of a snapshot were collected from
+ *
+ * Ordered by completeness. Unprivileged processes on Linux cannot read the
+ * raw tables and fall back to the world-readable DMI attributes, or to a
+ * running identyd that can (see Identy_tier.hxx).
+ */
+enum class SmbiosTier : std::uint8_t {
+    None = 0,       /**< No SMBIOS data was available */
+    Attributes = 1, /**< UUID and version from /sys/class/dmi/id, no raw tables */
+    Daemon = 2,     /**< Complete data served by identyd */
+    Table = 3       /**< Complete data read from the firmware tables */
+};
+
 /**
  * @brief Managed SMBIOS data structure using modern C++ containers
  *
@@ -131,22 +145,25 @@ struct SMBIOS_Header
 struct SMBIOS
 {
     /** @brief Indicates whether SMBIOS 2.0 calling convention was used */
-    bool is_20_calling_used;
+    bool is_20_calling_used { false };
 
     /** @brief SMBIOS specification major version number */
-    byte major_version;
+    byte major_version { 0 };
 
     /** @brief SMBIOS specification minor version number */
-    byte minor_version;
+    byte minor_version { 0 };
 
     /** @brief Desktop Management Interface (DMI) version number */
-    byte dmi_version;
+    byte dmi_version { 0 };
 
     /** @brief System UUID (128-bit universally unique identifier) as defined by SMBIOS Type 1 */
-    byte uuid[SMBIOS_uuid_length];
+    byte uuid[SMBIOS_uuid_length] {};
 
     /** @brief Complete raw SMBIOS table data copied from firmware, managed by std::vector */
     std::vector<std::uint8_t> raw_tables_data;
+
+    /** @brief Source the fields above came from; not part of the fingerprint */
+    SmbiosTier tier { SmbiosTier::None };
 };
 
 /**
@@ -209,6 +226,14 @@ struct PhysicalDriveInfo
 
     /** @brief Human-readable device product ID */
     std::string product_id;
+
+    /**
+     * @brief Block device paths leading to the drive
+     *
+     * More than 1 for a multipath LUN, which is reported once instead of
+     * once per path. Not part of the fingerprint: paths come and go.
+     */
+    std::uint32_t path_count { 1 };
 };
 
 /**
@@ -296,6 +321,15 @@ IDENTY_EXPORT MotherboardEx snap_motherboard_ex();
 namespace identy
 {
 IDENTY_EXPORT std::vector<PhysicalDriveInfo> list_drives();
+
+/**
+ * @brief Reads CPU identification only
+ *
+ * The CPUID part of snap_motherboard(), for callers that do not need SMBIOS.
+ *
+ * @return CPU information
+ */
+IDENTY_EXPORT Cpu snap_cpu();
 } // namespace identy
 
 #endif
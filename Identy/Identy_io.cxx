@@ -2,149 +2,607 @@
 
 #include "Identy_io.hxx"
 
+#include "Identy_blob_store.hxx"
 #include "Identy_hwid.hxx"
+#include "detail/Identy_bytes.hxx"
 
 namespace
 {
-template<typename MB>
-void write_text_common(std::ostream& stream, MB&& mb)
+// Binary snapshot layout constants (see Identy_io.hxx for the overall layout)
+constexpr std::size_t header_magic_offset = 0;
+constexpr std::size_t header_version_offset = 4;
+constexpr std::size_t header_kind_offset = 6;
+constexpr std::size_t header_size_offset = 8;
+constexpr std::size_t header_field_count_offset = 12;
+
+constexpr std::size_t cpu_info_size = 36;
+constexpr std::size_t cpu_version_offset = 0;
+constexpr std::size_t cpu_logical_processors_offset = 4;
+constexpr std::size_t cpu_isa_basic_offset = 8;
+constexpr std::size_t cpu_isa_modern_offset = 12;
+constexpr std::size_t cpu_isa_extended_offset = 16;
+constexpr std::size_t cpu_hypervisor_bit_offset = 28;
+constexpr std::size_t cpu_brand_index_offset = 29;
+constexpr std::size_t cpu_clflush_offset = 30;
+constexpr std::size_t cpu_apic_id_offset = 31;
+constexpr std::size_t cpu_too_old_offset = 32;
+
+constexpr std::size_t smbios_info_size = 21;
+constexpr std::size_t smbios_info_min_size = 20;
+constexpr std::size_t smbios_is_20_offset = 0;
+constexpr std::size_t smbios_major_offset = 1;
+constexpr std::size_t smbios_minor_offset = 2;
+constexpr std::size_t smbios_dmi_offset = 3;
+constexpr std::size_t smbios_uuid_offset = 4;
+constexpr std::size_t smbios_tier_offset = 20;
+
+constexpr std::size_t drives_header_size = 8;
+constexpr std::size_t drive_strings_count = 5;
+constexpr std::size_t drive_record_size = 8 + drive_strings_count * 8;
+constexpr std::size_t drive_bus_type_offset = 0;
+constexpr std::size_t drive_path_count_offset = 4;
+constexpr std::size_t drive_strings_offset = 8;
+
+constexpr std::size_t max_snapshot_fields = 9;
+
+constexpr std::size_t align_up(std::size_t value) noexcept
 {
-    stream << "CPU:\n";
-    stream << mb.cpu.extended_brand_string;
-    stream << " Vendor: " << mb.cpu.vendor << "\n";
-    stream << " Cores: " << mb.cpu.logical_processors_count << "\n";
-    stream << " Hypervisor present: " << std::format("{}", mb.cpu.hypervisor_bit) << "\n";
-    stream << " Hypervisor signature (if presented) " << mb.cpu.hypervisor_signature << "\n";
+    return (value + identy::io::snapshot_alignment - 1) & ~(identy::io::snapshot_alignment - 1);
+}
+
+using identy::detail::store_le;
+using identy::detail::load_le;
+
+std::span<const identy::byte> as_bytes(std::string_view string) noexcept
+{
+    return { reinterpret_cast<const identy::byte*>(string.data()), string.size() };
+}
+
+/**
+ * @brief Single section of a snapshot being encoded
+ *
+ * Sections with non-empty @p source are copied verbatim, fixed-size blocks are
+ * filled in place after the layout is known.
+ */
+struct SectionPlan
+{
+    identy::io::SnapshotField id;
+    std::size_t size { 0 };
+    std::span<const identy::byte> source;
+    std::size_t offset { 0 };
+};
+
+void fill_cpu_info(identy::byte* dst, const identy::Cpu& cpu) noexcept
+{
+    store_le(dst + cpu_version_offset, cpu.version);
+    store_le(dst + cpu_logical_processors_offset, cpu.logical_processors_count);
+    store_le(dst + cpu_isa_basic_offset, cpu.instruction_set.basic);
+    store_le(dst + cpu_isa_modern_offset, cpu.instruction_set.modern);
+
+    for(std::size_t i = 0; i < std::size(cpu.instruction_set.extended_modern); ++i) {
+        store_le(dst + cpu_isa_extended_offset + i * sizeof(identy::register_32), cpu.instruction_set.extended_modern[i]);
+    }
+
+    dst[cpu_hypervisor_bit_offset] = cpu.hypervisor_bit ? 1 : 0;
+    dst[cpu_brand_index_offset] = cpu.brand_index;
+    dst[cpu_clflush_offset] = cpu.clflush_line_size;
+    dst[cpu_apic_id_offset] = cpu.apic_id;
+    dst[cpu_too_old_offset] = cpu.too_old ? 1 : 0;
+}
+
+void fill_smbios_info(identy::byte* dst, const identy::SMBIOS& smbios) noexcept
+{
+    dst[smbios_is_20_offset] = smbios.is_20_calling_used ? 1 : 0;
+    dst[smbios_major_offset] = smbios.major_version;
+    dst[smbios_minor_offset] = smbios.minor_version;
+    dst[smbios_dmi_offset] = smbios.dmi_version;
+    std::memcpy(dst + smbios_uuid_offset, smbios.uuid, identy::SMBIOS_uuid_length);
+    dst[smbios_tier_offset] = static_cast<identy::byte>(smbios.tier);
+}
+
+std::array<std::string_view, drive_strings_count> drive_strings(const identy::PhysicalDriveInfo& drive) noexcept
+{
+    return { drive.device_name, drive.serial, drive.model_id, drive.vendor_id, drive.product_id };
+}
+
+void fill_drives(identy::byte* records, identy::byte* pool, const std::vector<identy::PhysicalDriveInfo>& drives) noexcept
+{
+    store_le(records, static_cast<std::uint32_t>(drives.size()));
+    store_le(records + 4, static_cast<std::uint32_t>(drive_record_size));
+
+    identy::byte* record = records + drives_header_size;
+    std::uint32_t pool_offset = 0;
+
+    for(const auto& drive : drives) {
+        store_le(record + drive_bus_type_offset, static_cast<std::uint32_t>(drive.bus_type));
+        store_le(record + drive_path_count_offset, drive.path_count);
+
+        auto strings = drive_strings(drive);
+        for(std::size_t i = 0; i < strings.size(); ++i) {
+            auto size = static_cast<std::uint32_t>(strings[i].size());
 
-    stream << "Motherboard:\n";
-    stream << std::format(
-        " SMBIOS UUID: {:02x}{:02x}{:02x}{:02x}-{:02x}{:02x}-{:02x}{:02x}-{:02x}{:02x}-{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}\n",
-        mb.smbios.uuid[0], mb.smbios.uuid[1], mb.smbios.uuid[2], mb.smbios.uuid[3], mb.smbios.uuid[4], mb.smbios.uuid[5], mb.smbios.uuid[6],
-        mb.smbios.uuid[7], mb.smbios.uuid[8], mb.smbios.uuid[9], mb.smbios.uuid[10], mb.smbios.uuid[11], mb.smbios.uuid[12],
-        mb.smbios.uuid[13], mb.smbios.uuid[14], mb.smbios.uuid[15]);
+            store_le(record + drive_strings_offset + i * 8, pool_offset);
+            store_le(record + drive_strings_offset + i * 8 + 4, size);
 
-    stream << " SMBIOS Ver: ";
-    stream << std::format("{}.{}\n", mb.smbios.major_version, mb.smbios.minor_version);
+            if(size != 0) {
+                std::memcpy(pool + pool_offset, strings[i].data(), size);
+            }
 
-    stream << " SMBIOS DMI Ver: ";
-    stream << std::format("{}\n", mb.smbios.dmi_version);
+            pool_offset += size;
+        }
 
-    stream << " SMBIOS 2.0 calling convention: " << std::format("{}\n", mb.smbios.is_20_calling_used);
+        record += drive_record_size;
+    }
 }
 
 template<typename MB>
-void write_binary_common(std::ostream& stream, MB&& mb)
+std::size_t encode_common(std::vector<identy::byte>& out, const MB& mb, identy::io::SnapshotKind kind,
+    const std::vector<identy::PhysicalDriveInfo>* drives, const identy::io::BlobRef* tables_ref)
 {
-    if(!stream.good()) {
-        return;
+    using identy::io::SnapshotField;
+
+    SectionPlan sections[max_snapshot_fields];
+    std::size_t count = 0;
+
+    std::size_t cpu_index = count;
+    sections[count++] = { SnapshotField::CpuInfo, cpu_info_size, {}, 0 };
+    sections[count++] = { SnapshotField::CpuVendor, mb.cpu.vendor.size(), as_bytes(mb.cpu.vendor), 0 };
+    sections[count++] = { SnapshotField::CpuBrand, mb.cpu.extended_brand_string.size(), as_bytes(mb.cpu.extended_brand_string), 0 };
+    sections[count++] = { SnapshotField::CpuHypervisorSignature, mb.cpu.hypervisor_signature.size(),
+        as_bytes(mb.cpu.hypervisor_signature), 0 };
+
+    std::size_t smbios_index = count;
+    sections[count++] = { SnapshotField::SmbiosInfo, smbios_info_size, {}, 0 };
+
+    if(tables_ref != nullptr) {
+        sections[count++] = { SnapshotField::SmbiosTablesRef, sizeof(tables_ref->buffer), tables_ref->buffer, 0 };
+    }
+    else {
+        sections[count++] = { SnapshotField::SmbiosTables, mb.smbios.raw_tables_data.size(), mb.smbios.raw_tables_data, 0 };
     }
 
-    std::uint32_t vendor_size = static_cast<std::uint32_t>(mb.cpu.vendor.size());
-    stream.write(reinterpret_cast<const char*>(&vendor_size), sizeof(vendor_size));
-    stream.write(mb.cpu.vendor.data(), vendor_size);
+    std::size_t drives_index = 0;
+    std::size_t pool_index = 0;
 
-    stream.write(reinterpret_cast<const char*>(&mb.cpu.version), sizeof(mb.cpu.version));
+    if(drives != nullptr) {
+        std::size_t pool_size = 0;
+        for(const auto& drive : *drives) {
+            for(auto string : drive_strings(drive)) {
+                pool_size += string.size();
+            }
+        }
 
-    stream.write(reinterpret_cast<const char*>(&mb.cpu.hypervisor_bit), sizeof(mb.cpu.hypervisor_bit));
+        drives_index = count;
+        sections[count++] = { SnapshotField::Drives, drives_header_size + drives->size() * drive_record_size, {}, 0 };
 
-    stream.write(reinterpret_cast<const char*>(&mb.cpu.brand_index), sizeof(mb.cpu.brand_index));
-    stream.write(reinterpret_cast<const char*>(&mb.cpu.clflush_line_size), sizeof(mb.cpu.clflush_line_size));
-    stream.write(reinterpret_cast<const char*>(&mb.cpu.logical_processors_count), sizeof(mb.cpu.logical_processors_count));
+        pool_index = count;
+        sections[count++] = { SnapshotField::DriveStrings, pool_size, {}, 0 };
+    }
 
-    std::uint32_t brand_size = static_cast<std::uint32_t>(mb.cpu.extended_brand_string.size());
-    stream.write(reinterpret_cast<const char*>(&brand_size), sizeof(brand_size));
-    stream.write(mb.cpu.extended_brand_string.data(), brand_size);
+    std::size_t total = align_up(identy::io::snapshot_header_size + count * identy::io::snapshot_field_entry_size);
 
-    std::uint32_t hyperv_size = static_cast<std::uint32_t>(mb.cpu.hypervisor_signature.size());
-    stream.write(reinterpret_cast<const char*>(&hyperv_size), sizeof(hyperv_size));
-    stream.write(mb.cpu.hypervisor_signature.data(), hyperv_size);
+    for(std::size_t i = 0; i < count; ++i) {
+        sections[i].offset = total;
+        total = align_up(total + sections[i].size);
+    }
 
-    stream.write(reinterpret_cast<const char*>(&mb.cpu.instruction_set.basic), sizeof(mb.cpu.instruction_set.basic));
-    stream.write(reinterpret_cast<const char*>(&mb.cpu.instruction_set.modern), sizeof(mb.cpu.instruction_set.modern));
-    stream.write(reinterpret_cast<const char*>(mb.cpu.instruction_set.extended_modern), sizeof(mb.cpu.instruction_set.extended_modern));
+    // section offsets and the header size are 32-bit
+    if(total > std::numeric_limits<std::uint32_t>::max()) {
+        return 0;
+    }
 
-    stream.write(reinterpret_cast<const char*>(&mb.smbios.is_20_calling_used), sizeof(mb.smbios.is_20_calling_used));
-    stream.write(reinterpret_cast<const char*>(&mb.smbios.major_version), sizeof(mb.smbios.major_version));
-    stream.write(reinterpret_cast<const char*>(&mb.smbios.minor_version), sizeof(mb.smbios.minor_version));
-    stream.write(reinterpret_cast<const char*>(&mb.smbios.dmi_version), sizeof(mb.smbios.dmi_version));
+    auto base_offset = out.size();
+    out.resize(base_offset + total);
 
-    stream.write(reinterpret_cast<const char*>(mb.smbios.uuid), sizeof(mb.smbios.uuid));
+    identy::byte* base = out.data() + base_offset;
+
+    std::memcpy(base + header_magic_offset, identy::io::snapshot_magic, sizeof(identy::io::snapshot_magic));
+    store_le(base + header_version_offset, identy::io::snapshot_version);
+    store_le(base + header_kind_offset, static_cast<std::uint16_t>(kind));
+    store_le(base + header_size_offset, static_cast<std::uint32_t>(total));
+    store_le(base + header_field_count_offset, static_cast<std::uint16_t>(count));
+
+    identy::byte* entry = base + identy::io::snapshot_header_size;
+
+    for(std::size_t i = 0; i < count; ++i) {
+        store_le(entry, static_cast<std::uint16_t>(sections[i].id));
+        store_le(entry + 4, static_cast<std::uint32_t>(sections[i].offset));
+        store_le(entry + 8, static_cast<std::uint32_t>(sections[i].size));
+
+        if(!sections[i].source.empty()) {
+            std::memcpy(base + sections[i].offset, sections[i].source.data(), sections[i].source.size());
+        }
+
+        entry += identy::io::snapshot_field_entry_size;
+    }
+
+    fill_cpu_info(base + sections[cpu_index].offset, mb.cpu);
+    fill_smbios_info(base + sections[smbios_index].offset, mb.smbios);
+
+    if(drives != nullptr) {
+        fill_drives(base + sections[drives_index].offset, base + sections[pool_index].offset, *drives);
+    }
+
+    return total;
 }
 }; // namespace
 
-void identy::io::write_text(std::ostream& stream, const Motherboard& mb)
+std::size_t identy::io::encode_binary(std::vector<byte>& out, const Motherboard& mb)
 {
-    if(!stream.good()) {
-        return; // todo: throw error
+    return encode_common(out, mb, SnapshotKind::Motherboard, nullptr, nullptr);
+}
+
+std::size_t identy::io::encode_binary(std::vector<byte>& out, const MotherboardEx& mb)
+{
+    return encode_common(out, mb, SnapshotKind::MotherboardEx, &mb.drives, nullptr);
+}
+
+std::size_t identy::io::encode_binary(std::vector<byte>& out, const MotherboardEx& mb, BlobStore& store)
+{
+    auto tables_ref = store.put(mb.smbios.raw_tables_data);
+    if(!tables_ref) {
+        return 0;
     }
 
-    write_text_common(stream, mb);
+    return encode_common(out, mb, SnapshotKind::MotherboardEx, &mb.drives, &*tables_ref);
 }
 
-void identy::io::write_text(std::ostream& stream, const MotherboardEx& mb)
+void identy::io::write_binary(std::ostream& stream, const Motherboard& mb)
 {
     if(!stream.good()) {
         return;
     }
 
-    write_text_common(stream, mb);
+    std::vector<byte> buffer;
+    if(encode_binary(buffer, mb) == 0) {
+        stream.setstate(std::ios::failbit);
+        return;
+    }
+
+    stream.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+}
 
-    stream << "Physical Drives:\n";
-    if(mb.drives.empty()) {
-        stream << " No drives detected or insufficient permissions\n";
+void identy::io::write_binary(std::ostream& stream, const MotherboardEx& mb)
+{
+    if(!stream.good()) {
+        return;
+    }
+
+    std::vector<byte> buffer;
+    if(encode_binary(buffer, mb) == 0) {
+        stream.setstate(std::ios::failbit);
         return;
     }
 
-    for(std::size_t i = 0; i < mb.drives.size(); ++i) {
-        const auto& drive = mb.drives[i];
-
-        stream << std::format(" Drive {}\n", i + 1);
-        stream << "  Device: " << drive.device_name << "\n";
-        stream << "  Serial: " << drive.serial << "\n";
-        stream << "  Bus Type: ";
-
-        switch(drive.bus_type) {
-            case PhysicalDriveInfo::SATA:
-                stream << "SATA\n";
-                break;
-            case PhysicalDriveInfo::NMVe:
-                stream << "NVMe\n";
-                break;
-            case PhysicalDriveInfo::USB:
-                stream << "USB\n";
-                break;
-            default:
-                stream << "Unknown\n";
-                break;
+    stream.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+}
+
+std::optional<identy::io::SnapshotReader> identy::io::read_binary(std::span<const byte> buffer) noexcept
+{
+    return SnapshotReader::open(buffer);
+}
+
+std::optional<identy::io::SnapshotReader> identy::io::SnapshotReader::open(std::span<const byte> buffer) noexcept
+{
+    if(buffer.size() < snapshot_header_size || std::memcmp(buffer.data(), snapshot_magic, sizeof(snapshot_magic)) != 0) {
+        return std::nullopt;
+    }
+
+    const byte* data = buffer.data();
+
+    SnapshotReader reader;
+    reader.m_data = data;
+    reader.m_version = load_le<std::uint16_t>(data + header_version_offset);
+    reader.m_size = load_le<std::uint32_t>(data + header_size_offset);
+
+    auto kind = load_le<std::uint16_t>(data + header_kind_offset);
+    auto field_count = load_le<std::uint16_t>(data + header_field_count_offset);
+
+    if(reader.m_version == 0 || reader.m_version > snapshot_version) {
+        return std::nullopt;
+    }
+
+    if(kind != static_cast<std::uint16_t>(SnapshotKind::Motherboard) && kind != static_cast<std::uint16_t>(SnapshotKind::MotherboardEx)) {
+        return std::nullopt;
+    }
+
+    reader.m_kind = static_cast<SnapshotKind>(kind);
+
+    std::uint64_t table_end = snapshot_header_size + std::uint64_t { field_count } * snapshot_field_entry_size;
+
+    if(reader.m_size > buffer.size() || table_end > reader.m_size) {
+        return std::nullopt;
+    }
+
+    for(std::size_t i = 0; i < field_count; ++i) {
+        const byte* entry = data + snapshot_header_size + i * snapshot_field_entry_size;
+
+        auto id = load_le<std::uint16_t>(entry);
+        auto offset = load_le<std::uint32_t>(entry + 4);
+        auto size = load_le<std::uint32_t>(entry + 8);
+
+        if(offset < table_end || std::uint64_t { offset } + size > reader.m_size) {
+            return std::nullopt;
+        }
+
+        if(id == 0 || id > max_field_id) {
+            continue; // unknown field written by a newer minor revision
+        }
+
+        if(reader.m_field_mask & (1u << id)) {
+            return std::nullopt;
+        }
+
+        reader.m_field_mask |= 1u << id;
+        reader.m_fields[id] = { offset, size };
+    }
+
+    if(reader.has_field(SnapshotField::CpuInfo) && reader.field(SnapshotField::CpuInfo).size() < cpu_info_size) {
+        return std::nullopt;
+    }
+
+    if(reader.has_field(SnapshotField::SmbiosInfo) && reader.field(SnapshotField::SmbiosInfo).size() < smbios_info_min_size) {
+        return std::nullopt;
+    }
+
+    if(reader.has_field(SnapshotField::SmbiosTablesRef) && reader.field(SnapshotField::SmbiosTablesRef).size() != sizeof(BlobRef::buffer)) {
+        return std::nullopt;
+    }
+
+    if(reader.has_field(SnapshotField::Drives)) {
+        auto drives = reader.field(SnapshotField::Drives);
+        auto pool = reader.field(SnapshotField::DriveStrings);
+
+        if(drives.size() < drives_header_size) {
+            return std::nullopt;
+        }
+
+        reader.m_drive_count = load_le<std::uint32_t>(drives.data());
+        reader.m_drive_record_size = load_le<std::uint32_t>(drives.data() + 4);
+
+        if(reader.m_drive_record_size < drive_record_size
+            || drives_header_size + std::uint64_t { reader.m_drive_count } * reader.m_drive_record_size > drives.size()) {
+            return std::nullopt;
+        }
+
+        for(std::size_t i = 0; i < reader.m_drive_count; ++i) {
+            const byte* record = drives.data() + drives_header_size + i * reader.m_drive_record_size;
+
+            for(std::size_t s = 0; s < drive_strings_count; ++s) {
+                auto offset = load_le<std::uint32_t>(record + drive_strings_offset + s * 8);
+                auto size = load_le<std::uint32_t>(record + drive_strings_offset + s * 8 + 4);
+
+                if(std::uint64_t { offset } + size > pool.size()) {
+                    return std::nullopt;
+                }
+            }
         }
     }
+
+    return reader;
 }
 
-void identy::io::write_binary(std::ostream& stream, const Motherboard& mb)
+identy::io::SnapshotKind identy::io::SnapshotReader::kind() const noexcept
 {
-    write_binary_common(stream, mb);
+    return m_kind;
 }
 
-void identy::io::write_binary(std::ostream& stream, const MotherboardEx& mb)
+std::uint16_t identy::io::SnapshotReader::version() const noexcept
 {
-    if(!stream.good()) {
+    return m_version;
+}
+
+std::size_t identy::io::SnapshotReader::size() const noexcept
+{
+    return m_size;
+}
+
+std::span<const identy::byte> identy::io::SnapshotReader::bytes() const noexcept
+{
+    return { m_data, m_size };
+}
+
+bool identy::io::SnapshotReader::has_field(SnapshotField id) const noexcept
+{
+    auto index = static_cast<std::uint16_t>(id);
+    return index <= max_field_id && (m_field_mask & (1u << index)) != 0;
+}
+
+std::span<const identy::byte> identy::io::SnapshotReader::field(SnapshotField id) const noexcept
+{
+    if(!has_field(id)) {
+        return {};
+    }
+
+    const auto& range = m_fields[static_cast<std::uint16_t>(id)];
+    return { m_data + range.offset, range.size };
+}
+
+std::string_view identy::io::SnapshotReader::cpu_vendor() const noexcept
+{
+    auto bytes = field(SnapshotField::CpuVendor);
+    return { reinterpret_cast<const char*>(bytes.data()), bytes.size() };
+}
+
+std::string_view identy::io::SnapshotReader::cpu_brand() const noexcept
+{
+    auto bytes = field(SnapshotField::CpuBrand);
+    return { reinterpret_cast<const char*>(bytes.data()), bytes.size() };
+}
+
+std::string_view identy::io::SnapshotReader::cpu_hypervisor_signature() const noexcept
+{
+    auto bytes = field(SnapshotField::CpuHypervisorSignature);
+    return { reinterpret_cast<const char*>(bytes.data()), bytes.size() };
+}
+
+std::span<const identy::byte> identy::io::SnapshotReader::smbios_tables() const noexcept
+{
+    return field(SnapshotField::SmbiosTables);
+}
+
+std::optional<identy::io::BlobRef> identy::io::SnapshotReader::smbios_tables_ref() const noexcept
+{
+    auto bytes = field(SnapshotField::SmbiosTablesRef);
+    if(bytes.empty()) {
+        return std::nullopt;
+    }
+
+    BlobRef ref;
+    std::memcpy(ref.buffer, bytes.data(), sizeof(ref.buffer));
+
+    return ref;
+}
+
+std::span<const identy::byte, identy::SMBIOS_uuid_length> identy::io::SnapshotReader::smbios_uuid() const noexcept
+{
+    static constexpr byte zero_uuid[SMBIOS_uuid_length] {};
+
+    auto info = field(SnapshotField::SmbiosInfo);
+    if(info.empty()) {
+        return std::span<const byte, SMBIOS_uuid_length>(zero_uuid);
+    }
+
+    return info.subspan<smbios_uuid_offset, SMBIOS_uuid_length>();
+}
+
+identy::SmbiosTier identy::io::SnapshotReader::smbios_tier() const noexcept
+{
+    auto info = field(SnapshotField::SmbiosInfo);
+    if(info.size() > smbios_tier_offset) {
+        auto tier = info[smbios_tier_offset];
+        return tier <= static_cast<byte>(SmbiosTier::Table) ? static_cast<SmbiosTier>(tier) : SmbiosTier::None;
+    }
+
+    // written before the tier was recorded
+    if(!smbios_tables().empty() || smbios_tables_ref().has_value()) {
+        return SmbiosTier::Table;
+    }
+
+    auto uuid = smbios_uuid();
+    return std::ranges::any_of(uuid, [](byte b) { return b != 0; }) ? SmbiosTier::Attributes : SmbiosTier::None;
+}
+
+std::size_t identy::io::SnapshotReader::drive_count() const noexcept
+{
+    return m_drive_count;
+}
+
+identy::io::DriveView identy::io::SnapshotReader::drive(std::size_t index) const noexcept
+{
+    assert(index < m_drive_count && "drive index out of range");
+
+    auto drives = field(SnapshotField::Drives);
+    auto pool = field(SnapshotField::DriveStrings);
+
+    const byte* record = drives.data() + drives_header_size + index * m_drive_record_size;
+
+    std::string_view strings[drive_strings_count];
+
+    for(std::size_t i = 0; i < drive_strings_count; ++i) {
+        auto offset = load_le<std::uint32_t>(record + drive_strings_offset + i * 8);
+        auto size = load_le<std::uint32_t>(record + drive_strings_offset + i * 8 + 4);
+
+        strings[i] = { reinterpret_cast<const char*>(pool.data()) + offset, size };
+    }
+
+    DriveView view;
+    view.bus_type = static_cast<PhysicalDriveInfo::BusType>(load_le<std::uint32_t>(record + drive_bus_type_offset));
+
+    // snapshots written before multipath grouping have 0 here
+    view.path_count = std::max(load_le<std::uint32_t>(record + drive_path_count_offset), std::uint32_t { 1 });
+    view.device_name = strings[0];
+    view.serial = strings[1];
+    view.model_id = strings[2];
+    view.vendor_id = strings[3];
+    view.product_id = strings[4];
+
+    return view;
+}
+
+void identy::io::SnapshotReader::read_cpu(Cpu& cpu) const
+{
+    cpu.vendor = cpu_vendor();
+    cpu.extended_brand_string = cpu_brand();
+    cpu.hypervisor_signature = cpu_hypervisor_signature();
+
+    auto info = field(SnapshotField::CpuInfo);
+    if(info.empty()) {
         return;
     }
 
-    write_binary_common(stream, mb);
+    const byte* src = info.data();
 
-    std::uint32_t drives_count = static_cast<std::uint32_t>(mb.drives.size());
-    stream.write(reinterpret_cast<const char*>(&drives_count), sizeof(drives_count));
+    cpu.version = load_le<register_32>(src + cpu_version_offset);
+    cpu.logical_processors_count = load_le<register_32>(src + cpu_logical_processors_offset);
+    cpu.instruction_set.basic = load_le<register_32>(src + cpu_isa_basic_offset);
+    cpu.instruction_set.modern = load_le<register_32>(src + cpu_isa_modern_offset);
 
-    for(const auto& drive : mb.drives) {
-        stream.write(reinterpret_cast<const char*>(&drive.bus_type), sizeof(drive.bus_type));
+    for(std::size_t i = 0; i < std::size(cpu.instruction_set.extended_modern); ++i) {
+        cpu.instruction_set.extended_modern[i] = load_le<register_32>(src + cpu_isa_extended_offset + i * sizeof(register_32));
+    }
 
-        std::uint32_t name_size = static_cast<std::uint32_t>(drive.device_name.size());
-        stream.write(reinterpret_cast<const char*>(&name_size), sizeof(name_size));
-        stream.write(drive.device_name.data(), name_size);
+    cpu.hypervisor_bit = src[cpu_hypervisor_bit_offset] != 0;
+    cpu.brand_index = src[cpu_brand_index_offset];
+    cpu.clflush_line_size = src[cpu_clflush_offset];
+    cpu.apic_id = src[cpu_apic_id_offset];
+    cpu.too_old = src[cpu_too_old_offset] != 0;
+}
+
+void identy::io::SnapshotReader::read_smbios(SMBIOS& smbios, const BlobStore* store) const
+{
+    auto tables = smbios_tables();
 
-        std::uint32_t serial_size = static_cast<std::uint32_t>(drive.serial.size());
-        stream.write(reinterpret_cast<const char*>(&serial_size), sizeof(serial_size));
-        stream.write(drive.serial.data(), serial_size);
+    if(auto ref = smbios_tables_ref(); ref.has_value() && store != nullptr) {
+        tables = store->get(*ref).value_or(std::span<const byte> {});
     }
+
+    smbios.raw_tables_data.assign(tables.begin(), tables.end());
+    smbios.tier = smbios_tier();
+
+    auto info = field(SnapshotField::SmbiosInfo);
+    if(info.empty()) {
+        return;
+    }
+
+    smbios.is_20_calling_used = info[smbios_is_20_offset] != 0;
+    smbios.major_version = info[smbios_major_offset];
+    smbios.minor_version = info[smbios_minor_offset];
+    smbios.dmi_version = info[smbios_dmi_offset];
+    std::memcpy(smbios.uuid, info.data() + smbios_uuid_offset, SMBIOS_uuid_length);
+}
+
+identy::Motherboard identy::io::SnapshotReader::to_motherboard(const BlobStore* store) const
+{
+    Motherboard mb;
+    read_cpu(mb.cpu);
+    read_smbios(mb.smbios, store);
+
+    return mb;
+}
+
+identy::MotherboardEx identy::io::SnapshotReader::to_motherboard_ex(const BlobStore* store) const
+{
+    MotherboardEx mb;
+    read_cpu(mb.cpu);
+    read_smbios(mb.smbios, store);
+
+    mb.drives.reserve(m_drive_count);
+
+    for(std::size_t i = 0; i < m_drive_count; ++i) {
+        auto view = drive(i);
+
+        PhysicalDriveInfo info;
+        info.bus_type = view.bus_type;
+        info.device_name = view.device_name;
+        info.serial = view.serial;
+        info.model_id = view.model_id;
+        info.vendor_id = view.vendor_id;
+        info.product_id = view.product_id;
+        info.path_count = view.path_count;
+
+        mb.drives.push_back(std::move(info));
+    }
+
+    return mb;
 }
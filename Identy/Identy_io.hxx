@@ -10,10 +10,25 @@
  * ## Supported Output Formats
  *
  * - **Text Format** - Human-readable structured output with labeled fields
- * - **Binary Format** - Compact binary serialization for efficient storage
+ * - **JSON Format** - One JSON object per line for log pipelines
+ * - **Binary Format** - Versioned little-endian snapshot with zero-copy reader
  * - **Raw Hash** - Direct byte-level hash output for transmission/comparison
  *
- * @note All functions operate on std::ostream, supporting files, stringstreams,
+ * ## Binary Snapshot Layout (version 1)
+ *
+ * All integers are little-endian regardless of host byte order.
+ *
+ * | Offset | Size | Content                                              |
+ * |--------|------|------------------------------------------------------|
+ * | 0      | 16   | Header: magic "IDSN", version, kind, size, fields    |
+ * | 16     | 12*N | Field table: id, reserved, offset, size per field    |
+ * | ...    | ...  | Field sections, each aligned to snapshot_alignment   |
+ *
+ * Offsets in the field table are relative to the beginning of the snapshot.
+ * Readers skip field ids they do not know, so new fields can be appended
+ * without bumping the format version.
+ *
+ * @note Writers operate on std::ostream, supporting files, stringstreams,
  *       network sockets, or any other stream-compatible output target.
  */
 
@@ -22,7 +37,13 @@
 #ifndef UNC_IDENTY_IO_H
 #define UNC_IDENTY_IO_H
 
+#include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <ostream>
+#include <span>
+#include <string_view>
+#include <vector>
 
 #include "Identy_hash.hxx"
 
@@ -32,6 +53,197 @@ struct Motherboard;
 struct MotherboardEx;
 } // namespace identy
 
+namespace identy::io
+{
+/** @brief Magic bytes at the beginning of every binary snapshot ("IDSN") */
+constexpr byte snapshot_magic[4] = { 'I', 'D', 'S', 'N' };
+
+/** @brief Current binary snapshot format version */
+constexpr std::uint16_t snapshot_version = 1;
+
+/** @brief Alignment of every field section inside a binary snapshot */
+constexpr std::size_t snapshot_alignment = 8;
+
+/** @brief Size of the fixed binary snapshot header in bytes */
+constexpr std::size_t snapshot_header_size = 16;
+
+/** @brief Size of a single field table entry in bytes */
+constexpr std::size_t snapshot_field_entry_size = 12;
+
+/**
+ * @brief Kind of structure stored in a binary snapshot
+ */
+enum class SnapshotKind : std::uint16_t {
+    Motherboard = 1,   ///< Snapshot of identy::Motherboard (no drives section)
+    MotherboardEx = 2, ///< Snapshot of identy::MotherboardEx
+};
+
+/**
+ * @brief Identifiers of the sections stored in the binary snapshot field table
+ */
+enum class SnapshotField : std::uint16_t {
+    CpuInfo = 1,                ///< Fixed-size block with CPU registers and flags
+    CpuVendor = 2,              ///< CPU vendor string bytes
+    CpuBrand = 3,               ///< CPU extended brand string bytes
+    CpuHypervisorSignature = 4, ///< Hypervisor signature string bytes
+    SmbiosInfo = 5,             ///< Fixed-size block with SMBIOS versions, UUID and tier
+    SmbiosTables = 6,           ///< Raw SMBIOS table bytes
+    Drives = 7,                 ///< Drive count, record size and fixed-size drive records
+    DriveStrings = 8,           ///< String pool referenced by drive records
+    SmbiosTablesRef = 9,        ///< BlobRef of raw SMBIOS tables kept in a BlobStore instead of SmbiosTables
+};
+
+class BlobStore;
+
+/**
+ * @brief Reference to a blob kept in a BlobStore (SHA-256 digest of its contents)
+ */
+using BlobRef = hs::Hash256;
+
+/**
+ * @brief Zero-copy view of a single drive record inside a binary snapshot
+ *
+ * All string views point directly into the buffer the snapshot was read from
+ * and stay valid only as long as that buffer is alive.
+ */
+struct DriveView
+{
+    /** @brief Drive bus type */
+    PhysicalDriveInfo::BusType bus_type { PhysicalDriveInfo::Other };
+
+    /** @brief Drive device name */
+    std::string_view device_name;
+
+    /** @brief Drive serial number */
+    std::string_view serial;
+
+    /** @brief Drive model ID */
+    std::string_view model_id;
+
+    /** @brief Drive vendor ID */
+    std::string_view vendor_id;
+
+    /** @brief Drive product ID */
+    std::string_view product_id;
+
+    /** @brief Block device paths leading to the drive, see PhysicalDriveInfo::path_count */
+    std::uint32_t path_count { 1 };
+};
+
+/**
+ * @brief Zero-copy reader over an encoded binary snapshot
+ *
+ * Validates the header, field table and every internal reference once when
+ * the reader is created, after which all accessors are cheap and return views
+ * directly into the underlying buffer without allocating.
+ *
+ * @warning The reader does not own the buffer. The buffer must outlive the
+ *          reader and every view obtained from it.
+ *
+ * @see read_binary()
+ */
+class SnapshotReader final
+{
+public:
+    /**
+     * @brief Validates an encoded snapshot and creates a reader over it
+     *
+     * @param buffer Bytes starting at the snapshot header. The buffer may be
+     *               longer than the snapshot (e.g. a concatenated archive)
+     * @return Reader on success, std::nullopt if the data is truncated, has a wrong
+     *         magic, an unsupported version or inconsistent internal references
+     */
+    static std::optional<SnapshotReader> open(std::span<const byte> buffer) noexcept;
+
+    /** @brief Kind of structure stored in the snapshot */
+    SnapshotKind kind() const noexcept;
+
+    /** @brief Format version the snapshot was written with */
+    std::uint16_t version() const noexcept;
+
+    /** @brief Total encoded size of the snapshot in bytes, including padding */
+    std::size_t size() const noexcept;
+
+    /** @brief Bytes of the whole snapshot */
+    std::span<const byte> bytes() const noexcept;
+
+    /** @brief Raw bytes of a field section, empty if the field is absent */
+    std::span<const byte> field(SnapshotField id) const noexcept;
+
+    /** @brief Whether the snapshot contains the given field */
+    bool has_field(SnapshotField id) const noexcept;
+
+    /** @brief CPU vendor string */
+    std::string_view cpu_vendor() const noexcept;
+
+    /** @brief CPU extended brand string */
+    std::string_view cpu_brand() const noexcept;
+
+    /** @brief CPU hypervisor signature */
+    std::string_view cpu_hypervisor_signature() const noexcept;
+
+    /** @brief Raw SMBIOS tables, empty if the tables are stored by reference */
+    std::span<const byte> smbios_tables() const noexcept;
+
+    /** @brief Reference to the SMBIOS tables if they were stored in a BlobStore */
+    std::optional<BlobRef> smbios_tables_ref() const noexcept;
+
+    /** @brief SMBIOS UUID bytes (SMBIOS_uuid_length bytes, zeroed if absent) */
+    std::span<const byte, SMBIOS_uuid_length> smbios_uuid() const noexcept;
+
+    /** @brief Source of the SMBIOS fields, inferred for snapshots written before it was recorded */
+    SmbiosTier smbios_tier() const noexcept;
+
+    /** @brief Number of drive records */
+    std::size_t drive_count() const noexcept;
+
+    /**
+     * @brief Returns a view of a drive record
+     *
+     * @param index Drive index, must be less than drive_count()
+     */
+    DriveView drive(std::size_t index) const noexcept;
+
+    /** @brief Decodes the fixed CPU block and strings into @p cpu */
+    void read_cpu(Cpu& cpu) const;
+
+    /**
+     * @brief Decodes the SMBIOS block and raw tables into @p smbios
+     *
+     * @param smbios Destination structure
+     * @param store Store used to resolve tables written by reference; when
+     *              nullptr or when the blob is missing the tables are left empty
+     */
+    void read_smbios(SMBIOS& smbios, const BlobStore* store = nullptr) const;
+
+    /** @brief Materializes the snapshot as an owning Motherboard */
+    Motherboard to_motherboard(const BlobStore* store = nullptr) const;
+
+    /** @brief Materializes the snapshot as an owning MotherboardEx */
+    MotherboardEx to_motherboard_ex(const BlobStore* store = nullptr) const;
+
+private:
+    static constexpr std::size_t max_field_id = 9;
+
+    struct FieldRange
+    {
+        std::uint32_t offset { 0 };
+        std::uint32_t size { 0 };
+    };
+
+    SnapshotReader() = default;
+
+    const byte* m_data { nullptr };
+    std::uint32_t m_size { 0 };
+    std::uint16_t m_version { 0 };
+    SnapshotKind m_kind { SnapshotKind::Motherboard };
+    std::uint32_t m_drive_count { 0 };
+    std::uint32_t m_drive_record_size { 0 };
+    std::uint32_t m_field_mask { 0 };
+    FieldRange m_fields[max_field_id + 1] {};
+};
+} // namespace identy::io
+
 namespace identy::io
 {
 /**
@@ -63,43 +275,165 @@ void write_text(std::ostream& stream, const Motherboard& mb);
  * @see write_binary() for compact machine-readable format
  */
 void write_text(std::ostream& stream, const MotherboardEx& mb);
+
+/**
+ * @brief Formats basic motherboard information as text into a caller-provided buffer
+ *
+ * Produces exactly the same output as write_text() without touching iostreams,
+ * locales or heap memory. The buffer is never written past its end; when it is
+ * too small the output is truncated and the return value tells how large the
+ * buffer has to be.
+ *
+ * @param buffer Destination buffer (not null-terminated)
+ * @param mb Motherboard structure containing hardware data
+ * @return Size of the complete output in bytes, may exceed buffer.size()
+ */
+std::size_t format_text(std::span<char> buffer, const Motherboard& mb) noexcept;
+
+/**
+ * @brief Formats extended motherboard information as text into a caller-provided buffer
+ *
+ * @param buffer Destination buffer (not null-terminated)
+ * @param mb MotherboardEx structure containing hardware and drive data
+ * @return Size of the complete output in bytes, may exceed buffer.size()
+ *
+ * @see format_text(std::span<char>, const Motherboard&)
+ */
+std::size_t format_text(std::span<char> buffer, const MotherboardEx& mb) noexcept;
+
+/**
+ * @brief Writes basic motherboard information to stream as a single JSON line
+ *
+ * Emits one JSON object terminated by a newline, so consecutive snapshots form
+ * a JSON Lines stream. Strings are escaped per RFC 8259; well-formed UTF-8 is
+ * passed through unchanged, any other byte is written as "\ufffd". CPUID registers and the CPU version are written
+ * as "0x%08x" strings, the SMBIOS UUID in canonical 8-4-4-4-12 form.
+ *
+ * @param stream Output stream to write to (must be in good state)
+ * @param mb Motherboard structure containing hardware data
+ */
+void write_json(std::ostream& stream, const Motherboard& mb);
+
+/**
+ * @brief Writes extended motherboard information to stream as a single JSON line
+ *
+ * Same as the basic variant with an additional "drives" array.
+ *
+ * @param stream Output stream to write to (must be in good state)
+ * @param mb MotherboardEx structure containing hardware and drive data
+ */
+void write_json(std::ostream& stream, const MotherboardEx& mb);
+
+/**
+ * @brief Formats basic motherboard information as a JSON line into a caller-provided buffer
+ *
+ * @param buffer Destination buffer (not null-terminated)
+ * @param mb Motherboard structure containing hardware data
+ * @return Size of the complete output in bytes, may exceed buffer.size()
+ *
+ * @see write_json(), format_text()
+ */
+std::size_t format_json(std::span<char> buffer, const Motherboard& mb) noexcept;
+
+/**
+ * @brief Formats extended motherboard information as a JSON line into a caller-provided buffer
+ *
+ * @param buffer Destination buffer (not null-terminated)
+ * @param mb MotherboardEx structure containing hardware and drive data
+ * @return Size of the complete output in bytes, may exceed buffer.size()
+ */
+std::size_t format_json(std::span<char> buffer, const MotherboardEx& mb) noexcept;
 } // namespace identy::io
 
 namespace identy::io
 {
+/**
+ * @brief Encodes basic motherboard information as a binary snapshot
+ *
+ * Appends the versioned little-endian snapshot to @p out. The snapshot size is
+ * computed up front, so the buffer grows at most once per call.
+ *
+ * @param out Buffer to append the encoded snapshot to
+ * @param mb Motherboard structure containing hardware data
+ * @return Number of bytes appended, 0 if the snapshot would exceed 4 GiB
+ *         (nothing is appended then)
+ *
+ * @see SnapshotReader
+ */
+std::size_t encode_binary(std::vector<byte>& out, const Motherboard& mb);
+
+/**
+ * @brief Encodes extended motherboard information as a binary snapshot
+ *
+ * @param out Buffer to append the encoded snapshot to
+ * @param mb MotherboardEx structure containing hardware and drive data
+ * @return Number of bytes appended, 0 if the snapshot would exceed 4 GiB
+ *
+ * @see SnapshotReader
+ */
+std::size_t encode_binary(std::vector<byte>& out, const MotherboardEx& mb);
+
+/**
+ * @brief Encodes a snapshot storing the SMBIOS tables in a BlobStore
+ *
+ * The raw tables are put into @p store (deduplicated by content) and the
+ * snapshot carries only the 32-byte BlobRef in place of the tables.
+ *
+ * @param out Buffer to append the encoded snapshot to
+ * @param mb MotherboardEx structure containing hardware and drive data
+ * @param store Blob store receiving the SMBIOS tables
+ * @return Number of bytes appended, 0 if the tables could not be stored or the
+ *         snapshot would exceed 4 GiB
+ */
+std::size_t encode_binary(std::vector<byte>& out, const MotherboardEx& mb, BlobStore& store);
+
 /**
  * @brief Writes basic motherboard information in compact binary format
  *
- * Serializes CPU and SMBIOS data to the output stream as a compact binary
- * representation suitable for efficient storage or network transmission.
+ * Encodes CPU and SMBIOS data into a single contiguous buffer and writes it
+ * to the stream with one write call. See the file documentation for the layout.
  *
  * @param stream Output stream to write to (must be in good state and binary mode)
  * @param mb Motherboard structure containing hardware data
  *
+ * Sets failbit on @p stream and writes nothing when the snapshot cannot be
+ * encoded (see encode_binary()).
+ *
  * @warning Stream must be opened in binary mode (std::ios::binary) to prevent
  *          line-ending translation corrupting the data
  *
- * @note No deserialization function is currently provided. Use for archival
- *       or transmission where you control both ends of the data flow.
+ * @see read_binary() for deserialization
  */
 void write_binary(std::ostream& stream, const Motherboard& mb);
 
 /**
  * @brief Writes extended motherboard information in compact binary format
  *
- * Serializes CPU, SMBIOS, and drive data to the output stream as a compact binary
- * representation suitable for efficient storage or network transmission.
+ * Encodes CPU, SMBIOS and drive data into a single contiguous buffer and
+ * writes it to the stream with one write call.
  *
  * @param stream Output stream to write to (must be in good state and binary mode)
  * @param mb MotherboardEx structure containing hardware and drive data
  *
+ * Sets failbit on @p stream and writes nothing when the snapshot cannot be
+ * encoded (see encode_binary()).
+ *
  * @warning Stream must be opened in binary mode (std::ios::binary) to prevent
  *          line-ending translation corrupting the data
  *
- * @note No deserialization function is currently provided. Use for archival
- *       or transmission where you control both ends of the data flow.
+ * @see read_binary() for deserialization
  */
 void write_binary(std::ostream& stream, const MotherboardEx& mb);
+
+/**
+ * @brief Opens a binary snapshot for zero-copy reading
+ *
+ * Shorthand for SnapshotReader::open().
+ *
+ * @param buffer Bytes starting at the snapshot header
+ * @return Reader over the snapshot, std::nullopt if the data is malformed
+ */
+std::optional<SnapshotReader> read_binary(std::span<const byte> buffer) noexcept;
 } // namespace identy::io
 
 namespace identy::io
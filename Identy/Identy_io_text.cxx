@@ -0,0 +1,518 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_io.hxx"
+
+#include "Identy_hwid.hxx"
+#include "Identy_strings.hxx"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IDENTY_IO_SSE2 1
+#endif
+
+namespace
+{
+constexpr char hex_digits[] = "0123456789abcdef";
+
+// Size of the on-stack buffer used by the stream writers; larger outputs
+// fall back to a single heap allocation
+constexpr std::size_t stack_buffer_size = 2048;
+
+/**
+ * Appends into a caller-provided buffer without ever writing past its end.
+ * Keeps counting once the buffer is full so the caller learns the size
+ * required for the complete output.
+ */
+class BufferWriter
+{
+public:
+    explicit BufferWriter(std::span<char> buffer) noexcept
+        : m_data(buffer.data())
+        , m_capacity(buffer.size())
+    {
+    }
+
+    std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    void put(char c) noexcept
+    {
+        if(m_size < m_capacity) {
+            m_data[m_size] = c;
+        }
+        ++m_size;
+    }
+
+    void append(std::string_view text) noexcept
+    {
+        if(m_size < m_capacity) {
+            std::memcpy(m_data + m_size, text.data(), std::min(text.size(), m_capacity - m_size));
+        }
+        m_size += text.size();
+    }
+
+    void append_unsigned(std::uint64_t value) noexcept
+    {
+        char digits[20];
+        std::size_t count = 0;
+
+        do {
+            digits[sizeof(digits) - ++count] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while(value != 0);
+
+        append({ digits + sizeof(digits) - count, count });
+    }
+
+    void append_signed(std::int64_t value) noexcept
+    {
+        if(value < 0) {
+            put('-');
+            append_unsigned(0 - static_cast<std::uint64_t>(value));
+            return;
+        }
+
+        append_unsigned(static_cast<std::uint64_t>(value));
+    }
+
+    void append_hex_byte(std::uint8_t value) noexcept
+    {
+        char digits[2] = { hex_digits[value >> 4], hex_digits[value & 0x0F] };
+        append({ digits, sizeof(digits) });
+    }
+
+    void append_hex32(std::uint32_t value) noexcept
+    {
+        char digits[10] = { '0', 'x' };
+        for(std::size_t i = 0; i < 8; ++i) {
+            digits[2 + i] = hex_digits[(value >> (28 - i * 4)) & 0x0F];
+        }
+        append({ digits, sizeof(digits) });
+    }
+
+    // Skips control and non-ASCII bytes, e.g. the binary header of a raw VPD serial
+    void append_printable(std::string_view text) noexcept
+    {
+        while(!text.empty()) {
+            auto run = identy::strings::printable_prefix(text);
+            append(text.substr(0, run));
+            text.remove_prefix(std::min(run + 1, text.size()));
+        }
+    }
+
+    void append_bool(bool value) noexcept
+    {
+        append(value ? "true" : "false");
+    }
+
+    void append_uuid(const identy::byte (&uuid)[identy::SMBIOS_uuid_length]) noexcept
+    {
+        for(std::size_t i = 0; i < identy::SMBIOS_uuid_length; ++i) {
+            if(i == 4 || i == 6 || i == 8 || i == 10) {
+                put('-');
+            }
+            append_hex_byte(uuid[i]);
+        }
+    }
+
+    void append_json_string(std::string_view text) noexcept;
+
+private:
+    char* m_data;
+    std::size_t m_capacity;
+    std::size_t m_size { 0 };
+};
+
+constexpr bool needs_json_escape(unsigned char c) noexcept
+{
+    return c < 0x20 || c == '"' || c == '\\' || c >= 0x80;
+}
+
+constexpr bool is_continuation(unsigned char c) noexcept
+{
+    return (c & 0xC0) == 0x80;
+}
+
+// Length of the well-formed UTF-8 sequence at the start of @p text, 0 if the
+// bytes are not UTF-8 (stray continuation, overlong form, surrogate, > U+10FFFF)
+std::size_t utf8_sequence_length(std::string_view text) noexcept
+{
+    auto at = [text](std::size_t i) { return i < text.size() ? static_cast<unsigned char>(text[i]) : 0u; };
+
+    auto lead = at(0);
+    auto second = at(1);
+
+    if(lead >= 0xC2 && lead <= 0xDF) {
+        return is_continuation(second) ? 2 : 0;
+    }
+
+    if(lead >= 0xE0 && lead <= 0xEF) {
+        auto low = lead == 0xE0 ? 0xA0u : 0x80u;
+        auto high = lead == 0xED ? 0x9Fu : 0xBFu;
+        return second >= low && second <= high && is_continuation(at(2)) ? 3 : 0;
+    }
+
+    if(lead >= 0xF0 && lead <= 0xF4) {
+        auto low = lead == 0xF0 ? 0x90u : 0x80u;
+        auto high = lead == 0xF4 ? 0x8Fu : 0xBFu;
+        return second >= low && second <= high && is_continuation(at(2)) && is_continuation(at(3)) ? 4 : 0;
+    }
+
+    return 0;
+}
+
+// Length of the leading run of ASCII characters that can be copied verbatim
+std::size_t json_safe_prefix(std::string_view text) noexcept
+{
+    std::size_t i = 0;
+
+#ifdef IDENTY_IO_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control_limit = _mm_set1_epi8(0x1F);
+
+    for(; i + 16 <= text.size(); i += 16) {
+        auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i));
+
+        // unsigned c <= 0x1F  <=>  min(c, 0x1F) == c
+        auto control = _mm_cmpeq_epi8(_mm_min_epu8(chunk, control_limit), chunk);
+        auto special = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash));
+
+        // the sign bit of every byte >= 0x80 lands in the mask directly
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(control, special), chunk)));
+
+        if(mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+#endif
+
+    for(; i < text.size(); ++i) {
+        if(needs_json_escape(static_cast<unsigned char>(text[i]))) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+void BufferWriter::append_json_string(std::string_view text) noexcept
+{
+    put('"');
+
+    while(!text.empty()) {
+        auto safe = json_safe_prefix(text);
+        append(text.substr(0, safe));
+
+        if(safe == text.size()) {
+            break;
+        }
+
+        auto c = static_cast<unsigned char>(text[safe]);
+
+        if(c >= 0x80) {
+            // serials may come from raw binary pages: keep valid UTF-8, replace
+            // every other byte with U+FFFD so the output stays parseable
+            auto length = utf8_sequence_length(text.substr(safe));
+            if(length != 0) {
+                append(text.substr(safe, length));
+                text.remove_prefix(safe + length);
+            }
+            else {
+                append("\\ufffd");
+                text.remove_prefix(safe + 1);
+            }
+            continue;
+        }
+
+        switch(c) {
+            case '"':
+                append("\\\"");
+                break;
+            case '\\':
+                append("\\\\");
+                break;
+            case '\n':
+                append("\\n");
+                break;
+            case '\r':
+                append("\\r");
+                break;
+            case '\t':
+                append("\\t");
+                break;
+            default:
+                append("\\u00");
+                append_hex_byte(c);
+                break;
+        }
+
+        text.remove_prefix(safe + 1);
+    }
+
+    put('"');
+}
+
+std::string_view bus_type_text(identy::PhysicalDriveInfo::BusType bus) noexcept
+{
+    switch(bus) {
+        case identy::PhysicalDriveInfo::SATA:
+            return "SATA";
+        case identy::PhysicalDriveInfo::NMVe:
+            return "NVMe";
+        case identy::PhysicalDriveInfo::USB:
+            return "USB";
+        default:
+            return "Unknown";
+    }
+}
+
+std::string_view bus_type_json(identy::PhysicalDriveInfo::BusType bus) noexcept
+{
+    switch(bus) {
+        case identy::PhysicalDriveInfo::SATA:
+            return "sata";
+        case identy::PhysicalDriveInfo::NMVe:
+            return "nvme";
+        case identy::PhysicalDriveInfo::USB:
+            return "usb";
+        case identy::PhysicalDriveInfo::Virtual:
+            return "virtual";
+        case identy::PhysicalDriveInfo::Scsi:
+            return "scsi";
+        case identy::PhysicalDriveInfo::ATA:
+            return "ata";
+        case identy::PhysicalDriveInfo::SAS:
+            return "sas";
+        default:
+            return "other";
+    }
+}
+
+std::string_view smbios_tier_json(identy::SmbiosTier tier) noexcept
+{
+    switch(tier) {
+        case identy::SmbiosTier::Attributes:
+            return "attributes";
+        case identy::SmbiosTier::Daemon:
+            return "daemon";
+        case identy::SmbiosTier::Table:
+            return "table";
+        default:
+            return "none";
+    }
+}
+
+template<typename MB>
+void format_text_common(BufferWriter& out, const MB& mb) noexcept
+{
+    out.append("CPU:\n");
+    out.append(mb.cpu.extended_brand_string);
+    out.append(" Vendor: ");
+    out.append(mb.cpu.vendor);
+    out.append("\n Cores: ");
+    out.append_signed(mb.cpu.logical_processors_count);
+    out.append("\n Hypervisor present: ");
+    out.append_bool(mb.cpu.hypervisor_bit);
+    out.append("\n Hypervisor signature (if presented) ");
+    out.append(mb.cpu.hypervisor_signature);
+
+    out.append("\nMotherboard:\n SMBIOS UUID: ");
+    out.append_uuid(mb.smbios.uuid);
+
+    out.append("\n SMBIOS Ver: ");
+    out.append_unsigned(mb.smbios.major_version);
+    out.put('.');
+    out.append_unsigned(mb.smbios.minor_version);
+
+    out.append("\n SMBIOS DMI Ver: ");
+    out.append_unsigned(mb.smbios.dmi_version);
+
+    out.append("\n SMBIOS 2.0 calling convention: ");
+    out.append_bool(mb.smbios.is_20_calling_used);
+    out.put('\n');
+}
+
+void format_text_drives(BufferWriter& out, const std::vector<identy::PhysicalDriveInfo>& drives) noexcept
+{
+    out.append("Physical Drives:\n");
+    if(drives.empty()) {
+        out.append(" No drives detected or insufficient permissions\n");
+        return;
+    }
+
+    for(std::size_t i = 0; i < drives.size(); ++i) {
+        const auto& drive = drives[i];
+
+        out.append(" Drive ");
+        out.append_unsigned(i + 1);
+        out.append("\n  Device: ");
+        out.append(drive.device_name);
+        out.append("\n  Serial: ");
+        out.append_printable(drive.serial);
+        out.append("\n  Bus Type: ");
+        out.append(bus_type_text(drive.bus_type));
+        if(drive.path_count > 1) {
+            out.append("\n  Paths: ");
+            out.append_unsigned(drive.path_count);
+        }
+        out.put('\n');
+    }
+}
+
+template<typename MB>
+void format_json_common(BufferWriter& out, const MB& mb) noexcept
+{
+    const auto& cpu = mb.cpu;
+
+    out.append("{\"cpu\":{\"vendor\":");
+    out.append_json_string(cpu.vendor);
+    out.append(",\"brand\":");
+    out.append_json_string(cpu.extended_brand_string);
+    out.append(",\"version\":\"");
+    out.append_hex32(static_cast<std::uint32_t>(cpu.version));
+    out.put('"');
+    out.append(",\"logical_processors\":");
+    out.append_signed(cpu.logical_processors_count);
+    out.append(",\"apic_id\":");
+    out.append_unsigned(cpu.apic_id);
+    out.append(",\"brand_index\":");
+    out.append_unsigned(cpu.brand_index);
+    out.append(",\"clflush_line_size\":");
+    out.append_unsigned(cpu.clflush_line_size);
+    out.append(",\"hypervisor\":");
+    out.append_bool(cpu.hypervisor_bit);
+    out.append(",\"hypervisor_signature\":");
+    out.append_json_string(cpu.hypervisor_signature);
+    out.append(",\"too_old\":");
+    out.append_bool(cpu.too_old);
+    out.append(",\"instruction_set\":[\"");
+    out.append_hex32(static_cast<std::uint32_t>(cpu.instruction_set.basic));
+    out.append("\",\"");
+    out.append_hex32(static_cast<std::uint32_t>(cpu.instruction_set.modern));
+    for(auto reg : cpu.instruction_set.extended_modern) {
+        out.append("\",\"");
+        out.append_hex32(static_cast<std::uint32_t>(reg));
+    }
+    out.append("\"]}");
+
+    const auto& smbios = mb.smbios;
+
+    out.append(",\"smbios\":{\"uuid\":\"");
+    out.append_uuid(smbios.uuid);
+    out.append("\",\"version\":\"");
+    out.append_unsigned(smbios.major_version);
+    out.put('.');
+    out.append_unsigned(smbios.minor_version);
+    out.append("\",\"dmi_version\":");
+    out.append_unsigned(smbios.dmi_version);
+    out.append(",\"calling_convention_20\":");
+    out.append_bool(smbios.is_20_calling_used);
+    out.append(",\"tables_size\":");
+    out.append_unsigned(smbios.raw_tables_data.size());
+    out.append(",\"tier\":\"");
+    out.append(smbios_tier_json(smbios.tier));
+    out.append("\"}");
+}
+
+void format_json_drives(BufferWriter& out, const std::vector<identy::PhysicalDriveInfo>& drives) noexcept
+{
+    out.append(",\"drives\":[");
+
+    for(std::size_t i = 0; i < drives.size(); ++i) {
+        const auto& drive = drives[i];
+
+        out.append(i == 0 ? "{\"device\":" : ",{\"device\":");
+        out.append_json_string(drive.device_name);
+        out.append(",\"bus\":\"");
+        out.append(bus_type_json(drive.bus_type));
+        out.append("\",\"serial\":");
+        out.append_json_string(drive.serial);
+        out.append(",\"model\":");
+        out.append_json_string(drive.model_id);
+        out.append(",\"vendor\":");
+        out.append_json_string(drive.vendor_id);
+        out.append(",\"product\":");
+        out.append_json_string(drive.product_id);
+        out.append(",\"paths\":");
+        out.append_unsigned(drive.path_count);
+        out.put('}');
+    }
+
+    out.put(']');
+}
+
+template<typename Format>
+void write_formatted(std::ostream& stream, Format&& format)
+{
+    if(!stream.good()) {
+        return;
+    }
+
+    char local[stack_buffer_size];
+    auto size = format(std::span<char>(local));
+
+    if(size <= sizeof(local)) {
+        stream.write(local, static_cast<std::streamsize>(size));
+        return;
+    }
+
+    std::string heap(size, '\0');
+    format(std::span<char>(heap));
+    stream.write(heap.data(), static_cast<std::streamsize>(size));
+}
+} // namespace
+
+std::size_t identy::io::format_text(std::span<char> buffer, const Motherboard& mb) noexcept
+{
+    BufferWriter out(buffer);
+    format_text_common(out, mb);
+    return out.size();
+}
+
+std::size_t identy::io::format_text(std::span<char> buffer, const MotherboardEx& mb) noexcept
+{
+    BufferWriter out(buffer);
+    format_text_common(out, mb);
+    format_text_drives(out, mb.drives);
+    return out.size();
+}
+
+std::size_t identy::io::format_json(std::span<char> buffer, const Motherboard& mb) noexcept
+{
+    BufferWriter out(buffer);
+    format_json_common(out, mb);
+    out.append("}\n");
+    return out.size();
+}
+
+std::size_t identy::io::format_json(std::span<char> buffer, const MotherboardEx& mb) noexcept
+{
+    BufferWriter out(buffer);
+    format_json_common(out, mb);
+    format_json_drives(out, mb.drives);
+    out.append("}\n");
+    return out.size();
+}
+
+void identy::io::write_text(std::ostream& stream, const Motherboard& mb)
+{
+    write_formatted(stream, [&](std::span<char> buffer) { return format_text(buffer, mb); });
+}
+
+void identy::io::write_text(std::ostream& stream, const MotherboardEx& mb)
+{
+    write_formatted(stream, [&](std::span<char> buffer) { return format_text(buffer, mb); });
+}
+
+void identy::io::write_json(std::ostream& stream, const Motherboard& mb)
+{
+    write_formatted(stream, [&](std::span<char> buffer) { return format_json(buffer, mb); });
+}
+
+void identy::io::write_json(std::ostream& stream, const MotherboardEx& mb)
+{
+    write_formatted(stream, [&](std::span<char> buffer) { return format_json(buffer, mb); });
+}
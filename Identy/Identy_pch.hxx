@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <cassert>
 #include <charconv>
 #include <concepts>
@@ -14,6 +15,7 @@
 #include <format>
 #include <fstream>
 #include <iomanip>
+#include <limits>
 #include <optional>
 #include <ranges>
 #include <span>
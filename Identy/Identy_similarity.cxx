@@ -0,0 +1,362 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_similarity.hxx"
+
+#include <cmath>
+
+#include "detail/Identy_walk.hxx"
+
+namespace
+{
+using identy::detail::Digest;
+using identy::detail::mix;
+using identy::similarity::signature_length;
+
+enum class ComponentKind : std::uint64_t {
+    CpuIdentity = 1,
+    CpuFeatures,
+    Uuid,
+    SmbiosStructure,
+    Drive,
+    SmbiosPlatform
+};
+
+constexpr std::uint64_t multiplier = 0xBF58476D1CE4E5B9ull;
+
+/** Multiply-shift hash functions h_i(d) = (a_i * d + b_i) >> 32 with odd a_i */
+struct Permutations
+{
+    std::array<std::uint64_t, signature_length> a {};
+    std::array<std::uint64_t, signature_length> b {};
+};
+
+constexpr Permutations make_permutations() noexcept
+{
+    Permutations permutations;
+    for(std::size_t i = 0; i < signature_length; ++i) {
+        permutations.a[i] = mix(0x5157'4D48'0000'0000ull + i) | 1;
+        permutations.b[i] = mix(0x5157'4D48'8000'0000ull + i);
+    }
+    return permutations;
+}
+
+constexpr Permutations permutations = make_permutations();
+
+/** Digest of one component, keyed by its kind */
+Digest component_digest(ComponentKind kind) noexcept
+{
+    return Digest(static_cast<std::uint64_t>(kind));
+}
+
+/**
+ * Structures that carry a per-unit serial number or UUID: system, baseboard,
+ * chassis, memory device, portable battery and power supply. All other
+ * types describe the model and are the same on every machine of it.
+ */
+bool is_unit_structure(identy::byte type) noexcept
+{
+    switch(type) {
+        case 1:
+        case 2:
+        case 3:
+        case 17:
+        case 22:
+        case 39:
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::uint8_t sketch_byte(std::uint32_t value) noexcept
+{
+    return static_cast<std::uint8_t>(value);
+}
+} // namespace
+
+std::size_t identy::similarity::component_digests(const MotherboardEx& mb, std::vector<std::uint64_t>& out)
+{
+    auto before = out.size();
+
+    auto identity = component_digest(ComponentKind::CpuIdentity);
+    identity.update(std::string_view(mb.cpu.vendor));
+    identity.update(std::string_view(mb.cpu.extended_brand_string));
+    identity.update(std::string_view(mb.cpu.hypervisor_signature));
+    identity.update(static_cast<std::uint64_t>(mb.cpu.version));
+    out.push_back(identity.finish());
+
+    const auto& features = mb.cpu.instruction_set;
+    auto feature_digest = component_digest(ComponentKind::CpuFeatures);
+    feature_digest.update(static_cast<std::uint64_t>(features.basic) << 32 | features.modern);
+    feature_digest.update(static_cast<std::uint64_t>(features.extended_modern[0]) << 32 | features.extended_modern[1]);
+    feature_digest.update(static_cast<std::uint64_t>(features.extended_modern[2]));
+    out.push_back(feature_digest.finish());
+
+    // model structures count once together, or two machines of one model
+    // would agree on most of their components
+    auto platform = component_digest(ComponentKind::SmbiosPlatform);
+    bool has_platform = false;
+    bool has_system = false;
+
+    detail::for_each_structure(mb.smbios.raw_tables_data, [&](std::span<const byte> structure) {
+        if(is_unit_structure(structure[0])) {
+            out.push_back(component_digest(ComponentKind::SmbiosStructure).update(structure).finish());
+            has_system = has_system || structure[0] == 1;
+        }
+        else {
+            platform.update(structure);
+            has_platform = true;
+        }
+    });
+
+    if(has_platform) {
+        out.push_back(platform.finish());
+    }
+
+    // the system structure already holds the UUID
+    if(!has_system) {
+        auto uuid = component_digest(ComponentKind::Uuid);
+        uuid.update(std::span<const byte>(mb.smbios.uuid));
+        out.push_back(uuid.finish());
+    }
+
+    for(const auto& drive : mb.drives) {
+        auto digest = component_digest(ComponentKind::Drive);
+        digest.update(std::string_view(drive.serial));
+        digest.update(std::string_view(drive.model_id));
+        out.push_back(digest.finish());
+    }
+
+    return out.size() - before;
+}
+
+identy::similarity::Signature identy::similarity::sign(std::span<const std::uint64_t> digests) noexcept
+{
+    Signature signature;
+    signature.values.fill(std::numeric_limits<std::uint32_t>::max());
+
+    for(auto digest : digests) {
+        for(std::size_t i = 0; i < signature_length; ++i) {
+            auto value = static_cast<std::uint32_t>((permutations.a[i] * digest + permutations.b[i]) >> 32);
+            signature.values[i] = std::min(signature.values[i], value);
+        }
+    }
+
+    return signature;
+}
+
+identy::similarity::Signature identy::similarity::sign(const MotherboardEx& mb)
+{
+    std::vector<std::uint64_t> digests;
+    digests.reserve(64);
+    component_digests(mb, digests);
+
+    return sign(digests);
+}
+
+std::vector<identy::similarity::Signature> identy::similarity::sign_batch(std::span<const MotherboardEx> boards, exec::ExecutorRef executor)
+{
+    std::vector<Signature> signatures(boards.size());
+
+    exec::parallel_for(
+        boards.size(),
+        [&boards, &signatures](std::size_t begin, std::size_t end) {
+            std::vector<std::uint64_t> digests;
+            for(auto i = begin; i < end; ++i) {
+                digests.clear();
+                component_digests(boards[i], digests);
+                signatures[i] = sign(digests);
+            }
+        },
+        executor);
+
+    return signatures;
+}
+
+double identy::similarity::estimate(const Signature& lhs, const Signature& rhs) noexcept
+{
+    std::size_t equal = 0;
+    for(std::size_t i = 0; i < signature_length; ++i) {
+        equal += lhs.values[i] == rhs.values[i] ? 1 : 0;
+    }
+
+    return static_cast<double>(equal) / static_cast<double>(signature_length);
+}
+
+identy::similarity::Index::Index(const IndexOptions& options)
+    : m_options(options)
+{
+    m_options.rows = std::clamp<std::size_t>(m_options.rows, 1, signature_length);
+    m_options.bands = std::clamp<std::size_t>(m_options.bands, 1, signature_length / m_options.rows);
+
+    m_bands.resize(m_options.bands);
+}
+
+std::uint32_t identy::similarity::Index::band_key(const Signature& signature, std::size_t band) const noexcept
+{
+    auto key = mix(band);
+    for(std::size_t row = 0; row < m_options.rows; ++row) {
+        key = std::rotl((key ^ signature.values[band * m_options.rows + row]) * multiplier, 31);
+    }
+
+    return static_cast<std::uint32_t>(mix(key) >> 32);
+}
+
+void identy::similarity::Index::grow(Band& band, std::size_t capacity)
+{
+    std::vector<std::uint32_t> keys(capacity);
+    std::vector<std::uint32_t> heads(capacity, no_record);
+    auto mask = capacity - 1;
+
+    for(std::size_t i = 0; i < band.heads.size(); ++i) {
+        if(band.heads[i] == no_record) {
+            continue;
+        }
+
+        auto slot = band.keys[i] & mask;
+        while(heads[slot] != no_record) {
+            slot = (slot + 1) & mask;
+        }
+
+        keys[slot] = band.keys[i];
+        heads[slot] = band.heads[i];
+    }
+
+    band.keys = std::move(keys);
+    band.heads = std::move(heads);
+}
+
+void identy::similarity::Index::reserve(std::size_t records)
+{
+    auto capacity = std::bit_ceil(std::max<std::size_t>(records / 3 * 4 + 4, 16));
+
+    for(auto& band : m_bands) {
+        if(band.heads.size() < capacity) {
+            grow(band, capacity);
+        }
+        band.next.reserve(records);
+    }
+    m_sketches.reserve(records);
+}
+
+std::uint32_t identy::similarity::Index::insert(const Signature& signature)
+{
+    assert(m_sketches.size() < max_records);
+    auto id = static_cast<std::uint32_t>(m_sketches.size());
+
+    for(std::size_t b = 0; b < m_bands.size(); ++b) {
+        auto& band = m_bands[b];
+
+        // load factor at most 3/4
+        if((band.used + 1) * 4 > band.heads.size() * 3) {
+            grow(band, std::max<std::size_t>(band.heads.size() * 2, 16));
+        }
+
+        auto key = band_key(signature, b);
+        auto mask = band.heads.size() - 1;
+        auto slot = key & mask;
+
+        while(band.heads[slot] != no_record && band.keys[slot] != key) {
+            slot = (slot + 1) & mask;
+        }
+
+        if(band.heads[slot] == no_record) {
+            band.keys[slot] = key;
+            ++band.used;
+        }
+
+        band.next.push_back(band.heads[slot]);
+        band.heads[slot] = id;
+    }
+
+    auto& sketch = m_sketches.emplace_back();
+    for(std::size_t i = 0; i < signature_length; ++i) {
+        sketch[i] = sketch_byte(signature.values[i]);
+    }
+
+    return id;
+}
+
+std::vector<identy::similarity::Match> identy::similarity::Index::query(const Signature& signature, double min_similarity,
+    std::size_t limit) const
+{
+    std::vector<std::uint32_t> candidates;
+
+    for(std::size_t b = 0; b < m_bands.size(); ++b) {
+        const auto& band = m_bands[b];
+        if(band.heads.empty()) {
+            continue;
+        }
+
+        auto key = band_key(signature, b);
+        auto mask = band.heads.size() - 1;
+        auto slot = key & mask;
+
+        while(band.heads[slot] != no_record && band.keys[slot] != key) {
+            slot = (slot + 1) & mask;
+        }
+
+        for(auto id = band.heads[slot]; id != no_record; id = band.next[id]) {
+            candidates.push_back(id);
+        }
+    }
+
+    std::ranges::sort(candidates);
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::array<std::uint8_t, signature_length> sketch;
+    for(std::size_t i = 0; i < signature_length; ++i) {
+        sketch[i] = sketch_byte(signature.values[i]);
+    }
+
+    // one-byte values also agree for 1/256 of the differing positions
+    constexpr double chance = 1.0 / 256.0;
+
+    std::vector<Match> matches;
+    for(auto id : candidates) {
+        const auto& stored = m_sketches[id];
+
+        std::size_t equal = 0;
+        for(std::size_t i = 0; i < signature_length; ++i) {
+            equal += stored[i] == sketch[i] ? 1 : 0;
+        }
+
+        auto observed = static_cast<double>(equal) / static_cast<double>(signature_length);
+        auto similarity = std::clamp((observed - chance) / (1.0 - chance), 0.0, 1.0);
+
+        if(similarity >= min_similarity) {
+            matches.push_back({ id, similarity });
+        }
+    }
+
+    std::ranges::sort(matches, [](const Match& lhs, const Match& rhs) {
+        return lhs.similarity != rhs.similarity ? lhs.similarity > rhs.similarity : lhs.id < rhs.id;
+    });
+
+    if(matches.size() > limit) {
+        matches.resize(limit);
+    }
+
+    return matches;
+}
+
+double identy::similarity::Index::candidate_probability(double similarity) const noexcept
+{
+    auto s = std::clamp(similarity, 0.0, 1.0);
+    auto band_hit = std::pow(s, static_cast<double>(m_options.rows));
+
+    return 1.0 - std::pow(1.0 - band_hit, static_cast<double>(m_options.bands));
+}
+
+std::size_t identy::similarity::Index::memory_bytes() const noexcept
+{
+    std::size_t bytes = m_bands.capacity() * sizeof(Band) + m_sketches.capacity() * sizeof(m_sketches[0]);
+
+    for(const auto& band : m_bands) {
+        bytes += band.keys.capacity() * sizeof(std::uint32_t);
+        bytes += band.heads.capacity() * sizeof(std::uint32_t);
+        bytes += band.next.capacity() * sizeof(std::uint32_t);
+    }
+
+    return bytes;
+}
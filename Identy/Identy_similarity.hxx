@@ -0,0 +1,210 @@
+/**
+ * @file Identy_similarity.hxx
+ * @brief Near-duplicate search over hardware snapshots (MinHash and LSH)
+ *
+ * hs::hash() changes completely when a single drive serial or the SMBIOS
+ * UUID changes, so it cannot find cloned machines that differ in one or two
+ * components. This module treats a snapshot as a set of component digests:
+ *
+ * - the CPU identity (vendor, brand string, version, hypervisor signature)
+ * - the CPU feature registers
+ * - every raw SMBIOS structure that carries a unit serial or UUID (system,
+ *   baseboard, chassis, memory device, battery, power supply)
+ * - all other raw SMBIOS structures together, as one component
+ * - the SMBIOS UUID, when the tables hold no system structure
+ * - every drive (serial and model)
+ *
+ * sign() condenses the set into a MinHash signature. The fraction of equal
+ * signature values estimates the Jaccard similarity of two sets: two
+ * snapshots of n components each that share k of them have similarity
+ * k / (2n - k).
+ *
+ * Index stores signatures in banded LSH tables. A query looks up one table
+ * per band and only compares the records colliding in at least one band, so
+ * its cost depends on the number of near duplicates, not on the index size:
+ *
+ * @code
+ * identy::similarity::Index index;
+ * for(const auto& mb : fleet) {
+ *     ids.push_back(index.insert(identy::similarity::sign(mb)));
+ * }
+ *
+ * for(const auto& match : index.query(identy::similarity::sign(suspect), 0.85)) {
+ *     report(ids[match.id], match.similarity);
+ * }
+ * @endcode
+ *
+ * Machines of the same model share their static SMBIOS structures (BIOS,
+ * caches, slots, ...). Counted one by one, they would lift unrelated
+ * machines of one model to a similarity of 0.5-0.7 and make every query walk
+ * the whole model; counted as one component, such machines score below 0.3,
+ * while clones differing in a UUID or a drive still score above 0.8.
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_SIMILARITY_H
+#define UNC_IDENTY_SIMILARITY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "Identy_executor.hxx"
+#include "Identy_hwid.hxx"
+
+namespace identy::similarity
+{
+/** @brief Number of MinHash values in a signature */
+inline constexpr std::size_t signature_length = 64;
+
+/**
+ * @brief MinHash signature of a component set
+ *
+ * Value i is the minimum of the i-th hash function over all component
+ * digests. An empty set has every value at its maximum.
+ */
+struct Signature
+{
+    std::array<std::uint32_t, signature_length> values {};
+
+    bool operator==(const Signature&) const = default;
+};
+
+/**
+ * @brief Appends the 64-bit digests of the components of @p mb to @p out
+ *
+ * Digests of different component kinds never collide by construction
+ * (each kind is hashed with its own seed).
+ *
+ * @return Number of digests appended
+ */
+std::size_t component_digests(const MotherboardEx& mb, std::vector<std::uint64_t>& out);
+
+/** @brief MinHash signature of a set of component digests; duplicates are ignored */
+Signature sign(std::span<const std::uint64_t> digests) noexcept;
+
+/** @brief MinHash signature of the components of @p mb */
+Signature sign(const MotherboardEx& mb);
+
+/**
+ * @brief Signs many snapshots in parallel
+ * @return Signatures in input order
+ */
+std::vector<Signature> sign_batch(std::span<const MotherboardEx> boards, exec::ExecutorRef executor = exec::default_executor());
+
+/** @brief Estimated Jaccard similarity of the sets behind two signatures, in [0, 1] */
+double estimate(const Signature& lhs, const Signature& rhs) noexcept;
+
+/**
+ * @brief Banding of an Index
+ *
+ * A record becomes a candidate when all @p rows values of at least one of
+ * the @p bands bands equal the query's. bands * rows must not exceed
+ * signature_length; more bands raise recall at lower similarities and cost
+ * memory, more rows cut candidates below the threshold.
+ */
+struct IndexOptions
+{
+    std::size_t bands { 16 };
+    std::size_t rows { 4 };
+};
+
+/**
+ * @brief Record found by Index::query()
+ */
+struct Match
+{
+    /** @brief Value Index::insert() returned for the record */
+    std::uint32_t id { 0 };
+
+    /** @brief Estimated similarity to the query */
+    double similarity { 0 };
+};
+
+/**
+ * @brief LSH index of MinHash signatures
+ *
+ * Every band is an open-addressing table from a 32-bit hash of the band's
+ * values to a chain of records, 15 to 25 bytes per record and band. Besides the chains, a record keeps one byte of
+ * each signature value (64 bytes) to estimate its similarity to a query;
+ * one-byte values agree by chance with probability 1/256, which query()
+ * corrects for.
+ *
+ * insert() requires exclusive access; const members may run concurrently.
+ */
+class Index final
+{
+public:
+    /** @brief Record identifiers are 32-bit: at most this many records */
+    static constexpr std::size_t max_records = std::numeric_limits<std::uint32_t>::max() - 1;
+
+    /** @param options Banding; clamped to bands * rows <= signature_length and at least one of each */
+    explicit Index(const IndexOptions& options = {});
+
+    /**
+     * @brief Adds a record
+     * @return Identifier of the record: the number of records inserted before
+     */
+    std::uint32_t insert(const Signature& signature);
+
+    /** @brief Preallocates tables for @p records records */
+    void reserve(std::size_t records);
+
+    /**
+     * @brief Records whose estimated similarity to @p signature is at least @p min_similarity
+     *
+     * Only records colliding in at least one band are considered, see
+     * candidate_probability(). Results are ordered by descending similarity,
+     * then by identifier.
+     *
+     * @param limit Maximum number of matches returned
+     */
+    std::vector<Match> query(const Signature& signature, double min_similarity,
+        std::size_t limit = std::numeric_limits<std::size_t>::max()) const;
+
+    /**
+     * @brief Probability that a record of the given similarity becomes a candidate
+     *
+     * 1 - (1 - s^rows)^bands: the recall of query() for records of
+     * similarity @p similarity when the threshold is below it.
+     */
+    double candidate_probability(double similarity) const noexcept;
+
+    std::size_t size() const noexcept
+    {
+        return m_sketches.size();
+    }
+
+    /** @brief Heap memory held by the index */
+    std::size_t memory_bytes() const noexcept;
+
+    const IndexOptions& options() const noexcept
+    {
+        return m_options;
+    }
+
+private:
+    static constexpr std::uint32_t no_record = std::numeric_limits<std::uint32_t>::max();
+
+    struct Band
+    {
+        std::vector<std::uint32_t> keys;
+        std::vector<std::uint32_t> heads;
+        std::vector<std::uint32_t> next;
+        std::size_t used { 0 };
+    };
+
+    std::uint32_t band_key(const Signature& signature, std::size_t band) const noexcept;
+    void grow(Band& band, std::size_t capacity);
+
+    IndexOptions m_options;
+    std::vector<Band> m_bands;
+    std::vector<std::array<std::uint8_t, signature_length>> m_sketches;
+};
+} // namespace identy::similarity
+
+#endif
@@ -0,0 +1,191 @@
+#include "Identy_pch.hxx"
+
+#include <chrono>
+#include <cstdio>
+
+#include "Identy_trace.hxx"
+#include "Platform/Identy_platform_source.hxx"
+
+namespace
+{
+constexpr std::size_t file_read_chunk = 4096;
+
+class LiveSource final : public identy::platform::HardwareSource
+{
+public:
+    void cpuid(identy::register_32 registers[4], identy::register_32 leaf, identy::register_32 subleaf) override
+    {
+#ifdef IDENTY_MSVC
+        __cpuidex(registers, leaf, subleaf);
+#elif defined(IDENTY_GNUC) || defined(IDENTY_CLANG)
+        unsigned int eax, ebx, ecx, edx;
+        __cpuid_count(leaf, subleaf, eax, ebx, ecx, edx);
+        registers[0] = static_cast<identy::register_32>(eax);
+        registers[1] = static_cast<identy::register_32>(ebx);
+        registers[2] = static_cast<identy::register_32>(ecx);
+        registers[3] = static_cast<identy::register_32>(edx);
+#endif
+    }
+
+    std::optional<std::vector<identy::byte>> read_file(const std::filesystem::path& path) override
+    {
+        // stdio rather than iostreams keeps stream machinery out of Identy::core
+#ifdef IDENTY_WIN32
+        std::FILE* file = _wfopen(path.c_str(), L"rb");
+#else
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+#endif
+
+        if(file == nullptr) {
+            identy::trace::count_io(0, 1);
+            return std::nullopt;
+        }
+
+        // sysfs reports a fixed size for text attributes, so read until EOF
+        // instead of trusting the file size
+        std::vector<identy::byte> data;
+        std::size_t used = 0;
+
+        while(true) {
+            data.resize(used + file_read_chunk);
+            auto count = std::fread(data.data() + used, 1, file_read_chunk, file);
+            used += count;
+
+            if(count < file_read_chunk) {
+                break;
+            }
+        }
+
+        bool failed = std::ferror(file) != 0;
+        std::fclose(file);
+
+        // open, one read per chunk, close
+        identy::trace::count_io(used, used / file_read_chunk + 3);
+
+        if(failed) {
+            return std::nullopt;
+        }
+
+        data.resize(used);
+        return data;
+    }
+
+    std::optional<std::vector<std::string>> list_dir(const std::filesystem::path& path) override
+    {
+        std::error_code ec;
+        std::filesystem::directory_iterator it(path, ec);
+        identy::trace::count_io(0, 1);
+
+        if(ec) {
+            return std::nullopt;
+        }
+
+        std::vector<std::string> names;
+
+        for(; it != std::filesystem::directory_iterator(); it.increment(ec)) {
+            if(ec) {
+                break;
+            }
+            names.push_back(it->path().filename().string());
+        }
+
+        std::ranges::sort(names);
+        return names;
+    }
+
+    std::optional<std::filesystem::path> read_link(const std::filesystem::path& path) override
+    {
+        std::error_code ec;
+        auto target = std::filesystem::read_symlink(path, ec);
+        identy::trace::count_io(0, 1);
+
+        if(ec) {
+            return std::nullopt;
+        }
+
+        return target;
+    }
+
+    bool exists(const std::filesystem::path& path) override
+    {
+        identy::trace::count_io(0, 1);
+
+        std::error_code ec;
+        return std::filesystem::exists(path, ec);
+    }
+
+    std::optional<identy::platform::FileStamp> stat(const std::filesystem::path& path) override
+    {
+        identy::trace::count_io(0, 1);
+
+        std::error_code ec;
+        auto status = std::filesystem::status(path, ec);
+
+        if(ec || !std::filesystem::exists(status)) {
+            return std::nullopt;
+        }
+
+        identy::platform::FileStamp stamp;
+
+        if(std::filesystem::is_regular_file(status)) {
+            auto size = std::filesystem::file_size(path, ec);
+            stamp.size = ec ? 0 : size;
+        }
+
+        auto time = std::filesystem::last_write_time(path, ec);
+        if(ec) {
+            return std::nullopt;
+        }
+
+        stamp.mtime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        return stamp;
+    }
+
+    std::optional<std::vector<identy::byte>> firmware_table(identy::dword provider, identy::dword id) override
+    {
+#ifdef IDENTY_WIN32
+        identy::dword size = GetSystemFirmwareTable(provider, id, nullptr, 0);
+        if(size == 0) {
+            return std::nullopt;
+        }
+
+        std::vector<identy::byte> buffer(size);
+        size = GetSystemFirmwareTable(provider, id, buffer.data(), size);
+        identy::trace::count_io(size, 2);
+
+        buffer.resize(std::min<std::size_t>(size, buffer.size()));
+
+        return buffer;
+#else
+        (void)provider;
+        (void)id;
+        return std::nullopt;
+#endif
+    }
+};
+
+LiveSource live;
+
+thread_local identy::platform::HardwareSource* current_source = nullptr;
+} // namespace
+
+identy::platform::HardwareSource& identy::platform::live_source() noexcept
+{
+    return live;
+}
+
+identy::platform::HardwareSource& identy::platform::source() noexcept
+{
+    return current_source != nullptr ? *current_source : live;
+}
+
+identy::platform::ScopedSource::ScopedSource(HardwareSource& source) noexcept
+    : m_previous(current_source)
+{
+    current_source = &source;
+}
+
+identy::platform::ScopedSource::~ScopedSource()
+{
+    current_source = m_previous;
+}
@@ -2,19 +2,565 @@
 
 #include "Identy_strings.hxx"
 
+#include <atomic>
+
+#include "Identy_platform.hxx"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IDENTY_STRINGS_SSE2 1
+
+#if defined(IDENTY_GNUC) || defined(IDENTY_CLANG)
+#include <immintrin.h>
+#define IDENTY_STRINGS_AVX2 1
+#define IDENTY_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(IDENTY_MSVC)
+#include <immintrin.h>
+#define IDENTY_STRINGS_AVX2 1
+#define IDENTY_TARGET_AVX2
+#endif
+#endif
+
 namespace
 {
-constexpr const char* WHITESPACE_CHARS = " \t\r\n";
+using identy::strings::Isa;
+using identy::strings::to_lower_ascii;
+
+constexpr std::size_t npos = std::string_view::npos;
+
+constexpr bool is_space(char c) noexcept
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+constexpr bool is_printable(char c) noexcept
+{
+    return c >= 0x20 && c <= 0x7E;
+}
+
+constexpr int hex_value(char c) noexcept
+{
+    if(c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if(c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if(c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/**
+ * One implementation of every scanning primitive. Positions are offsets
+ * into the input; "end" results are one past the last matching byte.
+ */
+struct Kernels
+{
+    Isa isa;
+    std::size_t (*first_not_space)(const char* data, std::size_t size);
+    std::size_t (*end_not_space)(const char* data, std::size_t size);
+    bool (*equal_icase)(const char* lhs, const char* rhs, std::size_t size);
+    std::size_t (*find_icase)(const char* haystack, std::size_t size, const char* needle, std::size_t needle_size);
+    bool (*all_equal)(const char* data, std::size_t size, char c);
+    std::size_t (*printable_prefix)(const char* data, std::size_t size);
+};
+
+// ============================================================================
+// Scalar
+// ============================================================================
+
+std::size_t first_not_space_scalar(const char* data, std::size_t size)
+{
+    std::size_t i = 0;
+    while(i < size && is_space(data[i])) {
+        ++i;
+    }
+    return i;
+}
+
+std::size_t end_not_space_scalar(const char* data, std::size_t size)
+{
+    while(size > 0 && is_space(data[size - 1])) {
+        --size;
+    }
+    return size;
+}
+
+bool equal_icase_scalar(const char* lhs, const char* rhs, std::size_t size)
+{
+    for(std::size_t i = 0; i < size; ++i) {
+        if(to_lower_ascii(lhs[i]) != to_lower_ascii(rhs[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Candidates from position begin on, used for the tails of the vector kernels
+std::size_t find_icase_from(const char* haystack, std::size_t size, const char* needle, std::size_t needle_size,
+    std::size_t begin)
+{
+    auto first = to_lower_ascii(needle[0]);
+
+    for(auto i = begin; i + needle_size <= size; ++i) {
+        if(to_lower_ascii(haystack[i]) == first && equal_icase_scalar(haystack + i + 1, needle + 1, needle_size - 1)) {
+            return i;
+        }
+    }
+    return npos;
+}
+
+std::size_t find_icase_scalar(const char* haystack, std::size_t size, const char* needle, std::size_t needle_size)
+{
+    return find_icase_from(haystack, size, needle, needle_size, 0);
+}
+
+bool all_equal_scalar(const char* data, std::size_t size, char c)
+{
+    for(std::size_t i = 0; i < size; ++i) {
+        if(data[i] != c) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t printable_prefix_scalar(const char* data, std::size_t size)
+{
+    std::size_t i = 0;
+    while(i < size && is_printable(data[i])) {
+        ++i;
+    }
+    return i;
+}
+
+constexpr Kernels scalar_kernels {
+    Isa::Scalar,
+    first_not_space_scalar,
+    end_not_space_scalar,
+    equal_icase_scalar,
+    find_icase_scalar,
+    all_equal_scalar,
+    printable_prefix_scalar,
+};
+
+#ifdef IDENTY_STRINGS_SSE2
+// ============================================================================
+// SSE2
+// ============================================================================
+
+constexpr unsigned sse2_full_mask = 0xFFFF;
+
+unsigned space_mask_sse2(__m128i chunk) noexcept
+{
+    auto space = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')));
+    space = _mm_or_si128(space, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')));
+    space = _mm_or_si128(space, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+    return static_cast<unsigned>(_mm_movemask_epi8(space));
+}
+
+// 'A'..'Z' gain bit 0x20; bytes from 0x80 compare negative and stay as they are
+__m128i fold_sse2(__m128i chunk) noexcept
+{
+    auto upper = _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(chunk, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(chunk, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+__m128i load_sse2(const char* data) noexcept
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+std::size_t first_not_space_sse2(const char* data, std::size_t size)
+{
+    std::size_t i = 0;
+    for(; i + 16 <= size; i += 16) {
+        auto mask = ~space_mask_sse2(load_sse2(data + i)) & sse2_full_mask;
+        if(mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+    return i + first_not_space_scalar(data + i, size - i);
+}
+
+std::size_t end_not_space_sse2(const char* data, std::size_t size)
+{
+    for(; size >= 16; size -= 16) {
+        auto mask = ~space_mask_sse2(load_sse2(data + size - 16)) & sse2_full_mask;
+        if(mask != 0) {
+            return size - 16 + static_cast<std::size_t>(std::bit_width(mask));
+        }
+    }
+    return end_not_space_scalar(data, size);
+}
+
+bool equal_icase_sse2(const char* lhs, const char* rhs, std::size_t size)
+{
+    std::size_t i = 0;
+    for(; i + 16 <= size; i += 16) {
+        auto equal = _mm_cmpeq_epi8(fold_sse2(load_sse2(lhs + i)), fold_sse2(load_sse2(rhs + i)));
+        if(static_cast<unsigned>(_mm_movemask_epi8(equal)) != sse2_full_mask) {
+            return false;
+        }
+    }
+    return equal_icase_scalar(lhs + i, rhs + i, size - i);
+}
+
+// Compares the first and last needle byte at 16 positions at once and
+// verifies only the positions where both match
+std::size_t find_icase_sse2(const char* haystack, std::size_t size, const char* needle, std::size_t needle_size)
+{
+    auto first = _mm_set1_epi8(to_lower_ascii(needle[0]));
+    auto last = _mm_set1_epi8(to_lower_ascii(needle[needle_size - 1]));
+
+    std::size_t i = 0;
+    for(; i + needle_size - 1 + 16 <= size; i += 16) {
+        auto block_first = fold_sse2(load_sse2(haystack + i));
+        auto block_last = fold_sse2(load_sse2(haystack + i + needle_size - 1));
+
+        auto mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last))));
+
+        while(mask != 0) {
+            auto offset = static_cast<std::size_t>(std::countr_zero(mask));
+            if(needle_size <= 2 || equal_icase_scalar(haystack + i + offset + 1, needle + 1, needle_size - 2)) {
+                return i + offset;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return find_icase_from(haystack, size, needle, needle_size, i);
+}
+
+bool all_equal_sse2(const char* data, std::size_t size, char c)
+{
+    auto expected = _mm_set1_epi8(c);
+
+    std::size_t i = 0;
+    for(; i + 16 <= size; i += 16) {
+        if(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(load_sse2(data + i), expected))) != sse2_full_mask) {
+            return false;
+        }
+    }
+    return all_equal_scalar(data + i, size - i, c);
+}
+
+std::size_t printable_prefix_sse2(const char* data, std::size_t size)
+{
+    std::size_t i = 0;
+    for(; i + 16 <= size; i += 16) {
+        auto chunk = load_sse2(data + i);
+        auto printable = _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8(0x1F)), _mm_cmplt_epi8(chunk, _mm_set1_epi8(0x7F)));
+
+        auto mask = ~static_cast<unsigned>(_mm_movemask_epi8(printable)) & sse2_full_mask;
+        if(mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+    return i + printable_prefix_scalar(data + i, size - i);
+}
+
+constexpr Kernels sse2_kernels {
+    Isa::SSE2,
+    first_not_space_sse2,
+    end_not_space_sse2,
+    equal_icase_sse2,
+    find_icase_sse2,
+    all_equal_sse2,
+    printable_prefix_sse2,
+};
+#endif
+
+#ifdef IDENTY_STRINGS_AVX2
+// ============================================================================
+// AVX2
+// ============================================================================
+
+IDENTY_TARGET_AVX2 std::uint32_t space_mask_avx2(__m256i chunk) noexcept
+{
+    auto space = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t')));
+    space = _mm256_or_si256(space, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')));
+    space = _mm256_or_si256(space, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')));
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(space));
+}
+
+IDENTY_TARGET_AVX2 __m256i fold_avx2(__m256i chunk) noexcept
+{
+    auto upper = _mm256_andnot_si256(_mm256_cmpgt_epi8(chunk, _mm256_set1_epi8('Z')), _mm256_cmpgt_epi8(chunk, _mm256_set1_epi8('A' - 1)));
+    return _mm256_or_si256(chunk, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+IDENTY_TARGET_AVX2 __m256i load_avx2(const char* data) noexcept
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+}
+
+IDENTY_TARGET_AVX2 std::size_t first_not_space_avx2(const char* data, std::size_t size)
+{
+    std::size_t i = 0;
+    for(; i + 32 <= size; i += 32) {
+        auto mask = ~space_mask_avx2(load_avx2(data + i));
+        if(mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+    return i + first_not_space_sse2(data + i, size - i);
+}
+
+IDENTY_TARGET_AVX2 std::size_t end_not_space_avx2(const char* data, std::size_t size)
+{
+    for(; size >= 32; size -= 32) {
+        auto mask = ~space_mask_avx2(load_avx2(data + size - 32));
+        if(mask != 0) {
+            return size - 32 + static_cast<std::size_t>(std::bit_width(mask));
+        }
+    }
+    return end_not_space_sse2(data, size);
+}
+
+IDENTY_TARGET_AVX2 bool equal_icase_avx2(const char* lhs, const char* rhs, std::size_t size)
+{
+    std::size_t i = 0;
+    for(; i + 32 <= size; i += 32) {
+        auto equal = _mm256_cmpeq_epi8(fold_avx2(load_avx2(lhs + i)), fold_avx2(load_avx2(rhs + i)));
+        if(static_cast<std::uint32_t>(_mm256_movemask_epi8(equal)) != 0xFFFFFFFFu) {
+            return false;
+        }
+    }
+    return equal_icase_sse2(lhs + i, rhs + i, size - i);
+}
+
+IDENTY_TARGET_AVX2 std::size_t find_icase_avx2(const char* haystack, std::size_t size, const char* needle, std::size_t needle_size)
+{
+    auto first = _mm256_set1_epi8(to_lower_ascii(needle[0]));
+    auto last = _mm256_set1_epi8(to_lower_ascii(needle[needle_size - 1]));
+
+    std::size_t i = 0;
+    for(; i + needle_size - 1 + 32 <= size; i += 32) {
+        auto block_first = fold_avx2(load_avx2(haystack + i));
+        auto block_last = fold_avx2(load_avx2(haystack + i + needle_size - 1));
+
+        auto mask = static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last))));
+
+        while(mask != 0) {
+            auto offset = static_cast<std::size_t>(std::countr_zero(mask));
+            if(needle_size <= 2 || equal_icase_scalar(haystack + i + offset + 1, needle + 1, needle_size - 2)) {
+                return i + offset;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return find_icase_from(haystack, size, needle, needle_size, i);
+}
+
+IDENTY_TARGET_AVX2 bool all_equal_avx2(const char* data, std::size_t size, char c)
+{
+    auto expected = _mm256_set1_epi8(c);
+
+    std::size_t i = 0;
+    for(; i + 32 <= size; i += 32) {
+        if(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(load_avx2(data + i), expected))) != 0xFFFFFFFFu) {
+            return false;
+        }
+    }
+    return all_equal_sse2(data + i, size - i, c);
+}
+
+IDENTY_TARGET_AVX2 std::size_t printable_prefix_avx2(const char* data, std::size_t size)
+{
+    std::size_t i = 0;
+    for(; i + 32 <= size; i += 32) {
+        auto chunk = load_avx2(data + i);
+        auto printable = _mm256_andnot_si256(_mm256_cmpgt_epi8(chunk, _mm256_set1_epi8(0x7E)), _mm256_cmpgt_epi8(chunk, _mm256_set1_epi8(0x1F)));
+
+        auto mask = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(printable));
+        if(mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+    return i + printable_prefix_sse2(data + i, size - i);
+}
+
+constexpr Kernels avx2_kernels {
+    Isa::AVX2,
+    first_not_space_avx2,
+    end_not_space_avx2,
+    equal_icase_avx2,
+    find_icase_avx2,
+    all_equal_avx2,
+    printable_prefix_avx2,
+};
+
+// The instructions the process may execute, so the real CPU rather than the
+// hardware source a snapshot reads
+bool cpu_has_avx2() noexcept
+{
+#if defined(IDENTY_GNUC) || defined(IDENTY_CLANG)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    int registers[4] {};
+
+    __cpuid(registers, 1);
+    bool os_saves_ymm = (registers[2] & (1 << 27)) != 0 && (registers[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+
+    __cpuidex(registers, 7, 0);
+    return os_saves_ymm && (registers[1] & (1 << 5)) != 0;
+#endif
+}
+#endif
+
+const Kernels* kernels_for(Isa isa) noexcept
+{
+    switch(isa) {
+        case Isa::Scalar:
+            return &scalar_kernels;
+#ifdef IDENTY_STRINGS_SSE2
+        case Isa::SSE2:
+            return &sse2_kernels;
+#endif
+#ifdef IDENTY_STRINGS_AVX2
+        case Isa::AVX2:
+            return cpu_has_avx2() ? &avx2_kernels : nullptr;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+const Kernels* detect() noexcept
+{
+    for(auto isa : { Isa::AVX2, Isa::SSE2 }) {
+        if(auto* kernels = kernels_for(isa)) {
+            return kernels;
+        }
+    }
+    return &scalar_kernels;
+}
+
+std::atomic<const Kernels*> active { nullptr };
+
+const Kernels& kernels() noexcept
+{
+    auto* current = active.load(std::memory_order_acquire);
+    if(current == nullptr) {
+        // racing first calls detect the same set
+        current = detect();
+        active.store(current, std::memory_order_release);
+    }
+    return *current;
+}
 } // namespace
 
+identy::strings::Isa identy::strings::isa() noexcept
+{
+    return kernels().isa;
+}
+
+bool identy::strings::set_isa(Isa isa) noexcept
+{
+    auto* selected = kernels_for(isa);
+    if(selected == nullptr) {
+        return false;
+    }
+
+    active.store(selected, std::memory_order_release);
+    return true;
+}
+
 std::string_view identy::strings::trim_whitespace(std::string_view string)
 {
-    auto start = string.find_first_not_of(WHITESPACE_CHARS);
-    auto end = string.find_last_not_of(WHITESPACE_CHARS);
+    const auto& k = kernels();
 
-    if(start == std::string_view::npos || end == std::string_view::npos) {
+    auto start = k.first_not_space(string.data(), string.size());
+    if(start == string.size()) {
         return {};
     }
 
-    return string.substr(start, end - start + 1);
+    auto end = start + k.end_not_space(string.data() + start, string.size() - start);
+    return string.substr(start, end - start);
+}
+
+bool identy::strings::equals_icase(std::string_view lhs, std::string_view rhs) noexcept
+{
+    return lhs.size() == rhs.size() && kernels().equal_icase(lhs.data(), rhs.data(), lhs.size());
+}
+
+std::size_t identy::strings::find_icase(std::string_view haystack, std::string_view needle) noexcept
+{
+    if(needle.empty()) {
+        return 0;
+    }
+    if(needle.size() > haystack.size()) {
+        return npos;
+    }
+
+    return kernels().find_icase(haystack.data(), haystack.size(), needle.data(), needle.size());
+}
+
+bool identy::strings::contains_icase(std::string_view haystack, std::string_view needle) noexcept
+{
+    return find_icase(haystack, needle) != npos;
+}
+
+bool identy::strings::all_same(std::string_view string) noexcept
+{
+    return string.size() < 2 || kernels().all_equal(string.data() + 1, string.size() - 1, string[0]);
+}
+
+std::size_t identy::strings::printable_prefix(std::string_view string) noexcept
+{
+    return kernels().printable_prefix(string.data(), string.size());
+}
+
+std::string identy::strings::filter_printable(std::string_view string)
+{
+    std::string result;
+    result.reserve(string.size());
+
+    while(!string.empty()) {
+        auto run = printable_prefix(string);
+        result.append(string.substr(0, run));
+        string.remove_prefix(std::min(run + 1, string.size()));
+    }
+
+    return result;
+}
+
+std::optional<std::array<std::uint8_t, 16>> identy::strings::parse_uuid(std::string_view text) noexcept
+{
+    if(text.size() < 32) {
+        return std::nullopt;
+    }
+
+    std::array<std::uint8_t, 16> uuid {};
+    std::size_t count = 0;
+
+    for(std::size_t i = 0; i < text.size() && count < uuid.size(); ++i) {
+        if(text[i] == '-') {
+            continue;
+        }
+
+        if(i + 1 >= text.size()) {
+            break;
+        }
+
+        auto high = hex_value(text[i]);
+        auto low = hex_value(text[i + 1]);
+        if(high < 0 || low < 0) {
+            return std::nullopt;
+        }
+
+        uuid[count++] = static_cast<std::uint8_t>(high << 4 | low);
+        ++i;
+    }
+
+    if(count != uuid.size()) {
+        return std::nullopt;
+    }
+
+    return uuid;
 }
@@ -1,11 +1,95 @@
+/**
+ * @file Identy_strings.hxx
+ * @brief String primitives shared by the collectors and heuristics
+ *
+ * Serial numbers, model names and sysfs attributes are short ASCII strings
+ * that every snapshot and VM check scans several times. The scanning
+ * functions below process 16 (SSE2) or 32 (AVX2) bytes per step. The kernel
+ * set is chosen once per process from the CPU features; isa() reports the
+ * choice and set_isa() forces another one, e.g. to compare implementations.
+ *
+ * Case folding and printability are ASCII only: bytes outside 0x00-0x7F are
+ * never folded and never printable.
+ */
+
 #pragma once
 
 #ifndef UNC_IDENTY_STRINGS_H
 #define UNC_IDENTY_STRINGS_H
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
 namespace identy::strings
 {
+/**
+ * @brief Kernel set used by the scanning functions
+ */
+enum class Isa : std::uint8_t {
+    Scalar, /**< Portable byte loops */
+    SSE2,   /**< 16 bytes per step */
+    AVX2,   /**< 32 bytes per step */
+};
+
+/** @brief Kernel set in use */
+Isa isa() noexcept;
+
+/**
+ * @brief Selects a kernel set
+ * @return false if this build or CPU lacks it; the selection is unchanged
+ */
+bool set_isa(Isa isa) noexcept;
+
+/** @brief Removes leading and trailing spaces, tabs, CR and LF */
 std::string_view trim_whitespace(std::string_view string);
+
+/** @brief ASCII lowercase of one character */
+constexpr char to_lower_ascii(char c) noexcept
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+/** @brief Equality ignoring ASCII case */
+bool equals_icase(std::string_view lhs, std::string_view rhs) noexcept;
+
+/**
+ * @brief Position of the first occurrence of @p needle ignoring ASCII case
+ * @return Offset into @p haystack, std::string_view::npos if absent; 0 for
+ *         an empty needle
+ */
+std::size_t find_icase(std::string_view haystack, std::string_view needle) noexcept;
+
+/** @brief Whether @p haystack contains @p needle ignoring ASCII case */
+bool contains_icase(std::string_view haystack, std::string_view needle) noexcept;
+
+/**
+ * @brief Whether every character equals the first one
+ *
+ * True for empty and one-character strings. Used to spot placeholder
+ * serials such as "0000000000" or "          ".
+ */
+bool all_same(std::string_view string) noexcept;
+
+/** @brief Length of the leading run of printable ASCII (0x20-0x7E) */
+std::size_t printable_prefix(std::string_view string) noexcept;
+
+/** @brief Copy of @p string with every non-printable byte removed */
+std::string filter_printable(std::string_view string);
+
+/**
+ * @brief Parses a textual UUID
+ *
+ * Accepts 32 hex digits of either case, optionally split by dashes between
+ * bytes as in "4c4c4544-0033-...". Characters after the 16th byte are
+ * ignored. Bytes are returned in text order.
+ *
+ * @return The 16 bytes, std::nullopt on a malformed or short string
+ */
+std::optional<std::array<std::uint8_t, 16>> parse_uuid(std::string_view text) noexcept;
 } // namespace identy::strings
 
 #endif
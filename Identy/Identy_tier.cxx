@@ -0,0 +1,163 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_tier.hxx"
+
+#include <mutex>
+
+// only for the socket path constant; the client is installed by Identy::io
+#include "Identy_daemon.hxx"
+#include "Platform/Identy_platform_hwid.hxx"
+#include "Platform/Identy_platform_source.hxx"
+
+namespace
+{
+using identy::platform::Probe;
+
+std::atomic<identy::platform::DaemonSmbiosQuery> daemon_query { nullptr };
+
+std::mutex& socket_mutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::filesystem::path& socket_path()
+{
+    static std::filesystem::path path { identy::daemon::default_socket_path };
+    return path;
+}
+
+bool is_live() noexcept
+{
+    return &identy::platform::source() == &identy::platform::live_source();
+}
+
+bool readable(const std::atomic<Probe>& probe) noexcept
+{
+    return probe.load(std::memory_order_relaxed) == Probe::Readable;
+}
+
+void probe_daemon(identy::platform::AccessPlan& plan)
+{
+    if(plan.daemon.load(std::memory_order_relaxed) != Probe::Unknown) {
+        return;
+    }
+
+    // replayed and rooted sources describe another machine than the daemon's
+    auto socket = identy::tier::daemon_socket();
+    bool present = is_live() && daemon_query.load(std::memory_order_acquire) != nullptr && !socket.empty() &&
+        identy::platform::source().exists(socket);
+
+    plan.daemon.store(present ? Probe::Readable : Probe::Unavailable, std::memory_order_relaxed);
+}
+} // namespace
+
+identy::platform::AccessPlan& identy::platform::live_access_plan() noexcept
+{
+    static AccessPlan plan;
+    return plan;
+}
+
+std::optional<std::vector<identy::byte>> identy::platform::read_planned(std::atomic<Probe>& probe, const std::filesystem::path& path)
+{
+    if(probe.load(std::memory_order_relaxed) == Probe::Unavailable) {
+        return std::nullopt;
+    }
+
+    auto data = source().read_file(path);
+    probe.store(data.has_value() ? Probe::Readable : Probe::Unavailable, std::memory_order_relaxed);
+
+    return data;
+}
+
+identy::SMBIOS_RawData identy::platform::get_smbios()
+{
+    if(is_live()) {
+        return get_smbios(live_access_plan());
+    }
+
+    AccessPlan plan;
+    return get_smbios(plan);
+}
+
+std::optional<identy::SMBIOS> identy::platform::query_daemon_smbios(AccessPlan& plan)
+{
+    probe_daemon(plan);
+    if(!readable(plan.daemon)) {
+        return std::nullopt;
+    }
+
+    // a daemon that could not read the tables either has nothing to add
+    auto smbios = daemon_query.load(std::memory_order_acquire)(tier::daemon_socket());
+    if(!smbios.has_value() || smbios->tier != SmbiosTier::Table) {
+        plan.daemon.store(Probe::Unavailable, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    smbios->tier = SmbiosTier::Daemon;
+    return smbios;
+}
+
+void identy::platform::set_daemon_smbios_query(DaemonSmbiosQuery query) noexcept
+{
+    daemon_query.store(query, std::memory_order_release);
+    live_access_plan().daemon.store(Probe::Unknown, std::memory_order_relaxed);
+}
+
+identy::SmbiosTier identy::tier::Access::best() const noexcept
+{
+    if(dmi_table) {
+        return SmbiosTier::Table;
+    }
+    if(daemon) {
+        return SmbiosTier::Daemon;
+    }
+    if(uuid_attribute || version_attribute) {
+        return SmbiosTier::Attributes;
+    }
+
+    return SmbiosTier::None;
+}
+
+identy::tier::Access identy::tier::access()
+{
+    platform::AccessPlan local;
+    auto& plan = is_live() ? platform::live_access_plan() : local;
+
+    platform::probe_smbios(plan);
+    probe_daemon(plan);
+
+    Access result;
+    result.dmi_table = readable(plan.dmi_table);
+    result.entry_point = readable(plan.entry_point);
+    result.uuid_attribute = readable(plan.uuid_attribute);
+    result.version_attribute = readable(plan.version_attribute);
+    result.daemon = readable(plan.daemon);
+
+    return result;
+}
+
+void identy::tier::reset()
+{
+    auto& plan = platform::live_access_plan();
+
+    for(auto* probe : { &plan.dmi_table, &plan.entry_point, &plan.uuid_attribute, &plan.version_attribute, &plan.daemon }) {
+        probe->store(Probe::Unknown, std::memory_order_relaxed);
+    }
+}
+
+void identy::tier::set_daemon_socket(const std::filesystem::path& socket)
+{
+    {
+        std::lock_guard lock(socket_mutex());
+        socket_path() = socket;
+    }
+
+    platform::live_access_plan().daemon.store(Probe::Unknown, std::memory_order_relaxed);
+}
+
+std::filesystem::path identy::tier::daemon_socket()
+{
+    std::lock_guard lock(socket_mutex());
+    return socket_path();
+}
@@ -0,0 +1,100 @@
+/**
+ * @file Identy_tier.hxx
+ * @brief Privilege-aware choice of the SMBIOS source
+ *
+ * On Linux the raw tables (/sys/firmware/dmi/tables/DMI) and
+ * /sys/class/dmi/id/product_uuid are readable by root only. Rather than
+ * retrying them on every snapshot, the collectors keep an access plan that
+ * records which sources answered. The plan is filled on first use and reused
+ * for the rest of the process, and each snapshot takes the cheapest source
+ * that yields complete data:
+ *
+ * | Tier       | Source                          | Cost                   | Fields                |
+ * |------------|---------------------------------|------------------------|-----------------------|
+ * | Table      | DMI table and entry point       | two reads of a few KiB | all                   |
+ * | Daemon     | identyd over its socket         | one socket round trip  | all                   |
+ * | Attributes | product_uuid and smbios_version | two small reads        | UUID and version only |
+ *
+ * The daemon ranks above the attributes although it costs more: it returns
+ * the same tables a privileged process reads, so the fingerprint does not
+ * depend on who collected it. The achieved tier is reported in SMBIOS::tier
+ * and kept by the binary snapshot format.
+ *
+ * The daemon tier needs the client in Identy::io; linking Identy::core alone
+ * leaves it out.
+ *
+ * Only the live hardware source is planned once per process. Capture, replay
+ * and ScopedSysfsRoot probe on every snapshot and never contact the daemon.
+ *
+ * @code
+ * auto access = identy::tier::access();
+ * if(access.best() < identy::SmbiosTier::Table) {
+ *     // running unprivileged
+ * }
+ * @endcode
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_TIER_H
+#define UNC_IDENTY_TIER_H
+
+#include <filesystem>
+
+#include "Identy_hwid.hxx"
+
+namespace identy::tier
+{
+/**
+ * @brief Sources available to the calling process
+ */
+struct Access
+{
+    /** @brief Raw SMBIOS tables (the firmware table API on Windows) */
+    bool dmi_table { false };
+
+    /** @brief SMBIOS entry point with the version */
+    bool entry_point { false };
+
+    /** @brief /sys/class/dmi/id/product_uuid */
+    bool uuid_attribute { false };
+
+    /** @brief /sys/class/dmi/id/smbios_version */
+    bool version_attribute { false };
+
+    /** @brief identyd socket present and the daemon tier enabled (needs Identy::io) */
+    bool daemon { false };
+
+    /** @brief Tier the next snapshot will achieve */
+    SmbiosTier best() const noexcept;
+};
+
+/**
+ * @brief Probes the sources not tried yet and returns the access plan
+ *
+ * Probing reads each unknown source once; later calls and snapshots reuse
+ * the outcome.
+ */
+Access access();
+
+/**
+ * @brief Forgets the plan of the live source
+ *
+ * Call after the privileges of the process changed or identyd was started.
+ */
+void reset();
+
+/**
+ * @brief Sets the socket of the daemon tier
+ * @param socket identyd socket, empty disables the daemon tier
+ *
+ * Defaults to daemon::default_socket_path. identyd disables the tier for
+ * itself so it never waits on its own socket.
+ */
+void set_daemon_socket(const std::filesystem::path& socket);
+
+/** @brief Socket of the daemon tier, empty if disabled */
+std::filesystem::path daemon_socket();
+} // namespace identy::tier
+
+#endif
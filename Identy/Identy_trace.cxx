@@ -0,0 +1,188 @@
+#include "Identy_pch.hxx"
+
+#include "Identy_trace.hxx"
+
+#include <atomic>
+#include <chrono>
+
+namespace
+{
+struct PhaseCounters
+{
+    std::atomic<std::uint64_t> calls { 0 };
+    std::atomic<std::uint64_t> total_ns { 0 };
+    std::atomic<std::uint64_t> max_ns { 0 };
+    std::atomic<std::uint64_t> bytes { 0 };
+    std::atomic<std::uint64_t> syscalls { 0 };
+    std::array<std::atomic<std::uint64_t>, identy::trace::histogram_buckets> histogram {};
+};
+
+constexpr std::array<std::string_view, identy::trace::phase_count> phase_names {
+    "snap_motherboard",
+    "snap_motherboard_ex",
+    "cpu_info",
+    "get_smbios",
+    "list_drives",
+    "drive",
+    "vm.analyze",
+    "vm.check_cpu",
+    "vm.check_smbios",
+    "vm.check_network",
+    "vm.check_drives",
+    "hash",
+    "collector",
+};
+
+std::array<PhaseCounters, identy::trace::phase_count> counters;
+
+std::atomic<identy::trace::Sink> sink { nullptr };
+
+// I/O accounted on this thread so far; spans report the difference
+thread_local std::uint64_t thread_bytes = 0;
+thread_local std::uint64_t thread_syscalls = 0;
+thread_local std::uint32_t thread_depth = 0;
+
+std::uint64_t now_ns() noexcept
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+std::size_t bucket_of(std::uint64_t duration_ns) noexcept
+{
+    if(duration_ns == 0) {
+        return 0;
+    }
+    return std::min<std::size_t>(std::bit_width(duration_ns) - 1, identy::trace::histogram_buckets - 1);
+}
+
+void update_max(std::atomic<std::uint64_t>& max, std::uint64_t value) noexcept
+{
+    auto current = max.load(std::memory_order_relaxed);
+    while(current < value && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+} // namespace
+
+std::string_view identy::trace::phase_name(Phase phase) noexcept
+{
+    auto index = static_cast<std::size_t>(phase);
+    return index < phase_names.size() ? phase_names[index] : std::string_view {};
+}
+
+void identy::trace::set_sink(Sink new_sink) noexcept
+{
+    sink.store(new_sink, std::memory_order_release);
+}
+
+std::uint64_t identy::trace::PhaseStats::percentile_ns(double fraction) const noexcept
+{
+    if(calls == 0) {
+        return 0;
+    }
+
+    auto target = static_cast<std::uint64_t>(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(calls));
+    std::uint64_t seen = 0;
+
+    for(std::size_t i = 0; i < histogram.size(); ++i) {
+        seen += histogram[i];
+        if(seen > target || (seen == calls && seen > 0)) {
+            return (std::uint64_t { 2 } << i) - 1;
+        }
+    }
+
+    return max_ns;
+}
+
+identy::trace::PhaseStats identy::trace::stats(Phase phase) noexcept
+{
+    PhaseStats result;
+
+    auto index = static_cast<std::size_t>(phase);
+    if(index >= counters.size()) {
+        return result;
+    }
+
+    const auto& c = counters[index];
+    result.calls = c.calls.load(std::memory_order_relaxed);
+    result.total_ns = c.total_ns.load(std::memory_order_relaxed);
+    result.max_ns = c.max_ns.load(std::memory_order_relaxed);
+    result.bytes = c.bytes.load(std::memory_order_relaxed);
+    result.syscalls = c.syscalls.load(std::memory_order_relaxed);
+
+    for(std::size_t i = 0; i < histogram_buckets; ++i) {
+        result.histogram[i] = c.histogram[i].load(std::memory_order_relaxed);
+    }
+
+    return result;
+}
+
+void identy::trace::reset() noexcept
+{
+    for(auto& c : counters) {
+        c.calls.store(0, std::memory_order_relaxed);
+        c.total_ns.store(0, std::memory_order_relaxed);
+        c.max_ns.store(0, std::memory_order_relaxed);
+        c.bytes.store(0, std::memory_order_relaxed);
+        c.syscalls.store(0, std::memory_order_relaxed);
+
+        for(auto& bucket : c.histogram) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+identy::trace::detail::SpanStart identy::trace::detail::begin(Phase phase, std::string_view detail) noexcept
+{
+    SpanStart start { now_ns(), thread_bytes, thread_syscalls };
+
+    if(auto callback = sink.load(std::memory_order_acquire)) {
+        Event event;
+        event.kind = EventKind::Begin;
+        event.phase = phase;
+        event.depth = thread_depth;
+        event.timestamp_ns = start.timestamp_ns;
+        event.detail = detail;
+        callback(event);
+    }
+
+    ++thread_depth;
+    return start;
+}
+
+void identy::trace::detail::end(Phase phase, std::string_view detail, const SpanStart& start) noexcept
+{
+    auto timestamp = now_ns();
+    auto duration = timestamp - start.timestamp_ns;
+    auto bytes = thread_bytes - start.bytes;
+    auto syscalls = thread_syscalls - start.syscalls;
+
+    --thread_depth;
+
+    auto& c = counters[static_cast<std::size_t>(phase)];
+    c.calls.fetch_add(1, std::memory_order_relaxed);
+    c.total_ns.fetch_add(duration, std::memory_order_relaxed);
+    c.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    c.syscalls.fetch_add(syscalls, std::memory_order_relaxed);
+    c.histogram[bucket_of(duration)].fetch_add(1, std::memory_order_relaxed);
+    update_max(c.max_ns, duration);
+
+    if(auto callback = sink.load(std::memory_order_acquire)) {
+        Event event;
+        event.kind = EventKind::End;
+        event.phase = phase;
+        event.depth = thread_depth;
+        event.timestamp_ns = timestamp;
+        event.duration_ns = duration;
+        event.bytes = bytes;
+        event.syscalls = syscalls;
+        event.detail = detail;
+        callback(event);
+    }
+}
+
+void identy::trace::detail::add_io(std::uint64_t bytes, std::uint64_t syscalls) noexcept
+{
+    thread_bytes += bytes;
+    thread_syscalls += syscalls;
+}
@@ -0,0 +1,219 @@
+/**
+ * @file Identy_trace.hxx
+ * @brief Optional phase-level tracing and metrics of the collectors
+ *
+ * Configuring with -DIDENTY_ENABLE_TRACING=ON instruments every phase of a
+ * snapshot: snap_motherboard(), CPUID, get_smbios(), list_drives() and each
+ * drive, each VM check and hashing. For each phase the library keeps
+ * lock-free counters (calls, time, bytes, syscalls) and a log2 latency
+ * histogram, and forwards begin/end events to an optional sink:
+ *
+ * @code
+ * identy::trace::set_sink([](const identy::trace::Event& event) {
+ *     if(event.kind == identy::trace::EventKind::End) {
+ *         my_tracer.record(identy::trace::phase_name(event.phase), event.duration_ns);
+ *     }
+ * });
+ * @endcode
+ *
+ * Without the option trace::Span is an empty type whose members compile to
+ * nothing, so the instrumentation costs nothing. The query functions stay
+ * available and report zeros.
+ *
+ * Byte and syscall counts cover reads issued through the live hardware
+ * source (sysfs files, directories, links, firmware tables) and bytes fed to
+ * the hash; syscalls of buffered file reads are estimated as one open, one
+ * read per 4 KiB and one close.
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_TRACE_H
+#define UNC_IDENTY_TRACE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace identy::trace
+{
+/** @brief Whether the library was built with IDENTY_ENABLE_TRACING */
+#ifdef IDENTY_ENABLE_TRACING
+inline constexpr bool enabled = true;
+#else
+inline constexpr bool enabled = false;
+#endif
+
+/**
+ * @brief Instrumented phase
+ */
+enum class Phase : std::uint8_t {
+    SnapMotherboard,   /**< snap_motherboard() */
+    SnapMotherboardEx, /**< snap_motherboard_ex() */
+    CpuInfo,           /**< CPUID queries */
+    GetSmbios,         /**< SMBIOS/DMI table retrieval */
+    ListDrives,        /**< Drive enumeration */
+    Drive,             /**< One drive; Event::detail is the device name */
+    VmAnalyze,         /**< Default VM heuristic, all checks */
+    VmCheckCpu,        /**< Hypervisor bit, signature and HVCI checks */
+    VmCheckSmbios,     /**< SMBIOS manufacturer and UUID checks */
+    VmCheckNetwork,    /**< Network adapter scan */
+    VmCheckDrives,     /**< Drive bus, serial and product checks */
+    Hash,              /**< Default fingerprint hash */
+    Collector,         /**< One registered collector; Event::detail is its name */
+    Count
+};
+
+/** @brief Number of phases */
+inline constexpr std::size_t phase_count = static_cast<std::size_t>(Phase::Count);
+
+/** @brief Stable name of a phase ("snap_motherboard", "vm.check_network", ...) */
+std::string_view phase_name(Phase phase) noexcept;
+
+/**
+ * @brief Kind of a trace event
+ */
+enum class EventKind : std::uint8_t {
+    Begin,
+    End
+};
+
+/**
+ * @brief Phase boundary delivered to the sink
+ *
+ * Duration, bytes and syscalls are only set on End events and include nested
+ * phases.
+ */
+struct Event
+{
+    EventKind kind { EventKind::Begin };
+    Phase phase { Phase::SnapMotherboard };
+
+    /** @brief Nesting depth on the emitting thread, 0 for outermost phases */
+    std::uint32_t depth { 0 };
+
+    /** @brief steady_clock time of the event in nanoseconds */
+    std::uint64_t timestamp_ns { 0 };
+
+    std::uint64_t duration_ns { 0 };
+    std::uint64_t bytes { 0 };
+    std::uint64_t syscalls { 0 };
+
+    /** @brief Phase specific detail, valid during the callback only */
+    std::string_view detail;
+};
+
+/**
+ * @brief Event callback
+ *
+ * Called synchronously on the thread running the phase, possibly from several
+ * threads at once.
+ */
+using Sink = void (*)(const Event& event);
+
+/**
+ * @brief Installs the event sink, nullptr to remove it
+ */
+void set_sink(Sink sink) noexcept;
+
+/** @brief Number of latency histogram buckets */
+inline constexpr std::size_t histogram_buckets = 48;
+
+/**
+ * @brief Aggregated metrics of one phase
+ */
+struct PhaseStats
+{
+    std::uint64_t calls { 0 };
+    std::uint64_t total_ns { 0 };
+    std::uint64_t max_ns { 0 };
+    std::uint64_t bytes { 0 };
+    std::uint64_t syscalls { 0 };
+
+    /** @brief Bucket i counts durations in [2^i, 2^(i+1)) ns; bucket 0 also holds 0 ns */
+    std::array<std::uint64_t, histogram_buckets> histogram {};
+
+    /**
+     * @brief Approximate latency percentile
+     * @param fraction Percentile in [0, 1]
+     * @return Upper bound of the histogram bucket holding the percentile
+     */
+    std::uint64_t percentile_ns(double fraction) const noexcept;
+};
+
+/** @brief Snapshot of the metrics of @p phase */
+PhaseStats stats(Phase phase) noexcept;
+
+/** @brief Clears all metrics */
+void reset() noexcept;
+
+namespace detail
+{
+struct SpanStart
+{
+    std::uint64_t timestamp_ns;
+    std::uint64_t bytes;
+    std::uint64_t syscalls;
+};
+
+SpanStart begin(Phase phase, std::string_view detail) noexcept;
+void end(Phase phase, std::string_view detail, const SpanStart& start) noexcept;
+void add_io(std::uint64_t bytes, std::uint64_t syscalls) noexcept;
+} // namespace detail
+
+/**
+ * @brief Scoped phase measurement, selected at compile time
+ */
+template<bool Enabled>
+class BasicSpan;
+
+template<>
+class BasicSpan<false> final
+{
+public:
+    explicit BasicSpan(Phase, std::string_view = {}) noexcept
+    {
+    }
+};
+
+template<>
+class BasicSpan<true> final
+{
+public:
+    explicit BasicSpan(Phase phase, std::string_view detail = {}) noexcept
+        : m_phase(phase)
+        , m_detail(detail)
+        , m_start(detail::begin(phase, detail))
+    {
+    }
+
+    ~BasicSpan()
+    {
+        detail::end(m_phase, m_detail, m_start);
+    }
+
+    BasicSpan(const BasicSpan&) = delete;
+    BasicSpan& operator=(const BasicSpan&) = delete;
+
+private:
+    Phase m_phase;
+    std::string_view m_detail;
+    detail::SpanStart m_start;
+};
+
+/** @brief Span type used by the library */
+using Span = BasicSpan<enabled>;
+
+/**
+ * @brief Accounts bytes and syscalls to the phases open on this thread
+ */
+inline void count_io(std::uint64_t bytes, std::uint64_t syscalls) noexcept
+{
+    if constexpr(enabled) {
+        detail::add_io(bytes, syscalls);
+    }
+}
+} // namespace identy::trace
+
+#endif
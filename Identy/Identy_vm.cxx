@@ -1,5 +1,7 @@
 #include "Identy_pch.hxx"
 
+#include "Identy_strings.hxx"
+#include "Identy_trace.hxx"
 #include "Identy_vm.hxx"
 
 #include "Platform/Identy_platform_vm.hxx"
@@ -71,32 +73,6 @@ constexpr std::uint32_t SMBIOS_type_system_manufacturer = 1;
 constexpr std::ptrdiff_t SMBIOS_system_manufacturer_offset = 4;
 } // namespace
 
-namespace
-{
-constexpr char ctolower(char c)
-{
-    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
-}
-
-constexpr bool char_equal_icase(char a, char b) noexcept
-{
-    return ctolower(static_cast<unsigned char>(a)) == ctolower(static_cast<unsigned char>(b));
-}
-
-constexpr bool contains_icase(std::string_view string, std::string_view substring) noexcept
-{
-    if(substring.empty()) {
-        return true;
-    }
-    if(substring.size() > string.size()) {
-        return false;
-    }
-
-    auto it = std::search(string.begin(), string.end(), substring.begin(), substring.end(), char_equal_icase);
-    return it != string.end();
-}
-} // namespace
-
 namespace
 {
 void check_network_adapters(identy::vm::HeuristicVerdict& verdict)
@@ -116,7 +92,7 @@ void check_network_adapters(identy::vm::HeuristicVerdict& verdict)
         std::string_view desc { adapter.description };
 
         auto is_virtual = std::ranges::any_of(known_vm_network_adapters, [desc](std::string_view key) {
-            return contains_icase(desc, key);
+            return identy::strings::contains_icase(desc, key);
         });
 
         if(is_virtual) {
@@ -244,7 +220,7 @@ void check_drive(const identy::PhysicalDriveInfo& drive, identy::vm::HeuristicVe
     auto full_model_name = drive.vendor_id + " " + drive.product_id;
 
     if(std::ranges::any_of(known_vm_drives_products, [&full_model_name](std::string_view product) {
-           return contains_icase(full_model_name, product);
+           return identy::strings::contains_icase(full_model_name, product);
        })) {
         verdict.detections.push_back(identy::vm::VMFlags::Storage_ProductIdKnownVM);
         ++product_id_known_vm_count;
@@ -254,7 +230,7 @@ void check_drive(const identy::PhysicalDriveInfo& drive, identy::vm::HeuristicVe
         verdict.detections.push_back(identy::vm::VMFlags::Storage_BusTypeIsVirtual);
     }
 
-    if(drive.serial.empty() || drive.serial.find_first_not_of(drive.serial[0]) == std::string_view::npos) {
+    if(drive.serial.empty() || identy::strings::all_same(drive.serial)) {
         verdict.detections.push_back(identy::vm::VMFlags::Storage_SuspiciousSerial);
     }
 
@@ -273,23 +249,34 @@ identy::vm::HeuristicVerdict check_mb_common(const MB& mb)
 {
     identy::vm::HeuristicVerdict verdict;
 
-    if(is_hvci(mb.cpu, mb.smbios)) {
-        verdict.detections.push_back(identy::vm::VMFlags::Platform_HyperVIsolation);
-    }
-    else {
-        if(mb.cpu.hypervisor_bit) {
-            verdict.detections.push_back(identy::vm::VMFlags::Cpu_Hypervisor_bit);
+    {
+        identy::trace::Span span(identy::trace::Phase::VmCheckCpu);
+
+        if(is_hvci(mb.cpu, mb.smbios)) {
+            verdict.detections.push_back(identy::vm::VMFlags::Platform_HyperVIsolation);
         }
+        else {
+            if(mb.cpu.hypervisor_bit) {
+                verdict.detections.push_back(identy::vm::VMFlags::Cpu_Hypervisor_bit);
+            }
 
-        if(std::ranges::any_of(known_hypervisor_signatures, [&mb](const std::string& sig) {
-               return mb.cpu.hypervisor_signature.find(sig) != std::string::npos;
-           })) {
-            verdict.detections.push_back(identy::vm::VMFlags::Cpu_Hypervisor_signature);
+            if(std::ranges::any_of(known_hypervisor_signatures, [&mb](const std::string& sig) {
+                   return mb.cpu.hypervisor_signature.find(sig) != std::string::npos;
+               })) {
+                verdict.detections.push_back(identy::vm::VMFlags::Cpu_Hypervisor_signature);
+            }
         }
     }
 
-    check_smbios(mb.smbios, verdict);
-    check_network_adapters(verdict);
+    {
+        identy::trace::Span span(identy::trace::Phase::VmCheckSmbios);
+        check_smbios(mb.smbios, verdict);
+    }
+
+    {
+        identy::trace::Span span(identy::trace::Phase::VmCheckNetwork);
+        check_network_adapters(verdict);
+    }
 
     return verdict;
 }
@@ -298,6 +285,8 @@ identy::vm::HeuristicVerdict check_mb_common(const MB& mb)
 template<identy::vm::WeightPolicy Policy>
 identy::vm::HeuristicVerdict identy::vm::DefaultHeuristic<Policy>::operator()(const Motherboard& mb) const
 {
+    trace::Span span(trace::Phase::VmAnalyze);
+
     auto verdict = check_mb_common(mb);
     verdict.confidence = detail::calculate_confidence<Policy>(verdict.detections);
 
@@ -307,8 +296,12 @@ identy::vm::HeuristicVerdict identy::vm::DefaultHeuristic<Policy>::operator()(co
 template<identy::vm::WeightPolicy Policy>
 identy::vm::HeuristicVerdict identy::vm::DefaultHeuristicEx<Policy>::operator()(const MotherboardEx& mb) const
 {
+    trace::Span span(trace::Phase::VmAnalyze);
+
     auto verdict = check_mb_common(mb);
 
+    trace::Span drives_span(trace::Phase::VmCheckDrives);
+
     int product_vm_count {};
     for(auto& disk : mb.drives) {
         check_drive(disk, verdict, product_vm_count);
@@ -31,9 +31,11 @@
 #define UNC_IDENTY_VM_H
 
 #include <concepts>
+#include <span>
 #include <type_traits>
 #include <vector>
 
+#include "Identy_executor.hxx"
 #include "Identy_hwid.hxx"
 
 namespace identy::vm
@@ -483,6 +485,25 @@ HeuristicVerdict analyze_full(const Motherboard& mb);
  */
 template<HeuristicEx Heuristic = DefaultHeuristicEx<>>
 HeuristicVerdict analyze_full(const MotherboardEx& mb);
+
+/**
+ * @brief Analyzes many snapshots concurrently
+ *
+ * Equivalent to calling analyze_full() on every element, with the work
+ * spread over an executor (see Identy_executor.hxx). Checks that read the
+ * running system, such as the network adapter scan, see the caller's
+ * hardware source on every worker.
+ *
+ * @param boards Snapshots to analyze
+ * @param executor Executor running the chunks, the built-in pool by default
+ * @return One verdict per snapshot, in input order
+ */
+template<Heuristic Heuristic = DefaultHeuristic<>>
+std::vector<HeuristicVerdict> analyze_batch(std::span<const Motherboard> boards, exec::ExecutorRef executor = exec::default_executor());
+
+/** @copydoc analyze_batch(std::span<const Motherboard>, exec::ExecutorRef) */
+template<HeuristicEx Heuristic = DefaultHeuristicEx<>>
+std::vector<HeuristicVerdict> analyze_batch(std::span<const MotherboardEx> boards, exec::ExecutorRef executor = exec::default_executor());
 } // namespace identy::vm
 
 template<identy::vm::Heuristic Heuristic>
@@ -509,4 +530,38 @@ identy::vm::HeuristicVerdict identy::vm::analyze_full(const MotherboardEx& mb)
     return Heuristic {}(mb);
 }
 
+template<identy::vm::Heuristic Heuristic>
+std::vector<identy::vm::HeuristicVerdict> identy::vm::analyze_batch(std::span<const Motherboard> boards, exec::ExecutorRef executor)
+{
+    std::vector<HeuristicVerdict> verdicts(boards.size());
+
+    exec::parallel_for(
+        boards.size(),
+        [&boards, &verdicts](std::size_t begin, std::size_t end) {
+            for(auto i = begin; i < end; ++i) {
+                verdicts[i] = Heuristic {}(boards[i]);
+            }
+        },
+        executor);
+
+    return verdicts;
+}
+
+template<identy::vm::HeuristicEx Heuristic>
+std::vector<identy::vm::HeuristicVerdict> identy::vm::analyze_batch(std::span<const MotherboardEx> boards, exec::ExecutorRef executor)
+{
+    std::vector<HeuristicVerdict> verdicts(boards.size());
+
+    exec::parallel_for(
+        boards.size(),
+        [&boards, &verdicts](std::size_t begin, std::size_t end) {
+            for(auto i = begin; i < end; ++i) {
+                verdicts[i] = Heuristic {}(boards[i]);
+            }
+        },
+        executor);
+
+    return verdicts;
+}
+
 #endif
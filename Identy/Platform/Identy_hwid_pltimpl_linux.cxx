@@ -3,83 +3,80 @@
 #include "../Identy_pch.hxx"
 
 #include "../Identy_strings.hxx"
+#include "../Identy_trace.hxx"
 
 #include "Identy_platform_hwid.hxx"
+#include "Identy_platform_source.hxx"
+
+#include <unordered_map>
 
 namespace
 {
-std::optional<std::array<identy::byte, 16>> get_smbios_uuid_sysfs(std::string_view uuid_str)
+// From SMBIOS 2.6 on the kernel prints the first three UUID fields
+// little-endian (%pUl), while the table and the fingerprint keep the raw
+// byte order
+void uuid_to_table_order(std::array<identy::byte, 16>& uuid) noexcept
 {
-    if(uuid_str.size() < 32) {
-        return std::nullopt;
-    }
-
-    std::array<identy::byte, 16> uuid;
-
-    std::size_t byte_index { 0 };
-
-    for(std::size_t i { 0 }; i < uuid_str.size() && byte_index < 16; ++i) {
-        if(uuid_str[i] == '-') {
-            continue;
-        }
-
-        if(i + 1 >= uuid_str.size()) {
-            break;
-        }
-
-        char byte_hex[3] = { uuid_str[i], uuid_str[i + 1], 0 };
-
-        identy::byte value { 0 };
+    std::reverse(uuid.begin(), uuid.begin() + 4);
+    std::reverse(uuid.begin() + 4, uuid.begin() + 6);
+    std::reverse(uuid.begin() + 6, uuid.begin() + 8);
+}
+} // namespace
 
-        auto [ptr, ec] = std::from_chars(byte_hex, byte_hex + 2, value, 16);
+namespace
+{
+const std::filesystem::path dmi_id_path = "/sys/class/dmi/id";
+const std::filesystem::path dmi_table_path = "/sys/firmware/dmi/tables/DMI";
+const std::filesystem::path dmi_entry_point_path = "/sys/firmware/dmi/tables/smbios_entry_point";
 
-        if(ec == std::errc()) {
-            uuid[byte_index++] = value;
-            i++;
-        }
-        {
-            return std::nullopt;
-        }
+std::string sysfs_value(const std::optional<std::vector<identy::byte>>& data)
+{
+    if(!data.has_value()) {
+        return "";
     }
 
-    if(byte_index != 16) {
-        return std::nullopt;
-    }
+    std::string_view value { reinterpret_cast<const char*>(data->data()), data->size() };
+    value = value.substr(0, value.find('\n'));
 
-    return uuid;
+    return std::string(identy::strings::trim_whitespace(value));
 }
-} // namespace
 
-namespace
-{
-void try_read_sysfs_uuid(identy::SMBIOS_RawData& result)
+std::string read_sysfs_value(const std::filesystem::path& path)
 {
-    const std::filesystem::path dmi_id_path = "/sys/class/dmi/id";
-
-    if(!std::filesystem::exists(dmi_id_path)) {
-        return;
-    }
+    return sysfs_value(identy::platform::source().read_file(path));
+}
 
-    std::ifstream uuid_file(dmi_id_path / "product_uuid");
+std::string planned_sysfs_value(std::atomic<identy::platform::Probe>& probe, const std::filesystem::path& path)
+{
+    return sysfs_value(identy::platform::read_planned(probe, path));
+}
 
-    std::string uuid_string;
+void try_read_sysfs_uuid(identy::SMBIOS_RawData& result, identy::platform::AccessPlan& plan)
+{
+    auto version_string = planned_sysfs_value(plan.version_attribute, dmi_id_path / "smbios_version");
 
-    if(uuid_file >> uuid_string) {
-        auto trimmed = identy::strings::trim_whitespace(uuid_string);
-        result.fallback_uid = get_smbios_uuid_sysfs(trimmed);
+    size_t dot_pos = version_string.find('.');
+    if(dot_pos != std::string::npos) {
+        std::from_chars(version_string.data(), version_string.data() + dot_pos, result.major_version);
+        std::from_chars(version_string.data() + dot_pos + 1, version_string.data() + version_string.size(), result.minor_version);
     }
 
-    std::ifstream version_file(dmi_id_path / "smbios_version");
+    auto uuid_string = planned_sysfs_value(plan.uuid_attribute, dmi_id_path / "product_uuid");
 
-    std::string version_string;
+    if(!uuid_string.empty()) {
+        result.fallback_uid = identy::strings::parse_uuid(uuid_string);
 
-    if(version_file >> version_string) {
-        size_t dot_pos = version_string.find('.');
-        if(dot_pos != std::string::npos) {
-            std::from_chars(version_string.data(), version_string.data() + dot_pos, result.major_version);
-            std::from_chars(version_string.data() + dot_pos + 1, version_string.data() + version_string.size(), result.minor_version);
+        bool unknown_version = result.major_version == 0;
+        bool little_endian = result.major_version > 2 || (result.major_version == 2 && result.minor_version >= 6);
+
+        if(result.fallback_uid.has_value() && (unknown_version || little_endian)) {
+            uuid_to_table_order(*result.fallback_uid);
         }
     }
+
+    if(result.fallback_uid.has_value() || result.major_version != 0) {
+        result.tier = identy::SmbiosTier::Attributes;
+    }
 }
 } // namespace
 
@@ -127,79 +124,115 @@ void read_smbios_versions(identy::SMBIOS_RawData& result, const std::vector<iden
     }
 }
 
-identy::SMBIOS_RawData get_smbios_linux()
+identy::SMBIOS_RawData get_smbios_linux(identy::platform::AccessPlan& plan)
 {
-    std::ifstream file("/sys/firmware/dmi/tables/DMI", std::ios::binary | std::ios::ate);
     identy::SMBIOS_RawData result;
 
-    if(file.is_open()) {
-        auto size = file.tellg();
-        file.seekg(0, std::ios::beg);
-
-        result.table_data.resize(static_cast<std::size_t>(size));
+    auto table = identy::platform::read_planned(plan.dmi_table, dmi_table_path);
 
-        file.read(reinterpret_cast<char*>(result.table_data.data()), size);
+    if(table.has_value()) {
+        result.table_data = std::move(*table);
+        result.tier = identy::SmbiosTier::Table;
 
         // Read entry point for version info
-        std::ifstream entry_file("/sys/firmware/dmi/tables/smbios_entry_point", std::ios::binary | std::ios::ate);
-        if(entry_file.is_open()) {
-            auto entry_size = entry_file.tellg();
-            entry_file.seekg(0);
-
-            std::vector<identy::byte> entry_buffer(static_cast<std::size_t>(entry_size));
-            entry_file.read(reinterpret_cast<char*>(entry_buffer.data()), entry_size);
-
-            read_smbios_versions(result, entry_buffer);
+        auto entry_buffer = identy::platform::read_planned(plan.entry_point, dmi_entry_point_path);
+        if(entry_buffer.has_value()) {
+            read_smbios_versions(result, *entry_buffer);
         }
     }
     else {
-        try_read_sysfs_uuid(result);
+        try_read_sysfs_uuid(result, plan);
     }
 
     return result;
 }
 
-std::string read_sysfs_value(const std::filesystem::path& path)
+/**
+ * @brief Multipath map holding a block device, e.g. "dm-3"; empty if none
+ *
+ * Every path of a LUN lists the device-mapper map assembled over it in
+ * holders/. Maps of other targets (LVM, crypt) have a different dm uuid
+ * prefix and do not group anything. @p maps caches the verdict per map.
+ */
+std::string multipath_holder(identy::platform::HardwareSource& source, const std::filesystem::path& block_path,
+    const std::string& device, std::unordered_map<std::string, bool>& maps)
 {
-    namespace fs = std::filesystem;
-
-    if(!fs::exists(path))
-        return "";
+    auto holders = source.list_dir(block_path / device / "holders");
+    if(!holders.has_value()) {
+        return {};
+    }
 
-    std::ifstream file(path);
-    std::string value;
-    std::getline(file, value);
+    for(const auto& holder : *holders) {
+        auto [it, inserted] = maps.try_emplace(holder, false);
+        if(inserted) {
+            it->second = read_sysfs_value(block_path / holder / "dm" / "uuid").starts_with("mpath-");
+        }
 
-    value = identy::strings::trim_whitespace(value);
+        if(it->second) {
+            return holder;
+        }
+    }
 
-    return value;
+    return {};
 }
 
 std::vector<identy::PhysicalDriveInfo> list_drives_linux()
 {
+    auto& source = identy::platform::source();
+
+    const std::filesystem::path block_path = "/sys/block";
+
+    auto devices = source.list_dir(block_path);
+
+    if(!devices.has_value()) {
+        return {};
+    }
+
     std::vector<identy::PhysicalDriveInfo> drive_infos;
 
-    for(const auto& entry : std::filesystem::directory_iterator("/sys/block")) {
-        auto device = entry.path().filename().string();
+    // Paths of one LUN share a multipath map, which maps to the drive
+    // reported for the first path. A WWID alone does not group: disks
+    // without a map that report the same WWID stay separate drives
+    std::unordered_map<std::string, bool> multipath_maps;
+    std::unordered_map<std::string, std::size_t> luns;
 
+    for(const auto& device : *devices) {
         if(device.starts_with("loop") || device.starts_with("ram") || device.starts_with("dm-")) {
             continue;
         }
 
+        bool nvme = device.starts_with("nvme");
+        if(!nvme && !device.starts_with("sd")) {
+            continue;
+        }
+
+        identy::trace::Span span(identy::trace::Phase::Drive, device);
+
+        auto holder = multipath_holder(source, block_path, device, multipath_maps);
+        if(!holder.empty()) {
+            if(auto lun = luns.find(holder); lun != luns.end()) {
+                // further path of a known LUN: nothing else to read
+                ++drive_infos[lun->second].path_count;
+                continue;
+            }
+        }
+
+        auto device_path = block_path / device;
+
         identy::PhysicalDriveInfo info;
 
-        if(device.starts_with("nvme")) {
+        if(nvme) {
             info.bus_type = identy::PhysicalDriveInfo::NMVe;
 
-            info.serial = read_sysfs_value(entry.path() / "serial");
+            info.serial = read_sysfs_value(device_path / "serial");
         }
-        else if(device.starts_with("sd")) {
-            auto subsystem_path = entry.path() / "device" / "subsystem";
+        else {
+            auto subsystem_path = device_path / "device" / "subsystem";
 
-            if(std::filesystem::exists(subsystem_path)) {
-                auto target = std::filesystem::read_symlink(subsystem_path);
+            auto target = source.exists(subsystem_path) ? source.read_link(subsystem_path) : std::nullopt;
 
-                auto subsystem = target.filename();
+            if(target.has_value()) {
+                auto subsystem = target->filename();
 
                 if(subsystem == "scsi" || subsystem == "ata") {
                     info.bus_type = identy::PhysicalDriveInfo::SATA;
@@ -215,14 +248,15 @@ std::vector<identy::PhysicalDriveInfo> list_drives_linux()
                 info.bus_type = identy::PhysicalDriveInfo::Other;
             }
 
-            info.serial = read_sysfs_value(entry.path() / "device" / "serial");
+            info.serial = read_sysfs_value(device_path / "device" / "serial");
 
             if(info.serial.empty()) {
-                info.serial = read_sysfs_value(entry.path() / "device" / "vpd_pg80");
+                info.serial = read_sysfs_value(device_path / "device" / "vpd_pg80");
             }
         }
-        else {
-            continue;
+
+        if(!holder.empty()) {
+            luns.try_emplace(holder, drive_infos.size());
         }
 
         drive_infos.push_back(info);
@@ -236,9 +270,25 @@ std::vector<identy::PhysicalDriveInfo> list_drives_linux()
 namespace identy::platform
 {
 
-SMBIOS_RawData get_smbios()
+void probe_smbios(AccessPlan& plan)
+{
+    const std::pair<std::atomic<Probe>*, std::filesystem::path> sources[] = {
+        { &plan.dmi_table, dmi_table_path },
+        { &plan.entry_point, dmi_entry_point_path },
+        { &plan.uuid_attribute, dmi_id_path / "product_uuid" },
+        { &plan.version_attribute, dmi_id_path / "smbios_version" },
+    };
+
+    for(const auto& [probe, path] : sources) {
+        if(probe->load(std::memory_order_relaxed) == Probe::Unknown) {
+            read_planned(*probe, path);
+        }
+    }
+}
+
+SMBIOS_RawData get_smbios(AccessPlan& plan)
 {
-    return get_smbios_linux();
+    return get_smbios_linux(plan);
 }
 
 std::vector<PhysicalDriveInfo> list_drives()
@@ -3,11 +3,13 @@
 #include "../Identy_pch.hxx"
 
 #include "../Identy_strings.hxx"
+#include "../Identy_trace.hxx"
 #include "../Identy_types.hxx"
 
 #include "../Identy_nvme_support.hxx"
 
 #include "Identy_platform_hwid.hxx"
+#include "Identy_platform_source.hxx"
 
 namespace identy
 {
@@ -41,17 +43,33 @@ constexpr std::size_t RSMB_dmi_revision_offset = 3;
 constexpr std::size_t RSMB_length_offset = 4;
 constexpr std::size_t RSMB_table_data_offset = 8;
 
-identy::SMBIOS_RawData get_smbios_win32()
+identy::SMBIOS_RawData get_smbios_win32(identy::platform::AccessPlan& plan)
 {
-    identy::dword size = GetSystemFirmwareTable('RSMB', 0, nullptr, 0);
-    if(size == 0) {
+    using identy::platform::Probe;
+
+    // GetSystemFirmwareTable needs no privileges; the version comes with the
+    // table and there are no DMI attributes
+    plan.uuid_attribute.store(Probe::Unavailable, std::memory_order_relaxed);
+    plan.version_attribute.store(Probe::Unavailable, std::memory_order_relaxed);
+
+    if(plan.dmi_table.load(std::memory_order_relaxed) == Probe::Unavailable) {
+        return {};
+    }
+
+    auto table = identy::platform::source().firmware_table('RSMB', 0);
+    bool available = table.has_value() && !table->empty();
+
+    plan.dmi_table.store(available ? Probe::Readable : Probe::Unavailable, std::memory_order_relaxed);
+    plan.entry_point.store(available ? Probe::Readable : Probe::Unavailable, std::memory_order_relaxed);
+
+    if(!available) {
         return {};
     }
 
-    std::vector<identy::byte> buffer(size);
-    GetSystemFirmwareTable('RSMB', 0, buffer.data(), size);
+    const std::vector<identy::byte>& buffer = *table;
 
     identy::SMBIOS_RawData result;
+    result.tier = identy::SmbiosTier::Table;
 
     if(buffer.size() >= RSMB_table_data_offset) {
         result.used_20_calling_method = buffer[RSMB_used_20_offset];
@@ -100,6 +118,8 @@ std::string get_nvme_serial(HANDLE h_device)
         static_cast<identy::dword>(input_buffer.size()), output_buffer.data(), static_cast<identy::dword>(output_buffer.size()),
         &bytes_returned, nullptr);
 
+    identy::trace::count_io(bytes_returned, 1);
+
     if(!result) {
         return {};
     }
@@ -130,6 +150,8 @@ std::optional<identy::PhysicalDriveInfo> get_drive_info(std::string_view drive_n
     auto path = std::format(R"(\\.\{})", drive_name);
 
     HANDLE raw_handle = CreateFileA(path.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
+    identy::trace::count_io(0, 1);
+
     if(raw_handle == INVALID_HANDLE_VALUE) {
         return std::nullopt;
     }
@@ -145,8 +167,12 @@ std::optional<identy::PhysicalDriveInfo> get_drive_info(std::string_view drive_n
     std::vector<identy::byte> buffer(1024);
     identy::dword bytes_returned = 0;
 
-    if(!DeviceIoControl(h_device.get(), IOCTL_STORAGE_QUERY_PROPERTY, &query, sizeof(query), buffer.data(),
-           static_cast<identy::dword>(buffer.size()), &bytes_returned, nullptr)) {
+    auto queried = DeviceIoControl(h_device.get(), IOCTL_STORAGE_QUERY_PROPERTY, &query, sizeof(query), buffer.data(),
+        static_cast<identy::dword>(buffer.size()), &bytes_returned, nullptr);
+
+    identy::trace::count_io(bytes_returned, 1);
+
+    if(!queried) {
         return std::nullopt;
     }
 
@@ -236,6 +262,8 @@ std::vector<identy::PhysicalDriveInfo> list_drives_win32()
 
     std::vector<identy::PhysicalDriveInfo> drive_infos;
     for(auto& drive_name : drives) {
+        identy::trace::Span span(identy::trace::Phase::Drive, drive_name);
+
         auto result = get_drive_info(drive_name);
         if(result.has_value()) {
             drive_infos.push_back(std::move(result.value()));
@@ -250,9 +278,16 @@ std::vector<identy::PhysicalDriveInfo> list_drives_win32()
 namespace identy::platform
 {
 
-SMBIOS_RawData get_smbios()
+void probe_smbios(AccessPlan& plan)
+{
+    if(plan.dmi_table.load(std::memory_order_relaxed) == Probe::Unknown) {
+        get_smbios_win32(plan);
+    }
+}
+
+SMBIOS_RawData get_smbios(AccessPlan& plan)
 {
-    return get_smbios_win32();
+    return get_smbios_win32(plan);
 }
 
 std::vector<PhysicalDriveInfo> list_drives()
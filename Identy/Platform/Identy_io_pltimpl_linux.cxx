@@ -0,0 +1,63 @@
+#ifdef IDENTY_LINUX
+
+#include "../Identy_pch.hxx"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Identy_platform_io.hxx"
+
+namespace identy::platform
+{
+
+std::unique_ptr<MappedFile> MappedFile::open(const std::filesystem::path& path, bool sequential)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        return nullptr;
+    }
+
+    struct stat info {};
+    if(::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    std::unique_ptr<MappedFile> file(new MappedFile());
+
+    if(info.st_size == 0) {
+        ::close(fd);
+        return file;
+    }
+
+    void* address = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+
+    if(address == MAP_FAILED) {
+        return nullptr;
+    }
+
+    if(sequential) {
+        ::madvise(address, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+    }
+
+    file->m_data = static_cast<const byte*>(address);
+    file->m_size = static_cast<std::size_t>(info.st_size);
+
+    return file;
+}
+
+MappedFile::~MappedFile()
+{
+    if(m_data != nullptr) {
+        ::munmap(const_cast<byte*>(m_data), m_size);
+    }
+}
+
+} // namespace identy::platform
+
+#endif // IDENTY_LINUX
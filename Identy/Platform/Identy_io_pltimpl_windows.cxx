@@ -0,0 +1,69 @@
+#ifdef IDENTY_WIN32
+
+#include "../Identy_pch.hxx"
+
+#include "../Identy_types.hxx"
+
+#include "Identy_platform_io.hxx"
+
+namespace identy::platform
+{
+
+std::unique_ptr<MappedFile> MappedFile::open(const std::filesystem::path& path, bool sequential)
+{
+    dword flags = sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL;
+
+    HANDLE file_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+    if(file_handle == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+
+    LARGE_INTEGER size {};
+    if(!GetFileSizeEx(file_handle, &size)) {
+        CloseHandle(file_handle);
+        return nullptr;
+    }
+
+    std::unique_ptr<MappedFile> file(new MappedFile());
+    file->m_file = file_handle;
+
+    if(size.QuadPart == 0) {
+        return file;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(mapping == nullptr) {
+        return nullptr;
+    }
+
+    file->m_mapping = mapping;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if(view == nullptr) {
+        return nullptr;
+    }
+
+    file->m_data = static_cast<const byte*>(view);
+    file->m_size = static_cast<std::size_t>(size.QuadPart);
+
+    return file;
+}
+
+MappedFile::~MappedFile()
+{
+    if(m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+    }
+
+    if(m_mapping != nullptr) {
+        CloseHandle(m_mapping);
+    }
+
+    if(m_file != nullptr) {
+        CloseHandle(m_file);
+    }
+}
+
+} // namespace identy::platform
+
+#endif // IDENTY_WIN32
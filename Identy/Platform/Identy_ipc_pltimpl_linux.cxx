@@ -0,0 +1,215 @@
+#ifdef IDENTY_LINUX
+
+#include "../Identy_pch.hxx"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Identy_platform_ipc.hxx"
+
+namespace
+{
+constexpr int socket_timeout_ms = 2000;
+
+class ScopedFd final
+{
+public:
+    explicit ScopedFd(int fd) noexcept
+        : m_fd(fd)
+    {
+    }
+
+    ~ScopedFd()
+    {
+        if(m_fd >= 0) {
+            ::close(m_fd);
+        }
+    }
+
+    ScopedFd(const ScopedFd&) = delete;
+    ScopedFd& operator=(const ScopedFd&) = delete;
+
+    int get() const noexcept
+    {
+        return m_fd;
+    }
+
+private:
+    int m_fd;
+};
+
+bool wait_for(int fd, short events) noexcept
+{
+    pollfd entry { fd, events, 0 };
+
+    while(true) {
+        int ready = ::poll(&entry, 1, socket_timeout_ms);
+
+        if(ready > 0) {
+            return true;
+        }
+        if(ready == 0 || errno != EINTR) {
+            return false;
+        }
+    }
+}
+} // namespace
+
+namespace identy::platform
+{
+
+std::unique_ptr<SharedMemory> SharedMemory::create(std::string_view name, std::size_t size)
+{
+    std::string owned_name(name);
+
+    // a segment left under this name may be held open for writing by another
+    // user; drop the name and insist on a fresh segment only this process can
+    // write. A name owned by someone else cannot be unlinked and fails below
+    ::shm_unlink(owned_name.c_str());
+
+    int fd = ::shm_open(owned_name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if(fd < 0) {
+        return nullptr;
+    }
+
+    ScopedFd guard(fd);
+
+    // shm_open honours the umask, readers need the segment world-readable
+    if(::fchmod(fd, 0644) != 0) {
+        ::shm_unlink(owned_name.c_str());
+        return nullptr;
+    }
+
+    if(::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::shm_unlink(owned_name.c_str());
+        return nullptr;
+    }
+
+    void* address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(address == MAP_FAILED) {
+        ::shm_unlink(owned_name.c_str());
+        return nullptr;
+    }
+
+    std::unique_ptr<SharedMemory> memory(new SharedMemory());
+    memory->m_data = address;
+    memory->m_size = size;
+    memory->m_owned_name = std::move(owned_name);
+
+    return memory;
+}
+
+std::unique_ptr<SharedMemory> SharedMemory::open(std::string_view name, std::size_t size)
+{
+    std::string path(name);
+
+    int fd = ::shm_open(path.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if(fd < 0) {
+        return nullptr;
+    }
+
+    ScopedFd guard(fd);
+
+    struct stat info {};
+    if(::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < size) {
+        return nullptr;
+    }
+
+    void* address = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if(address == MAP_FAILED) {
+        return nullptr;
+    }
+
+    std::unique_ptr<SharedMemory> memory(new SharedMemory());
+    memory->m_data = address;
+    memory->m_size = size;
+
+    return memory;
+}
+
+SharedMemory::~SharedMemory()
+{
+    if(m_data != nullptr) {
+        ::munmap(m_data, m_size);
+    }
+
+    if(!m_owned_name.empty()) {
+        ::shm_unlink(m_owned_name.c_str());
+    }
+}
+
+std::optional<std::vector<byte>> local_socket_request(const std::filesystem::path& path, std::span<const byte> request,
+    std::size_t max_reply)
+{
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+
+    const auto& native = path.native();
+    if(native.size() >= sizeof(address.sun_path)) {
+        return std::nullopt;
+    }
+    std::memcpy(address.sun_path, native.c_str(), native.size() + 1);
+
+    ScopedFd fd(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+    if(fd.get() < 0) {
+        return std::nullopt;
+    }
+
+    if(::connect(fd.get(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        return std::nullopt;
+    }
+
+    std::size_t sent = 0;
+    while(sent < request.size()) {
+        if(!wait_for(fd.get(), POLLOUT)) {
+            return std::nullopt;
+        }
+
+        auto count = ::send(fd.get(), request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if(count < 0 && errno == EINTR) {
+            continue;
+        }
+        if(count <= 0) {
+            return std::nullopt;
+        }
+        sent += static_cast<std::size_t>(count);
+    }
+
+    ::shutdown(fd.get(), SHUT_WR);
+
+    std::vector<byte> reply;
+    std::array<byte, 4096> chunk {};
+
+    while(true) {
+        if(!wait_for(fd.get(), POLLIN)) {
+            return std::nullopt;
+        }
+
+        auto count = ::recv(fd.get(), chunk.data(), chunk.size(), 0);
+        if(count < 0 && errno == EINTR) {
+            continue;
+        }
+        if(count < 0) {
+            return std::nullopt;
+        }
+        if(count == 0) {
+            break;
+        }
+
+        if(reply.size() + static_cast<std::size_t>(count) > max_reply) {
+            return std::nullopt;
+        }
+        reply.insert(reply.end(), chunk.begin(), chunk.begin() + count);
+    }
+
+    return reply;
+}
+
+} // namespace identy::platform
+
+#endif // IDENTY_LINUX
@@ -0,0 +1,31 @@
+#ifdef IDENTY_WIN32
+
+#include "../Identy_pch.hxx"
+
+#include "Identy_platform_ipc.hxx"
+
+namespace identy::platform
+{
+
+// identyd is Linux only; clients on Windows always fall back to collecting locally
+
+std::unique_ptr<SharedMemory> SharedMemory::create(std::string_view, std::size_t)
+{
+    return nullptr;
+}
+
+std::unique_ptr<SharedMemory> SharedMemory::open(std::string_view, std::size_t)
+{
+    return nullptr;
+}
+
+SharedMemory::~SharedMemory() = default;
+
+std::optional<std::vector<byte>> local_socket_request(const std::filesystem::path&, std::span<const byte>, std::size_t)
+{
+    return std::nullopt;
+}
+
+} // namespace identy::platform
+
+#endif // IDENTY_WIN32
@@ -3,6 +3,10 @@
 #ifndef UNC_IDENTY_PLATFORM_HWID_H
 #define UNC_IDENTY_PLATFORM_HWID_H
 
+#include <atomic>
+#include <filesystem>
+#include <optional>
+
 #include "../Identy_hwid.hxx"
 
 namespace identy
@@ -68,9 +72,11 @@ struct SMBIOS_RawData
 
     std::optional<std::array<identy::byte, 16>> fallback_uid;
 
+    SmbiosTier tier { SmbiosTier::None };
+
     [[nodiscard]] bool empty() const noexcept
     {
-        return table_data.empty() && !fallback_uid.has_value();
+        return table_data.empty() && !fallback_uid.has_value() && major_version == 0;
     }
 };
 
@@ -79,12 +85,78 @@ struct SMBIOS_RawData
 namespace identy::platform
 {
 
+/**
+ * @brief Outcome of the first attempt to read a source
+ */
+enum class Probe : byte {
+    Unknown,
+    Readable,
+    Unavailable
+};
+
+/**
+ * @brief Which SMBIOS sources answered, see Identy_tier.hxx
+ *
+ * Entries start Unknown and are settled by the first read. Sources marked
+ * Unavailable are not tried again while the plan lives.
+ */
+struct AccessPlan
+{
+    std::atomic<Probe> dmi_table { Probe::Unknown };
+    std::atomic<Probe> entry_point { Probe::Unknown };
+    std::atomic<Probe> uuid_attribute { Probe::Unknown };
+    std::atomic<Probe> version_attribute { Probe::Unknown };
+    std::atomic<Probe> daemon { Probe::Unknown };
+};
+
+/**
+ * @brief Plan of the live source, shared by the whole process
+ */
+AccessPlan& live_access_plan() noexcept;
+
+/**
+ * @brief Reads a file through the current source unless the plan ruled it out
+ * @param probe Plan entry of the file, settled by the read
+ */
+std::optional<std::vector<byte>> read_planned(std::atomic<Probe>& probe, const std::filesystem::path& path);
+
+/**
+ * @brief Platform-specific probing of the SMBIOS sources still Unknown
+ */
+void probe_smbios(AccessPlan& plan);
+
 /**
  * @brief Platform-specific SMBIOS retrieval
+ * @param plan Access plan consulted and updated by the reads
  * @return SMBIOS data structure, empty if retrieval failed
  */
+SMBIOS_RawData get_smbios(AccessPlan& plan);
+
+/**
+ * @brief SMBIOS retrieval with the plan of the current source
+ *
+ * The live source uses live_access_plan(); any other source a fresh plan.
+ */
 SMBIOS_RawData get_smbios();
 
+/**
+ * @brief SMBIOS of a running identyd, the Daemon tier
+ * @return Complete SMBIOS data, std::nullopt if the daemon tier is disabled,
+ *         unreachable or not better than the local sources
+ */
+std::optional<SMBIOS> query_daemon_smbios(AccessPlan& plan);
+
+/** @brief Snapshot SMBIOS of the identyd listening on a socket */
+using DaemonSmbiosQuery = std::optional<SMBIOS> (*)(const std::filesystem::path& socket);
+
+/**
+ * @brief Installs the client used by query_daemon_smbios()
+ *
+ * The client lives in Identy::io, which installs it when linked. Without it
+ * the daemon tier is unavailable and core has no dependency on io.
+ */
+void set_daemon_smbios_query(DaemonSmbiosQuery query) noexcept;
+
 /**
  * @brief Platform-specific drive enumeration
  * @return Vector of physical drive information
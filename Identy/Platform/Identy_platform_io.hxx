@@ -0,0 +1,58 @@
+#pragma once
+
+#ifndef UNC_IDENTY_PLATFORM_IO_H
+#define UNC_IDENTY_PLATFORM_IO_H
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+#include "../Identy_types.hxx"
+
+namespace identy::platform
+{
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * Thin RAII wrapper over mmap (Linux) or CreateFileMapping/MapViewOfFile
+ * (Windows). Empty files are represented by an empty mapping.
+ */
+class MappedFile final
+{
+public:
+    /**
+     * @brief Maps a file read-only
+     * @param path File to map
+     * @param sequential Hint the kernel that the mapping will be read front to back
+     * @return Mapped file, nullptr if the file cannot be opened or mapped
+     */
+    static std::unique_ptr<MappedFile> open(const std::filesystem::path& path, bool sequential);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile();
+
+    /** @brief Mapped file contents */
+    std::span<const byte> bytes() const noexcept
+    {
+        return { m_data, m_size };
+    }
+
+private:
+    MappedFile() = default;
+
+    const byte* m_data { nullptr };
+    std::size_t m_size { 0 };
+
+#ifdef IDENTY_WIN32
+    void* m_file { nullptr };
+    void* m_mapping { nullptr };
+#endif
+};
+
+} // namespace identy::platform
+
+#endif
@@ -0,0 +1,91 @@
+#pragma once
+
+#ifndef UNC_IDENTY_PLATFORM_IPC_H
+#define UNC_IDENTY_PLATFORM_IPC_H
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../Identy_types.hxx"
+
+namespace identy::platform
+{
+
+/**
+ * @brief Named shared memory segment
+ *
+ * Thin RAII wrapper over POSIX shm_open/mmap. The creator maps the segment
+ * read-write and removes the name when destroyed; readers map it read-only.
+ * Not available on Windows, where both factories return nullptr.
+ */
+class SharedMemory final
+{
+public:
+    /**
+     * @brief Creates a new segment readable by everyone
+     *
+     * Removes a segment left under @p name first, then creates the segment
+     * exclusively with mode 0644, so no other process keeps write access.
+     *
+     * @param name Segment name, starting with '/'
+     * @param size Segment size in bytes
+     * @return Writable mapping, nullptr on failure, including a name held by
+     *         another user
+     */
+    static std::unique_ptr<SharedMemory> create(std::string_view name, std::size_t size);
+
+    /**
+     * @brief Maps an existing segment read-only
+     * @param name Segment name, starting with '/'
+     * @param size Expected size; smaller segments are rejected
+     * @return Read-only mapping, nullptr if the segment does not exist or is too small
+     */
+    static std::unique_ptr<SharedMemory> open(std::string_view name, std::size_t size);
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    ~SharedMemory();
+
+    /** @brief Start of the mapping */
+    void* data() const noexcept
+    {
+        return m_data;
+    }
+
+    /** @brief Mapped size */
+    std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+private:
+    SharedMemory() = default;
+
+    void* m_data { nullptr };
+    std::size_t m_size { 0 };
+    std::string m_owned_name;
+};
+
+/**
+ * @brief Sends one request over a local stream socket and reads the reply
+ *
+ * The reply is read until the peer closes the connection.
+ *
+ * @param path Unix domain socket path
+ * @param request Request bytes
+ * @param max_reply Replies longer than this are rejected
+ * @return Reply, std::nullopt on connection or I/O errors and timeouts
+ */
+std::optional<std::vector<byte>> local_socket_request(const std::filesystem::path& path, std::span<const byte> request,
+    std::size_t max_reply);
+
+} // namespace identy::platform
+
+#endif
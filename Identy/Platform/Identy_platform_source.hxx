@@ -0,0 +1,115 @@
+#pragma once
+
+#ifndef UNC_IDENTY_PLATFORM_SOURCE_H
+#define UNC_IDENTY_PLATFORM_SOURCE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../Identy_hwid.hxx"
+
+namespace identy::platform
+{
+
+/**
+ * @brief Size and modification time of a file or directory
+ */
+struct FileStamp
+{
+    /** @brief Size in bytes, 0 for directories */
+    std::uint64_t size { 0 };
+
+    /** @brief Modification time in nanoseconds of the filesystem clock */
+    std::int64_t mtime_ns { 0 };
+};
+
+/**
+ * @brief Raw hardware inputs read by the collectors
+ *
+ * Every CPUID instruction, sysfs read and firmware table query made while
+ * snapshotting goes through the current source. The live source talks to the
+ * hardware; capture and replay (see Identy_capture.hxx) swap in a recording or
+ * a replaying source for the calling thread.
+ */
+class HardwareSource
+{
+public:
+    virtual ~HardwareSource() = default;
+
+    /**
+     * @brief Executes CPUID
+     * @param registers Receives EAX, EBX, ECX, EDX
+     * @param leaf Leaf (EAX input)
+     * @param subleaf Subleaf (ECX input)
+     */
+    virtual void cpuid(register_32 registers[4], register_32 leaf, register_32 subleaf) = 0;
+
+    /**
+     * @brief Reads a whole file
+     * @return File contents, std::nullopt if the file cannot be opened
+     */
+    virtual std::optional<std::vector<byte>> read_file(const std::filesystem::path& path) = 0;
+
+    /**
+     * @brief Lists the names of directory entries
+     * @return Entry names sorted in ascending order, std::nullopt if the
+     *         directory cannot be read
+     */
+    virtual std::optional<std::vector<std::string>> list_dir(const std::filesystem::path& path) = 0;
+
+    /**
+     * @brief Resolves a symbolic link one level
+     * @return Link target, std::nullopt if @p path is not a readable link
+     */
+    virtual std::optional<std::filesystem::path> read_link(const std::filesystem::path& path) = 0;
+
+    /** @brief Whether @p path exists */
+    virtual bool exists(const std::filesystem::path& path) = 0;
+
+    /**
+     * @brief Queries size and modification time without reading the file
+     * @return Stamp, std::nullopt if @p path does not exist
+     */
+    virtual std::optional<FileStamp> stat(const std::filesystem::path& path) = 0;
+
+    /**
+     * @brief Reads a system firmware table (GetSystemFirmwareTable on Windows)
+     * @return Table, std::nullopt if unsupported or unavailable
+     */
+    virtual std::optional<std::vector<byte>> firmware_table(dword provider, dword id) = 0;
+};
+
+/**
+ * @brief Source used by the collectors on the calling thread
+ *
+ * The live hardware unless a ScopedSource is active on this thread.
+ */
+HardwareSource& source() noexcept;
+
+/** @brief Source reading the actual hardware */
+HardwareSource& live_source() noexcept;
+
+/**
+ * @brief Replaces the source of the calling thread for its lifetime
+ *
+ * Scopes nest; the previous source is restored on destruction.
+ */
+class ScopedSource final
+{
+public:
+    explicit ScopedSource(HardwareSource& source) noexcept;
+    ~ScopedSource();
+
+    ScopedSource(const ScopedSource&) = delete;
+    ScopedSource& operator=(const ScopedSource&) = delete;
+
+private:
+    HardwareSource* m_previous;
+};
+
+} // namespace identy::platform
+
+#endif
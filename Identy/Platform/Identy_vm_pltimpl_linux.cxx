@@ -2,6 +2,7 @@
 
 #include "../Identy_pch.hxx"
 
+#include "Identy_platform_source.hxx"
 #include "Identy_platform_vm.hxx"
 
 namespace
@@ -9,13 +10,14 @@ namespace
 
 std::string read_sysfs_file(const std::filesystem::path& path)
 {
-    if(!std::filesystem::exists(path)) {
+    auto data = identy::platform::source().read_file(path);
+
+    if(!data.has_value()) {
         return {};
     }
 
-    std::ifstream file(path);
-    std::string value;
-    std::getline(file, value);
+    std::string value { reinterpret_cast<const char*>(data->data()), data->size() };
+    value.resize(std::min(value.size(), value.find('\n')));
 
     return value;
 }
@@ -26,38 +28,44 @@ std::vector<identy::platform::NetworkAdapterInfo> list_network_adapters_linux(bo
 
     const std::filesystem::path net_path = "/sys/class/net";
 
-    if(!std::filesystem::exists(net_path)) {
+    auto& source = identy::platform::source();
+
+    auto interfaces = source.exists(net_path) ? source.list_dir(net_path) : std::nullopt;
+
+    if(!interfaces.has_value()) {
         access_denied = true;
         return {};
     }
 
     std::vector<identy::platform::NetworkAdapterInfo> adapters;
 
-    for(const auto& entry : std::filesystem::directory_iterator(net_path)) {
-        auto iface_name = entry.path().filename().string();
+    for(const auto& iface_name : *interfaces) {
+        auto iface_path = net_path / iface_name;
 
         identy::platform::NetworkAdapterInfo info;
 
         // Read device type from uevent or use interface name heuristics
-        auto uevent_path = entry.path() / "device" / "uevent";
-        auto driver_path = entry.path() / "device" / "driver";
+        auto uevent_path = iface_path / "device" / "uevent";
+        auto driver_path = iface_path / "device" / "driver";
 
         // Check if it's a loopback interface
         info.is_loopback = (iface_name == "lo");
 
         // Check for tunnel interfaces
-        auto type_path = entry.path() / "type";
+        auto type_path = iface_path / "type";
         auto type_str = read_sysfs_file(type_path);
         if(!type_str.empty()) {
-            int type = std::stoi(type_str);
+            int type = 0;
+            std::from_chars(type_str.data(), type_str.data() + type_str.size(), type);
             // ARPHRD_TUNNEL = 768, ARPHRD_TUNNEL6 = 769, ARPHRD_SIT = 776, ARPHRD_IPGRE = 778
             info.is_tunnel = (type == 768 || type == 769 || type == 776 || type == 778);
         }
 
         // Try to get description from driver or device info
-        if(std::filesystem::exists(driver_path)) {
-            auto driver_target = std::filesystem::read_symlink(driver_path);
-            info.description = driver_target.filename().string();
+        if(source.exists(driver_path)) {
+            if(auto driver_target = source.read_link(driver_path)) {
+                info.description = driver_target->filename().string();
+            }
         }
 
         // If no driver info, use interface name as description
@@ -0,0 +1,100 @@
+/**
+ * @file Identy_bytes.hxx
+ * @brief Internal byte-order and checksum helpers of the on-disk formats
+ *
+ * The binary snapshot, archive, history, cache, blob store, blocklist,
+ * columnar and daemon formats are all little-endian and checksum their
+ * records with CRC-32 (IEEE 802.3, reflected). They share these helpers so
+ * the formats cannot disagree on either.
+ *
+ * @note This is an internal implementation detail and not part of the
+ *       public API.
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_DETAIL_BYTES_H
+#define UNC_IDENTY_DETAIL_BYTES_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#include "../Identy_types.hxx"
+
+namespace identy::detail
+{
+/**
+ * @brief Writes an integer as sizeof(T) little-endian bytes
+ * @param dst Destination, at least sizeof(T) bytes
+ * @param value Value to store
+ */
+template<typename T>
+void store_le(identy::byte* dst, T value) noexcept
+{
+    using U = std::make_unsigned_t<T>;
+    auto bits = static_cast<U>(value);
+
+    for(std::size_t i = 0; i < sizeof(T); ++i) {
+        dst[i] = static_cast<identy::byte>(bits >> (i * 8));
+    }
+}
+
+/**
+ * @brief Reads an integer from sizeof(T) little-endian bytes
+ * @param src Source, at least sizeof(T) bytes
+ * @return Decoded value
+ */
+template<typename T>
+T load_le(const identy::byte* src) noexcept
+{
+    using U = std::make_unsigned_t<T>;
+    U bits = 0;
+
+    for(std::size_t i = 0; i < sizeof(T); ++i) {
+        bits |= static_cast<U>(static_cast<U>(src[i]) << (i * 8));
+    }
+
+    return static_cast<T>(bits);
+}
+
+/** @brief Byte-wise CRC-32 lookup table (polynomial 0xEDB88320) */
+inline constexpr auto crc32_table = [] {
+    std::array<std::uint32_t, 256> table {};
+
+    for(std::uint32_t i = 0; i < table.size(); ++i) {
+        std::uint32_t crc = i;
+        for(int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+        table[i] = crc;
+    }
+
+    return table;
+}();
+
+/**
+ * @brief Feeds bytes into a running CRC-32
+ *
+ * Start with 0xFFFFFFFF and invert the final value, or use crc32() for a
+ * single buffer.
+ */
+inline std::uint32_t crc32_update(std::uint32_t crc, std::span<const identy::byte> data) noexcept
+{
+    for(auto b : data) {
+        crc = crc32_table[(crc ^ b) & 0xFF] ^ (crc >> 8);
+    }
+
+    return crc;
+}
+
+/** @brief CRC-32 of one buffer */
+inline std::uint32_t crc32(std::span<const identy::byte> data) noexcept
+{
+    return crc32_update(0xFFFFFFFFu, data) ^ 0xFFFFFFFFu;
+}
+} // namespace identy::detail
+
+#endif
@@ -0,0 +1,194 @@
+/**
+ * @file Identy_walk.hxx
+ * @brief Internal walkers over the fields and SMBIOS structures of a snapshot
+ *
+ * default_hash_ex() hashes, the similarity signatures sign and the
+ * cardinality sketches count the same snapshot parts. They visit them
+ * through these walkers, so a field added to the fingerprint or a change to
+ * how SMBIOS structures are split reaches all three.
+ *
+ * @note This is an internal implementation detail and not part of the
+ *       public API.
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_DETAIL_WALK_H
+#define UNC_IDENTY_DETAIL_WALK_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "../Identy_hwid.hxx"
+#include "Identy_bytes.hxx"
+
+namespace identy::detail
+{
+/** @brief splitmix64 finalizer */
+constexpr std::uint64_t mix(std::uint64_t x) noexcept
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Keyed 64-bit digest of a sequence of values
+ *
+ * Not cryptographic: it feeds the MinHash and HyperLogLog sketches, which
+ * only need well-spread values. Byte ranges are read little-endian, so a
+ * digest is the same on every host.
+ */
+class Digest
+{
+public:
+    /** @param key Separates the digests of different kinds of values */
+    explicit Digest(std::uint64_t key) noexcept
+        : m_state(mix(key))
+    {
+    }
+
+    Digest& update(std::span<const byte> data) noexcept
+    {
+        std::size_t offset = 0;
+
+        for(; offset + 8 <= data.size(); offset += 8) {
+            absorb(load_le<std::uint64_t>(data.data() + offset));
+        }
+
+        std::uint64_t tail = 0;
+        for(std::size_t i = offset; i < data.size(); ++i) {
+            tail |= static_cast<std::uint64_t>(data[i]) << ((i - offset) * 8);
+        }
+        absorb(tail ^ (static_cast<std::uint64_t>(data.size() - offset) << 56));
+        return *this;
+    }
+
+    Digest& update(std::string_view text) noexcept
+    {
+        return update(std::span<const byte>(reinterpret_cast<const byte*>(text.data()), text.size()));
+    }
+
+    Digest& update(std::uint64_t value) noexcept
+    {
+        absorb(value);
+        return *this;
+    }
+
+    std::uint64_t finish() const noexcept
+    {
+        return mix(m_state);
+    }
+
+private:
+    void absorb(std::uint64_t word) noexcept
+    {
+        m_state = std::rotl((m_state ^ word) * 0xBF58476D1CE4E5B9ull, 31);
+    }
+
+    std::uint64_t m_state;
+};
+
+/** @brief Snapshot fields default_hash_ex() covers, in hash order */
+enum class HashedField : std::uint8_t {
+    CpuVendor,
+    CpuVersion,
+    CpuBrandIndex,
+    CpuClflushLineSize,
+    CpuLogicalProcessors,
+    CpuBrandString,
+    CpuInstructionSet,
+    SmbiosVersion,
+    SmbiosUuid,
+    DriveBusType,
+    DriveDeviceName,
+    DriveSerial
+};
+
+/** @brief USB and unclassified drives come and go, so the fingerprint leaves them out */
+inline bool is_hashed_drive(const PhysicalDriveInfo& drive) noexcept
+{
+    return drive.bus_type != PhysicalDriveInfo::USB && drive.bus_type != PhysicalDriveInfo::Other;
+}
+
+/**
+ * @brief Calls fn(field, values...) for each CPU and SMBIOS field default_hash() covers
+ *
+ * Fields are visited in hash order; a field made of several members passes
+ * them in the order they are hashed.
+ */
+template<typename Fn>
+void for_each_hashed_field(const Cpu& cpu, const SMBIOS& smbios, Fn&& fn)
+{
+    fn(HashedField::CpuVendor, cpu.vendor);
+    fn(HashedField::CpuVersion, cpu.version);
+    fn(HashedField::CpuBrandIndex, cpu.brand_index);
+    fn(HashedField::CpuClflushLineSize, cpu.clflush_line_size);
+    fn(HashedField::CpuLogicalProcessors, cpu.logical_processors_count);
+    fn(HashedField::CpuBrandString, cpu.extended_brand_string);
+
+    const auto& isa = cpu.instruction_set;
+    fn(HashedField::CpuInstructionSet, isa.basic, isa.modern, isa.extended_modern);
+
+    byte is_20_flag = smbios.is_20_calling_used ? 1 : 0;
+    fn(HashedField::SmbiosVersion, is_20_flag, smbios.major_version, smbios.minor_version, smbios.dmi_version);
+    fn(HashedField::SmbiosUuid, smbios.uuid);
+}
+
+/** @brief As above, followed by the bus type, device name and serial of each hashed drive */
+template<typename Fn>
+void for_each_hashed_field(const MotherboardEx& board, Fn&& fn)
+{
+    for_each_hashed_field(board.cpu, board.smbios, fn);
+
+    for(const auto& drive : board.drives) {
+        if(!is_hashed_drive(drive)) {
+            continue;
+        }
+
+        fn(HashedField::DriveBusType, drive.bus_type);
+        fn(HashedField::DriveDeviceName, drive.device_name);
+        fn(HashedField::DriveSerial, drive.serial);
+    }
+}
+
+/**
+ * @brief Calls fn(structure) for each structure of a raw SMBIOS table
+ *
+ * A structure is its formatted area plus its string set, up to and
+ * including the double null. The walk stops at the first structure that is
+ * too short or runs past the table.
+ */
+template<typename Fn>
+void for_each_structure(std::span<const byte> table, Fn&& fn)
+{
+    std::size_t offset = 0;
+
+    while(offset + sizeof(SMBIOS_Header) <= table.size()) {
+        auto length = table[offset + 1];
+        if(length < sizeof(SMBIOS_Header)) {
+            break;
+        }
+
+        // strings block is terminated by a double null
+        std::size_t next = offset + length;
+        while(next + 1 < table.size() && (table[next] != 0 || table[next + 1] != 0)) {
+            ++next;
+        }
+
+        if(next + 2 > table.size()) {
+            break;
+        }
+
+        next += 2;
+        fn(table.subspan(offset, next - offset));
+        offset = next;
+    }
+}
+} // namespace identy::detail
+
+#endif
@@ -0,0 +1,213 @@
+/**
+ * @file bench.hxx
+ * @brief Minimal microbenchmark harness of identy_bench
+ *
+ * A benchmark is a function taking a State. Setup goes before the measured
+ * loop, which runs while State::keep_running() returns true:
+ *
+ * @code
+ * registry.add("sha256/1KiB", [](bench::State& state) {
+ *     std::vector<identy::byte> data(1024);
+ *     state.set_bytes_per_op(data.size());
+ *     while(state.keep_running()) {
+ *         bench::do_not_optimize(Sha256::hash(data));
+ *     }
+ * });
+ * @endcode
+ *
+ * The runner grows the iteration count until a run takes the minimum time
+ * and reports ns/op, bytes/s and heap allocations per operation, plus any
+ * counters the benchmark set (memory footprint, recall, error rates, ...).
+ */
+
+#pragma once
+
+#ifndef UNC_IDENTY_BENCH_H
+#define UNC_IDENTY_BENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace identy::bench
+{
+/** @brief Number of operator new calls made by the process so far */
+std::uint64_t allocation_count() noexcept;
+
+/**
+ * @brief Iteration control and measurement of a single benchmark run
+ */
+class State final
+{
+public:
+    explicit State(std::uint64_t iterations) noexcept
+        : m_iterations(iterations)
+        , m_remaining(iterations)
+    {
+    }
+
+    /**
+     * @brief Whether to run another iteration
+     *
+     * The first call starts the clock and the allocation counter, the call
+     * returning false stops them.
+     */
+    bool keep_running() noexcept
+    {
+        if(!m_started) {
+            m_started = true;
+            m_start_allocations = allocation_count();
+            m_start = std::chrono::steady_clock::now();
+        }
+
+        if(m_remaining == 0) {
+            m_end = std::chrono::steady_clock::now();
+            m_end_allocations = allocation_count();
+            return false;
+        }
+
+        --m_remaining;
+        return true;
+    }
+
+    /** @brief Declares how many bytes one iteration processes (for bytes/s) */
+    void set_bytes_per_op(std::uint64_t bytes) noexcept
+    {
+        m_bytes_per_op = bytes;
+    }
+
+    /** @brief Reports an extra named value with the result, replacing one of the same name */
+    void set_counter(std::string name, double value)
+    {
+        for(auto& counter : m_counters) {
+            if(counter.first == name) {
+                counter.second = value;
+                return;
+            }
+        }
+        m_counters.emplace_back(std::move(name), value);
+    }
+
+    /** @brief Marks the benchmark as not applicable in this environment */
+    void skip(std::string reason)
+    {
+        m_skip_reason = std::move(reason);
+        m_remaining = 0;
+    }
+
+    std::uint64_t iterations() const noexcept
+    {
+        return m_iterations;
+    }
+
+    std::uint64_t bytes_per_op() const noexcept
+    {
+        return m_bytes_per_op;
+    }
+
+    const std::string& skip_reason() const noexcept
+    {
+        return m_skip_reason;
+    }
+
+    const std::vector<std::pair<std::string, double>>& counters() const noexcept
+    {
+        return m_counters;
+    }
+
+    std::chrono::nanoseconds elapsed() const noexcept
+    {
+        return m_end - m_start;
+    }
+
+    std::uint64_t allocations() const noexcept
+    {
+        return m_end_allocations - m_start_allocations;
+    }
+
+private:
+    std::uint64_t m_iterations { 0 };
+    std::uint64_t m_remaining { 0 };
+    std::uint64_t m_bytes_per_op { 0 };
+    std::uint64_t m_start_allocations { 0 };
+    std::uint64_t m_end_allocations { 0 };
+    bool m_started { false };
+    std::chrono::steady_clock::time_point m_start {};
+    std::chrono::steady_clock::time_point m_end {};
+    std::string m_skip_reason;
+    std::vector<std::pair<std::string, double>> m_counters;
+};
+
+/**
+ * @brief Named benchmarks in registration order
+ */
+class Registry final
+{
+public:
+    using Function = std::function<void(State&)>;
+
+    struct Entry
+    {
+        std::string name;
+        Function function;
+    };
+
+    void add(std::string name, Function function)
+    {
+        m_entries.push_back({ std::move(name), std::move(function) });
+    }
+
+    const std::vector<Entry>& entries() const noexcept
+    {
+        return m_entries;
+    }
+
+private:
+    std::vector<Entry> m_entries;
+};
+
+/**
+ * @brief Keeps the compiler from discarding a computed value
+ */
+template<typename T>
+inline void do_not_optimize(const T& value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    const volatile char* sink = reinterpret_cast<const volatile char*>(&value);
+    (void)*sink;
+#endif
+}
+
+/**
+ * @brief Stream buffer discarding everything written to it
+ *
+ * Lets stream writers be measured without the cost of a growing string.
+ */
+class NullBuffer final : public std::streambuf
+{
+protected:
+    std::streamsize xsputn(const char*, std::streamsize count) override
+    {
+        return count;
+    }
+
+    int_type overflow(int_type c) override
+    {
+        return traits_type::not_eof(c);
+    }
+};
+
+void register_hash_benchmarks(Registry& registry);
+void register_hwid_benchmarks(Registry& registry);
+void register_vm_benchmarks(Registry& registry);
+void register_io_benchmarks(Registry& registry);
+void register_sketch_benchmarks(Registry& registry);
+} // namespace identy::bench
+
+#endif
@@ -0,0 +1,61 @@
+#include <span>
+#include <string>
+#include <vector>
+
+#include <Identy.h>
+#include <Identy_sha256.hxx>
+
+#include "bench.hxx"
+
+namespace
+{
+std::string size_label(std::size_t size)
+{
+    if(size >= 1024 * 1024) {
+        return std::to_string(size / (1024 * 1024)) + "MiB";
+    }
+    if(size >= 1024) {
+        return std::to_string(size / 1024) + "KiB";
+    }
+    return std::to_string(size) + "B";
+}
+} // namespace
+
+void identy::bench::register_hash_benchmarks(Registry& registry)
+{
+    for(std::size_t size : { std::size_t { 1 }, std::size_t { 64 }, std::size_t { 1024 }, std::size_t { 64 * 1024 }, std::size_t { 1024 * 1024 } }) {
+        registry.add("sha256/" + size_label(size), [size](State& state) {
+            std::vector<byte> data(size, 0x5A);
+            state.set_bytes_per_op(size);
+
+            while(state.keep_running()) {
+                do_not_optimize(hs::detail::Sha256::hash(data));
+            }
+        });
+    }
+
+    registry.add("hs::hash<Motherboard>", [](State& state) {
+        auto mb = snap_motherboard();
+
+        while(state.keep_running()) {
+            do_not_optimize(hs::hash(mb));
+        }
+    });
+
+    registry.add("hs::default_hash_ex", [](State& state) {
+        auto mb = snap_motherboard_ex();
+        state.set_bytes_per_op(mb.smbios.raw_tables_data.size());
+
+        while(state.keep_running()) {
+            do_not_optimize(hs::detail::default_hash_ex(mb));
+        }
+    });
+
+    registry.add("hs::hash_batch/1024", [](State& state) {
+        std::vector<Motherboard> boards(1024, snap_motherboard());
+
+        while(state.keep_running()) {
+            do_not_optimize(hs::hash_batch(std::span<const Motherboard>(boards)));
+        }
+    });
+}
@@ -0,0 +1,161 @@
+#include <filesystem>
+#include <string>
+
+#include <Identy.h>
+
+#include "Platform/Identy_platform_hwid.hxx"
+
+#include "bench.hxx"
+
+namespace
+{
+/**
+ * @brief Synthetic sysfs tree removed when the benchmark ends
+ */
+class SyntheticTree
+{
+public:
+    explicit SyntheticTree(const identy::fixture::SysfsSpec& spec)
+        : m_root(std::filesystem::temp_directory_path() / ("identy_bench_sysfs_" + std::to_string(spec.block_devices)))
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(m_root, ec);
+        m_ok = identy::fixture::write_sysfs_tree(m_root, spec);
+    }
+
+    ~SyntheticTree()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(m_root, ec);
+    }
+
+    const std::filesystem::path& root() const noexcept
+    {
+        return m_root;
+    }
+
+    bool ok() const noexcept
+    {
+        return m_ok;
+    }
+
+private:
+    std::filesystem::path m_root;
+    bool m_ok { false };
+};
+} // namespace
+
+void identy::bench::register_hwid_benchmarks(Registry& registry)
+{
+    registry.add("get_cpu_info", [](State& state) {
+        while(state.keep_running()) {
+            do_not_optimize(snap_cpu());
+        }
+    });
+
+    registry.add("platform::get_smbios", [](State& state) {
+        state.set_bytes_per_op(platform::get_smbios().table_data.size());
+
+        while(state.keep_running()) {
+            do_not_optimize(platform::get_smbios());
+        }
+    });
+
+    registry.add("list_drives", [](State& state) {
+        while(state.keep_running()) {
+            do_not_optimize(list_drives());
+        }
+    });
+
+    registry.add("snap_motherboard_ex", [](State& state) {
+        while(state.keep_running()) {
+            do_not_optimize(snap_motherboard_ex());
+        }
+    });
+
+#ifdef IDENTY_LINUX
+    for(std::size_t devices : { 10, 100, 1000, 10000 }) {
+        registry.add("list_drives/synthetic/" + std::to_string(devices), [devices](State& state) {
+            fixture::SysfsSpec spec;
+            spec.block_devices = devices;
+
+            SyntheticTree tree(spec);
+            if(!tree.ok()) {
+                state.skip("cannot create synthetic sysfs tree");
+                return;
+            }
+
+            ScopedSysfsRoot root(tree.root());
+
+            while(state.keep_running()) {
+                do_not_optimize(list_drives());
+            }
+        });
+    }
+
+    registry.add("list_drives/synthetic/multipath/64x4", [](State& state) {
+        fixture::SysfsSpec spec;
+        spec.block_devices = 16;
+        spec.multipath_luns = 64;
+        spec.paths_per_lun = 4;
+
+        SyntheticTree tree(spec);
+        if(!tree.ok()) {
+            state.skip("cannot create synthetic sysfs tree");
+            return;
+        }
+
+        ScopedSysfsRoot root(tree.root());
+
+        while(state.keep_running()) {
+            do_not_optimize(list_drives());
+        }
+    });
+
+    for(std::size_t size : { 4 * 1024, 64 * 1024 }) {
+        registry.add("platform::get_smbios/synthetic/" + std::to_string(size / 1024) + "KiB", [size](State& state) {
+            fixture::SysfsSpec spec;
+            spec.block_devices = 0;
+            spec.dmi_table_size = size;
+
+            SyntheticTree tree(spec);
+            if(!tree.ok()) {
+                state.skip("cannot create synthetic sysfs tree");
+                return;
+            }
+
+            ScopedSysfsRoot root(tree.root());
+            state.set_bytes_per_op(size);
+
+            while(state.keep_running()) {
+                do_not_optimize(platform::get_smbios());
+            }
+        });
+    }
+
+    // Startup cost of a short-lived tool: full collection against a cache hit
+    for(bool cached : { false, true }) {
+        registry.add(cached ? "cache::cached_fingerprint/synthetic/hit" : "hs::hash(snap_motherboard_ex)/synthetic", [cached](State& state) {
+            fixture::SysfsSpec spec;
+
+            SyntheticTree tree(spec);
+            if(!tree.ok()) {
+                state.skip("cannot create synthetic sysfs tree");
+                return;
+            }
+
+            ScopedSysfsRoot root(tree.root());
+            auto cache_dir = tree.root() / "cache";
+
+            if(cached && !cache::store(cache_dir, snap_motherboard_ex())) {
+                state.skip("cannot write the cache");
+                return;
+            }
+
+            while(state.keep_running()) {
+                do_not_optimize(cached ? cache::cached_fingerprint(cache_dir) : hs::hash(snap_motherboard_ex()));
+            }
+        });
+    }
+#endif
+}
@@ -0,0 +1,240 @@
+#include <array>
+#include <format>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <Identy.h>
+
+#include "bench.hxx"
+
+namespace
+{
+/**
+ * The operator<< / std::format text writer io::write_text replaced, kept as
+ * the baseline for "io::write_text/iostream"
+ */
+void write_text_iostream(std::ostream& stream, const identy::MotherboardEx& mb)
+{
+    stream << "CPU:\n";
+    stream << mb.cpu.extended_brand_string;
+    stream << " Vendor: " << mb.cpu.vendor << "\n";
+    stream << " Cores: " << mb.cpu.logical_processors_count << "\n";
+    stream << " Hypervisor present: " << std::format("{}", mb.cpu.hypervisor_bit) << "\n";
+    stream << " Hypervisor signature (if presented) " << mb.cpu.hypervisor_signature << "\n";
+
+    stream << "Motherboard:\n";
+    stream << std::format(
+        " SMBIOS UUID: {:02x}{:02x}{:02x}{:02x}-{:02x}{:02x}-{:02x}{:02x}-{:02x}{:02x}-{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}\n",
+        mb.smbios.uuid[0], mb.smbios.uuid[1], mb.smbios.uuid[2], mb.smbios.uuid[3], mb.smbios.uuid[4], mb.smbios.uuid[5], mb.smbios.uuid[6],
+        mb.smbios.uuid[7], mb.smbios.uuid[8], mb.smbios.uuid[9], mb.smbios.uuid[10], mb.smbios.uuid[11], mb.smbios.uuid[12],
+        mb.smbios.uuid[13], mb.smbios.uuid[14], mb.smbios.uuid[15]);
+
+    stream << " SMBIOS Ver: ";
+    stream << std::format("{}.{}\n", mb.smbios.major_version, mb.smbios.minor_version);
+
+    stream << " SMBIOS DMI Ver: ";
+    stream << std::format("{}\n", mb.smbios.dmi_version);
+
+    stream << " SMBIOS 2.0 calling convention: " << std::format("{}\n", mb.smbios.is_20_calling_used);
+
+    stream << "Physical Drives:\n";
+    if(mb.drives.empty()) {
+        stream << " No drives detected or insufficient permissions\n";
+        return;
+    }
+
+    for(std::size_t i = 0; i < mb.drives.size(); ++i) {
+        const auto& drive = mb.drives[i];
+
+        stream << std::format(" Drive {}\n", i + 1);
+        stream << "  Device: " << drive.device_name << "\n";
+        stream << "  Serial: " << drive.serial << "\n";
+        stream << "  Bus Type: ";
+
+        switch(drive.bus_type) {
+            case identy::PhysicalDriveInfo::SATA:
+                stream << "SATA\n";
+                break;
+            case identy::PhysicalDriveInfo::NMVe:
+                stream << "NVMe\n";
+                break;
+            case identy::PhysicalDriveInfo::USB:
+                stream << "USB\n";
+                break;
+            default:
+                stream << "Unknown\n";
+                break;
+        }
+    }
+}
+} // namespace
+
+void identy::bench::register_io_benchmarks(Registry& registry)
+{
+    registry.add("io::write_binary", [](State& state) {
+        auto mb = snap_motherboard_ex();
+
+        std::vector<byte> encoded;
+        state.set_bytes_per_op(io::encode_binary(encoded, mb));
+
+        NullBuffer buffer;
+        std::ostream stream(&buffer);
+
+        while(state.keep_running()) {
+            io::write_binary(stream, mb);
+        }
+    });
+
+    registry.add("io::encode_binary", [](State& state) {
+        auto mb = snap_motherboard_ex();
+
+        std::vector<byte> out;
+        state.set_bytes_per_op(io::encode_binary(out, mb));
+
+        while(state.keep_running()) {
+            out.clear();
+            io::encode_binary(out, mb);
+            do_not_optimize(out.data());
+        }
+    });
+
+    registry.add("io::read_binary", [](State& state) {
+        std::vector<byte> encoded;
+        state.set_bytes_per_op(io::encode_binary(encoded, snap_motherboard_ex()));
+
+        while(state.keep_running()) {
+            do_not_optimize(io::read_binary(encoded));
+        }
+    });
+
+    registry.add("io::SnapshotReader::fields", [](State& state) {
+        std::vector<byte> encoded;
+        state.set_bytes_per_op(io::encode_binary(encoded, snap_motherboard_ex()));
+
+        auto reader = io::read_binary(encoded);
+        if(!reader) {
+            state.skip("cannot decode snapshot");
+            return;
+        }
+
+        while(state.keep_running()) {
+            std::size_t total = reader->cpu_vendor().size() + reader->cpu_brand().size() + reader->smbios_uuid()[0]
+                + reader->smbios_tables().size();
+            for(std::size_t i = 0; i < reader->drive_count(); ++i) {
+                total += reader->drive(i).serial.size();
+            }
+            do_not_optimize(total);
+        }
+    });
+
+    registry.add("io::SnapshotReader::to_motherboard_ex", [](State& state) {
+        std::vector<byte> encoded;
+        state.set_bytes_per_op(io::encode_binary(encoded, snap_motherboard_ex()));
+
+        auto reader = io::read_binary(encoded);
+        if(!reader) {
+            state.skip("cannot decode snapshot");
+            return;
+        }
+
+        while(state.keep_running()) {
+            do_not_optimize(reader->to_motherboard_ex());
+        }
+    });
+
+    registry.add("io::write_text", [](State& state) {
+        auto mb = snap_motherboard_ex();
+        state.set_bytes_per_op(io::format_text({}, mb));
+
+        NullBuffer buffer;
+        std::ostream stream(&buffer);
+
+        while(state.keep_running()) {
+            io::write_text(stream, mb);
+        }
+    });
+
+    registry.add("io::write_text/iostream", [](State& state) {
+        auto mb = snap_motherboard_ex();
+        state.set_bytes_per_op(io::format_text({}, mb));
+
+        NullBuffer buffer;
+        std::ostream stream(&buffer);
+
+        while(state.keep_running()) {
+            write_text_iostream(stream, mb);
+        }
+    });
+
+    registry.add("io::write_json", [](State& state) {
+        auto mb = snap_motherboard_ex();
+        state.set_bytes_per_op(io::format_json({}, mb));
+
+        NullBuffer buffer;
+        std::ostream stream(&buffer);
+
+        while(state.keep_running()) {
+            io::write_json(stream, mb);
+        }
+    });
+
+    registry.add("io::format_text", [](State& state) {
+        auto mb = snap_motherboard_ex();
+        std::array<char, 4096> buffer;
+        state.set_bytes_per_op(io::format_text(buffer, mb));
+
+        while(state.keep_running()) {
+            do_not_optimize(io::format_text(buffer, mb));
+        }
+    });
+
+    for(bool changed : { false, true }) {
+        registry.add(changed ? "diff/changed" : "diff/identical", [changed](State& state) {
+            MotherboardEx before;
+            before.cpu.vendor = "GenuineIntel";
+            before.cpu.extended_brand_string = "Intel(R) Xeon(R) Gold 6338 CPU @ 2.00GHz";
+            before.smbios.major_version = 3;
+            before.smbios.minor_version = 4;
+            before.smbios.raw_tables_data = fixture::make_smbios_table(16 * 1024, 1);
+
+            for(int i = 0; i < 8; ++i) {
+                PhysicalDriveInfo drive;
+                drive.bus_type = PhysicalDriveInfo::NMVe;
+                drive.device_name = "nvme" + std::to_string(i) + "n1";
+                drive.serial = "S4EWNX0R" + std::to_string(100000 + i);
+                drive.model_id = "Samsung SSD 980 PRO";
+                before.drives.push_back(drive);
+            }
+
+            auto after = before;
+            if(changed) {
+                // new system UUID in the tables and a replaced drive
+                after.smbios.raw_tables_data = fixture::make_smbios_table(16 * 1024, 2);
+                after.drives[3].serial = "S4EWNX0R999999";
+            }
+
+            state.set_bytes_per_op(before.smbios.raw_tables_data.size() * 2);
+
+            std::vector<SnapshotChange> changes;
+            while(state.keep_running()) {
+                do_not_optimize(diff(before, after, changes));
+            }
+        });
+    }
+
+    registry.add("fleet::Verifier/1024", [](State& state) {
+        std::vector<byte> encoded;
+        io::encode_binary(encoded, snap_motherboard_ex());
+        state.set_bytes_per_op(encoded.size() * 1024);
+
+        exec::WorkStealingPool pool(3);
+        while(state.keep_running()) {
+            fleet::Verifier verifier(nullptr, {}, pool);
+            for(int i = 0; i < 1024; ++i) {
+                verifier.push(std::span<const byte>(encoded));
+            }
+            verifier.finish();
+        }
+    });
+}
@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <Identy.h>
+
+#include "bench.hxx"
+
+namespace
+{
+std::atomic<std::uint64_t> allocations { 0 };
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if(void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return ::operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+std::uint64_t identy::bench::allocation_count() noexcept
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+namespace
+{
+struct Options
+{
+    bool json { false };
+    double min_time { 0.2 };
+    std::vector<std::string> filters;
+};
+
+struct Result
+{
+    std::string name;
+    std::uint64_t iterations { 0 };
+    double ns_per_op { 0 };
+    double bytes_per_second { 0 };
+    double allocs_per_op { 0 };
+    std::vector<std::pair<std::string, double>> counters;
+    std::string skipped;
+};
+
+void print_usage()
+{
+    std::cout << "Usage: identy_bench [--json] [--min-time SECONDS] [--filter SUBSTRING]...\n"
+                 "  --json       Print results as JSON\n"
+                 "  --min-time   Minimum measured time per benchmark (default 0.2)\n"
+                 "  --filter     Run only benchmarks whose name contains SUBSTRING\n";
+}
+
+bool parse_options(int argc, char** argv, Options& options)
+{
+    for(int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+
+        if(arg == "--json") {
+            options.json = true;
+        }
+        else if(arg == "--min-time" && i + 1 < argc) {
+            std::string_view value = argv[++i];
+            auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), options.min_time);
+            if(ec != std::errc() || options.min_time <= 0) {
+                return false;
+            }
+        }
+        else if(arg == "--filter" && i + 1 < argc) {
+            options.filters.emplace_back(argv[++i]);
+        }
+        else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool selected(const Options& options, const std::string& name)
+{
+    return options.filters.empty() || std::ranges::any_of(options.filters, [&](const std::string& filter) {
+        return name.find(filter) != std::string::npos;
+    });
+}
+
+Result run(const identy::bench::Registry::Entry& entry, double min_time)
+{
+    constexpr std::uint64_t max_iterations = 1'000'000'000;
+
+    Result result;
+    result.name = entry.name;
+
+    std::uint64_t iterations = 1;
+
+    while(true) {
+        identy::bench::State state(iterations);
+        entry.function(state);
+
+        if(!state.skip_reason().empty()) {
+            result.skipped = state.skip_reason();
+            return result;
+        }
+
+        auto seconds = std::chrono::duration<double>(state.elapsed()).count();
+
+        if(seconds >= min_time || iterations >= max_iterations) {
+            auto n = static_cast<double>(iterations);
+            result.iterations = iterations;
+            result.ns_per_op = seconds * 1e9 / n;
+            result.bytes_per_second = seconds > 0 ? static_cast<double>(state.bytes_per_op()) * n / seconds : 0;
+            result.allocs_per_op = static_cast<double>(state.allocations()) / n;
+            result.counters = state.counters();
+            return result;
+        }
+
+        // Aim 20% past the minimum to avoid another round, at most 100x growth
+        double scale = seconds > 0 ? std::min(100.0, min_time * 1.2 / seconds) : 100.0;
+        iterations = std::min(max_iterations, std::max(iterations * 2, static_cast<std::uint64_t>(static_cast<double>(iterations) * scale)));
+    }
+}
+
+std::string json_escape(std::string_view text)
+{
+    std::string out;
+
+    for(char c : text) {
+        if(c == '"' || c == '\\') {
+            out.push_back('\\');
+            out.push_back(c);
+        }
+        else if(static_cast<unsigned char>(c) < 0x20) {
+            out.push_back(' ');
+        }
+        else {
+            out.push_back(c);
+        }
+    }
+
+    return out;
+}
+
+std::string compiler_name()
+{
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_VER);
+#else
+    return "unknown";
+#endif
+}
+
+void print_json(const std::vector<Result>& results)
+{
+    auto cpu = identy::snap_cpu();
+
+    std::cout << "{\"context\":{\"cpu\":\"" << json_escape(cpu.extended_brand_string) << "\",\"compiler\":\""
+              << json_escape(compiler_name()) << "\",\"identy_snapshot_version\":" << identy::io::snapshot_version
+              << "},\"benchmarks\":[";
+
+    for(std::size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+
+        std::cout << (i == 0 ? "" : ",") << "\n{\"name\":\"" << json_escape(r.name) << "\"";
+
+        if(!r.skipped.empty()) {
+            std::cout << ",\"skipped\":\"" << json_escape(r.skipped) << "\"}";
+            continue;
+        }
+
+        char line[256];
+        std::snprintf(line, sizeof(line), ",\"iterations\":%llu,\"ns_per_op\":%.3f,\"bytes_per_second\":%.1f,\"allocs_per_op\":%.3f",
+            static_cast<unsigned long long>(r.iterations), r.ns_per_op, r.bytes_per_second, r.allocs_per_op);
+        std::cout << line;
+
+        if(!r.counters.empty()) {
+            std::cout << ",\"counters\":{";
+            for(std::size_t c = 0; c < r.counters.size(); ++c) {
+                std::snprintf(line, sizeof(line), "%s\"%s\":%.6g", c == 0 ? "" : ",", json_escape(r.counters[c].first).c_str(),
+                    r.counters[c].second);
+                std::cout << line;
+            }
+            std::cout << "}";
+        }
+
+        std::cout << "}";
+    }
+
+    std::cout << "\n]}\n";
+}
+
+std::string human_rate(double bytes_per_second)
+{
+    constexpr const char* units[] = { "B/s", "KiB/s", "MiB/s", "GiB/s" };
+
+    std::size_t unit = 0;
+    while(bytes_per_second >= 1024 && unit + 1 < std::size(units)) {
+        bytes_per_second /= 1024;
+        ++unit;
+    }
+
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.1f %s", bytes_per_second, units[unit]);
+    return text;
+}
+
+void print_row(const Result& r)
+{
+    char line[256];
+
+    if(!r.skipped.empty()) {
+        std::snprintf(line, sizeof(line), "%-44s skipped: %s\n", r.name.c_str(), r.skipped.c_str());
+    }
+    else {
+        std::snprintf(line, sizeof(line), "%-44s %14.1f %14s %10.2f %12llu\n", r.name.c_str(), r.ns_per_op,
+            r.bytes_per_second > 0 ? human_rate(r.bytes_per_second).c_str() : "-", r.allocs_per_op,
+            static_cast<unsigned long long>(r.iterations));
+    }
+
+    std::cout << line;
+
+    for(const auto& [name, value] : r.counters) {
+        std::snprintf(line, sizeof(line), "    %-40s %14.6g\n", name.c_str(), value);
+        std::cout << line;
+    }
+
+    std::cout << std::flush;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    if(!parse_options(argc, argv, options)) {
+        print_usage();
+        return 2;
+    }
+
+    identy::bench::Registry registry;
+    identy::bench::register_hash_benchmarks(registry);
+    identy::bench::register_hwid_benchmarks(registry);
+    identy::bench::register_vm_benchmarks(registry);
+    identy::bench::register_io_benchmarks(registry);
+    identy::bench::register_sketch_benchmarks(registry);
+
+    if(!options.json) {
+        char header[256];
+        std::snprintf(header, sizeof(header), "%-44s %14s %14s %10s %12s\n", "benchmark", "ns/op", "bytes/s", "allocs/op", "iterations");
+        std::cout << header;
+    }
+
+    std::vector<Result> results;
+
+    for(const auto& entry : registry.entries()) {
+        if(!selected(options, entry.name)) {
+            continue;
+        }
+
+        results.push_back(run(entry, options.min_time));
+
+        if(!options.json) {
+            print_row(results.back());
+        }
+    }
+
+    if(options.json) {
+        print_json(results);
+    }
+
+    return 0;
+}
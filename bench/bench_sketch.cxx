@@ -0,0 +1,349 @@
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <Identy.h>
+
+#include "bench.hxx"
+
+namespace
+{
+constexpr std::size_t index_records = 200'000;
+constexpr std::size_t components_per_record = 48;
+constexpr std::size_t blocklist_entries = 1'000'000;
+
+// model-clustered fleet: per machine 36 structures that come with the model
+// and 12 that carry unit serials (system, baseboard, chassis, 9 memory devices)
+constexpr std::size_t fleet_models = 10;
+constexpr std::size_t model_structures = 36;
+constexpr std::size_t memory_devices = 9;
+
+std::uint64_t next_random(std::uint64_t& state) noexcept
+{
+    state += 0x9E3779B97F4A7C15ull;
+    auto x = state;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/** Synthetic fleet: every record is a set of random component digests */
+struct SimilarityFleet
+{
+    std::vector<std::vector<std::uint64_t>> records;
+    identy::similarity::Index index;
+
+    SimilarityFleet()
+    {
+        std::uint64_t random = 1;
+
+        records.resize(index_records);
+        index.reserve(index_records);
+
+        for(auto& record : records) {
+            for(std::size_t c = 0; c < components_per_record; ++c) {
+                record.push_back(next_random(random));
+            }
+            index.insert(identy::similarity::sign(record));
+        }
+    }
+
+    /** Signature of a copy of record @p id with @p changed components replaced */
+    identy::similarity::Signature near_duplicate(std::size_t id, std::size_t changed, std::uint64_t& random) const
+    {
+        auto record = records[id];
+        for(std::size_t c = 0; c < changed; ++c) {
+            record[c] = next_random(random);
+        }
+        return identy::similarity::sign(record);
+    }
+
+    /** Fraction of near duplicates with @p changed components replaced found at @p threshold */
+    double recall(std::size_t changed, double threshold) const
+    {
+        constexpr std::size_t samples = 2000;
+        std::uint64_t random = 7;
+        std::size_t found = 0;
+
+        for(std::size_t i = 0; i < samples; ++i) {
+            auto id = static_cast<std::uint32_t>(next_random(random) % records.size());
+            for(const auto& match : index.query(near_duplicate(id, changed, random), threshold)) {
+                if(match.id == id) {
+                    ++found;
+                    break;
+                }
+            }
+        }
+
+        return static_cast<double>(found) / samples;
+    }
+};
+
+/** Appends one SMBIOS structure: 4-byte header, 8-byte body, one string, double null */
+void append_structure(std::vector<identy::byte>& table, identy::byte type, identy::word handle, std::uint64_t body, const std::string& text)
+{
+    table.push_back(type);
+    table.push_back(4 + sizeof(body));
+    table.push_back(static_cast<identy::byte>(handle & 0xFF));
+    table.push_back(static_cast<identy::byte>(handle >> 8));
+    for(std::size_t i = 0; i < sizeof(body); ++i) {
+        table.push_back(static_cast<identy::byte>(body >> (i * 8)));
+    }
+    table.insert(table.end(), text.begin(), text.end());
+    table.push_back(0);
+    table.push_back(0);
+}
+
+/** Machine @p id of a fleet of fleet_models models, with two NVMe drives */
+identy::MotherboardEx make_fleet_machine(std::size_t id)
+{
+    constexpr identy::byte model_types[] = { 0, 7, 8, 9, 10, 16, 19, 32, 41 };
+
+    auto model = id % fleet_models;
+    auto unit = "U" + std::to_string(id);
+
+    identy::MotherboardEx mb;
+    mb.cpu.vendor = "GenuineIntel";
+    mb.cpu.extended_brand_string = "Model " + std::to_string(model);
+    mb.cpu.version = static_cast<identy::register_32>(model);
+    std::uint64_t random = id;
+    auto uuid = next_random(random);
+    std::memcpy(mb.smbios.uuid, &uuid, sizeof(uuid));
+
+    auto& table = mb.smbios.raw_tables_data;
+    identy::word handle = 0;
+    for(std::size_t i = 0; i < model_structures; ++i, ++handle) {
+        append_structure(table, model_types[i % std::size(model_types)], handle, model * 1000 + i, "Model " + std::to_string(model));
+    }
+
+    append_structure(table, 1, handle++, uuid, unit);
+    append_structure(table, 2, handle++, model, unit);
+    append_structure(table, 3, handle++, model, unit);
+    for(std::size_t i = 0; i < memory_devices; ++i, ++handle) {
+        append_structure(table, 17, handle, i, unit + "-DIMM" + std::to_string(i));
+    }
+    append_structure(table, 127, handle, 0, {});
+
+    for(int d = 0; d < 2; ++d) {
+        identy::PhysicalDriveInfo drive;
+        drive.bus_type = identy::PhysicalDriveInfo::NMVe;
+        drive.device_name = "nvme" + std::to_string(d) + "n1";
+        drive.serial = unit + "-NVME" + std::to_string(d);
+        drive.model_id = "Samsung SSD 990 PRO";
+        mb.drives.push_back(drive);
+    }
+
+    return mb;
+}
+
+/** Index over index_records machines of make_fleet_machine() */
+struct ModelFleet
+{
+    identy::similarity::Index index;
+
+    ModelFleet()
+    {
+        index.reserve(index_records);
+        for(std::size_t id = 0; id < index_records; ++id) {
+            index.insert(identy::similarity::sign(make_fleet_machine(id)));
+        }
+    }
+
+    /** Signature of a clone of machine @p id with one drive replaced */
+    static identy::similarity::Signature clone(std::size_t id)
+    {
+        auto mb = make_fleet_machine(id);
+        mb.drives[1].serial = "REPLACED";
+        return identy::similarity::sign(mb);
+    }
+
+    /** Fraction of clones found at @p threshold */
+    double recall(double threshold) const
+    {
+        constexpr std::size_t samples = 500;
+        std::uint64_t random = 13;
+        std::size_t found = 0;
+
+        for(std::size_t i = 0; i < samples; ++i) {
+            auto id = static_cast<std::uint32_t>(next_random(random) % index_records);
+            for(const auto& match : index.query(clone(id), threshold)) {
+                if(match.id == id) {
+                    ++found;
+                    break;
+                }
+            }
+        }
+
+        return static_cast<double>(found) / samples;
+    }
+};
+
+/** Blocklist of random keys; keys past blocklist_entries in the same stream are not members */
+struct BlocklistFixture
+{
+    std::vector<std::uint64_t> members;
+    std::vector<std::uint64_t> probes;
+    std::optional<identy::filter::Blocklist> blocklist;
+
+    BlocklistFixture()
+    {
+        std::uint64_t random = 3;
+        for(std::size_t i = 0; i < blocklist_entries; ++i) {
+            members.push_back(next_random(random));
+        }
+        for(std::size_t i = 0; i < blocklist_entries; ++i) {
+            probes.push_back(next_random(random));
+        }
+        blocklist = identy::filter::Blocklist::build(members);
+    }
+
+    double false_positive_rate() const
+    {
+        std::size_t hits = 0;
+        for(auto key : probes) {
+            hits += blocklist->contains(key) ? 1 : 0;
+        }
+        return static_cast<double>(hits) / static_cast<double>(probes.size());
+    }
+};
+
+const BlocklistFixture& blocklist_fixture()
+{
+    static const BlocklistFixture fixture;
+    return fixture;
+}
+
+const SimilarityFleet& similarity_fleet()
+{
+    static const SimilarityFleet fleet;
+    return fleet;
+}
+
+const ModelFleet& model_fleet()
+{
+    static const ModelFleet fleet;
+    return fleet;
+}
+} // namespace
+
+void identy::bench::register_sketch_benchmarks(Registry& registry)
+{
+    registry.add("similarity::sign", [](State& state) {
+        auto mb = snap_motherboard_ex();
+
+        std::vector<std::uint64_t> digests;
+        state.set_counter("components", static_cast<double>(similarity::component_digests(mb, digests)));
+
+        while(state.keep_running()) {
+            do_not_optimize(similarity::sign(mb));
+        }
+    });
+
+    registry.add("similarity::Index::query/200k", [](State& state) {
+        const auto& fleet = similarity_fleet();
+
+        // components shared out of 48: 45 -> similarity 0.88, 36 -> 0.6
+        state.set_counter("bytes_per_record", static_cast<double>(fleet.index.memory_bytes()) / static_cast<double>(fleet.index.size()));
+        state.set_counter("recall_s0.88_t0.8", fleet.recall(3, 0.8));
+        state.set_counter("recall_s0.60_t0.5", fleet.recall(12, 0.5));
+
+        std::uint64_t random = 11;
+        std::vector<similarity::Signature> queries;
+        for(std::size_t i = 0; i < 256; ++i) {
+            queries.push_back(fleet.near_duplicate(next_random(random) % index_records, 3, random));
+        }
+
+        std::size_t next = 0;
+        while(state.keep_running()) {
+            do_not_optimize(fleet.index.query(queries[next++ % queries.size()], 0.8));
+        }
+    });
+
+    registry.add("similarity::Index::query/200k-10-models", [](State& state) {
+        const auto& fleet = model_fleet();
+
+        // 20k machines per model share their 36 model structures with the query
+        state.set_counter("same_model_similarity",
+            similarity::estimate(similarity::sign(make_fleet_machine(0)), similarity::sign(make_fleet_machine(fleet_models))));
+        state.set_counter("clone_similarity", similarity::estimate(similarity::sign(make_fleet_machine(0)), ModelFleet::clone(0)));
+        state.set_counter("recall_clone_t0.8", fleet.recall(0.8));
+
+        std::uint64_t random = 17;
+        std::vector<similarity::Signature> queries;
+        for(std::size_t i = 0; i < 256; ++i) {
+            queries.push_back(ModelFleet::clone(next_random(random) % index_records));
+        }
+
+        std::size_t next = 0;
+        while(state.keep_running()) {
+            do_not_optimize(fleet.index.query(queries[next++ % queries.size()], 0.8));
+        }
+    });
+
+    registry.add("filter::Blocklist::contains/1M", [](State& state) {
+        const auto& fixture = blocklist_fixture();
+        state.set_counter("bits_per_entry", fixture.blocklist->bits_per_entry());
+        state.set_counter("false_positive_rate", fixture.false_positive_rate());
+
+        // half members, half not, in an order the prefetcher cannot follow
+        std::size_t next = 0;
+        while(state.keep_running()) {
+            auto i = (next++ * 7919) % blocklist_entries;
+            const auto& keys = (i & 1) != 0 ? fixture.members : fixture.probes;
+            do_not_optimize(fixture.blocklist->contains(keys[i]));
+        }
+    });
+
+    registry.add("sketch::HyperLogLog::add/4096", [](State& state) {
+        std::uint64_t random = 5;
+        std::vector<std::uint64_t> digests(4096);
+        for(auto& digest : digests) {
+            digest = next_random(random);
+        }
+
+        sketch::HyperLogLog hll;
+        state.set_bytes_per_op(digests.size() * sizeof(std::uint64_t));
+
+        while(state.keep_running()) {
+            hll.add(digests);
+        }
+        do_not_optimize(hll.estimate());
+    });
+
+    registry.add("sketch::FieldCardinality::add/256", [](State& state) {
+        std::vector<MotherboardEx> boards(256, snap_motherboard_ex());
+        for(std::size_t i = 0; i < boards.size(); ++i) {
+            boards[i].smbios.uuid[0] = static_cast<byte>(i);
+        }
+
+        std::vector<sketch::FieldDigest> digests;
+        state.set_counter("digests_per_snapshot", static_cast<double>(sketch::field_digests(boards[0], digests)));
+
+        sketch::FieldCardinality counts;
+        while(state.keep_running()) {
+            counts.add(boards);
+        }
+        do_not_optimize(counts.estimate(sketch::Field::Fingerprint));
+    });
+
+    registry.add("sketch::HeavyHitters::add/64k", [](State& state) {
+        // 1% of the stream is one cloned image, the rest unique fingerprints
+        std::uint64_t random = 9;
+        std::vector<hs::Hash256> stream(1 << 16);
+        for(std::size_t i = 0; i < stream.size(); ++i) {
+            auto value = i % 100 == 0 ? 0 : next_random(random);
+            std::memcpy(stream[i].buffer, &value, sizeof(value));
+        }
+
+        sketch::HeavyHitters<32> hitters;
+        state.set_counter("memory_bytes", static_cast<double>(hitters.memory_bytes()));
+
+        std::size_t next = 0;
+        while(state.keep_running()) {
+            hitters.add(stream[next++ & (stream.size() - 1)]);
+        }
+        do_not_optimize(hitters.top(1));
+    });
+}
@@ -0,0 +1,55 @@
+#include <string>
+#include <string_view>
+
+#include <Identy.h>
+#include <Identy_strings.hxx>
+
+#include "Platform/Identy_platform_vm.hxx"
+
+#include "bench.hxx"
+
+void identy::bench::register_vm_benchmarks(Registry& registry)
+{
+    // primitives of the adapter and drive model checks
+    registry.add("strings::contains_icase", [](State& state) {
+        std::string_view description = "Intel(R) Ethernet Connection (7) I219-LM #2 - Virtual Switch";
+
+        while(state.keep_running()) {
+            do_not_optimize(strings::contains_icase(description, "virtualbox"));
+        }
+    });
+
+    registry.add("strings::all_same", [](State& state) {
+        std::string serial(40, '0');
+
+        while(state.keep_running()) {
+            do_not_optimize(strings::all_same(serial));
+        }
+    });
+
+    // check_network_adapters() is internal to analyze_full(); its cost is the
+    // adapter enumeration measured here
+    registry.add("check_network_adapters", [](State& state) {
+        bool access_denied = false;
+
+        while(state.keep_running()) {
+            do_not_optimize(platform::list_network_adapters(access_denied));
+        }
+    });
+
+    registry.add("vm::analyze_full<Motherboard>", [](State& state) {
+        auto mb = snap_motherboard();
+
+        while(state.keep_running()) {
+            do_not_optimize(vm::analyze_full(mb));
+        }
+    });
+
+    registry.add("vm::analyze_full<MotherboardEx>", [](State& state) {
+        auto mb = snap_motherboard_ex();
+
+        while(state.keep_running()) {
+            do_not_optimize(vm::analyze_full(mb));
+        }
+    });
+}
@@ -0,0 +1,504 @@
+/**
+ * @file scale_main.cxx
+ * @brief identy_scale: multithreaded scalability harness
+ *
+ * Runs one workload (snapshot, hash or VM analysis) on 1..N threads at once
+ * and reports, per thread count, throughput, p50/p99/p999 latency, context
+ * switches per operation and the scaling efficiency against one thread. A
+ * thread count whose efficiency drops below the configured threshold is
+ * flagged as contended: the workload serializes on shared state, such as
+ * kernel locks behind sysfs reads.
+ *
+ * Runs are configured by key=value files (see bench/configs) so results can
+ * be reproduced; command line options override the file.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <latch>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef IDENTY_LINUX
+#include <sys/resource.h>
+#endif
+
+#include <Identy.h>
+
+#include "bench.hxx"
+
+namespace
+{
+enum class Workload {
+    Snapshot,
+    SnapshotEx,
+    Hash,
+    Analyze
+};
+
+struct Config
+{
+    Workload workload { Workload::SnapshotEx };
+    std::vector<std::size_t> threads;
+    std::size_t ops_per_thread { 200 };
+    std::size_t warmup_ops { 10 };
+    double contention_threshold { 0.7 };
+
+    // Synthetic sysfs tree instead of the live system when block_devices > 0
+    std::size_t sysfs_block_devices { 0 };
+    std::size_t sysfs_network_interfaces { 4 };
+    std::size_t sysfs_dmi_size { 8192 };
+    std::uint32_t seed { 1 };
+
+    bool json { false };
+};
+
+struct Sample
+{
+    std::size_t threads { 0 };
+    std::size_t ops { 0 };
+    double seconds { 0 };
+    double ops_per_second { 0 };
+    double p50_ns { 0 };
+    double p99_ns { 0 };
+    double p999_ns { 0 };
+    double context_switches_per_op { -1 };
+    double efficiency { 1 };
+    bool contended { false };
+};
+
+std::string_view workload_name(Workload workload)
+{
+    switch(workload) {
+        case Workload::Snapshot:
+            return "snap_motherboard";
+        case Workload::SnapshotEx:
+            return "snap_motherboard_ex";
+        case Workload::Hash:
+            return "hs::hash";
+        case Workload::Analyze:
+            return "vm::analyze_full";
+    }
+    return "";
+}
+
+std::optional<Workload> parse_workload(std::string_view name)
+{
+    if(name == "snapshot") {
+        return Workload::Snapshot;
+    }
+    if(name == "snapshot_ex") {
+        return Workload::SnapshotEx;
+    }
+    if(name == "hash") {
+        return Workload::Hash;
+    }
+    if(name == "analyze") {
+        return Workload::Analyze;
+    }
+    return std::nullopt;
+}
+
+template<typename T>
+bool parse_number(std::string_view text, T& value)
+{
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && ptr == text.data() + text.size();
+}
+
+bool parse_thread_list(std::string_view text, std::vector<std::size_t>& threads)
+{
+    threads.clear();
+
+    while(!text.empty()) {
+        auto comma = text.find(',');
+        std::size_t count = 0;
+
+        if(!parse_number(text.substr(0, comma), count) || count == 0) {
+            return false;
+        }
+
+        threads.push_back(count);
+        text.remove_prefix(comma == std::string_view::npos ? text.size() : comma + 1);
+    }
+
+    return !threads.empty();
+}
+
+std::string_view trim(std::string_view text)
+{
+    while(!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while(!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+bool apply_setting(Config& config, std::string_view key, std::string_view value)
+{
+    if(key == "workload") {
+        auto workload = parse_workload(value);
+        if(workload) {
+            config.workload = *workload;
+        }
+        return workload.has_value();
+    }
+    if(key == "threads") {
+        return parse_thread_list(value, config.threads);
+    }
+    if(key == "ops_per_thread") {
+        return parse_number(value, config.ops_per_thread) && config.ops_per_thread > 0;
+    }
+    if(key == "warmup_ops") {
+        return parse_number(value, config.warmup_ops);
+    }
+    if(key == "contention_threshold") {
+        return parse_number(value, config.contention_threshold);
+    }
+    if(key == "sysfs_block_devices") {
+        return parse_number(value, config.sysfs_block_devices);
+    }
+    if(key == "sysfs_network_interfaces") {
+        return parse_number(value, config.sysfs_network_interfaces);
+    }
+    if(key == "sysfs_dmi_size") {
+        return parse_number(value, config.sysfs_dmi_size);
+    }
+    if(key == "seed") {
+        return parse_number(value, config.seed);
+    }
+    return false;
+}
+
+bool load_config(const std::filesystem::path& path, Config& config)
+{
+    std::ifstream file(path);
+    if(!file.is_open()) {
+        std::cerr << "cannot open " << path.string() << "\n";
+        return false;
+    }
+
+    std::string line;
+    std::size_t number = 0;
+
+    while(std::getline(file, line)) {
+        ++number;
+
+        std::string_view text = trim(line);
+        if(text.empty() || text.front() == '#') {
+            continue;
+        }
+
+        auto eq = text.find('=');
+        if(eq == std::string_view::npos || !apply_setting(config, trim(text.substr(0, eq)), trim(text.substr(eq + 1)))) {
+            std::cerr << path.string() << ":" << number << ": invalid setting\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void print_usage()
+{
+    std::cout << "Usage: identy_scale [--config FILE] [--KEY VALUE]... [--json]\n"
+                 "Keys (also valid in config files as key=value):\n"
+                 "  workload                  snapshot | snapshot_ex | hash | analyze\n"
+                 "  threads                   comma-separated thread counts (default 1,2,4..hardware threads)\n"
+                 "  ops_per_thread            measured operations per thread\n"
+                 "  warmup_ops                unmeasured operations per thread before the run\n"
+                 "  contention_threshold      flag thread counts with lower scaling efficiency\n"
+                 "  sysfs_block_devices       > 0 reads a synthetic sysfs tree with that many drives\n"
+                 "  sysfs_network_interfaces  network interfaces of the synthetic tree\n"
+                 "  sysfs_dmi_size            DMI table size of the synthetic tree\n"
+                 "  seed                      seed of the synthetic tree\n";
+}
+
+bool parse_options(int argc, char** argv, Config& config)
+{
+    for(int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+
+        if(arg == "--json") {
+            config.json = true;
+        }
+        else if(arg == "--config" && i + 1 < argc) {
+            if(!load_config(argv[++i], config)) {
+                return false;
+            }
+        }
+        else if(arg.starts_with("--") && i + 1 < argc) {
+            std::string key(arg.substr(2));
+            std::ranges::replace(key, '-', '_');
+
+            if(!apply_setting(config, key, argv[++i])) {
+                std::cerr << "invalid value for " << arg << "\n";
+                return false;
+            }
+        }
+        else {
+            return false;
+        }
+    }
+
+    if(config.threads.empty()) {
+        auto hardware = std::max(1u, std::thread::hardware_concurrency());
+        for(std::size_t n = 1; n < hardware; n *= 2) {
+            config.threads.push_back(n);
+        }
+        config.threads.push_back(hardware);
+    }
+
+    return true;
+}
+
+/** @brief Voluntary plus involuntary context switches of the calling thread, -1 if unknown */
+long long thread_context_switches() noexcept
+{
+#if defined(IDENTY_LINUX) && defined(RUSAGE_THREAD)
+    rusage usage {};
+    if(getrusage(RUSAGE_THREAD, &usage) == 0) {
+        return static_cast<long long>(usage.ru_nvcsw) + static_cast<long long>(usage.ru_nivcsw);
+    }
+#endif
+    return -1;
+}
+
+/**
+ * @brief Inputs shared read-only by all worker threads
+ */
+struct Fixture
+{
+    identy::Motherboard mb;
+    identy::MotherboardEx mb_ex;
+    std::optional<std::filesystem::path> sysfs_root;
+};
+
+void run_once(Workload workload, const Fixture& fixture)
+{
+    switch(workload) {
+        case Workload::Snapshot:
+            identy::bench::do_not_optimize(identy::snap_motherboard());
+            break;
+        case Workload::SnapshotEx:
+            identy::bench::do_not_optimize(identy::snap_motherboard_ex());
+            break;
+        case Workload::Hash:
+            identy::bench::do_not_optimize(identy::hs::hash(fixture.mb_ex));
+            break;
+        case Workload::Analyze:
+            identy::bench::do_not_optimize(identy::vm::analyze_full(fixture.mb_ex));
+            break;
+    }
+}
+
+double percentile(std::vector<std::int64_t>& latencies, double fraction)
+{
+    if(latencies.empty()) {
+        return 0;
+    }
+
+    auto index = std::min(latencies.size() - 1, static_cast<std::size_t>(fraction * static_cast<double>(latencies.size())));
+    std::nth_element(latencies.begin(), latencies.begin() + static_cast<std::ptrdiff_t>(index), latencies.end());
+    return static_cast<double>(latencies[index]);
+}
+
+Sample measure(const Config& config, const Fixture& fixture, std::size_t thread_count)
+{
+    std::vector<std::vector<std::int64_t>> latencies(thread_count);
+    std::vector<long long> switches(thread_count, -1);
+
+    std::latch ready(static_cast<std::ptrdiff_t>(thread_count) + 1);
+    std::latch start(1);
+    std::atomic<std::size_t> running { thread_count };
+    std::chrono::steady_clock::time_point finished;
+
+    std::vector<std::thread> workers;
+    workers.reserve(thread_count);
+
+    for(std::size_t t = 0; t < thread_count; ++t) {
+        workers.emplace_back([&, t] {
+            // Sources are per thread, so every worker installs its own root
+            std::optional<identy::ScopedSysfsRoot> root;
+            if(fixture.sysfs_root) {
+                root.emplace(*fixture.sysfs_root);
+            }
+
+            auto& samples = latencies[t];
+            samples.reserve(config.ops_per_thread);
+
+            for(std::size_t i = 0; i < config.warmup_ops; ++i) {
+                run_once(config.workload, fixture);
+            }
+
+            ready.count_down();
+            start.wait();
+
+            auto switches_before = thread_context_switches();
+
+            for(std::size_t i = 0; i < config.ops_per_thread; ++i) {
+                auto begin = std::chrono::steady_clock::now();
+                run_once(config.workload, fixture);
+                auto end = std::chrono::steady_clock::now();
+
+                samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+            }
+
+            auto switches_after = thread_context_switches();
+            if(switches_before >= 0 && switches_after >= 0) {
+                switches[t] = switches_after - switches_before;
+            }
+
+            if(running.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                finished = std::chrono::steady_clock::now();
+            }
+        });
+    }
+
+    ready.arrive_and_wait();
+    auto started = std::chrono::steady_clock::now();
+    start.count_down();
+
+    for(auto& worker : workers) {
+        worker.join();
+    }
+
+    Sample sample;
+    sample.threads = thread_count;
+    sample.ops = thread_count * config.ops_per_thread;
+    sample.seconds = std::chrono::duration<double>(finished - started).count();
+    sample.ops_per_second = sample.seconds > 0 ? static_cast<double>(sample.ops) / sample.seconds : 0;
+
+    std::vector<std::int64_t> all;
+    all.reserve(sample.ops);
+    for(const auto& samples : latencies) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+
+    sample.p50_ns = percentile(all, 0.50);
+    sample.p99_ns = percentile(all, 0.99);
+    sample.p999_ns = percentile(all, 0.999);
+
+    if(std::ranges::none_of(switches, [](long long s) { return s < 0; })) {
+        long long total = 0;
+        for(auto s : switches) {
+            total += s;
+        }
+        sample.context_switches_per_op = static_cast<double>(total) / static_cast<double>(sample.ops);
+    }
+
+    return sample;
+}
+
+void print_table(const Config& config, const std::vector<Sample>& samples)
+{
+    std::printf("workload: %s, %zu ops/thread%s\n", std::string(workload_name(config.workload)).c_str(), config.ops_per_thread,
+        config.sysfs_block_devices > 0 ? ", synthetic sysfs" : "");
+    std::printf("%8s %14s %12s %12s %12s %10s %10s\n", "threads", "ops/s", "p50 ns", "p99 ns", "p999 ns", "cs/op", "efficiency");
+
+    for(const auto& s : samples) {
+        std::printf("%8zu %14.1f %12.0f %12.0f %12.0f %10.3f %9.0f%%%s\n", s.threads, s.ops_per_second, s.p50_ns, s.p99_ns,
+            s.p999_ns, s.context_switches_per_op, s.efficiency * 100, s.contended ? "  CONTENDED" : "");
+    }
+}
+
+void print_json(const Config& config, const std::vector<Sample>& samples)
+{
+    std::printf("{\"workload\":\"%s\",\"ops_per_thread\":%zu,\"warmup_ops\":%zu,\"sysfs_block_devices\":%zu,"
+                "\"sysfs_network_interfaces\":%zu,\"sysfs_dmi_size\":%zu,\"seed\":%u,\"hardware_threads\":%u,\"samples\":[",
+        std::string(workload_name(config.workload)).c_str(), config.ops_per_thread, config.warmup_ops, config.sysfs_block_devices,
+        config.sysfs_network_interfaces, config.sysfs_dmi_size, config.seed, std::thread::hardware_concurrency());
+
+    for(std::size_t i = 0; i < samples.size(); ++i) {
+        const auto& s = samples[i];
+        std::printf("%s\n{\"threads\":%zu,\"ops\":%zu,\"seconds\":%.6f,\"ops_per_second\":%.1f,\"p50_ns\":%.0f,\"p99_ns\":%.0f,"
+                    "\"p999_ns\":%.0f,\"context_switches_per_op\":%.4f,\"efficiency\":%.4f,\"contended\":%s}",
+            i == 0 ? "" : ",", s.threads, s.ops, s.seconds, s.ops_per_second, s.p50_ns, s.p99_ns, s.p999_ns,
+            s.context_switches_per_op, s.efficiency, s.contended ? "true" : "false");
+    }
+
+    std::printf("\n]}\n");
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Config config;
+
+    if(!parse_options(argc, argv, config)) {
+        print_usage();
+        return 2;
+    }
+
+    Fixture fixture;
+
+    std::filesystem::path tree;
+
+    if(config.sysfs_block_devices > 0) {
+        identy::fixture::SysfsSpec spec;
+        spec.block_devices = config.sysfs_block_devices;
+        spec.network_interfaces = config.sysfs_network_interfaces;
+        spec.dmi_table_size = config.sysfs_dmi_size;
+        spec.seed = config.seed;
+
+        tree = std::filesystem::temp_directory_path() / ("identy_scale_sysfs_" + std::to_string(config.seed));
+
+        std::error_code ec;
+        std::filesystem::remove_all(tree, ec);
+
+        if(!identy::fixture::write_sysfs_tree(tree, spec)) {
+            std::cerr << "cannot create synthetic sysfs tree in " << tree.string() << "\n";
+            return 1;
+        }
+
+        fixture.sysfs_root = tree;
+    }
+
+    {
+        std::optional<identy::ScopedSysfsRoot> root;
+        if(fixture.sysfs_root) {
+            root.emplace(*fixture.sysfs_root);
+        }
+
+        fixture.mb = identy::snap_motherboard();
+        fixture.mb_ex = identy::snap_motherboard_ex();
+    }
+
+    std::vector<Sample> samples;
+
+    for(auto threads : config.threads) {
+        auto sample = measure(config, fixture, threads);
+
+        if(!samples.empty() && samples.front().threads == 1 && samples.front().ops_per_second > 0) {
+            sample.efficiency = sample.ops_per_second / (samples.front().ops_per_second * static_cast<double>(threads));
+            sample.contended = threads <= std::thread::hardware_concurrency() && sample.efficiency < config.contention_threshold;
+        }
+
+        samples.push_back(sample);
+    }
+
+    if(config.json) {
+        print_json(config, samples);
+    }
+    else {
+        print_table(config, samples);
+    }
+
+    if(!tree.empty()) {
+        std::error_code ec;
+        std::filesystem::remove_all(tree, ec);
+    }
+
+    return 0;
+}
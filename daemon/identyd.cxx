@@ -0,0 +1,412 @@
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <Identy.h>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// Hot-plug events come in bursts (disk + partitions, link + queues)
+constexpr auto hotplug_debounce = std::chrono::milliseconds(500);
+
+// Per phase (request, reply); a client that stalls is answered with what it
+// sent or dropped, it never holds up the others
+constexpr auto client_timeout = std::chrono::milliseconds(1000);
+
+// Connections beyond this wait in the listen backlog
+constexpr std::size_t max_clients = 64;
+
+volatile std::sig_atomic_t stop_requested = 0;
+volatile std::sig_atomic_t refresh_requested = 0;
+
+struct Options
+{
+    std::string socket_path { identy::daemon::default_socket_path };
+    std::string shm_name { identy::daemon::default_shm_name };
+    std::chrono::seconds ttl { 600 };
+};
+
+void print_usage()
+{
+    std::cout << "Usage: identyd [--socket PATH] [--shm NAME] [--ttl SECONDS]\n"
+                 "  --socket   Unix domain socket to serve (default /run/identyd.sock)\n"
+                 "  --shm      Shared memory segment to publish (default /identyd)\n"
+                 "  --ttl      Refresh interval without hot-plug events (default 600)\n"
+                 "SIGHUP forces a refresh, SIGINT/SIGTERM stop the daemon.\n";
+}
+
+bool parse_options(int argc, char** argv, Options& options)
+{
+    for(int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+
+        if(arg == "--socket" && i + 1 < argc) {
+            options.socket_path = argv[++i];
+        }
+        else if(arg == "--shm" && i + 1 < argc) {
+            options.shm_name = argv[++i];
+        }
+        else if(arg == "--ttl" && i + 1 < argc) {
+            std::string_view value = argv[++i];
+            unsigned seconds = 0;
+            auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), seconds);
+            if(ec != std::errc() || ptr != value.data() + value.size() || seconds == 0) {
+                return false;
+            }
+            options.ttl = std::chrono::seconds(seconds);
+        }
+        else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void on_signal(int signal)
+{
+    if(signal == SIGHUP) {
+        refresh_requested = 1;
+    }
+    else {
+        stop_requested = 1;
+    }
+}
+
+void install_signal_handlers()
+{
+    struct sigaction action {};
+    action.sa_handler = on_signal;
+    sigemptyset(&action.sa_mask);
+
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    sigaction(SIGHUP, &action, nullptr);
+
+    std::signal(SIGPIPE, SIG_IGN);
+}
+
+int open_listener(const std::string& path)
+{
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+
+    if(path.size() >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if(fd < 0) {
+        return -1;
+    }
+
+    // a socket left behind by a previous instance
+    ::unlink(path.c_str());
+
+    if(::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 64) != 0) {
+        ::close(fd);
+        return -1;
+    }
+
+    // any local process may query, the daemon only ever answers
+    ::chmod(path.c_str(), 0666);
+
+    return fd;
+}
+
+/**
+ * Kernel uevent socket, -1 where netlink is unavailable (e.g. some
+ * containers); the daemon then relies on the TTL alone.
+ */
+int open_uevent_socket()
+{
+    int fd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+    if(fd < 0) {
+        return -1;
+    }
+
+    sockaddr_nl address {};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = 1;
+
+    if(::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * Drains pending uevents.
+ * @return true if any of them adds or removes a block or network device
+ */
+bool drain_uevents(int fd)
+{
+    std::array<char, 8192> buffer {};
+    bool relevant = false;
+
+    while(true) {
+        auto size = ::recv(fd, buffer.data(), buffer.size(), 0);
+        if(size <= 0) {
+            break;
+        }
+
+        bool hotplug = false;
+        bool subsystem = false;
+
+        // "ACTION@DEVPATH\0KEY=VALUE\0KEY=VALUE\0..."
+        std::string_view message(buffer.data(), static_cast<std::size_t>(size));
+        while(!message.empty()) {
+            auto end = message.find('\0');
+            auto field = message.substr(0, end);
+
+            if(field == "ACTION=add" || field == "ACTION=remove") {
+                hotplug = true;
+            }
+            else if(field == "SUBSYSTEM=block" || field == "SUBSYSTEM=net") {
+                subsystem = true;
+            }
+
+            if(end == std::string_view::npos) {
+                break;
+            }
+            message.remove_prefix(end + 1);
+        }
+
+        relevant = relevant || (hotplug && subsystem);
+    }
+
+    return relevant;
+}
+
+/**
+ * A client connection served from the main poll loop. Sockets are
+ * non-blocking: each readiness event moves the exchange as far as it can
+ * without waiting.
+ */
+struct Client
+{
+    int fd { -1 };
+    std::array<identy::byte, identy::daemon::request_size + 1> request {};
+    std::size_t received { 0 };
+    std::vector<identy::byte> reply;
+    std::size_t sent { 0 };
+    bool replying { false };
+    Clock::time_point deadline;
+};
+
+void start_reply(Client& client, const identy::daemon::Service& service)
+{
+    service.handle(std::span<const identy::byte>(client.request.data(), client.received), client.reply);
+    client.replying = true;
+    client.deadline = Clock::now() + client_timeout;
+}
+
+/**
+ * Advances one client.
+ * @return false once the exchange is over and the connection can be closed
+ */
+bool serve_client(Client& client, const identy::daemon::Service& service)
+{
+    // read until the client half-closes; one extra byte detects oversized requests
+    while(!client.replying) {
+        auto count = ::recv(client.fd, client.request.data() + client.received, client.request.size() - client.received, 0);
+        if(count < 0 && errno == EINTR) {
+            continue;
+        }
+        if(count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+        if(count < 0) {
+            return false;
+        }
+
+        client.received += static_cast<std::size_t>(count);
+        if(count == 0 || client.received == client.request.size()) {
+            start_reply(client, service);
+        }
+    }
+
+    while(client.sent < client.reply.size()) {
+        auto count = ::send(client.fd, client.reply.data() + client.sent, client.reply.size() - client.sent, MSG_NOSIGNAL);
+        if(count < 0 && errno == EINTR) {
+            continue;
+        }
+        if(count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+        if(count <= 0) {
+            return false;
+        }
+        client.sent += static_cast<std::size_t>(count);
+    }
+
+    return false;
+}
+
+void refresh(identy::daemon::Service& service, identy::daemon::FingerprintPublisher& publisher, std::string_view reason)
+{
+    bool changed = service.refresh();
+    publisher.publish(service.published());
+
+    std::cerr << "identyd: refresh #" << service.published().generation << " (" << reason << ")"
+              << (changed ? ", fingerprint changed" : "") << "\n";
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    if(!parse_options(argc, argv, options)) {
+        print_usage();
+        return 2;
+    }
+
+    install_signal_handlers();
+
+    auto publisher = identy::daemon::FingerprintPublisher::create(options.shm_name);
+    if(!publisher.has_value()) {
+        std::cerr << "identyd: cannot create shared memory " << options.shm_name << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+
+    int listener = open_listener(options.socket_path);
+    if(listener < 0) {
+        std::cerr << "identyd: cannot listen on " << options.socket_path << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+
+    int uevents = open_uevent_socket();
+    if(uevents < 0) {
+        std::cerr << "identyd: hot-plug events unavailable, refreshing every " << options.ttl.count() << "s only\n";
+    }
+
+    // never ask ourselves for the tables when running unprivileged
+    identy::tier::set_daemon_socket({});
+
+    identy::daemon::Service service;
+    refresh(service, *publisher, "start");
+
+    auto next_refresh = Clock::now() + options.ttl;
+    std::optional<Clock::time_point> pending_hotplug;
+    std::vector<Client> clients;
+    std::vector<pollfd> fds;
+
+    while(!stop_requested) {
+        auto now = Clock::now();
+
+        if(refresh_requested) {
+            refresh_requested = 0;
+            refresh(service, *publisher, "signal");
+            next_refresh = now + options.ttl;
+        }
+        else if(pending_hotplug.has_value() && now >= *pending_hotplug) {
+            pending_hotplug.reset();
+            refresh(service, *publisher, "hot-plug");
+            next_refresh = now + options.ttl;
+        }
+        else if(now >= next_refresh) {
+            refresh(service, *publisher, "ttl");
+            next_refresh = now + options.ttl;
+        }
+
+        // a stalled request is answered with what arrived, a stalled reply is dropped
+        now = Clock::now();
+        std::erase_if(clients, [&](Client& client) {
+            if(now < client.deadline) {
+                return false;
+            }
+            if(!client.replying) {
+                start_reply(client, service);
+                if(serve_client(client, service)) {
+                    return false;
+                }
+            }
+            ::close(client.fd);
+            return true;
+        });
+
+        auto deadline = pending_hotplug.has_value() ? std::min(next_refresh, *pending_hotplug) : next_refresh;
+        for(const auto& client : clients) {
+            deadline = std::min(deadline, client.deadline);
+        }
+        auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+
+        // the listener is left out while the client table is full
+        fds.clear();
+        fds.push_back({ clients.size() < max_clients ? listener : -1, POLLIN, 0 });
+        fds.push_back({ uevents, POLLIN, 0 });
+        for(const auto& client : clients) {
+            fds.push_back({ client.fd, static_cast<short>(client.replying ? POLLOUT : POLLIN), 0 });
+        }
+
+        int ready = ::poll(fds.data(), fds.size(), static_cast<int>(std::clamp<long long>(timeout, 0, 60'000)));
+
+        if(ready <= 0) {
+            continue;
+        }
+
+        if(uevents >= 0 && (fds[1].revents & POLLIN) && drain_uevents(uevents) && !pending_hotplug.has_value()) {
+            pending_hotplug = Clock::now() + hotplug_debounce;
+        }
+
+        for(std::size_t i = clients.size(); i-- > 0;) {
+            if(fds[i + 2].revents == 0) {
+                continue;
+            }
+            if(!serve_client(clients[i], service)) {
+                ::close(clients[i].fd);
+                clients.erase(clients.begin() + static_cast<std::ptrdiff_t>(i));
+            }
+        }
+
+        if(fds[0].revents & POLLIN) {
+            while(clients.size() < max_clients) {
+                int fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+                if(fd < 0) {
+                    break;
+                }
+
+                Client client;
+                client.fd = fd;
+                client.deadline = Clock::now() + client_timeout;
+                clients.push_back(std::move(client));
+            }
+        }
+    }
+
+    for(const auto& client : clients) {
+        ::close(client.fd);
+    }
+
+    ::close(listener);
+    ::unlink(options.socket_path.c_str());
+
+    if(uevents >= 0) {
+        ::close(uevents);
+    }
+
+    return 0;
+}
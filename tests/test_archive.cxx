@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <Identy.h>
+#include "test_boards.hxx"
+#include "test_config.hxx"
+
+namespace identy::test
+{
+
+namespace
+{
+// records differ in CPU version, table size and drive count
+BoardSpec archive_spec(int index)
+{
+    BoardSpec spec;
+    spec.vendor = "AuthenticAMD";
+    spec.brand = "AMD Ryzen 9 5950X 16-Core Processor";
+    spec.version = index;
+    spec.tables.assign(static_cast<std::size_t>(index % 7) * 13, static_cast<byte>(index));
+    spec.drives = static_cast<std::size_t>(index % 3);
+    return spec;
+}
+
+class ArchiveTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        path_ = std::filesystem::temp_directory_path()
+            / ("identy_archive_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + ".bin");
+    }
+
+    void TearDown() override
+    {
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+
+    void WriteArchive(int records, bool with_index)
+    {
+        std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+        io::ArchiveWriter writer(file);
+
+        for(int i = 0; i < records; ++i) {
+            EXPECT_TRUE(writer.append(make_board(i, archive_spec(i))));
+        }
+
+        if(with_index) {
+            writer.finish();
+        }
+    }
+
+    std::filesystem::path path_;
+};
+} // namespace
+
+TEST_F(ArchiveTest, Open_MissingFileFails)
+{
+    EXPECT_FALSE(io::ArchiveReader::open(path_).has_value());
+}
+
+TEST_F(ArchiveTest, Open_EmptyArchive)
+{
+    WriteArchive(0, false);
+
+    auto archive = io::ArchiveReader::open(path_);
+    ASSERT_TRUE(archive.has_value());
+    EXPECT_EQ(archive->record_count(), 0u);
+    EXPECT_TRUE(archive->partition(4).empty());
+    EXPECT_EQ(archive->begin(), archive->end());
+}
+
+TEST_F(ArchiveTest, Iterate_WithoutIndex)
+{
+    WriteArchive(25, false);
+
+    auto archive = io::ArchiveReader::open(path_);
+    ASSERT_TRUE(archive.has_value());
+    EXPECT_FALSE(archive->has_index());
+    EXPECT_EQ(archive->record_count(), 25u);
+
+    int index = 0;
+    for(const auto& record : *archive) {
+        auto expected = make_board(index, archive_spec(index));
+        auto decoded = record.to_motherboard_ex();
+
+        EXPECT_EQ(decoded.cpu.version, index);
+        EXPECT_EQ(hs::compare(hs::hash(decoded), hs::hash(expected)), 0) << "Record " << index;
+        ++index;
+    }
+
+    EXPECT_EQ(index, 25);
+}
+
+TEST_F(ArchiveTest, RandomAccess_WithIndex)
+{
+    WriteArchive(40, true);
+
+    auto archive = io::ArchiveReader::open(path_);
+    ASSERT_TRUE(archive.has_value());
+    EXPECT_TRUE(archive->has_index());
+    EXPECT_EQ(archive->record_count(), 40u);
+
+    auto record = archive->record(17);
+    ASSERT_TRUE(record.has_value());
+    EXPECT_EQ(record->to_motherboard_ex().cpu.version, 17);
+
+    EXPECT_FALSE(archive->record(40).has_value());
+    EXPECT_EQ(archive->for_each([](const io::SnapshotReader&) {}), 40u) << "Footer must not be parsed as a record";
+}
+
+TEST_F(ArchiveTest, Partition_CoversEveryRecordOnce)
+{
+    for(bool with_index : { false, true }) {
+        WriteArchive(101, with_index);
+
+        auto archive = io::ArchiveReader::open(path_);
+        ASSERT_TRUE(archive.has_value());
+
+        auto parts = archive->partition(8);
+        ASSERT_FALSE(parts.empty());
+        EXPECT_LE(parts.size(), 8u);
+        EXPECT_EQ(parts.front().begin, 0u);
+        EXPECT_EQ(parts.back().end, archive->data_size());
+
+        std::size_t total = 0;
+        for(std::size_t i = 0; i < parts.size(); ++i) {
+            if(i > 0) {
+                EXPECT_EQ(parts[i].begin, parts[i - 1].end) << "Partitions must be contiguous";
+            }
+            total += archive->for_each(parts[i], [](const io::SnapshotReader&) {});
+        }
+
+        EXPECT_EQ(total, 101u) << "with_index=" << with_index;
+    }
+}
+
+TEST_F(ArchiveTest, ScanParallel_VisitsAllRecords)
+{
+    WriteArchive(200, true);
+
+    auto archive = io::ArchiveReader::open(path_);
+    ASSERT_TRUE(archive.has_value());
+
+    std::atomic<long long> version_sum { 0 };
+    auto visited = archive->scan_parallel(
+        [&version_sum](const io::SnapshotReader& record) {
+            version_sum += record.to_motherboard().cpu.version;
+        },
+        4);
+
+    EXPECT_EQ(visited, 200u);
+    EXPECT_EQ(version_sum.load(), 199LL * 200 / 2);
+}
+
+TEST_F(ArchiveTest, TruncatedTail_StopsAtIntactPrefix)
+{
+    WriteArchive(10, false);
+
+    auto size = std::filesystem::file_size(path_);
+    std::filesystem::resize_file(path_, size - 5);
+
+    auto archive = io::ArchiveReader::open(path_);
+    ASSERT_TRUE(archive.has_value());
+    EXPECT_EQ(archive->for_each([](const io::SnapshotReader&) {}), 9u);
+}
+
+TEST_F(ArchiveTest, Append_RejectsEmptySnapshot)
+{
+    {
+        std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+        io::ArchiveWriter writer(file);
+
+        // encode_binary() yields no bytes for a snapshot it cannot encode
+        EXPECT_FALSE(writer.append_encoded({}));
+        EXPECT_TRUE(writer.append(make_board(1, archive_spec(1))));
+        EXPECT_EQ(writer.record_count(), 1u);
+        writer.finish();
+    }
+
+    auto archive = io::ArchiveReader::open(path_);
+    ASSERT_TRUE(archive.has_value());
+    EXPECT_EQ(archive->record_count(), 1u);
+}
+
+TEST_F(ArchiveTest, Append_FailedStreamAddsNoRecord)
+{
+    std::ostringstream stream;
+    stream.setstate(std::ios::badbit);
+
+    io::ArchiveWriter writer(stream);
+    EXPECT_FALSE(writer.append(make_board(1, archive_spec(1))));
+    EXPECT_EQ(writer.record_count(), 0u);
+}
+
+} // namespace identy::test
@@ -0,0 +1,355 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <Identy.h>
+#include "test_boards.hxx"
+#include "test_config.hxx"
+
+#ifdef IDENTY_LINUX
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+namespace identy::test
+{
+
+namespace
+{
+std::vector<byte> make_tables(byte seed, std::size_t size)
+{
+    std::vector<byte> tables(size);
+    for(std::size_t i = 0; i < size; ++i) {
+        tables[i] = static_cast<byte>(seed + i * 31);
+    }
+    return tables;
+}
+
+class BlobStoreTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        path_ = std::filesystem::temp_directory_path()
+            / ("identy_blobs_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + ".pack");
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+
+    void TearDown() override
+    {
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+
+    std::filesystem::path path_;
+};
+} // namespace
+
+// ============================================================================
+// Storage and deduplication
+// ============================================================================
+
+TEST_F(BlobStoreTest, Open_CreatesEmptyPack)
+{
+    auto store = io::BlobStore::open(path_);
+    ASSERT_TRUE(store.has_value());
+
+    EXPECT_TRUE(std::filesystem::exists(path_));
+    EXPECT_EQ(store->blob_count(), 0u);
+    EXPECT_EQ(store->pack_size(), std::filesystem::file_size(path_));
+}
+
+TEST_F(BlobStoreTest, Open_RejectsForeignFile)
+{
+    {
+        std::ofstream file(path_, std::ios::binary);
+        file << "definitely not a pack";
+    }
+
+    EXPECT_FALSE(io::BlobStore::open(path_).has_value());
+}
+
+TEST_F(BlobStoreTest, Put_IdenticalPayloadStoredOnce)
+{
+    auto store = io::BlobStore::open(path_);
+    ASSERT_TRUE(store.has_value());
+
+    auto tables = make_tables(1, 4096);
+
+    auto first = store->put(tables);
+    auto size_after_first = store->pack_size();
+    auto second = store->put(tables);
+    ASSERT_TRUE(first.has_value());
+    ASSERT_TRUE(second.has_value());
+
+    EXPECT_TRUE(std::ranges::equal(first->buffer, second->buffer));
+    EXPECT_EQ(store->blob_count(), 1u);
+    EXPECT_EQ(store->ref_count(*first), 2u);
+    EXPECT_LT(store->pack_size() - size_after_first, tables.size()) << "Duplicate must not be written again";
+}
+
+TEST_F(BlobStoreTest, Get_ReturnsStoredBytes)
+{
+    auto store = io::BlobStore::open(path_);
+    ASSERT_TRUE(store.has_value());
+
+    auto a = make_tables(1, 100);
+    auto b = make_tables(2, 7);
+
+    auto ref_a = store->put(a);
+    auto ref_b = store->put(b);
+    ASSERT_TRUE(ref_a.has_value());
+    ASSERT_TRUE(ref_b.has_value());
+
+    auto got_a = store->get(*ref_a);
+    auto got_b = store->get(*ref_b);
+    ASSERT_TRUE(got_a.has_value());
+    ASSERT_TRUE(got_b.has_value());
+
+    EXPECT_TRUE(std::ranges::equal(*got_a, a));
+    EXPECT_TRUE(std::ranges::equal(*got_b, b));
+
+    io::BlobRef unknown {};
+    EXPECT_FALSE(store->get(unknown).has_value());
+    EXPECT_FALSE(store->contains(unknown));
+}
+
+TEST_F(BlobStoreTest, Release_DecrementsReferences)
+{
+    auto store = io::BlobStore::open(path_);
+    ASSERT_TRUE(store.has_value());
+
+    auto ref = *store->put(make_tables(3, 64));
+    store->put(make_tables(3, 64));
+
+    EXPECT_TRUE(store->release(ref));
+    EXPECT_EQ(store->ref_count(ref), 1u);
+    EXPECT_TRUE(store->release(ref));
+    EXPECT_EQ(store->ref_count(ref), 0u);
+    EXPECT_FALSE(store->release(ref));
+}
+
+// ============================================================================
+// Persistence
+// ============================================================================
+
+TEST_F(BlobStoreTest, Reopen_ReplaysIndexAndRefCounts)
+{
+    auto tables = make_tables(4, 1000);
+    io::BlobRef ref;
+
+    {
+        auto store = io::BlobStore::open(path_);
+        ASSERT_TRUE(store.has_value());
+        ref = *store->put(tables);
+        store->put(tables);
+        store->put(tables);
+        store->release(ref);
+        store->put(make_tables(5, 33));
+    }
+
+    auto store = io::BlobStore::open(path_);
+    ASSERT_TRUE(store.has_value());
+
+    EXPECT_EQ(store->blob_count(), 2u);
+    EXPECT_EQ(store->ref_count(ref), 2u);
+
+    auto got = store->get(ref);
+    ASSERT_TRUE(got.has_value());
+    EXPECT_TRUE(std::ranges::equal(*got, tables));
+}
+
+TEST_F(BlobStoreTest, Reopen_TruncatesTornTail)
+{
+    auto tables = make_tables(6, 500);
+    std::uint64_t good_size = 0;
+
+    {
+        auto store = io::BlobStore::open(path_);
+        ASSERT_TRUE(store.has_value());
+        store->put(tables);
+        good_size = store->pack_size();
+        store->put(make_tables(7, 500));
+    }
+
+    std::filesystem::resize_file(path_, good_size + 100);
+
+    auto store = io::BlobStore::open(path_);
+    ASSERT_TRUE(store.has_value());
+    EXPECT_EQ(store->blob_count(), 1u);
+    EXPECT_EQ(store->pack_size(), good_size);
+    EXPECT_EQ(std::filesystem::file_size(path_), good_size);
+
+    auto ref = store->put(make_tables(8, 10));
+    ASSERT_TRUE(ref.has_value());
+    EXPECT_TRUE(store->get(*ref).has_value());
+}
+
+TEST_F(BlobStoreTest, Reopen_SkipsBlobNotMatchingDigest)
+{
+    auto good = make_tables(10, 300);
+    auto bad = make_tables(11, 300);
+    std::uint64_t bad_payload = 0;
+    io::BlobRef bad_ref;
+
+    {
+        auto store = io::BlobStore::open(path_);
+        ASSERT_TRUE(store.has_value());
+        bad_payload = store->pack_size() + 48;
+        bad_ref = *store->put(bad);
+        store->put(good);
+    }
+
+    {
+        std::fstream file(path_, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(bad_payload + 17));
+        file.put('!');
+    }
+
+    auto size = std::filesystem::file_size(path_);
+    auto store = io::BlobStore::open(path_);
+    ASSERT_TRUE(store.has_value());
+
+    EXPECT_EQ(store->blob_count(), 1u);
+    EXPECT_FALSE(store->get(bad_ref).has_value());
+    EXPECT_EQ(store->pack_size(), size) << "a corrupt blob does not cut off the records after it";
+
+    auto ref = store->put(good);
+    ASSERT_TRUE(ref.has_value());
+    EXPECT_EQ(store->ref_count(*ref), 2u);
+}
+
+TEST_F(BlobStoreTest, Reopen_FailsOnCorruptRecordBeforeEnd)
+{
+    // tag of the first record, then its size field
+    for(std::uint64_t offset : { 8u, 16u }) {
+        std::filesystem::remove(path_);
+
+        {
+            auto store = io::BlobStore::open(path_);
+            ASSERT_TRUE(store.has_value());
+            store->put(make_tables(12, 300));
+            store->put(make_tables(13, 300));
+        }
+
+        {
+            std::fstream file(path_, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(static_cast<std::streamoff>(offset));
+            file.write("\xFF\xFF\xFF\x7F", 4);
+        }
+
+        auto size = std::filesystem::file_size(path_);
+        EXPECT_FALSE(io::BlobStore::open(path_).has_value()) << offset;
+        EXPECT_EQ(std::filesystem::file_size(path_), size) << "the records after a corrupt one are kept";
+    }
+}
+
+TEST_F(BlobStoreTest, Put_FailedWriteLeavesStoreUnchanged)
+{
+#ifdef IDENTY_LINUX
+    auto store = io::BlobStore::open(path_);
+    ASSERT_TRUE(store.has_value());
+    auto first = store->put(make_tables(12, 64));
+    ASSERT_TRUE(first.has_value());
+
+    auto size = store->pack_size();
+    auto tables = make_tables(13, 4096);
+
+    // a file size limit makes the write fail like a full disk would
+    rlimit saved {};
+    ASSERT_EQ(getrlimit(RLIMIT_FSIZE, &saved), 0);
+    auto handler = std::signal(SIGXFSZ, SIG_IGN);
+
+    rlimit limited = saved;
+    limited.rlim_cur = size + 100;
+    ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &limited), 0);
+
+    auto failed = store->put(tables);
+    auto size_after_failed = store->pack_size();
+    auto released = store->release(*first);
+
+    setrlimit(RLIMIT_FSIZE, &saved);
+    std::signal(SIGXFSZ, handler);
+
+    EXPECT_FALSE(failed.has_value());
+    EXPECT_EQ(store->blob_count(), 1u);
+    EXPECT_EQ(size_after_failed, size);
+    EXPECT_TRUE(released) << "a record that fits is still written";
+    EXPECT_EQ(store->ref_count(*first), 0u);
+
+    auto ref = store->put(tables);
+    ASSERT_TRUE(ref.has_value());
+    auto got = store->get(*ref);
+    ASSERT_TRUE(got.has_value());
+    EXPECT_TRUE(std::ranges::equal(*got, tables));
+
+    store.reset();
+    auto reopened = io::BlobStore::open(path_);
+    ASSERT_TRUE(reopened.has_value());
+    EXPECT_EQ(reopened->blob_count(), 2u);
+    EXPECT_TRUE(reopened->get(*ref).has_value());
+#else
+    GTEST_SKIP() << "Write failures are simulated with RLIMIT_FSIZE";
+#endif
+}
+
+// ============================================================================
+// Snapshots by reference
+// ============================================================================
+
+TEST_F(BlobStoreTest, Snapshot_StoresTablesByReference)
+{
+    auto store = io::BlobStore::open(path_);
+    ASSERT_TRUE(store.has_value());
+
+    BoardSpec spec;
+    spec.tables = make_tables(9, 8192);
+    const auto& tables = spec.tables;
+
+    std::vector<byte> inline_snapshot;
+    io::encode_binary(inline_snapshot, make_board(1, spec));
+
+    std::vector<byte> first;
+    std::vector<byte> second;
+    io::encode_binary(first, make_board(1, spec), *store);
+    io::encode_binary(second, make_board(2, spec), *store);
+
+    EXPECT_LT(first.size() + tables.size(), inline_snapshot.size() + 64);
+    EXPECT_EQ(store->blob_count(), 1u);
+
+    auto reader = io::read_binary(second);
+    ASSERT_TRUE(reader.has_value());
+    EXPECT_FALSE(reader->has_field(io::SnapshotField::SmbiosTables));
+    ASSERT_TRUE(reader->smbios_tables_ref().has_value());
+    EXPECT_EQ(store->ref_count(*reader->smbios_tables_ref()), 2u);
+
+    auto decoded = reader->to_motherboard_ex(&*store);
+    EXPECT_EQ(decoded.smbios.raw_tables_data, tables);
+    EXPECT_EQ(decoded.smbios.uuid[0], 2);
+    ASSERT_EQ(decoded.drives.size(), 1u);
+    EXPECT_EQ(decoded.drives[0].serial, "SN-2-0");
+}
+
+TEST_F(BlobStoreTest, Snapshot_WithoutStoreLeavesTablesEmpty)
+{
+    auto store = io::BlobStore::open(path_);
+    ASSERT_TRUE(store.has_value());
+
+    BoardSpec spec;
+    spec.tables = make_tables(3, 256);
+
+    std::vector<byte> snapshot;
+    io::encode_binary(snapshot, make_board(3, spec), *store);
+
+    auto reader = io::read_binary(snapshot);
+    ASSERT_TRUE(reader.has_value());
+
+    auto decoded = reader->to_motherboard_ex();
+    EXPECT_TRUE(decoded.smbios.raw_tables_data.empty());
+    EXPECT_EQ(decoded.smbios.major_version, 3);
+}
+
+} // namespace identy::test
@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <Identy.h>
+#include "test_config.hxx"
+
+namespace identy::test
+{
+
+namespace
+{
+std::vector<std::uint64_t> make_keys(std::uint64_t first, std::size_t count)
+{
+    std::vector<std::uint64_t> keys;
+    for(std::size_t i = 0; i < count; ++i) {
+        auto x = (first + i) * 0x9E3779B97F4A7C15ull;
+        keys.push_back(x ^ (x >> 31));
+    }
+    return keys;
+}
+
+hs::Hash256 make_hash(std::uint32_t seed)
+{
+    hs::Hash256 hash {};
+    for(std::size_t i = 0; i < sizeof(hash.buffer); ++i) {
+        hash.buffer[i] = static_cast<byte>((seed * 131 + i * 17) ^ (seed >> (i % 24)));
+    }
+    return hash;
+}
+
+double false_positive_rate(const filter::Blocklist& blocklist, std::uint64_t first, std::size_t probes)
+{
+    std::size_t hits = 0;
+    for(auto key : make_keys(first, probes)) {
+        hits += blocklist.contains(key) ? 1 : 0;
+    }
+    return static_cast<double>(hits) / static_cast<double>(probes);
+}
+} // namespace
+
+// ============================================================================
+// Fuse filter
+// ============================================================================
+
+TEST(BlocklistTest, Build_ContainsEveryKey)
+{
+    for(std::size_t count : { 1u, 2u, 3u, 100u, 10'000u }) {
+        auto keys = make_keys(0, count);
+        auto blocklist = filter::Blocklist::build(keys);
+        ASSERT_TRUE(blocklist.has_value()) << "count=" << count;
+        EXPECT_EQ(blocklist->size(), count);
+
+        for(auto key : keys) {
+            ASSERT_TRUE(blocklist->contains(key)) << "count=" << count;
+        }
+    }
+}
+
+TEST(BlocklistTest, Build_FalsePositiveRateAndSize)
+{
+    auto blocklist = filter::Blocklist::build(make_keys(0, 200'000));
+    ASSERT_TRUE(blocklist.has_value());
+
+    // 8-bit fingerprints: 1/256 = 0.39%
+    EXPECT_LT(false_positive_rate(*blocklist, 1'000'000'000, 200'000), 0.006);
+    EXPECT_LT(blocklist->bits_per_entry(), 10.0);
+    EXPECT_GT(blocklist->bits_per_entry(), 8.0);
+}
+
+TEST(BlocklistTest, Build_EmptyAndDuplicateKeys)
+{
+    auto empty = filter::Blocklist::build(std::span<const std::uint64_t> {});
+    ASSERT_TRUE(empty.has_value());
+    EXPECT_EQ(empty->size(), 0u);
+    EXPECT_FALSE(empty->contains(42));
+
+    std::vector<std::uint64_t> keys { 5, 5, 7, 5, 7 };
+    auto blocklist = filter::Blocklist::build(keys);
+    ASSERT_TRUE(blocklist.has_value());
+    EXPECT_EQ(blocklist->size(), 2u);
+    EXPECT_TRUE(blocklist->contains(5));
+    EXPECT_TRUE(blocklist->contains(7));
+}
+
+TEST(BlocklistTest, Hashes_UseTheirLeadingBytes)
+{
+    std::vector<hs::Hash256> banned;
+    for(std::uint32_t i = 0; i < 500; ++i) {
+        banned.push_back(make_hash(i));
+    }
+
+    auto blocklist = filter::Blocklist::build<32>(banned);
+    ASSERT_TRUE(blocklist.has_value());
+
+    for(const auto& hash : banned) {
+        EXPECT_TRUE(blocklist->contains(hash));
+    }
+
+    hs::Hash128 short_hash {};
+    short_hash.buffer[0] = 0x01;
+    short_hash.buffer[7] = 0x80;
+    EXPECT_EQ(filter::key_of(short_hash), 0x8000'0000'0000'0001ull);
+}
+
+// ============================================================================
+// Bloom updates
+// ============================================================================
+
+TEST(BlocklistTest, Add_RequiresUpdateCapacity)
+{
+    auto blocklist = filter::Blocklist::build(make_keys(0, 100));
+    ASSERT_TRUE(blocklist.has_value());
+    EXPECT_EQ(blocklist->update_capacity(), 0u);
+    EXPECT_FALSE(blocklist->add(12345));
+    EXPECT_EQ(blocklist->updates(), 0u);
+}
+
+TEST(BlocklistTest, Add_KeysAreFoundWithBoundedFalsePositives)
+{
+    auto blocklist = filter::Blocklist::build(make_keys(0, 10'000), 10'000);
+    ASSERT_TRUE(blocklist.has_value());
+
+    auto added = make_keys(500'000, 10'000);
+    for(auto key : added) {
+        EXPECT_TRUE(blocklist->add(key));
+    }
+    EXPECT_EQ(blocklist->updates(), 10'000u);
+
+    for(auto key : added) {
+        ASSERT_TRUE(blocklist->contains(key));
+    }
+
+    // fuse 0.39% plus Bloom at capacity, about 1%
+    EXPECT_LT(false_positive_rate(*blocklist, 1'000'000'000, 100'000), 0.02);
+}
+
+// ============================================================================
+// Serialization
+// ============================================================================
+
+TEST(BlocklistTest, Encode_OpenRoundTrip)
+{
+    auto keys = make_keys(0, 5000);
+    auto blocklist = filter::Blocklist::build(keys, 100);
+    ASSERT_TRUE(blocklist.has_value());
+    blocklist->add(0xABCDEF);
+
+    std::vector<byte> bytes { 0xEE };
+    auto size = blocklist->encode(bytes);
+    EXPECT_EQ(bytes.size(), size + 1) << "encode appends";
+    EXPECT_EQ(size % 64, 0u);
+
+    auto opened = filter::Blocklist::open(std::span<const byte>(bytes).subspan(1));
+    ASSERT_TRUE(opened.has_value());
+    EXPECT_EQ(opened->size(), blocklist->size());
+    EXPECT_EQ(opened->updates(), 1u);
+    EXPECT_EQ(opened->update_capacity(), 100u);
+    EXPECT_TRUE(opened->contains(0xABCDEF));
+
+    for(auto key : keys) {
+        ASSERT_TRUE(opened->contains(key));
+    }
+
+    for(auto key : make_keys(1'000'000, 2000)) {
+        EXPECT_EQ(opened->contains(key), blocklist->contains(key));
+    }
+}
+
+TEST(BlocklistTest, Open_AddCopiesMappedBloom)
+{
+    auto blocklist = filter::Blocklist::build(make_keys(0, 100), 100);
+    ASSERT_TRUE(blocklist.has_value());
+
+    std::vector<byte> bytes;
+    blocklist->encode(bytes);
+    auto original = bytes;
+
+    auto opened = filter::Blocklist::open(bytes);
+    ASSERT_TRUE(opened.has_value());
+    EXPECT_TRUE(opened->add(777));
+    EXPECT_TRUE(opened->contains(777));
+    EXPECT_EQ(bytes, original) << "the source buffer is never written";
+}
+
+TEST(BlocklistTest, Open_RejectsMalformedBuffers)
+{
+    auto blocklist = filter::Blocklist::build(make_keys(0, 1000), 10);
+    ASSERT_TRUE(blocklist.has_value());
+
+    std::vector<byte> bytes;
+    blocklist->encode(bytes);
+
+    EXPECT_FALSE(filter::Blocklist::open(std::span<const byte>(bytes).first(63)).has_value());
+    EXPECT_FALSE(filter::Blocklist::open(std::span<const byte>(bytes).first(bytes.size() - 1)).has_value());
+
+    auto bad_magic = bytes;
+    bad_magic[0] = 'X';
+    EXPECT_FALSE(filter::Blocklist::open(bad_magic).has_value());
+
+    auto bad_version = bytes;
+    bad_version[4] = 99;
+    EXPECT_FALSE(filter::Blocklist::open(bad_version).has_value());
+
+    auto bad_segment = bytes;
+    bad_segment[24] = 3;
+    EXPECT_FALSE(filter::Blocklist::open(bad_segment).has_value());
+
+    auto trailing = bytes;
+    trailing.resize(bytes.size() + 64, 0);
+    EXPECT_FALSE(filter::Blocklist::open(trailing).has_value()) << "Bloom block count must match the payload";
+
+    auto fewer_blocks = bytes;
+    fewer_blocks[36] = static_cast<byte>(fewer_blocks[36] - 1);
+    EXPECT_FALSE(filter::Blocklist::open(fewer_blocks).has_value());
+}
+
+TEST(BlocklistTest, Open_RejectsUpdatesWithoutBloomBlocks)
+{
+    auto blocklist = filter::Blocklist::build(make_keys(0, 1000), 0);
+    ASSERT_TRUE(blocklist.has_value());
+
+    std::vector<byte> bytes;
+    blocklist->encode(bytes);
+    ASSERT_TRUE(filter::Blocklist::open(bytes).has_value());
+
+    // claims added keys but has no Bloom filter to look them up in
+    bytes[40] = 1;
+    EXPECT_FALSE(filter::Blocklist::open(bytes).has_value());
+}
+
+TEST(BlocklistTest, OpenPath_MapsFile)
+{
+    auto path = std::filesystem::temp_directory_path() / "identy_blocklist_test.idbl";
+    auto keys = make_keys(0, 3000);
+
+    {
+        auto blocklist = filter::Blocklist::build(keys);
+        ASSERT_TRUE(blocklist.has_value());
+        std::ofstream file(path, std::ios::binary);
+        blocklist->write(file);
+    }
+
+    {
+        auto mapped = filter::Blocklist::open(path);
+        ASSERT_TRUE(mapped.has_value());
+        EXPECT_EQ(mapped->size(), keys.size());
+        for(auto key : keys) {
+            ASSERT_TRUE(mapped->contains(key));
+        }
+
+        auto moved = std::move(*mapped);
+        EXPECT_TRUE(moved.contains(keys.front())) << "moving keeps the mapping";
+    }
+
+    EXPECT_FALSE(filter::Blocklist::open(path.string() + ".missing").has_value());
+
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
+} // namespace identy::test
@@ -0,0 +1,142 @@
+#pragma once
+
+#ifndef IDENTY_TEST_BOARDS_H
+#define IDENTY_TEST_BOARDS_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <Identy.h>
+
+namespace identy::test
+{
+
+/**
+ * @brief Appends one SMBIOS structure: 4-byte header, @p body, strings, double null
+ */
+inline void append_structure(std::vector<byte>& table, byte type, word handle, std::vector<byte> body, std::string strings = {})
+{
+    table.push_back(type);
+    table.push_back(static_cast<byte>(4 + body.size()));
+    table.push_back(static_cast<byte>(handle & 0xFF));
+    table.push_back(static_cast<byte>(handle >> 8));
+    table.insert(table.end(), body.begin(), body.end());
+
+    if(strings.empty()) {
+        table.push_back(0);
+    }
+    else {
+        table.insert(table.end(), strings.begin(), strings.end());
+        table.push_back(0);
+    }
+    table.push_back(0);
+}
+
+/**
+ * @brief What make_board() puts into a synthetic snapshot
+ */
+struct BoardSpec
+{
+    std::string vendor { "GenuineIntel" };
+    std::string brand { "Intel(R) Xeon(R) Gold 6248 CPU @ 2.50GHz" };
+    register_32 version { 0x000906EA };
+    register_32 logical_processors { 8 };
+    byte smbios_minor { 2 };
+    std::vector<byte> tables;
+
+    /** @brief Number of drives, all on @ref bus_type */
+    std::size_t drives { 1 };
+    PhysicalDriveInfo::BusType bus_type { PhysicalDriveInfo::NMVe };
+    std::string serial_prefix { "SN" };
+    std::string model_id { "Samsung SSD 990 PRO" };
+};
+
+/**
+ * @brief Synthetic snapshot number @p index of @p spec
+ *
+ * The UUID starts with @p index, little-endian, and drive d is serial
+ * "<serial_prefix>-<index>-<d>", so boards of different indices differ in
+ * fingerprint. NVMe drives are named nvme<d>n1, all others sd<letter>.
+ */
+inline MotherboardEx make_board(std::size_t index, const BoardSpec& spec = {})
+{
+    MotherboardEx mb;
+    mb.cpu.vendor = spec.vendor;
+    mb.cpu.extended_brand_string = spec.brand;
+    mb.cpu.version = spec.version;
+    mb.cpu.logical_processors_count = spec.logical_processors;
+    mb.smbios.major_version = 3;
+    mb.smbios.minor_version = spec.smbios_minor;
+    for(std::size_t i = 0; i < sizeof(index); ++i) {
+        mb.smbios.uuid[i] = static_cast<byte>(index >> (i * 8));
+    }
+    mb.smbios.raw_tables_data = spec.tables;
+
+    for(std::size_t d = 0; d < spec.drives; ++d) {
+        PhysicalDriveInfo drive;
+        drive.bus_type = spec.bus_type;
+        drive.device_name = spec.bus_type == PhysicalDriveInfo::NMVe ? "nvme" + std::to_string(d) + "n1"
+                                                                      : std::string("sd") + static_cast<char>('a' + d);
+        drive.serial = spec.serial_prefix + "-" + std::to_string(index) + "-" + std::to_string(d);
+        drive.model_id = spec.model_id;
+        mb.drives.push_back(drive);
+    }
+
+    return mb;
+}
+
+/**
+ * @brief Snapshot with every field set to a non-default value
+ */
+inline MotherboardEx make_synthetic_board()
+{
+    MotherboardEx mb;
+
+    mb.cpu.vendor = "GenuineIntel";
+    mb.cpu.version = 0x000906EA;
+    mb.cpu.hypervisor_bit = true;
+    mb.cpu.brand_index = 3;
+    mb.cpu.clflush_line_size = 8;
+    mb.cpu.logical_processors_count = 12;
+    mb.cpu.apic_id = 7;
+    mb.cpu.extended_brand_string = "Intel(R) Core(TM) i7-8700 CPU @ 3.20GHz";
+    mb.cpu.hypervisor_signature = "KVMKVMKVM";
+    mb.cpu.instruction_set.basic = static_cast<register_32>(0xBFEBFBFF);
+    mb.cpu.instruction_set.modern = 0x7FFAFBBF;
+    mb.cpu.instruction_set.extended_modern[0] = 0x029C67AF;
+    mb.cpu.instruction_set.extended_modern[1] = -1;
+    mb.cpu.instruction_set.extended_modern[2] = 0x0C000400;
+    mb.cpu.too_old = true;
+
+    mb.smbios.is_20_calling_used = true;
+    mb.smbios.major_version = 3;
+    mb.smbios.minor_version = 2;
+    mb.smbios.dmi_version = 1;
+    for(std::size_t i = 0; i < SMBIOS_uuid_length; ++i) {
+        mb.smbios.uuid[i] = static_cast<byte>(0xA0 + i);
+    }
+    mb.smbios.raw_tables_data = { 0x01, 0x1B, 0x01, 0x00, 0x01, 0x02, 0x00, 0x00, 0x00 };
+
+    PhysicalDriveInfo nvme;
+    nvme.bus_type = PhysicalDriveInfo::NMVe;
+    nvme.device_name = "nvme0n1";
+    nvme.serial = "S4EWNX0R123456";
+    nvme.model_id = "Samsung SSD 970 EVO Plus 1TB";
+    nvme.vendor_id = "Samsung";
+    nvme.product_id = "970 EVO Plus";
+
+    PhysicalDriveInfo sata;
+    sata.bus_type = PhysicalDriveInfo::SAS;
+    sata.device_name = "sda";
+    sata.serial = "WD-WCC4E0000000";
+    sata.path_count = 2;
+
+    mb.drives = { nvme, sata };
+
+    return mb;
+}
+
+} // namespace identy::test
+
+#endif // IDENTY_TEST_BOARDS_H
@@ -0,0 +1,260 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <Identy.h>
+#include "test_config.hxx"
+
+namespace identy::test
+{
+
+namespace
+{
+class CacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        root_ = std::filesystem::temp_directory_path()
+            / ("identy_cache_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+
+        sysfs_ = root_ / "tree";
+        cache_dir_ = root_ / "cache";
+    }
+
+    void TearDown() override
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+    }
+
+    void write_tree()
+    {
+        fixture::SysfsSpec spec;
+        spec.block_devices = 5;
+        ASSERT_TRUE(fixture::write_sysfs_tree(sysfs_, spec));
+    }
+
+    void overwrite(const std::filesystem::path& path, std::string_view contents)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    }
+
+    void flip_byte(std::size_t offset)
+    {
+        auto path = cache_dir_ / cache::cache_file_name;
+
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(static_cast<std::streamoff>(offset));
+        char c = 0;
+        file.get(c);
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.put(static_cast<char>(c ^ 0x5A));
+    }
+
+    std::filesystem::path root_;
+    std::filesystem::path sysfs_;
+    std::filesystem::path cache_dir_;
+};
+
+bool same_hash(const hs::Hash256& lhs, const hs::Hash256& rhs)
+{
+    return std::memcmp(lhs.buffer, rhs.buffer, sizeof(lhs.buffer)) == 0;
+}
+} // namespace
+
+// ============================================================================
+// Cache key
+// ============================================================================
+
+TEST_F(CacheTest, CurrentKey_ReadsInvariants)
+{
+#ifdef IDENTY_LINUX
+    write_tree();
+    ScopedSysfsRoot root(sysfs_);
+
+    auto key = cache::current_key();
+    ASSERT_TRUE(key.has_value());
+    EXPECT_EQ(key->boot_id.size(), 36u) << key->boot_id;
+    EXPECT_EQ(key->dmi_size, fixture::SysfsSpec {}.dmi_table_size);
+    EXPECT_NE(key->block_names_crc, 0u);
+    EXPECT_EQ(key->tier, SmbiosTier::Table);
+
+    EXPECT_EQ(cache::current_key(), key) << "key is stable";
+#else
+    GTEST_SKIP() << "The cache key uses Linux invariants";
+#endif
+}
+
+TEST_F(CacheTest, CurrentKey_UnavailableDuringReplay)
+{
+    CaptureBundle bundle;
+    ScopedReplay replay(bundle);
+
+    EXPECT_FALSE(cache::current_key().has_value());
+    EXPECT_FALSE(cache::store(cache_dir_, MotherboardEx {}));
+    EXPECT_FALSE(std::filesystem::exists(cache_dir_ / cache::cache_file_name));
+}
+
+// ============================================================================
+// Hits
+// ============================================================================
+
+TEST_F(CacheTest, CachedFingerprint_CollectsOnceThenHits)
+{
+#ifdef IDENTY_LINUX
+    write_tree();
+    ScopedSysfsRoot root(sysfs_);
+
+    EXPECT_FALSE(cache::load_fingerprint(cache_dir_).has_value());
+
+    auto expected = hs::hash(snap_motherboard_ex());
+    auto first = cache::cached_fingerprint(cache_dir_);
+    EXPECT_TRUE(same_hash(first, expected));
+    ASSERT_TRUE(std::filesystem::exists(cache_dir_ / cache::cache_file_name));
+
+    auto loaded = cache::load_fingerprint(cache_dir_);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_TRUE(same_hash(*loaded, expected));
+
+    auto snapshot = cache::load_snapshot(cache_dir_);
+    ASSERT_TRUE(snapshot.has_value());
+    EXPECT_EQ(snapshot->drives.size(), 5u);
+    EXPECT_TRUE(same_hash(hs::hash(*snapshot), expected));
+
+    EXPECT_TRUE(same_hash(hs::hash(cache::cached_snapshot(cache_dir_)), expected));
+#else
+    GTEST_SKIP() << "The cache key uses Linux invariants";
+#endif
+}
+
+TEST_F(CacheTest, Invalidate_RemovesFile)
+{
+#ifdef IDENTY_LINUX
+    write_tree();
+    ScopedSysfsRoot root(sysfs_);
+
+    ASSERT_TRUE(cache::store(cache_dir_, snap_motherboard_ex()));
+    ASSERT_TRUE(cache::load_fingerprint(cache_dir_).has_value());
+
+    cache::invalidate(cache_dir_);
+    EXPECT_FALSE(std::filesystem::exists(cache_dir_ / cache::cache_file_name));
+    EXPECT_FALSE(cache::load_fingerprint(cache_dir_).has_value());
+#else
+    GTEST_SKIP() << "The cache key uses Linux invariants";
+#endif
+}
+
+// ============================================================================
+// Validation
+// ============================================================================
+
+TEST_F(CacheTest, Miss_AfterReboot)
+{
+#ifdef IDENTY_LINUX
+    write_tree();
+    ScopedSysfsRoot root(sysfs_);
+
+    ASSERT_TRUE(cache::store(cache_dir_, snap_motherboard_ex()));
+
+    overwrite(sysfs_ / "proc/sys/kernel/random/boot_id", "00000000-1111-2222-3333-444444444444\n");
+    EXPECT_FALSE(cache::load_fingerprint(cache_dir_).has_value());
+#else
+    GTEST_SKIP() << "The cache key uses Linux invariants";
+#endif
+}
+
+TEST_F(CacheTest, Miss_AfterFirmwareChange)
+{
+#ifdef IDENTY_LINUX
+    write_tree();
+    ScopedSysfsRoot root(sysfs_);
+
+    ASSERT_TRUE(cache::store(cache_dir_, snap_motherboard_ex()));
+
+    auto table = fixture::make_smbios_table(2048, 9);
+    overwrite(sysfs_ / "sys/firmware/dmi/tables/DMI", { reinterpret_cast<const char*>(table.data()), table.size() });
+    EXPECT_FALSE(cache::load_fingerprint(cache_dir_).has_value());
+#else
+    GTEST_SKIP() << "The cache key uses Linux invariants";
+#endif
+}
+
+TEST_F(CacheTest, Miss_AfterDriveHotplug)
+{
+#ifdef IDENTY_LINUX
+    write_tree();
+    ScopedSysfsRoot root(sysfs_);
+
+    ASSERT_TRUE(cache::store(cache_dir_, snap_motherboard_ex()));
+    ASSERT_TRUE(cache::load_fingerprint(cache_dir_).has_value());
+
+    std::filesystem::create_directories(sysfs_ / "sys/block/sdz");
+    EXPECT_FALSE(cache::load_fingerprint(cache_dir_).has_value());
+
+    auto refreshed = cache::cached_fingerprint(cache_dir_);
+    EXPECT_TRUE(same_hash(refreshed, hs::hash(snap_motherboard_ex())));
+    EXPECT_TRUE(cache::load_fingerprint(cache_dir_).has_value()) << "the miss rewrote the cache";
+#else
+    GTEST_SKIP() << "The cache key uses Linux invariants";
+#endif
+}
+
+TEST_F(CacheTest, Miss_AfterSmbiosTierChange)
+{
+#ifdef IDENTY_LINUX
+    write_tree();
+
+    // a table that exists but cannot be read, as for an unprivileged process
+    std::filesystem::remove(sysfs_ / "sys/firmware/dmi/tables/DMI");
+    std::filesystem::create_directory(sysfs_ / "sys/firmware/dmi/tables/DMI");
+
+    ScopedSysfsRoot root(sysfs_);
+
+    auto attributes = snap_motherboard_ex();
+    ASSERT_EQ(attributes.smbios.tier, SmbiosTier::Attributes);
+    ASSERT_TRUE(cache::store(cache_dir_, attributes));
+    ASSERT_TRUE(cache::load_fingerprint(cache_dir_).has_value());
+
+    // only the tier moves: same boot, same table metadata, same drives
+    std::filesystem::remove(sysfs_ / "sys/class/dmi/id/product_uuid");
+    std::filesystem::remove(sysfs_ / "sys/class/dmi/id/smbios_version");
+    EXPECT_FALSE(cache::load_fingerprint(cache_dir_).has_value());
+    EXPECT_TRUE(same_hash(cache::cached_fingerprint(cache_dir_), hs::hash(snap_motherboard_ex())));
+#else
+    GTEST_SKIP() << "The cache key uses Linux invariants";
+#endif
+}
+
+TEST_F(CacheTest, Miss_OnCorruption)
+{
+#ifdef IDENTY_LINUX
+    write_tree();
+    ScopedSysfsRoot root(sysfs_);
+
+    ASSERT_TRUE(cache::store(cache_dir_, snap_motherboard_ex()));
+
+    // snapshot payload: the fingerprint only reads the header
+    flip_byte(200);
+    EXPECT_TRUE(cache::load_fingerprint(cache_dir_).has_value());
+    EXPECT_FALSE(cache::load_snapshot(cache_dir_).has_value());
+
+    // fingerprint bytes in the header
+    ASSERT_TRUE(cache::store(cache_dir_, snap_motherboard_ex()));
+    flip_byte(90);
+    EXPECT_FALSE(cache::load_fingerprint(cache_dir_).has_value());
+
+    overwrite(cache_dir_ / cache::cache_file_name, "IDFC");
+    EXPECT_FALSE(cache::load_fingerprint(cache_dir_).has_value());
+#else
+    GTEST_SKIP() << "The cache key uses Linux invariants";
+#endif
+}
+
+} // namespace identy::test
@@ -0,0 +1,272 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Identy.h>
+#include "test_config.hxx"
+
+namespace identy::test
+{
+
+namespace
+{
+void add_cpuid(CaptureBundle& bundle, register_32 leaf, register_32 subleaf, register_32 eax, register_32 ebx, register_32 ecx, register_32 edx)
+{
+    register_32 registers[4] = { eax, ebx, ecx, edx };
+    bundle.add_cpuid(leaf, subleaf, registers);
+}
+
+register_32 chars(const char (&text)[5])
+{
+    register_32 value = 0;
+    std::memcpy(&value, text, 4);
+    return value;
+}
+
+std::vector<byte> make_dmi_table()
+{
+    // Type 1 (System Information) carrying the UUID at offset 8, then end-of-table
+    std::vector<byte> table = { 1, 24, 0x01, 0x00, 1, 2, 3, 4 };
+    for(byte i = 0; i < 16; ++i) {
+        table.push_back(static_cast<byte>(0xA0 + i));
+    }
+    table.insert(table.end(), { 'A', 'c', 'm', 'e', 0, 0 });
+    table.insert(table.end(), { 127, 4, 0xFF, 0xFF, 0, 0 });
+    return table;
+}
+
+std::vector<byte> make_entry_point()
+{
+    std::vector<byte> entry(24, 0);
+    std::memcpy(entry.data(), "_SM3_", 5);
+    entry[7] = 3;
+    entry[8] = 5;
+    return entry;
+}
+
+CaptureBundle make_bundle()
+{
+    CaptureBundle bundle;
+
+    add_cpuid(bundle, 0, 0, 1, chars("Genu"), chars("ntel"), chars("ineI"));
+    add_cpuid(bundle, 1, 0, 0x000906EA, 0x00100800, static_cast<register_32>(0x80000000), 0x0F8BFBFF);
+    add_cpuid(bundle, static_cast<register_32>(0x40000000), 0, 0x40000001, chars("KVMK"), chars("VMKV"), chars("M\0\0\0"));
+
+    bundle.add_file("/sys/firmware/dmi/tables/DMI", std::span<const byte>(make_dmi_table()));
+    bundle.add_file("/sys/firmware/dmi/tables/smbios_entry_point", std::span<const byte>(make_entry_point()));
+
+    bundle.add_directory("/sys/block", { "sda", "nvme0n1", "loop0" });
+    bundle.add_file("/sys/block/nvme0n1/serial", "  S4EWNX0R123456   \n");
+    bundle.add_link("/sys/block/sda/device/subsystem", "../../../../bus/scsi");
+    bundle.add_file("/sys/block/sda/device/serial", "WD-WCC4N0000001\n");
+
+    bundle.add_directory("/sys/class/net", { "lo", "eth0" });
+    bundle.add_file("/sys/class/net/lo/type", "772\n");
+    bundle.add_file("/sys/class/net/eth0/type", "1\n");
+    bundle.add_link("/sys/class/net/eth0/device/driver", "../../../bus/virtio/drivers/virtio_net");
+
+    return bundle;
+}
+
+bool has_flag(const vm::HeuristicVerdict& verdict, vm::VMFlags flag)
+{
+    return std::ranges::find(verdict.detections, flag) != verdict.detections.end();
+}
+
+std::vector<byte> encoded(const MotherboardEx& mb)
+{
+    std::vector<byte> out;
+    io::encode_binary(out, mb);
+    return out;
+}
+} // namespace
+
+// ============================================================================
+// Replay of synthetic bundles
+// ============================================================================
+
+TEST(CaptureTest, Replay_BuildsSnapshotFromBundle)
+{
+#ifdef IDENTY_LINUX
+    auto bundle = make_bundle();
+
+    ScopedReplay replay(bundle);
+    auto mb = snap_motherboard_ex();
+
+    EXPECT_EQ(mb.cpu.vendor, "GenuineIntel");
+    EXPECT_EQ(mb.cpu.version, 0x000906EA);
+    EXPECT_TRUE(mb.cpu.hypervisor_bit);
+    EXPECT_EQ(mb.cpu.hypervisor_signature, "KVMKVMKVM");
+    EXPECT_TRUE(mb.cpu.too_old);
+
+    EXPECT_EQ(mb.smbios.major_version, 3);
+    EXPECT_EQ(mb.smbios.minor_version, 5);
+    EXPECT_EQ(mb.smbios.raw_tables_data, make_dmi_table());
+    EXPECT_EQ(mb.smbios.uuid[0], 0xA0);
+    EXPECT_EQ(mb.smbios.uuid[15], 0xAF);
+
+    ASSERT_EQ(mb.drives.size(), 2u);
+    EXPECT_EQ(mb.drives[0].serial, "S4EWNX0R123456");
+    EXPECT_EQ(mb.drives[0].bus_type, PhysicalDriveInfo::NMVe);
+    EXPECT_EQ(mb.drives[1].serial, "WD-WCC4N0000001");
+    EXPECT_EQ(mb.drives[1].bus_type, PhysicalDriveInfo::SATA);
+#else
+    GTEST_SKIP() << "Bundle inputs are Linux sysfs paths";
+#endif
+}
+
+TEST(CaptureTest, Replay_AnalyzeFullSeesRecordedAdapters)
+{
+#ifdef IDENTY_LINUX
+    auto bundle = make_bundle();
+
+    ScopedReplay replay(bundle);
+    auto verdict = vm::analyze_full(snap_motherboard_ex());
+
+    EXPECT_TRUE(has_flag(verdict, vm::VMFlags::Cpu_Hypervisor_bit));
+    EXPECT_TRUE(has_flag(verdict, vm::VMFlags::Platform_VirtualNetworkAdaptersPresent));
+    EXPECT_TRUE(has_flag(verdict, vm::VMFlags::Platform_OnlyVirtualNetworkAdapters));
+#else
+    GTEST_SKIP() << "Bundle inputs are Linux sysfs paths";
+#endif
+}
+
+TEST(CaptureTest, Replay_IsDeterministic)
+{
+    auto bundle = make_bundle();
+
+    ScopedReplay replay(bundle);
+
+    auto first = snap_motherboard_ex();
+    auto first_verdict = vm::analyze_full(first);
+
+    for(int i = 0; i < 10; ++i) {
+        auto again = snap_motherboard_ex();
+        EXPECT_EQ(encoded(again), encoded(first));
+        EXPECT_EQ(vm::analyze_full(again).detections, first_verdict.detections);
+    }
+}
+
+TEST(CaptureTest, Replay_MissingInputsReadAsAbsent)
+{
+    CaptureBundle bundle;
+
+    ScopedReplay replay(bundle);
+    auto mb = snap_motherboard_ex();
+
+    EXPECT_TRUE(mb.cpu.vendor.empty());
+    EXPECT_FALSE(mb.cpu.hypervisor_bit);
+    EXPECT_TRUE(mb.smbios.raw_tables_data.empty());
+    EXPECT_TRUE(mb.drives.empty());
+}
+
+TEST(CaptureTest, Replay_ScopesNestAndRestore)
+{
+    auto live = snap_motherboard_ex();
+    auto bundle = make_bundle();
+    CaptureBundle empty;
+
+    {
+        ScopedReplay outer(bundle);
+        {
+            ScopedReplay inner(empty);
+            EXPECT_TRUE(snap_motherboard_ex().cpu.vendor.empty());
+        }
+        EXPECT_EQ(snap_motherboard_ex().cpu.vendor, "GenuineIntel");
+    }
+
+    EXPECT_EQ(snap_motherboard_ex().cpu.vendor, live.cpu.vendor);
+}
+
+// ============================================================================
+// Live capture
+// ============================================================================
+
+TEST(CaptureTest, Capture_ReplayMatchesLiveSnapshot)
+{
+    auto live = snap_motherboard_ex();
+    auto live_verdict = vm::analyze_full(live);
+
+    auto bundle = capture_hardware();
+    EXPECT_GT(bundle.cpuid_count(), 0u);
+
+    ScopedReplay replay(bundle);
+    auto replayed = snap_motherboard_ex();
+
+    EXPECT_EQ(encoded(replayed), encoded(live));
+    EXPECT_EQ(vm::analyze_full(replayed).detections, live_verdict.detections);
+}
+
+// ============================================================================
+// Encoding
+// ============================================================================
+
+TEST(CaptureTest, Encode_RoundTrip)
+{
+    auto bundle = make_bundle();
+
+    std::vector<byte> bytes;
+    auto size = bundle.encode(bytes);
+    EXPECT_EQ(size, bytes.size());
+
+    auto decoded = CaptureBundle::decode(bytes);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->cpuid_count(), bundle.cpuid_count());
+    EXPECT_EQ(decoded->record_count(), bundle.record_count());
+
+    std::vector<byte> again;
+    decoded->encode(again);
+    EXPECT_EQ(again, bytes);
+
+    std::ostringstream stream;
+    bundle.write(stream);
+    EXPECT_EQ(stream.str(), std::string(bytes.begin(), bytes.end()));
+
+    MotherboardEx from_original;
+    MotherboardEx from_decoded;
+    {
+        ScopedReplay replay(bundle);
+        from_original = snap_motherboard_ex();
+    }
+    {
+        ScopedReplay replay(*decoded);
+        from_decoded = snap_motherboard_ex();
+    }
+    EXPECT_EQ(encoded(from_decoded), encoded(from_original));
+}
+
+TEST(CaptureTest, Encode_AddReplacesExistingRecord)
+{
+    CaptureBundle bundle;
+    bundle.add_file("/a", "one");
+    bundle.add_file("/a", "two");
+    bundle.add_existing("/a");
+
+    EXPECT_EQ(bundle.record_count(), 2u);
+
+    auto data = bundle.find(CaptureRecordKind::File, "/a");
+    ASSERT_TRUE(data.has_value());
+    EXPECT_EQ(std::string(data->begin(), data->end()), "two");
+    EXPECT_FALSE(bundle.find(CaptureRecordKind::Link, "/a").has_value());
+}
+
+TEST(CaptureTest, Decode_RejectsMalformedInput)
+{
+    std::vector<byte> bytes;
+    make_bundle().encode(bytes);
+
+    EXPECT_FALSE(CaptureBundle::decode({}).has_value());
+
+    auto bad_magic = bytes;
+    bad_magic[0] = 'X';
+    EXPECT_FALSE(CaptureBundle::decode(bad_magic).has_value());
+
+    for(std::size_t cut : { std::size_t { 15 }, std::size_t { 40 }, bytes.size() - 1 }) {
+        EXPECT_FALSE(CaptureBundle::decode(std::span<const byte>(bytes.data(), cut)).has_value()) << cut;
+    }
+}
+
+} // namespace identy::test
@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <Identy.h>
+#include "test_boards.hxx"
+#include "test_config.hxx"
+
+namespace identy::test
+{
+
+namespace
+{
+std::vector<std::uint64_t> make_values(std::uint64_t first, std::size_t count)
+{
+    std::vector<std::uint64_t> values(count);
+    for(std::size_t i = 0; i < count; ++i) {
+        values[i] = first + i;
+    }
+    return values;
+}
+
+/** Board @p seed of a fleet where every machine has the same CPU and a unique UUID and drive */
+// one model, two logical processor counts, and a USB stick the fingerprint ignores
+std::vector<MotherboardEx> make_fleet(std::size_t count)
+{
+    BoardSpec spec;
+    spec.brand = "Intel(R) Xeon(R) Gold 6338";
+    spec.version = 0x606A6;
+    spec.smbios_minor = 4;
+    spec.model_id = "Samsung SSD 980";
+
+    std::vector<MotherboardEx> boards;
+    for(std::size_t i = 0; i < count; ++i) {
+        auto& mb = boards.emplace_back(make_board(i, spec));
+        mb.cpu.logical_processors_count = i % 4 == 0 ? 64 : 128;
+
+        PhysicalDriveInfo stick;
+        stick.device_name = "sdb";
+        stick.serial = "USB" + std::to_string(i);
+        stick.bus_type = PhysicalDriveInfo::USB;
+        mb.drives.push_back(stick);
+    }
+    return boards;
+}
+} // namespace
+
+// ============================================================================
+// HyperLogLog
+// ============================================================================
+
+TEST(CardinalityTest, HyperLogLog_EstimatesWithinError)
+{
+    for(std::size_t count : { 0u, 1u, 100u, 10'000u, 1'000'000u }) {
+        sketch::HyperLogLog hll;
+        hll.add(make_values(count * 7, count));
+
+        // four standard errors
+        auto tolerance = std::max(1.0, 4 * hll.standard_error() * static_cast<double>(count));
+        EXPECT_NEAR(hll.estimate(), static_cast<double>(count), tolerance) << "count=" << count;
+    }
+}
+
+TEST(CardinalityTest, HyperLogLog_IgnoresDuplicates)
+{
+    auto values = make_values(0, 5000);
+
+    sketch::HyperLogLog once;
+    once.add(values);
+
+    sketch::HyperLogLog repeated;
+    for(int i = 0; i < 3; ++i) {
+        for(auto value : values) {
+            repeated.add(value);
+        }
+    }
+
+    EXPECT_EQ(once, repeated) << "single and batched adds agree";
+}
+
+TEST(CardinalityTest, HyperLogLog_MergeEstimatesUnion)
+{
+    sketch::HyperLogLog a;
+    sketch::HyperLogLog b;
+    a.add(make_values(0, 60'000));
+    b.add(make_values(40'000, 60'000));
+
+    sketch::HyperLogLog both;
+    both.add(make_values(0, 100'000));
+
+    ASSERT_TRUE(a.merge(b));
+    EXPECT_EQ(a, both) << "merging equals counting the union";
+
+    sketch::HyperLogLog coarse(10);
+    EXPECT_FALSE(a.merge(coarse));
+    EXPECT_EQ(a, both);
+}
+
+TEST(CardinalityTest, HyperLogLog_ClampsPrecision)
+{
+    EXPECT_EQ(sketch::HyperLogLog(1).precision(), sketch::HyperLogLog::min_precision);
+    EXPECT_EQ(sketch::HyperLogLog(30).precision(), sketch::HyperLogLog::max_precision);
+    EXPECT_EQ(sketch::HyperLogLog(12).registers().size(), 4096u);
+}
+
+TEST(CardinalityTest, HyperLogLog_EncodeDecodeRoundTrip)
+{
+    sketch::HyperLogLog hll(8);
+    hll.add(make_values(0, 1000));
+
+    std::vector<byte> bytes;
+    EXPECT_EQ(hll.encode(bytes), 8u + 256u);
+
+    auto decoded = sketch::HyperLogLog::decode(bytes);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(*decoded, hll);
+
+    EXPECT_FALSE(sketch::HyperLogLog::decode(std::span<const byte>(bytes).first(bytes.size() - 1)).has_value());
+
+    auto bad_register = bytes;
+    bad_register[8] = 64 - 8 + 2;
+    EXPECT_FALSE(sketch::HyperLogLog::decode(bad_register).has_value());
+
+    auto bad_precision = bytes;
+    bad_precision[5] = 30;
+    EXPECT_FALSE(sketch::HyperLogLog::decode(bad_precision).has_value());
+}
+
+// ============================================================================
+// Field cardinality
+// ============================================================================
+
+TEST(CardinalityTest, FieldDigests_FollowHashedFields)
+{
+    auto mb = make_fleet(2)[1];
+
+    std::vector<sketch::FieldDigest> digests;
+    auto count = sketch::field_digests(mb, digests);
+
+    // 9 CPU/SMBIOS fields, 3 per hashed drive, fingerprint, hypervisor, model; no structures
+    EXPECT_EQ(count, 9u + 3u + 1u + 1u + 1u);
+
+    std::size_t serials = 0;
+    for(const auto& digest : digests) {
+        serials += digest.field == sketch::Field::DriveSerial ? 1 : 0;
+    }
+    EXPECT_EQ(serials, 1u) << "USB drives are skipped like in default_hash_ex()";
+
+    auto renamed = mb;
+    renamed.drives[0].device_name = "nvme1n1";
+    std::vector<sketch::FieldDigest> renamed_digests;
+    sketch::field_digests(renamed, renamed_digests);
+
+    for(std::size_t i = 0; i < digests.size(); ++i) {
+        auto changes = digests[i].field == sketch::Field::DriveDeviceName || digests[i].field == sketch::Field::Fingerprint;
+        EXPECT_EQ(digests[i].digest != renamed_digests[i].digest, changes) << sketch::field_name(digests[i].field);
+    }
+}
+
+TEST(CardinalityTest, FieldCardinality_CountsDistinctValuesPerField)
+{
+    auto boards = make_fleet(20'000);
+
+    sketch::FieldCardinality counts;
+    counts.add(boards);
+
+    EXPECT_EQ(counts.snapshots(), boards.size());
+    EXPECT_NEAR(counts.estimate(sketch::Field::CpuVendor), 1.0, 0.5);
+    EXPECT_NEAR(counts.estimate(sketch::Field::CpuLogicalProcessors), 2.0, 0.5);
+    EXPECT_NEAR(counts.estimate(sketch::Field::DriveModel), 1.0, 0.5);
+    EXPECT_NEAR(counts.estimate(sketch::Field::SmbiosUuid), 20'000.0, 20'000.0 * 0.04);
+    EXPECT_NEAR(counts.estimate(sketch::Field::DriveSerial), 20'000.0, 20'000.0 * 0.04);
+    EXPECT_NEAR(counts.estimate(sketch::Field::Fingerprint), 20'000.0, 20'000.0 * 0.04);
+}
+
+TEST(CardinalityTest, FieldCardinality_BatchAndMergeMatchSerial)
+{
+    auto boards = make_fleet(3000);
+
+    sketch::FieldCardinality serial;
+    for(const auto& mb : boards) {
+        serial.add(mb);
+    }
+
+    exec::WorkStealingPool pool(3);
+    sketch::FieldCardinality parallel;
+    parallel.add_batch(boards, pool);
+
+    sketch::FieldCardinality first;
+    sketch::FieldCardinality second;
+    first.add(std::span<const MotherboardEx>(boards).first(1000));
+    second.add(std::span<const MotherboardEx>(boards).subspan(1000));
+    ASSERT_TRUE(first.merge(second));
+
+    for(std::size_t i = 0; i < sketch::field_count; ++i) {
+        auto field = static_cast<sketch::Field>(i);
+        EXPECT_EQ(parallel.sketch(field), serial.sketch(field)) << sketch::field_name(field);
+        EXPECT_EQ(first.sketch(field), serial.sketch(field)) << sketch::field_name(field);
+    }
+    EXPECT_EQ(parallel.snapshots(), serial.snapshots());
+    EXPECT_EQ(first.snapshots(), serial.snapshots());
+
+    EXPECT_FALSE(first.merge(sketch::FieldCardinality(10)));
+}
+
+TEST(CardinalityTest, FieldCardinality_EncodeDecodeRoundTrip)
+{
+    sketch::FieldCardinality counts(6);
+    counts.add(make_fleet(100));
+
+    std::vector<byte> bytes;
+    EXPECT_EQ(counts.encode(bytes), 16u + sketch::field_count * 64u);
+
+    auto decoded = sketch::FieldCardinality::decode(bytes);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->precision(), 6u);
+    EXPECT_EQ(decoded->snapshots(), 100u);
+    for(std::size_t i = 0; i < sketch::field_count; ++i) {
+        auto field = static_cast<sketch::Field>(i);
+        EXPECT_EQ(decoded->sketch(field), counts.sketch(field));
+    }
+
+    auto bad_magic = bytes;
+    bad_magic[3] = 'X';
+    EXPECT_FALSE(sketch::FieldCardinality::decode(bad_magic).has_value());
+
+    auto extra_field = bytes;
+    extra_field[6] = static_cast<byte>(sketch::field_count + 1);
+    EXPECT_FALSE(sketch::FieldCardinality::decode(extra_field).has_value());
+
+    EXPECT_FALSE(sketch::FieldCardinality::decode(std::span<const byte>(bytes).first(100)).has_value());
+}
+
+} // namespace identy::test
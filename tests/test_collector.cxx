@@ -0,0 +1,315 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Identy.h>
+#include "test_config.hxx"
+
+namespace identy::test
+{
+
+namespace
+{
+using namespace std::chrono_literals;
+
+collect::Collector make_collector(std::string name, std::string output, collect::CostClass cost = collect::CostClass::Cheap,
+    collect::Encoding encoding = collect::Encoding::Binary, std::chrono::milliseconds delay = 0ms)
+{
+    collect::Collector collector;
+    collector.name = std::move(name);
+    collector.cost = cost;
+    collector.encoding = encoding;
+    collector.collect = [output = std::move(output), delay]() -> std::optional<std::vector<byte>> {
+        std::this_thread::sleep_for(delay);
+        return std::vector<byte>(output.begin(), output.end());
+    };
+
+    return collector;
+}
+
+const collect::Result* find(const std::vector<collect::Result>& results, std::string_view name)
+{
+    auto it = std::ranges::find(results, name, &collect::Result::name);
+    return it == results.end() ? nullptr : &*it;
+}
+
+bool same_hash(const hs::Hash256& lhs, const hs::Hash256& rhs)
+{
+    return std::memcmp(lhs.buffer, rhs.buffer, sizeof(lhs.buffer)) == 0;
+}
+
+hs::Hash256 fold_of(const collect::Registry& registry)
+{
+    return collect::fold(hs::Hash256 {}, collect::run(registry));
+}
+} // namespace
+
+// ============================================================================
+// Registry
+// ============================================================================
+
+TEST(CollectorTest, Registry_RejectsInvalidAndDuplicateNames)
+{
+    collect::Registry registry;
+
+    EXPECT_TRUE(registry.add(make_collector("b", "1")));
+    EXPECT_TRUE(registry.add(make_collector("a", "2")));
+    EXPECT_FALSE(registry.add(make_collector("a", "3"))) << "duplicate name";
+    EXPECT_FALSE(registry.add(make_collector("", "4"))) << "empty name";
+
+    collect::Collector no_function;
+    no_function.name = "c";
+    EXPECT_FALSE(registry.add(no_function));
+
+    auto collectors = registry.collectors();
+    ASSERT_EQ(collectors.size(), 2u);
+    EXPECT_EQ(collectors[0].name, "a");
+    EXPECT_EQ(collectors[1].name, "b");
+
+    EXPECT_TRUE(registry.remove("a"));
+    EXPECT_FALSE(registry.remove("a"));
+    EXPECT_EQ(registry.size(), 1u);
+
+    registry.clear();
+    EXPECT_EQ(registry.size(), 0u);
+}
+
+// ============================================================================
+// Folding
+// ============================================================================
+
+TEST(CollectorTest, Fingerprint_WithoutCollectorsEqualsSnapshotHash)
+{
+    collect::Registry registry;
+
+    auto result = collect::fingerprint(registry);
+    EXPECT_TRUE(result.components.empty());
+    EXPECT_TRUE(same_hash(result.hash, hs::hash(result.snapshot)));
+}
+
+TEST(CollectorTest, Fold_IndependentOfRegistrationAndCompletionOrder)
+{
+    collect::Registry first;
+    first.add(make_collector("gpu", "10de:2484", collect::CostClass::Moderate, collect::Encoding::Binary, 30ms));
+    first.add(make_collector("tpm", "ek", collect::CostClass::Moderate));
+
+    collect::Registry second;
+    second.add(make_collector("tpm", "ek", collect::CostClass::Moderate, collect::Encoding::Binary, 30ms));
+    second.add(make_collector("gpu", "10de:2484", collect::CostClass::Cheap));
+
+    EXPECT_TRUE(same_hash(fold_of(first), fold_of(second)));
+    EXPECT_FALSE(same_hash(fold_of(first), hs::Hash256 {}));
+}
+
+TEST(CollectorTest, Fold_CanonicalizesEncodings)
+{
+    collect::Registry first;
+    first.add(make_collector("macs", "aa:bb\n00:11\naa:bb\n", collect::CostClass::Cheap, collect::Encoding::Set));
+    first.add(make_collector("instance", "i-0123\n", collect::CostClass::Cheap, collect::Encoding::Text));
+
+    collect::Registry second;
+    second.add(make_collector("macs", "00:11\r\naa:bb", collect::CostClass::Cheap, collect::Encoding::Set));
+    second.add(make_collector("instance", "i-0123", collect::CostClass::Cheap, collect::Encoding::Text));
+
+    EXPECT_TRUE(same_hash(fold_of(first), fold_of(second)));
+
+    auto results = collect::run(first);
+    ASSERT_NE(find(results, "macs"), nullptr);
+    EXPECT_EQ(std::string(find(results, "macs")->value.begin(), find(results, "macs")->value.end()), "00:11\naa:bb\n");
+}
+
+TEST(CollectorTest, Fold_IgnoresVolatileComponents)
+{
+    collect::Registry registry;
+    auto uptime = make_collector("uptime", "1234");
+    uptime.stability = collect::Stability::Volatile;
+    registry.add(uptime);
+
+    auto results = collect::run(registry);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].status, collect::Status::Ok);
+
+    hs::Hash256 base {};
+    base.buffer[0] = 7;
+    EXPECT_TRUE(same_hash(collect::fold(base, results), base));
+}
+
+TEST(CollectorTest, Fold_SkipsComponentsWithoutValue)
+{
+    collect::Registry registry;
+    registry.add(make_collector("gpu", "10de:2484"));
+
+    collect::Collector missing;
+    missing.name = "tpm";
+    missing.collect = [] { return std::optional<std::vector<byte>> {}; };
+    registry.add(missing);
+
+    collect::Registry present;
+    present.add(make_collector("gpu", "10de:2484"));
+
+    EXPECT_TRUE(same_hash(fold_of(registry), fold_of(present))) << "a failed component counts as absent";
+}
+
+TEST(CollectorTest, Fingerprint_TimedOutStableComponentIsIncomplete)
+{
+    collect::Registry registry;
+    registry.add(make_collector("slow", "x", collect::CostClass::Expensive, collect::Encoding::Binary, 300ms));
+    registry.add(make_collector("fast", "y", collect::CostClass::Cheap));
+
+    collect::Registry fast_only;
+    fast_only.add(make_collector("fast", "y", collect::CostClass::Cheap));
+
+    exec::WorkStealingPool pool(2);
+
+    collect::RunOptions tight;
+    tight.budget = 20ms;
+
+    auto results = collect::run(registry, tight, pool);
+    ASSERT_EQ(find(results, "slow")->status, collect::Status::TimedOut);
+
+    hs::Hash256 base {};
+    base.buffer[0] = 3;
+    EXPECT_TRUE(same_hash(collect::fold(base, results), collect::fold(base, collect::run(fast_only))))
+        << "the overrun is folded like an absent component, the same on every run";
+
+    auto timed_out = collect::fingerprint(registry, tight, pool);
+    EXPECT_FALSE(timed_out.complete);
+
+    collect::RunOptions generous;
+    generous.budget = 5s;
+
+    auto finished = collect::fingerprint(registry, generous, pool);
+    EXPECT_TRUE(finished.complete);
+    EXPECT_FALSE(same_hash(finished.hash, timed_out.hash));
+
+    auto volatile_slow = make_collector("uptime", "1", collect::CostClass::Expensive, collect::Encoding::Binary, 300ms);
+    volatile_slow.stability = collect::Stability::Volatile;
+    collect::Registry with_volatile;
+    with_volatile.add(volatile_slow);
+    EXPECT_TRUE(collect::fingerprint(with_volatile, tight, pool).complete) << "volatile components are never folded";
+}
+
+// ============================================================================
+// Execution
+// ============================================================================
+
+TEST(CollectorTest, Run_ReportsFailures)
+{
+    collect::Registry registry;
+
+    collect::Collector missing;
+    missing.name = "missing";
+    missing.collect = [] { return std::optional<std::vector<byte>> {}; };
+    registry.add(missing);
+
+    collect::Collector throwing;
+    throwing.name = "throwing";
+    throwing.cost = collect::CostClass::Moderate;
+    throwing.collect = []() -> std::optional<std::vector<byte>> { throw std::runtime_error("device gone"); };
+    registry.add(throwing);
+
+    auto results = collect::run(registry);
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].status, collect::Status::Failed);
+    EXPECT_EQ(results[1].status, collect::Status::Failed);
+}
+
+TEST(CollectorTest, Run_ThreadedCollectorsOverlap)
+{
+    collect::Registry registry;
+    for(auto name : { "a", "b", "c", "d" }) {
+        registry.add(make_collector(name, name, collect::CostClass::Moderate, collect::Encoding::Binary, 100ms));
+    }
+
+    collect::RunOptions options;
+    options.budget = 5s;
+
+    // an explicit pool: the default one has a single worker on a single core
+    exec::WorkStealingPool pool(4);
+
+    auto start = std::chrono::steady_clock::now();
+    auto results = collect::run(registry, options, pool);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    for(const auto& result : results) {
+        EXPECT_EQ(result.status, collect::Status::Ok) << result.name;
+    }
+    EXPECT_LT(elapsed, 350ms) << "four 100 ms collectors ran concurrently";
+}
+
+TEST(CollectorTest, Run_BudgetBoundsSlowCollectors)
+{
+    collect::Registry registry;
+    registry.add(make_collector("slow", "x", collect::CostClass::Expensive, collect::Encoding::Binary, 500ms));
+    registry.add(make_collector("fast", "y", collect::CostClass::Moderate));
+
+    collect::RunOptions options;
+    options.budget = 30ms;
+
+    exec::WorkStealingPool pool(2);
+
+    auto start = std::chrono::steady_clock::now();
+    auto results = collect::run(registry, options, pool);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_LT(elapsed, 400ms) << "the caller did not wait for the slow collector";
+    EXPECT_EQ(find(results, "slow")->status, collect::Status::TimedOut);
+    EXPECT_TRUE(find(results, "slow")->value.empty());
+    EXPECT_EQ(find(results, "fast")->status, collect::Status::Ok);
+}
+
+TEST(CollectorTest, Run_ExpensiveCanBeExcluded)
+{
+    collect::Registry registry;
+    registry.add(make_collector("probe", "x", collect::CostClass::Expensive));
+
+    collect::RunOptions options;
+    options.include_expensive = false;
+
+    auto results = collect::run(registry, options);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].status, collect::Status::Skipped);
+}
+
+TEST(CollectorTest, FileCollector_ReadsThroughCallerSource)
+{
+#ifdef IDENTY_LINUX
+    auto root = std::filesystem::temp_directory_path() / "identy_collector_source";
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+    std::filesystem::create_directories(root / "var/lib/cloud/data");
+    std::ofstream(root / "var/lib/cloud/data/instance-id") << "i-0abc\n";
+
+    collect::Registry registry;
+    registry.add(collect::file_collector("cloud.instance_id", "/var/lib/cloud/data/instance-id"));
+
+    // the same read on a worker thread must see the caller's source
+    auto threaded = collect::file_collector("cloud.threaded", "/var/lib/cloud/data/instance-id");
+    threaded.cost = collect::CostClass::Moderate;
+    registry.add(threaded);
+
+    std::vector<collect::Result> results;
+    {
+        ScopedSysfsRoot scoped(root);
+        results = collect::run(registry);
+    }
+
+    ASSERT_EQ(results.size(), 2u);
+    for(const auto& result : results) {
+        ASSERT_EQ(result.status, collect::Status::Ok) << result.name;
+        EXPECT_EQ(std::string(result.value.begin(), result.value.end()), "i-0abc") << result.name;
+    }
+
+    std::filesystem::remove_all(root, ec);
+#else
+    GTEST_SKIP() << "ScopedSysfsRoot redirects Linux paths";
+#endif
+}
+
+} // namespace identy::test
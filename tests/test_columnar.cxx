@@ -0,0 +1,285 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Identy.h>
+#include "test_boards.hxx"
+#include "test_config.hxx"
+
+namespace identy::test
+{
+
+namespace
+{
+// two vendors, a hypervisor on every third board, NVMe and SATA drives; board 0 has no UUID
+std::vector<MotherboardEx> make_columnar_boards(int count)
+{
+    std::vector<MotherboardEx> boards;
+    for(int index = 0; index < count; ++index) {
+        BoardSpec spec;
+        spec.vendor = index % 2 == 0 ? "GenuineIntel" : "AuthenticAMD";
+        spec.brand = index % 2 == 0 ? "Intel(R) Xeon(R) Gold 6248" : "AMD EPYC 7742";
+        spec.version = 0x000906EA + index;
+        spec.logical_processors = 8 * (index + 1);
+        spec.smbios_minor = static_cast<byte>(index);
+        spec.tables.assign(static_cast<std::size_t>(index) * 10, 0xAA);
+        spec.drives = static_cast<std::size_t>(index % 3);
+        spec.model_id = "Samsung SSD 980";
+
+        auto& mb = boards.emplace_back(make_board(static_cast<std::size_t>(index), spec));
+        mb.cpu.apic_id = static_cast<std::uint8_t>(index);
+        mb.cpu.hypervisor_bit = index % 3 == 0;
+        mb.cpu.hypervisor_signature = index % 3 == 0 ? "KVMKVMKVM" : "";
+        mb.cpu.instruction_set.extended_modern[1] = -index;
+        mb.smbios.tier = index % 4 == 0 ? SmbiosTier::Attributes : SmbiosTier::Table;
+
+        for(std::size_t d = 0; d < mb.drives.size(); ++d) {
+            auto& drive = mb.drives[d];
+            drive.bus_type = d == 0 ? PhysicalDriveInfo::NMVe : PhysicalDriveInfo::SATA;
+            drive.vendor_id = "Samsung";
+            drive.path_count = static_cast<std::uint32_t>(1 + d * 3);
+        }
+    }
+    return boards;
+}
+
+void expect_matches_boards(const std::vector<io::ColumnView>& columns, const std::vector<MotherboardEx>& boards)
+{
+    auto find = [&](std::string_view name) -> const io::ColumnView& {
+        auto it = std::ranges::find(columns, name, &io::ColumnView::name);
+        EXPECT_NE(it, columns.end()) << name;
+        return *it;
+    };
+
+    const auto& vendor = find("cpu_vendor");
+    const auto& brand = find("cpu_brand");
+    const auto& version = find("cpu_version");
+    const auto& hypervisor = find("cpu_hypervisor");
+    const auto& signature = find("cpu_hypervisor_signature");
+    const auto& isa = find("cpu_isa_extended_1");
+    const auto& uuid = find("smbios_uuid");
+    const auto& minor = find("smbios_minor_version");
+    const auto& tables = find("smbios_tables_size");
+    const auto& tier = find("smbios_tier");
+    const auto& drives = find("drives");
+
+    ASSERT_EQ(drives.children.size(), 1u);
+    const auto& item = drives.children.front();
+    const auto* serial = item.child("serial");
+    const auto* bus = item.child("bus");
+    const auto* model = item.child("model");
+    const auto* paths = item.child("paths");
+    ASSERT_NE(paths, nullptr);
+    ASSERT_NE(serial, nullptr);
+    ASSERT_NE(bus, nullptr);
+    ASSERT_NE(model, nullptr);
+
+    auto drive_offsets = drives.offsets_as();
+    ASSERT_EQ(drive_offsets.size(), boards.size() + 1);
+
+    for(std::size_t row = 0; row < boards.size(); ++row) {
+        const auto& mb = boards[row];
+
+        EXPECT_EQ(vendor.string_at(row), mb.cpu.vendor);
+        EXPECT_EQ(brand.string_at(row), mb.cpu.extended_brand_string);
+        EXPECT_EQ(version.values_as<std::int32_t>()[row], mb.cpu.version);
+        EXPECT_EQ(hypervisor.bool_at(row), mb.cpu.hypervisor_bit);
+        EXPECT_EQ(signature.is_valid(row), !mb.cpu.hypervisor_signature.empty());
+        EXPECT_EQ(signature.string_at(row), mb.cpu.hypervisor_signature);
+        EXPECT_EQ(isa.values_as<std::int32_t>()[row], mb.cpu.instruction_set.extended_modern[1]);
+        EXPECT_EQ(minor.values_as<std::uint8_t>()[row], mb.smbios.minor_version);
+        EXPECT_EQ(tables.values_as<std::uint32_t>()[row], mb.smbios.raw_tables_data.size());
+        EXPECT_EQ(tier.values_as<std::uint8_t>()[row], static_cast<std::uint8_t>(mb.smbios.tier));
+
+        bool has_uuid = std::ranges::any_of(mb.smbios.uuid, [](byte b) { return b != 0; });
+        EXPECT_EQ(uuid.is_valid(row), has_uuid);
+        EXPECT_TRUE(std::ranges::equal(uuid.binary_at(row), mb.smbios.uuid));
+
+        ASSERT_EQ(static_cast<std::size_t>(drive_offsets[row + 1] - drive_offsets[row]), mb.drives.size());
+        for(std::size_t d = 0; d < mb.drives.size(); ++d) {
+            auto child_row = static_cast<std::size_t>(drive_offsets[row]) + d;
+            EXPECT_EQ(serial->string_at(child_row), mb.drives[d].serial);
+            EXPECT_EQ(model->string_at(child_row), mb.drives[d].model_id);
+            EXPECT_EQ(bus->values_as<std::uint8_t>()[child_row], static_cast<std::uint8_t>(mb.drives[d].bus_type));
+            EXPECT_EQ(paths->values_as<std::uint32_t>()[child_row], mb.drives[d].path_count);
+        }
+    }
+}
+} // namespace
+
+// ============================================================================
+// Builder Tests
+// ============================================================================
+
+TEST(ColumnarTest, Builder_ColumnsMatchInput)
+{
+    auto boards = make_columnar_boards(10);
+
+    io::ColumnarBatchBuilder builder;
+    builder.append(boards);
+    EXPECT_EQ(builder.size(), boards.size());
+
+    auto batch = builder.finish();
+    EXPECT_EQ(batch.row_count(), boards.size());
+    EXPECT_EQ(builder.size(), 0u) << "finish() must reset the builder";
+
+    auto columns = batch.columns();
+    for(const auto& column : columns) {
+        EXPECT_EQ(column.length, boards.size()) << column.name;
+    }
+
+    expect_matches_boards(columns, boards);
+}
+
+TEST(ColumnarTest, Builder_DictionaryEncodesRepeatedStrings)
+{
+    io::ColumnarBatchBuilder builder;
+    builder.append(make_columnar_boards(50));
+    auto batch = builder.finish();
+
+    auto vendor = batch.column("cpu_vendor");
+    ASSERT_TRUE(vendor.has_value());
+    EXPECT_EQ(vendor->type, io::ColumnType::Dictionary);
+    ASSERT_EQ(vendor->children.size(), 1u);
+    EXPECT_EQ(vendor->children.front().length, 2u) << "Only two distinct vendors";
+
+    auto indices = vendor->values_as<std::int32_t>();
+    EXPECT_EQ(indices[0], 0);
+    EXPECT_EQ(indices[1], 1);
+    EXPECT_EQ(indices[2], 0);
+}
+
+TEST(ColumnarTest, Builder_ArrowLayout)
+{
+    io::ColumnarBatchBuilder builder;
+    builder.append(make_columnar_boards(20));
+    auto batch = builder.finish();
+
+    for(const auto& column : batch.columns()) {
+        for(auto buffer : { column.validity, column.offsets, column.values }) {
+            if(!buffer.empty()) {
+                EXPECT_EQ(reinterpret_cast<std::uintptr_t>(buffer.data()) % io::columnar_alignment, 0u) << column.name;
+            }
+        }
+    }
+
+    auto signature = batch.column("cpu_hypervisor_signature");
+    ASSERT_TRUE(signature.has_value());
+    EXPECT_GT(signature->null_count, 0u);
+    EXPECT_GE(signature->validity.size(), (signature->length + 7) / 8);
+    EXPECT_EQ(signature->offsets_as().front(), 0);
+
+    auto version = batch.column("cpu_version");
+    ASSERT_TRUE(version.has_value());
+    EXPECT_EQ(version->null_count, 0u);
+    EXPECT_TRUE(version->validity.empty()) << "Columns without nulls carry no bitmap";
+
+    auto uuid = batch.column("smbios_uuid");
+    ASSERT_TRUE(uuid.has_value());
+    EXPECT_EQ(uuid->type, io::ColumnType::FixedSizeBinary);
+    EXPECT_EQ(uuid->byte_width, SMBIOS_uuid_length);
+    EXPECT_EQ(uuid->null_count, 1u);
+    EXPECT_FALSE(uuid->is_valid(0));
+}
+
+TEST(ColumnarTest, Builder_EmptyBatch)
+{
+    io::ColumnarBatchBuilder builder;
+    auto batch = builder.finish();
+
+    EXPECT_EQ(batch.row_count(), 0u);
+
+    auto drives = batch.column("drives");
+    ASSERT_TRUE(drives.has_value());
+    EXPECT_EQ(drives->offsets_as().size(), 1u);
+
+    std::vector<byte> file;
+    batch.encode(file);
+    auto reader = io::ColumnarReader::open(file);
+    ASSERT_TRUE(reader.has_value());
+    EXPECT_EQ(reader->row_count(), 0u);
+}
+
+// ============================================================================
+// Batch File Tests
+// ============================================================================
+
+TEST(ColumnarTest, File_RoundTrip)
+{
+    auto boards = make_columnar_boards(25);
+
+    io::ColumnarBatchBuilder builder;
+    builder.append(boards);
+    auto batch = builder.finish();
+
+    std::ostringstream oss(std::ios::binary);
+    batch.write(oss);
+    auto data = oss.str();
+
+    std::vector<byte> file(data.begin(), data.end());
+    EXPECT_EQ(std::memcmp(file.data(), io::columnar_magic, sizeof(io::columnar_magic)), 0);
+
+    auto reader = io::ColumnarReader::open(file);
+    ASSERT_TRUE(reader.has_value());
+    EXPECT_EQ(reader->row_count(), boards.size());
+    EXPECT_EQ(reader->columns().size(), batch.columns().size());
+    ASSERT_NE(reader->column("cpu_brand"), nullptr);
+    EXPECT_EQ(reader->column("missing"), nullptr);
+
+    expect_matches_boards(reader->columns(), boards);
+}
+
+TEST(ColumnarTest, File_BuffersAlignedAndInPlace)
+{
+    io::ColumnarBatchBuilder builder;
+    builder.append(make_columnar_boards(5));
+
+    std::vector<byte> file;
+    builder.finish().encode(file);
+
+    auto reader = io::ColumnarReader::open(file);
+    ASSERT_TRUE(reader.has_value());
+
+    for(const auto& column : reader->columns()) {
+        if(!column.values.empty()) {
+            EXPECT_GE(column.values.data(), file.data());
+            EXPECT_LE(column.values.data() + column.values.size(), file.data() + file.size());
+            EXPECT_EQ(static_cast<std::size_t>(column.values.data() - file.data()) % io::columnar_alignment, 0u);
+        }
+    }
+}
+
+TEST(ColumnarTest, File_RejectsMalformedInput)
+{
+    io::ColumnarBatchBuilder builder;
+    builder.append(make_columnar_boards(5));
+
+    std::vector<byte> file;
+    builder.finish().encode(file);
+
+    EXPECT_FALSE(io::ColumnarReader::open(std::span<const byte>(file).first(16)).has_value());
+    EXPECT_FALSE(io::ColumnarReader::open(std::span<const byte>(file).first(file.size() - 1)).has_value());
+
+    auto bad_magic = file;
+    bad_magic[0] = 'X';
+    EXPECT_FALSE(io::ColumnarReader::open(bad_magic).has_value());
+
+    auto bad_version = file;
+    bad_version[4] = 0x7F;
+    EXPECT_FALSE(io::ColumnarReader::open(bad_version).has_value());
+
+    // first node: make the value buffer point past the end of the file
+    auto bad_buffer = file;
+    bad_buffer[32 + 64 + 8] = 0xFF;
+    bad_buffer[32 + 64 + 9] = 0xFF;
+    EXPECT_FALSE(io::ColumnarReader::open(bad_buffer).has_value());
+
+    // first node: claim more rows than the batch has
+    auto bad_length = file;
+    bad_length[32 + 8] += 1;
+    EXPECT_FALSE(io::ColumnarReader::open(bad_length).has_value());
+}
+
+} // namespace identy::test
@@ -0,0 +1,420 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef IDENTY_LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <Identy.h>
+#include "test_config.hxx"
+
+namespace identy::test
+{
+
+namespace
+{
+class DaemonTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        name_ = std::string("identy_daemon_") + ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        root_ = std::filesystem::temp_directory_path() / name_;
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+    }
+
+    void TearDown() override
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+    }
+
+    std::string shm_name() const
+    {
+        return "/" + name_ + "_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed());
+    }
+
+    std::string name_;
+    std::filesystem::path root_;
+};
+
+bool same_hash(const hs::Hash256& lhs, const hs::Hash256& rhs)
+{
+    return std::memcmp(lhs.buffer, rhs.buffer, sizeof(lhs.buffer)) == 0;
+}
+
+hs::Hash256 filled_hash(byte value)
+{
+    hs::Hash256 hash;
+    std::memset(hash.buffer, value, sizeof(hash.buffer));
+    return hash;
+}
+} // namespace
+
+// ============================================================================
+// Wire protocol
+// ============================================================================
+
+TEST_F(DaemonTest, Request_RoundTrip)
+{
+    for(auto query : { daemon::Query::Fingerprint, daemon::Query::Snapshot, daemon::Query::Verdict }) {
+        std::vector<byte> buffer;
+        daemon::encode_request(buffer, query);
+
+        ASSERT_EQ(buffer.size(), daemon::request_size);
+        EXPECT_EQ(daemon::decode_request(buffer), query);
+    }
+}
+
+TEST_F(DaemonTest, Request_RejectsMalformed)
+{
+    std::vector<byte> buffer;
+    daemon::encode_request(buffer, daemon::Query::Fingerprint);
+
+    auto bad_magic = buffer;
+    bad_magic[0] = 'X';
+    EXPECT_FALSE(daemon::decode_request(bad_magic).has_value());
+
+    auto unknown_query = buffer;
+    unknown_query[4] = 99;
+    EXPECT_FALSE(daemon::decode_request(unknown_query).has_value());
+
+    EXPECT_FALSE(daemon::decode_request(std::span(buffer).first(4)).has_value());
+
+    buffer.push_back(0);
+    EXPECT_FALSE(daemon::decode_request(buffer).has_value());
+}
+
+TEST_F(DaemonTest, Reply_RoundTripAndTruncation)
+{
+    std::vector<byte> payload { 1, 2, 3, 4, 5 };
+    std::vector<byte> buffer;
+    daemon::encode_reply(buffer, daemon::Query::Snapshot, daemon::Status::Ok, payload);
+
+    ASSERT_EQ(buffer.size(), daemon::reply_header_size + payload.size());
+
+    auto reply = daemon::decode_reply(buffer);
+    ASSERT_TRUE(reply.has_value());
+    EXPECT_EQ(reply->query, daemon::Query::Snapshot);
+    EXPECT_EQ(reply->status, daemon::Status::Ok);
+    EXPECT_TRUE(std::ranges::equal(reply->payload, payload));
+
+    buffer.pop_back();
+    EXPECT_FALSE(daemon::decode_reply(buffer).has_value());
+}
+
+TEST_F(DaemonTest, Verdict_RoundTrip)
+{
+    vm::HeuristicVerdict verdict;
+    verdict.confidence = vm::VMConfidence::Probable;
+    verdict.detections = { vm::VMFlags::Cpu_Hypervisor_bit, vm::VMFlags::Storage_BusTypeIsVirtual };
+
+    std::vector<byte> buffer;
+    daemon::encode_verdict(buffer, verdict);
+
+    auto decoded = daemon::decode_verdict(buffer);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->confidence, verdict.confidence);
+    EXPECT_EQ(decoded->detections, verdict.detections);
+
+    buffer.pop_back();
+    EXPECT_FALSE(daemon::decode_verdict(buffer).has_value());
+}
+
+// ============================================================================
+// Service
+// ============================================================================
+
+TEST_F(DaemonTest, Service_UnavailableBeforeRefresh)
+{
+    daemon::Service service;
+
+    std::vector<byte> request;
+    daemon::encode_request(request, daemon::Query::Fingerprint);
+
+    std::vector<byte> reply;
+    service.handle(request, reply);
+
+    auto decoded = daemon::decode_reply(reply);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->status, daemon::Status::Unavailable);
+
+    std::vector<byte> garbage { 1, 2, 3 };
+    service.handle(garbage, reply);
+    decoded = daemon::decode_reply(reply);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->status, daemon::Status::BadRequest);
+}
+
+TEST_F(DaemonTest, Service_ServesCollectedState)
+{
+#ifdef IDENTY_LINUX
+    fixture::SysfsSpec spec;
+    spec.block_devices = 6;
+    ASSERT_TRUE(fixture::write_sysfs_tree(root_, spec));
+
+    ScopedSysfsRoot root(root_);
+    auto expected = snap_motherboard_ex();
+
+    daemon::Service service;
+    EXPECT_TRUE(service.refresh());
+    EXPECT_EQ(service.published().generation, 1u);
+    EXPECT_TRUE(same_hash(service.published().hash, hs::hash(expected)));
+
+    EXPECT_FALSE(service.refresh()) << "unchanged hardware keeps the fingerprint";
+    EXPECT_EQ(service.published().generation, 2u);
+
+    std::vector<byte> request;
+    std::vector<byte> reply;
+
+    daemon::encode_request(request, daemon::Query::Snapshot);
+    service.handle(request, reply);
+
+    auto decoded = daemon::decode_reply(reply);
+    ASSERT_TRUE(decoded.has_value());
+    ASSERT_EQ(decoded->status, daemon::Status::Ok);
+
+    auto snapshot = io::read_binary(decoded->payload);
+    ASSERT_TRUE(snapshot.has_value());
+    EXPECT_TRUE(same_hash(hs::hash(snapshot->to_motherboard_ex()), hs::hash(expected)));
+
+    request.clear();
+    daemon::encode_request(request, daemon::Query::Verdict);
+    service.handle(request, reply);
+
+    decoded = daemon::decode_reply(reply);
+    ASSERT_TRUE(decoded.has_value());
+    auto verdict = daemon::decode_verdict(decoded->payload);
+    ASSERT_TRUE(verdict.has_value());
+
+    auto expected_verdict = vm::analyze_full(expected);
+    EXPECT_EQ(verdict->confidence, expected_verdict.confidence);
+    EXPECT_EQ(verdict->detections, expected_verdict.detections);
+    EXPECT_EQ(service.published().confidence, expected_verdict.confidence);
+#else
+    GTEST_SKIP() << "Synthetic trees use the Linux sysfs layout";
+#endif
+}
+
+// ============================================================================
+// Shared memory publication
+// ============================================================================
+
+TEST_F(DaemonTest, SharedMemory_PublishAndRead)
+{
+#ifdef IDENTY_LINUX
+    auto name = shm_name();
+
+    EXPECT_FALSE(daemon::FingerprintReader::open(name).has_value()) << "no segment yet";
+
+    auto publisher = daemon::FingerprintPublisher::create(name);
+    ASSERT_TRUE(publisher.has_value());
+
+    auto reader = daemon::FingerprintReader::open(name);
+    ASSERT_TRUE(reader.has_value());
+    EXPECT_FALSE(reader->read().has_value()) << "nothing published yet";
+
+    daemon::PublishedFingerprint fingerprint;
+    fingerprint.hash = filled_hash(0xAB);
+    fingerprint.generation = 7;
+    fingerprint.updated_unix_ns = 123456789;
+    fingerprint.confidence = vm::VMConfidence::Possible;
+    fingerprint.detections = 0b1010;
+    publisher->publish(fingerprint);
+
+    auto read = reader->read();
+    ASSERT_TRUE(read.has_value());
+    EXPECT_TRUE(same_hash(read->hash, fingerprint.hash));
+    EXPECT_EQ(read->generation, 7u);
+    EXPECT_EQ(read->updated_unix_ns, 123456789u);
+    EXPECT_EQ(read->confidence, vm::VMConfidence::Possible);
+    EXPECT_EQ(read->detections, 0b1010u);
+
+    publisher.reset();
+    EXPECT_FALSE(daemon::FingerprintReader::open(name).has_value()) << "publisher removes the segment";
+#else
+    GTEST_SKIP() << "identyd is Linux only";
+#endif
+}
+
+TEST_F(DaemonTest, SharedMemory_PreCreatedSegmentIsReplaced)
+{
+#ifdef IDENTY_LINUX
+    auto name = shm_name();
+
+    // another process claims the name first and keeps a writable descriptor
+    int squatter = ::shm_open(name.c_str(), O_RDWR | O_CREAT, 0666);
+    ASSERT_GE(squatter, 0);
+    ASSERT_EQ(::ftruncate(squatter, 4096), 0);
+
+    auto publisher = daemon::FingerprintPublisher::create(name);
+    ASSERT_TRUE(publisher.has_value());
+
+    daemon::PublishedFingerprint fingerprint;
+    fingerprint.hash = filled_hash(0x11);
+    fingerprint.generation = 3;
+    publisher->publish(fingerprint);
+
+    std::vector<char> garbage(4096, '\x5A');
+    EXPECT_EQ(::pwrite(squatter, garbage.data(), garbage.size(), 0), static_cast<ssize_t>(garbage.size()));
+    ::close(squatter);
+
+    auto reader = daemon::FingerprintReader::open(name);
+    ASSERT_TRUE(reader.has_value());
+
+    auto read = reader->read();
+    ASSERT_TRUE(read.has_value()) << "writes through the old descriptor must not reach readers";
+    EXPECT_TRUE(same_hash(read->hash, fingerprint.hash));
+    EXPECT_EQ(read->generation, 3u);
+#else
+    GTEST_SKIP() << "identyd is Linux only";
+#endif
+}
+
+TEST_F(DaemonTest, SharedMemory_ReadersNeverSeeTornUpdates)
+{
+#ifdef IDENTY_LINUX
+    auto name = shm_name();
+
+    auto publisher = daemon::FingerprintPublisher::create(name);
+    ASSERT_TRUE(publisher.has_value());
+
+    auto reader = daemon::FingerprintReader::open(name);
+    ASSERT_TRUE(reader.has_value());
+
+    constexpr std::uint64_t updates = 20000;
+    std::atomic<bool> done { false };
+
+    std::thread writer([&] {
+        for(std::uint64_t i = 1; i <= updates; ++i) {
+            daemon::PublishedFingerprint fingerprint;
+            fingerprint.hash = filled_hash(static_cast<byte>(i));
+            fingerprint.generation = i;
+            fingerprint.updated_unix_ns = i * 3;
+            publisher->publish(fingerprint);
+        }
+        done.store(true);
+    });
+
+    std::uint64_t torn = 0;
+    std::uint64_t last_generation = 0;
+    bool went_backwards = false;
+
+    while(!done.load()) {
+        auto read = reader->read();
+        if(!read.has_value()) {
+            continue;
+        }
+
+        if(!same_hash(read->hash, filled_hash(static_cast<byte>(read->generation)))
+            || read->updated_unix_ns != read->generation * 3) {
+            ++torn;
+        }
+
+        went_backwards = went_backwards || read->generation < last_generation;
+        last_generation = read->generation;
+    }
+
+    writer.join();
+
+    EXPECT_EQ(torn, 0u);
+    EXPECT_FALSE(went_backwards);
+    EXPECT_EQ(reader->read()->generation, updates);
+#else
+    GTEST_SKIP() << "identyd is Linux only";
+#endif
+}
+
+// ============================================================================
+// Socket client
+// ============================================================================
+
+TEST_F(DaemonTest, Client_UnreachableDaemon)
+{
+    EXPECT_FALSE(daemon::query_fingerprint(root_ / "missing.sock").has_value());
+}
+
+TEST_F(DaemonTest, Client_QueriesOverUnixSocket)
+{
+#ifdef IDENTY_LINUX
+    fixture::SysfsSpec spec;
+    spec.block_devices = 3;
+    ASSERT_TRUE(fixture::write_sysfs_tree(root_, spec));
+
+    daemon::Service service;
+    {
+        ScopedSysfsRoot root(root_);
+        service.refresh();
+    }
+
+    auto socket_path = root_ / "identyd.sock";
+
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    ASSERT_LT(socket_path.native().size(), sizeof(address.sun_path));
+    std::strcpy(address.sun_path, socket_path.c_str());
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_GE(listener, 0);
+    ASSERT_EQ(::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), 0);
+    ASSERT_EQ(::listen(listener, 4), 0);
+
+    constexpr int requests = 3;
+
+    std::thread server([&] {
+        std::vector<byte> reply;
+
+        for(int i = 0; i < requests; ++i) {
+            int client = ::accept(listener, nullptr, nullptr);
+            if(client < 0) {
+                return;
+            }
+
+            std::vector<byte> request(daemon::request_size + 1);
+            std::size_t received = 0;
+            while(received < request.size()) {
+                auto count = ::recv(client, request.data() + received, request.size() - received, 0);
+                if(count <= 0) {
+                    break;
+                }
+                received += static_cast<std::size_t>(count);
+            }
+
+            service.handle(std::span(request).first(received), reply);
+            ::send(client, reply.data(), reply.size(), MSG_NOSIGNAL);
+            ::close(client);
+        }
+    });
+
+    auto fingerprint = daemon::query_fingerprint(socket_path);
+    auto snapshot = daemon::query_snapshot(socket_path);
+    auto verdict = daemon::query_verdict(socket_path);
+
+    server.join();
+    ::close(listener);
+
+    ASSERT_TRUE(fingerprint.has_value());
+    EXPECT_TRUE(same_hash(*fingerprint, service.published().hash));
+
+    ASSERT_TRUE(snapshot.has_value());
+    EXPECT_EQ(snapshot->drives.size(), 3u);
+    EXPECT_TRUE(same_hash(hs::hash(*snapshot), service.published().hash));
+
+    ASSERT_TRUE(verdict.has_value());
+    EXPECT_EQ(verdict->confidence, service.published().confidence);
+#else
+    GTEST_SKIP() << "identyd is Linux only";
+#endif
+}
+
+} // namespace identy::test
@@ -0,0 +1,255 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Identy.h>
+#include "test_boards.hxx"
+#include "test_config.hxx"
+
+namespace identy::test
+{
+
+namespace
+{
+std::vector<byte> make_table(std::string bios_vendor = "American Megatrends")
+{
+    std::vector<byte> table;
+    append_structure(table, 0, 0x0000, { 1, 2, 0, 0xF0 }, bios_vendor);
+    append_structure(table, 1, 0x0001, std::vector<byte>(20, 0x11), "Dell Inc.");
+    append_structure(table, 2, 0x0002, { 1, 2, 3 }, "Board");
+    append_structure(table, 17, 0x0010, std::vector<byte>(30, 0x22));
+    append_structure(table, 17, 0x0011, std::vector<byte>(30, 0x33));
+    append_structure(table, 127, 0xFFFF, {});
+    return table;
+}
+
+// three WD SATA drives, sda..sdc
+BoardSpec diff_spec()
+{
+    BoardSpec spec;
+    spec.brand = "Intel(R) Xeon(R) Silver 4210";
+    spec.version = 0x00050657;
+    spec.logical_processors = 20;
+    spec.tables = make_table();
+    spec.drives = 3;
+    spec.bus_type = PhysicalDriveInfo::SATA;
+    spec.serial_prefix = "WD";
+    spec.model_id = "WDC WD40EFRX";
+    return spec;
+}
+
+template<typename Before, typename After>
+concept Diffable = requires(Before&& before, After&& after) { diff(std::forward<Before>(before), std::forward<After>(after)); };
+
+std::size_t count_kind(const std::vector<SnapshotChange>& changes, ChangeKind kind)
+{
+    return static_cast<std::size_t>(std::ranges::count(changes, kind, &SnapshotChange::kind));
+}
+} // namespace
+
+// changes hold views into both snapshots, temporaries would leave them dangling
+static_assert(Diffable<const MotherboardEx&, const MotherboardEx&>);
+static_assert(Diffable<MotherboardEx&, MotherboardEx&>);
+static_assert(!Diffable<MotherboardEx, const MotherboardEx&>);
+static_assert(!Diffable<const MotherboardEx&, MotherboardEx>);
+static_assert(!Diffable<MotherboardEx, MotherboardEx>);
+
+// ============================================================================
+// Field Changes
+// ============================================================================
+
+TEST(DiffTest, IdenticalSnapshots_NoChanges)
+{
+    auto mb = make_board(0, diff_spec());
+    auto copy = make_board(0, diff_spec());
+    EXPECT_TRUE(diff(mb, mb).empty());
+    EXPECT_TRUE(diff(mb, copy).empty());
+}
+
+TEST(DiffTest, CpuFieldChanges)
+{
+    auto a = make_board(0, diff_spec());
+    auto b = a;
+    b.cpu.vendor = "AuthenticAMD";
+    b.cpu.logical_processors_count = 32;
+    b.cpu.hypervisor_bit = true;
+
+    auto changes = diff(a, b);
+    ASSERT_EQ(changes.size(), 3u);
+    EXPECT_EQ(count_kind(changes, ChangeKind::CpuField), 3u);
+
+    EXPECT_EQ(changes[0].field, "vendor");
+    EXPECT_EQ(changes[0].before, "GenuineIntel");
+    EXPECT_EQ(changes[0].after, "AuthenticAMD");
+
+    EXPECT_EQ(changes[1].field, "logical_processors");
+    EXPECT_EQ(changes[1].before_value, 20);
+    EXPECT_EQ(changes[1].after_value, 32);
+
+    EXPECT_EQ(changes[2].field, "hypervisor");
+    EXPECT_EQ(changes[2].after_value, 1);
+}
+
+TEST(DiffTest, SmbiosFieldChanges)
+{
+    auto a = make_board(0, diff_spec());
+    auto b = a;
+    b.smbios.minor_version = 4;
+    b.smbios.uuid[15] = 0x01;
+
+    auto changes = diff(a, b);
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[0].field, "minor_version");
+    EXPECT_EQ(changes[1].field, "uuid");
+    EXPECT_EQ(changes[1].after.size(), SMBIOS_uuid_length);
+    EXPECT_EQ(static_cast<byte>(changes[1].after[15]), 0x01);
+}
+
+// ============================================================================
+// SMBIOS Structures
+// ============================================================================
+
+TEST(DiffTest, Structures_ModifiedByTypeAndHandle)
+{
+    auto a = make_board(0, diff_spec());
+    auto b = a;
+    b.smbios.raw_tables_data = make_table("Phoenix Technologies");
+
+    auto changes = diff(a, b);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].kind, ChangeKind::SmbiosStructureModified);
+    EXPECT_EQ(changes[0].smbios_type, 0);
+    EXPECT_EQ(changes[0].smbios_handle, 0x0000);
+}
+
+TEST(DiffTest, Structures_AddedAndRemoved)
+{
+    auto a = make_board(0, diff_spec());
+    auto b = a;
+
+    std::vector<byte> table;
+    append_structure(table, 0, 0x0000, { 1, 2, 0, 0xF0 }, "American Megatrends");
+    append_structure(table, 1, 0x0001, std::vector<byte>(20, 0x11), "Dell Inc.");
+    append_structure(table, 2, 0x0002, { 1, 2, 3 }, "Board");
+    append_structure(table, 17, 0x0011, std::vector<byte>(30, 0x33));
+    append_structure(table, 17, 0x0012, std::vector<byte>(30, 0x44));
+    append_structure(table, 127, 0xFFFF, {});
+    b.smbios.raw_tables_data = table;
+
+    auto changes = diff(a, b);
+    ASSERT_EQ(changes.size(), 2u);
+
+    EXPECT_EQ(changes[0].kind, ChangeKind::SmbiosStructureRemoved);
+    EXPECT_EQ(changes[0].smbios_type, 17);
+    EXPECT_EQ(changes[0].smbios_handle, 0x0010);
+
+    EXPECT_EQ(changes[1].kind, ChangeKind::SmbiosStructureAdded);
+    EXPECT_EQ(changes[1].smbios_handle, 0x0012);
+}
+
+TEST(DiffTest, Structures_ReorderedIsNotAChange)
+{
+    auto a = make_board(0, diff_spec());
+    auto b = a;
+
+    std::vector<byte> table;
+    append_structure(table, 0, 0x0000, { 1, 2, 0, 0xF0 }, "American Megatrends");
+    append_structure(table, 1, 0x0001, std::vector<byte>(20, 0x11), "Dell Inc.");
+    append_structure(table, 2, 0x0002, { 1, 2, 3 }, "Board");
+    append_structure(table, 17, 0x0011, std::vector<byte>(30, 0x33));
+    append_structure(table, 17, 0x0010, std::vector<byte>(30, 0x22));
+    append_structure(table, 127, 0xFFFF, {});
+    b.smbios.raw_tables_data = table;
+
+    EXPECT_TRUE(diff(a, b).empty());
+}
+
+TEST(DiffTest, Structures_TruncatedTableDoesNotCrash)
+{
+    auto a = make_board(0, diff_spec());
+    auto b = a;
+    b.smbios.raw_tables_data.resize(b.smbios.raw_tables_data.size() / 2);
+
+    auto changes = diff(a, b);
+    EXPECT_GT(count_kind(changes, ChangeKind::SmbiosStructureRemoved), 0u);
+}
+
+// ============================================================================
+// Drives
+// ============================================================================
+
+TEST(DiffTest, Drives_MatchedBySerial)
+{
+    auto a = make_board(0, diff_spec());
+    auto b = a;
+
+    // same drives, different order, one renamed device node
+    std::swap(b.drives[0], b.drives[2]);
+    b.drives[1].device_name = "sdx";
+
+    auto changes = diff(a, b);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].kind, ChangeKind::DriveModified);
+    EXPECT_EQ(changes[0].field, "device");
+    EXPECT_EQ(changes[0].before, "sdb");
+    EXPECT_EQ(changes[0].after, "sdx");
+    EXPECT_EQ(changes[0].before_index, 1u);
+    EXPECT_EQ(changes[0].after_index, 1u);
+}
+
+TEST(DiffTest, Drives_AddedAndRemoved)
+{
+    auto a = make_board(0, diff_spec());
+    auto b = a;
+
+    b.drives.erase(b.drives.begin());
+    PhysicalDriveInfo drive;
+    drive.bus_type = PhysicalDriveInfo::NMVe;
+    drive.serial = "S4EWNX0R999";
+    b.drives.push_back(drive);
+
+    auto changes = diff(a, b);
+    ASSERT_EQ(changes.size(), 2u);
+
+    EXPECT_EQ(changes[0].kind, ChangeKind::DriveRemoved);
+    EXPECT_EQ(changes[0].before, "WD-0-0");
+    EXPECT_EQ(changes[0].before_index, 0u);
+    EXPECT_EQ(changes[0].after_index, SnapshotChange::no_index);
+
+    EXPECT_EQ(changes[1].kind, ChangeKind::DriveAdded);
+    EXPECT_EQ(changes[1].after, "S4EWNX0R999");
+    EXPECT_EQ(changes[1].after_index, 2u);
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+TEST(DiffTest, WriteDiff_OneLinePerChange)
+{
+    auto a = make_board(0, diff_spec());
+    auto b = a;
+    b.cpu.vendor = "AuthenticAMD";
+    b.smbios.raw_tables_data = make_table("Phoenix");
+    b.drives[2].model_id = "WDC WD80EFAX";
+
+    std::vector<SnapshotChange> changes;
+    ASSERT_EQ(diff(a, b, changes), 3u);
+
+    std::ostringstream oss;
+    io::write_diff(oss, changes);
+
+    EXPECT_EQ(oss.str(), "CPU vendor: \"GenuineIntel\" -> \"AuthenticAMD\"\n"
+                         "SMBIOS structure modified: type 0 handle 0x0000\n"
+                         "Drive #3 model: \"WDC WD40EFRX\" -> \"WDC WD80EFAX\"\n");
+}
+
+TEST(DiffTest, LiveSnapshot_NoChanges)
+{
+    auto mb = snap_motherboard_ex();
+    auto again = snap_motherboard_ex();
+    EXPECT_TRUE(diff(mb, again).empty());
+}
+
+} // namespace identy::test
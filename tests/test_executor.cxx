@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <Identy.h>
+#include "test_config.hxx"
+
+namespace identy::test
+{
+
+namespace
+{
+/** Executor running every task on a thread of its own, counting submissions */
+struct CountingExecutor
+{
+    std::atomic<std::size_t> submitted { 0 };
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+
+    ~CountingExecutor()
+    {
+        for(auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    void submit(exec::Task task)
+    {
+        ++submitted;
+        std::lock_guard lock(mutex);
+        threads.emplace_back(std::move(task));
+    }
+
+    std::size_t concurrency() const
+    {
+        return 3;
+    }
+};
+
+static_assert(exec::Executor<exec::InlineExecutor>);
+static_assert(exec::Executor<exec::WorkStealingPool>);
+static_assert(exec::Executor<CountingExecutor>);
+
+std::vector<Motherboard> make_boards(std::size_t count)
+{
+    std::vector<Motherboard> boards(count);
+    for(std::size_t i = 0; i < count; ++i) {
+        boards[i].cpu.version = static_cast<std::uint32_t>(i);
+        boards[i].cpu.hypervisor_bit = i % 3 == 0;
+        boards[i].smbios.uuid[0] = static_cast<byte>(i);
+    }
+
+    return boards;
+}
+} // namespace
+
+// ============================================================================
+// Work-stealing pool
+// ============================================================================
+
+TEST(ExecutorTest, Pool_RunsEverySubmittedTask)
+{
+    std::atomic<int> counter { 0 };
+
+    {
+        exec::WorkStealingPool pool(3);
+        EXPECT_EQ(pool.concurrency(), 3u);
+
+        for(int i = 0; i < 1000; ++i) {
+            pool.submit([&counter] { ++counter; });
+        }
+    }
+
+    EXPECT_EQ(counter.load(), 1000) << "the destructor drains queued tasks";
+}
+
+TEST(ExecutorTest, Pool_TasksSubmittedFromWorkersRun)
+{
+    std::atomic<int> counter { 0 };
+
+    {
+        exec::WorkStealingPool pool(2);
+        for(int i = 0; i < 10; ++i) {
+            pool.submit([&pool, &counter] {
+                for(int j = 0; j < 10; ++j) {
+                    pool.submit([&counter] { ++counter; });
+                }
+            });
+        }
+    }
+
+    EXPECT_EQ(counter.load(), 100);
+}
+
+// ============================================================================
+// parallel_for
+// ============================================================================
+
+TEST(ExecutorTest, ParallelFor_CoversEveryIndexOnce)
+{
+    exec::WorkStealingPool pool(4);
+
+    for(std::size_t count : { 0u, 1u, 7u, 1000u }) {
+        std::vector<std::atomic<int>> hits(count);
+
+        exec::parallel_for(
+            count,
+            [&hits](std::size_t begin, std::size_t end) {
+                for(auto i = begin; i < end; ++i) {
+                    ++hits[i];
+                }
+            },
+            pool, 3);
+
+        for(std::size_t i = 0; i < count; ++i) {
+            EXPECT_EQ(hits[i].load(), 1) << "count=" << count << " index=" << i;
+        }
+    }
+}
+
+TEST(ExecutorTest, ParallelFor_NestedInsideSingleWorkerCompletes)
+{
+    exec::WorkStealingPool pool(1);
+
+    std::atomic<std::size_t> total { 0 };
+    std::atomic<bool> done { false };
+
+    // the only worker blocks in the outer task, so the inner loop must make
+    // progress on the calling thread alone
+    pool.submit([&pool, &total, &done] {
+        exec::parallel_for(
+            100,
+            [&total](std::size_t begin, std::size_t end) { total += end - begin; },
+            pool, 1);
+        done = true;
+    });
+
+    while(!done) {
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(total.load(), 100u);
+}
+
+TEST(ExecutorTest, ParallelFor_InlineExecutorRunsOnCaller)
+{
+    exec::InlineExecutor executor;
+    std::set<std::thread::id> threads;
+
+    exec::parallel_for(
+        50,
+        [&threads](std::size_t, std::size_t) { threads.insert(std::this_thread::get_id()); },
+        executor, 5);
+
+    ASSERT_EQ(threads.size(), 1u);
+    EXPECT_EQ(*threads.begin(), std::this_thread::get_id());
+}
+
+TEST(ExecutorTest, ParallelFor_UsesInjectedExecutor)
+{
+    CountingExecutor executor;
+    std::atomic<std::size_t> total { 0 };
+
+    exec::parallel_for(
+        64,
+        [&total](std::size_t begin, std::size_t end) { total += end - begin; },
+        executor, 4);
+
+    EXPECT_EQ(total.load(), 64u);
+    EXPECT_GT(executor.submitted.load(), 0u);
+    EXPECT_LE(executor.submitted.load(), executor.concurrency());
+}
+
+// ============================================================================
+// Batch entry points
+// ============================================================================
+
+TEST(ExecutorTest, HashBatch_MatchesPerElementHash)
+{
+    auto boards = make_boards(257);
+    exec::WorkStealingPool pool(3);
+
+    auto hashes = hs::hash_batch(std::span<const Motherboard>(boards), pool);
+    ASSERT_EQ(hashes.size(), boards.size());
+
+    for(std::size_t i = 0; i < boards.size(); ++i) {
+        auto expected = hs::hash(boards[i]);
+        EXPECT_EQ(std::memcmp(hashes[i].buffer, expected.buffer, sizeof(expected.buffer)), 0) << "index " << i;
+    }
+}
+
+TEST(ExecutorTest, AnalyzeBatch_MatchesAnalyzeFull)
+{
+    auto boards = make_boards(64);
+    CountingExecutor executor;
+
+    auto verdicts = vm::analyze_batch(std::span<const Motherboard>(boards), executor);
+    ASSERT_EQ(verdicts.size(), boards.size());
+
+    for(std::size_t i = 0; i < boards.size(); ++i) {
+        auto expected = vm::analyze_full(boards[i]);
+        EXPECT_EQ(verdicts[i].confidence, expected.confidence) << "index " << i;
+        EXPECT_EQ(verdicts[i].detections, expected.detections) << "index " << i;
+    }
+}
+
+TEST(ExecutorTest, Collectors_RunOnInjectedExecutor)
+{
+    collect::Registry registry;
+
+    collect::Collector collector;
+    collector.name = "pci";
+    collector.cost = collect::CostClass::Moderate;
+    collector.collect = [] { return std::optional<std::vector<byte>>(std::vector<byte> { 1, 2 }); };
+    registry.add(collector);
+
+    CountingExecutor executor;
+    auto results = collect::run(registry, {}, executor);
+
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].status, collect::Status::Ok);
+    EXPECT_EQ(executor.submitted.load(), 1u);
+}
+
+} // namespace identy::test
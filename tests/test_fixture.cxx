@@ -0,0 +1,281 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <Identy.h>
+#include "test_config.hxx"
+
+namespace identy::test
+{
+
+namespace
+{
+class FixtureTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        root_ = std::filesystem::temp_directory_path()
+            / ("identy_fixture_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+    }
+
+    void TearDown() override
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+    }
+
+    std::size_t count_bus(const MotherboardEx& mb, PhysicalDriveInfo::BusType bus)
+    {
+        return static_cast<std::size_t>(std::ranges::count(mb.drives, bus, &PhysicalDriveInfo::bus_type));
+    }
+
+    std::filesystem::path root_;
+};
+
+bool has_flag(const vm::HeuristicVerdict& verdict, vm::VMFlags flag)
+{
+    return std::ranges::find(verdict.detections, flag) != verdict.detections.end();
+}
+} // namespace
+
+// ============================================================================
+// SMBIOS table generation
+// ============================================================================
+
+TEST_F(FixtureTest, SmbiosTable_HasRequestedSize)
+{
+    for(std::size_t size : { 512, 1000, 4096, 65536 }) {
+        auto table = fixture::make_smbios_table(size, 7);
+        EXPECT_EQ(table.size(), size);
+        ASSERT_GE(table.size(), 6u);
+        EXPECT_EQ(table[table.size() - 6], 127) << "ends with the end-of-table structure";
+    }
+}
+
+TEST_F(FixtureTest, SmbiosTable_SmallSizeYieldsMinimalTable)
+{
+    auto table = fixture::make_smbios_table(0, 7);
+    EXPECT_FALSE(table.empty());
+    EXPECT_EQ(table[0], 0);
+}
+
+TEST_F(FixtureTest, SmbiosTable_SeedChangesUuid)
+{
+    MotherboardEx a;
+    a.smbios.raw_tables_data = fixture::make_smbios_table(1024, 1);
+    MotherboardEx b;
+    b.smbios.raw_tables_data = fixture::make_smbios_table(1024, 2);
+
+    auto changes = diff(a, b);
+    EXPECT_FALSE(changes.empty());
+    EXPECT_EQ(fixture::make_smbios_table(1024, 1), a.smbios.raw_tables_data);
+}
+
+// ============================================================================
+// Sysfs trees
+// ============================================================================
+
+TEST_F(FixtureTest, Tree_CollectorsReadGeneratedDevices)
+{
+#ifdef IDENTY_LINUX
+    fixture::SysfsSpec spec;
+    spec.block_devices = 30;
+    spec.loop_devices = 4;
+    spec.network_interfaces = 3;
+    spec.virtual_network_interfaces = 1;
+    spec.dmi_table_size = 8192;
+    spec.smbios_major_version = 3;
+    spec.smbios_minor_version = 6;
+
+    ASSERT_TRUE(fixture::write_sysfs_tree(root_, spec));
+
+    ScopedSysfsRoot root(root_);
+    auto mb = snap_motherboard_ex();
+
+    ASSERT_EQ(mb.drives.size(), 30u);
+    EXPECT_EQ(count_bus(mb, PhysicalDriveInfo::NMVe), 10u);
+    EXPECT_EQ(count_bus(mb, PhysicalDriveInfo::SATA), 10u);
+    EXPECT_EQ(count_bus(mb, PhysicalDriveInfo::USB), 10u);
+
+    for(const auto& drive : mb.drives) {
+        EXPECT_TRUE(drive.serial.starts_with("FX")) << drive.serial;
+    }
+
+    EXPECT_EQ(mb.smbios.raw_tables_data.size(), 8192u);
+    EXPECT_EQ(mb.smbios.major_version, 3);
+    EXPECT_EQ(mb.smbios.minor_version, 6);
+
+    auto verdict = vm::analyze_full(mb);
+    EXPECT_TRUE(has_flag(verdict, vm::VMFlags::Platform_VirtualNetworkAdaptersPresent));
+    EXPECT_FALSE(has_flag(verdict, vm::VMFlags::Platform_OnlyVirtualNetworkAdapters));
+#else
+    GTEST_SKIP() << "Synthetic trees use the Linux sysfs layout";
+#endif
+}
+
+TEST_F(FixtureTest, Tree_ScsiNamesBeyondSdz)
+{
+#ifdef IDENTY_LINUX
+    fixture::SysfsSpec spec;
+    spec.block_devices = 90;
+
+    ASSERT_TRUE(fixture::write_sysfs_tree(root_, spec));
+
+    EXPECT_TRUE(std::filesystem::exists(root_ / "sys" / "block" / "sdz"));
+    EXPECT_TRUE(std::filesystem::exists(root_ / "sys" / "block" / "sdaa"));
+    EXPECT_TRUE(std::filesystem::exists(root_ / "sys" / "block" / "nvme29n1"));
+
+    ScopedSysfsRoot root(root_);
+    EXPECT_EQ(snap_motherboard_ex().drives.size(), 90u);
+#else
+    GTEST_SKIP() << "Synthetic trees use the Linux sysfs layout";
+#endif
+}
+
+TEST_F(FixtureTest, Tree_IsDeterministic)
+{
+#ifdef IDENTY_LINUX
+    fixture::SysfsSpec spec;
+    spec.block_devices = 12;
+
+    ASSERT_TRUE(fixture::write_sysfs_tree(root_, spec));
+
+    std::vector<byte> first;
+    {
+        ScopedSysfsRoot root(root_);
+        io::encode_binary(first, snap_motherboard_ex());
+    }
+
+    std::filesystem::remove_all(root_);
+    ASSERT_TRUE(fixture::write_sysfs_tree(root_, spec));
+
+    std::vector<byte> second;
+    {
+        ScopedSysfsRoot root(root_);
+        io::encode_binary(second, snap_motherboard_ex());
+    }
+
+    EXPECT_EQ(first, second);
+#else
+    GTEST_SKIP() << "Synthetic trees use the Linux sysfs layout";
+#endif
+}
+
+TEST_F(FixtureTest, Tree_MultipathLunsReportedOnce)
+{
+#ifdef IDENTY_LINUX
+    fixture::SysfsSpec spec;
+    spec.block_devices = 6;
+    spec.multipath_luns = 3;
+    spec.paths_per_lun = 4;
+
+    ASSERT_TRUE(fixture::write_sysfs_tree(root_, spec));
+
+    hs::Hash256 four_paths;
+    {
+        ScopedSysfsRoot root(root_);
+        auto mb = snap_motherboard_ex();
+
+        ASSERT_EQ(mb.drives.size(), 6u + 3u) << "one entry per LUN, not per path";
+
+        std::size_t luns = 0;
+        for(const auto& drive : mb.drives) {
+            if(drive.serial.starts_with("LUN")) {
+                ++luns;
+                EXPECT_EQ(drive.path_count, 4u) << drive.serial;
+            }
+            else {
+                EXPECT_EQ(drive.path_count, 1u) << drive.serial;
+            }
+        }
+        EXPECT_EQ(luns, 3u);
+
+        four_paths = hs::hash<hs::detail::PathIndependentHashEx>(mb);
+    }
+
+    // a failed path must not change the path-independent fingerprint
+    std::filesystem::remove_all(root_);
+    spec.paths_per_lun = 2;
+    ASSERT_TRUE(fixture::write_sysfs_tree(root_, spec));
+
+    ScopedSysfsRoot root(root_);
+    auto mb = snap_motherboard_ex();
+    ASSERT_EQ(mb.drives.size(), 6u + 3u);
+
+    auto two_paths = hs::hash<hs::detail::PathIndependentHashEx>(mb);
+    EXPECT_EQ(hs::compare(four_paths, two_paths), 0);
+#else
+    GTEST_SKIP() << "Synthetic trees use the Linux sysfs layout";
+#endif
+}
+
+TEST_F(FixtureTest, Tree_SharedWwidWithoutMapNotGrouped)
+{
+#ifdef IDENTY_LINUX
+    fixture::SysfsSpec spec;
+    spec.block_devices = 6;
+
+    ASSERT_TRUE(fixture::write_sysfs_tree(root_, spec));
+
+    // two SCSI disks reporting the same WWID, e.g. identical bridge firmware
+    for(auto name : { "sda", "sdc" }) {
+        std::ofstream(root_ / "sys" / "block" / name / "device" / "wwid") << "naa.5000000000000000\n";
+    }
+
+    ScopedSysfsRoot root(root_);
+    auto mb = snap_motherboard_ex();
+
+    ASSERT_EQ(mb.drives.size(), 6u) << "only a multipath map groups paths";
+    for(const auto& drive : mb.drives) {
+        EXPECT_EQ(drive.path_count, 1u) << drive.serial;
+    }
+#else
+    GTEST_SKIP() << "Synthetic trees use the Linux sysfs layout";
+#endif
+}
+
+TEST_F(FixtureTest, Tree_CaptureFromRootReplaysIdentically)
+{
+#ifdef IDENTY_LINUX
+    fixture::SysfsSpec spec;
+    spec.block_devices = 6;
+    spec.network_interfaces = 2;
+
+    ASSERT_TRUE(fixture::write_sysfs_tree(root_, spec));
+
+    std::vector<byte> rooted;
+    CaptureBundle bundle;
+    {
+        ScopedSysfsRoot root(root_);
+        io::encode_binary(rooted, snap_motherboard_ex());
+        bundle = capture_hardware();
+    }
+
+    std::vector<byte> replayed;
+    {
+        ScopedReplay replay(bundle);
+        io::encode_binary(replayed, snap_motherboard_ex());
+    }
+
+    EXPECT_EQ(replayed, rooted);
+#else
+    GTEST_SKIP() << "Synthetic trees use the Linux sysfs layout";
+#endif
+}
+
+TEST_F(FixtureTest, Root_MissingTreeReadsAsEmpty)
+{
+    ScopedSysfsRoot root(root_ / "does-not-exist");
+    auto mb = snap_motherboard_ex();
+
+    EXPECT_TRUE(mb.drives.empty());
+    EXPECT_TRUE(mb.smbios.raw_tables_data.empty());
+}
+
+} // namespace identy::test
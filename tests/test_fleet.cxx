@@ -0,0 +1,329 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Identy.h>
+#include "test_boards.hxx"
+#include "test_config.hxx"
+
+namespace identy::test
+{
+
+namespace
+{
+// every fourth upload comes from a KVM guest
+MotherboardEx make_upload_board(std::size_t index)
+{
+    BoardSpec spec;
+    spec.vendor = index % 4 == 0 ? "KVMKVMKVM" : "GenuineIntel";
+    spec.version = static_cast<register_32>(index);
+
+    auto mb = make_board(index, spec);
+    mb.cpu.hypervisor_bit = index % 4 == 0;
+    return mb;
+}
+
+std::vector<byte> encode(const MotherboardEx& mb)
+{
+    std::vector<byte> out;
+    io::encode_binary(out, mb);
+    return out;
+}
+
+/** Sink collecting every result, indexed by sequence */
+struct Collector
+{
+    std::mutex mutex;
+    std::vector<fleet::Verified> results;
+    std::atomic<std::size_t> calls { 0 };
+
+    fleet::Sink sink()
+    {
+        return [this](std::span<const fleet::Verified> batch) {
+            ++calls;
+            std::lock_guard lock(mutex);
+            for(const auto& item : batch) {
+                if(results.size() <= item.sequence) {
+                    results.resize(item.sequence + 1);
+                }
+                results[item.sequence] = item;
+            }
+        };
+    }
+};
+} // namespace
+
+// ============================================================================
+// BoundedQueue
+// ============================================================================
+
+TEST(FleetTest, Queue_RoundsCapacityAndRejectsWhenFull)
+{
+    fleet::BoundedQueue<int> queue(3);
+    EXPECT_EQ(queue.capacity(), 4u);
+
+    for(int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.try_push(i));
+    }
+    int extra = 4;
+    EXPECT_FALSE(queue.try_push(extra));
+
+    int value = -1;
+    for(int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.try_pop(value));
+        EXPECT_EQ(value, i) << "FIFO order";
+    }
+    EXPECT_FALSE(queue.try_pop(value));
+}
+
+TEST(FleetTest, Queue_CloseDrainsThenFails)
+{
+    fleet::BoundedQueue<int> queue(4);
+
+    int value = 7;
+    ASSERT_TRUE(queue.push(value));
+    queue.close();
+
+    value = 8;
+    EXPECT_FALSE(queue.push(value)) << "closed queues reject pushes";
+
+    ASSERT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 7);
+    EXPECT_FALSE(queue.pop(value)) << "closed and drained";
+}
+
+TEST(FleetTest, Queue_BlockingProducersAndConsumersExchangeEverything)
+{
+    fleet::BoundedQueue<int> queue(2);
+    constexpr int per_producer = 2000;
+
+    std::atomic<long long> sum { 0 };
+    std::vector<std::thread> consumers;
+    for(int c = 0; c < 3; ++c) {
+        consumers.emplace_back([&queue, &sum] {
+            int value = 0;
+            while(queue.pop(value)) {
+                sum += value;
+            }
+        });
+    }
+
+    std::vector<std::thread> producers;
+    for(int p = 0; p < 3; ++p) {
+        producers.emplace_back([&queue] {
+            for(int i = 1; i <= per_producer; ++i) {
+                int value = i;
+                ASSERT_TRUE(queue.push(value));
+            }
+        });
+    }
+
+    for(auto& producer : producers) {
+        producer.join();
+    }
+    queue.close();
+    for(auto& consumer : consumers) {
+        consumer.join();
+    }
+
+    EXPECT_EQ(sum.load(), 3LL * per_producer * (per_producer + 1) / 2);
+}
+
+// ============================================================================
+// Verifier
+// ============================================================================
+
+TEST(FleetTest, Verifier_MatchesHashAndAnalyzePerSnapshot)
+{
+    constexpr std::size_t count = 150;
+
+    Collector collector;
+    fleet::Options options;
+    options.batch_size = 16;
+    options.decode_threads = 2;
+    options.hash_threads = 2;
+    options.score_threads = 2;
+
+    exec::WorkStealingPool pool(6);
+    std::vector<MotherboardEx> boards;
+    {
+        fleet::Verifier verifier(collector.sink(), options, pool);
+        for(std::size_t i = 0; i < count; ++i) {
+            boards.push_back(make_upload_board(i));
+            ASSERT_TRUE(verifier.push(encode(boards.back())));
+        }
+        verifier.finish();
+
+        EXPECT_FALSE(verifier.push(encode(boards.front()))) << "push after finish fails";
+    }
+
+    ASSERT_EQ(collector.results.size(), count);
+    EXPECT_EQ(collector.calls.load(), (count + 15) / 16) << "one sink call per batch";
+
+    for(std::size_t i = 0; i < count; ++i) {
+        const auto& result = collector.results[i];
+        EXPECT_EQ(result.sequence, i);
+        ASSERT_TRUE(result.decoded) << "index " << i;
+
+        auto expected_hash = hs::hash(boards[i]);
+        EXPECT_EQ(std::memcmp(result.hash.buffer, expected_hash.buffer, sizeof(expected_hash.buffer)), 0) << "index " << i;
+        EXPECT_EQ(result.board.drives.size(), 1u);
+
+        auto expected_verdict = vm::analyze_full(boards[i]);
+        EXPECT_EQ(result.verdict.confidence, expected_verdict.confidence) << "index " << i;
+        EXPECT_EQ(result.verdict.detections, expected_verdict.detections) << "index " << i;
+    }
+}
+
+TEST(FleetTest, Verifier_ReportsUndecodableSnapshots)
+{
+    Collector collector;
+    fleet::Options options;
+    options.batch_size = 4;
+
+    exec::WorkStealingPool pool(3);
+    fleet::Verifier verifier(collector.sink(), options, pool);
+    verifier.push(encode(make_upload_board(1)));
+    verifier.push(std::vector<byte> { 0xDE, 0xAD, 0xBE, 0xEF });
+    verifier.push(std::vector<byte> {});
+    verifier.push(encode(make_upload_board(2)));
+    verifier.finish();
+
+    ASSERT_EQ(collector.results.size(), 4u);
+    EXPECT_TRUE(collector.results[0].decoded);
+    EXPECT_FALSE(collector.results[1].decoded);
+    EXPECT_FALSE(collector.results[2].decoded);
+    EXPECT_TRUE(collector.results[3].decoded);
+    EXPECT_TRUE(collector.results[1].board.drives.empty());
+
+    auto stats = verifier.stats();
+    EXPECT_EQ(stats.pushed, 4u);
+    EXPECT_EQ(stats.completed, 4u);
+    EXPECT_EQ(stats.rejected, 2u);
+}
+
+TEST(FleetTest, Verifier_SlowSinkAppliesBackpressure)
+{
+    std::atomic<std::size_t> delivered { 0 };
+    fleet::Options options;
+    options.batch_size = 1;
+    options.queue_batches = 1;
+
+    exec::WorkStealingPool pool(3);
+    fleet::Verifier verifier(
+        [&delivered](std::span<const fleet::Verified> batch) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            delivered += batch.size();
+        },
+        options, pool);
+
+    auto blob = encode(make_upload_board(3));
+    constexpr std::size_t count = 20;
+    std::size_t max_in_flight = 0;
+
+    for(std::size_t i = 0; i < count; ++i) {
+        verifier.push(std::span<const byte>(blob));
+        max_in_flight = std::max(max_in_flight, i + 1 - delivered.load());
+    }
+    verifier.finish();
+
+    EXPECT_EQ(delivered.load(), count);
+    // each queue holds one batch (two slots after rounding), plus one batch in
+    // every stage and the batch being pushed
+    EXPECT_LE(max_in_flight, 3u * 2u + 3u + 1u);
+
+    auto stats = verifier.stats();
+    EXPECT_GT(stats.decode.stalled_ns + stats.hash.stalled_ns, 0u) << "upstream stages waited on the sink";
+}
+
+TEST(FleetTest, Verifier_RecordsStageStats)
+{
+    fleet::Options options;
+    options.batch_size = 8;
+    options.hash_threads = 3;
+
+    exec::WorkStealingPool pool(5);
+    fleet::Verifier verifier(nullptr, options, pool);
+    auto blob = encode(make_upload_board(5));
+    for(int i = 0; i < 20; ++i) {
+        verifier.push(std::span<const byte>(blob));
+    }
+    verifier.finish();
+
+    auto stats = verifier.stats();
+    EXPECT_EQ(stats.hash.threads, 3u);
+
+    for(const auto* stage : { &stats.decode, &stats.hash, &stats.score }) {
+        EXPECT_EQ(stage->items, 20u);
+        EXPECT_EQ(stage->latency.calls, 3u) << "8 + 8 + 4";
+        EXPECT_GE(stage->latency.total_ns, stage->latency.max_ns);
+        EXPECT_GT(stage->items_per_second(), 0.0);
+    }
+
+    EXPECT_EQ(stats.decode.latency.bytes, 20u * blob.size());
+    EXPECT_EQ(stats.end_to_end.calls, 3u);
+    EXPECT_EQ(stats.completed, 20u);
+    EXPECT_GT(stats.throughput(), 0.0);
+}
+
+TEST(FleetTest, Verifier_RunsOnSuppliedExecutor)
+{
+    exec::WorkStealingPool pool(3);
+    Collector collector;
+
+    fleet::Verifier verifier(collector.sink(), {}, pool);
+    for(std::size_t i = 0; i < 10; ++i) {
+        verifier.push(encode(make_upload_board(i)));
+    }
+    verifier.finish();
+
+    EXPECT_EQ(collector.results.size(), 10u);
+    EXPECT_EQ(collector.calls.load(), 1u);
+}
+
+TEST(FleetTest, Verifier_SmallExecutorClampsStageThreads)
+{
+    exec::WorkStealingPool pool(4);
+    Collector collector;
+
+    fleet::Options options;
+    options.batch_size = 4;
+    options.decode_threads = 1;
+    options.hash_threads = 5;
+    options.score_threads = 1;
+
+    fleet::Verifier verifier(collector.sink(), options, pool);
+    ASSERT_TRUE(verifier.started());
+    for(std::size_t i = 0; i < 10; ++i) {
+        EXPECT_TRUE(verifier.push(encode(make_upload_board(i))));
+    }
+    verifier.finish();
+
+    EXPECT_EQ(collector.results.size(), 10u);
+
+    auto stats = verifier.stats();
+    EXPECT_EQ(stats.decode.threads, 1u);
+    EXPECT_EQ(stats.hash.threads, 2u) << "the largest stage gives threads up first";
+    EXPECT_EQ(stats.score.threads, 1u);
+}
+
+TEST(FleetTest, Verifier_ExecutorWithoutRoomDoesNotStart)
+{
+    exec::InlineExecutor executor;
+    Collector collector;
+
+    // an inline executor would run the first worker forever on this thread
+    fleet::Verifier verifier(collector.sink(), {}, executor);
+    EXPECT_FALSE(verifier.started());
+    EXPECT_FALSE(verifier.push(encode(make_upload_board(1))));
+    verifier.finish();
+
+    EXPECT_TRUE(collector.results.empty());
+}
+
+} // namespace identy::test
@@ -55,6 +55,8 @@ static_assert(hs::IdentyHashFn<hs::detail::DefaultHash>,
     "DefaultHash should satisfy IdentyHashFn concept");
 static_assert(hs::IdentyHashExFn<hs::detail::DefaultHashEx>,
     "DefaultHashEx should satisfy IdentyHashExFn concept");
+static_assert(hs::IdentyHashExFn<hs::detail::PathIndependentHashEx>,
+    "PathIndependentHashEx should satisfy IdentyHashExFn concept");
 
 // ============================================================================
 // Hash Computation Tests
@@ -246,4 +248,101 @@ TEST_F(HashComputationTest, BasicVsExtended_MayDiffer)
     }
 }
 
+// ============================================================================
+// Path-Independent Hash
+// ============================================================================
+
+namespace
+{
+MotherboardEx make_multipath_board()
+{
+    MotherboardEx mb;
+    mb.cpu.vendor = "GenuineIntel";
+    mb.smbios.uuid[0] = 0x42;
+
+    PhysicalDriveInfo boot;
+    boot.bus_type = PhysicalDriveInfo::NMVe;
+    boot.device_name = "nvme0n1";
+    boot.serial = "S4EWNX0R123456";
+
+    PhysicalDriveInfo lun;
+    lun.bus_type = PhysicalDriveInfo::SATA;
+    lun.device_name = "sdb";
+    lun.serial = "LUN0001";
+    lun.path_count = 4;
+
+    mb.drives = { boot, lun };
+    return mb;
+}
+
+bool same_hash(const hs::Hash256& lhs, const hs::Hash256& rhs)
+{
+    return std::memcmp(lhs.buffer, rhs.buffer, sizeof(lhs.buffer)) == 0;
+}
+} // namespace
+
+TEST(PathIndependentHashTest, IgnoresPathNamesCountsAndDuplicates)
+{
+    using Hash = hs::detail::PathIndependentHashEx;
+
+    auto mb = make_multipath_board();
+    auto expected = hs::hash<Hash>(mb);
+
+    auto renamed = mb;
+    renamed.drives[1].device_name = "sdq";
+    renamed.drives[1].path_count = 2;
+    EXPECT_TRUE(same_hash(hs::hash<Hash>(renamed), expected));
+
+    // the same LUN enumerated once per path, in any order
+    auto per_path = mb;
+    auto path = per_path.drives[1];
+    path.device_name = "sdc";
+    per_path.drives.insert(per_path.drives.begin(), path);
+    EXPECT_TRUE(same_hash(hs::hash<Hash>(per_path), expected));
+
+    EXPECT_FALSE(same_hash(hs::hash(renamed), hs::hash(mb))) << "the default hash keeps device names";
+}
+
+TEST(PathIndependentHashTest, StillCoversDrivesAndBoard)
+{
+    using Hash = hs::detail::PathIndependentHashEx;
+
+    auto mb = make_multipath_board();
+    auto expected = hs::hash<Hash>(mb);
+
+    auto replaced = mb;
+    replaced.drives[1].serial = "LUN0002";
+    EXPECT_FALSE(same_hash(hs::hash<Hash>(replaced), expected));
+
+    auto other_uuid = mb;
+    other_uuid.smbios.uuid[0] = 0x43;
+    EXPECT_FALSE(same_hash(hs::hash<Hash>(other_uuid), expected));
+
+    // serials are length-prefixed: "AB" + "C" differs from "A" + "BC"
+    auto split = mb;
+    split.drives[0].serial = "AB";
+    split.drives[1].serial = "C";
+    split.drives[1].bus_type = PhysicalDriveInfo::NMVe;
+    auto resplit = split;
+    resplit.drives[0].serial = "A";
+    resplit.drives[1].serial = "BC";
+    EXPECT_FALSE(same_hash(hs::hash<Hash>(split), hs::hash<Hash>(resplit)));
+
+    // drives behind cheap bridges often report no or a placeholder serial
+    for(std::string placeholder : { "", "0000000000", "          " }) {
+        auto one = mb;
+        one.drives[0].serial = placeholder;
+        auto two = one;
+        two.drives.push_back(one.drives[0]);
+        EXPECT_FALSE(same_hash(hs::hash<Hash>(one), hs::hash<Hash>(two))) << '"' << placeholder << '"';
+    }
+
+    auto usb = mb;
+    PhysicalDriveInfo stick;
+    stick.bus_type = PhysicalDriveInfo::USB;
+    stick.serial = "USB0001";
+    usb.drives.push_back(stick);
+    EXPECT_TRUE(same_hash(hs::hash<Hash>(usb), expected)) << "USB drives are excluded like in default_hash_ex()";
+}
+
 } // namespace identy::test
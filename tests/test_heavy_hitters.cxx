@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include <Identy.h>
+#include "test_config.hxx"
+
+namespace identy::test
+{
+
+namespace
+{
+hs::Hash256 make_key(std::uint32_t id)
+{
+    hs::Hash256 key {};
+    for(std::size_t i = 0; i < sizeof(key.buffer); ++i) {
+        key.buffer[i] = static_cast<byte>((id >> ((i % 4) * 8)) ^ (i * 29));
+    }
+    return key;
+}
+
+template<std::size_t N>
+bool same_key(const hs::Hash<N>& lhs, const hs::Hash<N>& rhs)
+{
+    return std::memcmp(lhs.buffer, rhs.buffer, N) == 0;
+}
+
+std::uint64_t next_random(std::uint64_t& state) noexcept
+{
+    state += 0x9E3779B97F4A7C15ull;
+    auto x = state;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * Stream of @p length keys: key i < @p heavy occurs (heavy - i) * @p step
+ * times, every other key once, interleaved pseudo-randomly
+ */
+std::vector<hs::Hash256> make_stream(std::size_t length, std::uint32_t heavy, std::uint32_t step)
+{
+    std::vector<hs::Hash256> stream;
+    for(std::uint32_t i = 0; i < heavy; ++i) {
+        for(std::uint32_t n = 0; n < (heavy - i) * step; ++n) {
+            stream.push_back(make_key(i));
+        }
+    }
+
+    for(std::uint32_t id = 1'000'000; stream.size() < length; ++id) {
+        stream.push_back(make_key(id));
+    }
+
+    std::uint64_t random = 1;
+    for(std::size_t i = stream.size() - 1; i > 0; --i) {
+        std::swap(stream[i], stream[next_random(random) % (i + 1)]);
+    }
+
+    return stream;
+}
+} // namespace
+
+// ============================================================================
+// Count-Min
+// ============================================================================
+
+TEST(HeavyHittersTest, CountMin_NeverUnderestimates)
+{
+    sketch::CountMin sketch(1024, 4);
+    EXPECT_EQ(sketch.width(), 1024u);
+    EXPECT_EQ(sketch.depth(), 4u);
+
+    std::map<std::uint64_t, std::uint32_t> truth;
+    std::uint64_t random = 3;
+    for(int i = 0; i < 50'000; ++i) {
+        auto key = next_random(random) % 5000;
+        auto digest = sketch::detail::key_digest(std::span<const byte>(reinterpret_cast<const byte*>(&key), sizeof(key)));
+        sketch.add(digest);
+        ++truth[digest];
+    }
+
+    std::uint64_t over = 0;
+    for(const auto& [digest, count] : truth) {
+        auto estimate = sketch.estimate(digest);
+        ASSERT_GE(estimate, count);
+        over += estimate - count;
+    }
+
+    // e / width of the total weight is the bound per key; conservative update stays well below
+    EXPECT_LT(static_cast<double>(over) / truth.size(), 2.718 / 1024 * 50'000);
+}
+
+TEST(HeavyHittersTest, CountMin_SaturatesAndDecays)
+{
+    sketch::CountMin sketch(64, 2);
+    sketch.add(7, std::numeric_limits<std::uint32_t>::max() - 1);
+    EXPECT_EQ(sketch.add(7, 10), std::numeric_limits<std::uint32_t>::max());
+
+    sketch.clear();
+    sketch.add(7, 100);
+    sketch.decay();
+    EXPECT_EQ(sketch.estimate(7), 50u);
+}
+
+// ============================================================================
+// Heavy hitters
+// ============================================================================
+
+TEST(HeavyHittersTest, Top_FindsHeavyKeysInOrder)
+{
+    // 10 keys with 1000, 900, ... 100 occurrences hidden in 100k unique keys
+    auto stream = make_stream(105'500, 10, 100);
+
+    sketch::HeavyHittersOptions options;
+    options.capacity = 32;
+    sketch::HeavyHitters<32> hitters(options);
+    hitters.add(stream);
+
+    EXPECT_EQ(hitters.total(), stream.size());
+    EXPECT_EQ(hitters.size(), 32u);
+
+    auto top = hitters.top(10);
+    ASSERT_EQ(top.size(), 10u);
+    for(std::uint32_t i = 0; i < 10; ++i) {
+        std::uint64_t frequency = (10 - i) * 100;
+        EXPECT_TRUE(same_key(top[i].key, make_key(i))) << "rank " << i;
+        EXPECT_GE(top[i].count, frequency);
+        EXPECT_LE(top[i].guaranteed(), frequency);
+        EXPECT_GT(top[i].guaranteed(), frequency * 9 / 10);
+    }
+}
+
+TEST(HeavyHittersTest, Estimate_BoundsEveryKey)
+{
+    sketch::HeavyHitters<32> hitters;
+    for(int i = 0; i < 500; ++i) {
+        hitters.add(make_key(1));
+    }
+    hitters.add(make_key(2), 40);
+
+    EXPECT_EQ(hitters.estimate(make_key(1)), 500u);
+    EXPECT_EQ(hitters.estimate(make_key(2)), 40u);
+    EXPECT_EQ(hitters.estimate(make_key(3)), 0u);
+}
+
+TEST(HeavyHittersTest, Uuid_DetectsZeroedUuids)
+{
+    sketch::HeavyHitters<SMBIOS_uuid_length> uuids;
+
+    MotherboardEx mb;
+    for(std::uint32_t i = 0; i < 20'000; ++i) {
+        if(i % 10 == 0) {
+            std::fill(std::begin(mb.smbios.uuid), std::end(mb.smbios.uuid), byte { 0 });
+        }
+        else {
+            std::memcpy(mb.smbios.uuid, &i, sizeof(i));
+        }
+        uuids.add(sketch::uuid_key(mb.smbios));
+    }
+
+    auto top = uuids.top(1);
+    ASSERT_EQ(top.size(), 1u);
+    EXPECT_TRUE(same_key(top[0].key, hs::Hash<SMBIOS_uuid_length> {}));
+    EXPECT_GE(top[0].count, 2000u);
+}
+
+TEST(HeavyHittersTest, Decay_LetsNewWaveOvertake)
+{
+    sketch::HeavyHittersOptions options;
+    options.capacity = 4;
+    sketch::HeavyHitters<32> hitters(options);
+
+    hitters.add(make_key(1), 1000);
+    for(int period = 0; period < 4; ++period) {
+        hitters.decay();
+        hitters.add(make_key(2), 200);
+    }
+
+    auto top = hitters.top();
+    ASSERT_EQ(top.size(), 2u);
+    EXPECT_TRUE(same_key(top[0].key, make_key(2))) << "the recent wave ranks first";
+    EXPECT_LT(top[1].count, 100u);
+
+    hitters.clear();
+    EXPECT_EQ(hitters.size(), 0u);
+    EXPECT_EQ(hitters.total(), 0u);
+    EXPECT_EQ(hitters.estimate(make_key(2)), 0u);
+}
+
+TEST(HeavyHittersTest, Table_SurvivesHeavyChurn)
+{
+    // every key evicts another: index deletions must keep lookups working
+    sketch::HeavyHittersOptions options;
+    options.capacity = 8;
+    options.width = 64;
+    options.depth = 1;
+    sketch::HeavyHitters<32> hitters(options);
+
+    for(std::uint32_t round = 0; round < 200; ++round) {
+        for(std::uint32_t id = 0; id < 50; ++id) {
+            hitters.add(make_key(id * 7919 + round % 3));
+        }
+        hitters.add(make_key(999'999), 5);
+    }
+
+    EXPECT_EQ(hitters.size(), 8u);
+
+    // every tracked key is still found through the index
+    bool heavy_tracked = false;
+    for(const auto& hitter : hitters.top()) {
+        EXPECT_LE(hitters.estimate(hitter.key), hitter.count);
+        EXPECT_GE(hitters.estimate(hitter.key), hitter.guaranteed());
+        heavy_tracked = heavy_tracked || same_key(hitter.key, make_key(999'999));
+    }
+    EXPECT_TRUE(heavy_tracked);
+}
+
+} // namespace identy::test
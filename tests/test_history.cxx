@@ -0,0 +1,402 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <Identy.h>
+#include "test_boards.hxx"
+#include "test_config.hxx"
+
+namespace identy::test
+{
+
+namespace
+{
+// four NVMe drives and 2 KiB of tables
+BoardSpec history_spec()
+{
+    BoardSpec spec;
+    spec.brand = "Intel(R) Core(TM) i9-9900K CPU @ 3.60GHz";
+    spec.version = 0x000906EC;
+    spec.logical_processors = 16;
+    spec.smbios_minor = 1;
+    spec.tables.assign(2048, 0x5A);
+    spec.drives = 4;
+    return spec;
+}
+
+void expect_same_board(const MotherboardEx& actual, const MotherboardEx& expected)
+{
+    EXPECT_EQ(hs::compare(hs::hash(actual), hs::hash(expected)), 0);
+    EXPECT_EQ(actual.cpu.logical_processors_count, expected.cpu.logical_processors_count);
+    EXPECT_EQ(actual.smbios.raw_tables_data, expected.smbios.raw_tables_data);
+    EXPECT_EQ(actual.smbios.tier, expected.smbios.tier);
+    ASSERT_EQ(actual.drives.size(), expected.drives.size());
+    for(std::size_t i = 0; i < expected.drives.size(); ++i) {
+        EXPECT_EQ(actual.drives[i].serial, expected.drives[i].serial);
+        EXPECT_EQ(actual.drives[i].device_name, expected.drives[i].device_name);
+        EXPECT_EQ(actual.drives[i].bus_type, expected.drives[i].bus_type);
+        EXPECT_EQ(actual.drives[i].path_count, expected.drives[i].path_count);
+    }
+}
+
+class HistoryTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        path_ = std::filesystem::temp_directory_path()
+            / ("identy_history_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + ".idhl");
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+
+    void TearDown() override
+    {
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+
+    std::filesystem::path path_;
+};
+} // namespace
+
+// ============================================================================
+// Writer Tests
+// ============================================================================
+
+TEST_F(HistoryTest, Writer_UnchangedSnapshotsAreTiny)
+{
+    auto writer = io::HistoryWriter::open(path_, 1000);
+    ASSERT_TRUE(writer.has_value());
+
+    auto mb = make_board(1, history_spec());
+    EXPECT_EQ(writer->append(mb, 0), io::HistoryEntryType::Keyframe);
+    auto after_keyframe = writer->size();
+
+    for(std::uint64_t t = 1; t <= 100; ++t) {
+        EXPECT_EQ(writer->append(mb, t * 3600), io::HistoryEntryType::Delta);
+    }
+
+    EXPECT_EQ(writer->entry_count(), 101u);
+    EXPECT_EQ(writer->size() - after_keyframe, 100u * 24) << "Unchanged entries carry only a header";
+}
+
+TEST_F(HistoryTest, Writer_KeyframeInterval)
+{
+    auto writer = io::HistoryWriter::open(path_, 4);
+    ASSERT_TRUE(writer.has_value());
+
+    auto mb = make_board(1, history_spec());
+    for(std::uint64_t t = 0; t < 9; ++t) {
+        writer->append(mb, t);
+    }
+
+    auto reader = io::HistoryReader::open(path_);
+    ASSERT_TRUE(reader.has_value());
+    ASSERT_EQ(reader->entry_count(), 9u);
+
+    for(std::size_t i = 0; i < 9; ++i) {
+        EXPECT_EQ(reader->type(i), i % 4 == 0 ? io::HistoryEntryType::Keyframe : io::HistoryEntryType::Delta) << i;
+    }
+}
+
+TEST_F(HistoryTest, Writer_RejectsTimestampGoingBackwards)
+{
+    auto writer = io::HistoryWriter::open(path_);
+    ASSERT_TRUE(writer.has_value());
+
+    auto mb = make_board(1, history_spec());
+    ASSERT_TRUE(writer->append(mb, 100).has_value());
+    EXPECT_FALSE(writer->append(mb, 99).has_value());
+    EXPECT_TRUE(writer->append(mb, 100).has_value());
+    EXPECT_EQ(writer->entry_count(), 2u);
+}
+
+TEST_F(HistoryTest, Writer_KeyframeWhenDeltaExceedsLimits)
+{
+    auto writer = io::HistoryWriter::open(path_, 1000);
+    ASSERT_TRUE(writer.has_value());
+
+    // long serials keep a keyframe far larger than one small op per drive, so
+    // only the u16 limits can turn these changes into keyframes
+    auto many = make_board(1, history_spec());
+    many.drives.assign(70000, many.drives[0]);
+    for(std::size_t i = 0; i < many.drives.size(); ++i) {
+        many.drives[i].serial = std::string(64, 'S') + std::to_string(i);
+    }
+
+    auto more_paths = many;
+    for(auto& drive : more_paths.drives) {
+        drive.path_count = 2;
+    }
+
+    auto last_serial = more_paths;
+    last_serial.drives.back().serial = "REPLACED";
+
+    auto few_ops = many;
+    few_ops.drives.resize(1000);
+
+    EXPECT_EQ(writer->append(few_ops, 0), io::HistoryEntryType::Keyframe);
+    EXPECT_EQ(writer->append(many, 1), io::HistoryEntryType::Keyframe) << "drive index past 65535";
+    EXPECT_EQ(writer->append(more_paths, 2), io::HistoryEntryType::Keyframe) << "more than 65535 ops";
+    EXPECT_EQ(writer->append(last_serial, 3), io::HistoryEntryType::Keyframe) << "one op on drive 69999";
+    EXPECT_EQ(writer->append(few_ops, 4), io::HistoryEntryType::Delta);
+
+    auto reader = io::HistoryReader::open(path_);
+    ASSERT_TRUE(reader.has_value());
+    ASSERT_EQ(reader->entry_count(), 5u);
+
+    auto third = reader->snapshot(2);
+    ASSERT_TRUE(third.has_value());
+    ASSERT_EQ(third->drives.size(), more_paths.drives.size());
+    EXPECT_EQ(third->drives.back().path_count, 2u);
+
+    auto fourth = reader->snapshot(3);
+    ASSERT_TRUE(fourth.has_value());
+    ASSERT_EQ(fourth->drives.size(), last_serial.drives.size());
+    EXPECT_EQ(fourth->drives.back().serial, "REPLACED");
+
+    auto fifth = reader->snapshot(4);
+    ASSERT_TRUE(fifth.has_value());
+    expect_same_board(*fifth, few_ops);
+}
+
+// ============================================================================
+// Reader Tests
+// ============================================================================
+
+TEST_F(HistoryTest, Reader_ReconstructsEveryEntry)
+{
+    std::vector<MotherboardEx> states;
+    auto mb = make_board(1, history_spec());
+
+    {
+        auto writer = io::HistoryWriter::open(path_, 5);
+        ASSERT_TRUE(writer.has_value());
+
+        for(int step = 0; step < 23; ++step) {
+            switch(step % 6) {
+                case 1:
+                    mb.drives[3].serial = "REPLACED-" + std::to_string(step);
+                    break;
+                case 2:
+                    mb.smbios.raw_tables_data[100 + step] ^= 0xFF;
+                    break;
+                case 3:
+                    mb.drives.pop_back();
+                    break;
+                case 4: {
+                    PhysicalDriveInfo drive;
+                    drive.bus_type = PhysicalDriveInfo::USB;
+                    drive.serial = "USB-" + std::to_string(step);
+                    mb.drives.push_back(drive);
+                    mb.smbios.raw_tables_data.resize(mb.smbios.raw_tables_data.size() + 7, 0x11);
+                    break;
+                }
+                case 5:
+                    mb.cpu.logical_processors_count += 2;
+                    mb.cpu.hypervisor_bit = !mb.cpu.hypervisor_bit;
+                    mb.smbios.uuid[0] ^= 0x80;
+                    break;
+                default:
+                    break;
+            }
+
+            ASSERT_TRUE(writer->append(mb, static_cast<std::uint64_t>(step) * 10).has_value());
+            states.push_back(mb);
+        }
+    }
+
+    auto reader = io::HistoryReader::open(path_);
+    ASSERT_TRUE(reader.has_value());
+    ASSERT_EQ(reader->entry_count(), states.size());
+
+    for(std::size_t i = 0; i < states.size(); ++i) {
+        auto state = reader->snapshot(i);
+        ASSERT_TRUE(state.has_value()) << i;
+        expect_same_board(*state, states[i]);
+    }
+
+    EXPECT_EQ(reader->change_count(1), 1u) << "Only the drive serial changed";
+    EXPECT_FALSE(reader->snapshot(states.size()).has_value());
+}
+
+TEST_F(HistoryTest, Reader_PointInTime)
+{
+    auto mb = make_board(1, history_spec());
+    auto changed = mb;
+    changed.drives[2].serial = "NEW";
+
+    {
+        auto writer = io::HistoryWriter::open(path_);
+        ASSERT_TRUE(writer.has_value());
+        writer->append(mb, 1000);
+        writer->append(mb, 2000);
+        writer->append(changed, 3000);
+    }
+
+    auto reader = io::HistoryReader::open(path_);
+    ASSERT_TRUE(reader.has_value());
+
+    EXPECT_FALSE(reader->at(999).has_value());
+    expect_same_board(*reader->at(1000), mb);
+    expect_same_board(*reader->at(2999), mb);
+    expect_same_board(*reader->at(3000), changed);
+    expect_same_board(*reader->at(~std::uint64_t { 0 }), changed);
+}
+
+TEST_F(HistoryTest, Reader_TracksSmbiosTier)
+{
+    // a collection that fell back to sysfs attributes must not read back as a full one
+    auto full = make_board(1, history_spec());
+    full.smbios.tier = SmbiosTier::Table;
+    auto degraded = full;
+    degraded.smbios.tier = SmbiosTier::Attributes;
+
+    {
+        auto writer = io::HistoryWriter::open(path_);
+        ASSERT_TRUE(writer.has_value());
+        writer->append(full, 1);
+        EXPECT_EQ(writer->append(degraded, 2), io::HistoryEntryType::Delta);
+        EXPECT_EQ(writer->append(full, 3), io::HistoryEntryType::Delta);
+    }
+
+    auto reader = io::HistoryReader::open(path_);
+    ASSERT_TRUE(reader.has_value());
+    EXPECT_EQ(reader->change_count(1), 1u);
+    EXPECT_EQ(reader->snapshot(0)->smbios.tier, SmbiosTier::Table);
+    EXPECT_EQ(reader->snapshot(1)->smbios.tier, SmbiosTier::Attributes);
+    EXPECT_EQ(reader->snapshot(2)->smbios.tier, SmbiosTier::Table);
+}
+
+TEST_F(HistoryTest, Reader_TracksDrivePathCount)
+{
+    auto mb = make_board(1, history_spec());
+    mb.drives[1].path_count = 4;
+    auto failed_path = mb;
+    failed_path.drives[1].path_count = 3;
+
+    {
+        auto writer = io::HistoryWriter::open(path_);
+        ASSERT_TRUE(writer.has_value());
+        writer->append(mb, 1);
+        EXPECT_EQ(writer->append(failed_path, 2), io::HistoryEntryType::Delta);
+    }
+
+    auto reader = io::HistoryReader::open(path_);
+    ASSERT_TRUE(reader.has_value());
+    EXPECT_EQ(reader->change_count(1), 1u);
+
+    auto second = reader->snapshot(1);
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(second->drives[1].path_count, 3u);
+    EXPECT_EQ(reader->snapshot(0)->drives[1].path_count, 4u);
+}
+
+TEST_F(HistoryTest, Reader_StopsAtCorruptedEntry)
+{
+    auto mb = make_board(1, history_spec());
+    std::uint64_t size_after_two = 0;
+
+    {
+        auto writer = io::HistoryWriter::open(path_);
+        ASSERT_TRUE(writer.has_value());
+        writer->append(mb, 1);
+        mb.drives[0].serial = "X";
+        writer->append(mb, 2);
+        size_after_two = writer->size();
+        mb.drives[0].serial = "Y";
+        writer->append(mb, 3);
+    }
+
+    {
+        std::fstream file(path_, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(size_after_two + 30));
+        file.put('!');
+    }
+
+    auto reader = io::HistoryReader::open(path_);
+    ASSERT_TRUE(reader.has_value());
+    EXPECT_EQ(reader->entry_count(), 2u);
+    EXPECT_EQ(reader->valid_size(), size_after_two);
+    EXPECT_EQ(reader->snapshot(1)->drives[0].serial, "X");
+}
+
+TEST_F(HistoryTest, Reader_RejectsForeignFile)
+{
+    {
+        std::ofstream file(path_, std::ios::binary);
+        file << "not a history log at all";
+    }
+
+    EXPECT_FALSE(io::HistoryReader::open(path_).has_value());
+    EXPECT_FALSE(io::HistoryWriter::open(path_).has_value());
+}
+
+// ============================================================================
+// Reopen Tests
+// ============================================================================
+
+TEST_F(HistoryTest, Reopen_ContinuesDeltaChain)
+{
+    auto mb = make_board(1, history_spec());
+
+    {
+        auto writer = io::HistoryWriter::open(path_, 8);
+        ASSERT_TRUE(writer.has_value());
+        writer->append(mb, 1);
+        writer->append(mb, 2);
+    }
+
+    mb.drives[1].serial = "AFTER-REOPEN";
+
+    {
+        auto writer = io::HistoryWriter::open(path_, 2);
+        ASSERT_TRUE(writer.has_value());
+        EXPECT_EQ(writer->entry_count(), 2u);
+        EXPECT_FALSE(writer->append(mb, 1).has_value());
+        EXPECT_EQ(writer->append(mb, 3), io::HistoryEntryType::Delta) << "Interval comes from the log header";
+    }
+
+    auto reader = io::HistoryReader::open(path_);
+    ASSERT_TRUE(reader.has_value());
+    EXPECT_EQ(reader->keyframe_interval(), 8u);
+    ASSERT_EQ(reader->entry_count(), 3u);
+    EXPECT_EQ(reader->change_count(2), 1u);
+    expect_same_board(*reader->snapshot(2), mb);
+}
+
+TEST_F(HistoryTest, Reopen_TruncatesTornTail)
+{
+    auto mb = make_board(1, history_spec());
+    std::uint64_t good_size = 0;
+
+    {
+        auto writer = io::HistoryWriter::open(path_);
+        ASSERT_TRUE(writer.has_value());
+        writer->append(mb, 1);
+        good_size = writer->size();
+        mb.cpu.vendor = "AuthenticAMD";
+        writer->append(mb, 2);
+    }
+
+    std::filesystem::resize_file(path_, std::filesystem::file_size(path_) - 3);
+
+    {
+        auto writer = io::HistoryWriter::open(path_);
+        ASSERT_TRUE(writer.has_value());
+        EXPECT_EQ(writer->entry_count(), 1u);
+        EXPECT_EQ(writer->size(), good_size);
+        writer->append(mb, 5);
+    }
+
+    auto reader = io::HistoryReader::open(path_);
+    ASSERT_TRUE(reader.has_value());
+    ASSERT_EQ(reader->entry_count(), 2u);
+    EXPECT_EQ(reader->timestamp(1), 5u);
+    EXPECT_EQ(reader->snapshot(1)->cpu.vendor, "AuthenticAMD");
+}
+
+} // namespace identy::test
@@ -3,6 +3,7 @@
 #include <cstring>
 
 #include <Identy.h>
+#include "test_boards.hxx"
 #include "test_config.hxx"
 
 namespace identy::test
@@ -115,6 +116,340 @@ TEST_F(IOTest, WriteBinaryEx_Deterministic)
         << "write_binary (extended) should be deterministic for same input";
 }
 
+// ============================================================================
+// read_binary() Round-trip Tests
+// ============================================================================
+
+namespace
+{
+std::span<const byte> as_byte_span(const std::string& data)
+{
+    return { reinterpret_cast<const byte*>(data.data()), data.size() };
+}
+} // namespace
+
+TEST(BinarySnapshotTest, RoundTrip_AllFieldsPreserved)
+{
+    auto original = make_synthetic_board();
+
+    std::ostringstream oss(std::ios::binary);
+    io::write_binary(oss, original);
+    auto data = oss.str();
+
+    auto reader = io::read_binary(as_byte_span(data));
+    ASSERT_TRUE(reader.has_value()) << "Encoded snapshot should be readable";
+    EXPECT_EQ(reader->kind(), io::SnapshotKind::MotherboardEx);
+    EXPECT_EQ(reader->size(), data.size());
+
+    auto decoded = reader->to_motherboard_ex();
+
+    EXPECT_EQ(decoded.cpu.vendor, original.cpu.vendor);
+    EXPECT_EQ(decoded.cpu.version, original.cpu.version);
+    EXPECT_EQ(decoded.cpu.hypervisor_bit, original.cpu.hypervisor_bit);
+    EXPECT_EQ(decoded.cpu.brand_index, original.cpu.brand_index);
+    EXPECT_EQ(decoded.cpu.clflush_line_size, original.cpu.clflush_line_size);
+    EXPECT_EQ(decoded.cpu.logical_processors_count, original.cpu.logical_processors_count);
+    EXPECT_EQ(decoded.cpu.apic_id, original.cpu.apic_id);
+    EXPECT_EQ(decoded.cpu.extended_brand_string, original.cpu.extended_brand_string);
+    EXPECT_EQ(decoded.cpu.hypervisor_signature, original.cpu.hypervisor_signature);
+    EXPECT_EQ(decoded.cpu.instruction_set.basic, original.cpu.instruction_set.basic);
+    EXPECT_EQ(decoded.cpu.instruction_set.modern, original.cpu.instruction_set.modern);
+    EXPECT_EQ(std::memcmp(decoded.cpu.instruction_set.extended_modern, original.cpu.instruction_set.extended_modern,
+                  sizeof(original.cpu.instruction_set.extended_modern)),
+        0);
+    EXPECT_EQ(decoded.cpu.too_old, original.cpu.too_old);
+
+    EXPECT_EQ(decoded.smbios.is_20_calling_used, original.smbios.is_20_calling_used);
+    EXPECT_EQ(decoded.smbios.major_version, original.smbios.major_version);
+    EXPECT_EQ(decoded.smbios.minor_version, original.smbios.minor_version);
+    EXPECT_EQ(decoded.smbios.dmi_version, original.smbios.dmi_version);
+    EXPECT_EQ(std::memcmp(decoded.smbios.uuid, original.smbios.uuid, SMBIOS_uuid_length), 0);
+    EXPECT_EQ(decoded.smbios.raw_tables_data, original.smbios.raw_tables_data);
+
+    ASSERT_EQ(decoded.drives.size(), original.drives.size());
+    for(std::size_t i = 0; i < original.drives.size(); ++i) {
+        EXPECT_EQ(decoded.drives[i].bus_type, original.drives[i].bus_type);
+        EXPECT_EQ(decoded.drives[i].device_name, original.drives[i].device_name);
+        EXPECT_EQ(decoded.drives[i].serial, original.drives[i].serial);
+        EXPECT_EQ(decoded.drives[i].model_id, original.drives[i].model_id);
+        EXPECT_EQ(decoded.drives[i].vendor_id, original.drives[i].vendor_id);
+        EXPECT_EQ(decoded.drives[i].product_id, original.drives[i].product_id);
+        EXPECT_EQ(decoded.drives[i].path_count, original.drives[i].path_count);
+    }
+
+    EXPECT_EQ(hs::compare(hs::hash(decoded), hs::hash(original)), 0)
+        << "Decoded snapshot should hash identically to the original";
+}
+
+TEST(BinarySnapshotTest, RoundTrip_BasicMotherboard)
+{
+    auto original = make_synthetic_board();
+    Motherboard basic { original.cpu, original.smbios };
+
+    std::vector<byte> buffer;
+    auto written = io::encode_binary(buffer, basic);
+
+    ASSERT_EQ(written, buffer.size());
+
+    auto reader = io::read_binary(buffer);
+    ASSERT_TRUE(reader.has_value());
+    EXPECT_EQ(reader->kind(), io::SnapshotKind::Motherboard);
+    EXPECT_EQ(reader->drive_count(), 0u);
+    EXPECT_EQ(hs::compare(hs::hash(reader->to_motherboard()), hs::hash(basic)), 0);
+}
+
+TEST(BinarySnapshotTest, Views_PointIntoBuffer)
+{
+    auto original = make_synthetic_board();
+
+    std::vector<byte> buffer;
+    io::encode_binary(buffer, original);
+
+    auto reader = io::read_binary(buffer);
+    ASSERT_TRUE(reader.has_value());
+
+    auto vendor = reader->cpu_vendor();
+    auto serial = reader->drive(0).serial;
+    auto begin = reinterpret_cast<const char*>(buffer.data());
+    auto end = begin + buffer.size();
+
+    EXPECT_EQ(vendor, original.cpu.vendor);
+    EXPECT_EQ(serial, original.drives[0].serial);
+    EXPECT_TRUE(vendor.data() >= begin && vendor.data() + vendor.size() <= end) << "Views must not copy";
+    EXPECT_TRUE(serial.data() >= begin && serial.data() + serial.size() <= end) << "Views must not copy";
+}
+
+TEST(BinarySnapshotTest, Header_LittleEndianAndAligned)
+{
+    std::vector<byte> buffer;
+    io::encode_binary(buffer, make_synthetic_board());
+
+    ASSERT_GE(buffer.size(), io::snapshot_header_size);
+    EXPECT_EQ(std::memcmp(buffer.data(), io::snapshot_magic, sizeof(io::snapshot_magic)), 0);
+    EXPECT_EQ(buffer[4], io::snapshot_version & 0xFF);
+    EXPECT_EQ(buffer[5], io::snapshot_version >> 8);
+    EXPECT_EQ(buffer.size() % io::snapshot_alignment, 0u);
+
+    std::uint32_t encoded_size = buffer[8] | (buffer[9] << 8) | (buffer[10] << 16) | (buffer[11] << 24);
+    EXPECT_EQ(encoded_size, buffer.size());
+}
+
+TEST(BinarySnapshotTest, Reader_RejectsMalformedInput)
+{
+    std::vector<byte> buffer;
+    io::encode_binary(buffer, make_synthetic_board());
+
+    EXPECT_FALSE(io::read_binary(std::span<const byte>(buffer.data(), buffer.size() - 1)).has_value())
+        << "Truncated snapshot must be rejected";
+
+    auto bad_magic = buffer;
+    bad_magic[0] = 'X';
+    EXPECT_FALSE(io::read_binary(bad_magic).has_value()) << "Wrong magic must be rejected";
+
+    auto bad_version = buffer;
+    bad_version[4] = 0xFF;
+    EXPECT_FALSE(io::read_binary(bad_version).has_value()) << "Unsupported version must be rejected";
+
+    EXPECT_FALSE(io::read_binary({}).has_value()) << "Empty input must be rejected";
+}
+
+TEST(BinarySnapshotTest, Reader_ConcatenatedSnapshots)
+{
+    auto board = make_synthetic_board();
+
+    std::vector<byte> buffer;
+    auto first = io::encode_binary(buffer, board);
+    board.drives.pop_back();
+    io::encode_binary(buffer, board);
+
+    auto reader = io::read_binary(buffer);
+    ASSERT_TRUE(reader.has_value());
+    EXPECT_EQ(reader->size(), first);
+    EXPECT_EQ(reader->drive_count(), 2u);
+
+    auto next = io::read_binary(std::span<const byte>(buffer).subspan(reader->size()));
+    ASSERT_TRUE(next.has_value());
+    EXPECT_EQ(next->drive_count(), 1u);
+}
+
+TEST_F(IOTest, ReadBinary_LiveSnapshotRoundTrip)
+{
+    std::vector<byte> buffer;
+    io::encode_binary(buffer, mb_ex_);
+
+    auto reader = io::read_binary(buffer);
+    ASSERT_TRUE(reader.has_value());
+    EXPECT_EQ(hs::compare(hs::hash(reader->to_motherboard_ex()), hs::hash(mb_ex_)), 0);
+}
+
+// ============================================================================
+// format_text() / write_json() Tests
+// ============================================================================
+
+TEST(TextFormatTest, FormatText_ExactOutput)
+{
+    auto mb = make_synthetic_board();
+
+    const std::string expected = "CPU:\n"
+                                 "Intel(R) Core(TM) i7-8700 CPU @ 3.20GHz Vendor: GenuineIntel\n"
+                                 " Cores: 12\n"
+                                 " Hypervisor present: true\n"
+                                 " Hypervisor signature (if presented) KVMKVMKVM\n"
+                                 "Motherboard:\n"
+                                 " SMBIOS UUID: a0a1a2a3-a4a5-a6a7-a8a9-aaabacadaeaf\n"
+                                 " SMBIOS Ver: 3.2\n"
+                                 " SMBIOS DMI Ver: 1\n"
+                                 " SMBIOS 2.0 calling convention: true\n"
+                                 "Physical Drives:\n"
+                                 " Drive 1\n"
+                                 "  Device: nvme0n1\n"
+                                 "  Serial: S4EWNX0R123456\n"
+                                 "  Bus Type: NVMe\n"
+                                 " Drive 2\n"
+                                 "  Device: sda\n"
+                                 "  Serial: WD-WCC4E0000000\n"
+                                 "  Bus Type: Unknown\n"
+                                 "  Paths: 2\n";
+
+    std::string buffer(1024, '\0');
+    auto size = io::format_text(buffer, mb);
+    ASSERT_EQ(size, expected.size());
+    EXPECT_EQ(buffer.substr(0, size), expected);
+
+    std::ostringstream oss;
+    io::write_text(oss, mb);
+    EXPECT_EQ(oss.str(), expected);
+}
+
+TEST(TextFormatTest, FormatText_SmallBufferReportsRequiredSize)
+{
+    auto mb = make_synthetic_board();
+
+    std::string full(1024, '\0');
+    auto required = io::format_text(full, mb);
+
+    std::string small(32, '#');
+    small.append("guard");
+
+    auto size = io::format_text(std::span<char>(small.data(), 32), mb);
+    EXPECT_EQ(size, required);
+    EXPECT_EQ(small.substr(0, 32), full.substr(0, 32));
+    EXPECT_EQ(small.substr(32), "guard") << "Formatter must not write past the buffer";
+
+    EXPECT_EQ(io::format_json(std::span<char> {}, mb), io::format_json(full, mb));
+}
+
+TEST(TextFormatTest, WriteText_LargeOutputUsesSingleWrite)
+{
+    auto mb = make_synthetic_board();
+    for(int i = 0; i < 200; ++i) {
+        PhysicalDriveInfo drive;
+        drive.device_name = "sd" + std::to_string(i);
+        drive.serial = std::string(32, static_cast<char>('A' + i % 26));
+        mb.drives.push_back(drive);
+    }
+
+    std::ostringstream oss;
+    io::write_text(oss, mb);
+
+    std::string buffer(oss.str().size() + 16, '\0');
+    auto size = io::format_text(buffer, mb);
+    EXPECT_GT(size, 2048u);
+    EXPECT_EQ(oss.str(), buffer.substr(0, size));
+}
+
+TEST(TextFormatTest, WriteJson_Fields)
+{
+    std::ostringstream oss;
+    io::write_json(oss, make_synthetic_board());
+    auto json = oss.str();
+
+    ASSERT_FALSE(json.empty());
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.back(), '\n');
+    EXPECT_EQ(json.find('\n'), json.size() - 1) << "JSON output must be a single line";
+
+    EXPECT_NE(json.find("\"vendor\":\"GenuineIntel\""), std::string::npos);
+    EXPECT_NE(json.find("\"version\":\"0x000906ea\""), std::string::npos);
+    EXPECT_NE(json.find("\"logical_processors\":12"), std::string::npos);
+    EXPECT_NE(json.find("\"hypervisor\":true"), std::string::npos);
+    EXPECT_NE(json.find("\"0xffffffff\""), std::string::npos);
+    EXPECT_NE(json.find("\"uuid\":\"a0a1a2a3-a4a5-a6a7-a8a9-aaabacadaeaf\""), std::string::npos);
+    EXPECT_NE(json.find("\"version\":\"3.2\""), std::string::npos);
+    EXPECT_NE(json.find("\"tables_size\":9"), std::string::npos);
+    EXPECT_NE(json.find("{\"device\":\"sda\",\"bus\":\"sas\",\"serial\":\"WD-WCC4E0000000\""), std::string::npos);
+    EXPECT_NE(json.find("\"paths\":2}"), std::string::npos);
+    EXPECT_NE(json.find("\"paths\":1}"), std::string::npos);
+}
+
+TEST(TextFormatTest, WriteJson_BasicHasNoDrives)
+{
+    auto ex = make_synthetic_board();
+
+    Motherboard mb;
+    mb.cpu = ex.cpu;
+    mb.smbios = ex.smbios;
+
+    std::ostringstream oss;
+    io::write_json(oss, mb);
+
+    EXPECT_EQ(oss.str().find("\"drives\""), std::string::npos);
+    EXPECT_EQ(oss.str().substr(oss.str().size() - 3), "}}\n");
+}
+
+TEST(TextFormatTest, WriteJson_EscapesStrings)
+{
+    auto mb = make_synthetic_board();
+
+    // long enough to exercise both the vectorized scan and the scalar tail
+    mb.cpu.extended_brand_string = std::string("0123456789abcdef\"quoted\"\\path\\0123456789abcdef") + '\n' + '\t'
+        + std::string(1, '\x01') + std::string(1, '\0') + "\xC3\xA9nd";
+    mb.drives.clear();
+
+    std::string buffer(1024, '\0');
+    auto size = io::format_json(buffer, mb);
+    auto json = buffer.substr(0, size);
+
+    EXPECT_NE(json.find(R"("brand":"0123456789abcdef\"quoted\"\\path\\0123456789abcdef\n\t\u0001\u0000)"
+                        "\xC3\xA9nd\""),
+        std::string::npos)
+        << json;
+    EXPECT_NE(json.find("\"drives\":[]}"), std::string::npos);
+}
+
+TEST(TextFormatTest, WriteJson_ReplacesInvalidUtf8)
+{
+    auto mb = make_synthetic_board();
+
+    // raw VPD page 0x80: binary header, then the serial; plus a valid 3-byte
+    // sequence, an overlong form, a surrogate and a truncated sequence
+    mb.drives[0].serial = std::string("\x00\x80\x00\x14", 4) + "SN\xFF\xFE" + "\xE2\x82\xAC" + "\xC0\xAF" + "\xED\xA0\x80"
+        + "0123456789abcdef" + "\xE2\x82";
+
+    std::ostringstream oss;
+    io::write_json(oss, mb);
+    auto json = oss.str();
+
+    EXPECT_NE(json.find(R"("serial":"\u0000\ufffd\u0000\u0014SN\ufffd\ufffd)"
+                        "\xE2\x82\xAC"
+                        R"(\ufffd\ufffd\ufffd\ufffd\ufffd0123456789abcdef\ufffd\ufffd")"),
+        std::string::npos)
+        << json;
+
+    for(auto c : json) {
+        EXPECT_NE(static_cast<unsigned char>(c), 0xFF);
+    }
+}
+
+TEST_F(IOTest, WriteJson_LiveSnapshot)
+{
+    std::ostringstream oss;
+    io::write_json(oss, mb_ex_);
+
+    EXPECT_FALSE(oss.str().empty());
+    EXPECT_NE(oss.str().find(mb_ex_.cpu.vendor), std::string::npos);
+}
+
 // ============================================================================
 // write_hash() Tests
 // ============================================================================
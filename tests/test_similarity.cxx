@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <Identy.h>
+#include "test_boards.hxx"
+#include "test_config.hxx"
+
+namespace identy::test
+{
+
+namespace
+{
+// eight SMBIOS structures and the CPU of @p model, eight unit structures and three drives of @p seed
+BoardSpec similarity_spec(std::uint32_t seed, std::uint32_t model)
+{
+    constexpr byte model_types[] = { 0, 7, 8, 9, 16, 19, 32, 41 };
+    constexpr byte unit_types[] = { 1, 2, 3, 17, 17, 17, 17, 22 };
+
+    BoardSpec spec;
+    spec.brand = "Intel(R) Xeon(R) Gold " + std::to_string(model);
+    spec.version = static_cast<register_32>(model);
+    spec.drives = 3;
+    spec.bus_type = PhysicalDriveInfo::SATA;
+
+    word handle = 0;
+    for(auto type : model_types) {
+        append_structure(spec.tables, type, handle++, std::vector<byte>(8, static_cast<byte>(model + type)), "M" + std::to_string(model));
+    }
+    for(auto type : unit_types) {
+        append_structure(spec.tables, type, handle++, std::vector<byte>(8, static_cast<byte>(seed)), "S" + std::to_string(seed));
+    }
+
+    return spec;
+}
+
+std::vector<std::uint64_t> make_digests(std::uint64_t first, std::size_t count)
+{
+    std::vector<std::uint64_t> digests;
+    for(std::size_t i = 0; i < count; ++i) {
+        auto x = (first + i) * 0x9E3779B97F4A7C15ull;
+        digests.push_back(x ^ (x >> 29));
+    }
+    return digests;
+}
+} // namespace
+
+// ============================================================================
+// Signatures
+// ============================================================================
+
+TEST(SimilarityTest, ComponentDigests_OnePerComponent)
+{
+    auto mb = make_board(1, similarity_spec(1, 0));
+
+    // CPU identity and features, model structures as one, unit structures, drives
+    std::vector<std::uint64_t> digests { 42 };
+    EXPECT_EQ(similarity::component_digests(mb, digests), 3u + 8u + 3u);
+    EXPECT_EQ(digests.size(), 1u + 14u) << "digests are appended";
+
+    std::sort(digests.begin(), digests.end());
+    EXPECT_EQ(std::unique(digests.begin(), digests.end()), digests.end()) << "distinct components, distinct digests";
+
+    auto without_tables = mb;
+    without_tables.smbios.raw_tables_data.clear();
+    digests.clear();
+    EXPECT_EQ(similarity::component_digests(without_tables, digests), 2u + 1u + 3u) << "the UUID stands in for the system structure";
+}
+
+TEST(SimilarityTest, ComponentDigests_ModelStructuresCountOnce)
+{
+    auto a = make_board(1, similarity_spec(1, 0));
+    auto b = make_board(2, similarity_spec(2, 0));
+
+    // 3 of 14 + 14 - 3 components shared
+    EXPECT_LT(similarity::estimate(similarity::sign(a), similarity::sign(b)), 0.3);
+
+    // new firmware changes every model structure, but only one component
+    auto updated = a;
+    updated.smbios.raw_tables_data = similarity_spec(1, 1).tables;
+    EXPECT_GT(similarity::estimate(similarity::sign(a), similarity::sign(updated)), 0.7);
+}
+
+TEST(SimilarityTest, ComponentDigests_IgnoreDevicePaths)
+{
+    auto a = make_board(1, similarity_spec(1, 0));
+    auto b = a;
+    b.drives[0].device_name = "sdz";
+
+    EXPECT_EQ(similarity::sign(a), similarity::sign(b));
+}
+
+TEST(SimilarityTest, Sign_IgnoresOrderAndDuplicates)
+{
+    auto digests = make_digests(1, 30);
+    auto shuffled = digests;
+    std::reverse(shuffled.begin(), shuffled.end());
+    shuffled.push_back(digests[3]);
+
+    EXPECT_EQ(similarity::sign(digests), similarity::sign(shuffled));
+}
+
+TEST(SimilarityTest, Estimate_TracksJaccardSimilarity)
+{
+    // 150 shared out of 200 + 200 - 150 = 250: similarity 0.6
+    auto a = make_digests(0, 200);
+    auto b = make_digests(50, 200);
+
+    auto estimated = similarity::estimate(similarity::sign(a), similarity::sign(b));
+    EXPECT_NEAR(estimated, 0.6, 0.2);
+
+    EXPECT_DOUBLE_EQ(similarity::estimate(similarity::sign(a), similarity::sign(a)), 1.0);
+    EXPECT_LT(similarity::estimate(similarity::sign(a), similarity::sign(make_digests(1000, 200))), 0.1);
+}
+
+TEST(SimilarityTest, SignBatch_MatchesSign)
+{
+    std::vector<MotherboardEx> boards;
+    for(std::uint32_t seed = 0; seed < 40; ++seed) {
+        boards.push_back(make_board(seed, similarity_spec(seed, seed % 3)));
+    }
+
+    exec::WorkStealingPool pool(2);
+    auto signatures = similarity::sign_batch(boards, pool);
+
+    ASSERT_EQ(signatures.size(), boards.size());
+    for(std::size_t i = 0; i < boards.size(); ++i) {
+        EXPECT_EQ(signatures[i], similarity::sign(boards[i])) << "index " << i;
+    }
+}
+
+// ============================================================================
+// Index
+// ============================================================================
+
+TEST(SimilarityTest, Index_FindsCloneDifferingInOneDrive)
+{
+    similarity::Index index;
+    for(std::uint32_t seed = 100; seed < 400; ++seed) {
+        index.insert(similarity::sign(make_board(seed, similarity_spec(seed, seed % 3))));
+    }
+
+    auto original = make_board(7, similarity_spec(7, 1));
+    auto original_id = index.insert(similarity::sign(original));
+
+    auto clone = original;
+    clone.drives[1].serial = "SN-REPLACED";
+
+    // 13 of 15 distinct components shared; a hundred machines of the same model share 3
+    auto matches = index.query(similarity::sign(clone), 0.7);
+    ASSERT_FALSE(matches.empty());
+    EXPECT_EQ(matches.front().id, original_id);
+    EXPECT_GT(matches.front().similarity, 0.7);
+    EXPECT_EQ(matches.size(), 1u) << "machines of the same model stay below the threshold";
+
+    auto exact = index.query(similarity::sign(original), 0.99);
+    ASSERT_EQ(exact.size(), 1u);
+    EXPECT_EQ(exact.front().id, original_id);
+    EXPECT_DOUBLE_EQ(exact.front().similarity, 1.0);
+}
+
+TEST(SimilarityTest, Index_OrdersAndLimitsMatches)
+{
+    similarity::Index index;
+
+    auto base = make_digests(0, 40);
+    for(std::size_t changed : { 8u, 0u, 4u }) {
+        auto record = base;
+        for(std::size_t i = 0; i < changed; ++i) {
+            record[i] += 1000;
+        }
+        index.insert(similarity::sign(record));
+    }
+
+    auto matches = index.query(similarity::sign(base), 0.0);
+    ASSERT_GE(matches.size(), 2u);
+    EXPECT_EQ(matches[0].id, 1u) << "the identical record first";
+    for(std::size_t i = 1; i < matches.size(); ++i) {
+        EXPECT_GE(matches[i - 1].similarity, matches[i].similarity);
+    }
+
+    EXPECT_EQ(index.query(similarity::sign(base), 0.0, 1).size(), 1u);
+}
+
+TEST(SimilarityTest, Index_RecallFollowsCandidateProbability)
+{
+    similarity::Index index;
+    constexpr std::size_t records = 400;
+
+    // 45 of 48 components shared: similarity 45 / 51
+    std::vector<std::vector<std::uint64_t>> sets;
+    for(std::size_t r = 0; r < records; ++r) {
+        sets.push_back(make_digests(r * 1000, 48));
+        index.insert(similarity::sign(sets.back()));
+    }
+
+    std::size_t found = 0;
+    for(std::size_t r = 0; r < records; ++r) {
+        auto query = sets[r];
+        for(std::size_t i = 0; i < 3; ++i) {
+            query[i] = 0xFFFF'0000ull + r * 8 + i;
+        }
+
+        for(const auto& match : index.query(similarity::sign(query), 0.6)) {
+            if(match.id == r) {
+                ++found;
+                break;
+            }
+        }
+    }
+
+    auto expected = index.candidate_probability(45.0 / 51.0);
+    EXPECT_GT(expected, 0.99);
+    EXPECT_GE(static_cast<double>(found) / records, expected - 0.03);
+}
+
+TEST(SimilarityTest, Index_ClampsBanding)
+{
+    similarity::IndexOptions options;
+    options.bands = 100;
+    options.rows = 8;
+
+    similarity::Index index(options);
+    EXPECT_EQ(index.options().rows, 8u);
+    EXPECT_EQ(index.options().bands, similarity::signature_length / 8);
+
+    EXPECT_DOUBLE_EQ(index.candidate_probability(1.0), 1.0);
+    EXPECT_DOUBLE_EQ(index.candidate_probability(0.0), 0.0);
+}
+
+TEST(SimilarityTest, Index_ReportsSizeAndMemory)
+{
+    similarity::Index index;
+    EXPECT_EQ(index.size(), 0u);
+    EXPECT_TRUE(index.query(similarity::sign(make_digests(0, 10)), 0.0).empty());
+
+    index.reserve(1000);
+    auto reserved = index.memory_bytes();
+    EXPECT_GE(reserved, 1000u * similarity::signature_length);
+
+    for(std::size_t r = 0; r < 1000; ++r) {
+        EXPECT_EQ(index.insert(similarity::sign(make_digests(r * 100, 20))), r);
+    }
+    EXPECT_EQ(index.size(), 1000u);
+    EXPECT_EQ(index.memory_bytes(), reserved) << "reserve() covered every insert";
+}
+
+} // namespace identy::test
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
+#include <random>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include <Identy_strings.hxx>
 
@@ -164,4 +167,144 @@ TEST(StringsTest, TrimWhitespace_NullCharactersNotWhitespace)
     EXPECT_GT(result.size(), 2u);
 }
 
+// ============================================================================
+// Case-insensitive Comparison and Search
+// ============================================================================
+
+TEST(StringsTest, EqualsIcase_FoldsAsciiOnly)
+{
+    EXPECT_TRUE(strings::equals_icase("VMware Virtual Disk", "vmware VIRTUAL disk"));
+    EXPECT_FALSE(strings::equals_icase("QEMU", "QEMU "));
+    EXPECT_FALSE(strings::equals_icase("\xC3\x89", "\xC3\xA9")) << "no Unicode folding";
+    EXPECT_FALSE(strings::equals_icase("@", "`")) << "0x40 and 0x60 are not letters";
+}
+
+TEST(StringsTest, FindIcase_Positions)
+{
+    EXPECT_EQ(strings::find_icase("Red Hat VirtIO Ethernet Adapter", "virtio"), 8u);
+    EXPECT_EQ(strings::find_icase("abc", ""), 0u);
+    EXPECT_EQ(strings::find_icase("ab", "abc"), std::string_view::npos);
+    EXPECT_EQ(strings::find_icase("xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxQ", "q"), 40u);
+    EXPECT_TRUE(strings::contains_icase("Microsoft Hyper-V Network Adapter", "HYPER-V"));
+    EXPECT_FALSE(strings::contains_icase("Intel(R) Ethernet Connection", "vbox"));
+}
+
+// ============================================================================
+// Serial Checks and Filtering
+// ============================================================================
+
+TEST(StringsTest, AllSame_PlaceholderSerials)
+{
+    EXPECT_TRUE(strings::all_same(""));
+    EXPECT_TRUE(strings::all_same("0"));
+    EXPECT_TRUE(strings::all_same(std::string(100, '0')));
+    EXPECT_FALSE(strings::all_same(std::string(99, '0') + "1"));
+    EXPECT_FALSE(strings::all_same("S3Z9NB0K123456"));
+}
+
+TEST(StringsTest, FilterPrintable_DropsControlAndNonAscii)
+{
+    std::string vpd = std::string("\x00\x80\x00\x14", 4) + "WD-WCC4N1234567";
+    EXPECT_EQ(strings::filter_printable(vpd), "WD-WCC4N1234567");
+    EXPECT_EQ(strings::printable_prefix("abc\x7F" "def"), 3u);
+    EXPECT_EQ(strings::filter_printable("caf\xC3\xA9~"), "caf~");
+}
+
+// ============================================================================
+// UUID Parsing
+// ============================================================================
+
+TEST(StringsTest, ParseUuid_DashedAndPlain)
+{
+    auto dashed = strings::parse_uuid("4C4C4544-0033-4b10-8051-b2c04f4a3332");
+    auto plain = strings::parse_uuid("4c4c454400334b108051b2c04f4a3332");
+
+    ASSERT_TRUE(dashed.has_value());
+    ASSERT_TRUE(plain.has_value());
+    EXPECT_EQ(*dashed, *plain);
+    EXPECT_EQ((*dashed)[0], 0x4C);
+    EXPECT_EQ((*dashed)[15], 0x32);
+}
+
+TEST(StringsTest, ParseUuid_RejectsMalformed)
+{
+    EXPECT_FALSE(strings::parse_uuid("4c4c4544-0033").has_value()) << "too short";
+    EXPECT_FALSE(strings::parse_uuid("4c4c4544-0033-4b10-8051-b2c04f4a33zz").has_value()) << "not hex";
+    EXPECT_FALSE(strings::parse_uuid("4c4c4544-0033-4b10-8051-b2c04f4a333").has_value()) << "odd digit count";
+}
+
+// ============================================================================
+// Kernel Dispatch
+// ============================================================================
+
+TEST(StringsTest, Kernels_AgreeWithScalar)
+{
+    auto selected = strings::isa();
+
+    // random strings over an alphabet dense in spaces, letters of both cases
+    // and non-printable bytes, at lengths around the 16 and 32 byte steps
+    std::mt19937 rng(0x1D3A7);
+    const std::string alphabet = std::string(" \t\r\naAbBzZ@[`{0\x7F\x80\x1F", 19);
+    std::uniform_int_distribution<std::size_t> pick(0, alphabet.size() - 1);
+
+    std::vector<std::string> inputs;
+    for(std::size_t length = 0; length <= 70; ++length) {
+        for(int variant = 0; variant < 8; ++variant) {
+            std::string text;
+            for(std::size_t i = 0; i < length; ++i) {
+                text.push_back(alphabet[pick(rng)]);
+            }
+            if(variant == 0) {
+                text.assign(length, ' ');
+            }
+            if(variant == 1) {
+                text.assign(length, 'Z');
+            }
+            inputs.push_back(text);
+        }
+    }
+
+    struct Outcome
+    {
+        std::string_view trimmed;
+        std::size_t found;
+        bool equal;
+        bool same;
+        std::size_t printable;
+    };
+
+    auto evaluate = [&inputs] {
+        std::vector<Outcome> outcomes;
+        for(std::size_t i = 0; i < inputs.size(); ++i) {
+            const auto& text = inputs[i];
+            auto needle = text.substr(text.size() / 2, 3);
+            outcomes.push_back({ strings::trim_whitespace(text), strings::find_icase(text, needle),
+                strings::equals_icase(text, inputs[(i + 1) % inputs.size()]), strings::all_same(text),
+                strings::printable_prefix(text) });
+        }
+        return outcomes;
+    };
+
+    ASSERT_TRUE(strings::set_isa(strings::Isa::Scalar));
+    auto expected = evaluate();
+
+    for(auto isa : { strings::Isa::SSE2, strings::Isa::AVX2 }) {
+        if(!strings::set_isa(isa)) {
+            continue;
+        }
+
+        auto actual = evaluate();
+        for(std::size_t i = 0; i < inputs.size(); ++i) {
+            EXPECT_EQ(actual[i].trimmed.data(), expected[i].trimmed.data()) << "input " << i;
+            EXPECT_EQ(actual[i].trimmed.size(), expected[i].trimmed.size()) << "input " << i;
+            EXPECT_EQ(actual[i].found, expected[i].found) << "input " << i;
+            EXPECT_EQ(actual[i].equal, expected[i].equal) << "input " << i;
+            EXPECT_EQ(actual[i].same, expected[i].same) << "input " << i;
+            EXPECT_EQ(actual[i].printable, expected[i].printable) << "input " << i;
+        }
+    }
+
+    strings::set_isa(selected);
+}
+
 } // namespace identy::test
@@ -0,0 +1,263 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Identy.h>
+#include "Platform/Identy_platform_hwid.hxx"
+#include "test_config.hxx"
+
+namespace identy::test
+{
+
+namespace
+{
+class TierTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        root_ = std::filesystem::temp_directory_path()
+            / ("identy_tier_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+    }
+
+    void TearDown() override
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+    }
+
+    void write_tree()
+    {
+        fixture::SysfsSpec spec;
+        spec.block_devices = 2;
+        ASSERT_TRUE(fixture::write_sysfs_tree(root_, spec));
+    }
+
+    // What an unprivileged process sees: the tables are root-only
+    void hide_tables()
+    {
+        std::error_code ec;
+        std::filesystem::remove(root_ / "sys/firmware/dmi/tables/DMI", ec);
+        std::filesystem::remove(root_ / "sys/firmware/dmi/tables/smbios_entry_point", ec);
+    }
+
+    void hide_attributes()
+    {
+        std::error_code ec;
+        std::filesystem::remove(root_ / "sys/class/dmi/id/product_uuid", ec);
+        std::filesystem::remove(root_ / "sys/class/dmi/id/smbios_version", ec);
+    }
+
+    std::filesystem::path root_;
+};
+
+bool is_zero(const byte (&uuid)[SMBIOS_uuid_length])
+{
+    return std::all_of(std::begin(uuid), std::end(uuid), [](byte b) { return b == 0; });
+}
+} // namespace
+
+// ============================================================================
+// Achieved tier
+// ============================================================================
+
+TEST_F(TierTest, Snapshot_TableTierWhenReadable)
+{
+#ifdef IDENTY_LINUX
+    write_tree();
+    ScopedSysfsRoot root(root_);
+
+    auto mb = snap_motherboard();
+    EXPECT_EQ(mb.smbios.tier, SmbiosTier::Table);
+    EXPECT_FALSE(mb.smbios.raw_tables_data.empty());
+    EXPECT_FALSE(is_zero(mb.smbios.uuid));
+#else
+    GTEST_SKIP() << "Synthetic trees use the Linux sysfs layout";
+#endif
+}
+
+TEST_F(TierTest, Snapshot_AttributesMatchTableUuid)
+{
+#ifdef IDENTY_LINUX
+    write_tree();
+
+    Motherboard privileged;
+    {
+        ScopedSysfsRoot root(root_);
+        privileged = snap_motherboard();
+    }
+
+    hide_tables();
+    ScopedSysfsRoot root(root_);
+
+    auto mb = snap_motherboard();
+    EXPECT_EQ(mb.smbios.tier, SmbiosTier::Attributes);
+    EXPECT_TRUE(mb.smbios.raw_tables_data.empty());
+    EXPECT_EQ(mb.smbios.major_version, privileged.smbios.major_version);
+    EXPECT_EQ(mb.smbios.minor_version, privileged.smbios.minor_version);
+    EXPECT_EQ(std::memcmp(mb.smbios.uuid, privileged.smbios.uuid, SMBIOS_uuid_length), 0)
+        << "product_uuid is converted to the table byte order";
+#else
+    GTEST_SKIP() << "Synthetic trees use the Linux sysfs layout";
+#endif
+}
+
+TEST_F(TierTest, Snapshot_MalformedUuidAttributeIgnored)
+{
+#ifdef IDENTY_LINUX
+    write_tree();
+    hide_tables();
+
+    std::ofstream(root_ / "sys/class/dmi/id/product_uuid") << "not-a-uuid-not-a-uuid-not-a-uuid-xx\n";
+
+    ScopedSysfsRoot root(root_);
+
+    auto mb = snap_motherboard();
+    EXPECT_EQ(mb.smbios.tier, SmbiosTier::Attributes) << "the version attribute is still usable";
+    EXPECT_TRUE(is_zero(mb.smbios.uuid));
+#else
+    GTEST_SKIP() << "Synthetic trees use the Linux sysfs layout";
+#endif
+}
+
+TEST_F(TierTest, Snapshot_NoneWithoutSources)
+{
+#ifdef IDENTY_LINUX
+    write_tree();
+    hide_tables();
+    hide_attributes();
+    ScopedSysfsRoot root(root_);
+
+    auto mb = snap_motherboard();
+    EXPECT_EQ(mb.smbios.tier, SmbiosTier::None);
+    EXPECT_TRUE(is_zero(mb.smbios.uuid));
+#else
+    GTEST_SKIP() << "Synthetic trees use the Linux sysfs layout";
+#endif
+}
+
+// ============================================================================
+// Access plan
+// ============================================================================
+
+TEST_F(TierTest, Access_ReportsReadableSources)
+{
+#ifdef IDENTY_LINUX
+    write_tree();
+    hide_tables();
+    ScopedSysfsRoot root(root_);
+
+    auto access = tier::access();
+    EXPECT_FALSE(access.dmi_table);
+    EXPECT_FALSE(access.entry_point);
+    EXPECT_TRUE(access.uuid_attribute);
+    EXPECT_TRUE(access.version_attribute);
+    EXPECT_FALSE(access.daemon) << "rooted sources never use the daemon";
+    EXPECT_EQ(access.best(), SmbiosTier::Attributes);
+#else
+    GTEST_SKIP() << "Synthetic trees use the Linux sysfs layout";
+#endif
+}
+
+TEST_F(TierTest, Plan_UnavailableSourcesAreNotRetried)
+{
+#ifdef IDENTY_LINUX
+    write_tree();
+    auto table = root_ / "sys/firmware/dmi/tables/DMI";
+    auto saved = root_ / "DMI.saved";
+    std::filesystem::rename(table, saved);
+
+    ScopedSysfsRoot root(root_);
+
+    platform::AccessPlan plan;
+    EXPECT_EQ(platform::get_smbios(plan).tier, SmbiosTier::Attributes);
+    EXPECT_EQ(plan.dmi_table.load(), platform::Probe::Unavailable);
+
+    std::filesystem::rename(saved, table);
+    EXPECT_EQ(platform::get_smbios(plan).tier, SmbiosTier::Attributes) << "the plan is kept";
+
+    platform::AccessPlan fresh;
+    EXPECT_EQ(platform::get_smbios(fresh).tier, SmbiosTier::Table);
+#else
+    GTEST_SKIP() << "Synthetic trees use the Linux sysfs layout";
+#endif
+}
+
+TEST_F(TierTest, Access_BestPrefersCompleteSources)
+{
+    tier::Access access;
+    EXPECT_EQ(access.best(), SmbiosTier::None);
+
+    access.uuid_attribute = true;
+    EXPECT_EQ(access.best(), SmbiosTier::Attributes);
+
+    access.daemon = true;
+    EXPECT_EQ(access.best(), SmbiosTier::Daemon);
+
+    access.dmi_table = true;
+    EXPECT_EQ(access.best(), SmbiosTier::Table);
+}
+
+TEST_F(TierTest, DaemonSocket_Configurable)
+{
+    auto previous = tier::daemon_socket();
+
+    tier::set_daemon_socket({});
+    EXPECT_TRUE(tier::daemon_socket().empty());
+    EXPECT_FALSE(tier::access().daemon);
+
+    tier::set_daemon_socket(previous);
+    EXPECT_EQ(tier::daemon_socket(), previous);
+}
+
+// ============================================================================
+// Formats
+// ============================================================================
+
+TEST_F(TierTest, BinaryAndJson_KeepTier)
+{
+    MotherboardEx mb;
+    mb.smbios.major_version = 3;
+    mb.smbios.uuid[0] = 0x42;
+    mb.smbios.tier = SmbiosTier::Attributes;
+
+    std::vector<byte> buffer;
+    io::encode_binary(buffer, mb);
+
+    auto reader = io::read_binary(buffer);
+    ASSERT_TRUE(reader.has_value());
+    EXPECT_EQ(reader->smbios_tier(), SmbiosTier::Attributes);
+    EXPECT_EQ(reader->to_motherboard_ex().smbios.tier, SmbiosTier::Attributes);
+
+    std::ostringstream oss;
+    io::write_json(oss, mb);
+    auto json = oss.str();
+    EXPECT_NE(json.find("\"tier\":\"attributes\""), std::string::npos) << json;
+}
+
+TEST_F(TierTest, Diff_ReportsTierChange)
+{
+    MotherboardEx before;
+    before.smbios.tier = SmbiosTier::Table;
+
+    auto after = before;
+    after.smbios.tier = SmbiosTier::Daemon;
+
+    EXPECT_EQ(hs::compare(hs::hash(before), hs::hash(after)), 0) << "the tier is not part of the fingerprint";
+
+    auto changes = diff(before, after);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].kind, ChangeKind::SmbiosField);
+    EXPECT_EQ(changes[0].field, "tier");
+    EXPECT_EQ(changes[0].before_value, static_cast<std::int64_t>(SmbiosTier::Table));
+    EXPECT_EQ(changes[0].after_value, static_cast<std::int64_t>(SmbiosTier::Daemon));
+}
+
+} // namespace identy::test
@@ -0,0 +1,256 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <Identy.h>
+#include "test_config.hxx"
+
+namespace identy::test
+{
+
+namespace
+{
+struct RecordedEvent
+{
+    trace::EventKind kind;
+    trace::Phase phase;
+    std::uint32_t depth;
+    std::uint64_t bytes;
+    std::uint64_t syscalls;
+    std::string detail;
+};
+
+std::mutex recorded_mutex;
+std::vector<RecordedEvent> recorded;
+
+void record_event(const trace::Event& event)
+{
+    std::lock_guard lock(recorded_mutex);
+    recorded.push_back({ event.kind, event.phase, event.depth, event.bytes, event.syscalls, std::string(event.detail) });
+}
+
+class TraceTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        root_ = std::filesystem::temp_directory_path()
+            / ("identy_trace_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+
+        trace::reset();
+        recorded.clear();
+    }
+
+    void TearDown() override
+    {
+        trace::set_sink(nullptr);
+
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+    }
+
+    void write_tree(std::size_t block_devices)
+    {
+        fixture::SysfsSpec spec;
+        spec.block_devices = block_devices;
+        ASSERT_TRUE(fixture::write_sysfs_tree(root_, spec));
+    }
+
+    std::vector<RecordedEvent> events_of(trace::Phase phase, trace::EventKind kind)
+    {
+        std::vector<RecordedEvent> result;
+        std::ranges::copy_if(recorded, std::back_inserter(result), [&](const RecordedEvent& e) {
+            return e.phase == phase && e.kind == kind;
+        });
+        return result;
+    }
+
+    std::filesystem::path root_;
+};
+} // namespace
+
+// ============================================================================
+// Compile-time policy and metadata
+// ============================================================================
+
+TEST_F(TraceTest, DisabledSpanIsEmpty)
+{
+    static_assert(std::is_empty_v<trace::BasicSpan<false>>);
+    static_assert(std::is_same_v<trace::Span, trace::BasicSpan<trace::enabled>>);
+
+    trace::BasicSpan<false> span(trace::Phase::Hash);
+    (void)span;
+
+    EXPECT_EQ(trace::stats(trace::Phase::Hash).calls, 0u);
+}
+
+TEST_F(TraceTest, PhaseNamesAreUniqueAndNonEmpty)
+{
+    std::vector<std::string_view> names;
+
+    for(std::size_t i = 0; i < trace::phase_count; ++i) {
+        auto name = trace::phase_name(static_cast<trace::Phase>(i));
+        EXPECT_FALSE(name.empty()) << "phase " << i;
+        names.push_back(name);
+    }
+
+    std::ranges::sort(names);
+    EXPECT_EQ(std::ranges::adjacent_find(names), names.end());
+    EXPECT_EQ(trace::phase_name(trace::Phase::Drive), "drive");
+    EXPECT_TRUE(trace::phase_name(trace::Phase::Count).empty());
+}
+
+TEST_F(TraceTest, PercentileUsesHistogramBuckets)
+{
+    trace::PhaseStats stats;
+    stats.calls = 100;
+    stats.histogram[3] = 90;  // 8..15 ns
+    stats.histogram[10] = 10; // 1024..2047 ns
+
+    EXPECT_EQ(stats.percentile_ns(0.0), 15u);
+    EXPECT_EQ(stats.percentile_ns(0.5), 15u);
+    EXPECT_EQ(stats.percentile_ns(0.95), 2047u);
+    EXPECT_EQ(stats.percentile_ns(1.0), 2047u);
+
+    EXPECT_EQ(trace::PhaseStats {}.percentile_ns(0.5), 0u);
+}
+
+// ============================================================================
+// Instrumented collectors
+// ============================================================================
+
+TEST_F(TraceTest, Disabled_CollectorsLeaveStatsEmpty)
+{
+    if constexpr(trace::enabled) {
+        GTEST_SKIP() << "Built with IDENTY_ENABLE_TRACING";
+    }
+
+    write_tree(2);
+    ScopedSysfsRoot root(root_);
+
+    trace::set_sink(record_event);
+    auto mb = snap_motherboard_ex();
+    (void)vm::analyze_full(mb);
+
+    EXPECT_TRUE(recorded.empty());
+    for(std::size_t i = 0; i < trace::phase_count; ++i) {
+        EXPECT_EQ(trace::stats(static_cast<trace::Phase>(i)).calls, 0u);
+    }
+}
+
+TEST_F(TraceTest, Snapshot_EmitsDriveEventsWithDeviceNames)
+{
+    if constexpr(!trace::enabled) {
+        GTEST_SKIP() << "Built without IDENTY_ENABLE_TRACING";
+    }
+
+#ifdef IDENTY_LINUX
+    write_tree(4);
+    ScopedSysfsRoot root(root_);
+
+    trace::set_sink(record_event);
+    auto mb = snap_motherboard_ex();
+    trace::set_sink(nullptr);
+
+    ASSERT_EQ(mb.drives.size(), 4u);
+
+    auto begins = events_of(trace::Phase::Drive, trace::EventKind::Begin);
+    auto ends = events_of(trace::Phase::Drive, trace::EventKind::End);
+    ASSERT_EQ(begins.size(), 4u);
+    ASSERT_EQ(ends.size(), 4u);
+
+    auto list_end = events_of(trace::Phase::ListDrives, trace::EventKind::End);
+    ASSERT_EQ(list_end.size(), 1u);
+
+    for(const auto& e : ends) {
+        EXPECT_FALSE(e.detail.empty());
+        EXPECT_GT(e.syscalls, 0u) << e.detail;
+        EXPECT_EQ(e.depth, list_end[0].depth + 1) << "drives nest inside list_drives";
+    }
+
+    EXPECT_GT(list_end[0].bytes, 0u);
+    EXPECT_GE(list_end[0].syscalls, 4u);
+
+    auto smbios_end = events_of(trace::Phase::GetSmbios, trace::EventKind::End);
+    ASSERT_EQ(smbios_end.size(), 1u);
+    EXPECT_GE(smbios_end[0].bytes, fixture::SysfsSpec {}.dmi_table_size);
+
+    auto snap_end = events_of(trace::Phase::SnapMotherboardEx, trace::EventKind::End);
+    ASSERT_EQ(snap_end.size(), 1u);
+    EXPECT_EQ(snap_end[0].depth, 0u);
+    EXPECT_GE(snap_end[0].bytes, list_end[0].bytes + smbios_end[0].bytes);
+#else
+    GTEST_SKIP() << "Synthetic sysfs trees are Linux only";
+#endif
+}
+
+TEST_F(TraceTest, Events_BeginAndEndAreBalanced)
+{
+    if constexpr(!trace::enabled) {
+        GTEST_SKIP() << "Built without IDENTY_ENABLE_TRACING";
+    }
+
+    trace::set_sink(record_event);
+    auto mb = snap_motherboard_ex();
+    (void)vm::analyze_full(mb);
+    (void)hs::detail::default_hash_ex(mb);
+    trace::set_sink(nullptr);
+
+    std::vector<trace::Phase> stack;
+
+    for(const auto& e : recorded) {
+        if(e.kind == trace::EventKind::Begin) {
+            EXPECT_EQ(e.depth, stack.size());
+            stack.push_back(e.phase);
+        }
+        else {
+            ASSERT_FALSE(stack.empty());
+            EXPECT_EQ(stack.back(), e.phase);
+            stack.pop_back();
+            EXPECT_EQ(e.depth, stack.size());
+        }
+    }
+
+    EXPECT_TRUE(stack.empty());
+}
+
+TEST_F(TraceTest, Stats_AggregateCallsAndHistogram)
+{
+    if constexpr(!trace::enabled) {
+        GTEST_SKIP() << "Built without IDENTY_ENABLE_TRACING";
+    }
+
+    constexpr int runs = 3;
+
+    for(int i = 0; i < runs; ++i) {
+        auto mb = snap_motherboard_ex();
+        (void)vm::analyze_full(mb);
+        (void)hs::detail::default_hash_ex(mb);
+    }
+
+    for(auto phase : { trace::Phase::SnapMotherboardEx, trace::Phase::SnapMotherboard, trace::Phase::CpuInfo,
+             trace::Phase::GetSmbios, trace::Phase::ListDrives, trace::Phase::VmAnalyze, trace::Phase::VmCheckCpu,
+             trace::Phase::VmCheckSmbios, trace::Phase::VmCheckNetwork, trace::Phase::VmCheckDrives, trace::Phase::Hash }) {
+        auto stats = trace::stats(phase);
+
+        EXPECT_EQ(stats.calls, static_cast<std::uint64_t>(runs)) << trace::phase_name(phase);
+        EXPECT_EQ(std::accumulate(stats.histogram.begin(), stats.histogram.end(), std::uint64_t { 0 }), stats.calls);
+        EXPECT_LE(stats.max_ns, stats.total_ns);
+        EXPECT_LE(stats.percentile_ns(0.5), stats.percentile_ns(0.99));
+    }
+
+    EXPECT_GT(trace::stats(trace::Phase::Hash).bytes, 0u) << "hashed bytes are accounted";
+    EXPECT_EQ(trace::stats(trace::Phase::Hash).syscalls, 0u);
+
+    trace::reset();
+    EXPECT_EQ(trace::stats(trace::Phase::SnapMotherboardEx).calls, 0u);
+}
+
+} // namespace identy::test